@@ -0,0 +1,321 @@
+#!/usr/bin/env python3
+"""Design space exploration sweep over the NoCpad examples.
+
+Builds one simulation binary per structural configuration (example/topology,
+ordering scheme, VCs, buffer depth, arbiter) and runs every traffic point
+(injection rates) against it, in parallel over the available cores.
+The summary of each run's harness is collected in a single CSV.
+
+Structural parameters are passed to the example as -DIC_<NAME> overrides,
+thus only the ones an example declares (#ifndef IC_<NAME> in its ic_top)
+are swept for it. Traffic parameters are passed at run-time through the
+TB_<NAME> environment variables the testbench harness reads (tb_param).
+The synthetic traffic (destination pattern, injection process, burst
+lengths, see tb/traffic_gen.h) is a run-time axis as well.
+
+With --saturate, the injection rate of every configuration and traffic
+pattern is instead stepped up from --sat-start until the network saturates,
+ie the throughput stops growing, the average latency exceeds --sat-lat
+times the zero-load (first point) latency, or the run fails.
+
+With --meas-window, each run discards a warm-up period and measures the
+requests of a steady-state window, closing it once the latency and
+throughput confidence intervals converge (tb/meas_window.h).
+
+With --watchdog N, a run fails as soon as a router buffer has not moved for
+N cycles (src/include/rtr_watchdog.h), marked DEADLOCK when its wait-for graph
+has a cycle or STALLED otherwise. The remaining runs of a configuration that
+deadlocked are skipped, as its topology or routing is broken.
+
+Example:
+  ./dse_sweep.py -e nocpad_2m-2s_2d-mesh_basic-order nocpad_2m-2s_2d-mesh_vc-req-resp_id-order \\
+                 --arb MATRIX ROUND_ROBIN --buff 3 4 --rate 10 20 30 40 -o dse.csv
+  ./dse_sweep.py --pattern uniform hotspot transpose --inject onoff --saturate -o sat.csv
+"""
+
+import argparse
+import concurrent.futures
+import csv
+import itertools
+import os
+import re
+import shlex
+import subprocess
+import sys
+
+EXAMPLES_DIR = os.path.dirname(os.path.abspath(__file__))
+
+# Arbiters usable by the routers (see src/include/arbiters.h)
+ARBITERS = ['FIXED', 'MATRIX', 'ROUND_ROBIN', 'WEIGHTED_RR', 'DEFICIT_RR', 'QOS_RR', 'TREE_RR', 'AGE_RR']
+
+# Structural knobs : CSV column, example macro
+KNOBS = [('ord_scheme', 'IC_ORD_SCHEME'),
+         ('vcs',        'IC_VCS'),
+         ('buff_depth', 'IC_BUFF_DEPTH'),
+         ('arb',        'IC_ARB')]
+
+# Traffic knobs (tb/traffic_gen.h) : CSV column, environment variable
+PATTERNS = ['uniform', 'hotspot', 'transpose', 'bitcomp', 'neighbor']
+INJECTS  = ['bernoulli', 'onoff']
+BURSTS   = ['rand', 'fixed', 'uniform', 'bimodal']
+TRAFFIC  = [('pattern', 'TB_PATTERN'),
+            ('inject',  'TB_INJECT'),
+            ('burst',   'TB_BURST')]
+
+FIELDS = ['example'] + [k for k, _ in KNOBS] + [k for k, _ in TRAFFIC] + \
+         ['rate_rd', 'rate_wr', 'gen_cycles', 'status', 'saturated',
+          'rd_delay', 'wr_delay', 'rd_p99', 'wr_p99', 'rd_throughput', 'wr_throughput', 'binary']
+
+RE_DELAY = re.compile(r'Full\s+Avg delay\(cycles\)\s*:\s*(\S+),\s*(\S+)')
+RE_THR   = re.compile(r'Throughput\s+\(flits/cycle/node\)\s*:\s*(\S+),\s*(\S+)')
+# Latency distribution row : count min p50 p90 p99 p99.9 max avg
+RE_P99   = re.compile(r'^ALL\s+(RD|WR)\s*:\s*\d+\s+\d+\s+\d+\s+\d+\s+(\d+)', re.M)
+RE_WDOG  = re.compile(r'Watchdog : (\d+) deadlock cycles')
+
+# Configurations (example, binary) that deadlocked, their remaining runs are skipped
+DEADLOCKED = set()
+
+
+def example_knobs(example):
+    """Returns the IC_ macros the example can be overridden with."""
+    found = set()
+    for name in os.listdir(os.path.join(EXAMPLES_DIR, example)):
+        if name.startswith('ic_top') and name.endswith('.h'):
+            with open(os.path.join(EXAMPLES_DIR, example, name)) as f:
+                found.update(re.findall(r'#ifndef\s+(IC_\w+)', f.read()))
+    return found
+
+
+def structural_points(args):
+    """Unique (example, knob values) combinations. Unsupported knobs stay empty."""
+    grid = {'ord_scheme': args.ord, 'vcs': args.vcs, 'buff_depth': args.buff, 'arb': args.arb}
+    points = []
+    for example in args.examples:
+        avail = example_knobs(example)
+        axes = [grid[k] if (grid[k] and macro in avail) else [None] for k, macro in KNOBS]
+        for values in itertools.product(*axes):
+            point = (example, values)
+            if point not in points:
+                points.append(point)
+    return points
+
+
+def binary_name(values):
+    tag = '_'.join('%s%s' % (k, v) for (k, _), v in zip(KNOBS, values) if v is not None)
+    return 'sim_dse_' + (tag.lower() if tag else 'base')
+
+
+def build(example, values, args):
+    binary = binary_name(values)
+    flags = [args.cxxflags] + ['-D%s=%s' % (macro, v) for (_, macro), v in zip(KNOBS, values) if v is not None]
+    # The AGE_RR routers need the age sideband of the flits
+    if 'AGE_RR' in values:
+        flags.append('-DDNP_AGE=1')
+    # Always rebuilt (-B), the binary of a previous sweep may be of older sources or flags
+    cmd = ['make', '-B', '-C', os.path.join(EXAMPLES_DIR, example),
+           'SIM_BIN=' + binary, 'DSE_FLAGS=' + ' '.join(flags)]
+    if args.dry_run:
+        print(' '.join(shlex.quote(c) for c in cmd))
+        return binary, True
+    res = subprocess.run(cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+    if res.returncode != 0:
+        sys.stderr.write('Build failed for %s %s\n%s\n' % (example, binary, res.stdout[-4000:]))
+    return binary, res.returncode == 0
+
+
+def run(example, values, binary, tr, rate_rd, rate_wr, args):
+    row = {'example': example, 'rate_rd': rate_rd, 'rate_wr': rate_wr,
+           'gen_cycles': args.cycles, 'binary': binary}
+    for (k, _), v in zip(KNOBS, values):
+        row[k] = '' if v is None else v
+
+    if (example, binary) in DEADLOCKED:
+        for (k, _), v in zip(TRAFFIC, tr):
+            row[k] = v
+        row['status'] = 'SKIPPED'
+        return row
+
+    env = dict(os.environ)
+    for (k, var), v in zip(TRAFFIC, tr):
+        row[k] = v
+        env[var] = v
+    for var, v in (('TB_HOT_DST', args.hot_dst), ('TB_HOT_PCT', args.hot_pct),
+                   ('TB_ON_LEN', args.on_len), ('TB_OFF_LEN', args.off_len),
+                   ('TB_BURST_A', args.burst_a), ('TB_BURST_B', args.burst_b)):
+        if v is not None:
+            env[var] = str(v)
+    env['TB_GEN_RATE_RD'] = str(rate_rd)
+    env['TB_GEN_RATE_WR'] = str(rate_wr)
+    if args.cache_rate is not None:
+        env['TB_GEN_RATE_CACHE'] = str(args.cache_rate)
+    if args.cycles is not None:
+        env['TB_GEN_CYCLES'] = str(args.cycles)
+    if args.meas_window:
+        env['TB_MEAS_WINDOW'] = '1'
+        if args.warmup is not None:
+            env['TB_WARMUP_CYCLES'] = str(args.warmup)
+    if args.watchdog:
+        env['TB_WDOG_CYCLES'] = str(args.watchdog)
+
+    if args.dry_run:
+        print('TB_PATTERN=%s TB_INJECT=%s TB_BURST=%s TB_GEN_RATE_RD=%s TB_GEN_RATE_WR=%s %s/%s'
+              % (tr + (rate_rd, rate_wr, example, binary)))
+        row['status'] = 'DRY_RUN'
+        return row
+    try:
+        res = subprocess.run(['./' + binary], cwd=os.path.join(EXAMPLES_DIR, example), env=env,
+                             stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                             universal_newlines=True, timeout=args.timeout)
+        out = res.stdout
+    except subprocess.TimeoutExpired:
+        row['status'] = 'TIMEOUT'
+        return row
+
+    wdog = RE_WDOG.search(out)
+    if   wdog:                       row['status'] = 'DEADLOCK' if int(wdog.group(1)) else 'STALLED'
+    elif 'PASSED. No Errors.' in out: row['status'] = 'PASSED'
+    elif 'FAILED'            in out: row['status'] = 'FAILED'
+    else:                            row['status'] = 'ERROR(%d)' % res.returncode
+
+    if row['status'] == 'DEADLOCK':
+        DEADLOCKED.add((example, binary))
+
+    m = RE_DELAY.search(out)
+    if m: row['rd_delay'], row['wr_delay'] = m.groups()
+    m = RE_THR.search(out)
+    if m: row['rd_throughput'], row['wr_throughput'] = m.groups()
+    for d, p99 in RE_P99.findall(out):
+        row[d.lower() + '_p99'] = p99
+    return row
+
+
+def to_float(row, *keys):
+    try:
+        return sum(float(row[k]) for k in keys)
+    except (KeyError, ValueError):
+        return None
+
+
+def saturate(example, values, binary, tr, args):
+    """Steps the (RD=WR) injection rate up until the configuration saturates.
+       The last row is marked as the saturation point."""
+    rows = []
+    zero_lat = None
+    rate = args.sat_start
+    while rate <= 100:
+        row = run(example, values, binary, tr, rate, rate, args)
+        rows.append(row)
+        if row['status'] != 'PASSED':
+            break
+        lat = to_float(row, 'rd_delay', 'wr_delay')
+        thr = to_float(row, 'rd_throughput', 'wr_throughput')
+        if zero_lat is None:
+            zero_lat = lat
+        if lat is not None and zero_lat and lat > args.sat_lat * zero_lat:
+            break
+        if len(rows) > 1:
+            prev = to_float(rows[-2], 'rd_throughput', 'wr_throughput')
+            if thr is not None and prev is not None and thr < prev * (1.0 + args.sat_gain / 100.0):
+                break
+        rate += args.sat_step
+    if rows and rows[-1]['status'] != 'DRY_RUN':
+        rows[-1]['saturated'] = 'yes'
+    return rows
+
+
+def main():
+    p = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    p.add_argument('-e', '--examples', nargs='+', default=['nocpad_2m-2s_2d-mesh_basic-order'],
+                   help='example directories to sweep (the topology axis)')
+    p.add_argument('--rate',    nargs='+', type=int, default=[40], help='RD injection rates (%%)')
+    p.add_argument('--rate-wr', nargs='+', type=int, default=None, help='WR injection rates (%%). Default: same as --rate')
+    p.add_argument('--cache-rate', type=int, default=None, help='ACE cache transaction rate (%%)')
+    p.add_argument('--ord',  nargs='+', type=int, default=[], help='ordering schemes (IC_ORD_SCHEME)')
+    p.add_argument('--vcs',  nargs='+', type=int, default=[], help='virtual channels (IC_VCS)')
+    p.add_argument('--buff', nargs='+', type=int, default=[], help='router buffer depths (IC_BUFF_DEPTH)')
+    p.add_argument('--arb',  nargs='+', choices=ARBITERS, default=[], help='router arbiters (IC_ARB)')
+    p.add_argument('--pattern', nargs='+', choices=PATTERNS, default=['uniform'], help='destination patterns (TB_PATTERN)')
+    p.add_argument('--inject',  nargs='+', choices=INJECTS,  default=['bernoulli'], help='injection processes (TB_INJECT)')
+    p.add_argument('--burst',   nargs='+', choices=BURSTS,   default=['rand'], help='burst length distributions (TB_BURST)')
+    p.add_argument('--hot-dst', type=int, default=None, help='hotspot slave (TB_HOT_DST)')
+    p.add_argument('--hot-pct', type=int, default=None, help='hotspot traffic fraction (%%) (TB_HOT_PCT)')
+    p.add_argument('--on-len',  type=int, default=None, help='average ON period (cycles) (TB_ON_LEN)')
+    p.add_argument('--off-len', type=int, default=None, help='average OFF period (cycles) (TB_OFF_LEN)')
+    p.add_argument('--burst-a', type=int, default=None, help='fixed/min/short burst beats (TB_BURST_A)')
+    p.add_argument('--burst-b', type=int, default=None, help='max/long burst beats (TB_BURST_B)')
+    p.add_argument('--saturate',  action='store_true', help='step the injection rate up to saturation instead of --rate')
+    p.add_argument('--sat-start', type=int, default=5,  help='first injection rate of --saturate (%%)')
+    p.add_argument('--sat-step',  type=int, default=5,  help='injection rate step of --saturate (%%)')
+    p.add_argument('--sat-lat',   type=float, default=3.0, help='saturation latency, times the zero-load latency')
+    p.add_argument('--sat-gain',  type=float, default=1.0, help='saturation when the throughput grows less than this (%%)')
+    p.add_argument('--cycles', type=int, default=None, help='transaction generation cycles (TB_GEN_CYCLES)')
+    p.add_argument('--meas-window', action='store_true',
+                   help='measure a steady-state window up to convergence instead of --cycles (TB_MEAS_WINDOW)')
+    p.add_argument('--warmup', type=int, default=None, help='warm-up cycles of --meas-window (TB_WARMUP_CYCLES)')
+    p.add_argument('--watchdog', type=int, default=None,
+                   help='fail a run once a router buffer is stuck for this many cycles (TB_WDOG_CYCLES)')
+    p.add_argument('-j', '--jobs', type=int, default=os.cpu_count() or 1, help='parallel builds/runs')
+    p.add_argument('--cxxflags', default='-O2', help='extra compiler flags of the sweep binaries')
+    p.add_argument('--timeout', type=int, default=None, help='per run timeout (sec)')
+    p.add_argument('-o', '--out', default='dse.csv', help='output CSV')
+    p.add_argument('-n', '--dry-run', action='store_true', help='print the commands only')
+    args = p.parse_args()
+
+    if args.vcs and min(args.vcs) < 2:
+        p.error('--vcs : Requests and Responses need at least 2 VCs')
+    if args.buff and min(args.buff) < 3:
+        p.error('--buff : The IFs start with 3 credits, buffers must hold at least 3 flits')
+
+    if args.rate_wr is None:
+        traffic = [(r, r) for r in args.rate]
+    else:
+        traffic = list(itertools.product(args.rate, args.rate_wr))
+
+    if args.sat_step < 1:
+        p.error('--sat-step : must be positive')
+
+    patterns = list(itertools.product(args.pattern, args.inject, args.burst))
+    points = structural_points(args)
+    print('%d configurations x %d patterns x %s, %d jobs'
+          % (len(points), len(patterns), 'saturation sweep' if args.saturate else '%d rates' % len(traffic), args.jobs))
+
+    with concurrent.futures.ThreadPoolExecutor(max_workers=1 if args.dry_run else args.jobs) as pool:
+        built = list(pool.map(lambda pt: build(pt[0], pt[1], args), points))
+
+        todo = [(ex, values, binary, tr) for (ex, values), (binary, ok) in zip(points, built) if ok
+                for tr in patterns]
+        if args.saturate:
+            # The rate steps of a configuration are sequential, configurations run in parallel
+            runs = [pool.submit(saturate, ex, values, binary, tr, args) for ex, values, binary, tr in todo]
+        else:
+            runs = [pool.submit(lambda *a: [run(*a)], ex, values, binary, tr, rd, wr, args)
+                    for ex, values, binary, tr in todo for rd, wr in traffic]
+        rows = []
+        for fut in concurrent.futures.as_completed(runs):
+            for row in fut.result():
+                print('%-45s %-20s %-9s %-9s %-7s RD %3s WR %3s : %s%s'
+                      % (row['example'], row['binary'], row['pattern'], row['inject'], row['burst'],
+                         row['rate_rd'], row['rate_wr'], row['status'],
+                         ' (saturated)' if row.get('saturated') else ''))
+                rows.append(row)
+
+    rows.sort(key=lambda r: (r['example'], r['binary'], r['pattern'], r['inject'], r['burst'],
+                             r['rate_rd'], r['rate_wr']))
+    with open(args.out, 'w', newline='') as f:
+        w = csv.DictWriter(f, fieldnames=FIELDS)
+        w.writeheader()
+        w.writerows(rows)
+    print('Results in %s' % args.out)
+
+    failed = [b for (b, ok) in built if not ok]
+    if args.saturate:
+        # Failing at (or past) saturation is the expected stop condition, unless the network deadlocked
+        bad = [r for r in rows if r['status'] not in ('PASSED', 'DRY_RUN')
+               and (not r.get('saturated') or r['status'] == 'DEADLOCK')]
+    else:
+        bad = [r for r in rows if r['status'] not in ('PASSED', 'DRY_RUN')]
+    return 1 if failed or bad else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,139 @@
+#!/usr/bin/env python3
+"""Decoder of the binary event traces of the NoCpad testbenches.
+
+The simulation logs its events in per module rings (src/include/evt_trace.h)
+when built with -DEVT_TRACE_LEVEL=1 (transactions) or 2 (also data beats),
+and dumps them at the end of the run to TB_EVT_TRACE (evt_trace.bin).
+
+By default the events of all the modules are merged in time order and
+printed as text. With --chrome the trace is converted to the Chrome trace
+event JSON, to be opened in Perfetto (ui.perfetto.dev) or chrome://tracing.
+Each module is a track of instant events, and every transaction is also
+an async slice from its request to its completion, ie AR to the last R,
+AW to B, a HOME RD/WR to its acknowledge, matched per module and ID in
+order.
+
+Example:
+  ./evt_decode.py evt_trace.bin | less
+  ./evt_decode.py evt_trace.bin --ring 'master\\[0\\]' --type AR R
+  ./evt_decode.py evt_trace.bin --chrome -o evt_trace.json
+"""
+
+import argparse
+import json
+import re
+import struct
+import sys
+
+MAGIC = b'NOCPEVT1'
+REC   = struct.Struct('<QQIHH')  # time_ps, addr, arg, id, type
+
+# Request type -> completion type, the span of a transaction. R completes on its last beat
+SPANS = {'AR': 'R', 'AW': 'B', 'S_AR': 'S_R', 'S_AW': 'S_B',
+         'HOME_RD': 'HOME_RACK', 'HOME_WR': 'HOME_WACK'}
+LAST_BEAT = ('R', 'S_R')
+
+
+def load(fname):
+    """Returns the event type names and the rings, [(name, logged, [(time_ps, addr, arg, id, type)])]"""
+    with open(fname, 'rb') as f:
+        buf = f.read()
+    if buf[:8] != MAGIC:
+        sys.exit('%s : not an event trace' % fname)
+    pos = 8
+
+    def u32():
+        nonlocal pos
+        v, = struct.unpack_from('<I', buf, pos)
+        pos += 4
+        return v
+
+    def text():
+        nonlocal pos
+        n = u32()
+        s = buf[pos:pos + n].decode()
+        pos += n
+        return s
+
+    types = [text() for _ in range(u32())]
+    rings = []
+    for _ in range(u32()):
+        name = text()
+        logged, = struct.unpack_from('<Q', buf, pos)
+        pos += 8
+        stored = u32()
+        recs = [REC.unpack_from(buf, pos + i * REC.size) for i in range(stored)]
+        pos += stored * REC.size
+        rings.append((name, logged, recs))
+    return types, rings
+
+
+def events(types, rings, ring_re, type_set):
+    """All the selected events in time order, as (time_ps, ring index, type name, id, addr, arg)"""
+    evs = []
+    for r, (name, _, recs) in enumerate(rings):
+        if ring_re and not ring_re.search(name):
+            continue
+        for t, addr, arg, id_, ty in recs:
+            tname = types[ty] if ty < len(types) else str(ty)
+            if type_set and tname not in type_set:
+                continue
+            evs.append((t, r, tname, id_, addr, arg))
+    evs.sort(key=lambda e: (e[0], e[1]))
+    return evs
+
+
+def to_text(types, rings, evs, out):
+    for name, logged, recs in rings:
+        if logged > len(recs):
+            out.write('# %s : %d events logged, only the last %d kept\n' % (name, logged, len(recs)))
+    for t, r, tname, id_, addr, arg in evs:
+        out.write('%14.3f ns  %-40s %-10s id=%-4d addr=0x%-10x arg=%d\n' % (t / 1e3, rings[r][0], tname, id_, addr, arg))
+
+
+def to_chrome(types, rings, evs, out):
+    trace = []
+    for r, (name, _, _) in enumerate(rings):
+        trace.append({'ph': 'M', 'name': 'thread_name', 'pid': 0, 'tid': r, 'args': {'name': name}})
+
+    ends  = dict((v, k) for k, v in SPANS.items())
+    open_ = {}  # (ring, request type, id) -> [(async id, start)]
+    span  = 0
+    for t, r, tname, id_, addr, arg in evs:
+        ts = t / 1e6  # us
+        trace.append({'ph': 'i', 's': 't', 'name': tname, 'pid': 0, 'tid': r, 'ts': ts,
+                      'args': {'id': id_, 'addr': hex(addr), 'arg': arg}})
+        if tname in SPANS:
+            open_.setdefault((r, tname, id_), []).append((span, addr))
+            trace.append({'ph': 'b', 'cat': rings[r][0], 'name': '%s id %d' % (tname, id_), 'id': span,
+                          'pid': 0, 'tid': r, 'ts': ts, 'args': {'addr': hex(addr)}})
+            span += 1
+        elif tname in ends and (tname not in LAST_BEAT or arg):
+            pend = open_.get((r, ends[tname], id_))
+            if pend:
+                sid, _ = pend.pop(0)
+                trace.append({'ph': 'e', 'cat': rings[r][0], 'name': '%s id %d' % (ends[tname], id_), 'id': sid,
+                              'pid': 0, 'tid': r, 'ts': ts})
+    json.dump({'traceEvents': trace, 'displayTimeUnit': 'ns'}, out)
+    out.write('\n')
+
+
+def main():
+    p = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    p.add_argument('trace', help='Event trace dumped by the simulation (TB_EVT_TRACE)')
+    p.add_argument('--chrome', '--json', action='store_true', help='Chrome/Perfetto trace event JSON instead of text')
+    p.add_argument('--ring', help='Only the modules whose name matches this regular expression')
+    p.add_argument('--type', nargs='+', help='Only these event types, ie AR R HOME_RD')
+    p.add_argument('-o', '--out', help='Output file (default stdout)')
+    args = p.parse_args()
+
+    types, rings = load(args.trace)
+    evs = events(types, rings, re.compile(args.ring) if args.ring else None, set(args.type or []))
+    out = open(args.out, 'w') if args.out else sys.stdout
+    (to_chrome if args.chrome else to_text)(types, rings, evs, out)
+    if args.out:
+        out.close()
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,20 @@
+#include "./ic_top.h"
+#ifdef IC_TLM
+  // Loosely-Timed model of the same interconnect. Build with : make sim_tlm
+  #include "../../src/ic_tlm.h"
+  typedef ic_tlm<smpl_cfg, ic_top::DIM_X, ic_top::DIM_Y> ic_tlm_top;
+#endif
+#include "../../tb/tb_axi_con/harness.h"
+
+sc_trace_file* trace_file_ptr;
+
+int sc_main(int argc, char *argv[]) {
+  
+  trace_file_ptr = sc_create_vcd_trace_file("trace");
+  
+  harness the_harness("the_harness");
+  sc_start();  
+
+  return (0);
+  
+}; // End of main
@@ -0,0 +1,63 @@
+#ifndef AXI4_TOP_IC_H
+#define AXI4_TOP_IC_H
+
+#pragma once
+
+#include "../../src/ic_top_mesh.h"
+
+// Bundle of configuration parameters
+template <
+  unsigned char MASTER_NUM_ , unsigned char SLAVE_NUM_,
+  unsigned char RD_LANES_   , unsigned char WR_LANES_,
+  unsigned char RREQ_PHITS_ , unsigned char RRESP_PHITS_,
+  unsigned char WREQ_PHITS_ , unsigned char WRESP_PHITS_,
+  unsigned char ORD_SCHEME_ , unsigned char SLV_OUTS_
+>
+struct cfg {
+  static const unsigned char MASTER_NUM  = MASTER_NUM_;
+  static const unsigned char SLAVE_NUM   = SLAVE_NUM_;
+  static const unsigned char RD_LANES    = RD_LANES_;
+  static const unsigned char WR_LANES    = WR_LANES_;
+  static const unsigned char RREQ_PHITS  = RREQ_PHITS_;
+  static const unsigned char RRESP_PHITS = RRESP_PHITS_;
+  static const unsigned char WREQ_PHITS  = WREQ_PHITS_;
+  static const unsigned char WRESP_PHITS = WRESP_PHITS_;
+  static const unsigned char ORD_SCHEME  = ORD_SCHEME_;
+  static const unsigned char SLV_OUTS    = SLV_OUTS_;
+};
+
+// Design space exploration overrides (-D at build time). Defaults are the example's configuration
+//   An 8x8 mesh needs the wider node IDs, eg
+//   make SIM_BIN=sim_8x8 DSE_FLAGS="-DDNP_NODE_W=6 -DIC_DIM_X=8 -DIC_DIM_Y=8 -DIC_MASTER_NUM=60"
+#ifndef IC_DIM_X
+#define IC_DIM_X 4
+#endif
+#ifndef IC_DIM_Y
+#define IC_DIM_Y 4
+#endif
+#ifndef IC_MASTER_NUM
+#define IC_MASTER_NUM 12
+#endif
+#ifndef IC_SLAVE_NUM
+#define IC_SLAVE_NUM 4 // The testbench slaves report their ID in the 2-bit response, at most 4
+#endif
+#ifndef IC_ORD_SCHEME
+#define IC_ORD_SCHEME 0
+#endif
+#ifndef IC_ARB
+#define IC_ARB MATRIX
+#endif
+#ifndef IC_SLV_OUTS
+#define IC_SLV_OUTS 3 // Outstanding transactions per Slave and direction, eg 32 for a DDR controller
+#endif
+
+// the used configuration. 12 Masters/4 Slaves, 64bit AXI, 2.4.4.1 phit flits
+typedef cfg<IC_MASTER_NUM, IC_SLAVE_NUM, 8, 8, 4, 4, 4, 4, IC_ORD_SCHEME, IC_SLV_OUTS> smpl_cfg;
+
+#pragma hls_design top
+class ic_top : public ic_top_mesh<IC_DIM_X, IC_DIM_Y, smpl_cfg, IC_ARB> {
+public:
+  ic_top(sc_module_name name_) : ic_top_mesh<IC_DIM_X, IC_DIM_Y, smpl_cfg, IC_ARB>(name_) {};
+};
+
+#endif // AXI4_TOP_IC_H
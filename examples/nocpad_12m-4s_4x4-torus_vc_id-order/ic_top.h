@@ -0,0 +1,84 @@
+#ifndef AXI4_TOP_IC_H
+#define AXI4_TOP_IC_H
+
+#pragma once
+
+#include "../../src/ic_top_torus.h"
+
+// Bundle of configuration parameters
+template <
+  unsigned char MASTER_NUM_ , unsigned char SLAVE_NUM_,
+  unsigned char RD_LANES_   , unsigned char WR_LANES_,
+  unsigned char RREQ_PHITS_ , unsigned char RRESP_PHITS_,
+  unsigned char WREQ_PHITS_ , unsigned char WRESP_PHITS_,
+  unsigned char ORD_SCHEME_ , unsigned char VCS_,
+  unsigned char BUFF_DEPTH_=3, unsigned char CR_COALESCE_=0,
+  unsigned char TCS_=1, unsigned char TC_MAP_=TC_MAP_NONE,
+  unsigned char DAMQ_SLOTS_=0, unsigned char DAMQ_RSV_=1
+>
+struct cfg {
+  static const unsigned char MASTER_NUM  = MASTER_NUM_;
+  static const unsigned char SLAVE_NUM   = SLAVE_NUM_;
+  static const unsigned char RD_LANES    = RD_LANES_;
+  static const unsigned char WR_LANES    = WR_LANES_;
+  static const unsigned char RREQ_PHITS  = RREQ_PHITS_;
+  static const unsigned char RRESP_PHITS = RRESP_PHITS_;
+  static const unsigned char WREQ_PHITS  = WREQ_PHITS_;
+  static const unsigned char WRESP_PHITS = WRESP_PHITS_;
+  static const unsigned char ORD_SCHEME  = ORD_SCHEME_;
+  static const unsigned char VCS  = VCS_;
+  static const unsigned char BUFF_DEPTH  = BUFF_DEPTH_;  // Router input buffer slots per VC, the credits of the IFs
+  static const unsigned char CR_COALESCE = CR_COALESCE_; // Coalesced credit return, 0 for a credit per message
+  static const unsigned char TCS         = TCS_;         // Traffic classes, a Request and a Response VC each
+  static const unsigned char TC_MAP      = TC_MAP_;      // The key of a request's class, see vc_tc_map.h
+  static const unsigned char DAMQ_SLOTS  = DAMQ_SLOTS_;  // Shared router input buffer of that many slots, 0 for a FIFO per VC
+  static const unsigned char DAMQ_RSV    = DAMQ_RSV_;    // Slots of the shared buffer reserved per VC
+};
+
+// Design space exploration overrides (-D at build time). Defaults are the example's configuration
+//   Requests and Responses use VCs 0 and 1, their dateline copies 2 and 3. Thus 4 VCs.
+//   The IFs take their credits from the buffer depth. IC_CR_COALESCE>0 returns the credits in batches of that many
+//   IC_DAMQ_SLOTS>0 shares that many slots per router input among the VCs, each VC holding at most IC_BUFF_DEPTH
+//   An 8x8 torus needs the wider node IDs, eg
+//   make SIM_BIN=sim_8x8 DSE_FLAGS="-DDNP_NODE_W=6 -DIC_DIM_X=8 -DIC_DIM_Y=8 -DIC_MASTER_NUM=60"
+#ifndef IC_DIM_X
+#define IC_DIM_X 4
+#endif
+#ifndef IC_DIM_Y
+#define IC_DIM_Y 4
+#endif
+#ifndef IC_MASTER_NUM
+#define IC_MASTER_NUM 12
+#endif
+#ifndef IC_SLAVE_NUM
+#define IC_SLAVE_NUM 4 // The testbench slaves report their ID in the 2-bit response, at most 4
+#endif
+#ifndef IC_ORD_SCHEME
+#define IC_ORD_SCHEME 1
+#endif
+#ifndef IC_BUFF_DEPTH
+#define IC_BUFF_DEPTH 3
+#endif
+#ifndef IC_CR_COALESCE
+#define IC_CR_COALESCE 0
+#endif
+#ifndef IC_DAMQ_SLOTS
+#define IC_DAMQ_SLOTS 0
+#endif
+#ifndef IC_DAMQ_RSV
+#define IC_DAMQ_RSV 1
+#endif
+#ifndef IC_ARB
+#define IC_ARB MATRIX
+#endif
+
+// the used configuration. 12 Masters/4 Slaves, 64bit AXI, 4 phit flits, 4 VCs
+typedef cfg<IC_MASTER_NUM, IC_SLAVE_NUM, 8, 8, 4, 4, 4, 4, IC_ORD_SCHEME, 4, IC_BUFF_DEPTH, IC_CR_COALESCE, 1, TC_MAP_NONE, IC_DAMQ_SLOTS, IC_DAMQ_RSV> smpl_cfg;
+
+#pragma hls_design top
+class ic_top : public ic_top_torus<IC_DIM_X, IC_DIM_Y, smpl_cfg, IC_BUFF_DEPTH, IC_ARB> {
+public:
+  ic_top(sc_module_name name_) : ic_top_torus<IC_DIM_X, IC_DIM_Y, smpl_cfg, IC_BUFF_DEPTH, IC_ARB>(name_) {};
+};
+
+#endif // AXI4_TOP_IC_H
@@ -7,6 +7,7 @@
 #include "../../src/axi_slave_if.h"
 
 #include "../../src/router_wh.h"
+#include "../../src/cdc_link.h"
 
 #include "systemc.h"
 #include "nvhls_connections.h"
@@ -19,7 +20,7 @@ template <
   unsigned char RD_LANES_   , unsigned char WR_LANES_,
   unsigned char RREQ_PHITS_ , unsigned char RRESP_PHITS_,
   unsigned char WREQ_PHITS_ , unsigned char WRESP_PHITS_,
-  unsigned char ORD_SCHEME_
+  unsigned char ORD_SCHEME_ , unsigned char SLV_OUTS_
 >
 struct cfg {
   static const unsigned char MASTER_NUM  = MASTER_NUM_;
@@ -31,10 +32,26 @@ struct cfg {
   static const unsigned char WREQ_PHITS  = WREQ_PHITS_;
   static const unsigned char WRESP_PHITS = WRESP_PHITS_;
   static const unsigned char ORD_SCHEME  = ORD_SCHEME_;
+  static const unsigned char SLV_OUTS    = SLV_OUTS_;
 };
 
+// Design space exploration overrides (-D at build time). Defaults are the example's configuration
+#ifndef IC_ORD_SCHEME
+#define IC_ORD_SCHEME 0
+#endif
+#ifndef IC_ARB
+#define IC_ARB MATRIX
+#endif
+#ifndef IC_SLV_OUTS
+#define IC_SLV_OUTS 3 // Outstanding transactions per Slave and direction, eg 32 for a DDR controller
+#endif
+// IC_CDC : The routers run on their own clock (clk_noc), crossing to the IFs' clk through cdc_link
+#ifndef IC_CDC_DEPTH
+#define IC_CDC_DEPTH 8
+#endif
+
 // the used configuration. 2 Masters/Slaves, 64bit AXI, 2.4.4.1 phit flits
-typedef cfg<2, 2, 8, 8, 4, 4, 4, 4, 0> smpl_cfg;
+typedef cfg<2, 2, 8, 8, 4, 4, 4, 4, IC_ORD_SCHEME, IC_SLV_OUTS> smpl_cfg;
 
 SC_MODULE(ic_top) {
 public:
@@ -52,6 +69,9 @@ public:
   
   sc_in_clk    clk;
   sc_in <bool> rst_n;
+#ifdef IC_CDC
+  sc_in_clk    clk_noc; // The routers' clock, the IFs stay on clk
+#endif
   
   // IC's Address map
   sc_in<sc_uint <32> >           addr_map[smpl_cfg::SLAVE_NUM][2]; // [SLAVE_NUM][0:begin, 1: End]
@@ -107,7 +127,7 @@ public:
   
   // --- NoC Channels ---
   // REQ Router + In/Out Channels
-  router_wh_top< 4+2, 4+2, rreq_flit_t, 5, DIM_X>   rtr_req[DIM_X][DIM_Y];
+  router_wh_top< 4+2, 4+2, rreq_flit_t, 5, DIM_X, 1, arbiter<4+2, IC_ARB> >   rtr_req[DIM_X][DIM_Y];
   
   Connections::Combinational<wreq_flit_t>    chan_hor_right_req[DIM_X+1][DIM_Y];
   Connections::Combinational<wreq_flit_t>    chan_hor_left_req[DIM_X+1][DIM_Y];
@@ -122,7 +142,7 @@ public:
   
   
   // RESP Router + In/Out Channels
-  router_wh_top< 4+2, 4+2, rresp_flit_t, 5, DIM_X>  *rtr_resp[DIM_X][DIM_Y];
+  router_wh_top< 4+2, 4+2, rresp_flit_t, 5, DIM_X, 1, arbiter<4+2, IC_ARB> >  *rtr_resp[DIM_X][DIM_Y];
   
   Connections::Combinational<rreq_flit_t>    chan_hor_right_resp[DIM_X+1][DIM_Y];
   Connections::Combinational<rreq_flit_t>    chan_hor_left_resp[DIM_X+1][DIM_Y];
@@ -136,6 +156,22 @@ public:
   Connections::Combinational<rresp_flit_t>    chan_ej_wresp[DIM_X][DIM_Y];
   Connections::Combinational<rresp_flit_t>    chan_ej_rresp[DIM_X][DIM_Y];
   
+#ifdef IC_CDC
+  // The router side of the local channels, the IFs keep the chan_inj/chan_ej ones
+  Connections::Combinational<rreq_flit_t>     chan_inj_rreq_noc[DIM_X][DIM_Y];
+  Connections::Combinational<rreq_flit_t>     chan_inj_wreq_noc[DIM_X][DIM_Y];
+  Connections::Combinational<rreq_flit_t>     chan_ej_rreq_noc[DIM_X][DIM_Y];
+  Connections::Combinational<rreq_flit_t>     chan_ej_wreq_noc[DIM_X][DIM_Y];
+  
+  Connections::Combinational<rresp_flit_t>    chan_inj_rresp_noc[DIM_X][DIM_Y];
+  Connections::Combinational<rresp_flit_t>    chan_inj_wresp_noc[DIM_X][DIM_Y];
+  Connections::Combinational<rresp_flit_t>    chan_ej_rresp_noc[DIM_X][DIM_Y];
+  Connections::Combinational<rresp_flit_t>    chan_ej_wresp_noc[DIM_X][DIM_Y];
+  
+  // A crossing per local channel, [node][0:inj rd, 1:inj wr, 2:ej rd, 3:ej wr]
+  cdc_link<rreq_flit_t,  IC_CDC_DEPTH>  *cdc_req[DIM_X][DIM_Y][4];
+  cdc_link<rresp_flit_t, IC_CDC_DEPTH>  *cdc_resp[DIM_X][DIM_Y][4];
+#endif
   
   SC_CTOR(ic_top) {
     
@@ -215,7 +251,11 @@ public:
     for(int row=0; row<DIM_Y; ++row) {
       for (int col=0; col<DIM_X; ++col) {
         
+#ifdef IC_CDC
+        rtr_req[col][row].clk(clk_noc);
+#else
         rtr_req[col][row].clk(clk);
+#endif
         rtr_req[col][row].rst_n(rst_n);
         rtr_req[col][row].route_lut[0](route_lut[0][0]);
         rtr_req[col][row].id_x(rtr_id_x_req[col]);
@@ -233,11 +273,19 @@ public:
         rtr_req[col][row].data_in[3](chan_ver_down_req[col][row+1]);
         rtr_req[col][row].data_out[3](chan_ver_up_req[col][row+1]);
   
+#ifdef IC_CDC
+        rtr_req[col][row].data_in[4](chan_inj_rreq_noc[col][row]);
+        rtr_req[col][row].data_out[4](chan_ej_rreq_noc[col][row]);
+
+        rtr_req[col][row].data_in[5](chan_inj_wreq_noc[col][row]);
+        rtr_req[col][row].data_out[5](chan_ej_wreq_noc[col][row]);
+#else
         rtr_req[col][row].data_in[4](chan_inj_rreq[col][row]);
         rtr_req[col][row].data_out[4](chan_ej_rreq[col][row]);
 
         rtr_req[col][row].data_in[5](chan_inj_wreq[col][row]);
         rtr_req[col][row].data_out[5](chan_ej_wreq[col][row]);
+#endif
       }
     }
     
@@ -246,8 +294,12 @@ public:
     // Resp/Bck Router
     for(int row=0; row<DIM_Y; ++row) {
       for (int col=0; col<DIM_X; ++col) {
-        rtr_resp[col][row] = new router_wh_top< 4+2, 4+2, rresp_flit_t, 5, DIM_X> (sc_gen_unique_name("Router-resp"));
+        rtr_resp[col][row] = new router_wh_top< 4+2, 4+2, rresp_flit_t, 5, DIM_X, 1, arbiter<4+2, IC_ARB> > (sc_gen_unique_name("Router-resp"));
+#ifdef IC_CDC
+        rtr_resp[col][row]->clk(clk_noc);
+#else
         rtr_resp[col][row]->clk(clk);
+#endif
         rtr_resp[col][row]->rst_n(rst_n);
         rtr_resp[col][row]->route_lut[0](route_lut[0][0]);
         rtr_resp[col][row]->id_x(rtr_id_x_resp[col]);
@@ -265,14 +317,79 @@ public:
         rtr_resp[col][row]->data_in[3](chan_ver_down_resp[col][row+1]);
         rtr_resp[col][row]->data_out[3](chan_ver_up_resp[col][row+1]);
   
+#ifdef IC_CDC
+        rtr_resp[col][row]->data_in[4](chan_inj_rresp_noc[col][row]);
+        rtr_resp[col][row]->data_out[4](chan_ej_rresp_noc[col][row]);
+  
+        rtr_resp[col][row]->data_in[5](chan_inj_wresp_noc[col][row]);
+        rtr_resp[col][row]->data_out[5](chan_ej_wresp_noc[col][row]);
+#else
         rtr_resp[col][row]->data_in[4](chan_inj_rresp[col][row]);
         rtr_resp[col][row]->data_out[4](chan_ej_rresp[col][row]);
   
         rtr_resp[col][row]->data_in[5](chan_inj_wresp[col][row]);
         rtr_resp[col][row]->data_out[5](chan_ej_wresp[col][row]);
+#endif
+      }
+    }
+    
+#ifdef IC_CDC
+    // --- Clock Domain Crossings --- //
+    // Injection from clk to clk_noc, ejection from clk_noc to clk
+    for(int row=0; row<DIM_Y; ++row) {
+      for (int col=0; col<DIM_X; ++col) {
+        for (int c=0; c<4; ++c) {
+          bool inj = (c<2);
+          
+          cdc_req[col][row][c] = new cdc_link<rreq_flit_t, IC_CDC_DEPTH> (sc_gen_unique_name("CDC-req"));
+          cdc_req[col][row][c]->clk_wr(inj ? clk : clk_noc);
+          cdc_req[col][row][c]->clk_rd(inj ? clk_noc : clk);
+          cdc_req[col][row][c]->rst_n_wr(rst_n);
+          cdc_req[col][row][c]->rst_n_rd(rst_n);
+          
+          cdc_resp[col][row][c] = new cdc_link<rresp_flit_t, IC_CDC_DEPTH> (sc_gen_unique_name("CDC-resp"));
+          cdc_resp[col][row][c]->clk_wr(inj ? clk : clk_noc);
+          cdc_resp[col][row][c]->clk_rd(inj ? clk_noc : clk);
+          cdc_resp[col][row][c]->rst_n_wr(rst_n);
+          cdc_resp[col][row][c]->rst_n_rd(rst_n);
+        }
+        cdc_req[col][row][0]->data_in(chan_inj_rreq[col][row]);
+        cdc_req[col][row][0]->data_out(chan_inj_rreq_noc[col][row]);
+        cdc_req[col][row][1]->data_in(chan_inj_wreq[col][row]);
+        cdc_req[col][row][1]->data_out(chan_inj_wreq_noc[col][row]);
+        cdc_req[col][row][2]->data_in(chan_ej_rreq_noc[col][row]);
+        cdc_req[col][row][2]->data_out(chan_ej_rreq[col][row]);
+        cdc_req[col][row][3]->data_in(chan_ej_wreq_noc[col][row]);
+        cdc_req[col][row][3]->data_out(chan_ej_wreq[col][row]);
+        
+        cdc_resp[col][row][0]->data_in(chan_inj_rresp[col][row]);
+        cdc_resp[col][row][0]->data_out(chan_inj_rresp_noc[col][row]);
+        cdc_resp[col][row][1]->data_in(chan_inj_wresp[col][row]);
+        cdc_resp[col][row][1]->data_out(chan_inj_wresp_noc[col][row]);
+        cdc_resp[col][row][2]->data_in(chan_ej_rresp_noc[col][row]);
+        cdc_resp[col][row][2]->data_out(chan_ej_rresp[col][row]);
+        cdc_resp[col][row][3]->data_in(chan_ej_wresp_noc[col][row]);
+        cdc_resp[col][row][3]->data_out(chan_ej_wresp[col][row]);
       }
     }
+#endif
   }; // End of constructor
+  
+#ifndef __SYNTHESIS__
+  // Router utilization and stall counters, mapped to the mesh coordinates (col, row)
+  //   Ports 0:-X 1:+X 2:-Y 3:+Y 4:Local RD 5:Local WR
+  void end_of_simulation() {
+    std::cout << "\n--- Router Statistics ---\n";
+    for (unsigned row=0; row<DIM_Y; ++row) {
+      for (unsigned col=0; col<DIM_X; ++col) {
+        std::string coord = "(" + std::to_string(col) + "," + std::to_string(row) + ")";
+        rtr_req[col][row].stats.print(std::cout, "Router-req" + coord);
+        rtr_resp[col][row]->stats.print(std::cout, "Router-resp" + coord);
+      }
+    }
+    std::cout.flush();
+  };
+#endif
 
 private:
 }; // End of SC_MODULE
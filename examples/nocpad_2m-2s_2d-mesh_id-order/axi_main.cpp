@@ -1,4 +1,9 @@
 #include "./ic_top_2d.h"
+#ifdef IC_TLM
+  // Loosely-Timed model of the same interconnect. Build with : make sim_tlm
+  #include "../../src/ic_tlm.h"
+  typedef ic_tlm<smpl_cfg, ic_top::DIM_X, ic_top::DIM_Y> ic_tlm_top;
+#endif
 #include "../../tb/tb_axi_con/harness.h"
 
 sc_trace_file* trace_file_ptr;
@@ -19,7 +19,7 @@ template <
   unsigned char RD_LANES_   , unsigned char WR_LANES_,
   unsigned char RREQ_PHITS_ , unsigned char RRESP_PHITS_,
   unsigned char WREQ_PHITS_ , unsigned char WRESP_PHITS_,
-  unsigned char ORD_SCHEME_
+  unsigned char ORD_SCHEME_ , unsigned char SLV_OUTS_
 >
 struct cfg {
   static const unsigned char MASTER_NUM  = MASTER_NUM_;
@@ -31,10 +31,22 @@ struct cfg {
   static const unsigned char WREQ_PHITS  = WREQ_PHITS_;
   static const unsigned char WRESP_PHITS = WRESP_PHITS_;
   static const unsigned char ORD_SCHEME  = ORD_SCHEME_;
+  static const unsigned char SLV_OUTS    = SLV_OUTS_;
 };
 
+// Design space exploration overrides (-D at build time). Defaults are the example's configuration
+#ifndef IC_ORD_SCHEME
+#define IC_ORD_SCHEME 1
+#endif
+#ifndef IC_ARB
+#define IC_ARB MATRIX
+#endif
+#ifndef IC_SLV_OUTS
+#define IC_SLV_OUTS 3 // Outstanding transactions per Slave and direction, eg 32 for a DDR controller
+#endif
+
 // the used configuration. 2 Masters/Slaves, 64bit AXI, 2.4.4.1 phit flits
-typedef cfg<2, 2, 8, 8, 4, 4, 4, 4, 1> smpl_cfg;
+typedef cfg<2, 2, 8, 8, 4, 4, 4, 4, IC_ORD_SCHEME, IC_SLV_OUTS> smpl_cfg;
 
 SC_MODULE(ic_top) {
 public:
@@ -107,7 +119,7 @@ public:
   
   // --- NoC Channels ---
   // REQ Router + In/Out Channels
-  router_wh_top< 4+2, 4+2, rreq_flit_t, 5, DIM_X>   rtr_req[DIM_X][DIM_Y];
+  router_wh_top< 4+2, 4+2, rreq_flit_t, 5, DIM_X, 1, arbiter<4+2, IC_ARB> >   rtr_req[DIM_X][DIM_Y];
   
   Connections::Combinational<wreq_flit_t>    chan_hor_right_req[DIM_X+1][DIM_Y];
   Connections::Combinational<wreq_flit_t>    chan_hor_left_req[DIM_X+1][DIM_Y];
@@ -122,7 +134,7 @@ public:
   
   
   // RESP Router + In/Out Channels
-  router_wh_top< 4+2, 4+2, rresp_flit_t, 5, DIM_X>  *rtr_resp[DIM_X][DIM_Y];
+  router_wh_top< 4+2, 4+2, rresp_flit_t, 5, DIM_X, 1, arbiter<4+2, IC_ARB> >  *rtr_resp[DIM_X][DIM_Y];
   
   Connections::Combinational<rreq_flit_t>    chan_hor_right_resp[DIM_X+1][DIM_Y];
   Connections::Combinational<rreq_flit_t>    chan_hor_left_resp[DIM_X+1][DIM_Y];
@@ -246,7 +258,7 @@ public:
     // Resp/Bck Router
     for(int row=0; row<DIM_Y; ++row) {
       for (int col=0; col<DIM_X; ++col) {
-        rtr_resp[col][row] = new router_wh_top< 4+2, 4+2, rresp_flit_t, 5, DIM_X> (sc_gen_unique_name("Router-resp"));
+        rtr_resp[col][row] = new router_wh_top< 4+2, 4+2, rresp_flit_t, 5, DIM_X, 1, arbiter<4+2, IC_ARB> > (sc_gen_unique_name("Router-resp"));
         rtr_resp[col][row]->clk(clk);
         rtr_resp[col][row]->rst_n(rst_n);
         rtr_resp[col][row]->route_lut[0](route_lut[0][0]);
@@ -273,6 +285,22 @@ public:
       }
     }
   }; // End of constructor
+  
+#ifndef __SYNTHESIS__
+  // Router utilization and stall counters, mapped to the mesh coordinates (col, row)
+  //   Ports 0:-X 1:+X 2:-Y 3:+Y 4:Local RD 5:Local WR
+  void end_of_simulation() {
+    std::cout << "\n--- Router Statistics ---\n";
+    for (unsigned row=0; row<DIM_Y; ++row) {
+      for (unsigned col=0; col<DIM_X; ++col) {
+        std::string coord = "(" + std::to_string(col) + "," + std::to_string(row) + ")";
+        rtr_req[col][row].stats.print(std::cout, "Router-req" + coord);
+        rtr_resp[col][row]->stats.print(std::cout, "Router-resp" + coord);
+      }
+    }
+    std::cout.flush();
+  };
+#endif
 
 private:
 }; // End of SC_MODULE
@@ -19,7 +19,10 @@ template <
   unsigned char RD_LANES_   , unsigned char WR_LANES_,
   unsigned char RREQ_PHITS_ , unsigned char RRESP_PHITS_,
   unsigned char WREQ_PHITS_ , unsigned char WRESP_PHITS_,
-  unsigned char ORD_SCHEME_ , unsigned char VCS_
+  unsigned char ORD_SCHEME_ , unsigned char VCS_,
+  unsigned char BUFF_DEPTH_=3, unsigned char CR_COALESCE_=0,
+  unsigned char TCS_=1, unsigned char TC_MAP_=TC_MAP_NONE,
+  unsigned char DAMQ_SLOTS_=0, unsigned char DAMQ_RSV_=1
 >
 struct cfg {
   static const unsigned char MASTER_NUM  = MASTER_NUM_;
@@ -32,10 +35,63 @@ struct cfg {
   static const unsigned char WRESP_PHITS = WRESP_PHITS_;
   static const unsigned char ORD_SCHEME  = ORD_SCHEME_;
   static const unsigned char VCS  = VCS_;
+  static const unsigned char BUFF_DEPTH  = BUFF_DEPTH_;  // Router input buffer slots per VC, the credits of the IFs
+  static const unsigned char CR_COALESCE = CR_COALESCE_; // Coalesced credit return, 0 for a credit per message
+  static const unsigned char TCS         = TCS_;         // Traffic classes, a Request and a Response VC each
+  static const unsigned char TC_MAP      = TC_MAP_;      // The key of a request's class, see vc_tc_map.h
+  static const unsigned char DAMQ_SLOTS  = DAMQ_SLOTS_;  // Shared router input buffer of that many slots, 0 for a FIFO per VC
+  static const unsigned char DAMQ_RSV    = DAMQ_RSV_;    // Slots of the shared buffer reserved per VC
 };
 
+// Design space exploration overrides (-D at build time). Defaults are the example's configuration
+// Requests and Responses use VCs 0 and 1, thus IC_VCS must be at least 2.
+// IC_TCS traffic classes take the VC pairs 2*tc and 2*tc+1, thus IC_VCS>=2*IC_TCS. IC_TC_MAP picks the class,
+//   eg -DIC_VCS=4 -DIC_TCS=2 -DIC_TC_MAP=TC_MAP_TYPE keeps the reads apart from the write bursts
+// The IFs take their credits from the buffer depth. IC_CR_COALESCE>0 returns the credits in batches of that many
+// IC_DAMQ_SLOTS>0 shares that many slots per router input among the VCs, each VC holding at most IC_BUFF_DEPTH,
+//   eg -DIC_VCS=4 -DIC_BUFF_DEPTH=4 -DIC_DAMQ_SLOTS=8 has half the storage of the FIFOs, 4x4 slots
+// IC_EXPRESS>0 enables the routers' express bypass of straight hops, see router_vc.h. Pays off in larger meshes.
+//   The flits then carry the express mark, -DDNP_EXPRESS=1
+// IC_SA_ALLOC selects the switch allocator, SA_ISLIP of IC_SA_ITERS iterations or SA_WAVEFRONT. Not with IC_EXPRESS
+#ifndef IC_ORD_SCHEME
+#define IC_ORD_SCHEME 1
+#endif
+#ifndef IC_VCS
+#define IC_VCS 2
+#endif
+#ifndef IC_BUFF_DEPTH
+#define IC_BUFF_DEPTH 3
+#endif
+#ifndef IC_CR_COALESCE
+#define IC_CR_COALESCE 0
+#endif
+#ifndef IC_TCS
+#define IC_TCS 1
+#endif
+#ifndef IC_TC_MAP
+#define IC_TC_MAP TC_MAP_NONE
+#endif
+#ifndef IC_DAMQ_SLOTS
+#define IC_DAMQ_SLOTS 0
+#endif
+#ifndef IC_DAMQ_RSV
+#define IC_DAMQ_RSV 1
+#endif
+#ifndef IC_EXPRESS
+#define IC_EXPRESS 0
+#endif
+#ifndef IC_ARB
+#define IC_ARB MATRIX
+#endif
+#ifndef IC_SA_ALLOC
+#define IC_SA_ALLOC SA_SEPARABLE
+#endif
+#ifndef IC_SA_ITERS
+#define IC_SA_ITERS 2
+#endif
+
 // the used configuration. 2 Masters/Slaves, 64bit AXI, 2.4.4.1 phit flits
-typedef cfg<2, 2, 8, 8, 4, 4, 4, 4, 1, 2> smpl_cfg;
+typedef cfg<2, 2, 8, 8, 4, 4, 4, 4, IC_ORD_SCHEME, IC_VCS, IC_BUFF_DEPTH, IC_CR_COALESCE, IC_TCS, IC_TC_MAP, IC_DAMQ_SLOTS, IC_DAMQ_RSV> smpl_cfg;
 
 SC_MODULE(ic_top) {
 public:
@@ -48,7 +104,7 @@ public:
   typedef flit_dnp<smpl_cfg::WREQ_PHITS>  wreq_flit_t;
   typedef flit_dnp<smpl_cfg::WRESP_PHITS> wresp_flit_t;
     
-  typedef sc_uint<1> cr_t;
+  typedef vc_credits<smpl_cfg::VCS, smpl_cfg::BUFF_DEPTH, smpl_cfg::CR_COALESCE>::cr_t cr_t;
     
   static const unsigned DIM_X = 2;
   static const unsigned DIM_Y = 2;
@@ -172,7 +228,7 @@ public:
   
   // --- NoC Channels ---
   // REQ Router + In/Out Channels
-  rtr_vc< 4+2, 4+2, rreq_flit_t, DIM_X, 1, 2, 3, 5>   rtr_inst[DIM_X][DIM_Y];
+  rtr_vc< 4+2, 4+2, rreq_flit_t, DIM_X, 1, smpl_cfg::VCS, smpl_cfg::BUFF_DEPTH, 5, IC_ARB, false, 0, smpl_cfg::CR_COALESCE, smpl_cfg::DAMQ_SLOTS, smpl_cfg::DAMQ_RSV, IC_EXPRESS, IC_SA_ALLOC, IC_SA_ITERS>   rtr_inst[DIM_X][DIM_Y];
   
   Connections::Combinational<rreq_flit_t>    chan_hor_right_data[DIM_X+1][DIM_Y];
   Connections::Combinational<cr_t>           chan_hor_right_cr[DIM_X+1][DIM_Y];
@@ -413,6 +469,21 @@ public:
       }
     }
   }; // End of constructor
+  
+#ifndef __SYNTHESIS__
+  // Router utilization and stall counters, mapped to the mesh coordinates (col, row)
+  //   Ports 0:-X 1:+X 2:-Y 3:+Y 4:Local RD 5:Local WR
+  void end_of_simulation() {
+    std::cout << "\n--- Router Statistics ---\n";
+    for (unsigned row=0; row<DIM_Y; ++row) {
+      for (unsigned col=0; col<DIM_X; ++col) {
+        std::string coord = "(" + std::to_string(col) + "," + std::to_string(row) + ")";
+        rtr_inst[col][row].stats.print(std::cout, "Router" + coord);
+      }
+    }
+    std::cout.flush();
+  };
+#endif
 
 private:
 }; // End of SC_MODULE
@@ -15,6 +15,47 @@
 
 #pragma hls_design top
 
+// IC_DCT : Direct cache-to-cache transfer of snooped lines (ace_home DCT), the Snoop requests grow to 4 phits.
+//          The Master-IFs are always connected to the RD response router, their port simply idles without it.
+#ifndef IC_DCT
+  #define IC_DCT 0
+#endif
+// IC_MCAST_SNOOP : HOME sends a single multicast Snoop to the snooped Masters (ace_home MCAST_SNOOP),
+//                  replicated by the Snoop request router (router_wh_top RC_METHOD 8, LUT multicast)
+#ifndef IC_MCAST_SNOOP
+  #define IC_MCAST_SNOOP 0
+#endif
+// IC_HOME_TXN : In-flight coherent transactions of HOME (ace_home TXN_NUM, up to 8), 1 serializes every request
+#ifndef IC_HOME_TXN
+  #define IC_HOME_TXN 1
+#endif
+// IC_HOME_SF : Snoop filter entries of HOME (ace_home SF_ENTRIES, power of 2), 0 snoops every cached Master
+#ifndef IC_HOME_SF
+  #define IC_HOME_SF 0
+#endif
+// IC_HOME_WB : Write buffer entries of HOME (ace_home WB_NUM), 0 responds the Writes after Mem
+#ifndef IC_HOME_WB
+  #define IC_HOME_WB 0
+#endif
+// IC_SNP_OUTS : Snoops in flight to each cached Master (ace_master_if SNP_OUTS)
+#ifndef IC_SNP_OUTS
+  #define IC_SNP_OUTS 1
+#endif
+// IC_LLC_LINES : System cache lines of HOME, 0 disables it. IC_LLC_WAYS set associative, of IC_LLC_REPL replacement
+#ifndef IC_LLC_LINES
+  #define IC_LLC_LINES 0
+#endif
+#ifndef IC_LLC_WAYS
+  #define IC_LLC_WAYS 1
+#endif
+#ifndef IC_LLC_REPL
+  #define IC_LLC_REPL LLC_LRU
+#endif
+// IC_LITE_LINE_WR : ACE-Lite Masters send their whole line WriteUniques as WriteLineUnique (acelite_master_if LINE_WR)
+#ifndef IC_LITE_LINE_WR
+  #define IC_LITE_LINE_WR 0
+#endif
+
 // Bundle of configuration parameters
 template <
   unsigned char HOME_NUM_,
@@ -48,7 +89,7 @@ typedef cfg<1, 4, 0, 2,
             (ace::ace5<axi::cfg::ace>::C_CACHE_WIDTH < 64) ? 4 : (ace::ace5<axi::cfg::ace>::C_CACHE_WIDTH >> 4), //bits to phits
             (ace::ace5<axi::cfg::ace>::C_CACHE_WIDTH < 64) ? 4 : (ace::ace5<axi::cfg::ace>::C_CACHE_WIDTH >> 4), //bits to phits
             1,
-            3,
+            (IC_DCT ? 4 : 3),
             (ace::ace5<axi::cfg::ace>::C_CACHE_WIDTH < 64) ? 4 : (ace::ace5<axi::cfg::ace>::C_CACHE_WIDTH >> 4) //bits to phits
            > smpl_cfg;
 
@@ -104,10 +145,10 @@ public:
   
   //--- Internals ---//
   // Master/Slave IFs
-  ace_master_if     < smpl_cfg > *master_if[smpl_cfg::FULL_MASTER_NUM];
-  acelite_master_if < smpl_cfg > *master_lite_if[smpl_cfg::LITE_MASTER_NUM];
+  ace_master_if     < smpl_cfg, 0, IC_DCT, IC_SNP_OUTS > *master_if[smpl_cfg::FULL_MASTER_NUM];
+  acelite_master_if < smpl_cfg, 0, IC_LITE_LINE_WR > *master_lite_if[smpl_cfg::LITE_MASTER_NUM];
   ace_slave_if      < smpl_cfg > *slave_if[smpl_cfg::SLAVE_NUM];
-  ace_home          < smpl_cfg > *home[smpl_cfg::HOME_NUM];
+  ace_home          < smpl_cfg, IC_MCAST_SNOOP, IC_HOME_TXN, IC_HOME_SF, IC_DCT, IC_HOME_WB, IC_LLC_LINES, IC_LLC_WAYS, IC_LLC_REPL > *home[smpl_cfg::HOME_NUM];
   
   // NoC Channels
   // READ Fwd Req, master+home -> slaves+home
@@ -118,13 +159,14 @@ public:
   Connections::Combinational<rreq_flit_t>                                     chan_rd_req_r2h[smpl_cfg::HOME_NUM]; // M-IF_to_Rtr
   Connections::Combinational<rreq_flit_t>                                     chan_rd_req_h2r[smpl_cfg::HOME_NUM];  // Rtr_to_S-IF
   
-  // READ Bck Resp, slaves+home -> home+masters
+  // READ Bck Resp, slaves+home+masters(DCT) -> home+masters
   sc_signal<sc_uint<dnp::D_W> > route_rd_resp[NODES];
-  router_wh_top<smpl_cfg::SLAVE_NUM+smpl_cfg::HOME_NUM, smpl_cfg::ALL_MASTER_NUM+smpl_cfg::HOME_NUM, rresp_flit_t, 4, 0, NODES>  INIT_S1(rtr_rd_resp);
+  router_wh_top<smpl_cfg::SLAVE_NUM+smpl_cfg::HOME_NUM+smpl_cfg::FULL_MASTER_NUM, smpl_cfg::ALL_MASTER_NUM+smpl_cfg::HOME_NUM, rresp_flit_t, 4, 0, NODES>  INIT_S1(rtr_rd_resp);
   Connections::Combinational<rresp_flit_t>                                    chan_rd_s2r[smpl_cfg::SLAVE_NUM];  // S-IF_to_Rtr
   Connections::Combinational<rresp_flit_t>                                    chan_rd_r2m[smpl_cfg::ALL_MASTER_NUM]; // Rtr_to_M-IF
   Connections::Combinational<rresp_flit_t>                                    chan_rd_resp_r2h[smpl_cfg::HOME_NUM]; // M-IF_to_Rtr
   Connections::Combinational<rresp_flit_t>                                    chan_rd_resp_h2r[smpl_cfg::HOME_NUM];  // Rtr_to_S-IF
+  Connections::Combinational<rresp_flit_t>                                    chan_rd_dct_m2r[smpl_cfg::FULL_MASTER_NUM];  // M-IF_to_Rtr, direct transfers
   
   // WRITE fwd Req, Router+In/Out Channels
   sc_signal<sc_uint<dnp::D_W> > route_wr_req[NODES];
@@ -144,7 +186,7 @@ public:
   
   // CACHE fwd Req, Router+In/Out Channels
   sc_signal<sc_uint<dnp::D_W> > route_cache_req[NODES];
-  router_wh_top<smpl_cfg::HOME_NUM, smpl_cfg::FULL_MASTER_NUM, creq_flit_t, 4, 0, NODES>   INIT_S1(rtr_cache_req);
+  router_wh_top<smpl_cfg::HOME_NUM, smpl_cfg::FULL_MASTER_NUM, creq_flit_t, (IC_MCAST_SNOOP ? 8 : 4), 0, NODES>   INIT_S1(rtr_cache_req);
   Connections::Combinational<creq_flit_t>                                    chan_creq_h2r[smpl_cfg::HOME_NUM];  // Home_to_Rtr
   Connections::Combinational<creq_flit_t>                                    chan_creq_r2m[smpl_cfg::FULL_MASTER_NUM]; // Rtr_to_M-IF
   
@@ -199,7 +241,7 @@ public:
     // ------------------------------ //
     // Connect each Master-IF to the appropriate channels
     for(int i=0; i<smpl_cfg::FULL_MASTER_NUM; ++i){
-      master_if[i] = new ace_master_if < smpl_cfg > (sc_gen_unique_name("Master-if"));
+      master_if[i] = new ace_master_if < smpl_cfg, 0, IC_DCT, IC_SNP_OUTS > (sc_gen_unique_name("Master-if"));
       master_if[i]->clk(clk);
       master_if[i]->rst_n(rst_n);
       
@@ -235,11 +277,12 @@ public:
       // Cache-NoC
       master_if[i]->cache_flit_in(chan_creq_r2m[i]);
       master_if[i]->cache_flit_out(chan_cresp_m2r[i]);
+      master_if[i]->dct_flit_out(chan_rd_dct_m2r[i]);
     }
       
       // Connect ACE LITE Master-IFs to the appropriate channels
       for(int i=0; i<smpl_cfg::LITE_MASTER_NUM; ++i){
-        master_lite_if[i] = new acelite_master_if < smpl_cfg > (sc_gen_unique_name("Master-Lite-if"));
+        master_lite_if[i] = new acelite_master_if < smpl_cfg, 0, IC_LITE_LINE_WR > (sc_gen_unique_name("Master-Lite-if"));
         master_lite_if[i]->clk(clk);
         master_lite_if[i]->rst_n(rst_n);
         
@@ -270,7 +313,7 @@ public:
     // --- HOME-NODE(s) --- //
     // ---------------------//
     for (unsigned i=0; i<smpl_cfg::HOME_NUM; ++i) {
-      home[i] = new ace_home < smpl_cfg > (sc_gen_unique_name("Home-Node"));
+      home[i] = new ace_home < smpl_cfg, IC_MCAST_SNOOP, IC_HOME_TXN, IC_HOME_SF, IC_DCT, IC_HOME_WB, IC_LLC_LINES, IC_LLC_WAYS, IC_LLC_REPL > (sc_gen_unique_name("Home-Node"));
       home[i]->clk(clk);
       home[i]->rst_n(rst_n);
   
@@ -343,6 +386,7 @@ public:
     // In from Slaves
     for(int i=0; i<smpl_cfg::SLAVE_NUM; ++i)  rtr_rd_resp.data_in[i](chan_rd_s2r[i]);
     for(int i=0; i<smpl_cfg::HOME_NUM; ++i)   rtr_rd_resp.data_in[smpl_cfg::SLAVE_NUM+i](chan_rd_resp_h2r[i]);
+    for(int i=0; i<smpl_cfg::FULL_MASTER_NUM; ++i) rtr_rd_resp.data_in[smpl_cfg::SLAVE_NUM+smpl_cfg::HOME_NUM+i](chan_rd_dct_m2r[i]);
     // Out to Master
     for(int i=0; i<smpl_cfg::ALL_MASTER_NUM; ++i) rtr_rd_resp.data_out[i](chan_rd_r2m[i]);
     for(int i=0; i<smpl_cfg::HOME_NUM; ++i)       rtr_rd_resp.data_out[smpl_cfg::ALL_MASTER_NUM+i](chan_rd_resp_r2h[i]);
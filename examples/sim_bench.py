@@ -0,0 +1,189 @@
+#!/usr/bin/env python3
+"""Simulation speed benchmark of the NoCpad examples.
+
+Builds every example once per Connections simulation mode (SIM_MODE 1, the
+cycle-accurate ports, or 2, the faster TLM ones) at --cxxflags, runs it for a
+fixed budget of generated cycles (TB_GEN_CYCLES) and collects the simulated
+cycles and transactions per second of wall time and the peak resident memory
+that the harness reports (tb/sim_speed.h). Runs are sequential, as parallel
+ones would skew each other's timing, and each configuration keeps the best
+of --repeat runs to filter out the noise of the machine.
+
+The results are compared against a baseline file. A configuration slower than
+the baseline by more than --tol percent, or using more than --tol-rss percent
+extra memory, is a regression and fails the benchmark. Configurations missing
+from the baseline are added to it, --update replaces the stored ones.
+When both modes are run, the speed-up of SIM_MODE 2 over 1 is reported.
+
+Example:
+  ./sim_bench.py                                              # all examples, SIM_MODE 1
+  ./sim_bench.py -e nocpad_2m-2s_2d-mesh_basic-order --sim-mode 1 2 --cycles 20000
+  ./sim_bench.py --update                                     # accept the current speed as the baseline
+"""
+
+import argparse
+import hashlib
+import json
+import os
+import re
+import shlex
+import subprocess
+import sys
+
+EXAMPLES_DIR = os.path.dirname(os.path.abspath(__file__))
+
+RE_SPEED = re.compile(r'Sim speed\s+\(cycles/s, trans/s\)\s*:\s*(\S+),\s*(\S+)')
+RE_COST  = re.compile(r'Sim cost\s+\(wall s, cpu s, KB\)\s*:\s*(\S+),\s*(\S+),\s*(\S+)')
+
+METRICS = ['cycles_s', 'trans_s', 'wall_s', 'cpu_s', 'rss_kb']
+
+
+def all_examples():
+    return sorted(d for d in os.listdir(EXAMPLES_DIR)
+                  if os.path.isfile(os.path.join(EXAMPLES_DIR, d, 'Makefile')))
+
+
+def flags_tag(cxxflags):
+    """Short digest of the compiler flags, thus binaries of other flags are never reused"""
+    return hashlib.md5(cxxflags.encode()).hexdigest()[:8]
+
+
+def binary_name(mode, args):
+    return 'sim_bench_m%d_%s' % (mode, flags_tag(args.cxxflags))
+
+
+def build(example, mode, args):
+    # Always rebuilt (-B), a stale binary would be benchmarked as the current sources
+    cmd = ['make', '-B', '-C', os.path.join(EXAMPLES_DIR, example), 'SIM_BIN=' + binary_name(mode, args),
+           'SIM_MODE=%d' % mode, 'DSE_FLAGS=' + args.cxxflags]
+    if args.dry_run:
+        print(' '.join(shlex.quote(c) for c in cmd))
+        return True
+    res = subprocess.run(cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+    if res.returncode != 0:
+        sys.stderr.write('Build failed for %s SIM_MODE=%d\n%s\n' % (example, mode, res.stdout[-4000:]))
+    return res.returncode == 0
+
+
+def run(example, mode, args):
+    """A single run. Returns the metrics, or None with the failure status."""
+    env = dict(os.environ)
+    env['TB_GEN_CYCLES'] = str(args.cycles)
+    if args.dry_run:
+        print('TB_GEN_CYCLES=%d %s/%s' % (args.cycles, example, binary_name(mode, args)))
+        return None, 'DRY_RUN'
+    try:
+        res = subprocess.run(['./' + binary_name(mode, args)], cwd=os.path.join(EXAMPLES_DIR, example), env=env,
+                             stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                             universal_newlines=True, timeout=args.timeout)
+    except subprocess.TimeoutExpired:
+        return None, 'TIMEOUT'
+    out = res.stdout
+    speed, cost = RE_SPEED.search(out), RE_COST.search(out)
+    if '--- FAILED ---' in out:
+        return None, 'FAILED'
+    if res.returncode != 0 or not speed or not cost:
+        return None, 'ERROR(%d)' % res.returncode
+    vals = [float(v) for v in speed.groups() + cost.groups()]
+    return dict(zip(METRICS, vals)), 'PASSED'
+
+
+def best_of(example, mode, args):
+    best, status = None, None
+    for _ in range(args.repeat):
+        m, status = run(example, mode, args)
+        if m is None:
+            return None, status
+        if best is None or m['cycles_s'] > best['cycles_s']:
+            best = m
+    return best, status
+
+
+def compare(res, base, args):
+    """Verdict of a result against its baseline entry"""
+    if base is None:
+        return 'NEW'
+    if base.get('cycles') != args.cycles:
+        return 'NEW (budget was %s cycles)' % base.get('cycles')
+    if base.get('cxxflags') != args.cxxflags:
+        return 'NEW (built with %s)' % base.get('cxxflags')
+    verdict = []
+    if res['cycles_s'] < base['cycles_s'] * (1.0 - args.tol / 100.0):
+        verdict.append('REGRESSION speed')
+    if res['rss_kb'] > base['rss_kb'] * (1.0 + args.tol_rss / 100.0):
+        verdict.append('REGRESSION rss')
+    return ', '.join(verdict) if verdict else 'OK'
+
+
+def main():
+    p = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    p.add_argument('-e', '--examples', nargs='+', default=None, help='example directories. Default: all')
+    p.add_argument('--sim-mode', nargs='+', type=int, choices=[1, 2], default=[1],
+                   help='Connections simulation modes (SIM_MODE of the Makefiles)')
+    p.add_argument('--cycles', type=int, default=20000, help='transaction generation cycles (TB_GEN_CYCLES)')
+    p.add_argument('--repeat', type=int, default=3, help='runs per configuration, the fastest one is kept')
+    p.add_argument('--cxxflags', default='-O2', help='extra compiler flags of the benchmark binaries')
+    p.add_argument('--baseline', default=os.path.join(EXAMPLES_DIR, 'sim_bench_baseline.json'),
+                   help='baseline file of the reference results')
+    p.add_argument('--tol', type=float, default=10.0, help='tolerated slow down (%%)')
+    p.add_argument('--tol-rss', type=float, default=10.0, help='tolerated peak memory growth (%%)')
+    p.add_argument('--update', action='store_true', help='store the results as the new baseline')
+    p.add_argument('--timeout', type=int, default=None, help='per run timeout (sec)')
+    p.add_argument('-n', '--dry-run', action='store_true', help='print the commands only')
+    args = p.parse_args()
+
+    if args.repeat < 1:
+        p.error('--repeat : must be positive')
+    examples = args.examples or all_examples()
+
+    baseline = {}
+    if os.path.isfile(args.baseline):
+        with open(args.baseline) as f:
+            baseline = json.load(f)
+
+    results, bad = {}, []
+    print('%-45s %-4s %12s %12s %9s %10s : %s' % ('example', 'mode', 'cycles/s', 'trans/s', 'wall s', 'RSS KB', 'status'))
+    for example in examples:
+        for mode in args.sim_mode:
+            key = '%s/m%d' % (example, mode)
+            if not build(example, mode, args):
+                bad.append(key)
+                print('%-45s %-4d %s' % (example, mode, 'BUILD FAILED'))
+                continue
+            res, status = best_of(example, mode, args)
+            if res is None:
+                if status != 'DRY_RUN':
+                    bad.append(key)
+                print('%-45s %-4d %s' % (example, mode, status))
+                continue
+            res['cycles']   = args.cycles
+            res['cxxflags'] = args.cxxflags
+            results[key] = res
+            verdict = compare(res, baseline.get(key), args)
+            if verdict.startswith('REGRESSION'):
+                bad.append(key)
+            print('%-45s %-4d %12.0f %12.0f %9.2f %10.0f : %s'
+                  % (example, mode, res['cycles_s'], res['trans_s'], res['wall_s'], res['rss_kb'], verdict))
+
+    # Fast against accurate Connections ports
+    for example in examples:
+        m1, m2 = results.get('%s/m1' % example), results.get('%s/m2' % example)
+        if m1 and m2 and m1['cycles_s'] > 0:
+            print('%-45s SIM_MODE 2 speed-up : %.2fx' % (example, m2['cycles_s'] / m1['cycles_s']))
+
+    stored = 0
+    for key, res in results.items():
+        if args.update or key not in baseline or baseline[key].get('cycles') != args.cycles \
+                or baseline[key].get('cxxflags') != args.cxxflags:
+            baseline[key] = res
+            stored += 1
+    if stored and not args.dry_run:
+        with open(args.baseline, 'w') as f:
+            json.dump(baseline, f, indent=2, sort_keys=True)
+        print('%d results stored in %s' % (stored, args.baseline))
+
+    return 1 if bad else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -11,13 +11,53 @@
 #include "../include/ace.h"
 #include "../include/flit_ace.h"
 #include "../include/duth_fun.h"
+#include "../include/addr_dec.h"
+#include "../include/fifo_queue_oh.h"
+#include "../include/evt_trace.h"
+#include "../include/home_snp_log.h"
+
+// Replacement policies of the HOME's system cache
+enum llc_repl_type {LLC_LRU, LLC_FIFO, LLC_RAND};
 
 // --- HOME NODE ---
 // All coherent transactions are serialized to a HOME NODE.
 // HOME generates the apropriate Snoop requests and gathers their responses
 // Regarding the responses of the snooped masters, HOME decides if access to
 //   a main memory (i.e. Slave) is required for the transaction completion
-template <typename cfg>
+// HOME is split into 3 parallel stages, passing the transactions through FIFOs
+//   req_check    : Admits requests to the transaction table, sends Snoops and gathers their responses
+//   txn_complete : Accesses Mem if required, and responds to the initiator
+//   ack_check    : Waits for the final ACK of the initiator, and releases the table entry
+//   wb_drain     : (WB_NUM>0) Sends the buffered writes to Mem
+// Cache lines may span several flits (LINE_FLITS). The lines move a flit at a time, cut-through :
+//   - The data of a Write wait in the network until the Snoops of the transaction are done, then stream to Mem.
+//   - The line of the last Snoop response streams from cache_resp to the initiator, and to Mem when dirty.
+//     A line that arrives before the last response waits in the entry, as the response bits of the
+//     initiator are known only once all Snoops respond.
+//   - The line read from Mem streams to the initiator.
+// MCAST_SNOOP : Send a single multicast Snoop to all the masters, instead of one per master.
+//               The Snoop network must support multicast (i.e. router_wh_top RC_METHOD 8)
+// TXN_NUM     : In-flight coherent transactions (up to 8). Only requests to the same cache line
+//               are serialized, via an address match on the table (CAM). 1 serializes every request.
+// SF_ENTRIES  : Snoop filter entries (power of 2), 0 disables it. A direct mapped directory of the
+//               FULL masters that may hold a line. On a hit only the sharers are snooped, and when none
+//               holds the line Mem is accessed directly. On a miss all are snooped, and the entry is
+//               replaced by the gathered responses, thus dropping an entry never needs invalidations.
+// DCT         : Direct cache-to-cache transfer of Reads. A single snooped master, the first (or the only one of
+//               a multicast), may send the line straight to the initiator with the response header HOME passes in
+//               the Snoop, and HOME gets only the response. Any other line that reaches HOME then goes to Mem if
+//               dirty, or is dropped. Requires CREQ_PHITS>=4 and the masters' ace_master_if of DCT.
+// WB_NUM      : Write buffer entries, 0 disables it. The Writes, and the write-backs of dirty lines, are posted to
+//               a buffer of whole lines that drains to Mem in the background, one at a time. A Write is responded
+//               OKAY once its data are in the buffer, thus an error of Mem is not reported to its initiator.
+//               A Read from Mem waits until no buffered write targets its line.
+// LLC_LINES   : System cache lines, 0 disables it. A LLC_WAYS set associative cache in front of Mem, of LLC_REPL
+//  LLC_WAYS     replacement (llc_repl_type). Write-back and write-allocate for whole lines : it serves the line
+//  LLC_REPL     Reads that found no Snoop data, and absorbs the dirty lines and the Writes of whole lines, which
+//               are responded OKAY. A partial Write goes to Mem, after a dirty copy of its line is written back.
+//               The lines evicted dirty are written to Mem, through the write buffer when enabled.
+template <typename cfg, bool MCAST_SNOOP=false, unsigned char TXN_NUM=1, unsigned SF_ENTRIES=0, bool DCT=false, unsigned char WB_NUM=0,
+          unsigned LLC_LINES=0, unsigned char LLC_WAYS=1, unsigned char LLC_REPL=LLC_LRU>
 SC_MODULE(ace_home) {
   typedef typename ace::ace5<axi::cfg::ace> ace5_;
   typedef typename ace::ACE_Encoding        enc_;
@@ -34,8 +74,51 @@ SC_MODULE(ace_home) {
   typedef sc_uint< clog2<cfg::RRESP_PHITS>::val > cnt_phit_rresp_t;
   typedef sc_uint< clog2<cfg::WRESP_PHITS>::val > cnt_phit_wresp_t;
   
+  typedef sc_uint< clog2<TXN_NUM>::val > txn_id_t;
+  
   const unsigned char LOG_RD_M_LANES = nvhls::log2_ceil<cfg::RD_LANES>::val;
   const unsigned char LOG_WR_M_LANES = nvhls::log2_ceil<cfg::WR_LANES>::val;
+  // Address bits below the cache line, ignored by the address match
+  const unsigned char LOG_LINE_BYTES = nvhls::log2_ceil<ace5_::C_CACHE_WIDTH/8>::val;
+  static const unsigned SF_SIZE = (SF_ENTRIES>0) ? SF_ENTRIES : 1;
+  // Flits of a cache line, at 2 bytes per phit
+  static const unsigned LINE_FLITS = ((ace5_::C_CACHE_WIDTH/8) + (cfg::CRESP_PHITS<<1) - 1) / (cfg::CRESP_PHITS<<1);
+  static const unsigned WB_SIZE = (WB_NUM>0) ? WB_NUM : 1;
+  // System cache geometry. A line is kept as the 2 bytes of its phits, as it moves in the flits
+  static const unsigned LINE_B    = ace5_::C_CACHE_WIDTH/8;
+  static const unsigned LINE_PH   = LINE_FLITS*cfg::CRESP_PHITS;
+  static const unsigned LLC_SIZE  = (LLC_LINES>0) ? LLC_LINES : 1;
+  static const unsigned LLC_SETS  = (LLC_SIZE/LLC_WAYS>0) ? (LLC_SIZE/LLC_WAYS) : 1;
+  
+  // Transaction whose Snoops are completed. Passed from req_check to txn_complete
+  struct txn_info {
+    txn_id_t        id;
+    rreq_flit_t     req;                   // Initial request
+    cresp_flit_t    snp_data[LINE_FLITS];  // Line of an earlier Snoop response (Dirty takes precedence)
+    ace5_::CR::Resp resp_accum;
+    bool            got_data;
+    bool            got_dirty;
+    bool            stream;                // The line follows in snp_stream, instead of snp_data
+    bool            dct_done;              // A snooped master sent the line to the initiator
+    
+    inline friend std::ostream& operator << ( std::ostream& os, const txn_info& info ) {
+      os <<"TXN: "<< info.id <<", Req: "<< info.req <<", Resp: "<< info.resp_accum;
+      return os;
+    }
+  };
+  
+  // Transaction responded to its initiator. Passed from txn_complete to ack_check
+  struct ack_info {
+    txn_id_t          id;
+    sc_uint<dnp::S_W> initiator;
+    bool              is_read;
+    bool              wait_ack;  // Only a Full Master responds with an Ack
+    
+    inline friend std::ostream& operator << ( std::ostream& os, const ack_info& info ) {
+      os <<"TXN: "<< info.id <<", Init: "<< info.initiator <<", RD: "<< info.is_read <<", Wait: "<< info.wait_ack;
+      return os;
+    }
+  };
   
   sc_in_clk    clk;
   sc_in <bool> rst_n;
@@ -61,116 +144,396 @@ SC_MODULE(ace_home) {
   Connections::In<wresp_flit_t> INIT_S1(wr_from_slave);
   
   Connections::In<ack_flit_t> INIT_S1(ack_from_master);
-
+  
+  // --- Internals --- //
+  // FIFOs that pass the transactions between the stages
+  sc_fifo<txn_info> INIT_S1(snp_done);  // req_check    to txn_complete
+  sc_fifo<ack_info> INIT_S1(ack_wait);  // txn_complete to ack_check
+  sc_fifo<txn_id_t> INIT_S1(txn_fin);   // ack_check    to req_check
+  // The flits of the streamed lines, in the order of snp_done. req_check to txn_complete
+  sc_fifo<cresp_flit_t> INIT_S1(snp_stream); // Line of the last Snoop response
+  sc_fifo<wreq_flit_t>  INIT_S1(wr_stream);  // Data of a Write
+  // Write buffer, the header and line of each entry. txn_complete to wb_drain, and the drained entries back
+  sc_fifo<wreq_flit_t>  INIT_S1(wb_stream);
+  sc_fifo<bool>         INIT_S1(wb_fin);
+  
+  // Placed on req_check
+  bool          txn_valid[TXN_NUM];    // Transaction table. The line address acts as the CAM tag
+  ace5_::Addr   txn_line[TXN_NUM];
+  unsigned char txn_snp_wait[TXN_NUM]; // Snoop responses yet to be received
+  txn_info      txn_state[TXN_NUM];
+  sc_uint<cfg::FULL_MASTER_NUM> txn_sharers[TXN_NUM]; // Masters holding the line after the transaction
+  // Each master responds to its Snoops in order, thus keep the order they were sent to match the responses
+  fifo_queue<txn_id_t, TXN_NUM> snp_order[cfg::FULL_MASTER_NUM];
+  // Snoop filter
+  bool                          sf_valid[SF_SIZE];
+  ace5_::Addr                   sf_line[SF_SIZE];
+  sc_uint<cfg::FULL_MASTER_NUM> sf_sharers[SF_SIZE];
+  // The data of an admitted Write are next on wr_from_master. Its following Writes wait
+  bool                          wr_data_pend;
+  
+  // Placed on txn_complete. The lines of the buffered writes, drained in order from wb_head
+  bool          wb_valid[WB_SIZE];
+  ace5_::Addr   wb_line[WB_SIZE];
+  unsigned char wb_head;
+  unsigned char wb_tail;
+  // System cache, an entry per set and way (set*LLC_WAYS+way)
+  bool          llc_valid[LLC_SIZE];
+  bool          llc_dirty[LLC_SIZE];
+  ace5_::Addr   llc_line[LLC_SIZE];
+  sc_uint<16>   llc_data[LLC_SIZE][LINE_PH];
+  unsigned char llc_age[LLC_SIZE];   // LRU : 0 the most recent way of the set
+  unsigned char llc_rr[LLC_SETS];    // FIFO : the next way to replace
+  sc_uint<16>   llc_lfsr;            // RAND
+  
+#ifndef __SYNTHESIS__
+  // Simulation only event trace, admitted transactions and their acknowledges
+  evt_ring evt;
+#endif
   
   // Constructor
   SC_HAS_PROCESS(ace_home);
   ace_home(sc_module_name name_="ace_home")
     :
-    sc_module (name_)
+    sc_module (name_),
+    snp_done (TXN_NUM),
+    ack_wait (TXN_NUM),
+    txn_fin  (TXN_NUM),
+    snp_stream (2),
+    wr_stream  (2),
+    wb_stream  (WB_SIZE*(LINE_FLITS+1)),
+    wb_fin     (WB_SIZE)
   {
+    NVHLS_ASSERT_MSG((TXN_NUM>0) && (TXN_NUM<=8), "HOME supports 1 to 8 in-flight transactions.");
+    NVHLS_ASSERT_MSG((cfg::CRESP_PHITS==cfg::RRESP_PHITS) && (cfg::CRESP_PHITS==cfg::WREQ_PHITS), "HOME forwards the lines flit by flit, thus CRESP, RRESP and WREQ flits must be of the same phits.");
+    NVHLS_ASSERT_MSG(!DCT || (cfg::CREQ_PHITS>=4), "Direct transfers carry the response header in a 4th Snoop phit.");
+    NVHLS_ASSERT_MSG((SF_ENTRIES & (SF_ENTRIES-1))==0, "Snoop filter entries must be a power of 2.");
+    NVHLS_ASSERT_MSG((LLC_LINES==0) || ((LLC_WAYS>0) && ((LLC_LINES%LLC_WAYS)==0) && ((LLC_SETS & (LLC_SETS-1))==0)), "LLC lines must be a power of 2 sets of LLC_WAYS.");
+#ifndef __SYNTHESIS__
+    evt.init(this->name());
+#endif
+    
     SC_THREAD(req_check);
     sensitive << clk.pos();
     async_reset_signal_is(rst_n, false);
+    
+    SC_THREAD(txn_complete);
+    sensitive << clk.pos();
+    async_reset_signal_is(rst_n, false);
+    
+    SC_THREAD(ack_check);
+    sensitive << clk.pos();
+    async_reset_signal_is(rst_n, false);
+    
+    if (WB_NUM>0) {
+      SC_THREAD(wb_drain);
+      sensitive << clk.pos();
+      async_reset_signal_is(rst_n, false);
+    }
   }
   
-  
+  //--------------------------------------//
+  //--- Request admission and Snooping ---//
+  //--------------------------------------//
   void req_check () {
     cache_req.Reset();
     cache_resp.Reset();
     rd_from_master.Reset();
-    rd_to_master.Reset();
-    rd_to_slave.Reset();
-    rd_from_slave.Reset();
-    
     wr_from_master.Reset();
-    wr_to_master.Reset();
-    wr_to_slave.Reset();
-    wr_from_slave.Reset();
     
+    #pragma hls_unroll yes
+    for (int t=0; t<TXN_NUM; ++t) txn_valid[t] = false;
+    #pragma hls_unroll yes
+    for (int m=0; m<cfg::FULL_MASTER_NUM; ++m) snp_order[m].reset();
+    for (int e=0; e<SF_SIZE; ++e) sf_valid[e] = false;
+    wr_data_pend = false;
+    
+    rreq_flit_t flit_req_rcv;
+    bool        has_req     = false; // Got a request that waits to be admitted
+    
+    creq_flit_t                     flit_snoop;
+    bool                            issuing    = false; // Snoops of issue_txn are being sent
+    txn_id_t                        issue_txn  = 0;
+    sc_uint<cfg::FULL_MASTER_NUM>   issue_mask = 0;     // FULL Masters still to be snooped
     //-- End of Reset ---//
-
+    
+    wait();
     while(1) {
-      wait();
+      // Completed transactions release their table entry
+      txn_id_t fin_id;
+      if (txn_fin.nb_read(fin_id)) txn_valid[fin_id] = false;
+      
       // Initial Request
-      // Wait until a read or write request is received
-      rreq_flit_t flit_req_rcv;
-      bool got_new_req = false;
-      do {
-        if (!got_new_req) got_new_req = wr_from_master.PopNB(flit_req_rcv);
-        if (!got_new_req) got_new_req = rd_from_master.PopNB(flit_req_rcv);
-        wait();
-      } while (!got_new_req);
+      // The data of a Write follow its header, and stay in the network until its Snoops are done
+      if (!has_req) {
+        if (!wr_data_pend) has_req = wr_from_master.PopNB(flit_req_rcv);
+        if (!has_req)      has_req = rd_from_master.PopNB(flit_req_rcv);
+      }
+      bool is_wr_req = (flit_req_rcv.get_type() == dnp::PACK_TYPE__WR_REQ);
       
-      // Check who initiated the transaction the the type of transaction
-      ace5_::AddrPayload  cur_req;
-      unsigned initiator = flit_req_rcv.get_src();
-      bool     is_read   = (flit_req_rcv.get_type() == dnp::PACK_TYPE__RD_REQ);
-      bool     is_write  = (flit_req_rcv.get_type() == dnp::PACK_TYPE__WR_REQ);
-      NVHLS_ASSERT_MSG(is_read ^ is_write , "ERROR : Home got request of wrong type.");
-      flit_req_rcv.get_rd_req(cur_req);
+      // Admit the request in a free entry, if no in-flight transaction targets the same line
+      if (has_req && !issuing) {
+        ace5_::AddrPayload cur_req;
+        flit_req_rcv.get_rd_req(cur_req);
+        ace5_::Addr cur_line = cur_req.addr >> LOG_LINE_BYTES;
+        
+        bool     line_busy = false;
+        bool     got_free  = false;
+        txn_id_t free_id   = 0;
+        #pragma hls_unroll yes
+        for (int t=0; t<TXN_NUM; ++t) {
+          if (txn_valid[t] && (txn_line[t]==cur_line)) line_busy = true;
+          if (!txn_valid[t] && !got_free) {
+            free_id  = t;
+            got_free = true;
+          }
+        }
+        
+        if (!line_busy && got_free) {
+          // Check who initiated the transaction the the type of transaction
+          unsigned initiator = flit_req_rcv.get_src();
+          bool     is_read   = (flit_req_rcv.get_type() == dnp::PACK_TYPE__RD_REQ);
+          NVHLS_ASSERT_MSG(is_read ^ is_wr_req , "ERROR : Home got request of wrong type.");
+          
+          if(is_read) EVT_TRACE(EVT_LVL_TXN, evt, EVT_HOME_RD, free_id.to_uint(), cur_req.addr.to_uint64(), initiator,
+                                std::cout << "[HOME "<< THIS_ID <<"] Got RD from " << initiator << " : " << cur_req << " @" << sc_time_stamp() << "\n");
+          else        EVT_TRACE(EVT_LVL_TXN, evt, EVT_HOME_WR, free_id.to_uint(), cur_req.addr.to_uint64(), initiator,
+                                std::cout << "[HOME "<< THIS_ID <<"] Got WR from " << initiator << " : " << cur_req << " @" << sc_time_stamp() << "\n");
+          NVHLS_ASSERT_MSG(((flit_req_rcv.data[0].to_uint() >> dnp::D_PTR) & ((1<<dnp::D_W)-1)) == (THIS_ID.read().to_uint()), "Flit misrouted!");
+          
+          txn_valid[free_id] = true;
+          txn_line[free_id]  = cur_line;
+          txn_state[free_id].id         = free_id;
+          txn_state[free_id].req        = flit_req_rcv;
+          txn_state[free_id].resp_accum = 0;
+          txn_state[free_id].got_data   = false;
+          txn_state[free_id].got_dirty  = false;
+          txn_state[free_id].stream     = false;
+          txn_state[free_id].dct_done   = false;
+          if (is_wr_req) wr_data_pend = true;
+          
+          // Build the appropriate Snoop request for the cached FULL ACE Masters, depending the coherent access
+          ace5_::AC snoop_req;
+          snoop_req.addr  = cur_req.addr;
+          snoop_req.snoop = is_read ? ace::rd_2_snoop(cur_req.snoop) : ace::wr_2_snoop(cur_req.snoop);
+          snoop_req.prot  = initiator;
+          
+          flit_snoop.type = SINGLE; // Entire request fits in single flits thus SINGLE
+          flit_snoop.set_network(THIS_ID, 0, 0, (is_read ? dnp::PACK_TYPE__RD_REQ : dnp::PACK_TYPE__WR_REQ), 0);
+          flit_snoop.set_snoop_req(snoop_req);
+          
+          // Every FULL Master is snooped except the initiator, or only the sharers on a Snoop filter hit
+          // Depending the initiating master (Lite or Full Ace) different number of responses are expected
+          sc_uint<cfg::FULL_MASTER_NUM> init_mask = 0;
+          #pragma hls_unroll yes
+          for (int m=0; m<cfg::FULL_MASTER_NUM; ++m) {
+            init_mask[m] = ((m+cfg::SLAVE_NUM) == initiator);
+          }
+          unsigned sf_idx = cur_line & (SF_SIZE-1);
+          bool     sf_hit = (SF_ENTRIES>0) && sf_valid[sf_idx] && (sf_line[sf_idx]==cur_line);
+          issue_mask = sf_hit ? (sc_uint<cfg::FULL_MASTER_NUM>)(sf_sharers[sf_idx] & ~init_mask) : (sc_uint<cfg::FULL_MASTER_NUM>)(~init_mask);
+          // A reading initiator caches the line. Otherwise it keeps it only if it may already had it
+          bool init_keeps = is_read || !sf_hit || ((sf_sharers[sf_idx] & init_mask)!=0);
+          txn_sharers[free_id] = init_keeps ? init_mask : (sc_uint<cfg::FULL_MASTER_NUM>)0;
+          
+          unsigned char snp_cnt = 0;
+          #pragma hls_unroll yes
+          for (int m=0; m<cfg::FULL_MASTER_NUM; ++m) {
+            if (issue_mask[m]) snp_cnt++;
+          }
+          txn_snp_wait[free_id] = snp_cnt;
+#ifndef __SYNTHESIS__
+          home_snp_log::record(cur_req.addr.to_uint64(), initiator, issue_mask.to_uint());
+#endif
+          
+          // A Read that expects data may be served by the first snooped master. A multicast only when it is the only one
+          bool dct_snp = DCT && is_read && req_expects_data(cur_req.snoop, is_read) && (!MCAST_SNOOP || (snp_cnt==1));
+          flit_snoop.set_snoop_dct(dct_snp, (snp_cnt==1), initiator, cur_req);
+          issue_txn = free_id;
+          issuing   = true;
+          has_req   = false;
+        }
+      }
       
-      #ifndef __SYNTHESIS__
-      if(is_read) std::cout << "[HOME "<< THIS_ID <<"] Got RD from " << initiator << " : " << cur_req << " @" << sc_time_stamp() << "\n";
-      else        std::cout << "[HOME "<< THIS_ID <<"] Got WR from " << initiator << " : " << cur_req << " @" << sc_time_stamp() << "\n";
-      #endif
-      NVHLS_ASSERT_MSG(((flit_req_rcv.data[0].to_uint() >> dnp::D_PTR) & ((1<<dnp::D_W)-1)) == (THIS_ID.read().to_uint()), "Flit misrouted!");
-  
-      // Build the appropriate Snoop request for the cached FULL ACE Masters, depending the coherent access
-      ace5_::AC snoop_req;
-      snoop_req.addr  = cur_req.addr;
-      snoop_req.snoop = is_read ? ace::rd_2_snoop(cur_req.snoop) : ace::wr_2_snoop(cur_req.snoop);
-      snoop_req.prot  = initiator;
-  
-      creq_flit_t flit_snoop;
-      flit_snoop.type = SINGLE; // Entire request fits in single flits thus SINGLE
-      flit_snoop.set_network(THIS_ID, 0, 0, (is_read ? dnp::PACK_TYPE__RD_REQ : dnp::PACK_TYPE__WR_REQ), 0);
-      flit_snoop.set_snoop_req(snoop_req);
-  
-      // Send the Snoop requests to the masters. This can exploit multicast capabilities of the routers
-      for (int i=cfg::SLAVE_NUM; i<cfg::SLAVE_NUM+cfg::FULL_MASTER_NUM; ++i) {
-        if(i!=initiator) {
-          flit_snoop.set_dst(i);
-          cache_req.Push(flit_snoop);
-          wait();
+      // Send the Snoop requests to the masters. Either a single multicast or one per cycle
+      // Non-blocking, to keep gathering the responses of the rest transactions
+      if (issuing) {
+        if (issue_mask==0) {
+          issuing = false;
+        } else if (MCAST_SNOOP) {
+          sc_uint<dnp::MC_W> mcast_dst = 0;
+          #pragma hls_unroll yes
+          for (int m=0; m<cfg::FULL_MASTER_NUM; ++m) {
+            mcast_dst[m+cfg::SLAVE_NUM] = issue_mask[m];
+          }
+          flit_snoop.set_mcast_dst(mcast_dst);
+          if (cache_req.PushNB(flit_snoop)) {
+            #pragma hls_unroll yes
+            for (int m=0; m<cfg::FULL_MASTER_NUM; ++m) {
+              if (issue_mask[m]) snp_order[m].push(issue_txn);
+            }
+            issue_mask = 0;
+            issuing    = false;
+          }
+        } else {
+          bool          got_nxt = false;
+          unsigned char nxt_m   = 0;
+          #pragma hls_unroll yes
+          for (int m=0; m<cfg::FULL_MASTER_NUM; ++m) {
+            if (issue_mask[m] && !got_nxt) {
+              nxt_m   = m;
+              got_nxt = true;
+            }
+          }
+          flit_snoop.set_dst(nxt_m+cfg::SLAVE_NUM);
+          if (cache_req.PushNB(flit_snoop)) {
+            snp_order[nxt_m].push(issue_txn);
+            issue_mask[nxt_m] = 0;
+            flit_snoop.data[2][dnp::ace::creq::C_DCT_PTR] = 0; // The rest send their lines to HOME
+            issuing = (issue_mask!=0);
+          }
+        }
+        // All Snoops are sent. The transaction may have already gathered its responses
+        if (!issuing && (txn_snp_wait[issue_txn]==0)) {
+          snoops_done(issue_txn);
+          wr_data_fwd(issue_txn);
         }
       }
       
-      // Depending the initiating master (Lite or Full Ace) different number of request/repsonses are expected
-      bool init_is_full  = (initiator<(cfg::SLAVE_NUM+cfg::FULL_MASTER_NUM));
-      unsigned resp_wait = init_is_full ? cfg::FULL_MASTER_NUM-1 : cfg::FULL_MASTER_NUM;
-      // Wait until all responses are received
-      cresp_flit_t snoop_resp_data;
-      ace5_::CR::Resp resp_accum = 0;
-      bool got_data  = false;
-      bool got_dirty = false;
-      while (resp_wait) {
-        cresp_flit_t flit_rcv_snoop_resp = cache_resp.Pop();
+      // Gather the Snoop responses
+      cresp_flit_t flit_rcv_snoop_resp;
+      if (cache_resp.PopNB(flit_rcv_snoop_resp)) {
         NVHLS_ASSERT_MSG((flit_rcv_snoop_resp.type == HEAD || flit_rcv_snoop_resp.type == SINGLE), "Snoop Responce Must be at HEAD/SINGLE flit.");
+        unsigned snooped = flit_rcv_snoop_resp.get_src() - cfg::SLAVE_NUM;
+        NVHLS_ASSERT_MSG(!snp_order[snooped].empty(), "Got unexpected Snoop response.");
+        txn_id_t rsp_id = snp_order[snooped].pop();
         
         // Each response is checked if it contains data and accumulate the response to conclude to an action
         ace5_::CR::Resp cur_snoop_resp;
         cur_snoop_resp = (flit_rcv_snoop_resp.data[0] >> dnp::ace::cresp::C_RESP_PTR) & ((1<<dnp::ace::C_RESP_W)-1);
-        bool has_data  = cur_snoop_resp & 0x1;
-        bool has_dirty = cur_snoop_resp & 0x4;
-        if (has_data) {
-          if (has_dirty || !got_data) {
-            snoop_resp_data = cache_resp.Pop();  // Get data
-            NVHLS_ASSERT_MSG((snoop_resp_data.type == TAIL), "Currently a single flit cache line is supported!");
-          } else {
-            cresp_flit_t drop_data = cache_resp.Pop();                    // Already got Data, thus drop any other
-            NVHLS_ASSERT_MSG((drop_data.type == TAIL), "Currently a single flit cache line is supported!" );
+        // A DataTransfer without a following line was sent to the initiator (DCT)
+        bool has_data  = (flit_rcv_snoop_resp.data[0] >> dnp::ace::cresp::C_HAS_DATA_PTR) & 0x1;
+        bool has_dirty = has_data && (cur_snoop_resp & 0x4);
+        bool dct_sent  = DCT && (cur_snoop_resp & 0x1) && !has_data;
+        // Already got Data, thus drop any other
+        bool keep_data = has_data && (has_dirty || !txn_state[rsp_id].got_data);
+        txn_state[rsp_id].resp_accum |= cur_snoop_resp;
+        txn_state[rsp_id].got_dirty  |= has_dirty;
+        txn_state[rsp_id].got_data   |= has_data;
+        txn_state[rsp_id].dct_done   |= dct_sent;
+        txn_sharers[rsp_id][snooped] = ((cur_snoop_resp & 0x8) != 0); // IsShared : The Master retains the line
+        txn_snp_wait[rsp_id]--;
+        
+        bool last_resp = (txn_snp_wait[rsp_id]==0) && !(issuing && (issue_txn==rsp_id));
+        if (keep_data && last_resp) {
+          // The transaction completes with this response, thus its line streams behind it
+          txn_state[rsp_id].stream = true;
+          snoops_done(rsp_id);
+          cresp_flit_t line_flit;
+          do {
+            line_flit = cache_resp.Pop();
+            snp_stream.write(line_flit);
+          } while (line_flit.type != TAIL);
+          wr_data_fwd(rsp_id);
+        } else {
+          if (has_data) {
+            cresp_flit_t  line_flit;
+            unsigned char line_ptr = 0;
+            do {
+              line_flit = cache_resp.Pop();
+              NVHLS_ASSERT_MSG(line_ptr<LINE_FLITS, "Snoop line longer than LINE_FLITS.");
+              if (keep_data) txn_state[rsp_id].snp_data[line_ptr] = line_flit;
+              line_ptr++;
+            } while (line_flit.type != TAIL);
+          }
+          if (last_resp) {
+            snoops_done(rsp_id);
+            wr_data_fwd(rsp_id);
           }
         }
-        resp_accum |= cur_snoop_resp;
-        got_dirty  |= cur_snoop_resp & 0x4;
-        got_data   |= cur_snoop_resp & 0x1;
-        resp_wait--;
       }
       
-      // If initiator demands clean, update Mem in case of dirty line
-      bool update_mem = req_denies_dirty(cur_req.snoop, is_read);
-      if (got_dirty && update_mem) {
+      wait();
+    } // End of while(1)
+  }; // End of req_check
+  
+  // All Snoop responses of a transaction are gathered. Update the Snoop filter and pass it for completion
+  inline void snoops_done(txn_id_t id) {
+    if (SF_ENTRIES>0) {
+      unsigned sf_idx    = txn_line[id] & (SF_SIZE-1);
+      sf_valid[sf_idx]   = true;
+      sf_line[sf_idx]    = txn_line[id];
+      sf_sharers[sf_idx] = txn_sharers[id];
+    }
+    snp_done.write(txn_state[id]);
+  };
+  
+  // The data of a completed Write stream to txn_complete, as it forwards them to Mem. After any Snoop line,
+  // as txn_complete writes the dirty line to Mem first
+  inline void wr_data_fwd(txn_id_t id) {
+    if (txn_state[id].req.get_type() == dnp::PACK_TYPE__WR_REQ) {
+      wreq_flit_t wr_flit;
+      do {
+        wr_flit = wr_from_master.Pop();
+        wr_stream.write(wr_flit);
+      } while (wr_flit.type != TAIL);
+      wr_data_pend = false;
+    }
+  };
+  
+  //----------------------------------//
+  //--- Memory access and Response ---//
+  //----------------------------------//
+  void txn_complete () {
+    rd_to_master.Reset();
+    rd_to_slave.Reset();
+    rd_from_slave.Reset();
+    
+    wr_to_master.Reset();
+    if (WB_NUM==0) { // Otherwise owned by wb_drain
+      wr_to_slave.Reset();
+      wr_from_slave.Reset();
+    }
+    #pragma hls_unroll yes
+    for (int w=0; w<WB_SIZE; ++w) wb_valid[w] = false;
+    wb_head = 0;
+    wb_tail = 0;
+    for (int e=0; e<LLC_SIZE; ++e) {
+      llc_valid[e] = false;
+      llc_dirty[e] = false;
+      llc_age[e]   = e % LLC_WAYS;
+    }
+    for (int s=0; s<LLC_SETS; ++s) llc_rr[s] = 0;
+    llc_lfsr = 1;
+    //-- End of Reset ---//
+    
+    while(1) {
+      wait();
+      txn_info cur_txn;
+      while (!snp_done.nb_read(cur_txn)) {
+        wait();
+        wb_retire();
+      }
+      
+      rreq_flit_t        flit_req_rcv = cur_txn.req;
+      ace5_::AddrPayload cur_req;
+      flit_req_rcv.get_rd_req(cur_req);
+      unsigned     initiator    = flit_req_rcv.get_src();
+      bool         is_read      = (flit_req_rcv.get_type() == dnp::PACK_TYPE__RD_REQ);
+      bool         init_is_full = (initiator<(cfg::SLAVE_NUM+cfg::FULL_MASTER_NUM));
+      
+      ace5_::CR::Resp resp_accum      = cur_txn.resp_accum;
+      bool            got_data        = cur_txn.got_data;
+      bool            got_dirty       = cur_txn.got_dirty;
+      bool            dct_done        = DCT && cur_txn.dct_done; // The initiator got the line from a snooped master
+      bool            data_expected   = is_read && req_expects_data(cur_req.snoop, is_read) && !dct_done;
+      bool            from_mem        = data_expected && !got_data; //  Didn't get data response, thus ask memory
+      
+      // If initiator demands clean, update Mem in case of dirty line. Also when it got another line directly
+      // A WriteLineUnique overwrites the whole line, thus a dirty copy is dropped
+      bool line_wr    = !is_read && (cur_req.snoop == enc_::AWSNOOP::WR_LINE_UNIQUE);
+      bool update_mem = got_dirty && (req_denies_dirty(cur_req.snoop, is_read) || dct_done) && !line_wr;
+      if (update_mem) {
         unsigned mem_to_write = addr_lut(cur_req.addr);
         wreq_flit_t mem_upd_flit;
         mem_upd_flit.type = HEAD;
@@ -178,93 +541,441 @@ SC_MODULE(ace_home) {
         mem_upd_flit.data[1] = flit_req_rcv.data[1];
         mem_upd_flit.data[2] = flit_req_rcv.data[2];
         mem_upd_flit.set_network(THIS_ID, mem_to_write, 0, dnp::PACK_TYPE__C_WR_REQ, 0);
-        
-        wr_to_slave.Push(mem_upd_flit);
-        #pragma hls_unroll yes
-        for (int i=0; i<cfg::WREQ_PHITS; ++i) {
-          mem_upd_flit.data[i] = snoop_resp_data.data[i] | (((sc_uint<dnp::PHIT_W>)3) << dnp::ace::wdata::E0_PTR);
+        if (LLC_LINES==0) { // Otherwise the line is kept dirty in the LLC
+          wb_alloc(cur_req.addr >> LOG_LINE_BYTES);
+          mem_wr(mem_upd_flit);
         }
-        mem_upd_flit.type = TAIL;
-        wr_to_slave.Push(mem_upd_flit);
-        wr_from_slave.Pop(); // ToDo : Maybe error handling
         
         resp_accum = resp_accum & 0x1B; // Drop Pass Dirty bit as it got writen in Mem
       }
       
-      if (is_read) {
-        bool data_are_expected = req_expects_data(cur_req.snoop, is_read);
+      ace5_::Addr cur_line = cur_req.addr >> LOG_LINE_BYTES;
+      sc_uint<16> line_buf[LINE_PH]; // A line on its way to the LLC
+      if (is_read && !dct_done) {
+        // A line Read that hits the LLC is served from it. A dirty copy must reach Mem before a partial Read
+        bool     llc_serve = false;
+        unsigned llc_ent   = 0;
+        if (from_mem && (LLC_LINES>0)) {
+          bool llc_hit = llc_lookup(cur_line, llc_ent);
+          llc_serve = llc_hit && llc_line_req(cur_req);
+          if (llc_hit && !llc_serve && llc_dirty[llc_ent]) llc_flush(llc_ent);
+        }
         // After responces are gathered, either respond to initiating master, or ask Main_mem/LLC
-        if (data_are_expected) {
-          // After responces are gathered, either respond to initiating master, or ask Main_mem/LLC
-          if (!got_data) { //  Didn't get data response, thus  ask memory
-            //  Didn't get data response, thus  ask memory
-            unsigned mem_to_req = addr_lut(cur_req.addr);
-            flit_req_rcv.set_network(THIS_ID, mem_to_req, 0, dnp::PACK_TYPE__C_RD_REQ, 0);
-      
-            rd_to_slave.Push(flit_req_rcv);
-      
-            rd_from_slave.Pop(); // Drop the header
-      
-            snoop_resp_data = rd_from_slave.Pop();
-            resp_accum = ((snoop_resp_data.data[0] >> dnp::ace::rdata::RE_PTR) & 0x3) | (resp_accum & 0xC);
-          } else {
-            resp_accum = resp_accum & 0xE; // MASK WasUnique and HasData. Easily creating the R resp from CR resp
-          }
-          #pragma hls_unroll yes
-          for (int i=0; i<cfg::RRESP_PHITS; ++i) {
-            snoop_resp_data.data[i] |= snoop_resp_data.data[i] | (((sc_uint<dnp::PHIT_W>)resp_accum) << dnp::ace::rdata::RE_PTR);
+        if (from_mem && !llc_serve) {
+          unsigned mem_to_req = addr_lut(cur_req.addr);
+          flit_req_rcv.set_network(THIS_ID, mem_to_req, 0, dnp::PACK_TYPE__C_RD_REQ, 0);
+          // A buffered write to the line must reach Mem first
+          while (wb_hit(cur_line)) {
+            wait();
+            wb_retire();
           }
-        } else {
-          // Master does not expect Data, thus build empty data+response And write any data received to Mem
+          rd_to_slave.Push(flit_req_rcv);
+          rd_from_slave.Pop(); // Drop the header
+        } else if (!from_mem) {
           resp_accum = resp_accum & 0xE; // MASK WasUnique and HasData. Easily creating the R resp from CR resp
-          #pragma hls_unroll yes
-          for (int i=0; i<cfg::RRESP_PHITS; ++i) {
-            snoop_resp_data.data[i] = (((sc_uint<dnp::PHIT_W>) resp_accum) << dnp::ace::rdata::RE_PTR);
-          }
-          snoop_resp_data.type = TAIL;
         }
         // Build and send reponse packet
         rresp_flit_t flit_resp_to_init;
         flit_resp_to_init.type  = HEAD;
         flit_resp_to_init.set_network(THIS_ID, initiator, 0, dnp::PACK_TYPE__C_RD_RESP, 0);
         flit_resp_to_init.set_rd_resp(cur_req);
-  
         rd_to_master.Push(flit_resp_to_init); // Send Header flit
-        rd_to_master.Push(snoop_resp_data);   // Send Data. IsSHared and IsDirty are expected to be 0
-      } else {
+        
+        if (!data_expected) {
+          // Master does not expect Data, thus build empty data+response. Any data received go to Mem
+          rresp_flit_t flit_no_data;
+          #pragma hls_unroll yes
+          for (int i=0; i<cfg::RRESP_PHITS; ++i) {
+            flit_no_data.data[i] = (((sc_uint<dnp::PHIT_W>) resp_accum) << dnp::ace::rdata::RE_PTR);
+          }
+          flit_no_data.type = TAIL;
+          rd_to_master.Push(flit_no_data);
+        } else if (llc_serve) {
+          llc_touch(llc_ent);
+          for (unsigned f=0; f<LINE_FLITS; ++f) {
+            rresp_flit_t llc_flit;
+            #pragma hls_unroll yes
+            for (int i=0; i<cfg::RRESP_PHITS; ++i) {
+              llc_flit.data[i] = ((sc_uint<dnp::PHIT_W>)llc_data[llc_ent][f*cfg::RRESP_PHITS+i]) |
+                                 (((sc_uint<dnp::PHIT_W>)(resp_accum & 0xC)) << dnp::ace::rdata::RE_PTR);
+            }
+            llc_flit.type = (f==(LINE_FLITS-1)) ? TAIL : BODY;
+            rd_to_master.Push(llc_flit);
+          }
+        } else if (from_mem) {
+          // Mem responds with OKAY/SLVERR per phit, IsShared and PassDirty come from the Snoops
+          // A line read without error fills the LLC
+          rresp_flit_t  mem_flit;
+          unsigned char mem_flits = 0;
+          bool          mem_err   = false;
+          do {
+            mem_flit = rd_from_slave.Pop();
+            #pragma hls_unroll yes
+            for (int i=0; i<cfg::RRESP_PHITS; ++i) {
+              if (mem_flits<LINE_FLITS) line_buf[mem_flits*cfg::RRESP_PHITS+i] = mem_flit.data[i] & 0xFFFF;
+              mem_err |= (((mem_flit.data[i] >> dnp::ace::rdata::RE_PTR) & 0x3) != 0);
+              mem_flit.data[i] |= (((sc_uint<dnp::PHIT_W>)(resp_accum & 0xC)) << dnp::ace::rdata::RE_PTR);
+            }
+            rd_to_master.Push(mem_flit);
+            mem_flits++;
+          } while (mem_flit.type != TAIL);
+          if ((LLC_LINES>0) && llc_line_req(cur_req) && (mem_flits==LINE_FLITS) && !mem_err) llc_fill(cur_line, line_buf, false);
+        }
+      }
+      
+      // The Snoop line goes to the initiator when it expects data, and to Mem when dirty. IsShared and IsDirty are expected to be 0
+      if (got_data) {
+        cresp_flit_t  line_flit;
+        unsigned char line_ptr = 0;
+        do {
+          if (cur_txn.stream) {
+            while (!snp_stream.nb_read(line_flit)) wait();
+          } else {
+            line_flit = cur_txn.snp_data[line_ptr];
+          }
+          if (update_mem && (LLC_LINES>0)) {
+            NVHLS_ASSERT_MSG(line_ptr<LINE_FLITS, "Snoop line longer than LINE_FLITS.");
+            #pragma hls_unroll yes
+            for (int i=0; i<cfg::WREQ_PHITS; ++i) line_buf[line_ptr*cfg::WREQ_PHITS+i] = line_flit.data[i] & 0xFFFF;
+          } else if (update_mem) {
+            wreq_flit_t mem_upd_flit;
+            #pragma hls_unroll yes
+            for (int i=0; i<cfg::WREQ_PHITS; ++i) {
+              mem_upd_flit.data[i] = line_flit.data[i] | (((sc_uint<dnp::PHIT_W>)3) << dnp::ace::wdata::E0_PTR);
+            }
+            mem_upd_flit.type = line_flit.type;
+            mem_wr(mem_upd_flit);
+          }
+          if (data_expected) {
+            rresp_flit_t flit_data_to_init;
+            #pragma hls_unroll yes
+            for (int i=0; i<cfg::RRESP_PHITS; ++i) {
+              flit_data_to_init.data[i] = line_flit.data[i] | (((sc_uint<dnp::PHIT_W>)resp_accum) << dnp::ace::rdata::RE_PTR);
+            }
+            flit_data_to_init.type = line_flit.type;
+            rd_to_master.Push(flit_data_to_init);
+          }
+          line_ptr++;
+        } while (line_flit.type != TAIL);
+      }
+      if (update_mem && (LLC_LINES>0)) llc_fill(cur_line, line_buf, true);
+      if (update_mem && (WB_NUM==0) && (LLC_LINES==0)) wr_from_slave.Pop(); // ToDo : Maybe error handling
+      
+      if (!is_read) {
         // Init transaction is a Write thus resolbe Mem to write and send the Write transaction
         unsigned mem_to_write = addr_lut(cur_req.addr);
         flit_req_rcv.set_network(THIS_ID, mem_to_write, 0, dnp::PACK_TYPE__C_WR_REQ, 0);
-        wr_to_slave.Push(flit_req_rcv); // Send Head
+        bool llc_absorbed = false;
+        if (LLC_LINES>0) {
+          // The LLC keeps the Writes of whole lines. The rest go to Mem, dropping the LLC copy
+          wreq_flit_t   wr_buf[LINE_FLITS];
+          wreq_flit_t   wr_flit;
+          unsigned char wr_flits = 0;
+          bool          all_en   = true;
+          do {
+            while (!wr_stream.nb_read(wr_flit)) wait();
+            NVHLS_ASSERT_MSG(wr_flits<LINE_FLITS, "A Write through the LLC must fit in a cache line.");
+            wr_buf[wr_flits] = wr_flit;
+            #pragma hls_unroll yes
+            for (int i=0; i<cfg::WREQ_PHITS; ++i) {
+              line_buf[wr_flits*cfg::WREQ_PHITS+i] = wr_flit.data[i] & 0xFFFF;
+              if ((wr_flits*cfg::WREQ_PHITS+i)<(LINE_B/2)) all_en &= (((wr_flit.data[i] >> dnp::ace::wdata::E0_PTR) & 0x3) == 0x3);
+            }
+            wr_flits++;
+          } while (wr_flit.type != TAIL);
+          
+          llc_absorbed = llc_line_req(cur_req) && (wr_flits==LINE_FLITS) && all_en;
+          if (llc_absorbed) {
+            llc_fill(cur_line, line_buf, true);
+          } else {
+            unsigned llc_ent = 0;
+            if (llc_lookup(cur_line, llc_ent)) {
+              if (llc_dirty[llc_ent]) llc_flush(llc_ent);
+              llc_valid[llc_ent] = false;
+            }
+            wb_alloc(cur_line);
+            mem_wr(flit_req_rcv); // Send Head
+            for (unsigned f=0; f<LINE_FLITS; ++f) {
+              if (f<wr_flits) mem_wr(wr_buf[f]);
+            }
+          }
+        } else {
+          wb_alloc(cur_line);
+          mem_wr(flit_req_rcv); // Send Head
+          wreq_flit_t   wr_flit;
+          unsigned char wr_flits = 0;
+          do {
+            while (!wr_stream.nb_read(wr_flit)) wait();
+            NVHLS_ASSERT_MSG((WB_NUM==0) || (wr_flits<LINE_FLITS), "A buffered Write must fit in a cache line.");
+            mem_wr(wr_flit);
+            wr_flits++;
+          } while (wr_flit.type != TAIL);
+        }
         
-        wreq_flit_t data_to_update;
-        while(!wr_from_master.PopNB(data_to_update)) {
-          wait();
+        if ((WB_NUM>0) || llc_absorbed) {
+          // Posted, the buffer or the LLC holds the data thus respond OKAY
+          wresp_flit_t early_resp;
+          early_resp.type    = SINGLE;
+          early_resp.data[0] = ((sc_uint<dnp::PHIT_W>)cur_req.id << dnp::ace::wresp::ID_PTR);
+          early_resp.set_network(THIS_ID, initiator, 0, dnp::PACK_TYPE__C_WR_RESP, 0);
+          wr_to_master.Push(early_resp);
+        } else {
+          // transfer the response to the init Master
+          wresp_flit_t mv_wr_resp = wr_from_slave.Pop();
+          mv_wr_resp.set_src(THIS_ID); // Set the HOME src to receive the response
+          mv_wr_resp.set_dst(initiator); // Set the initiator as a recipient  src to receive the response
+          wr_to_master.Push(mv_wr_resp);
         }
-        wr_to_slave.Push(data_to_update);
+      }
+      
+      ack_info txn_ack;
+      txn_ack.id        = cur_txn.id;
+      txn_ack.initiator = initiator;
+      txn_ack.is_read   = is_read;
+      txn_ack.wait_ack  = init_is_full;
+      ack_wait.write(txn_ack);
+    } // End of while(1)
+  }; // End of txn_complete
+  
+  // A write to Mem, directly or through the write buffer
+  inline void mem_wr(wreq_flit_t &flit) {
+    if (WB_NUM>0) wb_stream.write(flit);
+    else          wr_to_slave.Push(flit);
+  };
+  
+  // Take the next buffer entry for a write of line, once it is drained
+  inline void wb_alloc(ace5_::Addr line) {
+    if (WB_NUM>0) {
+      while (wb_valid[wb_tail]) {
+        wait();
+        wb_retire();
+      }
+      wb_valid[wb_tail] = true;
+      wb_line[wb_tail]  = line;
+      wb_tail = (wb_tail==(WB_SIZE-1)) ? 0 : (wb_tail+1);
+    }
+  };
+  
+  // The 2 bytes of the phits of a line in the LLC are of Read/Write data flits, as only whole aligned lines are kept
+  inline bool llc_line_req(const ace5_::AddrPayload &req) {
+    return ((req.addr & (LINE_B-1))==0) && (((req.len.to_uint()+1)<<req.size.to_uint())==LINE_B) && (req.burst==enc_::AXBURST::INCR);
+  };
+  
+  inline bool llc_lookup(ace5_::Addr line, unsigned &ent) {
+    unsigned set = (line & (LLC_SETS-1)) * LLC_WAYS;
+    bool     hit = false;
+    ent = set;
+    #pragma hls_unroll yes
+    for (int w=0; w<LLC_WAYS; ++w) {
+      if ((LLC_LINES>0) && llc_valid[set+w] && (llc_line[set+w]==line)) {
+        ent = set+w;
+        hit = true;
+      }
+    }
+    return hit;
+  };
+  
+  // The accessed way becomes the most recent of its set
+  inline void llc_touch(unsigned ent) {
+    unsigned set = (ent/LLC_WAYS) * LLC_WAYS;
+    #pragma hls_unroll yes
+    for (int w=0; w<LLC_WAYS; ++w) {
+      if (llc_age[set+w] < llc_age[ent]) llc_age[set+w]++;
+    }
+    llc_age[ent] = 0;
+  };
+  
+  // An invalid way first, otherwise the one of the replacement policy
+  inline unsigned llc_victim(ace5_::Addr line) {
+    unsigned set = (line & (LLC_SETS-1));
+    unsigned way = 0;
+    if      (LLC_REPL==LLC_FIFO) way = llc_rr[set];
+    else if (LLC_REPL==LLC_RAND) way = llc_lfsr % LLC_WAYS;
+    #pragma hls_unroll yes
+    for (int w=LLC_WAYS-1; w>=0; --w) {
+      if ((LLC_REPL==LLC_LRU) && (llc_age[set*LLC_WAYS+w]==(LLC_WAYS-1))) way = w;
+    }
+    bool got_free = false;
+    #pragma hls_unroll yes
+    for (int w=0; w<LLC_WAYS; ++w) {
+      if (!llc_valid[set*LLC_WAYS+w] && !got_free) {
+        way      = w;
+        got_free = true;
+      }
+    }
+    llc_rr[set] = (llc_rr[set]==(LLC_WAYS-1)) ? 0 : (llc_rr[set]+1);
+    llc_lfsr    = (llc_lfsr >> 1) ^ ((llc_lfsr & 1) ? 0xB400 : 0);
+    return set*LLC_WAYS + way;
+  };
   
-        // transfer the response to the init Master
-        wresp_flit_t mv_wr_resp = wr_from_slave.Pop();
-        mv_wr_resp.set_src(THIS_ID); // Set the HOME src to receive the response
-        mv_wr_resp.set_dst(initiator); // Set the initiator as a recipient  src to receive the response
-        wr_to_master.Push(mv_wr_resp);
+  // Places a line in the LLC, over its copy or a victim whose dirty line is written back
+  inline void llc_fill(ace5_::Addr line, sc_uint<16> buf[LINE_PH], bool dirty) {
+    unsigned ent = 0;
+    if (!llc_lookup(line, ent)) {
+      ent = llc_victim(line);
+      if (llc_valid[ent] && llc_dirty[ent]) llc_flush(ent);
+      llc_valid[ent] = true;
+      llc_dirty[ent] = false;
+      llc_line[ent]  = line;
+    }
+    #pragma hls_unroll yes
+    for (int p=0; p<LINE_PH; ++p) llc_data[ent][p] = buf[p];
+    llc_dirty[ent] = llc_dirty[ent] || dirty;
+    llc_touch(ent);
+  };
+  
+  // Writes back a dirty line, which then is clean
+  inline void llc_flush(unsigned ent) {
+    ace5_::AddrPayload wb_req;
+    wb_req.id      = 0;
+    wb_req.addr    = llc_line[ent] << LOG_LINE_BYTES;
+    wb_req.size    = (LOG_LINE_BYTES<LOG_WR_M_LANES) ? LOG_LINE_BYTES : LOG_WR_M_LANES;
+    wb_req.len     = (LINE_B >> wb_req.size.to_uint()) - 1;
+    wb_req.burst   = enc_::AXBURST::INCR;
+    wb_req.snoop   = 0;
+    wb_req.domain  = 0;
+    wb_req.barrier = 0;
+    wb_req.unique  = 0;
+    
+    wreq_flit_t wb_flit;
+    wb_flit.type = HEAD;
+    wb_flit.set_network(THIS_ID, addr_lut(wb_req.addr), 0, dnp::PACK_TYPE__C_WR_REQ, 0);
+    wb_flit.set_wr_req(wb_req);
+    wb_alloc(llc_line[ent]);
+    mem_wr(wb_flit);
+    for (unsigned f=0; f<LINE_FLITS; ++f) {
+      #pragma hls_unroll yes
+      for (int i=0; i<cfg::WREQ_PHITS; ++i) {
+        bool in_line = ((f*cfg::WREQ_PHITS+i)<(LINE_B/2));
+        wb_flit.data[i] = ((sc_uint<dnp::PHIT_W>)llc_data[ent][f*cfg::WREQ_PHITS+i]) |
+                          ((sc_uint<dnp::PHIT_W>)(in_line && (f==(LINE_FLITS-1))) << dnp::ace::wdata::LA_PTR) |
+                          ((sc_uint<dnp::PHIT_W>)(in_line ? 3 : 0)                 << dnp::ace::wdata::E0_PTR) ;
+      }
+      wb_flit.type = (f==(LINE_FLITS-1)) ? TAIL : BODY;
+      mem_wr(wb_flit);
+    }
+    if (WB_NUM==0) wr_from_slave.Pop(); // ToDo : Maybe error handling
+    llc_dirty[ent] = false;
+  };
+  
+  // The oldest entry is released when wb_drain got its response
+  inline void wb_retire() {
+    bool drained;
+    if ((WB_NUM>0) && wb_fin.nb_read(drained)) {
+      wb_valid[wb_head] = false;
+      wb_head = (wb_head==(WB_SIZE-1)) ? 0 : (wb_head+1);
+    }
+  };
+  
+  inline bool wb_hit(ace5_::Addr line) {
+    bool hit = false;
+    #pragma hls_unroll yes
+    for (int w=0; w<WB_SIZE; ++w) {
+      if ((WB_NUM>0) && wb_valid[w] && (wb_line[w]==line)) hit = true;
+    }
+    return hit;
+  };
+  
+  //--------------------//
+  //--- Write buffer ---//
+  //--------------------//
+  // Drains the entries in order. The next is sent after the response of the previous, thus a Read that
+  // found no matching entry never overtakes a write of its line
+  void wb_drain () {
+    wr_to_slave.Reset();
+    wr_from_slave.Reset();
+    //-- End of Reset ---//
+    
+    while(1) {
+      wait();
+      wreq_flit_t wb_flit;
+      do {
+        while (!wb_stream.nb_read(wb_flit)) wait();
+        wr_to_slave.Push(wb_flit);
+      } while (wb_flit.type != TAIL);
+      wr_from_slave.Pop(); // ToDo : Maybe error handling
+      wb_fin.write(true);
+    } // End of while(1)
+  }; // End of wb_drain
+  
+  //----------------------------------//
+  //--- Final ACK of the initiator ---//
+  //----------------------------------//
+  void ack_check () {
+    ack_from_master.Reset();
+    
+    // Transactions waiting their ACK, in the order they were responded
+    ack_info      pend[TXN_NUM];
+    unsigned char pend_cnt = 0;
+    // The ACK of a direct transfer may arrive before the transaction is done in txn_complete
+    ack_info      early[TXN_NUM];
+    unsigned char early_cnt = 0;
+    //-- End of Reset ---//
+    
+    wait();
+    while(1) {
+      ack_info new_wait;
+      if (ack_wait.nb_read(new_wait)) {
+        bool          got_early = false;
+        unsigned char early_sel = 0;
+        #pragma hls_unroll yes
+        for (int t=0; t<TXN_NUM; ++t) {
+          if (DCT && (t<early_cnt) && !got_early && (early[t].initiator==new_wait.initiator) && (early[t].is_read==new_wait.is_read)) {
+            early_sel = t;
+            got_early = true;
+          }
+        }
+        if (new_wait.wait_ack && !got_early) {
+          pend[pend_cnt++] = new_wait;
+        } else {
+          txn_fin.write(new_wait.id);
+          if (new_wait.wait_ack) {
+            #pragma hls_unroll yes
+            for (int t=0; t<TXN_NUM-1; ++t) {
+              if (t>=early_sel) early[t] = early[t+1];
+            }
+            early_cnt--;
+          }
+        }
       }
       
       // Wait for the final ack from the Init Master that signifies that the cache has been completed the transaction
-      // Only a Full Master responds with an Ack
-      if (init_is_full) {
-        ack_flit_t rcv_ack = ack_from_master.Pop();
-        NVHLS_ASSERT_MSG( (rcv_ack.is_rack()&&is_read) || (rcv_ack.is_wack()&&(!is_read)), "ACK does not match the responce (i.e. RD/WR)");
-
-        #ifndef __SYNTHESIS__
-        if(is_read) std::cout << "[HOME "<< THIS_ID <<"] Got RD ACK from " << rcv_ack.get_src() << " : " << cur_req << " @" << sc_time_stamp() << "\n";
-        else        std::cout << "[HOME "<< THIS_ID <<"] Got WR AK  from " << rcv_ack.get_src() << " : " << cur_req << " @" << sc_time_stamp() << "\n";
-        #endif
+      // A master sends its ACKs in the order it got the responses, thus the oldest matching transaction is the acked one
+      ack_flit_t rcv_ack;
+      if (ack_from_master.PopNB(rcv_ack)) {
+        bool          found = false;
+        unsigned char sel   = 0;
+        #pragma hls_unroll yes
+        for (int t=0; t<TXN_NUM; ++t) {
+          if ((t<pend_cnt) && !found && (pend[t].initiator==rcv_ack.get_src()) && (pend[t].is_read==rcv_ack.is_rack())) {
+            sel   = t;
+            found = true;
+          }
+        }
+        if (DCT && !found) {
+          early[early_cnt].initiator = rcv_ack.get_src();
+          early[early_cnt].is_read   = rcv_ack.is_rack();
+          early_cnt++;
+        } else {
+          NVHLS_ASSERT_MSG(found && ((rcv_ack.is_rack()&&pend[sel].is_read) || (rcv_ack.is_wack()&&(!pend[sel].is_read))), "ACK does not match the responce (i.e. RD/WR)");
+        
+          if(pend[sel].is_read) EVT_TRACE(EVT_LVL_TXN, evt, EVT_HOME_RACK, pend[sel].id.to_uint(), 0, rcv_ack.get_src().to_uint(),
+                                          std::cout << "[HOME "<< THIS_ID <<"] Got RD ACK from " << rcv_ack.get_src() << " : TXN " << pend[sel].id << " @" << sc_time_stamp() << "\n");
+          else                  EVT_TRACE(EVT_LVL_TXN, evt, EVT_HOME_WACK, pend[sel].id.to_uint(), 0, rcv_ack.get_src().to_uint(),
+                                          std::cout << "[HOME "<< THIS_ID <<"] Got WR AK  from " << rcv_ack.get_src() << " : TXN " << pend[sel].id << " @" << sc_time_stamp() << "\n");
+        
+          txn_fin.write(pend[sel].id);
+          #pragma hls_unroll yes
+          for (int t=0; t<TXN_NUM-1; ++t) {
+            if (t>=sel) pend[t] = pend[t+1];
+          }
+          pend_cnt--;
+        }
       }
       
-      
+      wait();
     } // End of while(1)
-  }; // End of HOME Node
+  }; // End of ack_check
   
   // Transactions that do not accept Dirty data, thus the interconnects is responsible for to handle them
   inline bool req_denies_dirty(NVUINTW(enc_::ARSNOOP::_WIDTH) &request_in, bool is_read ) {
@@ -303,10 +1014,9 @@ SC_MODULE(ace_home) {
   
   // Memory map resolving 
   inline unsigned char addr_lut(const ace5_::Addr addr) {
-    for (int i=0; i<2; ++i) {
-      if (addr>=addr_map[i][0].read() && addr <= addr_map[i][1].read()) return i;
-    }
-    return 0; // Or send 404
+    bool hit;
+    unsigned char sel = addr_decoder<cfg::SLAVE_NUM>::decode(addr, addr_map, hit);
+    return sel;
   };
 }; // End of Home module
 
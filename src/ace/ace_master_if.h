@@ -15,6 +15,7 @@
 #include "../include/axi4_configs_extra.h"
 #include "../include/flit_ace.h"
 #include "../include/duth_fun.h"
+#include "../include/addr_dec.h"
 
 #define LOG_MAX_OUTS 8
 
@@ -59,10 +60,17 @@ struct order_info {
 // The interface gets the Requests and independently packetize and send them into the network
 // The Responses are getting depacketized into a seperate thread and are fed back to the MASTER
 // Thus Master interface comprises of 4 distinct/paarallel blocks WR/RD pack and WR/RD depack
-template <typename cfg>
+// Coherent transactions are interleaved to the cfg::HOME_NUM (power of 2) HOMEs at cache line granularity
+// HOME_SEL : 0 the line address modulo HOME_NUM, 1 the XOR-fold of the line address
+// DCT      : Direct cache-to-cache transfer (ace_home DCT). A snooped line is sent to the initiator at dct_flit_out,
+//            unless HOME must write it back. Coherent Reads of the same ID are then issued one at a time, as their
+//            responses may come from different masters.
+// SNP_OUTS : Snoops in flight to the cache. The AC requests are issued by snoop_req_job and the CR/CD responses,
+//            which the cache returns in AC order, are sent by snoop_resp_job. 1 waits each response before the next AC.
+template <typename cfg, unsigned char HOME_SEL=0, bool DCT=false, unsigned char SNP_OUTS=1>
 SC_MODULE(ace_master_if) {
   typedef typename ace::ace5<axi::cfg::ace> ace5_;
-  typedef typename axi::AXI4_Encoding       enc_;
+  typedef typename ace::ACE_Encoding        enc_;
   
   typedef flit_dnp<cfg::RREQ_PHITS>  rreq_flit_t;
   typedef flit_dnp<cfg::RRESP_PHITS> rresp_flit_t;
@@ -78,6 +86,21 @@ SC_MODULE(ace_master_if) {
   
   const unsigned char LOG_RD_M_LANES = nvhls::log2_ceil<cfg::RD_LANES>::val;
   const unsigned char LOG_WR_M_LANES = nvhls::log2_ceil<cfg::WR_LANES>::val;
+  const unsigned char LOG_LINE_BYTES = nvhls::log2_ceil<ace5_::C_CACHE_WIDTH/8>::val;
+  // A Snoop data beat spans CD_FLITS flits, at 2 bytes per phit
+  static const unsigned CD_PHITS = (ace5_::C_DATA_CHAN_WIDTH/8)/2;
+  static const unsigned CD_FLITS = (CD_PHITS + cfg::CRESP_PHITS - 1) / cfg::CRESP_PHITS;
+  
+  // Snoop issued to the cache, passed from snoop_req_job to snoop_resp_job
+  struct snp_info {
+    creq_flit_t flit;  // The received Snoop, for HOME and the direct transfer fields
+    ace5_::AC   req;
+    
+    inline friend std::ostream& operator << ( std::ostream& os, const snp_info& info ) {
+      os <<"Snoop: "<< info.flit;
+      return os;
+    }
+  };
   
   sc_in_clk    clk;
   sc_in <bool> rst_n;
@@ -113,6 +136,7 @@ SC_MODULE(ace_master_if) {
   
   Connections::In<creq_flit_t>   INIT_S1(cache_flit_in);
   Connections::Out<cresp_flit_t> INIT_S1(cache_flit_out);
+  Connections::Out<rresp_flit_t> INIT_S1(dct_flit_out);   // Snooped lines sent directly, on the RD response network
   
   
   // --- READ Internals --- //
@@ -126,6 +150,10 @@ SC_MODULE(ace_master_if) {
   // --- WRITE Internals --- //
   sc_fifo<sc_uint<dnp::ace::ID_W>>  INIT_S1(wr_trans_fin);  // Depack to pack
   
+  // --- SNOOP Internals --- //
+  sc_fifo<snp_info> INIT_S1(snp_trans_init); // Snoop Req to Resp
+  sc_fifo<bool>     INIT_S1(snp_trans_fin);  // Snoop Resp to Req, a response was sent
+  
   // Placed on WRITE Packetizer
   outs_table_entry     wr_out_table[1<<dnp::ace::ID_W]; //[(1<<TID_W)];       // Holds the OutStanding Transactions | Hint : TID_W=4 => 16 slots x 16bits (could be less)
   
@@ -135,8 +163,13 @@ SC_MODULE(ace_master_if) {
     :
     sc_module (name_),
     rd_trans_fin  (2),
-    wr_trans_fin  (2)
+    wr_trans_fin  (2),
+    snp_trans_init(SNP_OUTS),
+    snp_trans_fin (SNP_OUTS)
   {
+    NVHLS_ASSERT_MSG(SNP_OUTS>0, "At least a Snoop must be in flight.");
+    NVHLS_ASSERT_MSG(!DCT || (cfg::CRESP_PHITS==cfg::RRESP_PHITS), "Direct transfers send the Snoop line flits as RD response flits.");
+    
     SC_THREAD(rd_req_pack_job);
     sensitive << clk.pos();
     async_reset_signal_is(rst_n, false);
@@ -153,38 +186,73 @@ SC_MODULE(ace_master_if) {
     sensitive << clk.pos();
     async_reset_signal_is(rst_n, false);
   
-    SC_THREAD(snoop_module);
+    SC_THREAD(snoop_req_job);
+    sensitive << clk.pos();
+    async_reset_signal_is(rst_n, false);
+    
+    SC_THREAD(snoop_resp_job);
     sensitive << clk.pos();
     async_reset_signal_is(rst_n, false);
   }
   
-  //-------------------------------//
-  //--- ACE SNOOPING Module ---//
-  //-------------------------------//
-  void snoop_module () {
+  //----------------------------//
+  //--- ACE SNOOPING Requests ---//
+  //----------------------------//
+  void snoop_req_job () {
     //-- Start of Reset ---//
     ac_out.Reset();
-    cr_in.Reset();
-    cd_in.Reset();
-  
     cache_flit_in.Reset();
-    cache_flit_out.Reset();
     
+    unsigned char snp_outs = 0; // Snoops waiting their response
     //-- End of Reset ---//
     wait();
     while(1) {
-      creq_flit_t flit_snp_rcv = cache_flit_in.Pop();
+      bool fin;
+      if (snp_trans_fin.nb_read(fin)) snp_outs--;
       
-      sc_uint<dnp::D_W> sender = (flit_snp_rcv.data[0] >> dnp::S_PTR) & ((1<<dnp::S_W)-1);
+      creq_flit_t flit_snp_rcv;
+      if ((snp_outs<SNP_OUTS) && cache_flit_in.PopNB(flit_snp_rcv)) {
+        ace5_::AC snoop_req;
+        snoop_req.prot  = (flit_snp_rcv.data[2] >> dnp::ace::creq::C_PROT_PTR) & ((1<<dnp::ace::C_PROT_W)-1);
+        snoop_req.snoop = (flit_snp_rcv.data[1] >> dnp::ace::creq::SNP_PTR) & ((1<<dnp::ace::SNP_W)-1);
+        snoop_req.addr  = ((((flit_snp_rcv.data[2]>>dnp::ace::creq::AH_PTR) & ((1<<dnp::ace::AH_W)-1)) << dnp::ace::AL_W) |
+                            ((flit_snp_rcv.data[1]>>dnp::ace::creq::AL_PTR) & ((1<<dnp::ace::AL_W)-1)));
       
-      ace5_::AC snoop_req;
-      snoop_req.prot  = (flit_snp_rcv.data[2] >> dnp::ace::creq::C_PROT_PTR) & ((1<<dnp::ace::C_PROT_W)-1);
-      snoop_req.snoop = (flit_snp_rcv.data[1] >> dnp::ace::creq::SNP_PTR) & ((1<<dnp::ace::SNP_W)-1);
-      snoop_req.addr  = ((((flit_snp_rcv.data[2]>>dnp::ace::creq::AH_PTR) & ((1<<dnp::ace::AH_W)-1)) << dnp::ace::AL_W) |
-                          ((flit_snp_rcv.data[1]>>dnp::ace::creq::AL_PTR) & ((1<<dnp::ace::AL_W)-1)));
+        // Multicast Snoops are addressed via their multicast mask instead of the destination
+        bool is_mcast = (flit_snp_rcv.get_mcast_dst()!=0);
+        NVHLS_ASSERT_MSG( is_mcast || (((flit_snp_rcv.data[0].to_uint() >> dnp::D_PTR) & ((1<<dnp::D_W)-1)) == (THIS_ID.read().to_uint())), "Flit misrouted!");
+        NVHLS_ASSERT_MSG(!is_mcast || ((flit_snp_rcv.get_mcast_dst() >> THIS_ID.read()) & 1), "Multicast Flit misrouted!");
+        ac_out.Push(snoop_req);
       
-      NVHLS_ASSERT_MSG(((flit_snp_rcv.data[0].to_uint() >> dnp::D_PTR) & ((1<<dnp::D_W)-1)) == (THIS_ID.read().to_uint()), "Flit misrouted!");
-      ac_out.Push(snoop_req);
+        snp_info snp_issued;
+        snp_issued.flit = flit_snp_rcv;
+        snp_issued.req  = snoop_req;
+        snp_trans_init.write(snp_issued);
+        snp_outs++;
+      }
+      wait();
+    } // End of while(1)
+  }; // End of Snoop Request
+  
+  //-----------------------------//
+  //--- ACE SNOOPING Responses ---//
+  //-----------------------------//
+  void snoop_resp_job () {
+    //-- Start of Reset ---//
+    cr_in.Reset();
+    cd_in.Reset();
+    
+    cache_flit_out.Reset();
+    dct_flit_out.Reset();
+    //-- End of Reset ---//
+    while(1) {
+      wait();
+      // Blocking read of the oldest Snoop, the cache responds in order
+      snp_info    snp_issued   = snp_trans_init.read();
+      creq_flit_t flit_snp_rcv = snp_issued.flit;
+      ace5_::AC   snoop_req    = snp_issued.req;
+      
+      sc_uint<dnp::D_W> sender = (flit_snp_rcv.data[0] >> dnp::S_PTR) & ((1<<dnp::S_W)-1);
       
       ace5_::CR snoop_resp = cr_in.Pop();
       cresp_flit_t resp_flit;
@@ -197,29 +265,80 @@ SC_MODULE(ace_master_if) {
                           ((sc_uint<dnp::PHIT_W>)0                      << dnp::V_PTR       ) ;
       
       bool has_data = (snoop_resp.resp & 1);
-      if (has_data) {
+      // A Direct transfer sends the line to the initiator, unless it is dirty and the initiator does not accept it
+      bool is_dct   = DCT && has_data && flit_snp_rcv.get_snoop_dct() &&
+                      !((snoop_resp.resp & 0x4) && snp_denies_dirty(snoop_req.snoop));
+      // R resp of the direct transfer. IsShared of a single Snoop is final, otherwise others may keep a copy
+      sc_uint<dnp::ace::R_RE_W> dct_resp = (snoop_resp.resp & 0x6);
+      if (flit_snp_rcv.get_snoop_sole()) dct_resp |= (snoop_resp.resp & 0x8);
+      else if (snoop_req.snoop != enc_::ACSNOOP::RD_UNIQUE) dct_resp |= 0x8;
+      
+      if (is_dct) {
+        // HOME gets only the response, the initiator the header of its Read and the line
+        resp_flit.type = SINGLE;
+        cache_flit_out.Push(resp_flit);
+        
+        ace5_::AddrPayload init_req;
+        init_req.addr = snoop_req.addr;
+        sc_uint<dnp::S_W> initiator = flit_snp_rcv.get_snoop_dct_hdr(init_req);
+        rresp_flit_t dct_flit;
+        dct_flit.type = HEAD;
+        dct_flit.set_network(sender, initiator, 0, dnp::PACK_TYPE__C_RD_RESP, 0); // Sent on behalf of HOME, which gets the RACK
+        dct_flit.set_rd_resp(init_req);
+        dct_flit_out.Push(dct_flit);
+      } else if (has_data) {
+        resp_flit.data[0] |= ((sc_uint<dnp::PHIT_W>)1 << dnp::ace::cresp::C_HAS_DATA_PTR);
         resp_flit.type = HEAD;
         cache_flit_out.Push(resp_flit);
+      }
+      
+      if (has_data) {
+        // Each beat is sent as its flits are filled, thus HOME may forward the line cut-through
         ace5_::CD snoop_data;
         do {
-          unsigned char data_bytes[ace5_::C_CACHE_WIDTH/8];
+          unsigned char data_bytes[ace5_::C_DATA_CHAN_WIDTH/8];
           snoop_data = cd_in.Pop();
-          duth_fun<ace5_::CD::Data, ace5_::C_CACHE_WIDTH/8>::assign_ac2char(data_bytes, snoop_data.data);
-          for(unsigned i=0; i<(ace5_::C_CACHE_WIDTH/8)/2; ++i) {
-            resp_flit.data[i] = ((sc_uint<dnp::PHIT_W>)snoop_data.last      << dnp::ace::wdata::LA_PTR ) | // MSB
-                                ((sc_uint<dnp::PHIT_W>)data_bytes[(i<<1)+1] << dnp::ace::wdata::B1_PTR ) |
-                                ((sc_uint<dnp::PHIT_W>)data_bytes[(i<<1)  ] << dnp::ace::wdata::B0_PTR ) ;
+          duth_fun<ace5_::CD::Data, ace5_::C_DATA_CHAN_WIDTH/8>::assign_ac2char(data_bytes, snoop_data.data);
+          for (unsigned f=0; f<CD_FLITS; ++f) {
+            bool last_flit = snoop_data.last && (f==(CD_FLITS-1));
+            #pragma hls_unroll yes
+            for (unsigned i=0; i<cfg::CRESP_PHITS; ++i) {
+              unsigned p = f*cfg::CRESP_PHITS + i;
+              resp_flit.data[i] = 0;
+              if (p<CD_PHITS) {
+                resp_flit.data[i] = ((sc_uint<dnp::PHIT_W>)last_flit            << dnp::ace::wdata::LA_PTR ) | // MSB
+                                    ((sc_uint<dnp::PHIT_W>)data_bytes[(p<<1)+1] << dnp::ace::wdata::B1_PTR ) |
+                                    ((sc_uint<dnp::PHIT_W>)data_bytes[(p<<1)  ] << dnp::ace::wdata::B0_PTR ) ;
+              }
+            }
+            resp_flit.type = last_flit ? TAIL : BODY;
+            if (is_dct) {
+              rresp_flit_t dct_flit;
+              #pragma hls_unroll yes
+              for (unsigned i=0; i<cfg::RRESP_PHITS; ++i) {
+                dct_flit.data[i] = resp_flit.data[i] | ((sc_uint<dnp::PHIT_W>)dct_resp << dnp::ace::rdata::RE_PTR);
+              }
+              dct_flit.type = resp_flit.type;
+              dct_flit_out.Push(dct_flit);
+            } else {
+              cache_flit_out.Push(resp_flit);
+            }
           }
-          resp_flit.type = snoop_data.last ? TAIL : BODY;
-          cache_flit_out.Push(resp_flit);
         } while (!snoop_data.last);
       } else {
         resp_flit.type = SINGLE;
         cache_flit_out.Push(resp_flit);
       }
-    }
+      snp_trans_fin.write(true);
+    } // End of while(1)
+  }; // End of Snoop Response
   
-  }
+  // Snoops of Reads that do not accept Dirty data, thus HOME writes the line back
+  inline bool snp_denies_dirty(NVUINTW(enc_::ACSNOOP::_WIDTH) snoop_in) {
+    return ((snoop_in == enc_::ACSNOOP::RD_ONCE) ||
+            (snoop_in == enc_::ACSNOOP::RD_CLEAN) ||
+            (snoop_in == enc_::ACSNOOP::RD_NOT_SHARED_DIRTY));
+  };
   
   //-------------------------------//
   //--- READ REQuest Packetizer ---//
@@ -251,9 +370,9 @@ SC_MODULE(ace_master_if) {
         bool is_coherent = (this_req.snoop > 0) || ((this_req.snoop ==0) && (this_req.domain.xor_reduce()));
         
         // resolve address to node-id
-        sc_uint<dnp::D_W> this_dst = is_coherent ? (cfg::SLAVE_NUM+cfg::ALL_MASTER_NUM) : addr_lut_rd(this_req.addr);
+        sc_uint<dnp::D_W> this_dst = is_coherent ? home_lut(this_req.addr) : addr_lut_rd(this_req.addr);
         // Check reorder conditions for received TID.
-        bool          may_reorder = (sel_entry.sent>0) && (sel_entry.dst_last != this_dst);
+        bool          may_reorder = (sel_entry.sent>0) && ((sel_entry.dst_last != this_dst) || (DCT && is_coherent));
         // In case of possible reordering wait_for has the number of transactions
         //   of the same ID, this request has to wait for.
         sc_uint<LOG_MAX_OUTS> wait_for    =  sel_entry.sent;
@@ -445,7 +564,7 @@ SC_MODULE(ace_master_if) {
                                (this_req.snoop == 1);
         
         // resolve address to node-id
-        sc_uint<dnp::D_W> this_dst = pass_thru_home ? (cfg::SLAVE_NUM+cfg::ALL_MASTER_NUM) : addr_lut_wr(this_req.addr);
+        sc_uint<dnp::D_W> this_dst = pass_thru_home ? home_lut(this_req.addr) : addr_lut_wr(this_req.addr);
         
         // Check reorder conditions for this TID.
         //   In an ordered NoC reorder may occur when there are outstanding trans towards different destinations
@@ -636,17 +755,20 @@ SC_MODULE(ace_master_if) {
   
   // Memory map resolving 
   inline unsigned char addr_lut_rd(const ace5_::Addr addr) {
-    for (int i=0; i<2; ++i) {
-      if (addr>=addr_map[i][0].read() && addr <= addr_map[i][1].read()) return i;
-    }
-    return 0; // Or send 404
+    bool hit;
+    unsigned char sel = addr_decoder<cfg::SLAVE_NUM>::decode(addr, addr_map, hit);
+    return sel;
   };
   
   inline unsigned char addr_lut_wr(const ace5_::Addr addr) {
-    for (int i=0; i<2; ++i) {
-      if (addr>=addr_map[i][0].read() && addr <= addr_map[i][1].read()) return i;
-    }
-    return 0; // Or send 404
+    bool hit;
+    unsigned char sel = addr_decoder<cfg::SLAVE_NUM>::decode(addr, addr_map, hit);
+    return sel;
+  };
+  
+  // HOME resolving. HOMEs follow the Slaves and Masters in node-id
+  inline unsigned char home_lut(const ace5_::Addr addr) {
+    return cfg::SLAVE_NUM+cfg::ALL_MASTER_NUM+home_decoder<cfg::HOME_NUM, HOME_SEL, nvhls::log2_ceil<ace5_::C_CACHE_WIDTH/8>::val, ace5_::C_ADDR_WIDTH>::decode(addr);
   };
   
 }; // End of Master-IF module
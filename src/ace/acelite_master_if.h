@@ -16,16 +16,22 @@
 #include "../include/axi4_configs_extra.h"
 #include "../include/flit_ace.h"
 #include "../include/duth_fun.h"
+#include "../include/addr_dec.h"
 
 #define LOG_MAX_OUTS 8
 
 #define INIT_S1(n)   n{#n}
 
 // --- Helping Data structures --- //
-template <typename cfg>
+// Coherent transactions are interleaved to the cfg::HOME_NUM (power of 2) HOMEs at cache line granularity
+// HOME_SEL : 0 the line address modulo HOME_NUM, 1 the XOR-fold of the line address
+// LINE_WR  : A WriteUnique of a whole aligned line with all its strobes set is sent as WriteLineUnique. HOME then
+//            only invalidates the cached copies, instead of writing a dirty one to Mem before the Write. Its beats
+//            are gathered first to check the strobes, thus the header departs once the line is received.
+template <typename cfg, unsigned char HOME_SEL=0, bool LINE_WR=false>
 SC_MODULE(acelite_master_if) {
   typedef typename ace::ace5<axi::cfg::ace> ace5_;
-  typedef typename axi::AXI4_Encoding       enc_;
+  typedef typename ace::ACE_Encoding        enc_;
   
   typedef flit_dnp<cfg::RREQ_PHITS>  rreq_flit_t;
   typedef flit_dnp<cfg::RRESP_PHITS> rresp_flit_t;
@@ -37,6 +43,11 @@ SC_MODULE(acelite_master_if) {
   
   const unsigned char LOG_RD_M_LANES = nvhls::log2_ceil<cfg::RD_LANES>::val;
   const unsigned char LOG_WR_M_LANES = nvhls::log2_ceil<cfg::WR_LANES>::val;
+  const unsigned char LOG_LINE_BYTES = nvhls::log2_ceil<ace5_::C_CACHE_WIDTH/8>::val;
+  // Beats of a whole line Write, of the full bus width or the line when narrower
+  static const unsigned LINE_B      = ace5_::C_CACHE_WIDTH/8;
+  static const unsigned LINE_BEAT_B = (LINE_B<cfg::WR_LANES) ? LINE_B : cfg::WR_LANES;
+  static const unsigned LINE_BEATS  = LINE_B/LINE_BEAT_B;
   
   sc_in_clk    clk;
   sc_in <bool> rst_n;
@@ -133,7 +144,7 @@ SC_MODULE(acelite_master_if) {
         bool is_coherent = (this_req.snoop > 0) || ((this_req.snoop ==0) && (this_req.domain.xor_reduce()));
         
         // resolve address to node-id
-        sc_uint<dnp::D_W> this_dst = is_coherent ? (cfg::SLAVE_NUM+cfg::ALL_MASTER_NUM) : addr_lut_rd(this_req.addr);
+        sc_uint<dnp::D_W> this_dst = is_coherent ? home_lut(this_req.addr) : addr_lut_rd(this_req.addr);
         // Check reorder conditions for received TID.
         bool          may_reorder = (sel_entry.sent>0) && (sel_entry.dst_last != this_dst);
         // In case of possible reordering wait_for has the number of transactions
@@ -311,7 +322,7 @@ SC_MODULE(acelite_master_if) {
                                (this_req.snoop == 1);
         
         // resolve address to node-id
-        sc_uint<dnp::D_W> this_dst = pass_thru_home ? (cfg::SLAVE_NUM+cfg::ALL_MASTER_NUM) : addr_lut_wr(this_req.addr);
+        sc_uint<dnp::D_W> this_dst = pass_thru_home ? home_lut(this_req.addr) : addr_lut_wr(this_req.addr);
         
         // Check reorder conditions for this TID.
         //   In an ordered NoC reorder may occur when there are outstanding trans towards different destinations
@@ -329,6 +340,27 @@ SC_MODULE(acelite_master_if) {
           wait();
         }; // End of while reorder
         
+        // Gather the beats of a whole line WriteUnique, to send it as WriteLineUnique when all strobes are set
+        ace5_::WritePayload line_beats[LINE_BEATS];
+        unsigned char       line_beat_ptr = 0;
+        sc_uint<8>          line_lane     = this_req.addr.to_uint() & (cfg::WR_LANES-1);
+        bool                line_wr       = LINE_WR && pass_thru_home && (this_req.snoop == enc_::AWSNOOP::WR_UNIQUE) &&
+                                            ((this_req.addr & (LINE_B-1)) == 0) && (this_req.burst == enc_::AXBURST::INCR) &&
+                                            ((1<<this_req.size.to_uint()) == LINE_BEAT_B) && ((this_req.len.to_uint()+1) == LINE_BEATS);
+        if (line_wr) {
+          bool all_strb = true;
+          for (unsigned b=0; b<LINE_BEATS; ++b) {
+            bool wstrb_line[cfg::WR_LANES];
+            line_beats[b] = w_in.Pop();
+            duth_fun<ace5_::Wstrb, cfg::WR_LANES>::assign_ac2bool(wstrb_line, line_beats[b].wstrb);
+            #pragma hls_unroll yes
+            for (int l=0; l<cfg::WR_LANES; ++l) {
+              if ((l>=line_lane) && (l<(line_lane+LINE_BEAT_B))) all_strb &= wstrb_line[l];
+            }
+          }
+          if (all_strb) this_req.snoop = enc_::AWSNOOP::WR_LINE_UNIQUE;
+        }
+        
         // --- Start HEADER Packetization --- //
         // Packetize request according DNP20, and send
         rreq_flit_t tmp_flit;
@@ -403,7 +435,8 @@ SC_MODULE(acelite_master_if) {
         // If current beat has been packed, pop next
         if((bytes_packed & ((1<<this_req.size.to_uint())-1))==0) {
           ace5_::WritePayload this_wr;
-          this_wr  = w_in.Pop();
+          if (line_wr) this_wr = line_beats[line_beat_ptr++];
+          else         this_wr = w_in.Pop();
           last_tmp = this_wr.last;
           duth_fun<ace5_::Data , cfg::WR_LANES>::assign_ac2char(data_build_tmp , this_wr.data);
           duth_fun<ace5_::Wstrb, cfg::WR_LANES>::assign_ac2bool(wstrb_tmp      , this_wr.wstrb);
@@ -485,17 +518,20 @@ SC_MODULE(acelite_master_if) {
   
   // Memory map resolving 
   inline unsigned char addr_lut_rd(const ace5_::Addr addr) {
-    for (int i=0; i<2; ++i) {
-      if (addr>=addr_map[i][0].read() && addr <= addr_map[i][1].read()) return i;
-    }
-    return 0; // Or send 404
+    bool hit;
+    unsigned char sel = addr_decoder<cfg::SLAVE_NUM>::decode(addr, addr_map, hit);
+    return sel;
   };
   
   inline unsigned char addr_lut_wr(const ace5_::Addr addr) {
-    for (int i=0; i<2; ++i) {
-      if (addr>=addr_map[i][0].read() && addr <= addr_map[i][1].read()) return i;
-    }
-    return 0; // Or send 404
+    bool hit;
+    unsigned char sel = addr_decoder<cfg::SLAVE_NUM>::decode(addr, addr_map, hit);
+    return sel;
+  };
+  
+  // HOME resolving. HOMEs follow the Slaves and Masters in node-id
+  inline unsigned char home_lut(const ace5_::Addr addr) {
+    return cfg::SLAVE_NUM+cfg::ALL_MASTER_NUM+home_decoder<cfg::HOME_NUM, HOME_SEL, nvhls::log2_ceil<ace5_::C_CACHE_WIDTH/8>::val, ace5_::C_ADDR_WIDTH>::decode(addr);
   };
   
 }; // End of Master-IF module
@@ -16,6 +16,7 @@
 
 #include "./include/axi4_configs_extra.h"
 #include "./include/duth_fun.h"
+#include "./include/addr_dec.h"
 
 #define LOG_MAX_OUTS 8
 
@@ -51,14 +52,67 @@ struct order_info {
   #endif
 };
 
+// ID remapping. Info of a new transaction passed from packetizer to depacketizer
+struct remap_info {
+  sc_uint<dnp::ID_W> tid; // AXI ID
+  sc_uint<dnp::ID_W> tag; // Internal tag, travels as the reorder ticket
+  bool               more; // A sub-burst of a striped burst, more of it follow
+
+  inline friend std::ostream& operator << ( std::ostream& os, const remap_info& info ) {
+    os <<"TID: "<< info.tid <<", Tag: "<< info.tag <<", More: "<< info.more;
+    #ifdef SYSTEMC_INCLUDED
+      os << std::dec << " @" << sc_time_stamp();
+    #else
+      os << std::dec << " @" << "no-timed";
+    #endif
+    return os;
+  }
+};
+
+// Depacketizer's state of each tag. The tags of an ID form a linked list in issue order
+struct remap_tag_entry {
+  sc_uint<dnp::ID_W> tid;
+  unsigned char      nxt_tag;
+  unsigned char      head_slot; // Its stored beats in the reorder buffer (RD)
+  unsigned char      tail_slot;
+  bool               pending;   // In flight
+  bool               stored;    // The whole response has arrived and waits for its turn
+  bool               more;      // Not the last sub-burst of a striped burst, thus does not end it
+  sc_uint<dnp::RE_W> resp;      // The Write response
+};
+
+// Each ID has a head/tail pointer at its tag list. The head is the oldest, thus the next to respond
+struct remap_book_entry {
+  unsigned char head_tag;
+  unsigned char tail_tag;
+};
+
 
 // --- Master IF --- //
 // AXI Master connects the independent AXI RD and WR cahnnels to the interface 
 // The interface gets the Requests and independently packetize and send them into the network
 // The Responses are getting depacketized into a seperate thread and are fed back to the MASTER
 // Thus Master interface comprises of 4 distinct/parallel blocks WR/RD pack and WR/RD depack
-template <typename cfg>
+// REMAP_TAGS   : When >0, ID remapping. Each transaction gets a tag from a free pool and never stalls for ordering.
+//                The depacketizers restore the order of each AXI ID. Up to 16 tags, 8 when WRESP_PHITS==1
+// RD_ROB_BEATS : Reorder buffer beats, to store the RD responses that arrive before older ones of their ID
+// STRIPE_CH    : When >0, the Slaves 0..STRIPE_CH-1 are memory channels, interleaved every 1<<LOG_STRIPE bytes
+//                of their (joined) address range, from the base of Slave 0. An INCR burst that crosses a stripe
+//                boundary is split into a sub-burst per channel, each of its own tag. A channel gets the dense offset
+//                of its stripes, the range offset>>log2(STRIPE_CH) past the in-stripe bits, thus its Slave sees local
+//                addresses in 1/STRIPE_CH of the range. The depacketizers merge the sub-bursts back into one burst,
+//                a single RLAST and the worst BRESP. Requires ID remapping, a power of 2 STRIPE_CH, and
+//                LOG_STRIPE of 8 (256B) to 12 (4KB), which also holds any WRAP burst within a stripe
+// MAX_BEATS    : When >0, the maximum packet length in beats. Longer INCR and FIXED bursts are split into sub-bursts
+//                of up to MAX_BEATS, each a packet of its own header and tag, and merged back as the stripes. Their
+//                responses are bounded the same, thus a long burst does not hold a wormhole output for its whole
+//                length. WRAP bursts (up to 16 beats) are kept whole. Requires ID remapping. Only this Master IF
+//                splits, the reorder and VC ones send every burst as a single packet
+template <typename cfg, unsigned char REMAP_TAGS=0, unsigned char RD_ROB_BEATS=16, unsigned char STRIPE_CH=0, unsigned char LOG_STRIPE=12, unsigned short MAX_BEATS=0>
 SC_MODULE(axi_master_if) {
+  // The sub-bursts are merged back by their tags
+  static_assert((MAX_BEATS==0) || (REMAP_TAGS>0), "Maximum packet length (MAX_BEATS) requires ID remapping (REMAP_TAGS>0).");
+  
   typedef typename axi::axi4<axi::cfg::standard_duth> axi4_;
   typedef typename axi::AXI4_Encoding                 enc_;
   
@@ -73,6 +127,18 @@ SC_MODULE(axi_master_if) {
   const unsigned char LOG_RD_M_LANES = nvhls::log2_ceil<cfg::RD_LANES>::val;
   const unsigned char LOG_WR_M_LANES = nvhls::log2_ceil<cfg::WR_LANES>::val;
   
+  static const unsigned char TAGS      = (REMAP_TAGS>0) ? REMAP_TAGS : 1; // Sizes the remap storage, even when unused
+  static const unsigned char LOG_STRIPE_CH = nvhls::log2_ceil<STRIPE_CH>::val;
+  static const unsigned char ROB_SLOTS = (RD_ROB_BEATS>0) ? RD_ROB_BEATS : 1;
+  static const unsigned char REMAP_NONE = 255; // Null tag/slot pointer
+  
+  // Reorder buffer slot, an early RD response beat
+  struct remap_rob_entry {
+    axi4_::ReadPayload beat;
+    unsigned char      nxt_slot;
+    bool               valid;
+  };
+  
   sc_in_clk    clk;
   sc_in <bool> rst_n;
   
@@ -108,14 +174,46 @@ SC_MODULE(axi_master_if) {
   sc_fifo<sc_uint<dnp::ID_W>>  wr_trans_fin{"wr_trans_fin"};
   outs_table_entry     wr_out_table[1<<dnp::ID_W];
   
+  // --- ID Remapping Internals --- //
+  // Packetizer side. The tag pool and what each tag holds. The fin FIFOs return tags instead of IDs
+  sc_fifo<remap_info>  rd_remap_init{"rd_remap_init"};
+  bool                 rd_tag_free[TAGS];
+  sc_uint<dnp::ID_W>   rd_tag_tid[TAGS];
+  unsigned int         rd_tag_beats[TAGS]; // Reserved reorder buffer beats
+  unsigned int         rd_rob_free;
+  
+  sc_fifo<remap_info>  wr_remap_init{"wr_remap_init"};
+  bool                 wr_tag_free[TAGS];
+  sc_uint<dnp::ID_W>   wr_tag_tid[TAGS];
+  
+  // Depacketizer side. Per ID order of the tags and the reorder buffer
+  remap_book_entry     rd_remap_book[1<<dnp::ID_W];
+  remap_tag_entry      rd_remap_tags[TAGS];
+  remap_rob_entry      rd_rob[ROB_SLOTS];
+  
+  remap_book_entry     wr_remap_book[1<<dnp::ID_W];
+  remap_tag_entry      wr_remap_tags[TAGS];
+  sc_uint<dnp::RE_W>   wr_split_resp[1<<dnp::ID_W]; // The worst response of the sent sub-bursts, per ID
+  
   // Constructor
   SC_HAS_PROCESS(axi_master_if);
     axi_master_if(sc_module_name name_="axi_master_if")
     :
     sc_module (name_),
-    rd_trans_fin  (2),
-    wr_trans_fin  (2)
+    rd_trans_fin  ((REMAP_TAGS>2) ? REMAP_TAGS : 2), // Holds every remapped finished transaction, thus the depacketizer never blocks on it
+    wr_trans_fin  ((REMAP_TAGS>2) ? REMAP_TAGS : 2),
+    rd_remap_init (2),
+    wr_remap_init (2)
   {
+    NVHLS_ASSERT_MSG(REMAP_TAGS <= (1<<dnp::ID_W), "Remap tags exceed the ID width.");
+    NVHLS_ASSERT_MSG((REMAP_TAGS <= (1<<dnp::REORD_W)) || (cfg::WRESP_PHITS>1), "More than 8 remap tags require WRESP_PHITS>1.");
+    NVHLS_ASSERT_MSG(RD_ROB_BEATS < 255, "RD reorder buffer beats exceed the slot pointers.");
+    NVHLS_ASSERT_MSG((STRIPE_CH==0) || (REMAP_TAGS>0), "Channel striping requires ID remapping.");
+    NVHLS_ASSERT_MSG((STRIPE_CH & (STRIPE_CH-1))==0 && STRIPE_CH<=cfg::SLAVE_NUM, "Striped channels must be a power of 2 of the Slaves.");
+    NVHLS_ASSERT_MSG((STRIPE_CH==0) || ((LOG_STRIPE>=8) && (LOG_STRIPE<=12)), "Stripe granularity must be 256B to 4KB.");
+    NVHLS_ASSERT_MSG((MAX_BEATS==0) || (REMAP_TAGS>0), "Maximum packet length requires ID remapping.");
+    NVHLS_ASSERT_MSG(MAX_BEATS <= (1<<dnp::LE_W), "Maximum packet length exceeds the AXI burst length.");
+    
     SC_THREAD(rd_req_pack_job);
     sensitive << clk.pos();
     async_reset_signal_is(rst_n, false);
@@ -151,22 +249,60 @@ SC_MODULE(axi_master_if) {
     sc_uint<LOG_MAX_OUTS> outstanding = 0;
     sc_uint<dnp::D_W>     out_dst = 0;
     
+    // For ID remapping, all tags and reorder buffer beats are free
+    #pragma hls_unroll yes
+    for (int i=0; i<TAGS; ++i) {
+      rd_tag_free[i]  = true;
+      rd_tag_tid[i]   = 0;
+      rd_tag_beats[i] = 0;
+    }
+    rd_rob_free = RD_ROB_BEATS;
+    
     ar_in.Reset();
     rd_flit_out.Reset();
     
     axi4_::AddrPayload this_req;
+    axi4_::AddrPayload split_req;         // The rest of a split burst, sent as sub-bursts
+    bool               split_more = false;
+    FLIT_TS_DO(flit_ts::stamp_t ts_acc = 0;)
     //-- End of Reset ---//
     #pragma hls_pipeline_init_interval 1
     #pragma pipeline_stall_mode flush
     while(1) {
       wait();
-      if(ar_in.PopNB(this_req)) {
+      if(split_more || ar_in.PopNB(split_req)) {
+        FLIT_TS_DO(if (!split_more) ts_acc = flit_ts::now();)
+        split_more = burst_split(split_req, this_req);
         // A new request must stall until it is eligible to depart.
         // Depending the reordering scheme
         // 0 : all in-flight transactions must be to the same destination
         // 1 : all in-flight transactions of the SAME ID, must be to the same destination
+        // When remapping IDs, a request only waits for a free tag and the reorder buffer space its response may need
         sc_uint<dnp::D_W> this_dst = addr_lut_rd(this_req.addr);
-        if (cfg::ORD_SCHEME==0) {
+        axi4_::Addr       net_addr = stripe_addr(this_req.addr);
+        sc_uint<dnp::ID_W> this_tag = 0;
+        if (REMAP_TAGS>0) {
+          // A response overtakes older ones of its ID only when they are in-flight. Then it may need to be buffered
+          unsigned int beats     = this_req.len.to_uint()+1;
+          bool         needs_rob = (rd_out_table[this_req.id.to_uint()].sent>0);
+          #pragma hls_pipeline_init_interval 1
+          #pragma pipeline_stall_mode flush
+          while(!rd_remap_avail() || (needs_rob && (rd_rob_free<beats)) || rd_flit_out.Full()) {
+            sc_uint<dnp::ID_W> tag_fin;
+            if(rd_trans_fin.nb_read(tag_fin)) rd_remap_fin(tag_fin);
+            needs_rob = (rd_out_table[this_req.id.to_uint()].sent>0);
+            wait();
+          }; // End of while
+          this_tag = rd_remap_alloc(this_req.id.to_uint(), (needs_rob ? beats : 0));
+          rd_out_table[this_req.id.to_uint()].sent++;
+          rd_out_table[this_req.id.to_uint()].dst_last  = this_dst;
+          
+          remap_info new_info;
+          new_info.tid  = this_req.id.to_uint();
+          new_info.tag  = this_tag;
+          new_info.more = split_more;
+          rd_remap_init.write(new_info);
+        } else if (cfg::ORD_SCHEME==0) {
           // Poll for Finished transactions until reordering is not possible.
           #pragma hls_pipeline_init_interval 1
           #pragma pipeline_stall_mode flush
@@ -204,28 +340,31 @@ SC_MODULE(axi_master_if) {
         // Packetize request into a flit. The fields are described in DNP20
         rreq_flit_t tmp_flit;
         tmp_flit.type = SINGLE; // Entire request fits in at single flits thus SINGLE
-        tmp_flit.data[0] = ((sc_uint<dnp::PHIT_W>)0                      << dnp::req::REORD_PTR) |
+        tmp_flit.data[0] = ((sc_uint<dnp::PHIT_W>)(this_tag & ((1<<dnp::REORD_W)-1)) << dnp::req::REORD_PTR) |
                            ((sc_uint<dnp::PHIT_W>)this_req.id            << dnp::req::ID_PTR )   |
                            ((sc_uint<dnp::PHIT_W>)dnp::PACK_TYPE__RD_REQ << dnp::T_PTR      )    |
-                           ((sc_uint<dnp::PHIT_W>) 0                     << dnp::Q_PTR      )    |
+                           ((sc_uint<dnp::PHIT_W>)(this_req.qos>>1)      << dnp::Q_PTR      )    |
                            ((sc_uint<dnp::PHIT_W>)this_dst               << dnp::D_PTR      )    |
                            ((sc_uint<dnp::PHIT_W>)THIS_ID                << dnp::S_PTR      )    |
                            ((sc_uint<dnp::PHIT_W>)0                      << dnp::V_PTR      )    ;
         
         tmp_flit.data[1] = ((sc_uint<dnp::PHIT_W>)this_req.len             << dnp::req::LE_PTR) |
-                           ((sc_uint<dnp::PHIT_W>)(this_req.addr & 0xffff) << dnp::req::AL_PTR) ;
+                           ((sc_uint<dnp::PHIT_W>)(net_addr & 0xffff)      << dnp::req::AL_PTR) ;
         
-        tmp_flit.data[2] = ((sc_uint<dnp::PHIT_W>)this_req.burst               << dnp::req::BU_PTR ) |
+        tmp_flit.data[2] = ((sc_uint<dnp::PHIT_W>)(this_tag >> dnp::REORD_W)   << dnp::req::REORD_H_PTR) |
+                           ((sc_uint<dnp::PHIT_W>)this_req.burst               << dnp::req::BU_PTR ) |
                            ((sc_uint<dnp::PHIT_W>)this_req.size                << dnp::req::SZ_PTR ) |
-                           ((sc_uint<dnp::PHIT_W>)(this_req.addr >> dnp::AL_W) << dnp::req::AH_PTR ) ;
+                           ((sc_uint<dnp::PHIT_W>)(net_addr >> dnp::AL_W)      << dnp::req::AH_PTR ) ;
         
+        FLIT_TS_DO(tmp_flit.ts.inject(ts_acc);)
         rd_flit_out.Push(tmp_flit);
       } else {
         // No RD Req from Master, simply check for finished Outstanding trans
         sc_uint<dnp::ID_W> tid_fin;
         if(rd_trans_fin.nb_read(tid_fin)) {
-          if (cfg::ORD_SCHEME==0) outstanding--;
-          else                    rd_out_table[tid_fin].sent--; // update outstanding table
+          if      (REMAP_TAGS>0)         rd_remap_fin(tid_fin);
+          else if (cfg::ORD_SCHEME==0)   outstanding--;
+          else                           rd_out_table[tid_fin].sent--; // update outstanding table
         }
       }
     } // End of while(1)
@@ -237,12 +376,25 @@ SC_MODULE(axi_master_if) {
   void rd_resp_depack_job () {
     r_out.Reset();
     rd_flit_in.Reset();
+    remap_reset(rd_remap_book, rd_remap_tags);
+    #pragma hls_unroll yes
+    for (int i=0; i<ROB_SLOTS; ++i) rd_rob[i].valid = false;
     while(1) {
       // Get the response flits, depacketize them to form AXI Master's response and
       //   inform the packetizer for the transaction completion
       rresp_flit_t flit_rcv;
-      flit_rcv = rd_flit_in.Pop();
+      if (REMAP_TAGS>0) {
+        // Buffered responses are drained to Master, as soon as they become the oldest of their ID
+        wait();
+        remap_info new_info;
+        if (rd_remap_init.nb_read(new_info)) remap_push(rd_remap_book, rd_remap_tags, new_info);
+        if (rd_remap_drain())            continue;
+        if (!rd_flit_in.PopNB(flit_rcv)) continue;
+      } else {
+        flit_rcv = rd_flit_in.Pop();
+      }
       
+      FLIT_TS_DO(flit_ts_stats::get().record(false, THIS_ID.read(), flit_rcv.get_src(), flit_rcv.ts);)
       // Construct the transaction's attributes to build the response accordingly.
       axi4_::AddrPayload   active_trans;
       active_trans.id    = (flit_rcv.data[0] >> dnp::rresp::ID_PTR) & ((1 << dnp::ID_W) - 1);
@@ -250,6 +402,15 @@ SC_MODULE(axi_master_if) {
       active_trans.size  = (flit_rcv.data[1] >> dnp::rresp::SZ_PTR) & ((1 << dnp::SZ_W) - 1);
       active_trans.len   = (flit_rcv.data[1] >> dnp::rresp::LE_PTR) & ((1 << dnp::LE_W) - 1);
       
+      // A remapped response that overtook older ones of its ID is kept in the reorder buffer
+      unsigned char this_tag = 0;
+      bool          to_rob   = false;
+      if (REMAP_TAGS>0) {
+        this_tag = get_rresp_ticket(flit_rcv);
+        while (!rd_remap_tags[this_tag].pending) remap_push(rd_remap_book, rd_remap_tags, rd_remap_init.read());
+        to_rob = (rd_remap_book[active_trans.id.to_uint()].head_tag != this_tag);
+      }
+      
       sc_uint<dnp::SZ_W> final_size        = (unsigned) active_trans.size;
       // Partial lower 8-bit part of address to calculate the initial axi pointer in case of a non-aligned address
       sc_uint<dnp::AP_W> addr_part         = (flit_rcv.data[1] >> dnp::rresp::AP_PTR) & ((1<<dnp::AP_W) - 1);
@@ -266,9 +427,9 @@ SC_MODULE(axi_master_if) {
       
       // For data Depacketization loop, we keep 2 pointers.
       //   axi_lane_ptr  -> to keep track axi byte lanes to place to data
-      //   flit_phit_ptr -> to point at the data of the flit
+      //   flit_byte_ptr -> to point at the data of the flit
       sc_uint<8>        axi_lane_ptr   = addr_init_aligned;  // Bytes MOD axi size
-      cnt_phit_rresp_t  flit_phit_ptr  = 0;                  // Bytes MOD phits in flit
+      sc_uint<8>        flit_byte_ptr  = 0;                  // Bytes MOD bytes in flit
       // Also we keep track the processed and total data.
       sc_uint<16>  bytes_total    = ((active_trans.len.to_uint()+1)<<final_size);
       sc_uint<16>  bytes_depacked = 0;                                  // Number of DE-packetized bytes
@@ -284,44 +445,59 @@ SC_MODULE(axi_master_if) {
         // Each iteration moves data from the flit the the appropriate place on the AXI RD response
         // The two flit and axi pointers orchistrate the operation, until completion
         sc_uint<8> bytes_axi_left  = ((1<<final_size) - (axi_lane_ptr & ((1<<final_size)-1)));
-        sc_uint<8> bytes_flit_left = ((cfg::RRESP_PHITS<<1) - (flit_phit_ptr<<1));
+        sc_uint<8> bytes_flit_left = ((cfg::RRESP_PHITS<<dnp::BPP_W) - flit_byte_ptr);
         sc_uint<8> bytes_per_iter  = (bytes_axi_left<bytes_flit_left) ? bytes_axi_left : bytes_flit_left;
         
-        if(flit_phit_ptr==0)
+        if(flit_byte_ptr==0)
           flit_rcv = rd_flit_in.Pop();
         
         #pragma hls_unroll yes
-        build_resp: for (int i = 0; i < (cfg::RD_LANES >> 1); ++i) { // i counts AXI Byte Lanes IN PHITS (i.e. Lanes/bytes_in_phit)
-          if (i>=(axi_lane_ptr>>1) && i<((axi_lane_ptr+bytes_per_iter)>>1)) {
-            cnt_phit_rresp_t loc_flit_ptr = flit_phit_ptr + (i-(axi_lane_ptr>>1));
-            resp_build_tmp[(i << 1) + 1] = (flit_rcv.data[loc_flit_ptr] >> dnp::rdata::B1_PTR) & ((1 << dnp::B_W) - 1); // MSB
-            resp_build_tmp[(i << 1)    ] = (flit_rcv.data[loc_flit_ptr] >> dnp::rdata::B0_PTR) & ((1 << dnp::B_W) - 1); // LSB
+        build_resp: for (int u = 0; u < (cfg::RD_LANES>>dnp::PACK_GRAN_W); ++u) { // u counts AXI Byte Lanes IN PACKING UNITS (i.e. phits, or bytes when narrow packing)
+          if ((u<<dnp::PACK_GRAN_W)>=axi_lane_ptr && (u<<dnp::PACK_GRAN_W)<(axi_lane_ptr+bytes_per_iter)) {
+            sc_uint<8> loc_flit_byte = flit_byte_ptr + ((u<<dnp::PACK_GRAN_W)-axi_lane_ptr);
+            sc_uint<8> loc_flit_ptr  = loc_flit_byte >> dnp::BPP_W;                      // The unit's phit
+            sc_uint<8> loc_phit_byte = loc_flit_byte & (dnp::BPP-dnp::PACK_GRAN);        // and its first byte in it, 0 unless narrow packing
+            #pragma hls_unroll yes
+            for (int b=0; b<dnp::PACK_GRAN; ++b) {
+              resp_build_tmp[(u<<dnp::PACK_GRAN_W)+b] = (flit_rcv.data[loc_flit_ptr] >> (dnp::rdata::B0_PTR+(loc_phit_byte+b)*dnp::B_W)) & ((1<<dnp::B_W)-1);
+            }
           }
         }
         
         bool done_job  = ((bytes_depacked+bytes_per_iter)==bytes_total);             // All bytes are processed
-        bool done_flit = (flit_phit_ptr+(bytes_per_iter>>1)==cfg::RRESP_PHITS);      // Flit got empty
+        bool done_flit = ((flit_byte_ptr+bytes_per_iter)==(cfg::RRESP_PHITS<<dnp::BPP_W)); // Flit got empty
         bool done_axi  = (((bytes_depacked+bytes_per_iter)&((1<<final_size)-1))==0); // Beat got full
         
         // Push the response to MASTER, when either this Beat got the needed bytes or all bytes are transferred
         if( done_job || done_axi ) {
           axi4_::ReadPayload builder_resp;
           builder_resp.id   = active_trans.id;
-          builder_resp.resp = (flit_rcv.data[flit_phit_ptr] >> dnp::rdata::RE_PTR) & ((1 << dnp::RE_W) - 1);
+          // The response of the beat's unit, that of its own beat under narrow packing
+          builder_resp.resp = (flit_rcv.data[flit_byte_ptr>>dnp::BPP_W] >> (dnp::rdata::RE_PTR+((flit_byte_ptr & (dnp::BPP-1))>>dnp::PACK_GRAN_W)*dnp::RE_W)) & ((1 << dnp::RE_W) - 1);
           builder_resp.last = ((bytes_depacked+bytes_per_iter)==bytes_total);
           duth_fun<axi4_::Data, cfg::RD_LANES>::assign_char2ac(builder_resp.data, resp_build_tmp);
-          r_out.Push(builder_resp);
+          if (to_rob) {
+            rd_remap_store(this_tag, builder_resp);
+          } else {
+            builder_resp.last = builder_resp.last && !rd_remap_tags[this_tag].more; // Only the last sub-burst ends a striped one
+            r_out.Push(builder_resp);
+          }
           #pragma hls_unroll yes
           for(int i=0; i<cfg::RD_LANES; ++i) resp_build_tmp[i] = 0;
         }
         
         // Check to either finish transaction or update the pointers for the next iteration
         if (done_job) { // End of transaction
-          rd_trans_fin.write(active_trans.id.to_uint());
+          if (REMAP_TAGS>0) {
+            if (to_rob) rd_remap_tags[this_tag].stored = true;
+            else        rd_remap_done(this_tag);
+          } else {
+            rd_trans_fin.write(active_trans.id.to_uint());
+          }
           break;
         } else {
           bytes_depacked +=bytes_per_iter;
-          flit_phit_ptr = (done_flit) ? 0 : (flit_phit_ptr +(bytes_per_iter>>1));
+          flit_byte_ptr = (done_flit) ? 0 : (flit_byte_ptr + bytes_per_iter);
           axi_lane_ptr  = (active_trans.burst==enc_::AXBURST::FIXED) ? ((axi_lane_ptr+bytes_per_iter) & ((1<<final_size)-1)) + addr_init_aligned :
                                                                        ((axi_lane_ptr+bytes_per_iter) & (cfg::RD_LANES-1)) ;
         }
@@ -346,16 +522,47 @@ SC_MODULE(axi_master_if) {
     sc_uint<LOG_MAX_OUTS> outstanding = 0;
     sc_uint<dnp::D_W>     out_dst = 0;
     
+    #pragma hls_unroll yes
+    for (int i=0; i<TAGS; ++i) {
+      wr_tag_free[i] = true;
+      wr_tag_tid[i]  = 0;
+    }
+    
     axi4_::AddrPayload this_req;
+    axi4_::AddrPayload split_req;         // The rest of a split burst, sent as sub-bursts
+    bool               split_more = false;
+    FLIT_TS_DO(flit_ts::stamp_t ts_acc = 0;)
     wait();
     while(1) {
-      if(aw_in.PopNB(this_req)) { // New Request
+      if(split_more || aw_in.PopNB(split_req)) { // New Request, or the next sub-burst
+        FLIT_TS_DO(if (!split_more) ts_acc = flit_ts::now();)
+        split_more = burst_split(split_req, this_req);
         // A new request must stall until it is eligible to depart.
         // Depending the reordering scheme
         // 0 : all in-flight transactions must be to the same destination
         // 1 : all in-flight transactions of the SAME ID, must be to the same destination
+        // When remapping IDs, a request only waits for a free tag
         sc_uint<dnp::D_W> this_dst = addr_lut_wr(this_req.addr);
-        if (cfg::ORD_SCHEME==0) {
+        axi4_::Addr       net_addr = stripe_addr(this_req.addr);
+        sc_uint<dnp::ID_W> this_tag = 0;
+        if (REMAP_TAGS>0) {
+          #pragma hls_pipeline_init_interval 1
+          #pragma pipeline_stall_mode flush
+          while(!wr_remap_avail() || wr_flit_out.Full()) {
+            sc_uint<dnp::ID_W> tag_fin;
+            if(wr_trans_fin.nb_read(tag_fin)) wr_remap_fin(tag_fin);
+            wait();
+          }; // End of while
+          this_tag = wr_remap_alloc(this_req.id.to_uint());
+          wr_out_table[this_req.id.to_uint()].sent++;
+          wr_out_table[this_req.id.to_uint()].dst_last = this_dst;
+          
+          remap_info new_info;
+          new_info.tid  = this_req.id.to_uint();
+          new_info.tag  = this_tag;
+          new_info.more = split_more;
+          wr_remap_init.write(new_info);
+        } else if (cfg::ORD_SCHEME==0) {
           // Poll for Finished transactions until reordering is not possible.
           #pragma hls_pipeline_init_interval 1
           #pragma pipeline_stall_mode flush
@@ -390,33 +597,42 @@ SC_MODULE(axi_master_if) {
         rreq_flit_t tmp_flit;
         wreq_flit_t tmp_mule_flit;
         tmp_mule_flit.type    = HEAD;
-        tmp_mule_flit.data[0] = ((sc_uint<dnp::PHIT_W>)0                       << dnp::req::REORD_PTR) |
+        tmp_mule_flit.data[0] = ((sc_uint<dnp::PHIT_W>)(this_tag & ((1<<dnp::REORD_W)-1)) << dnp::req::REORD_PTR) |
                                 ((sc_uint<dnp::PHIT_W>)this_req.id             << dnp::req::ID_PTR)    |
                                 ((sc_uint<dnp::PHIT_W>)dnp::PACK_TYPE__WR_REQ  << dnp::T_PTR)          |
-                                ((sc_uint<dnp::PHIT_W>)0                       << dnp::Q_PTR)          |
+                                ((sc_uint<dnp::PHIT_W>)(this_req.qos>>1)       << dnp::Q_PTR)          |
                                 ((sc_uint<dnp::PHIT_W>)this_dst                << dnp::D_PTR)          |
                                 ((sc_uint<dnp::PHIT_W>)THIS_ID                 << dnp::S_PTR)          |
                                 ((sc_uint<dnp::PHIT_W>)0                       << dnp::V_PTR)          ;
         
         tmp_mule_flit.data[1] = ((sc_uint<dnp::PHIT_W>) this_req.len            << dnp::req::LE_PTR) |
-                                ((sc_uint<dnp::PHIT_W>)(this_req.addr & 0xffff) << dnp::req::AL_PTR) ;
+                                ((sc_uint<dnp::PHIT_W>)(net_addr & 0xffff)      << dnp::req::AL_PTR) ;
         
-        tmp_mule_flit.data[2] = ((sc_uint<dnp::PHIT_W>)this_req.burst               << dnp::req::BU_PTR)  |
+        tmp_mule_flit.data[2] = ((sc_uint<dnp::PHIT_W>)(this_tag >> dnp::REORD_W)   << dnp::req::REORD_H_PTR) |
+                                ((sc_uint<dnp::PHIT_W>)this_req.burst               << dnp::req::BU_PTR)  |
                                 ((sc_uint<dnp::PHIT_W>)this_req.size                << dnp::req::SZ_PTR)  |
-                                ((sc_uint<dnp::PHIT_W>)(this_req.addr >> dnp::AL_W) << dnp::req::AH_PTR)  ;
+                                ((sc_uint<dnp::PHIT_W>)(net_addr >> dnp::AL_W)      << dnp::req::AH_PTR)  ;
         
+        // A short write carries its single beat past the header, thus the header flit is sent with the data
+        bool short_wr = dnp::SHORT_WR && (cfg::WREQ_PHITS>dnp::req::WDATA_PHIT) && (this_req.len==0) &&
+                        ((1<<this_req.size.to_uint()) <= ((cfg::WREQ_PHITS-dnp::req::WDATA_PHIT)<<dnp::BPP_W));
+
+        FLIT_TS_DO(tmp_mule_flit.ts.inject(ts_acc);)
         // push header flit to NoC
-        #pragma hls_pipeline_init_interval 1
-        #pragma pipeline_stall_mode flush
-        while (!wr_flit_out.PushNB(tmp_mule_flit)) {
-          sc_uint<dnp::ID_W> tid_fin;
-          if(wr_trans_fin.nb_read(tid_fin)) {
-            if (cfg::ORD_SCHEME==0) outstanding--;
-            else                    wr_out_table[tid_fin].sent--; // update outstanding table
+        if (!short_wr) {
+          #pragma hls_pipeline_init_interval 1
+          #pragma pipeline_stall_mode flush
+          while (!wr_flit_out.PushNB(tmp_mule_flit)) {
+            sc_uint<dnp::ID_W> tid_fin;
+            if(wr_trans_fin.nb_read(tid_fin)) {
+              if      (REMAP_TAGS>0)         wr_remap_fin(tid_fin);
+              else if (cfg::ORD_SCHEME==0)   outstanding--;
+              else                           wr_out_table[tid_fin].sent--; // update outstanding table
+            }
+            wait();
           }
-          wait();
         }
-        
+
         // --- Start DATA Packetization --- //
         // Data Depacketization happens in a loop. Each iteration pops a flit and constructs a beat.
         //   Multiple iterations may be needed either the consume incoming data or fill a flit, which
@@ -432,9 +648,9 @@ SC_MODULE(axi_master_if) {
         sc_uint<8>   addr_init_aligned = (this_req.addr.to_uint() & (cfg::WR_LANES-1)) & ~((1<<this_req.size.to_uint())-1);
         // For data Depacketization we keep 2 pointers.
         //   - One to keep track axi byte lanes to place to data  (axi_lane_ptr)
-        //   - One to point at the data of the flit               (flit_phit_ptr)
+        //   - One to point at the data of the flit               (flit_byte_ptr)
         sc_uint<8>       axi_lane_ptr  = addr_init_aligned; // Bytes MOD size
-        cnt_phit_wreq_t  flit_phit_ptr = 0;                 // Bytes MOD phits in flit
+        sc_uint<8>       flit_byte_ptr = short_wr ? (dnp::req::WDATA_PHIT<<dnp::BPP_W) : 0; // Bytes MOD bytes in flit
         
         sc_uint<16>  bytes_total  = ((this_req.len.to_uint()+1)<<this_req.size.to_uint());
         sc_uint<16>  bytes_packed = 0;
@@ -447,45 +663,52 @@ SC_MODULE(axi_master_if) {
         gather_wr_beats : while (1) {
           // Calculate the bytes transferred in this iteration, depending the available flit bytes and the remaining to the beat
           sc_uint<8> bytes_axi_left  = ((1<<this_req.size.to_uint()) - (axi_lane_ptr & ((1<<this_req.size.to_uint())-1)));
-          sc_uint<8> bytes_flit_left = ((cfg::WREQ_PHITS<<1)         - (flit_phit_ptr<<1));
+          sc_uint<8> bytes_flit_left = ((cfg::WREQ_PHITS<<dnp::BPP_W)         - flit_byte_ptr);
           sc_uint<8> bytes_per_iter  = (bytes_axi_left<bytes_flit_left) ? bytes_axi_left : bytes_flit_left;
           
           // If current beat has been packed, get the next one
           if((bytes_packed & ((1<<this_req.size.to_uint())-1))==0) {
             axi4_::WritePayload this_wr;
             this_wr  = w_in.Pop();
-            last_tmp = this_wr.last;
+            last_tmp = this_wr.last || ((bytes_packed + (1<<this_req.size.to_uint())) == bytes_total); // Or the last of a sub-burst
             duth_fun<axi4_::Data , cfg::WR_LANES>::assign_ac2char(data_build_tmp , this_wr.data);
             duth_fun<axi4_::Wstrb, cfg::WR_LANES>::assign_ac2bool(wstrb_tmp      , this_wr.wstrb);
           }
           
-          // Convert AXI Beats to flits.
+          // Convert AXI Beats to flits. With narrow packing several beats may fill a phit,
+          //   its first unit starts it over and the rest are merged into it
           #pragma hls_unroll yes
-          for (int i=0; i<cfg::WREQ_PHITS; ++i){ // i counts phits on the flit
-            if(i>=flit_phit_ptr && i<(flit_phit_ptr+(bytes_per_iter>>1))) {
-              sc_uint<8> loc_axi_ptr = (axi_lane_ptr + ((i-flit_phit_ptr)<<1));
-              tmp_mule_flit.data[i] = ((sc_uint<dnp::PHIT_W>)last_tmp                      << dnp::wdata::LA_PTR ) | // MSB
-                                      ((sc_uint<dnp::PHIT_W>)wstrb_tmp[loc_axi_ptr+1]      << dnp::wdata::E1_PTR ) |
-                                      ((sc_uint<dnp::PHIT_W>)wstrb_tmp[loc_axi_ptr  ]      << dnp::wdata::E0_PTR ) |
-                                      ((sc_uint<dnp::PHIT_W>)data_build_tmp[loc_axi_ptr+1] << dnp::wdata::B1_PTR ) | // (i*2) % 4
-                                      ((sc_uint<dnp::PHIT_W>)data_build_tmp[loc_axi_ptr  ] << dnp::wdata::B0_PTR ) ;
+          for (int u=0; u<((cfg::WREQ_PHITS<<dnp::BPP_W)>>dnp::PACK_GRAN_W); ++u){ // u counts packing units on the flit
+            if((u<<dnp::PACK_GRAN_W)>=flit_byte_ptr && (u<<dnp::PACK_GRAN_W)<(flit_byte_ptr+bytes_per_iter)) {
+              const int  p   = u>>(dnp::BPP_W-dnp::PACK_GRAN_W);     // The unit's phit
+              const int  off = (u<<dnp::PACK_GRAN_W)&(dnp::BPP-1);   // and its first byte in it
+              sc_uint<8> loc_axi_ptr = (axi_lane_ptr + ((u<<dnp::PACK_GRAN_W)-flit_byte_ptr));
+              sc_uint<dnp::PHIT_W> phit = (off==0) ? (sc_uint<dnp::PHIT_W>)0 : tmp_mule_flit.data[p];
+              phit |= (sc_uint<dnp::PHIT_W>)last_tmp << dnp::wdata::LA_PTR; // MSB
+              #pragma hls_unroll yes
+              for (int b=0; b<dnp::PACK_GRAN; ++b) {
+                phit |= ((sc_uint<dnp::PHIT_W>)wstrb_tmp[loc_axi_ptr+b]      << (dnp::wdata::E0_PTR+(off+b)*dnp::E_W)) |
+                        ((sc_uint<dnp::PHIT_W>)data_build_tmp[loc_axi_ptr+b] << (dnp::wdata::B0_PTR+(off+b)*dnp::B_W)) ;
+              }
+              tmp_mule_flit.data[p] = phit;
             }
           }
           
           // transaction event flags
           bool done_job  = ((bytes_packed+bytes_per_iter)==bytes_total);                            // All bytes are processed
-          bool done_flit = (flit_phit_ptr+(bytes_per_iter>>1)==cfg::WREQ_PHITS);                    // Flit got empty
+          bool done_flit = ((flit_byte_ptr+bytes_per_iter)==(cfg::WREQ_PHITS<<dnp::BPP_W));                 // Flit got empty
           bool done_axi  = (((bytes_packed+bytes_per_iter)&((1<<(this_req.size.to_uint()))-1))==0); // Beat got full
           
           if(done_job || done_flit) {
-            tmp_mule_flit.type = (bytes_packed+bytes_per_iter==bytes_total) ? TAIL : BODY;
+            tmp_mule_flit.type = (short_wr) ? SINGLE : (bytes_packed+bytes_per_iter==bytes_total) ? TAIL : BODY;
             #pragma hls_pipeline_init_interval 1
             #pragma pipeline_stall_mode flush
             while (!wr_flit_out.PushNB(tmp_mule_flit)) {
               sc_uint<dnp::ID_W> tid_fin;
               if(wr_trans_fin.nb_read(tid_fin)) {
-                if (cfg::ORD_SCHEME==0) outstanding--;
-                else                    wr_out_table[tid_fin].sent--; // update outstanding table
+                if      (REMAP_TAGS>0)         wr_remap_fin(tid_fin);
+                else if (cfg::ORD_SCHEME==0)   outstanding--;
+                else                           wr_out_table[tid_fin].sent--; // update outstanding table
               }
               wait();
             }
@@ -496,7 +719,7 @@ SC_MODULE(axi_master_if) {
             break;
           } else { // Move to next iteration
             bytes_packed  = bytes_packed+bytes_per_iter;
-            flit_phit_ptr = (done_flit) ? 0 : (flit_phit_ptr +(bytes_per_iter>>1));
+            flit_byte_ptr = (done_flit) ? 0 : (flit_byte_ptr + bytes_per_iter);
             axi_lane_ptr  = ((unsigned)this_req.burst==enc_::AXBURST::FIXED) ? ((axi_lane_ptr+bytes_per_iter) & ((1<<this_req.size.to_uint())-1)) + addr_init_aligned :
                             ((axi_lane_ptr+bytes_per_iter) & (cfg::WR_LANES-1)) ;
           }
@@ -505,8 +728,9 @@ SC_MODULE(axi_master_if) {
         // When no request, Check for finished transactions
         sc_uint<dnp::ID_W> tid_fin;
         if(wr_trans_fin.nb_read(tid_fin)) {
-          if (cfg::ORD_SCHEME==0) outstanding--;
-          else                    wr_out_table[tid_fin].sent--;
+          if      (REMAP_TAGS>0)         wr_remap_fin(tid_fin);
+          else if (cfg::ORD_SCHEME==0)   outstanding--;
+          else                           wr_out_table[tid_fin].sent--;
         }
         wait();
       }
@@ -520,39 +744,304 @@ SC_MODULE(axi_master_if) {
   void wr_resp_depack_job(){
     wr_flit_in.Reset();
     b_out.Reset();
+    remap_reset(wr_remap_book, wr_remap_tags);
+    #pragma hls_unroll yes
+    for (int i=0; i<(1<<dnp::ID_W); ++i) wr_split_resp[i] = 0;
     wait();
     #pragma hls_pipeline_init_interval 1
     #pragma pipeline_stall_mode flush
     while(1) {
-      // Blocking read from NoC to start depacketize the response
+      // Read from NoC to start depacketize the response. Blocking, unless remapping that also checks the stored ones
       wresp_flit_t flit_rcv;
-      flit_rcv = wr_flit_in.Pop();
+      axi4_::WRespPayload this_resp;
+      if (REMAP_TAGS>0) {
+        // A stored response is sent first, as soon as it becomes the oldest of its ID
+        wait();
+        remap_info    new_info;
+        unsigned char ready_tag;
+        if (wr_remap_init.nb_read(new_info)) remap_push(wr_remap_book, wr_remap_tags, new_info);
+        if (remap_ready(wr_remap_book, wr_remap_tags, ready_tag)) {
+          this_resp.id   = wr_remap_tags[ready_tag].tid.to_uint();
+          this_resp.resp = wr_remap_tags[ready_tag].resp.to_uint();
+          wr_remap_respond(ready_tag, this_resp);
+          wr_remap_done(ready_tag);
+          continue;
+        }
+        if (!wr_flit_in.PopNB(flit_rcv)) continue;
+      } else {
+        flit_rcv = wr_flit_in.Pop();
+      }
       
+      FLIT_TS_DO(flit_ts_stats::get().record(true, THIS_ID.read(), flit_rcv.get_src(), flit_rcv.ts);)
       // Construct the trans Header to create the response
-      axi4_::WRespPayload this_resp;
       sc_uint<dnp::ID_W> this_tid = (flit_rcv.data[0] >> dnp::wresp::ID_PTR) & ((1 << dnp::ID_W) - 1);
       this_resp.id = this_tid.to_uint();
       this_resp.resp = (flit_rcv.data[0] >> dnp::wresp::RESP_PTR) & ((1 << dnp::RE_W) - 1);
       
-      b_out.Push(this_resp);        // Send the response to MASTER
-      wr_trans_fin.write(this_tid); // Inform Packetizer for finished transaction
+      if (REMAP_TAGS>0) {
+        // An early response waits for the older ones of its ID
+        unsigned char this_tag = get_wresp_ticket(flit_rcv);
+        while (!wr_remap_tags[this_tag].pending) remap_push(wr_remap_book, wr_remap_tags, wr_remap_init.read());
+        if (wr_remap_book[this_tid].head_tag != this_tag) {
+          wr_remap_tags[this_tag].resp   = this_resp.resp;
+          wr_remap_tags[this_tag].stored = true;
+        } else {
+          wr_remap_respond(this_tag, this_resp);
+          wr_remap_done(this_tag);
+        }
+      } else {
+        b_out.Push(this_resp);        // Send the response to MASTER
+        wr_trans_fin.write(this_tid); // Inform Packetizer for finished transaction
+      }
     } // End of While(1)
   }; // End of Write Resp De-pack
   
   
+  // --- ID Remapping --- //
+  // Packetizer side. Tag allocation and release
+  inline bool rd_remap_avail() const {
+    bool avail = false;
+    #pragma hls_unroll yes
+    for (int i=0; i<TAGS; ++i) avail = avail || rd_tag_free[i];
+    return avail;
+  };
+  
+  inline sc_uint<dnp::ID_W> rd_remap_alloc(sc_uint<dnp::ID_W> tid, unsigned int beats) {
+    sc_uint<dnp::ID_W> tag = 0;
+    bool found = false;
+    #pragma hls_unroll yes
+    for (int i=0; i<TAGS; ++i) {
+      if (rd_tag_free[i] && !found) {
+        tag   = i;
+        found = true;
+      }
+    }
+    rd_tag_free[tag]  = false;
+    rd_tag_tid[tag]   = tid;
+    rd_tag_beats[tag] = beats;
+    rd_rob_free      -= beats;
+    return tag;
+  };
+  
+  inline void rd_remap_fin(sc_uint<dnp::ID_W> tag) {
+    rd_tag_free[tag] = true;
+    rd_out_table[rd_tag_tid[tag]].sent--;
+    rd_rob_free += rd_tag_beats[tag];
+  };
+  
+  inline bool wr_remap_avail() const {
+    bool avail = false;
+    #pragma hls_unroll yes
+    for (int i=0; i<TAGS; ++i) avail = avail || wr_tag_free[i];
+    return avail;
+  };
+  
+  inline sc_uint<dnp::ID_W> wr_remap_alloc(sc_uint<dnp::ID_W> tid) {
+    sc_uint<dnp::ID_W> tag = 0;
+    bool found = false;
+    #pragma hls_unroll yes
+    for (int i=0; i<TAGS; ++i) {
+      if (wr_tag_free[i] && !found) {
+        tag   = i;
+        found = true;
+      }
+    }
+    wr_tag_free[tag] = false;
+    wr_tag_tid[tag]  = tid;
+    return tag;
+  };
+  
+  inline void wr_remap_fin(sc_uint<dnp::ID_W> tag) {
+    wr_tag_free[tag] = true;
+    wr_out_table[wr_tag_tid[tag]].sent--;
+  };
+  
+  // Depacketizer side. Per ID lists of the in-flight tags
+  inline void remap_reset(remap_book_entry book[], remap_tag_entry tags[]) {
+    #pragma hls_unroll yes
+    for (int i=0; i<(1<<dnp::ID_W); ++i) {
+      book[i].head_tag = REMAP_NONE;
+      book[i].tail_tag = REMAP_NONE;
+    }
+    #pragma hls_unroll yes
+    for (int i=0; i<TAGS; ++i) {
+      tags[i].pending = false;
+      tags[i].stored  = false;
+      tags[i].more    = false;
+    }
+  };
+  
+  // A new tag is appended to its ID's list
+  inline void remap_push(remap_book_entry book[], remap_tag_entry tags[], const remap_info &info) {
+    unsigned char tag = info.tag.to_uint();
+    unsigned char tid = info.tid.to_uint();
+    tags[tag].tid       = info.tid;
+    tags[tag].nxt_tag   = REMAP_NONE;
+    tags[tag].head_slot = REMAP_NONE;
+    tags[tag].tail_slot = REMAP_NONE;
+    tags[tag].pending   = true;
+    tags[tag].stored    = false;
+    tags[tag].more      = info.more;
+    if (book[tid].head_tag==REMAP_NONE) book[tid].head_tag               = tag;
+    else                                tags[book[tid].tail_tag].nxt_tag = tag;
+    book[tid].tail_tag = tag;
+  };
+  
+  // A tag that got responded is removed from the head of its ID's list
+  inline void remap_pop(remap_book_entry book[], remap_tag_entry tags[], unsigned char tag) {
+    unsigned char tid = tags[tag].tid.to_uint();
+    book[tid].head_tag = tags[tag].nxt_tag;
+    if (book[tid].head_tag==REMAP_NONE) book[tid].tail_tag = REMAP_NONE;
+    tags[tag].pending = false;
+    tags[tag].stored  = false;
+  };
+  
+  // A stored response that is the oldest of its ID
+  inline bool remap_ready(const remap_book_entry book[], const remap_tag_entry tags[], unsigned char &tag) const {
+    bool found = false;
+    tag = 0;
+    #pragma hls_unroll yes
+    for (int i=0; i<TAGS; ++i) {
+      if (tags[i].stored && (book[tags[i].tid.to_uint()].head_tag==i) && !found) {
+        tag   = i;
+        found = true;
+      }
+    }
+    return found;
+  };
+  
+  inline void rd_remap_done(unsigned char tag) {
+    remap_pop(rd_remap_book, rd_remap_tags, tag);
+    rd_trans_fin.write(tag);
+  };
+  
+  inline void wr_remap_done(unsigned char tag) {
+    remap_pop(wr_remap_book, wr_remap_tags, tag);
+    wr_trans_fin.write(tag);
+  };
+  
+  // The response of a striped burst is sent by its last sub-burst, the worst of all sub-bursts
+  inline void wr_remap_respond(unsigned char tag, axi4_::WRespPayload &resp) {
+    unsigned char tid = resp.id.to_uint();
+    if (resp.resp.to_uint() < wr_split_resp[tid].to_uint()) resp.resp = wr_split_resp[tid].to_uint();
+    if (wr_remap_tags[tag].more) {
+      wr_split_resp[tid] = resp.resp.to_uint();
+    } else {
+      wr_split_resp[tid] = 0;
+      b_out.Push(resp);
+    }
+  };
+  
+  // Stores an early RD beat. The packetizer has reserved the space, thus a free slot always exists
+  inline void rd_remap_store(unsigned char tag, const axi4_::ReadPayload &beat) {
+    unsigned char slot  = 0;
+    bool          found = false;
+    #pragma hls_unroll yes
+    for (int i=0; i<ROB_SLOTS; ++i) {
+      if (!rd_rob[i].valid && !found) {
+        slot  = i;
+        found = true;
+      }
+    }
+    NVHLS_ASSERT_MSG(found, "RD reorder buffer FULL!");
+    rd_rob[slot].beat     = beat;
+    rd_rob[slot].nxt_slot = REMAP_NONE;
+    rd_rob[slot].valid    = true;
+    if (rd_remap_tags[tag].head_slot==REMAP_NONE) rd_remap_tags[tag].head_slot                    = slot;
+    else                                          rd_rob[rd_remap_tags[tag].tail_slot].nxt_slot = slot;
+    rd_remap_tags[tag].tail_slot = slot;
+  };
+  
+  // Sends to Master a beat of a stored response that became the oldest of its ID
+  inline bool rd_remap_drain() {
+    unsigned char tag;
+    if (!remap_ready(rd_remap_book, rd_remap_tags, tag)) return false;
+    unsigned char slot = rd_remap_tags[tag].head_slot;
+    axi4_::ReadPayload beat = rd_rob[slot].beat;
+    bool sub_last = beat.last;
+    beat.last = sub_last && !rd_remap_tags[tag].more;
+    r_out.Push(beat);
+    rd_rob[slot].valid = false;
+    rd_remap_tags[tag].head_slot = rd_rob[slot].nxt_slot;
+    if (sub_last) rd_remap_done(tag);
+    return true;
+  };
+  
+  // The tag travels at the reorder ticket fields and is echoed back by the Slave
+  inline unsigned char get_rresp_ticket(const rresp_flit_t &flit) const {
+    return (((flit.data[dnp::rresp::REORD_H_PHIT] >> dnp::rresp::REORD_H_PTR) & ((1<<dnp::REORD_H_W)-1)) << dnp::REORD_W) |
+            ((flit.data[0] >> dnp::rresp::REORD_PTR) & ((1<<dnp::REORD_W)-1));
+  };
+  
+  inline unsigned char get_wresp_ticket(const wresp_flit_t &flit) const {
+    unsigned char tct_h = (cfg::WRESP_PHITS>1) ? ((flit.data[dnp::wresp::REORD_H_PHIT] >> dnp::wresp::REORD_H_PTR) & ((1<<dnp::REORD_H_W)-1)) : 0;
+    return (tct_h << dnp::REORD_W) | ((flit.data[0] >> dnp::wresp::REORD_PTR) & ((1<<dnp::REORD_W)-1));
+  };
+  
   // Memory map resolving 
   inline unsigned char addr_lut_rd(const axi4_::Addr addr) {
-    for (int i=0; i<2; ++i) {
-      if (addr>=addr_map[i][0].read() && addr <= addr_map[i][1].read()) return i;
-    }
-    return 0;
+    bool hit;
+    unsigned char sel = addr_decoder<cfg::SLAVE_NUM>::decode(addr, addr_map, hit);
+    return stripe_sel(addr, sel, hit);
   };
   
   inline unsigned char addr_lut_wr(const axi4_::Addr addr) {
-    for (int i=0; i<2; ++i) {
-      if (addr>=addr_map[i][0].read() && addr <= addr_map[i][1].read()) return i;
+    bool hit;
+    unsigned char sel = addr_decoder<cfg::SLAVE_NUM>::decode(addr, addr_map, hit);
+    return stripe_sel(addr, sel, hit);
+  };
+  
+  // --- Channel Striping --- //
+  // The striped range starts at the base of Slave 0. An address of it goes to the channel of its stripe
+  inline unsigned char stripe_sel(const axi4_::Addr &addr, unsigned char sel, bool hit) {
+    if ((STRIPE_CH>0) && hit && (sel<STRIPE_CH)) return (stripe_off(addr) >> LOG_STRIPE) & (STRIPE_CH-1);
+    return sel;
+  };
+  
+  inline unsigned long long stripe_off(const axi4_::Addr &addr) {
+    return addr.to_uint64() - addr_decoder<cfg::SLAVE_NUM>::base(addr_map, 0);
+  };
+  
+  // The address sent for a striped one is its dense offset in the stripes of its channel, put at the channel's base.
+  //   Thus the Slave IF, which removes its base, gives the channel a contiguous range of 1/STRIPE_CH the striped one
+  inline axi4_::Addr stripe_addr(const axi4_::Addr &addr) {
+    bool          hit;
+    unsigned char sel = addr_decoder<cfg::SLAVE_NUM>::decode(addr, addr_map, hit);
+    if ((STRIPE_CH>0) && hit && (sel<STRIPE_CH)) {
+      unsigned long long off   = stripe_off(addr);
+      unsigned char      ch    = (off >> LOG_STRIPE) & (STRIPE_CH-1);
+      unsigned long long dense = ((off >> (LOG_STRIPE+LOG_STRIPE_CH)) << LOG_STRIPE) | (off & ((1ULL<<LOG_STRIPE)-1));
+      return addr_decoder<cfg::SLAVE_NUM>::base(addr_map, ch) + dense;
+    }
+    return addr;
+  };
+  
+  // Splits off req the sub-burst up to its next stripe boundary or MAX_BEATS, req keeps the rest.
+  //   Returns true when more sub-bursts follow. Only INCR bursts may cross a stripe, FIXED ones are only cut short
+  inline bool burst_split(axi4_::AddrPayload &req, axi4_::AddrPayload &sub) {
+    sub = req;
+    bool incr  = (req.burst.to_uint()==enc_::AXBURST::INCR);
+    bool fixed = (req.burst.to_uint()==enc_::AXBURST::FIXED);
+    
+    unsigned long long addr       = req.addr.to_uint64();
+    unsigned long long aligned    = addr & ~((1ULL<<req.size.to_uint())-1);
+    unsigned int       beats_left = req.len.to_uint()+1;
+    unsigned int       beats_in   = beats_left;
+    if ((STRIPE_CH>0) && incr) {
+      bool          hit;
+      unsigned char sel = addr_decoder<cfg::SLAVE_NUM>::decode(req.addr, addr_map, hit);
+      if (hit && (sel<STRIPE_CH)) {
+        unsigned long long boundary = addr + ((1ULL<<LOG_STRIPE) - (stripe_off(req.addr) & ((1ULL<<LOG_STRIPE)-1)));
+        beats_in = (boundary-aligned) >> req.size.to_uint();
+      }
     }
-    return 0;
+    if ((MAX_BEATS>0) && (incr || fixed) && (beats_in>MAX_BEATS)) beats_in = MAX_BEATS;
+    if (beats_left<=beats_in) return false;
+    
+    sub.len  = beats_in-1;
+    req.addr = fixed ? addr : (aligned + ((unsigned long long)beats_in << req.size.to_uint()));
+    req.len  = beats_left-beats_in-1;
+    return true;
   };
   
 }; // End of Master-IF module
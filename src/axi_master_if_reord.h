@@ -16,6 +16,7 @@
 
 #include "./include/axi4_configs_extra.h"
 #include "./include/duth_fun.h"
+#include "./include/addr_dec.h"
 
 #define LOG_MAX_OUTS 8
 
@@ -69,15 +70,14 @@ struct reorder_book_entry {
 };
 
 
-#define WR_REORD_SLOTS 3
-#define RD_REORD_SLOTS 3
-
 // --- Master IF --- //
 // AXI Master connects the independent AXI RD and WR cahnnels to the interface 
 // The interface gets the Requests and independently packetize and send them into the network
 // The Responses are getting depacketized into a seperate thread and are fed back to the MASTER
 // Thus Master interface comprises of 4 distinct/parallel blocks WR/RD pack and WR/RD depack
-template <typename cfg>
+// RD/WR_REORD_SLOTS : Reorder buffer flit slots, up to 63. Tickets extend past the header phit
+//                     when more than 7 slots are used (i.e. WRESP_PHITS>1 for more than 7 WR slots)
+template <typename cfg, unsigned char RD_REORD_SLOTS=3, unsigned char WR_REORD_SLOTS=3>
 SC_MODULE(axi_master_if) {
   typedef typename axi::axi4<axi::cfg::standard_duth> axi4_;
   typedef typename axi::AXI4_Encoding            enc_;
@@ -92,6 +92,8 @@ SC_MODULE(axi_master_if) {
   
   const unsigned char LOG_RD_M_LANES = nvhls::log2_ceil<cfg::RD_LANES>::val;
   const unsigned char LOG_WR_M_LANES = nvhls::log2_ceil<cfg::WR_LANES>::val;
+  // In-flight RD flits. Scales with the reorder buffer to be able to fill it
+  const unsigned char RD_MAX_OUTS_FLITS = (RD_REORD_SLOTS>10) ? RD_REORD_SLOTS : 10;
   
   sc_in_clk    clk;
   sc_in <bool> rst_n;
@@ -139,6 +141,12 @@ SC_MODULE(axi_master_if) {
   reorder_buff_entry<wresp_flit_t> wr_reord_buff[WR_REORD_SLOTS];  // The Reorder buffer storage, plus link list metadata
   reorder_book_entry               wr_reord_book[(1<<dnp::ID_W)];      // Bookeeping information of the linked list
   
+#ifndef __SYNTHESIS__
+  // Occupancy histograms of the Reorder Buffers, sampled each cycle. Reported at the end of simulation
+  unsigned long long rd_reord_hist[RD_REORD_SLOTS+1];
+  unsigned long long wr_reord_hist[WR_REORD_SLOTS+1];
+#endif
+  
   // Constructor
   SC_HAS_PROCESS(axi_master_if);
   axi_master_if(sc_module_name name_="axi_master_if")
@@ -149,6 +157,11 @@ SC_MODULE(axi_master_if) {
     wr_trans_init (3),
     wr_trans_fin  (3) 
   { 
+    NVHLS_ASSERT_MSG(!dnp::NARROW_PACK, "Narrow packing is supported by axi_master_if/axi_slave_if only.");
+    NVHLS_ASSERT_MSG(RD_REORD_SLOTS < (1<<(dnp::REORD_W+dnp::REORD_H_W)), "RD reorder slots exceed the ticket width.");
+    NVHLS_ASSERT_MSG(WR_REORD_SLOTS < (1<<(dnp::REORD_W+dnp::REORD_H_W)), "WR reorder slots exceed the ticket width.");
+    NVHLS_ASSERT_MSG((WR_REORD_SLOTS < (1<<dnp::REORD_W)) || (cfg::WRESP_PHITS>1), "WR ticket extension requires WRESP_PHITS>1.");
+    
     SC_THREAD(rd_req_pack_job);
     sensitive << clk.pos();
     async_reset_signal_is(rst_n, false);
@@ -164,6 +177,12 @@ SC_MODULE(axi_master_if) {
     SC_THREAD(wr_resp_depack_job);
     sensitive << clk.pos();
     async_reset_signal_is(rst_n, false);
+    
+#ifndef __SYNTHESIS__
+    SC_THREAD(reord_stats_job);
+    sensitive << clk.pos();
+    async_reset_signal_is(rst_n, false);
+#endif
   }
   
   //-------------------------------//
@@ -190,10 +209,12 @@ SC_MODULE(axi_master_if) {
     for (int i=0; i<(1<<dnp::ID_W); ++i) rd_out_table[i].dst_last=0;
     
     axi4_::AddrPayload this_req;
+    FLIT_TS_DO(flit_ts::stamp_t ts_acc = 0;)
     //-- End of Reset ---//
     while(1) {
       wait();
       if(ar_in.PopNB(this_req)) {
+        FLIT_TS_DO(ts_acc = flit_ts::now();)
         // A new request must stall until it is eligible to depart.
         // Reordering of responses of the same IDs are allowed and handled by the depacketizer in the reorder buffer
         // The response that might get reordered must be able to fit in the buffer
@@ -207,11 +228,11 @@ SC_MODULE(axi_master_if) {
         
         // Calculate the size of the transaction to check if its able to fit in the reorder buffer
         unsigned int bytes_total = ((this_req.len+1)<<this_req.size.to_uint());
-        unsigned int phits_total = (bytes_total>>1) + 4; // each phit stores 2 bytes PLUS 2 header phits.
+        unsigned int phits_total = (bytes_total>>dnp::BPP_W) + 4; // each phit stores BPP bytes PLUS 2 header phits.
         unsigned int flits_total = (phits_total & 0x3) ? (phits_total>>2)+1 : (phits_total>>2);
         
         // All needed slots must available beforehand, thus wait until space has been freed or its no longer possible to be reordered
-        while((through_reord && (rd_avail_reord_slots < flits_total)) || (total_rd_flits_sent>9)) {
+        while((through_reord && (rd_avail_reord_slots < flits_total)) || (total_rd_flits_sent>=RD_MAX_OUTS_FLITS)) {
           order_info rcv_fin;
           if(rd_trans_fin.nb_read(rcv_fin)) {
             if(rd_out_table[rcv_fin.tid].sent==1) rd_out_table[rcv_fin.tid].reorder = false;
@@ -311,10 +332,10 @@ SC_MODULE(axi_master_if) {
       // Packetize request into a flit. The fields are described in DNP20
       rreq_flit_t tmp_flit;
       tmp_flit.type = SINGLE; // all request fits in at single flits thus SINGLE
-      tmp_flit.data[0] = ((sc_uint<dnp::PHIT_W>)head_ticket            << dnp::req::REORD_PTR)|
+      tmp_flit.data[0] = ((sc_uint<dnp::PHIT_W>)(head_ticket & ((1<<dnp::REORD_W)-1)) << dnp::req::REORD_PTR)|
                          ((sc_uint<dnp::PHIT_W>)this_req.id            << dnp::req::ID_PTR)   |
                          ((sc_uint<dnp::PHIT_W>)dnp::PACK_TYPE__RD_REQ << dnp::T_PTR)         |
-                         ((sc_uint<dnp::PHIT_W>)0                      << dnp::Q_PTR)         |
+                         ((sc_uint<dnp::PHIT_W>)(this_req.qos>>1)      << dnp::Q_PTR)         |
                          ((sc_uint<dnp::PHIT_W>)this_dst               << dnp::D_PTR)         |
                          ((sc_uint<dnp::PHIT_W>)THIS_ID.read()         << dnp::S_PTR)         |
                          ((sc_uint<dnp::PHIT_W>)0                      << dnp::V_PTR)         ;
@@ -322,10 +343,12 @@ SC_MODULE(axi_master_if) {
       tmp_flit.data[1] = ((sc_uint<dnp::PHIT_W>)this_req.len             << dnp::req::LE_PTR) |
                          ((sc_uint<dnp::PHIT_W>) this_req.addr & 0xffff) << dnp::req::AL_PTR  ;
   
-      tmp_flit.data[2] = ((sc_uint<dnp::PHIT_W>)this_req.burst               << dnp::req::BU_PTR)  |
+      tmp_flit.data[2] = ((sc_uint<dnp::PHIT_W>)((head_ticket >> dnp::REORD_W) & ((1<<dnp::REORD_H_W)-1)) << dnp::req::REORD_H_PTR) |
+                         ((sc_uint<dnp::PHIT_W>)this_req.burst               << dnp::req::BU_PTR)  |
                          ((sc_uint<dnp::PHIT_W>)this_req.size                << dnp::req::SZ_PTR)  |
                          ((sc_uint<dnp::PHIT_W>)(this_req.addr >> dnp::AL_W) << dnp::req::AH_PTR ) ;
       
+      FLIT_TS_DO(tmp_flit.ts.inject(ts_acc);)
       // Try to push to Network, but continue reading for incoming finished transactions
       while(!rd_flit_out.PushNB(tmp_flit)) {
         order_info rcv_fin;
@@ -423,9 +446,10 @@ SC_MODULE(axi_master_if) {
         rresp_flit_t flit_rcv;
         if (rd_flit_in.PopNB(flit_rcv)) {
           unsigned char rcv_ticket;
-          if (flit_rcv.is_head() || flit_rcv.is_single())
-            rcv_ticket = ((flit_rcv.data[0] >> (dnp::rresp::REORD_PTR)) & ((1<<dnp::REORD_W)-1));
-          else
+          if (flit_rcv.is_head() || flit_rcv.is_single()) {
+            rcv_ticket = get_rresp_ticket(flit_rcv);
+            FLIT_TS_DO(flit_ts_stats::get().record(false, THIS_ID.read(), flit_rcv.get_src(), flit_rcv.ts);)
+          } else
             rcv_ticket = rcv_ticket_nxt;
           
           // Through reorder when the ticket belongs to its slots
@@ -537,22 +561,23 @@ SC_MODULE(axi_master_if) {
   
         // Calculate the bytes to transfer in this iteration
         sc_uint<8> bytes_axi_left  = ((1<<final_size) - (axi_lane_ptr & ((1<<final_size)-1)));
-        sc_uint<8> bytes_flit_left = ((cfg::RRESP_PHITS<<1) - (flit_phit_ptr<<1));
+        sc_uint<8> bytes_flit_left = ((cfg::RRESP_PHITS<<dnp::BPP_W) - (flit_phit_ptr<<dnp::BPP_W));
         sc_uint<8> bytes_per_iter  = (bytes_axi_left<bytes_flit_left) ? bytes_axi_left : bytes_flit_left;
         
         #pragma hls_unroll yes
-        build_resp: for (int i = 0; i < (cfg::RD_LANES >> 1); ++i) { // i counts AXI Byte Lanes IN PHITS (i.e. Lanes/bytes_in_phit)
-          if (i >= (axi_lane_ptr >> 1) && i < ((axi_lane_ptr + bytes_per_iter) >> 1)) {
-            cnt_phit_rresp_t loc_flit_ptr = flit_phit_ptr + (i - (axi_lane_ptr >> 1));
-            resp_build_tmp[(i << 1) + 1] =
-                    (cur_flit.data[loc_flit_ptr] >> dnp::rdata::B1_PTR) & ((1 << dnp::B_W) - 1); // MSB
-            resp_build_tmp[(i << 1)] = (cur_flit.data[loc_flit_ptr] >> dnp::rdata::B0_PTR) & ((1 << dnp::B_W) - 1); // LSB
+        build_resp: for (int i = 0; i < (cfg::RD_LANES>>dnp::BPP_W); ++i) { // i counts AXI Byte Lanes IN PHITS (i.e. Lanes/bytes_in_phit)
+          if (i >= (axi_lane_ptr>>dnp::BPP_W) && i < ((axi_lane_ptr+bytes_per_iter)>>dnp::BPP_W)) {
+            cnt_phit_rresp_t loc_flit_ptr = flit_phit_ptr + (i - (axi_lane_ptr>>dnp::BPP_W));
+            #pragma hls_unroll yes
+            for (int b=0; b<dnp::BPP; ++b) {
+              resp_build_tmp[(i<<dnp::BPP_W)+b] = (cur_flit.data[loc_flit_ptr] >> (dnp::rdata::B0_PTR+b*dnp::B_W)) & ((1<<dnp::B_W)-1);
+            }
           }
         }
         
         // transaction event flags
         bool done_job  = ((bytes_depacked+bytes_per_iter)==bytes_total);             // All bytes are processed
-        bool done_flit = (flit_phit_ptr+(bytes_per_iter>>1)==cfg::RRESP_PHITS);      // Flit got empty
+        bool done_flit = (flit_phit_ptr+(bytes_per_iter>>dnp::BPP_W)==cfg::RRESP_PHITS);      // Flit got empty
         bool done_axi  = (((bytes_depacked+bytes_per_iter)&((1<<final_size)-1))==0); // Beat got full
   
   
@@ -606,7 +631,7 @@ SC_MODULE(axi_master_if) {
         } else { 
           // Response continues, update pointers.
           bytes_depacked += bytes_per_iter;
-          flit_phit_ptr  = (done_flit) ? 0 : (flit_phit_ptr +(bytes_per_iter>>1));
+          flit_phit_ptr  = (done_flit) ? 0 : (flit_phit_ptr +(bytes_per_iter>>dnp::BPP_W));
           axi_lane_ptr   = (active_trans.burst==enc_::AXBURST::FIXED) ? ((axi_lane_ptr+bytes_per_iter) & ((1<<final_size)-1)) + addr_init_aligned :
                            ((axi_lane_ptr+bytes_per_iter) & (cfg::RD_LANES-1)) ;
         }
@@ -648,7 +673,9 @@ SC_MODULE(axi_master_if) {
       }
       
       axi4_::AddrPayload this_req;
+      FLIT_TS_DO(flit_ts::stamp_t ts_acc = 0;)
       if(aw_in.PopNB(this_req)) {
+        FLIT_TS_DO(ts_acc = flit_ts::now();)
         // A new request must stall until it is eligible to depart.
         // Reordering of responses of the same IDs are allowed and handled by the depacketizer in the reorder buffer
         // The response that might get reordered must be able to fit in the buffer
@@ -697,10 +724,10 @@ SC_MODULE(axi_master_if) {
       wreq_flit_t tmp_flit;
       wreq_flit_t tmp_mule_flit;
       tmp_mule_flit.type    = HEAD;
-      tmp_mule_flit.data[0] = ((sc_uint<dnp::PHIT_W>)this_ticket            << dnp::req::REORD_PTR) |
+      tmp_mule_flit.data[0] = ((sc_uint<dnp::PHIT_W>)(this_ticket & ((1<<dnp::REORD_W)-1)) << dnp::req::REORD_PTR) |
                               ((sc_uint<dnp::PHIT_W>)this_req.id            << dnp::req::ID_PTR)    |
                               ((sc_uint<dnp::PHIT_W>)dnp::PACK_TYPE__WR_REQ << dnp::T_PTR)          |
-                              ((sc_uint<dnp::PHIT_W>)0                      << dnp::Q_PTR)          |
+                              ((sc_uint<dnp::PHIT_W>)(this_req.qos>>1)      << dnp::Q_PTR)          |
                               ((sc_uint<dnp::PHIT_W>)this_dst               << dnp::D_PTR)          |
                               ((sc_uint<dnp::PHIT_W>)THIS_ID.read()         << dnp::S_PTR)          |
                               ((sc_uint<dnp::PHIT_W>)0                      << dnp::V_PTR)          ;
@@ -708,7 +735,8 @@ SC_MODULE(axi_master_if) {
       tmp_mule_flit.data[1] = ((sc_uint<dnp::PHIT_W>)this_req.len   << dnp::req::LE_PTR) |
                               ((sc_uint<dnp::PHIT_W>)this_req.addr & 0xffff);
       
-      tmp_mule_flit.data[2] = ((sc_uint<dnp::PHIT_W>)this_req.burst << dnp::req::BU_PTR)      |
+      tmp_mule_flit.data[2] = ((sc_uint<dnp::PHIT_W>)((this_ticket >> dnp::REORD_W) & ((1<<dnp::REORD_H_W)-1)) << dnp::req::REORD_H_PTR) |
+                              ((sc_uint<dnp::PHIT_W>)this_req.burst << dnp::req::BU_PTR)      |
                               ((sc_uint<dnp::PHIT_W>)this_req.size  << dnp::req::SZ_PTR)      |
                               ((sc_uint<dnp::PHIT_W>)(this_req.addr >> dnp::AL_W) << dnp::req::AH_PTR)  ;
       
@@ -722,22 +750,29 @@ SC_MODULE(axi_master_if) {
   
       wr_trans_init.write(trans_expect);
       
+      // A short write carries its single beat past the header, thus the header flit is sent with the data
+      bool short_wr = dnp::SHORT_WR && (cfg::WREQ_PHITS>dnp::req::WDATA_PHIT) && (this_req.len==0) &&
+                      ((1<<this_req.size.to_uint()) <= ((cfg::WREQ_PHITS-dnp::req::WDATA_PHIT)<<dnp::BPP_W));
+
+      FLIT_TS_DO(tmp_mule_flit.ts.inject(ts_acc);)
       // If network is not ready, continue to poll for finished transactions
-      #pragma hls_pipeline_init_interval 1
-      #pragma pipeline_stall_mode flush
-      while(!wr_flit_out.PushNB(tmp_mule_flit)) {
-        order_info rcv_fin;
-        if(wr_trans_fin.nb_read(rcv_fin)) {
-          if(wr_out_table[rcv_fin.tid].sent==1) wr_out_table[rcv_fin.tid].reorder = false;
-          wr_out_table[rcv_fin.tid].sent = wr_out_table[rcv_fin.tid].sent - 1;
-    
-          if (rcv_fin.ticket<WR_REORD_SLOTS) {
-            wr_reord_avail[rcv_fin.ticket] = true;
-            wr_avail_reord_slots++;
+      if (!short_wr) {
+        #pragma hls_pipeline_init_interval 1
+        #pragma pipeline_stall_mode flush
+        while(!wr_flit_out.PushNB(tmp_mule_flit)) {
+          order_info rcv_fin;
+          if(wr_trans_fin.nb_read(rcv_fin)) {
+            if(wr_out_table[rcv_fin.tid].sent==1) wr_out_table[rcv_fin.tid].reorder = false;
+            wr_out_table[rcv_fin.tid].sent = wr_out_table[rcv_fin.tid].sent - 1;
+
+            if (rcv_fin.ticket<WR_REORD_SLOTS) {
+              wr_reord_avail[rcv_fin.ticket] = true;
+              wr_avail_reord_slots++;
+            }
           }
-        }
-        wait(); 
-      };
+          wait();
+        };
+      }
   
   
       // --- Start DATA Packetization --- //
@@ -757,7 +792,7 @@ SC_MODULE(axi_master_if) {
       //   - One to keep track axi byte lanes to place to data  (axi_lane_ptr)
       //   - One to point at the data of the flit               (flit_phit_ptr)
       sc_uint<8>       axi_lane_ptr  = addr_init_aligned; // Bytes MOD size
-      cnt_phit_wreq_t  flit_phit_ptr = 0;                 // Bytes MOD phits in flit
+      cnt_phit_wreq_t  flit_phit_ptr = short_wr ? dnp::req::WDATA_PHIT : 0; // Bytes MOD phits in flit
   
       sc_uint<16>  bytes_total  = ((this_req.len.to_uint()+1)<<this_req.size.to_uint());
       sc_uint<16>  bytes_packed = 0;
@@ -771,7 +806,7 @@ SC_MODULE(axi_master_if) {
         wait();
         // Calculate the bytes transferred in this iteration, depending the available flit bytes and the remaining to the beat
         sc_uint<8> bytes_axi_left  = ((1<<this_req.size.to_uint()) - (axi_lane_ptr & ((1<<this_req.size.to_uint())-1)));
-        sc_uint<8> bytes_flit_left = ((cfg::WREQ_PHITS<<1)         - (flit_phit_ptr<<1));
+        sc_uint<8> bytes_flit_left = ((cfg::WREQ_PHITS<<dnp::BPP_W)         - (flit_phit_ptr<<dnp::BPP_W));
         sc_uint<8> bytes_per_iter  = (bytes_axi_left<bytes_flit_left) ? bytes_axi_left : bytes_flit_left;
   
   
@@ -787,24 +822,26 @@ SC_MODULE(axi_master_if) {
         // Convert AXI Beats to flits.
         #pragma hls_unroll yes
         for (int i=0; i<cfg::WREQ_PHITS; ++i){ // i counts phits on the flit
-          if(i>=flit_phit_ptr && i<(flit_phit_ptr+(bytes_per_iter>>1))) {
-            sc_uint<8> loc_axi_ptr = (axi_lane_ptr + ((i-flit_phit_ptr)<<1));
-            tmp_mule_flit.data[i] = ((sc_uint<dnp::PHIT_W>)last_tmp                      << dnp::wdata::LA_PTR ) | // MSB
-                                    ((sc_uint<dnp::PHIT_W>)wstrb_tmp[loc_axi_ptr+1]      << dnp::wdata::E1_PTR ) |
-                                    ((sc_uint<dnp::PHIT_W>)wstrb_tmp[loc_axi_ptr  ]      << dnp::wdata::E0_PTR ) |
-                                    ((sc_uint<dnp::PHIT_W>)data_build_tmp[loc_axi_ptr+1] << dnp::wdata::B1_PTR ) | // (i*2) % 4
-                                    ((sc_uint<dnp::PHIT_W>)data_build_tmp[loc_axi_ptr  ] << dnp::wdata::B0_PTR ) ;
+          if(i>=flit_phit_ptr && i<(flit_phit_ptr+(bytes_per_iter>>dnp::BPP_W))) {
+            sc_uint<8> loc_axi_ptr = (axi_lane_ptr + ((i-flit_phit_ptr)<<dnp::BPP_W));
+            sc_uint<dnp::PHIT_W> phit = (sc_uint<dnp::PHIT_W>)last_tmp << dnp::wdata::LA_PTR; // MSB
+            #pragma hls_unroll yes
+            for (int b=0; b<dnp::BPP; ++b) {
+              phit |= ((sc_uint<dnp::PHIT_W>)wstrb_tmp[loc_axi_ptr+b]      << (dnp::wdata::E0_PTR+b*dnp::E_W)) |
+                      ((sc_uint<dnp::PHIT_W>)data_build_tmp[loc_axi_ptr+b] << (dnp::wdata::B0_PTR+b*dnp::B_W)) ;
+            }
+            tmp_mule_flit.data[i] = phit;
           }
         }
         
         // transaction event flags
         bool done_job  = ((bytes_packed+bytes_per_iter)==bytes_total);                            // All bytes are processed
-        bool done_flit = (flit_phit_ptr+(bytes_per_iter>>1)==cfg::WREQ_PHITS);                    // Flit got empty
+        bool done_flit = (flit_phit_ptr+(bytes_per_iter>>dnp::BPP_W)==cfg::WREQ_PHITS);                    // Flit got empty
         bool done_axi  = (((bytes_packed+bytes_per_iter)&((1<<(this_req.size.to_uint()))-1))==0); // Beat got full
     
         // If network is not ready, continue to poll for finished transactions
         if(done_job || done_flit) {
-          tmp_mule_flit.type = (bytes_packed+bytes_per_iter==bytes_total) ? TAIL : BODY;
+          tmp_mule_flit.type = (short_wr) ? SINGLE : (bytes_packed+bytes_per_iter==bytes_total) ? TAIL : BODY;
           while (!wr_flit_out.PushNB(tmp_mule_flit)) {
             order_info rcv_fin;
             if(wr_trans_fin.nb_read(rcv_fin)) {
@@ -825,7 +862,7 @@ SC_MODULE(axi_master_if) {
           break;
         } else { // Move to next iteration
           bytes_packed  = bytes_packed+bytes_per_iter;
-          flit_phit_ptr = (done_flit) ? 0 : (flit_phit_ptr +(bytes_per_iter>>1));
+          flit_phit_ptr = (done_flit) ? 0 : (flit_phit_ptr +(bytes_per_iter>>dnp::BPP_W));
           axi_lane_ptr  = ((unsigned)this_req.burst==enc_::AXBURST::FIXED) ? ((axi_lane_ptr+bytes_per_iter) & ((1<<this_req.size.to_uint())-1)) + addr_init_aligned :
                           ((axi_lane_ptr+bytes_per_iter) & (cfg::WR_LANES-1)) ;
         }
@@ -881,7 +918,8 @@ SC_MODULE(axi_master_if) {
       bool bypass = false;
       wresp_flit_t flit_rcv;
       if(wr_flit_in.PopNB(flit_rcv)) {
-        unsigned char rcv_ticket = ((flit_rcv.data[0] >> (dnp::wresp::REORD_PTR)) & ((1<<dnp::REORD_W)-1));
+        FLIT_TS_DO(flit_ts_stats::get().record(true, THIS_ID.read(), flit_rcv.get_src(), flit_rcv.ts);)
+        unsigned char rcv_ticket = get_wresp_ticket(flit_rcv);
         if(rcv_ticket<WR_REORD_SLOTS && WR_REORD_SLOTS) {
           wr_reord_buff[rcv_ticket].flit  = flit_rcv;
           wr_reord_buff[rcv_ticket].valid = true;
@@ -899,7 +937,7 @@ SC_MODULE(axi_master_if) {
        
         order_info fin_trans;
         fin_trans.tid    = this_tid;
-        fin_trans.ticket = (flit_rcv.data[0] >> dnp::wresp::REORD_PTR) & ((1<<dnp::REORD_W)-1);
+        fin_trans.ticket = get_wresp_ticket(flit_rcv);
         fin_trans.dst    = (flit_rcv.data[0] >> dnp::S_PTR) & ((1<<dnp::S_W)-1);
   
         wr_reord_book[this_tid].hol_expect--;
@@ -944,7 +982,7 @@ SC_MODULE(axi_master_if) {
   
           order_info fin_trans;
           fin_trans.tid    = (flit_reord.data[0] >> dnp::wresp::ID_PTR)    & ((1<<dnp::ID_W)-1);
-          fin_trans.ticket = (flit_reord.data[0] >> dnp::wresp::REORD_PTR) & ((1<<dnp::REORD_W)-1);
+          fin_trans.ticket = get_wresp_ticket(flit_reord);
           
           b_out.Push(this_resp);
           wr_trans_fin.write(fin_trans);
@@ -953,22 +991,68 @@ SC_MODULE(axi_master_if) {
     } // End of While(1)
   }; // End of Write Resp Packetizer  
   
+#ifndef __SYNTHESIS__
+  //---------------------------------//
+  //--- Reorder Buffer Occupancy  ---//
+  //---------------------------------//
+  void reord_stats_job () {
+    for (int i=0; i<=RD_REORD_SLOTS; ++i) rd_reord_hist[i] = 0;
+    for (int i=0; i<=WR_REORD_SLOTS; ++i) wr_reord_hist[i] = 0;
+    wait();
+    while(1) {
+      wait();
+      unsigned char rd_used = 0;
+      unsigned char wr_used = 0;
+      for (int i=0; i<RD_REORD_SLOTS; ++i) rd_used += !rd_reord_avail[i];
+      for (int i=0; i<WR_REORD_SLOTS; ++i) wr_used += !wr_reord_avail[i];
+      rd_reord_hist[rd_used]++;
+      wr_reord_hist[wr_used]++;
+    }
+  };
+  
+  void end_of_simulation () {
+    unsigned long long rd_cycles = 0;
+    unsigned long long wr_cycles = 0;
+    for (int i=0; i<=RD_REORD_SLOTS; ++i) rd_cycles += rd_reord_hist[i];
+    for (int i=0; i<=WR_REORD_SLOTS; ++i) wr_cycles += wr_reord_hist[i];
+    
+    std::cout << "[" << name() << "] RD Reorder occupancy (slots : % of cycles) :";
+    for (int i=0; i<=RD_REORD_SLOTS; ++i) {
+      if (rd_reord_hist[i]) std::cout << " " << i << ":" << (100.0*rd_reord_hist[i])/rd_cycles;
+    }
+    std::cout << "\n";
+    std::cout << "[" << name() << "] WR Reorder occupancy (slots : % of cycles) :";
+    for (int i=0; i<=WR_REORD_SLOTS; ++i) {
+      if (wr_reord_hist[i]) std::cout << " " << i << ":" << (100.0*wr_reord_hist[i])/wr_cycles;
+    }
+    std::cout << "\n";
+  };
+#endif
+  
+  // Reorder tickets are split between the header phit and the extension field
+  inline unsigned char get_rresp_ticket(const rresp_flit_t &flit) const {
+    return (((flit.data[dnp::rresp::REORD_H_PHIT] >> dnp::rresp::REORD_H_PTR) & ((1<<dnp::REORD_H_W)-1)) << dnp::REORD_W) |
+            ((flit.data[0] >> dnp::rresp::REORD_PTR) & ((1<<dnp::REORD_W)-1));
+  };
+  
+  inline unsigned char get_wresp_ticket(const wresp_flit_t &flit) const {
+    unsigned char tct_h = (cfg::WRESP_PHITS>1) ? ((flit.data[dnp::wresp::REORD_H_PHIT] >> dnp::wresp::REORD_H_PTR) & ((1<<dnp::REORD_H_W)-1)) : 0;
+    return (tct_h << dnp::REORD_W) | ((flit.data[0] >> dnp::wresp::REORD_PTR) & ((1<<dnp::REORD_W)-1));
+  };
   
   // Memory map resolving
   inline unsigned char addr_lut_rd(const axi4_::Addr addr) {
-    for (int i=0; i<cfg::SLAVE_NUM; ++i) {
-      if (addr>=addr_map[i][0].read() && addr <= addr_map[i][1].read()) return i;
-    }
-    NVHLS_ASSERT_MSG(0, "RD address not resolved!");
-    return 0;
+    bool hit;
+    unsigned char sel = addr_decoder<cfg::SLAVE_NUM>::decode(addr, addr_map, hit);
+    NVHLS_ASSERT_MSG(hit || addr_decoder<cfg::SLAVE_NUM>::HAS_DEF, "RD address not resolved!");
+    return sel;
   };
   
   inline unsigned char addr_lut_wr(const axi4_::Addr addr) {
-    for (int i=0; i<cfg::SLAVE_NUM; ++i) {
-      if (addr>=addr_map[i][0].read() && addr <= addr_map[i][1].read()) return i;
-    }
-    NVHLS_ASSERT_MSG(0, "WR address not resolved!");
-    return 0;
+    bool hit;
+    unsigned char sel = addr_decoder<cfg::SLAVE_NUM>::decode(addr, addr_map, hit);
+    NVHLS_ASSERT_MSG(hit || addr_decoder<cfg::SLAVE_NUM>::HAS_DEF, "WR address not resolved!");
+    return sel;
   };
   
   
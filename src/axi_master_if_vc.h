@@ -16,12 +16,16 @@
 
 #include "./include/axi4_configs_extra.h"
 #include "./include/duth_fun.h"
+#include "./include/addr_dec.h"
+#include "./include/vc_credits.h"
+#include "./include/vc_tc_map.h"
 
 #define LOG_MAX_OUTS 8
 
 // --- Helping Data structures --- //
 struct outs_table_entry {
   sc_uint<dnp::D_W>     dst_last;
+  sc_uint<dnp::V_W>     vc_last;
   sc_uint<LOG_MAX_OUTS> sent;
   bool                  reorder;
 };
@@ -62,7 +66,11 @@ SC_MODULE(axi_master_if_vc) {
   typedef typename axi::axi4<axi::cfg::standard_duth> axi4_;
   typedef typename axi::AXI4_Encoding                 enc_;
   
-  typedef sc_uint< nvhls::log2_ceil<cfg::VCS>::val > cr_t;
+  typedef vc_credits<cfg::VCS, cfg::BUFF_DEPTH, cfg::CR_COALESCE, cfg::DAMQ_SLOTS, cfg::DAMQ_RSV> crs; // Credits count the router's buffer slots
+  typedef typename crs::cr_t  cr_t;
+  typedef typename crs::cnt_t cr_cnt_t;
+  
+  typedef vc_tc_map<cfg::TCS, cfg::TC_MAP, dnp::ID_W> tcm; // Traffic class of each request
   
   typedef flit_dnp<cfg::RREQ_PHITS>  rreq_flit_t;
   typedef flit_dnp<cfg::RRESP_PHITS> rresp_flit_t;
@@ -124,6 +132,9 @@ SC_MODULE(axi_master_if_vc) {
     rd_trans_fin  (2),
     wr_trans_fin  (2)
   {
+    NVHLS_ASSERT_MSG(!dnp::NARROW_PACK, "Narrow packing is supported by axi_master_if/axi_slave_if only.");
+    NVHLS_ASSERT_MSG((cfg::TCS>0) && (2*cfg::TCS<=cfg::VCS), "Each traffic class needs a Request and a Response VC!");
+    
     SC_THREAD(rd_req_pack_job);
     sensitive << clk.pos();
     async_reset_signal_is(rst_n, false);
@@ -151,61 +162,66 @@ SC_MODULE(axi_master_if_vc) {
     #pragma hls_unroll yes
     for (int i=0; i<1<<dnp::ID_W; ++i) {
       rd_out_table[i].dst_last = 0;
+      rd_out_table[i].vc_last  = 0;
       rd_out_table[i].sent     = 0;
       rd_out_table[i].reorder  = false;
     }
-    sc_uint<3> credits_avail[cfg::VCS];
+    cr_cnt_t   credits_avail[cfg::VCS];
     #pragma hls_unroll yes
     for (int i=0; i<cfg::VCS; ++i) {
-      credits_avail[i] = 3;
+      credits_avail[i] = cfg::BUFF_DEPTH;
     }
   
     sc_uint<LOG_MAX_OUTS> outstanding = 0;
     sc_uint<dnp::D_W>     out_dst = 0;
+    sc_uint<dnp::V_W>     out_vc  = 0;
     
     ar_in.Reset();
     rd_flit_data_out.Reset();
     rd_flit_cr_in.Reset();
     
     axi4_::AddrPayload this_req;
+    FLIT_TS_DO(flit_ts::stamp_t ts_acc = 0;)
     //-- End of Reset ---//
     //#pragma hls_pipeline_init_interval 1
     //#pragma pipeline_stall_mode flush
     while(1) {
       wait();
       if(ar_in.PopNB(this_req)) {
+        FLIT_TS_DO(ts_acc = flit_ts::now();)
         // A new request must stall until it is eligible to depart.
         // Depending the reordering scheme
-        // 0 : all in-flight transactions must be to the same destination
-        // 1 : all in-flight transactions of the SAME ID, must be to the same destination
+        // 0 : all in-flight transactions must be to the same destination and VC
+        // 1 : all in-flight transactions of the SAME ID, must be to the same destination and VC
         sc_uint<dnp::D_W> this_dst = addr_lut_rd(this_req.addr);
-        sc_uint<cfg::VCS> this_vc = 0; //this_req.id.to_uint()==0 ? 0 : 1;
+        sc_uint<dnp::V_W> this_vc  = tcm::req_vc(this_req.id.to_uint(), this_req.qos.to_uint(), false, this_dst.to_uint());
   
         if (cfg::ORD_SCHEME==0) {
           // Poll for Finished transactions until reordering is not possible.
           #pragma hls_pipeline_init_interval 1
           #pragma pipeline_stall_mode flush
-          while((outstanding>0) && (out_dst != this_dst)) {
+          while((outstanding>0) && ((out_dst != this_dst) || (out_vc != this_vc))) {
             sc_uint<dnp::ID_W> tid_fin;
             if(rd_trans_fin.nb_read(tid_fin)) outstanding--;
   
             cr_t vc_upd;
-            if(rd_flit_cr_in.PopNB(vc_upd)) credits_avail[vc_upd]++;
+            if(rd_flit_cr_in.PopNB(vc_upd)) cr_return(credits_avail, vc_upd);
             wait();
           }; // End of while reorder
           outstanding++;
           out_dst = this_dst;
+          out_vc  = this_vc;
         } else {
           // Get info about the outstanding transactions the received request's TID
           outs_table_entry      sel_entry   = rd_out_table[this_req.id.to_uint()];
   
-          bool                  may_reorder = (sel_entry.sent>0) && (sel_entry.dst_last != this_dst);
+          bool                  may_reorder = (sel_entry.sent>0) && ((sel_entry.dst_last != this_dst) || (sel_entry.vc_last != this_vc));
           sc_uint<LOG_MAX_OUTS> wait_for    =  sel_entry.sent;
           
           // Poll for Finished transactions until no longer reordering is possible.
           //#pragma hls_pipeline_init_interval 1
           //#pragma pipeline_stall_mode flush
-          while(may_reorder || (credits_avail[this_vc]==0)) {
+          while(may_reorder || !crs::ready(credits_avail, this_vc)) {
             sc_uint<dnp::ID_W> tid_fin;
             if(rd_trans_fin.nb_read(tid_fin)) {
               rd_out_table[tid_fin].sent--;                   // update outstanding table
@@ -214,11 +230,12 @@ SC_MODULE(axi_master_if_vc) {
             may_reorder = (wait_for>0);
     
             cr_t vc_upd;
-            if(rd_flit_cr_in.PopNB(vc_upd)) credits_avail[vc_upd]++;
+            if(rd_flit_cr_in.PopNB(vc_upd)) cr_return(credits_avail, vc_upd);
             wait();
           }; // End of while
           rd_out_table[this_req.id.to_uint()].sent++;
           rd_out_table[this_req.id.to_uint()].dst_last  = this_dst;
+          rd_out_table[this_req.id.to_uint()].vc_last   = this_vc;
         }
         
         // --- Start Packetization --- //
@@ -229,7 +246,7 @@ SC_MODULE(axi_master_if_vc) {
         tmp_flit.data[0] = ((sc_uint<dnp::PHIT_W>)0                     << dnp::req::REORD_PTR) |
                            ((sc_uint<dnp::PHIT_W>)this_req.id               << dnp::req::ID_PTR ) |
                            ((sc_uint<dnp::PHIT_W>)dnp::PACK_TYPE__RD_REQ << dnp::T_PTR      ) |
-                           ((sc_uint<dnp::PHIT_W>) 0                     << dnp::Q_PTR      ) |
+                           ((sc_uint<dnp::PHIT_W>)(this_req.qos>>1)      << dnp::Q_PTR      ) |
                            ((sc_uint<dnp::PHIT_W>)this_dst                   << dnp::D_PTR      ) |
                            ((sc_uint<dnp::PHIT_W>)THIS_ID                    << dnp::S_PTR      ) ;
         
@@ -241,7 +258,7 @@ SC_MODULE(axi_master_if_vc) {
                            ((sc_uint<dnp::PHIT_W>)(this_req.addr >> dnp::AL_W) << dnp::req::AH_PTR ) ;
         
         // send header flit to NoC
-        while (credits_avail[this_vc]==0) {
+        while (!crs::ready(credits_avail, this_vc)) {
           sc_uint<dnp::ID_W> tid_fin;
           if(rd_trans_fin.nb_read(tid_fin)) {
             if (cfg::ORD_SCHEME==0) outstanding--;
@@ -249,9 +266,10 @@ SC_MODULE(axi_master_if_vc) {
           }
           
           cr_t vc_upd;
-          if (rd_flit_cr_in.PopNB(vc_upd)) credits_avail[vc_upd]++;
+          if (rd_flit_cr_in.PopNB(vc_upd)) cr_return(credits_avail, vc_upd);
           wait();
         }
+        FLIT_TS_DO(tmp_flit.ts.inject(ts_acc);)
         bool dbg_rreq_ok = rd_flit_data_out.PushNB(tmp_flit); // We've already checked that !Full thus this should not block.
         NVHLS_ASSERT_MSG(dbg_rreq_ok, "R Req pack DROP!!!");
         credits_avail[this_vc]--;
@@ -264,7 +282,7 @@ SC_MODULE(axi_master_if_vc) {
         }
   
         cr_t vc_upd;
-        if (rd_flit_cr_in.PopNB(vc_upd)) credits_avail[vc_upd]++;
+        if (rd_flit_cr_in.PopNB(vc_upd)) cr_return(credits_avail, vc_upd);
         //wait();
       }
     } // End of while(1)
@@ -282,9 +300,10 @@ SC_MODULE(axi_master_if_vc) {
       //   inform the packetizer for the transaction completion
       rresp_flit_t flit_rcv;
       flit_rcv = rd_flit_data_in.Pop();
+      FLIT_TS_DO(flit_ts_stats::get().record(false, THIS_ID.read(), flit_rcv.get_src(), flit_rcv.ts);)
       
-      cr_t flit_rcv_vc = flit_rcv.get_vc();
-      bool dbg_rresp_cr_ok = rd_flit_cr_out.PushNB(flit_rcv_vc);
+      cr_t flit_rcv_cr = crs::single(flit_rcv.get_vc());
+      bool dbg_rresp_cr_ok = rd_flit_cr_out.PushNB(flit_rcv_cr);
       NVHLS_ASSERT_MSG(dbg_rresp_cr_ok, "R Resp credit DROP!!!");
       
       // Construct the transaction's attributes to build the response accordingly.
@@ -326,30 +345,32 @@ SC_MODULE(axi_master_if_vc) {
         // Each iteration moves data from the flit the the appropriate place on the AXI RD response
         // The two flit and axi pointers orchistrate the operation, until completion
       sc_uint<8> bytes_axi_left  = ((1<<final_size) - (axi_lane_ptr & ((1<<final_size)-1)));
-      sc_uint<8> bytes_flit_left = ((cfg::RRESP_PHITS<<1) - (flit_phit_ptr<<1));
+      sc_uint<8> bytes_flit_left = ((cfg::RRESP_PHITS<<dnp::BPP_W) - (flit_phit_ptr<<dnp::BPP_W));
       sc_uint<8> bytes_per_iter  = (bytes_axi_left<bytes_flit_left) ? bytes_axi_left : bytes_flit_left;
       
       // When the flit pointer resets get the next flit
       if(flit_phit_ptr==0) {
         flit_rcv = rd_flit_data_in.Pop();
         
-        cr_t flit_rcv_vc = flit_rcv.get_vc();
-        bool dbg_rresp_cr_ok = rd_flit_cr_out.PushNB(flit_rcv_vc);
+        cr_t flit_rcv_cr = crs::single(flit_rcv.get_vc());
+        bool dbg_rresp_cr_ok = rd_flit_cr_out.PushNB(flit_rcv_cr);
         NVHLS_ASSERT_MSG(dbg_rresp_cr_ok, "R Resp credit DROP!!!");
       }
       // Convert flits to axi transfers.
       #pragma hls_unroll yes
-      build_resp: for (int i = 0; i < (cfg::RD_LANES >> 1); ++i) { // i counts AXI Byte Lanes IN PHITS (i.e. Lanes/bytes_in_phit)
-        if (i>=(axi_lane_ptr>>1) && i<((axi_lane_ptr+bytes_per_iter)>>1)) {
-          //unsigned char loc_flit_ptr = flit_phit_ptr+(i&((bytes_per_iter>>1)-1));
-          cnt_phit_rresp_t loc_flit_ptr = flit_phit_ptr + (i-(axi_lane_ptr>>1));
-          resp_build_tmp[(i << 1) + 1] = (flit_rcv.data[loc_flit_ptr] >> dnp::rdata::B1_PTR) & ((1 << dnp::B_W) - 1); // MSB
-          resp_build_tmp[(i << 1)    ] = (flit_rcv.data[loc_flit_ptr] >> dnp::rdata::B0_PTR) & ((1 << dnp::B_W) - 1); // LSB
+      build_resp: for (int i = 0; i < (cfg::RD_LANES>>dnp::BPP_W); ++i) { // i counts AXI Byte Lanes IN PHITS (i.e. Lanes/bytes_in_phit)
+        if (i>=(axi_lane_ptr>>dnp::BPP_W) && i<((axi_lane_ptr+bytes_per_iter)>>dnp::BPP_W)) {
+          //unsigned char loc_flit_ptr = flit_phit_ptr+(i&((bytes_per_iter>>dnp::BPP_W)-1));
+          cnt_phit_rresp_t loc_flit_ptr = flit_phit_ptr + (i-(axi_lane_ptr>>dnp::BPP_W));
+          #pragma hls_unroll yes
+          for (int b=0; b<dnp::BPP; ++b) {
+            resp_build_tmp[(i<<dnp::BPP_W)+b] = (flit_rcv.data[loc_flit_ptr] >> (dnp::rdata::B0_PTR+b*dnp::B_W)) & ((1<<dnp::B_W)-1);
+          }
         }
       }
       
       bool done_job  = ((bytes_depacked+bytes_per_iter)==bytes_total);             // All bytes are processed
-      bool done_flit = (flit_phit_ptr+(bytes_per_iter>>1)==cfg::RRESP_PHITS);      // Flit got empty
+      bool done_flit = (flit_phit_ptr+(bytes_per_iter>>dnp::BPP_W)==cfg::RRESP_PHITS);      // Flit got empty
       bool done_axi  = (((bytes_depacked+bytes_per_iter)&((1<<final_size)-1))==0); // Beat got full
       
       // Push the response to MASTER, when either this Beat got the needed bytes or all bytes are transferred
@@ -370,7 +391,7 @@ SC_MODULE(axi_master_if_vc) {
         break;
       } else {
         bytes_depacked +=bytes_per_iter;
-        flit_phit_ptr = (done_flit) ? 0 : (flit_phit_ptr +(bytes_per_iter>>1));
+        flit_phit_ptr = (done_flit) ? 0 : (flit_phit_ptr +(bytes_per_iter>>dnp::BPP_W));
         axi_lane_ptr  = (active_trans.burst==enc_::AXBURST::FIXED) ? ((axi_lane_ptr+bytes_per_iter) & ((1<<final_size)-1)) + addr_init_aligned :
                                                                      ((axi_lane_ptr+bytes_per_iter) & (cfg::RD_LANES-1)) ;
       }
@@ -387,52 +408,57 @@ SC_MODULE(axi_master_if_vc) {
     aw_in.Reset();
     w_in.Reset();
     
-    sc_uint<3> wr_credits_avail[cfg::VCS];
+    cr_cnt_t   wr_credits_avail[cfg::VCS];
     for (int i=0; i<cfg::VCS; ++i) {
-      wr_credits_avail[i] = 3;
+      wr_credits_avail[i] = cfg::BUFF_DEPTH;
     }
 
     for (int i=0; i<1<<dnp::ID_W; ++i) {
       wr_out_table[i].dst_last = 0;
+      wr_out_table[i].vc_last  = 0;
       wr_out_table[i].sent     = 0;
       wr_out_table[i].reorder  = false;
     }
   
     sc_uint<LOG_MAX_OUTS> outstanding = 0;
     sc_uint<dnp::D_W>     out_dst = 0;
+    sc_uint<dnp::V_W>     out_vc  = 0;
     
     axi4_::AddrPayload this_req;
+    FLIT_TS_DO(flit_ts::stamp_t ts_acc = 0;)
     wait();
     while(1) {
       if(aw_in.PopNB(this_req)) { // New Request
+        FLIT_TS_DO(ts_acc = flit_ts::now();)
         // A new request must stall until it is eligible to depart.
         // Depending the reordering scheme
-        // 0 : all in-flight transactions must be to the same destination
-        // 1 : all in-flight transactions of the SAME ID, must be to the same destination
+        // 0 : all in-flight transactions must be to the same destination and VC
+        // 1 : all in-flight transactions of the SAME ID, must be to the same destination and VC
         
         sc_uint<dnp::D_W> this_dst = addr_lut_wr(this_req.addr);
-        sc_uint<cfg::VCS> this_vc = 0; // Requests on VC 0
+        sc_uint<dnp::V_W> this_vc  = tcm::req_vc(this_req.id.to_uint(), this_req.qos.to_uint(), true, this_dst.to_uint());
         
         if (cfg::ORD_SCHEME==0) {
           // Poll for Finished transactions until no longer reordering is possible.
           #pragma hls_pipeline_init_interval 1
           #pragma pipeline_stall_mode flush
-          while((outstanding>0) && (out_dst != this_dst)) {
+          while((outstanding>0) && ((out_dst != this_dst) || (out_vc != this_vc))) {
             sc_uint<dnp::ID_W> tid_fin;
             if(wr_trans_fin.nb_read(tid_fin)) outstanding--;
   
             cr_t vc_upd;
-            if(wr_flit_cr_in.PopNB(vc_upd)) wr_credits_avail[vc_upd]++;
+            if(wr_flit_cr_in.PopNB(vc_upd)) cr_return(wr_credits_avail, vc_upd);
             wait();
           }; // End of while reorder
           outstanding++;
           out_dst = this_dst;
+          out_vc  = this_vc;
         } else {
           outs_table_entry sel_entry = wr_out_table[this_req.id.to_uint()];
-          bool may_reorder   = (sel_entry.sent>0) && (sel_entry.dst_last != this_dst);
+          bool may_reorder   = (sel_entry.sent>0) && ((sel_entry.dst_last != this_dst) || (sel_entry.vc_last != this_vc));
           sc_uint<LOG_MAX_OUTS> wait_for =  sel_entry.sent; // Counts outstanding transactions to wait for
           // Poll Finished transactions until no longer reorder is possible.
-          while(may_reorder  || (wr_credits_avail[this_vc]==0)) {
+          while(may_reorder  || !crs::ready(wr_credits_avail, this_vc)) {
             sc_uint<dnp::ID_W> tid_fin;
             if(wr_trans_fin.nb_read(tid_fin)) {
               wr_out_table[tid_fin].sent--;
@@ -441,12 +467,13 @@ SC_MODULE(axi_master_if_vc) {
             may_reorder = (wait_for>0);
     
             cr_t vc_upd;
-            if(wr_flit_cr_in.PopNB(vc_upd)) wr_credits_avail[vc_upd]++;
+            if(wr_flit_cr_in.PopNB(vc_upd)) cr_return(wr_credits_avail, vc_upd);
             wait();
           }; // End of while reorder
   
           wr_out_table[this_req.id.to_uint()].sent++;
           wr_out_table[this_req.id.to_uint()].dst_last = this_dst;
+          wr_out_table[this_req.id.to_uint()].vc_last  = this_vc;
         }
 
         
@@ -458,7 +485,7 @@ SC_MODULE(axi_master_if_vc) {
         tmp_mule_flit.data[0] = ((sc_uint<dnp::PHIT_W>)0                           << dnp::req::REORD_PTR) |
                                 ((sc_uint<dnp::PHIT_W>)this_req.id                 << dnp::req::ID_PTR)  |
                                 ((sc_uint<dnp::PHIT_W>)dnp::PACK_TYPE__WR_REQ  << dnp::T_PTR)        |
-                                ((sc_uint<dnp::PHIT_W>)0                       << dnp::Q_PTR)        |
+                                ((sc_uint<dnp::PHIT_W>)(this_req.qos>>1)       << dnp::Q_PTR)        |
                                 ((sc_uint<dnp::PHIT_W>)this_dst                    << dnp::D_PTR)        |
                                 ((sc_uint<dnp::PHIT_W>)THIS_ID                     << dnp::S_PTR)        ;
         
@@ -469,24 +496,31 @@ SC_MODULE(axi_master_if_vc) {
                                 ((sc_uint<dnp::PHIT_W>)this_req.size                     << dnp::req::SZ_PTR)  |
                                 ((sc_uint<dnp::PHIT_W>)(this_req.addr >> dnp::AL_W) << dnp::req::AH_PTR)  ;
                 
+        // A short write carries its single beat past the header, thus the header flit is sent with the data
+        bool short_wr = dnp::SHORT_WR && (cfg::WREQ_PHITS>dnp::req::WDATA_PHIT) && (this_req.len==0) &&
+                        ((1<<this_req.size.to_uint()) <= ((cfg::WREQ_PHITS-dnp::req::WDATA_PHIT)<<dnp::BPP_W));
+
         // push header flit to NoC
-        //#pragma hls_pipeline_init_interval 1
-        //#pragma pipeline_stall_mode flush
-        while (wr_credits_avail[this_vc]==0) {
-          sc_uint<dnp::ID_W> tid_fin;
-          if(wr_trans_fin.nb_read(tid_fin)) {
-            if (cfg::ORD_SCHEME==0) outstanding--;
-            else                    wr_out_table[tid_fin].sent--; // update outstanding table
+        if (!short_wr) {
+          //#pragma hls_pipeline_init_interval 1
+          //#pragma pipeline_stall_mode flush
+          while (!crs::ready(wr_credits_avail, this_vc)) {
+            sc_uint<dnp::ID_W> tid_fin;
+            if(wr_trans_fin.nb_read(tid_fin)) {
+              if (cfg::ORD_SCHEME==0) outstanding--;
+              else                    wr_out_table[tid_fin].sent--; // update outstanding table
+            }
+
+            cr_t vc_upd;
+            if (wr_flit_cr_in.PopNB(vc_upd)) cr_return(wr_credits_avail, vc_upd);
+            wait();
           }
-          
-          cr_t vc_upd;
-          if (wr_flit_cr_in.PopNB(vc_upd)) wr_credits_avail[vc_upd]++;
+          FLIT_TS_DO(tmp_mule_flit.ts.inject(ts_acc);)
+          bool dbg_wreq_ok = wr_flit_data_out.PushNB(tmp_mule_flit); // We've already checked that !Full thus this should not block.
+          NVHLS_ASSERT_MSG(dbg_wreq_ok, "W Req pack DROP!!!");
+          wr_credits_avail[this_vc]--;
           wait();
         }
-        bool dbg_wreq_ok = wr_flit_data_out.PushNB(tmp_mule_flit); // We've already checked that !Full thus this should not block.
-        NVHLS_ASSERT_MSG(dbg_wreq_ok, "W Req pack DROP!!!");
-        wr_credits_avail[this_vc]--;
-        wait();
         
         // --- Start DATA Packetization --- //
         // Data Depacketization happens in a loop. Each iteration pops a flit and constructs a beat.
@@ -505,7 +539,7 @@ SC_MODULE(axi_master_if_vc) {
         //   - One to keep track axi byte lanes to place to data  (axi_lane_ptr)
         //   - One to point at the data of the flit               (flit_phit_ptr)
         sc_uint<8>       axi_lane_ptr  = addr_init_aligned; // Bytes MOD size
-        cnt_phit_wreq_t  flit_phit_ptr = 0;                 // Bytes MOD phits in flit
+        cnt_phit_wreq_t  flit_phit_ptr = short_wr ? dnp::req::WDATA_PHIT : 0; // Bytes MOD phits in flit
         
         sc_uint<16>  bytes_total  = ((this_req.len.to_uint()+1)<<this_req.size.to_uint());
         sc_uint<16>  bytes_packed = 0;
@@ -518,7 +552,7 @@ SC_MODULE(axi_master_if_vc) {
         gather_wr_beats : while (1) {
           // Calculate the bytes transferred in this iteration, depending the available flit bytes and the remaining to the beat
           sc_uint<8> bytes_axi_left  = ((1<<this_req.size.to_uint()) - (axi_lane_ptr & ((1<<this_req.size.to_uint())-1)));
-          sc_uint<8> bytes_flit_left = ((cfg::WREQ_PHITS<<1)         - (flit_phit_ptr<<1));
+          sc_uint<8> bytes_flit_left = ((cfg::WREQ_PHITS<<dnp::BPP_W)         - (flit_phit_ptr<<dnp::BPP_W));
           sc_uint<8> bytes_per_iter  = (bytes_axi_left<bytes_flit_left) ? bytes_axi_left : bytes_flit_left;
           
           // If current beat has been packed, pop next
@@ -533,28 +567,30 @@ SC_MODULE(axi_master_if_vc) {
           // Convert AXI Beats to flits.
           #pragma hls_unroll yes
           for (int i=0; i<cfg::WREQ_PHITS; ++i){ // i counts phits on the flit
-            if(i>=flit_phit_ptr && i<(flit_phit_ptr+(bytes_per_iter>>1))) {
-              sc_uint<8> loc_axi_ptr = (axi_lane_ptr + ((i-flit_phit_ptr)<<1));
-              tmp_mule_flit.data[i] = ((sc_uint<dnp::PHIT_W>)last_tmp                      << dnp::wdata::LA_PTR ) | // MSB
-                                      ((sc_uint<dnp::PHIT_W>)wstrb_tmp[loc_axi_ptr+1]      << dnp::wdata::E1_PTR ) |
-                                      ((sc_uint<dnp::PHIT_W>)wstrb_tmp[loc_axi_ptr  ]      << dnp::wdata::E0_PTR ) |
-                                      ((sc_uint<dnp::PHIT_W>)data_build_tmp[loc_axi_ptr+1] << dnp::wdata::B1_PTR ) | // (i*2) % 4
-                                      ((sc_uint<dnp::PHIT_W>)data_build_tmp[loc_axi_ptr  ] << dnp::wdata::B0_PTR ) ;
+            if(i>=flit_phit_ptr && i<(flit_phit_ptr+(bytes_per_iter>>dnp::BPP_W))) {
+              sc_uint<8> loc_axi_ptr = (axi_lane_ptr + ((i-flit_phit_ptr)<<dnp::BPP_W));
+              sc_uint<dnp::PHIT_W> phit = (sc_uint<dnp::PHIT_W>)last_tmp << dnp::wdata::LA_PTR; // MSB
+              #pragma hls_unroll yes
+              for (int b=0; b<dnp::BPP; ++b) {
+                phit |= ((sc_uint<dnp::PHIT_W>)wstrb_tmp[loc_axi_ptr+b]      << (dnp::wdata::E0_PTR+b*dnp::E_W)) |
+                        ((sc_uint<dnp::PHIT_W>)data_build_tmp[loc_axi_ptr+b] << (dnp::wdata::B0_PTR+b*dnp::B_W)) ;
+              }
+              tmp_mule_flit.data[i] = phit;
             }
           }
           
           // transaction event flags
           bool done_job  = ((bytes_packed+bytes_per_iter)==bytes_total);                            // All bytes are processed
-          bool done_flit = (flit_phit_ptr+(bytes_per_iter>>1)==cfg::WREQ_PHITS);                    // Flit got empty
+          bool done_flit = (flit_phit_ptr+(bytes_per_iter>>dnp::BPP_W)==cfg::WREQ_PHITS);                    // Flit got empty
           bool done_axi  = (((bytes_packed+bytes_per_iter)&((1<<(this_req.size.to_uint()))-1))==0); // Beat got full
           
           // Push the flit to NoC when either this Flit got the needed bytes or all bytes are transferred
           if(done_job || done_flit) {
-            tmp_mule_flit.type = (bytes_packed+bytes_per_iter==bytes_total) ? TAIL : BODY;
+            tmp_mule_flit.type = (short_wr) ? SINGLE : (bytes_packed+bytes_per_iter==bytes_total) ? TAIL : BODY;
             tmp_mule_flit.vc   = this_vc;
             //#pragma hls_pipeline_init_interval 1
             //#pragma pipeline_stall_mode flush
-            while (wr_credits_avail[this_vc]==0) {
+            while (!crs::ready(wr_credits_avail, this_vc)) {
               sc_uint<dnp::ID_W> tid_fin;
               if(wr_trans_fin.nb_read(tid_fin)) {
                 if (cfg::ORD_SCHEME==0) outstanding--;
@@ -562,7 +598,7 @@ SC_MODULE(axi_master_if_vc) {
               }
       
               cr_t vc_upd;
-              if (wr_flit_cr_in.PopNB(vc_upd)) wr_credits_avail[vc_upd]++;
+              if (wr_flit_cr_in.PopNB(vc_upd)) cr_return(wr_credits_avail, vc_upd);
               wait();
             }
             bool dbg_wreq_ok = wr_flit_data_out.PushNB(tmp_mule_flit); // We've already checked that !Full thus this should not block.
@@ -576,7 +612,7 @@ SC_MODULE(axi_master_if_vc) {
             break;
           } else { // Move to next iteration
             bytes_packed  = bytes_packed+bytes_per_iter;
-            flit_phit_ptr = (done_flit) ? 0 : (flit_phit_ptr +(bytes_per_iter>>1));
+            flit_phit_ptr = (done_flit) ? 0 : (flit_phit_ptr +(bytes_per_iter>>dnp::BPP_W));
             axi_lane_ptr  = ((unsigned)this_req.burst==enc_::AXBURST::FIXED) ? ((axi_lane_ptr+bytes_per_iter) & ((1<<this_req.size.to_uint())-1)) + addr_init_aligned :
                             ((axi_lane_ptr+bytes_per_iter) & (cfg::WR_LANES-1)) ;
           }
@@ -590,7 +626,7 @@ SC_MODULE(axi_master_if_vc) {
         }
         
         cr_t vc_upd;
-        if (wr_flit_cr_in.PopNB(vc_upd)) wr_credits_avail[vc_upd]++;
+        if (wr_flit_cr_in.PopNB(vc_upd)) cr_return(wr_credits_avail, vc_upd);
         wait();
       }
     } // End of While(1)
@@ -611,9 +647,10 @@ SC_MODULE(axi_master_if_vc) {
       // Blocking read from NoC to start depacketize the response
       wresp_flit_t flit_rcv;
       flit_rcv = wr_flit_data_in.Pop();
+      FLIT_TS_DO(flit_ts_stats::get().record(true, THIS_ID.read(), flit_rcv.get_src(), flit_rcv.ts);)
   
-      cr_t flit_rcv_vc = flit_rcv.get_vc();
-      bool dbg_wresp_cr_ok = wr_flit_cr_out.PushNB(flit_rcv_vc);
+      cr_t flit_rcv_cr = crs::single(flit_rcv.get_vc());
+      bool dbg_wresp_cr_ok = wr_flit_cr_out.PushNB(flit_rcv_cr);
       NVHLS_ASSERT_MSG(dbg_wresp_cr_ok, "W Resp credit DROP!!!");
       
       // Construct the trans Header to create the response
@@ -628,19 +665,23 @@ SC_MODULE(axi_master_if_vc) {
   }; // End of Write Resp De-pack
   
   
+  // Credits returned by the router, of a single VC or coalesced
+  inline void cr_return(cr_cnt_t credits[cfg::VCS], const cr_t &msg) {
+    #pragma hls_unroll yes
+    for (int v=0; v<cfg::VCS; ++v) credits[v] += crs::count(msg, v);
+  };
+  
   // Memory map resolving 
   inline unsigned char addr_lut_rd(const axi4_::Addr addr) {
-    for (int i=0; i<2; ++i) {
-      if (addr>=addr_map[i][0].read() && addr <= addr_map[i][1].read()) return i;
-    }
-    return 0; // Or send 404
+    bool hit;
+    unsigned char sel = addr_decoder<cfg::SLAVE_NUM>::decode(addr, addr_map, hit);
+    return sel;
   };
   
   inline unsigned char addr_lut_wr(const axi4_::Addr addr) {
-    for (int i=0; i<2; ++i) {
-      if (addr>=addr_map[i][0].read() && addr <= addr_map[i][1].read()) return i;
-    }
-    return 0; // Or send 404
+    bool hit;
+    unsigned char sel = addr_decoder<cfg::SLAVE_NUM>::decode(addr, addr_map, hit);
+    return sel;
   };
   
 }; // End of Master-IF module
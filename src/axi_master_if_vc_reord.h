@@ -16,12 +16,16 @@
 
 #include "./include/axi4_configs_extra.h"
 #include "./include/duth_fun.h"
+#include "./include/addr_dec.h"
+#include "./include/vc_credits.h"
+#include "./include/vc_tc_map.h"
 
 #define LOG_MAX_OUTS 8
 
 // --- Helping Data structures --- //
 struct outs_table_entry {
   sc_uint<dnp::D_W>     dst_last;
+  sc_uint<dnp::V_W>     vc_last;
   sc_uint<LOG_MAX_OUTS> sent;
   bool                  reorder;
 };
@@ -82,7 +86,11 @@ SC_MODULE(axi_master_if_vc) {
   typedef typename axi::axi4<axi::cfg::standard_duth> axi4_;
   typedef typename axi::AXI4_Encoding            enc_;
   
-  typedef sc_uint< nvhls::log2_ceil<cfg::VCS>::val > cr_t;
+  typedef vc_credits<cfg::VCS, cfg::BUFF_DEPTH, cfg::CR_COALESCE, cfg::DAMQ_SLOTS, cfg::DAMQ_RSV> crs; // Credits count the router's buffer slots
+  typedef typename crs::cr_t  cr_t;
+  typedef typename crs::cnt_t cr_cnt_t;
+  
+  typedef vc_tc_map<cfg::TCS, cfg::TC_MAP, dnp::ID_W> tcm; // Traffic class of each request
   
   typedef flit_dnp<cfg::RREQ_PHITS>  rreq_flit_t;
   typedef flit_dnp<cfg::RRESP_PHITS> rresp_flit_t;
@@ -157,6 +165,9 @@ SC_MODULE(axi_master_if_vc) {
     wr_trans_init (3),
     wr_trans_fin  (3) 
   { 
+    NVHLS_ASSERT_MSG(!dnp::NARROW_PACK, "Narrow packing is supported by axi_master_if/axi_slave_if only.");
+    NVHLS_ASSERT_MSG((cfg::TCS>0) && (2*cfg::TCS<=cfg::VCS), "Each traffic class needs a Request and a Response VC!");
+    
     SC_THREAD(rd_req_pack_job);
     sensitive << clk.pos();
     async_reset_signal_is(rst_n, false);
@@ -181,6 +192,7 @@ SC_MODULE(axi_master_if_vc) {
     //-- Start of Reset ---//
     for (int i=0; i<(1<<dnp::ID_W); ++i) {
       rd_out_table[i].dst_last = 0;
+      rd_out_table[i].vc_last  = 0;
       rd_out_table[i].sent     = 0;
       rd_out_table[i].reorder  = false;
     }
@@ -188,15 +200,15 @@ SC_MODULE(axi_master_if_vc) {
     for (int i=0; i<RD_REORD_SLOTS; ++i) rd_reord_avail[i] = true;
     unsigned char rd_avail_reord_slots = RD_REORD_SLOTS;
     
-    sc_uint<cfg::VCS> this_vc;
+    sc_uint<dnp::V_W> this_vc;
     unsigned char this_dst    = -1;
     unsigned char this_ticket = -1;
     unsigned char head_ticket = -1;
   
-    sc_uint<3> credits_avail[cfg::VCS];
+    cr_cnt_t   credits_avail[cfg::VCS];
     #pragma hls_unroll yes
     for (int i=0; i<cfg::VCS; ++i) {
-      credits_avail[i] = 3;
+      credits_avail[i] = cfg::BUFF_DEPTH;
     }
     
     ar_in.Reset();
@@ -206,31 +218,32 @@ SC_MODULE(axi_master_if_vc) {
     for (int i=0; i<(1<<dnp::ID_W); ++i) rd_out_table[i].dst_last=0;
     
     axi4_::AddrPayload this_req;
+    FLIT_TS_DO(flit_ts::stamp_t ts_acc = 0;)
     //-- End of Reset ---//
     while(1) {
       wait();
       if(ar_in.PopNB(this_req)) {
+        FLIT_TS_DO(ts_acc = flit_ts::now();)
         // A new request must stall until it is eligible to depart.
         // Reordering of responses of the same IDs are allowed and handled by the depacketizer in the reorder buffer
         // The response that might get reordered must be able to fit in the buffer
         outs_table_entry sel_entry = rd_out_table[this_req.id.to_uint()]; // Get info for this TID outstandings
         
         this_dst = addr_lut_rd(this_req.addr);
+        this_vc  = tcm::req_vc(this_req.id.to_uint(), this_req.qos.to_uint(), false, this_dst);
         // Check if reorder may occur
-        bool may_reorder   = (sel_entry.sent>0) && (sel_entry.dst_last != this_dst);
+        bool may_reorder   = (sel_entry.sent>0) && ((sel_entry.dst_last != this_dst) || (sel_entry.vc_last != this_vc));
         bool through_reord = may_reorder || sel_entry.reorder;
         
         unsigned char wait_for =  sel_entry.sent;
         
         // Calculate the size of the transaction to check if its able to fit in the reorder buffer
         unsigned int bytes_total = ((this_req.len+1)<<this_req.size.to_uint());
-        unsigned int phits_total = (bytes_total>>1) + 4; // each phit stores 2 bytes PLUS 2 header phits.
+        unsigned int phits_total = (bytes_total>>dnp::BPP_W) + 4; // each phit stores BPP bytes PLUS 2 header phits.
         unsigned int flits_total = (phits_total & 0x3) ? (phits_total>>2)+1 : (phits_total>>2);
   
-        this_vc = 0;
-        
         // All needed slots must available beforehand, thus wait until space has been freed or its no longer possible to be reordered
-        while((through_reord && (rd_avail_reord_slots < flits_total)) || (credits_avail[this_vc]==0) || (total_rd_flits_sent>9)) {
+        while((through_reord && (rd_avail_reord_slots < flits_total)) || !crs::ready(credits_avail, this_vc) || (total_rd_flits_sent>9)) {
           order_info rcv_fin;
           if(rd_trans_fin.nb_read(rcv_fin)) {
             if(rd_out_table[rcv_fin.tid].sent==1) rd_out_table[rcv_fin.tid].reorder = false;
@@ -244,12 +257,12 @@ SC_MODULE(axi_master_if_vc) {
           }
   
           cr_t vc_upd;
-          if(rd_flit_cr_in.PopNB(vc_upd)) credits_avail[vc_upd]++;
+          if(rd_flit_cr_in.PopNB(vc_upd)) cr_return(credits_avail, vc_upd);
           
           wait();
   
           sel_entry = rd_out_table[this_req.id.to_uint()];
-          may_reorder   = (sel_entry.sent>0) && (sel_entry.dst_last != this_dst);
+          may_reorder   = (sel_entry.sent>0) && ((sel_entry.dst_last != this_dst) || (sel_entry.vc_last != this_vc));
           through_reord = may_reorder || sel_entry.reorder;
         }; // End of while reorder
   
@@ -281,6 +294,7 @@ SC_MODULE(axi_master_if_vc) {
             
             // Send the allocated slot (ticket) to depacketizer, and update local info
             rd_out_table[this_req.id.to_uint()].dst_last = this_dst;
+            rd_out_table[this_req.id.to_uint()].vc_last  = this_vc;
             rd_out_table[this_req.id.to_uint()].sent = rd_out_table[this_req.id.to_uint()].sent + 1;
             total_rd_flits_sent++;
             rd_trans_init.write(trans_expect);
@@ -305,6 +319,7 @@ SC_MODULE(axi_master_if_vc) {
           trans_expect.ticket = flits_total;
           
           rd_out_table[this_req.id.to_uint()].dst_last = this_dst;
+          rd_out_table[this_req.id.to_uint()].vc_last  = this_vc;
           rd_out_table[this_req.id.to_uint()].sent     = rd_out_table[this_req.id.to_uint()].sent + flits_total;
           total_rd_flits_sent += flits_total;
           rd_trans_init.write(trans_expect);
@@ -326,7 +341,7 @@ SC_MODULE(axi_master_if_vc) {
         }
   
         cr_t vc_upd;
-        if(rd_flit_cr_in.PopNB(vc_upd)) credits_avail[vc_upd]++;
+        if(rd_flit_cr_in.PopNB(vc_upd)) cr_return(credits_avail, vc_upd);
         
         continue;
       }
@@ -341,7 +356,7 @@ SC_MODULE(axi_master_if_vc) {
       tmp_flit.data[0] = ((sc_uint<dnp::PHIT_W>)head_ticket            << dnp::req::REORD_PTR)|
                          ((sc_uint<dnp::PHIT_W>)this_req.id            << dnp::req::ID_PTR)   |
                          ((sc_uint<dnp::PHIT_W>)dnp::PACK_TYPE__RD_REQ << dnp::T_PTR)         |
-                         ((sc_uint<dnp::PHIT_W>)0                      << dnp::Q_PTR)         |
+                         ((sc_uint<dnp::PHIT_W>)(this_req.qos>>1)      << dnp::Q_PTR)         |
                          ((sc_uint<dnp::PHIT_W>)this_dst               << dnp::D_PTR)         |
                          ((sc_uint<dnp::PHIT_W>)THIS_ID.read()             << dnp::S_PTR)         ;
       
@@ -353,7 +368,7 @@ SC_MODULE(axi_master_if_vc) {
                          ((sc_uint<dnp::PHIT_W>)(this_req.addr >> dnp::AL_W) << dnp::req::AH_PTR ) ;
       
       // Try to push to Network, but continue reading for incoming finished transactions
-      while(credits_avail[this_vc]==0) {
+      while(!crs::ready(credits_avail, this_vc)) {
         order_info rcv_fin;
         if(rd_trans_fin.nb_read(rcv_fin)) {
           if(rd_out_table[rcv_fin.tid].sent==1) rd_out_table[rcv_fin.tid].reorder = false;
@@ -367,9 +382,10 @@ SC_MODULE(axi_master_if_vc) {
         }
   
         cr_t vc_upd;
-        if (rd_flit_cr_in.PopNB(vc_upd)) credits_avail[vc_upd]++;
+        if (rd_flit_cr_in.PopNB(vc_upd)) cr_return(credits_avail, vc_upd);
         wait();
       }
+      FLIT_TS_DO(tmp_flit.ts.inject(ts_acc);)
       bool dbg_rreq_ok = rd_flit_data_out.PushNB(tmp_flit); // We've already checked that !Full thus this should not block.
       NVHLS_ASSERT_MSG(dbg_rreq_ok, "R Req pack DROP!!!");
       credits_avail[this_vc]--;
@@ -455,14 +471,15 @@ SC_MODULE(axi_master_if_vc) {
       if (!bypass_valid) {
         rresp_flit_t flit_rcv;
         if (rd_flit_data_in.PopNB(flit_rcv)) {
-          cr_t flit_rcv_vc = flit_rcv.get_vc();
-          bool dbg_rresp_cr_ok = rd_flit_cr_out.PushNB(flit_rcv_vc);
+          cr_t flit_rcv_cr = crs::single(flit_rcv.get_vc());
+          bool dbg_rresp_cr_ok = rd_flit_cr_out.PushNB(flit_rcv_cr);
           NVHLS_ASSERT_MSG(dbg_rresp_cr_ok, "R Resp credit DROP!!!");
           
           unsigned char rcv_ticket;
-          if (flit_rcv.is_head() || flit_rcv.is_single())
+          if (flit_rcv.is_head() || flit_rcv.is_single()) {
             rcv_ticket = ((flit_rcv.data[0] >> (dnp::rresp::REORD_PTR)) & ((1<<dnp::REORD_W)-1));
-          else
+            FLIT_TS_DO(flit_ts_stats::get().record(false, THIS_ID.read(), flit_rcv.get_src(), flit_rcv.ts);)
+          } else
             rcv_ticket = rcv_ticket_nxt;
           
           // Through reorder when the ticket belongs to its slots
@@ -576,23 +593,24 @@ SC_MODULE(axi_master_if_vc) {
   
         // Calculate the bytes to transfer in this iteration
         sc_uint<8> bytes_axi_left  = ((1<<final_size) - (axi_lane_ptr & ((1<<final_size)-1)));
-        sc_uint<8> bytes_flit_left = ((cfg::RRESP_PHITS<<1) - (flit_phit_ptr<<1));
+        sc_uint<8> bytes_flit_left = ((cfg::RRESP_PHITS<<dnp::BPP_W) - (flit_phit_ptr<<dnp::BPP_W));
         sc_uint<8> bytes_per_iter  = (bytes_axi_left<bytes_flit_left) ? bytes_axi_left : bytes_flit_left;
   
         // Convert flits to AXI Beats.
         #pragma hls_unroll yes
-        build_resp: for (int i = 0; i < (cfg::RD_LANES >> 1); ++i) { // i counts AXI Byte Lanes IN PHITS (i.e. Lanes/bytes_in_phit)
-          if (i >= (axi_lane_ptr >> 1) && i < ((axi_lane_ptr + bytes_per_iter) >> 1)) {
-            cnt_phit_rresp_t loc_flit_ptr = flit_phit_ptr + (i - (axi_lane_ptr >> 1));
-            resp_build_tmp[(i << 1) + 1] =
-                    (cur_flit.data[loc_flit_ptr] >> dnp::rdata::B1_PTR) & ((1 << dnp::B_W) - 1); // MSB
-            resp_build_tmp[(i << 1)] = (cur_flit.data[loc_flit_ptr] >> dnp::rdata::B0_PTR) & ((1 << dnp::B_W) - 1); // LSB
+        build_resp: for (int i = 0; i < (cfg::RD_LANES>>dnp::BPP_W); ++i) { // i counts AXI Byte Lanes IN PHITS (i.e. Lanes/bytes_in_phit)
+          if (i >= (axi_lane_ptr>>dnp::BPP_W) && i < ((axi_lane_ptr+bytes_per_iter)>>dnp::BPP_W)) {
+            cnt_phit_rresp_t loc_flit_ptr = flit_phit_ptr + (i - (axi_lane_ptr>>dnp::BPP_W));
+            #pragma hls_unroll yes
+            for (int b=0; b<dnp::BPP; ++b) {
+              resp_build_tmp[(i<<dnp::BPP_W)+b] = (cur_flit.data[loc_flit_ptr] >> (dnp::rdata::B0_PTR+b*dnp::B_W)) & ((1<<dnp::B_W)-1);
+            }
           }
         }
         
         // transaction event flags
         bool done_job  = ((bytes_depacked+bytes_per_iter)==bytes_total);             // All bytes are processed
-        bool done_flit = (flit_phit_ptr+(bytes_per_iter>>1)==cfg::RRESP_PHITS);      // Flit got empty
+        bool done_flit = (flit_phit_ptr+(bytes_per_iter>>dnp::BPP_W)==cfg::RRESP_PHITS);      // Flit got empty
         bool done_axi  = (((bytes_depacked+bytes_per_iter)&((1<<final_size)-1))==0); // Beat got full
   
   
@@ -646,7 +664,7 @@ SC_MODULE(axi_master_if_vc) {
         } else {
           // Response continues, update pointers.
           bytes_depacked += bytes_per_iter;
-          flit_phit_ptr  = (done_flit) ? 0 : (flit_phit_ptr +(bytes_per_iter>>1));
+          flit_phit_ptr  = (done_flit) ? 0 : (flit_phit_ptr +(bytes_per_iter>>dnp::BPP_W));
           axi_lane_ptr   = (active_trans.burst==enc_::AXBURST::FIXED) ? ((axi_lane_ptr+bytes_per_iter) & ((1<<final_size)-1)) + addr_init_aligned :
                            ((axi_lane_ptr+bytes_per_iter) & (cfg::RD_LANES-1)) ;
         }
@@ -663,13 +681,14 @@ SC_MODULE(axi_master_if_vc) {
     aw_in.Reset();
     w_in.Reset();
   
-    sc_uint<3> wr_credits_avail[cfg::VCS];
+    cr_cnt_t   wr_credits_avail[cfg::VCS];
     for (int i=0; i<cfg::VCS; ++i) {
-      wr_credits_avail[i] = 3;
+      wr_credits_avail[i] = cfg::BUFF_DEPTH;
     }
 
     for (int i=0; i<(1<<dnp::ID_W); ++i) {
       wr_out_table[i].dst_last = 0;
+      wr_out_table[i].vc_last  = 0;
       wr_out_table[i].sent     = 0;
       wr_out_table[i].reorder  = false;
     }
@@ -677,7 +696,7 @@ SC_MODULE(axi_master_if_vc) {
     unsigned char wr_avail_reord_slots = WR_REORD_SLOTS;
     unsigned char this_ticket          = -1;
     unsigned char this_dst             = -1;
-    sc_uint<cfg::VCS> this_vc;
+    sc_uint<dnp::V_W> this_vc;
     
     while(1) {
       wait();
@@ -695,21 +714,23 @@ SC_MODULE(axi_master_if_vc) {
       }
   
       cr_t vc_upd;
-      if(wr_flit_cr_in.PopNB(vc_upd)) wr_credits_avail[vc_upd]++;
+      if(wr_flit_cr_in.PopNB(vc_upd)) cr_return(wr_credits_avail, vc_upd);
       
       axi4_::AddrPayload this_req;
+      FLIT_TS_DO(flit_ts::stamp_t ts_acc = 0;)
       if(aw_in.PopNB(this_req)) {
+        FLIT_TS_DO(ts_acc = flit_ts::now();)
         // A new request must stall until it is eligible to depart.
         // Reordering of responses of the same IDs are allowed and handled by the depacketizer in the reorder buffer
         // The response that might get reordered must be able to fit in the buffer
         outs_table_entry sel_entry = wr_out_table[this_req.id.to_uint()];
         this_dst = addr_lut_wr(this_req.addr);
+        this_vc  = tcm::req_vc(this_req.id.to_uint(), this_req.qos.to_uint(), true, this_dst);
     
-        bool          may_reorder   = (sel_entry.sent>0) && (sel_entry.dst_last != this_dst);
+        bool          may_reorder   = (sel_entry.sent>0) && ((sel_entry.dst_last != this_dst) || (sel_entry.vc_last != this_vc));
         bool          through_reord = may_reorder || sel_entry.reorder;
         unsigned char wait_for      =  sel_entry.sent;
   
-        this_vc = 0;
         // Stall until the necessary resources are available
         while(through_reord && (wr_avail_reord_slots<1)) {
           order_info rcv_fin;
@@ -753,7 +774,7 @@ SC_MODULE(axi_master_if_vc) {
       tmp_mule_flit.data[0] = ((sc_uint<dnp::PHIT_W>)this_ticket            << dnp::req::REORD_PTR) |
                               ((sc_uint<dnp::PHIT_W>)this_req.id            << dnp::req::ID_PTR)    |
                               ((sc_uint<dnp::PHIT_W>)dnp::PACK_TYPE__WR_REQ << dnp::T_PTR)          |
-                              ((sc_uint<dnp::PHIT_W>)0                      << dnp::Q_PTR)          |
+                              ((sc_uint<dnp::PHIT_W>)(this_req.qos>>1)      << dnp::Q_PTR)          |
                               ((sc_uint<dnp::PHIT_W>)this_dst               << dnp::D_PTR)          |
                               ((sc_uint<dnp::PHIT_W>)THIS_ID.read()             << dnp::S_PTR)          ;
   
@@ -766,6 +787,7 @@ SC_MODULE(axi_master_if_vc) {
 
       wr_out_table[this_req.id.to_uint()].sent++;
       wr_out_table[this_req.id.to_uint()].dst_last = this_dst;
+      wr_out_table[this_req.id.to_uint()].vc_last  = this_vc;
   
       order_info trans_expect;
       trans_expect.tid    = this_req.id.to_uint();
@@ -774,29 +796,36 @@ SC_MODULE(axi_master_if_vc) {
   
       wr_trans_init.write(trans_expect);
       
+      // A short write carries its single beat past the header, thus the header flit is sent with the data
+      bool short_wr = dnp::SHORT_WR && (cfg::WREQ_PHITS>dnp::req::WDATA_PHIT) && (this_req.len==0) &&
+                      ((1<<this_req.size.to_uint()) <= ((cfg::WREQ_PHITS-dnp::req::WDATA_PHIT)<<dnp::BPP_W));
+
       // If network is not ready, continue to poll for finished transactions
-      #pragma hls_pipeline_init_interval 1
-      #pragma pipeline_stall_mode flush
-      while(wr_credits_avail[this_vc]==0) {
-        order_info rcv_fin;
-        if(wr_trans_fin.nb_read(rcv_fin)) {
-          if(wr_out_table[rcv_fin.tid].sent==1) wr_out_table[rcv_fin.tid].reorder = false;
-          wr_out_table[rcv_fin.tid].sent = wr_out_table[rcv_fin.tid].sent - 1;
-    
-          if (rcv_fin.ticket<WR_REORD_SLOTS) {
-            wr_reord_avail[rcv_fin.ticket] = true;
-            wr_avail_reord_slots++;
+      if (!short_wr) {
+        #pragma hls_pipeline_init_interval 1
+        #pragma pipeline_stall_mode flush
+        while(!crs::ready(wr_credits_avail, this_vc)) {
+          order_info rcv_fin;
+          if(wr_trans_fin.nb_read(rcv_fin)) {
+            if(wr_out_table[rcv_fin.tid].sent==1) wr_out_table[rcv_fin.tid].reorder = false;
+            wr_out_table[rcv_fin.tid].sent = wr_out_table[rcv_fin.tid].sent - 1;
+
+            if (rcv_fin.ticket<WR_REORD_SLOTS) {
+              wr_reord_avail[rcv_fin.ticket] = true;
+              wr_avail_reord_slots++;
+            }
           }
-        }
-  
-        cr_t vc_upd;
-        if(wr_flit_cr_in.PopNB(vc_upd)) wr_credits_avail[vc_upd]++;
+
+          cr_t vc_upd;
+          if(wr_flit_cr_in.PopNB(vc_upd)) cr_return(wr_credits_avail, vc_upd);
+          wait();
+        };
+        FLIT_TS_DO(tmp_mule_flit.ts.inject(ts_acc);)
+        bool dbg_wreq_ok = wr_flit_data_out.PushNB(tmp_mule_flit); // We've already checked that !Full thus this should not block.
+        NVHLS_ASSERT_MSG(dbg_wreq_ok, "W Req pack DROP!!!");
+        wr_credits_avail[this_vc]--;
         wait();
-      };
-      bool dbg_wreq_ok = wr_flit_data_out.PushNB(tmp_mule_flit); // We've already checked that !Full thus this should not block.
-      NVHLS_ASSERT_MSG(dbg_wreq_ok, "W Req pack DROP!!!");
-      wr_credits_avail[this_vc]--;
-      wait();
+      }
   
       // --- Start DATA Packetization --- //
       // Data Depacketization happens in a loop. Each iteration pops a flit and constructs a beat.
@@ -815,7 +844,7 @@ SC_MODULE(axi_master_if_vc) {
       //   - One to keep track axi byte lanes to place to data  (axi_lane_ptr)
       //   - One to point at the data of the flit               (flit_phit_ptr)
       sc_uint<8>       axi_lane_ptr  = addr_init_aligned; // Bytes MOD size
-      cnt_phit_wreq_t  flit_phit_ptr = 0;                 // Bytes MOD phits in flit
+      cnt_phit_wreq_t  flit_phit_ptr = short_wr ? dnp::req::WDATA_PHIT : 0; // Bytes MOD phits in flit
   
       sc_uint<16>  bytes_total  = ((this_req.len.to_uint()+1)<<this_req.size.to_uint());
       sc_uint<16>  bytes_packed = 0;
@@ -829,7 +858,7 @@ SC_MODULE(axi_master_if_vc) {
         wait();
         // Calculate the bytes transferred in this iteration, depending the available flit bytes and the remaining to the beat
         sc_uint<8> bytes_axi_left  = ((1<<this_req.size.to_uint()) - (axi_lane_ptr & ((1<<this_req.size.to_uint())-1)));
-        sc_uint<8> bytes_flit_left = ((cfg::WREQ_PHITS<<1)         - (flit_phit_ptr<<1));
+        sc_uint<8> bytes_flit_left = ((cfg::WREQ_PHITS<<dnp::BPP_W)         - (flit_phit_ptr<<dnp::BPP_W));
         sc_uint<8> bytes_per_iter  = (bytes_axi_left<bytes_flit_left) ? bytes_axi_left : bytes_flit_left;
   
   
@@ -845,26 +874,28 @@ SC_MODULE(axi_master_if_vc) {
         // Convert AXI Beats to flits.
         #pragma hls_unroll yes
         for (int i=0; i<cfg::WREQ_PHITS; ++i){ // i counts phits on the flit
-          if(i>=flit_phit_ptr && i<(flit_phit_ptr+(bytes_per_iter>>1))) {
-            sc_uint<8> loc_axi_ptr = (axi_lane_ptr + ((i-flit_phit_ptr)<<1));
-            tmp_mule_flit.data[i] = ((sc_uint<dnp::PHIT_W>)last_tmp                      << dnp::wdata::LA_PTR ) | // MSB
-                                    ((sc_uint<dnp::PHIT_W>)wstrb_tmp[loc_axi_ptr+1]      << dnp::wdata::E1_PTR ) |
-                                    ((sc_uint<dnp::PHIT_W>)wstrb_tmp[loc_axi_ptr  ]      << dnp::wdata::E0_PTR ) |
-                                    ((sc_uint<dnp::PHIT_W>)data_build_tmp[loc_axi_ptr+1] << dnp::wdata::B1_PTR ) | // (i*2) % 4
-                                    ((sc_uint<dnp::PHIT_W>)data_build_tmp[loc_axi_ptr  ] << dnp::wdata::B0_PTR ) ;
+          if(i>=flit_phit_ptr && i<(flit_phit_ptr+(bytes_per_iter>>dnp::BPP_W))) {
+            sc_uint<8> loc_axi_ptr = (axi_lane_ptr + ((i-flit_phit_ptr)<<dnp::BPP_W));
+            sc_uint<dnp::PHIT_W> phit = (sc_uint<dnp::PHIT_W>)last_tmp << dnp::wdata::LA_PTR; // MSB
+            #pragma hls_unroll yes
+            for (int b=0; b<dnp::BPP; ++b) {
+              phit |= ((sc_uint<dnp::PHIT_W>)wstrb_tmp[loc_axi_ptr+b]      << (dnp::wdata::E0_PTR+b*dnp::E_W)) |
+                      ((sc_uint<dnp::PHIT_W>)data_build_tmp[loc_axi_ptr+b] << (dnp::wdata::B0_PTR+b*dnp::B_W)) ;
+            }
+            tmp_mule_flit.data[i] = phit;
           }
         }
         
         // transaction event flags
         bool done_job  = ((bytes_packed+bytes_per_iter)==bytes_total);                            // All bytes are processed
-        bool done_flit = (flit_phit_ptr+(bytes_per_iter>>1)==cfg::WREQ_PHITS);                    // Flit got empty
+        bool done_flit = (flit_phit_ptr+(bytes_per_iter>>dnp::BPP_W)==cfg::WREQ_PHITS);                    // Flit got empty
         bool done_axi  = (((bytes_packed+bytes_per_iter)&((1<<(this_req.size.to_uint()))-1))==0); // Beat got full
     
         // If network is not ready, continue to poll for finished transactions
         if(done_job || done_flit) {
-          tmp_mule_flit.type = (bytes_packed+bytes_per_iter==bytes_total) ? TAIL : BODY;
+          tmp_mule_flit.type = (short_wr) ? SINGLE : (bytes_packed+bytes_per_iter==bytes_total) ? TAIL : BODY;
           tmp_mule_flit.vc   = this_vc;
-          while (wr_credits_avail[this_vc]==0) {
+          while (!crs::ready(wr_credits_avail, this_vc)) {
             order_info rcv_fin;
             if(wr_trans_fin.nb_read(rcv_fin)) {
               if(wr_out_table[rcv_fin.tid].sent==1) wr_out_table[rcv_fin.tid].reorder = false;
@@ -877,7 +908,7 @@ SC_MODULE(axi_master_if_vc) {
             }
   
             cr_t vc_upd;
-            if (wr_flit_cr_in.PopNB(vc_upd)) wr_credits_avail[vc_upd]++;
+            if (wr_flit_cr_in.PopNB(vc_upd)) cr_return(wr_credits_avail, vc_upd);
             wait();
           }
           bool dbg_wreq_ok = wr_flit_data_out.PushNB(tmp_mule_flit); // We've already checked that !Full thus this should not block.
@@ -891,7 +922,7 @@ SC_MODULE(axi_master_if_vc) {
           break;
         } else { // Move to next iteration
           bytes_packed  = bytes_packed+bytes_per_iter;
-          flit_phit_ptr = (done_flit) ? 0 : (flit_phit_ptr +(bytes_per_iter>>1));
+          flit_phit_ptr = (done_flit) ? 0 : (flit_phit_ptr +(bytes_per_iter>>dnp::BPP_W));
           axi_lane_ptr  = ((unsigned)this_req.burst==enc_::AXBURST::FIXED) ? ((axi_lane_ptr+bytes_per_iter) & ((1<<this_req.size.to_uint())-1)) + addr_init_aligned :
                           ((axi_lane_ptr+bytes_per_iter) & (cfg::WR_LANES-1)) ;
         }
@@ -948,8 +979,9 @@ SC_MODULE(axi_master_if_vc) {
       bool bypass = false;
       wresp_flit_t flit_rcv;
       if(wr_flit_data_in.PopNB(flit_rcv)) {
-        cr_t flit_rcv_vc = flit_rcv.get_vc();
-        bool dbg_wresp_cr_ok = wr_flit_cr_out.PushNB(flit_rcv_vc);
+        FLIT_TS_DO(flit_ts_stats::get().record(true, THIS_ID.read(), flit_rcv.get_src(), flit_rcv.ts);)
+        cr_t flit_rcv_cr = crs::single(flit_rcv.get_vc());
+        bool dbg_wresp_cr_ok = wr_flit_cr_out.PushNB(flit_rcv_cr);
         NVHLS_ASSERT_MSG(dbg_wresp_cr_ok, "W Resp credit DROP!!!");
         
         unsigned char rcv_ticket = ((flit_rcv.data[0] >> (dnp::wresp::REORD_PTR)) & ((1<<dnp::REORD_W)-1));
@@ -1025,21 +1057,25 @@ SC_MODULE(axi_master_if_vc) {
   }; // End of Write Resp Packetizer  
   
   
+  // Credits returned by the router, of a single VC or coalesced
+  inline void cr_return(cr_cnt_t credits[cfg::VCS], const cr_t &msg) {
+    #pragma hls_unroll yes
+    for (int v=0; v<cfg::VCS; ++v) credits[v] += crs::count(msg, v);
+  };
+  
   // Memory map resolving
   inline unsigned char addr_lut_rd(const axi4_::Addr addr) {
-    for (int i=0; i<cfg::SLAVE_NUM; ++i) {
-      if (addr>=addr_map[i][0].read() && addr <= addr_map[i][1].read()) return i;
-    }
-    NVHLS_ASSERT_MSG(0, "RD address not resolved!");
-    return 0; 
+    bool hit;
+    unsigned char sel = addr_decoder<cfg::SLAVE_NUM>::decode(addr, addr_map, hit);
+    NVHLS_ASSERT_MSG(hit || addr_decoder<cfg::SLAVE_NUM>::HAS_DEF, "RD address not resolved!");
+    return sel;
   };
   
   inline unsigned char addr_lut_wr(const axi4_::Addr addr) {
-    for (int i=0; i<cfg::SLAVE_NUM; ++i) {
-      if (addr>=addr_map[i][0].read() && addr <= addr_map[i][1].read()) return i;
-    }
-    NVHLS_ASSERT_MSG(0, "WR address not resolved!");
-    return 0;
+    bool hit;
+    unsigned char sel = addr_decoder<cfg::SLAVE_NUM>::decode(addr, addr_map, hit);
+    NVHLS_ASSERT_MSG(hit || addr_decoder<cfg::SLAVE_NUM>::HAS_DEF, "WR address not resolved!");
+    return sel;
   };
   
   
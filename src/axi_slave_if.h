@@ -16,6 +16,7 @@
 
 #include "./include/axi4_configs_extra.h"
 #include "./include/duth_fun.h"
+#include "./include/outs_id_table.h"
 
 #define LOG_MAX_OUTS 8
 
@@ -27,7 +28,11 @@ struct rd_trans_info_t {
   sc_uint<dnp::SZ_W> size;
   sc_uint<dnp::LE_W> len;
   sc_uint<dnp::AP_W> addr_part;
-  sc_uint<dnp::REORD_W> reord_tct; // Used for reordering at master
+  sc_uint<dnp::Q_W>  qos;
+  sc_uint<dnp::REORD_W+dnp::REORD_H_W> reord_tct; // Used for reordering at master
+#if FLIT_TS_ON
+  flit_ts ts; // Of the request, carried to its response
+#endif
   
   inline friend std::ostream& operator << ( std::ostream& os, const rd_trans_info_t& info ) {
     os <<"S: "<< info.src /*<<", D: "<< info.dst*/ <<", TID: "<< info.tid <<", Bu: "<< info.burst <<"Si: "<< info.size <<"Le: "<< info.len <<", Ticket: "<<info.reord_tct;
@@ -58,7 +63,11 @@ struct rd_trans_info_t {
 struct wr_trans_info_t {
   sc_uint<dnp::S_W>  src;
   sc_uint<dnp::ID_W> tid;
-  sc_uint<dnp::REORD_W> reord_tct; // Used for reordering at master
+  sc_uint<dnp::Q_W>  qos;
+  sc_uint<dnp::REORD_W+dnp::REORD_H_W> reord_tct; // Used for reordering at master
+#if FLIT_TS_ON
+  flit_ts ts; // Of the request, carried to its response
+#endif
   
   inline friend std::ostream& operator << ( std::ostream& os, const wr_trans_info_t& info ) {
     os <<"S: "<< info.src << ", Id: " << info.tid <<", Ticket: "<<info.reord_tct;
@@ -85,6 +94,8 @@ struct wr_trans_info_t {
 // The interface gets the Request packets and independently reconstructs the AXI depending the Slave's attributes
 // The Responses are getting packetized into seperate threads and are fed back to the network
 // Thus Slave interface comprises of 4 distinct/parallel blocks WR/RD pack and WR/RD depack
+// Up to cfg::SLV_OUTS transactions per direction are outstanding at the Slave, of any AXI ID.
+//   The Resp packetizers keep them in an ID indexed table, thus the Slave may complete different IDs out of order.
 template <typename cfg>
 SC_MODULE(axi_slave_if) {
   typedef typename axi::axi4<axi::cfg::standard_duth> axi4_;
@@ -129,10 +140,12 @@ SC_MODULE(axi_slave_if) {
   // --- READ Internal FIFOs --- //
   sc_fifo<rd_trans_info_t>      rd_trans_init{"rd_trans_init"};
   sc_fifo< sc_uint<dnp::ID_W> > rd_trans_fin{"rd_trans_fin"};
+  outs_id_table<rd_trans_info_t, cfg::SLV_OUTS, dnp::ID_W> rd_outs_table;
   
   // --- WRITE Internal FIFOs --- //
   sc_fifo<wr_trans_info_t>      wr_trans_init{"wr_trans_init"};
   sc_fifo< sc_uint<dnp::ID_W> > wr_trans_fin{"wr_trans_fin"};
+  outs_id_table<wr_trans_info_t, cfg::SLV_OUTS, dnp::ID_W> wr_outs_table;
   
   // Constructor
   SC_HAS_PROCESS(axi_slave_if);    
@@ -140,10 +153,12 @@ SC_MODULE(axi_slave_if) {
     : 
     sc_module (name_),
     rd_trans_init (3),
-    rd_trans_fin  (3),
+    rd_trans_fin  (cfg::SLV_OUTS), // Holds every finished transaction, thus the Resp packetizer never blocks on it
     wr_trans_init (3),
-    wr_trans_fin  (3)
+    wr_trans_fin  (cfg::SLV_OUTS)
   { 
+    NVHLS_ASSERT_MSG((cfg::SLV_OUTS>0) && (cfg::SLV_OUTS<(1<<LOG_MAX_OUTS)), "SLV_OUTS must be in [1, 2^LOG_MAX_OUTS)");
+    
     SC_THREAD(rd_req_depack_job);
     sensitive << clk.pos();
     async_reset_signal_is(rst_n, false);
@@ -167,7 +182,6 @@ SC_MODULE(axi_slave_if) {
   //---------------------------------//
   void rd_req_depack_job () {
     sc_uint<LOG_MAX_OUTS>  rd_in_flight =  0;
-    sc_uint<dnp::ID_W>     outst_tid    = -1;
     rreq_flit_t            flit_rcv;
     
     ar_out.Reset();
@@ -181,15 +195,12 @@ SC_MODULE(axi_slave_if) {
         sc_uint<dnp::ID_W> orig_tid = (flit_rcv.data[0] >> dnp::req::ID_PTR) & ((1<<dnp::ID_W)-1);
         sc_uint<dnp::S_W>  req_src  = (flit_rcv.data[0] >> dnp::S_PTR)       & ((1<<dnp::S_W)-1);
         
-        // Wait while reordering is possible
+        // Wait while the outstanding transactions are at their limit
         #pragma hls_pipeline_init_interval 1
         #pragma pipeline_stall_mode flush
-        while ( ((rd_in_flight>0) && (orig_tid != outst_tid)) || (rd_in_flight>2) ) {
+        while (rd_in_flight>=cfg::SLV_OUTS) {
           sc_uint<dnp::ID_W> fin_tid;
-          if(rd_trans_fin.nb_read(fin_tid)) {
-            rd_in_flight--;
-            NVHLS_ASSERT(fin_tid==outst_tid);
-          }
+          if(rd_trans_fin.nb_read(fin_tid)) rd_in_flight--;
           wait();
         };
         
@@ -208,6 +219,7 @@ SC_MODULE(axi_slave_if) {
         temp_req.len   = final_len.to_uint();
         temp_req.size  = final_size.to_uint();
         temp_req.burst = (flit_rcv.data[2] >> dnp::req::BU_PTR)  & ((1<<dnp::BU_W)-1);
+        temp_req.qos   = ((flit_rcv.data[0] >> dnp::Q_PTR) & ((1<<dnp::Q_W)-1)) << 1;
         temp_req.addr  = ((((flit_rcv.data[2]>>dnp::req::AH_PTR) & ((1<<dnp::AH_W)-1)) << dnp::AL_W) |
                            ((flit_rcv.data[1]>>dnp::req::AL_PTR) & ((1<<dnp::AL_W)-1)))
                          - slave_base_addr.read();
@@ -220,22 +232,21 @@ SC_MODULE(axi_slave_if) {
         temp_info.size      = (flit_rcv.data[2] >> dnp::req::SZ_PTR) & ((1<<dnp::SZ_W)-1);
         temp_info.burst     = (flit_rcv.data[2] >> dnp::req::BU_PTR) & ((1<<dnp::BU_W)-1);
         temp_info.addr_part = (flit_rcv.data[1] & ((1<<dnp::AP_W)-1));
-        temp_info.reord_tct = (flit_rcv.data[0] >> dnp::req::REORD_PTR) & ((1<<dnp::REORD_W)-1);
+        temp_info.qos       = (flit_rcv.data[0] >> dnp::Q_PTR) & ((1<<dnp::Q_W)-1);
+        temp_info.reord_tct = (((flit_rcv.data[dnp::req::REORD_H_PHIT] >> dnp::req::REORD_H_PTR) & ((1<<dnp::REORD_H_W)-1)) << dnp::REORD_W) |
+                              ((flit_rcv.data[0] >> dnp::req::REORD_PTR) & ((1<<dnp::REORD_W)-1));
   
         NVHLS_ASSERT(((flit_rcv.data[0].to_uint() >> dnp::D_PTR) & ((1<<dnp::D_W)-1)) == (THIS_ID.read().to_uint()));
         
         rd_in_flight++;
-        outst_tid = temp_info.tid;
         
+        FLIT_TS_DO(flit_rcv.ts.eject_req(); temp_info.ts = flit_rcv.ts;)
         rd_trans_init.write(temp_info);
         ar_out.Push(temp_req);
       } else { 
         // No new transaction, Check for finished transaction
         sc_uint<dnp::ID_W> fin_tid;
-        if(rd_trans_fin.nb_read(fin_tid)) {
-          rd_in_flight--;
-          NVHLS_ASSERT(fin_tid==outst_tid);
-        }
+        if(rd_trans_fin.nb_read(fin_tid)) rd_in_flight--;
         wait();
       }
     } // End of while(1)
@@ -247,23 +258,43 @@ SC_MODULE(axi_slave_if) {
   void rd_resp_pack_job () {
     rd_flit_out.Reset();
     r_in.Reset();
+    rd_outs_table.reset();
     while(1) {
+      wait();
+      // Move the new transactions to the table
+      rd_trans_info_t new_info;
+      if (rd_trans_init.nb_read(new_info)) rd_outs_table.push(new_info.tid, new_info);
+
+      // The first beat of a response selects its transaction, the oldest of its ID.
+      //   Its info was sent before the request thus is either in the table or still in the FIFO.
+      //   Responses are not interleaved, the beats of a burst are consecutive
+      axi4_::ReadPayload first_resp;
+      if (!r_in.PopNB(first_resp)) continue;
+
+      sc_uint<dnp::ID_W> resp_tid = first_resp.id.to_uint();
+      while (!rd_outs_table.has(resp_tid)) {
+        new_info = rd_trans_init.read();
+        rd_outs_table.push(new_info.tid, new_info);
+      }
+
       rresp_flit_t    temp_flit;
-      rd_trans_info_t this_head = rd_trans_init.read();
+      rd_trans_info_t this_head = rd_outs_table.pop(resp_tid);
       //--- Build header ---
       temp_flit.type    = HEAD;
       temp_flit.data[0] = ((sc_uint<dnp::PHIT_W>)this_head.burst          << dnp::rresp::BU_PTR)    |
-                          ((sc_uint<dnp::PHIT_W>)this_head.reord_tct      << dnp::rresp::REORD_PTR) |
+                          ((sc_uint<dnp::PHIT_W>)(this_head.reord_tct & ((1<<dnp::REORD_W)-1)) << dnp::rresp::REORD_PTR) |
                           ((sc_uint<dnp::PHIT_W>)this_head.tid            << dnp::rresp::ID_PTR)    |
                           ((sc_uint<dnp::PHIT_W>)dnp::PACK_TYPE__RD_RESP  << dnp::T_PTR)            |
-                          ((sc_uint<dnp::PHIT_W>)0                        << dnp::Q_PTR)            |
+                          ((sc_uint<dnp::PHIT_W>)this_head.qos            << dnp::Q_PTR)            |
                           ((sc_uint<dnp::PHIT_W>)this_head.src            << dnp::D_PTR)            |
                           ((sc_uint<dnp::PHIT_W>)THIS_ID                  << dnp::S_PTR)            |
                           ((sc_uint<dnp::PHIT_W>)0                        << dnp::V_PTR)            ;
-      temp_flit.data[1] = ((sc_uint<dnp::PHIT_W>)(this_head.addr_part) << dnp::rresp::AP_PTR) |
+      temp_flit.data[1] = ((sc_uint<dnp::PHIT_W>)(this_head.reord_tct >> dnp::REORD_W) << dnp::rresp::REORD_H_PTR) |
+                          ((sc_uint<dnp::PHIT_W>)(this_head.addr_part) << dnp::rresp::AP_PTR) |
                           ((sc_uint<dnp::PHIT_W>)this_head.len         << dnp::rresp::LE_PTR) |
                           ((sc_uint<dnp::PHIT_W>)this_head.size        << dnp::rresp::SZ_PTR) ;
       
+      FLIT_TS_DO(temp_flit.ts = this_head.ts; temp_flit.ts.inject_rsp();)
       rd_flit_out.Push(temp_flit);
       
       // --- Start DATA Packetization --- //
@@ -272,9 +303,9 @@ SC_MODULE(axi_slave_if) {
       
       // For data Depacketization we keep 2 pointers.
       //   - One to keep track axi byte lanes to place to data  (axi_lane_ptr)
-      //   - One to point at the data of the flit               (flit_phit_ptr)
+      //   - One to point at the data of the flit               (flit_byte_ptr)
       sc_uint<8>        axi_lane_ptr  = addr_init_aligned;
-      cnt_phit_rresp_t  flit_phit_ptr = 0;
+      sc_uint<8>        flit_byte_ptr = 0;
   
       sc_uint<16> bytes_total  = ((this_head.len+1)<<this_head.size);  // Total number of bytes in the transaction
       sc_uint<16> bytes_packed = 0;                                    // Number of the packetized bytes
@@ -282,17 +313,20 @@ SC_MODULE(axi_slave_if) {
       unsigned char   data_build_tmp[cfg::RD_LANES];
       sc_uint<dnp::RE_W> resp_tmp;
       sc_uint<dnp::LA_W> last_tmp;
+      resp_tmp = first_resp.resp;
+      last_tmp = first_resp.last;
+      duth_fun<axi4_::Data , cfg::RD_LANES>::assign_ac2char(data_build_tmp , first_resp.data);
       #pragma hls_pipeline_init_interval 1
       #pragma pipeline_stall_mode flush
       gather_beats: while(1) {
         // Calculate the bytes to transfer in this iteration,
         //   depending the available flit bytes and the remaining to fill the beat
         sc_uint<8> bytes_axi_left  = ((1<<final_size) - (axi_lane_ptr & ((1<<final_size)-1)));
-        sc_uint<8> bytes_flit_left = ((cfg::RRESP_PHITS<<1) - (flit_phit_ptr<<1));
+        sc_uint<8> bytes_flit_left = ((cfg::RRESP_PHITS<<dnp::BPP_W) - flit_byte_ptr);
         sc_uint<8> bytes_per_iter  = (bytes_axi_left<bytes_flit_left) ? bytes_axi_left : bytes_flit_left;
-  
-        // When the axi lane pointer wraps a size get the next beat
-        if((bytes_packed & ((1<<final_size)-1))==0) {
+
+        // When the axi lane pointer wraps a size get the next beat. The first one is already popped
+        if((bytes_packed!=0) && ((bytes_packed & ((1<<final_size)-1))==0)) {
           axi4_::ReadPayload this_resp;
           this_resp = r_in.Pop();
           duth_fun<axi4_::Data , cfg::RD_LANES>::assign_ac2char(data_build_tmp , this_resp.data);
@@ -300,21 +334,28 @@ SC_MODULE(axi_slave_if) {
           resp_tmp = this_resp.resp;
         }
         
-        // Convert AXI Beats to flits.
+        // Convert AXI Beats to flits. With narrow packing several beats may fill a phit,
+        //   its first unit starts it over and the rest are merged into it
         #pragma hls_unroll yes
-        for (int i=0; i<cfg::RRESP_PHITS; ++i) { // i counts phits on the flit
-          if(i>=flit_phit_ptr && i<(flit_phit_ptr+(bytes_per_iter>>1))) {
-            sc_uint<8> loc_axi_ptr = (axi_lane_ptr + ((i-flit_phit_ptr)<<1));
-            temp_flit.data[i] = ((sc_uint<dnp::PHIT_W>)resp_tmp                      << dnp::rdata::RE_PTR) | // MSB
-                                ((sc_uint<dnp::PHIT_W>)last_tmp                      << dnp::rdata::LA_PTR) |
-                                ((sc_uint<dnp::PHIT_W>)data_build_tmp[loc_axi_ptr+1] << dnp::rdata::B1_PTR) | // (i*2) % 4
-                                ((sc_uint<dnp::PHIT_W>)data_build_tmp[loc_axi_ptr  ] << dnp::rdata::B0_PTR) ; // LSB
+        for (int u=0; u<((cfg::RRESP_PHITS<<dnp::BPP_W)>>dnp::PACK_GRAN_W); ++u) { // u counts packing units on the flit
+          if((u<<dnp::PACK_GRAN_W)>=flit_byte_ptr && (u<<dnp::PACK_GRAN_W)<(flit_byte_ptr+bytes_per_iter)) {
+            const int  p   = u>>(dnp::BPP_W-dnp::PACK_GRAN_W);     // The unit's phit
+            const int  off = (u<<dnp::PACK_GRAN_W)&(dnp::BPP-1);   // and its first byte in it
+            sc_uint<8> loc_axi_ptr = (axi_lane_ptr + ((u<<dnp::PACK_GRAN_W)-flit_byte_ptr));
+            sc_uint<dnp::PHIT_W> phit = (off==0) ? (sc_uint<dnp::PHIT_W>)0 : temp_flit.data[p];
+            phit |= ((sc_uint<dnp::PHIT_W>)resp_tmp << (dnp::rdata::RE_PTR+(off>>dnp::PACK_GRAN_W)*dnp::RE_W)) | // Per unit, thus per beat
+                    ((sc_uint<dnp::PHIT_W>)last_tmp << dnp::rdata::LA_PTR) ;
+            #pragma hls_unroll yes
+            for (int b=0; b<dnp::PACK_GRAN; ++b) {
+              phit |= ((sc_uint<dnp::PHIT_W>)data_build_tmp[loc_axi_ptr+b] << (dnp::rdata::B0_PTR+(off+b)*dnp::B_W));
+            }
+            temp_flit.data[p] = phit;
           }
         }
         
         // transaction event flags 
         bool done_job  = ((bytes_packed+bytes_per_iter)==bytes_total);             // All bytes are processed
-        bool done_flit = (flit_phit_ptr+(bytes_per_iter>>1)==cfg::RRESP_PHITS);    // Flit got empty
+        bool done_flit = ((flit_byte_ptr+bytes_per_iter)==(cfg::RRESP_PHITS<<dnp::BPP_W)); // Flit got empty
         bool done_axi  = (((bytes_packed+bytes_per_iter)&((1<<final_size)-1))==0); // Beat got full
         
         // Push the flit to NoC
@@ -331,7 +372,7 @@ SC_MODULE(axi_slave_if) {
         } else {  
           // Move to next iteration
           bytes_packed  += bytes_per_iter;
-          flit_phit_ptr = (done_flit) ? 0 : (flit_phit_ptr +(bytes_per_iter>>1));
+          flit_byte_ptr = (done_flit) ? 0 : (flit_byte_ptr + bytes_per_iter);
           axi_lane_ptr  = (this_head.burst==enc_::AXBURST::FIXED) ? ((axi_lane_ptr+bytes_per_iter) & ((1<<final_size)-1)) + addr_init_aligned :
                                                                     ((axi_lane_ptr+bytes_per_iter) & (cfg::RD_LANES-1)) ;
         }
@@ -345,7 +386,6 @@ SC_MODULE(axi_slave_if) {
   //-----------------------------------//  
   void wr_req_depack_job () {
     sc_uint<LOG_MAX_OUTS>    wr_in_flight = 0;
-    sc_uint<dnp::ID_W>  outst_tid    = -1;
     
     aw_out.Reset();
     w_out.Reset();
@@ -356,16 +396,13 @@ SC_MODULE(axi_slave_if) {
         sc_uint<dnp::ID_W> orig_tid = (flit_rcv.data[0] >> dnp::req::ID_PTR) & ((1<<dnp::ID_W)-1);
         sc_uint<dnp::S_W>  req_src  = (flit_rcv.data[0] >> dnp::S_PTR)       & ((1<<dnp::S_W)-1);
         
-        // Wait while reordering is possible
+        // Wait while the outstanding transactions are at their limit
         #pragma hls_pipeline_init_interval 1
         #pragma pipeline_stall_mode flush
-        while ( (wr_in_flight>0) && (orig_tid != outst_tid) || (wr_in_flight>2) ) {
+        while (wr_in_flight>=cfg::SLV_OUTS) {
           // Check for finished transactions
           sc_uint<dnp::ID_W> fin_tid;
-          if(wr_trans_fin.nb_read(fin_tid)) {
-            wr_in_flight--;
-            NVHLS_ASSERT(fin_tid==outst_tid);
-          }
+          if(wr_trans_fin.nb_read(fin_tid)) wr_in_flight--;
           wait();
         };
   
@@ -383,6 +420,7 @@ SC_MODULE(axi_slave_if) {
         this_req.len   = final_len.to_uint();
         this_req.size  = final_size.to_uint();
         this_req.burst = (flit_rcv.data[2] >> dnp::req::BU_PTR)  & ((1<<dnp::BU_W)-1);
+        this_req.qos   = ((flit_rcv.data[0] >> dnp::Q_PTR) & ((1<<dnp::Q_W)-1)) << 1;
         this_req.addr  = ((((flit_rcv.data[2]>>dnp::req::AH_PTR) & ((1<<dnp::AH_W)-1)) << dnp::AL_W) |
                           ((flit_rcv.data[1]>>dnp::req::AL_PTR)  & ((1<<dnp::AL_W)-1)))
                          - slave_base_addr.read();
@@ -393,12 +431,14 @@ SC_MODULE(axi_slave_if) {
         wr_trans_info_t this_info;
         this_info.tid       = orig_tid;
         this_info.src       = req_src;
-        this_info.reord_tct = (flit_rcv.data[0] >> dnp::req::REORD_PTR)  & ((1<<dnp::REORD_W)-1);
+        this_info.qos       = (flit_rcv.data[0] >> dnp::Q_PTR) & ((1<<dnp::Q_W)-1);
+        this_info.reord_tct = (((flit_rcv.data[dnp::req::REORD_H_PHIT] >> dnp::req::REORD_H_PTR) & ((1<<dnp::REORD_H_W)-1)) << dnp::REORD_W) |
+                              ((flit_rcv.data[0] >> dnp::req::REORD_PTR)  & ((1<<dnp::REORD_W)-1));
         
         // update bookkeeping vars
         wr_in_flight++;
-        outst_tid = orig_tid;
         // Push info to Resp-pack and request to Slave
+        FLIT_TS_DO(flit_rcv.ts.eject_req(); this_info.ts = flit_rcv.ts;)
         wr_trans_init.write(this_info);
         aw_out.Push(this_req);
         
@@ -413,7 +453,9 @@ SC_MODULE(axi_slave_if) {
         // Gather DATA
         sc_uint<8>        addr_init_aligned  = (this_req.addr.to_uint() & (cfg::WR_LANES-1)) & ~((1<<final_size)-1);
         sc_uint<8>        axi_lane_ptr       = addr_init_aligned;
-        cnt_phit_wreq_t   flit_phit_ptr      = 0;
+        // A short write (SINGLE) carries its data past the header, the data flit is the header flit
+        bool              short_wr           = dnp::SHORT_WR && (flit_rcv.type==SINGLE);
+        sc_uint<8>        flit_byte_ptr      = short_wr ? (dnp::req::WDATA_PHIT<<dnp::BPP_W) : 0;
     
         sc_uint<16> bytes_total    = ((this_req.len.to_uint()+1)<<this_req.size.to_uint());
         sc_uint<16> bytes_depacked = 0;
@@ -423,39 +465,38 @@ SC_MODULE(axi_slave_if) {
         gather_wr_flits : while (1) {
           // Calculate the bytes transferred in this iteration, depending the available flit bytes and the remaining to the beat
           sc_uint<8> bytes_axi_left  = ((1<<this_req.size.to_uint()) - (axi_lane_ptr & ((1<<this_req.size.to_uint())-1)));
-          sc_uint<8> bytes_flit_left = ((cfg::WREQ_PHITS<<1)         - (flit_phit_ptr<<1));
+          sc_uint<8> bytes_flit_left = ((cfg::WREQ_PHITS<<dnp::BPP_W)         - flit_byte_ptr);
           sc_uint<8> bytes_per_iter  = (bytes_axi_left<bytes_flit_left) ? bytes_axi_left : bytes_flit_left;
   
-          // When the phit pointer resets get the next flit
-          if(flit_phit_ptr==0) {
+          // When the flit pointer resets get the next flit
+          if(flit_byte_ptr==0) {
             #pragma hls_pipeline_init_interval 1
             #pragma pipeline_stall_mode flush
             while (!wr_flit_in.PopNB(flit_rcv)) {
               sc_uint<dnp::ID_W> fin_tid;
-              if(wr_trans_fin.nb_read(fin_tid)) {
-                wr_in_flight--;
-                NVHLS_ASSERT(fin_tid==outst_tid);
-              }
+              if(wr_trans_fin.nb_read(fin_tid)) wr_in_flight--;
               wait();
             }
           }
   
           // Convert AXI Beats to flits.
           #pragma hls_unroll yes
-          build_resp: for (unsigned int i=0; i<(cfg::WR_LANES>>1); ++i){ // i counts PHITS
-            if(i>=(axi_lane_ptr>>1) && i<((axi_lane_ptr+bytes_per_iter)>>1)) {
-              sc_uint<8> loc_flit_ptr = flit_phit_ptr + (i-(axi_lane_ptr>>1));
-              data_build_tmp[(i<<1)+1] = (flit_rcv.data[loc_flit_ptr] >> dnp::wdata::B1_PTR) & ((1<<dnp::B_W)-1); // MSB
-              data_build_tmp[(i<<1)  ] = (flit_rcv.data[loc_flit_ptr] >> dnp::wdata::B0_PTR) & ((1<<dnp::B_W)-1); // LSB
-        
-              wstr_build_tmp[(i<<1)+1] = (flit_rcv.data[loc_flit_ptr] >> dnp::wdata::E1_PTR) & ((1<<dnp::E_W)-1); // MSB
-              wstr_build_tmp[(i<<1)  ] = (flit_rcv.data[loc_flit_ptr] >> dnp::wdata::E0_PTR) & ((1<<dnp::E_W)-1); // LSB
+          build_resp: for (unsigned int u=0; u<(cfg::WR_LANES>>dnp::PACK_GRAN_W); ++u){ // u counts PACKING UNITS (phits, or bytes when narrow packing)
+            if((u<<dnp::PACK_GRAN_W)>=axi_lane_ptr && (u<<dnp::PACK_GRAN_W)<(axi_lane_ptr+bytes_per_iter)) {
+              sc_uint<8> loc_flit_byte = flit_byte_ptr + ((u<<dnp::PACK_GRAN_W)-axi_lane_ptr);
+              sc_uint<8> loc_flit_ptr  = loc_flit_byte >> dnp::BPP_W;                  // The unit's phit
+              sc_uint<8> loc_phit_byte = loc_flit_byte & (dnp::BPP-dnp::PACK_GRAN);    // and its first byte in it, 0 unless narrow packing
+              #pragma hls_unroll yes
+              for (int b=0; b<dnp::PACK_GRAN; ++b) {
+                data_build_tmp[(u<<dnp::PACK_GRAN_W)+b] = (flit_rcv.data[loc_flit_ptr] >> (dnp::wdata::B0_PTR+(loc_phit_byte+b)*dnp::B_W)) & ((1<<dnp::B_W)-1);
+                wstr_build_tmp[(u<<dnp::PACK_GRAN_W)+b] = (flit_rcv.data[loc_flit_ptr] >> (dnp::wdata::E0_PTR+(loc_phit_byte+b)*dnp::E_W)) & ((1<<dnp::E_W)-1);
+              }
             }
           }
   
           // transaction event flags
           bool done_job  = ((bytes_depacked+bytes_per_iter)==bytes_total);             // All bytes are processed
-          bool done_flit = (flit_phit_ptr+(bytes_per_iter>>1)==cfg::WREQ_PHITS);       // Flit got empty
+          bool done_flit = ((flit_byte_ptr+bytes_per_iter)==(cfg::WREQ_PHITS<<dnp::BPP_W)); // Flit got empty
           bool done_axi  = (((bytes_depacked+bytes_per_iter)&((1<<final_size)-1))==0); // Beat got full
           
           if(done_job || done_axi ) {
@@ -476,7 +517,7 @@ SC_MODULE(axi_slave_if) {
             break;
           } else {
             bytes_depacked +=bytes_per_iter;
-            flit_phit_ptr = (done_flit) ? 0 : (flit_phit_ptr +(bytes_per_iter>>1));
+            flit_byte_ptr = (done_flit) ? 0 : (flit_byte_ptr + bytes_per_iter);
             axi_lane_ptr   = ((unsigned)this_req.burst==enc_::AXBURST::FIXED) ? ((axi_lane_ptr+bytes_per_iter) & ((1<<this_req.size.to_uint())-1)) + addr_init_aligned :
                                                                       ((axi_lane_ptr+bytes_per_iter) & (cfg::WR_LANES-1)) ;
           }
@@ -484,10 +525,7 @@ SC_MODULE(axi_slave_if) {
       } else {
         // Check for finished transactions
         sc_uint<dnp::ID_W> fin_tid;
-        if(wr_trans_fin.nb_read(fin_tid)) {
-          wr_in_flight--;
-          NVHLS_ASSERT(fin_tid==outst_tid);
-        }
+        if(wr_trans_fin.nb_read(fin_tid)) wr_in_flight--;
         wait();
       }
     } // End of while(1)
@@ -500,24 +538,40 @@ SC_MODULE(axi_slave_if) {
   void wr_resp_pack_job(){
     wr_flit_out.Reset();
     b_in.Reset();
+    wr_outs_table.reset();
     #pragma hls_pipeline_init_interval 1
     #pragma pipeline_stall_mode flush
     while(1) {
       wait();
-      wresp_flit_t temp_flit;
-      wr_trans_info_t     this_head = wr_trans_init.read();
-      axi4_::WRespPayload this_resp = b_in.Pop();
+      // Move the new transactions to the table
+      wr_trans_info_t new_info;
+      if (wr_trans_init.nb_read(new_info)) wr_outs_table.push(new_info.tid, new_info);
+
+      // The response selects its transaction, the oldest of its ID
+      axi4_::WRespPayload this_resp;
+      if (!b_in.PopNB(this_resp)) continue;
+
+      sc_uint<dnp::ID_W> resp_tid = this_resp.id.to_uint();
+      while (!wr_outs_table.has(resp_tid)) {
+        new_info = wr_trans_init.read();
+        wr_outs_table.push(new_info.tid, new_info);
+      }
+
+      wresp_flit_t    temp_flit;
+      wr_trans_info_t this_head = wr_outs_table.pop(resp_tid);
       
       temp_flit.type = SINGLE;
       
       temp_flit.data[0] = ((sc_uint<dnp::PHIT_W>)this_resp.resp             << dnp::wresp::RESP_PTR ) |
-                          ((sc_uint<dnp::PHIT_W>)this_head.reord_tct        << dnp::wresp::REORD_PTR )   |
+                          ((sc_uint<dnp::PHIT_W>)(this_head.reord_tct & ((1<<dnp::REORD_W)-1)) << dnp::wresp::REORD_PTR )   |
                           ((sc_uint<dnp::PHIT_W>)this_head.tid              << dnp::wresp::ID_PTR )   |
                           ((sc_uint<dnp::PHIT_W>)dnp::PACK_TYPE__WR_RESP << dnp::T_PTR ) |
-                          ((sc_uint<dnp::PHIT_W>)0                       << dnp::Q_PTR ) |
+                          ((sc_uint<dnp::PHIT_W>)this_head.qos           << dnp::Q_PTR ) |
                           ((sc_uint<dnp::PHIT_W>)this_head.src              << dnp::D_PTR ) |
                           ((sc_uint<dnp::PHIT_W>)THIS_ID                    << dnp::S_PTR ) ;
+      if (cfg::WRESP_PHITS>1) temp_flit.data[dnp::wresp::REORD_H_PHIT] = ((sc_uint<dnp::PHIT_W>)(this_head.reord_tct >> dnp::REORD_W) << dnp::wresp::REORD_H_PTR);
       
+      FLIT_TS_DO(temp_flit.ts = this_head.ts; temp_flit.ts.inject_rsp();)
       wr_flit_out.Push(temp_flit);
       wr_trans_fin.write(this_head.tid);
     } // End of While(1)
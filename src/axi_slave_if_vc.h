@@ -14,6 +14,8 @@
 #include "./include/axi4_configs_extra.h"
 #include "./include/flit_axi.h"
 #include "./include/duth_fun.h"
+#include "./include/vc_credits.h"
+#include "./include/vc_tc_map.h"
 
 #include <axi/axi4.h>
 
@@ -27,7 +29,12 @@ struct rd_trans_info_t {
   sc_uint<dnp::SZ_W> size;
   sc_uint<dnp::LE_W> len;
   sc_uint<dnp::AP_W> addr_part;
+  sc_uint<dnp::Q_W>  qos;
+  sc_uint<dnp::V_W>  vc;           // The Request's VC, Responses follow its class
   sc_uint<dnp::REORD_W> reord_tct; // Used for reordering at master
+#if FLIT_TS_ON
+  flit_ts ts; // Of the request, carried to its response
+#endif
   
   inline friend std::ostream& operator << ( std::ostream& os, const rd_trans_info_t& info ) {
     os <<"S: "<< info.src /*<<", D: "<< info.dst*/ <<", TID: "<< info.tid <<", Bu: "<< info.burst <<"Si: "<< info.size <<"Le: "<< info.len <<", Ticket: "<<info.reord_tct;
@@ -58,7 +65,12 @@ struct rd_trans_info_t {
 struct wr_trans_info_t {
   sc_uint<dnp::S_W>  src;
   sc_uint<dnp::ID_W> tid;
+  sc_uint<dnp::Q_W>  qos;
+  sc_uint<dnp::V_W>  vc;           // The Request's VC, Responses follow its class
   sc_uint<dnp::REORD_W> reord_tct; // Used for reordering at master
+#if FLIT_TS_ON
+  flit_ts ts; // Of the request, carried to its response
+#endif
   
   inline friend std::ostream& operator << ( std::ostream& os, const wr_trans_info_t& info ) {
     os <<"S: "<< info.src << ", Id: " << info.tid <<", Ticket: "<<info.reord_tct;
@@ -90,7 +102,11 @@ SC_MODULE(axi_slave_if_vc) {
   typedef typename axi::axi4<axi::cfg::standard_duth> axi4_;
   typedef typename axi::AXI4_Encoding            enc_;
     
-  typedef sc_uint< nvhls::log2_ceil<cfg::VCS>::val > cr_t;
+  typedef vc_credits<cfg::VCS, cfg::BUFF_DEPTH, cfg::CR_COALESCE, cfg::DAMQ_SLOTS, cfg::DAMQ_RSV> crs; // Credits count the router's buffer slots
+  typedef typename crs::cr_t  cr_t;
+  typedef typename crs::cnt_t cr_cnt_t;
+  
+  typedef vc_tc_map<cfg::TCS, cfg::TC_MAP, dnp::ID_W> tcm; // Traffic class of each response
   
   typedef flit_dnp<cfg::RREQ_PHITS>   rreq_flit_t;
   typedef flit_dnp<cfg::RRESP_PHITS>  rresp_flit_t;
@@ -152,6 +168,9 @@ SC_MODULE(axi_slave_if_vc) {
     wr_trans_init (3),
     wr_trans_fin  (3)
   { 
+    NVHLS_ASSERT_MSG(!dnp::NARROW_PACK, "Narrow packing is supported by axi_master_if/axi_slave_if only.");
+    NVHLS_ASSERT_MSG((cfg::TCS>0) && (2*cfg::TCS<=cfg::VCS), "Each traffic class needs a Request and a Response VC!");
+    
     SC_THREAD(rd_req_depack_job);
     sensitive << clk.pos();
     async_reset_signal_is(rst_n, false);
@@ -187,8 +206,8 @@ SC_MODULE(axi_slave_if_vc) {
     while(1) {
       // Poll NoC for request flits
       if(rd_flit_data_in.PopNB(flit_rcv)) {
-        cr_t flit_rcv_vc = flit_rcv.get_vc();
-        bool dbg_rreq_cr_ok = rd_flit_cr_out.PushNB(flit_rcv_vc);
+        cr_t flit_rcv_cr = crs::single(flit_rcv.get_vc());
+        bool dbg_rreq_cr_ok = rd_flit_cr_out.PushNB(flit_rcv_cr);
         NVHLS_ASSERT_MSG(dbg_rreq_cr_ok, "R Req credit DROP!!!");
         
         sc_uint<dnp::ID_W> orig_tid = (flit_rcv.data[0] >> dnp::req::ID_PTR) & ((1<<dnp::ID_W)-1);
@@ -221,6 +240,7 @@ SC_MODULE(axi_slave_if_vc) {
         temp_req.len   = final_len.to_uint();
         temp_req.size  = final_size.to_uint();
         temp_req.burst = (flit_rcv.data[2] >> dnp::req::BU_PTR)  & ((1<<dnp::BU_W)-1);
+        temp_req.qos   = ((flit_rcv.data[0] >> dnp::Q_PTR) & ((1<<dnp::Q_W)-1)) << 1;
         temp_req.addr  = ((((flit_rcv.data[2]>>dnp::req::AH_PTR) & ((1<<dnp::AH_W)-1)) << dnp::AL_W) |
                            ((flit_rcv.data[1]>>dnp::req::AL_PTR) & ((1<<dnp::AL_W)-1)))
                          - slave_base_addr.read();
@@ -233,6 +253,8 @@ SC_MODULE(axi_slave_if_vc) {
         temp_info.size      = (flit_rcv.data[2] >> dnp::req::SZ_PTR) & ((1<<dnp::SZ_W)-1);
         temp_info.burst     = (flit_rcv.data[2] >> dnp::req::BU_PTR) & ((1<<dnp::BU_W)-1);
         temp_info.addr_part = (flit_rcv.data[1] & ((1<<dnp::AP_W)-1));
+        temp_info.qos       = (flit_rcv.data[0] >> dnp::Q_PTR) & ((1<<dnp::Q_W)-1);
+        temp_info.vc        = flit_rcv.get_vc();
         temp_info.reord_tct = (flit_rcv.data[0] >> dnp::req::REORD_PTR) & ((1<<dnp::REORD_W)-1);
   
         NVHLS_ASSERT(((flit_rcv.data[0].to_uint() >> dnp::D_PTR) & ((1<<dnp::D_W)-1)) == (THIS_ID.read().to_uint()));
@@ -240,6 +262,7 @@ SC_MODULE(axi_slave_if_vc) {
         rd_in_flight++;
         outst_tid = temp_info.tid;
         
+        FLIT_TS_DO(flit_rcv.ts.eject_req(); temp_info.ts = flit_rcv.ts;)
         rd_trans_init.write(temp_info);
         ar_out.Push(temp_req);
       } else { 
@@ -262,15 +285,15 @@ SC_MODULE(axi_slave_if_vc) {
     rd_flit_cr_in.Reset();
     r_in.Reset();
   
-    sc_uint<3> credits_avail[cfg::VCS];
+    cr_cnt_t   credits_avail[cfg::VCS];
     for (int i=0; i<cfg::VCS; ++i) {
-      credits_avail[i] = 3;
+      credits_avail[i] = cfg::BUFF_DEPTH;
     }
     
     while(1) {
       rresp_flit_t temp_flit;
       rd_trans_info_t   this_head = rd_trans_init.read();
-      sc_uint<cfg::VCS> this_vc   = 1;
+      sc_uint<dnp::V_W> this_vc   = tcm::resp_vc(this_head.vc.to_uint());
       //--- Build header ---
       temp_flit.type    = HEAD;
       temp_flit.vc      = this_vc;
@@ -278,7 +301,7 @@ SC_MODULE(axi_slave_if_vc) {
                           ((sc_uint<dnp::PHIT_W>)this_head.reord_tct         << dnp::rresp::REORD_PTR) |
                           ((sc_uint<dnp::PHIT_W>)this_head.tid               << dnp::rresp::ID_PTR) |
                           ((sc_uint<dnp::PHIT_W>)dnp::PACK_TYPE__RD_RESP  << dnp::T_PTR) |
-                          ((sc_uint<dnp::PHIT_W>)0                        << dnp::Q_PTR) |
+                          ((sc_uint<dnp::PHIT_W>)this_head.qos            << dnp::Q_PTR) |
                           ((sc_uint<dnp::PHIT_W>)this_head.src               << dnp::D_PTR) |
                           ((sc_uint<dnp::PHIT_W>)THIS_ID                     << dnp::S_PTR) ;
       temp_flit.data[1] = ((sc_uint<dnp::PHIT_W>)(this_head.addr_part) << dnp::rresp::AP_PTR) |
@@ -286,11 +309,12 @@ SC_MODULE(axi_slave_if_vc) {
                           ((sc_uint<dnp::PHIT_W>)this_head.size        << dnp::rresp::SZ_PTR) ;
       
       //#pragma hls_pipeline_init_interval 1
-      while (credits_avail[this_vc]==0) {
+      while (!crs::ready(credits_avail, this_vc)) {
         cr_t vc_upd;
-        if (rd_flit_cr_in.PopNB(vc_upd)) credits_avail[vc_upd]++;
+        if (rd_flit_cr_in.PopNB(vc_upd)) cr_return(credits_avail, vc_upd);
         wait();
       }
+      FLIT_TS_DO(temp_flit.ts = this_head.ts; temp_flit.ts.inject_rsp();)
       bool dbg_rresp_ok = rd_flit_data_out.PushNB(temp_flit); // Push Header flit to NoC
       NVHLS_ASSERT_MSG(dbg_rresp_ok, "R Resp data DROP!!!");
       credits_avail[this_vc]--;
@@ -317,7 +341,7 @@ SC_MODULE(axi_slave_if_vc) {
         // Calculate the bytes to transfer in this iteration,
         //   depending the available flit bytes and the remaining to fill the beat
         sc_uint<8> bytes_axi_left  = ((1<<final_size) - (axi_lane_ptr & ((1<<final_size)-1)));
-        sc_uint<8> bytes_flit_left = ((cfg::RRESP_PHITS<<1) - (flit_phit_ptr<<1));
+        sc_uint<8> bytes_flit_left = ((cfg::RRESP_PHITS<<dnp::BPP_W) - (flit_phit_ptr<<dnp::BPP_W));
         sc_uint<8> bytes_per_iter  = (bytes_axi_left<bytes_flit_left) ? bytes_axi_left : bytes_flit_left;
   
         // When the axi lane pointer wraps a size get the next beat
@@ -332,18 +356,21 @@ SC_MODULE(axi_slave_if_vc) {
         // Convert AXI Beats to flits.
         #pragma hls_unroll yes
         for (int i=0; i<cfg::RRESP_PHITS; ++i) { // i counts phits on the flit
-          if(i>=flit_phit_ptr && i<(flit_phit_ptr+(bytes_per_iter>>1))) {
-            sc_uint<8> loc_axi_ptr = (axi_lane_ptr + ((i-flit_phit_ptr)<<1));
-            temp_flit.data[i] = ((sc_uint<dnp::PHIT_W>)resp_tmp                      << dnp::rdata::RE_PTR) | // MSB
-                                ((sc_uint<dnp::PHIT_W>)last_tmp                      << dnp::rdata::LA_PTR) |
-                                ((sc_uint<dnp::PHIT_W>)data_build_tmp[loc_axi_ptr+1] << dnp::rdata::B1_PTR) | // (i*2) % 4
-                                ((sc_uint<dnp::PHIT_W>)data_build_tmp[loc_axi_ptr  ] << dnp::rdata::B0_PTR) ; // LSB
+          if(i>=flit_phit_ptr && i<(flit_phit_ptr+(bytes_per_iter>>dnp::BPP_W))) {
+            sc_uint<8> loc_axi_ptr = (axi_lane_ptr + ((i-flit_phit_ptr)<<dnp::BPP_W));
+            sc_uint<dnp::PHIT_W> phit = ((sc_uint<dnp::PHIT_W>)resp_tmp << dnp::rdata::RE_PTR) | // MSB
+                                        ((sc_uint<dnp::PHIT_W>)last_tmp << dnp::rdata::LA_PTR) ;
+            #pragma hls_unroll yes
+            for (int b=0; b<dnp::BPP; ++b) {
+              phit |= ((sc_uint<dnp::PHIT_W>)data_build_tmp[loc_axi_ptr+b] << (dnp::rdata::B0_PTR+b*dnp::B_W));
+            }
+            temp_flit.data[i] = phit;
           }
         }
         
         // transaction event flags 
         bool done_job  = ((bytes_packed+bytes_per_iter)==bytes_total);             // All bytes are processed
-        bool done_flit = (flit_phit_ptr+(bytes_per_iter>>1)==cfg::RRESP_PHITS);    // Flit got empty
+        bool done_flit = (flit_phit_ptr+(bytes_per_iter>>dnp::BPP_W)==cfg::RRESP_PHITS);    // Flit got empty
         bool done_axi  = (((bytes_packed+bytes_per_iter)&((1<<final_size)-1))==0); // Beat got full
         
         // Push the flit to NoC when either this Flit got the needed bytes or all bytes are transferred
@@ -351,9 +378,9 @@ SC_MODULE(axi_slave_if_vc) {
           temp_flit.type = (done_job) ? TAIL : BODY;
           temp_flit.vc   =  this_vc;
           //#pragma hls_pipeline_init_interval 1
-          while (credits_avail[this_vc]==0) {
+          while (!crs::ready(credits_avail, this_vc)) {
             cr_t vc_upd;
-            if (rd_flit_cr_in.PopNB(vc_upd)) credits_avail[vc_upd]++;
+            if (rd_flit_cr_in.PopNB(vc_upd)) cr_return(credits_avail, vc_upd);
             wait();
           }
           bool dbg_rresp_ok = rd_flit_data_out.PushNB(temp_flit); // Push Header flit to NoC
@@ -370,7 +397,7 @@ SC_MODULE(axi_slave_if_vc) {
         } else {
           // Move to next iteration
           bytes_packed  += bytes_per_iter;
-          flit_phit_ptr = (done_flit) ? 0 : (flit_phit_ptr +(bytes_per_iter>>1));
+          flit_phit_ptr = (done_flit) ? 0 : (flit_phit_ptr +(bytes_per_iter>>dnp::BPP_W));
           axi_lane_ptr  = (this_head.burst==enc_::AXBURST::FIXED) ? ((axi_lane_ptr+bytes_per_iter) & ((1<<final_size)-1)) + addr_init_aligned :
                                                                     ((axi_lane_ptr+bytes_per_iter) & (cfg::RD_LANES-1)) ;
         }
@@ -393,8 +420,8 @@ SC_MODULE(axi_slave_if_vc) {
     while(1) {
       wreq_flit_t   flit_rcv;
       if (wr_flit_data_in.PopNB(flit_rcv)) {
-        cr_t flit_rcv_vc = flit_rcv.get_vc();
-        bool dbg_wreq_cr_ok = wr_flit_cr_out.PushNB(flit_rcv_vc);
+        cr_t flit_rcv_cr = crs::single(flit_rcv.get_vc());
+        bool dbg_wreq_cr_ok = wr_flit_cr_out.PushNB(flit_rcv_cr);
         NVHLS_ASSERT_MSG(dbg_wreq_cr_ok, "W Req credit DROP!!!");
         
         sc_uint<dnp::ID_W> orig_tid = (flit_rcv.data[0] >> dnp::req::ID_PTR) & ((1<<dnp::ID_W)-1);
@@ -427,6 +454,7 @@ SC_MODULE(axi_slave_if_vc) {
         this_req.len   = final_len.to_uint();
         this_req.size  = final_size.to_uint();
         this_req.burst = (flit_rcv.data[2] >> dnp::req::BU_PTR)  & ((1<<dnp::BU_W)-1);
+        this_req.qos   = ((flit_rcv.data[0] >> dnp::Q_PTR) & ((1<<dnp::Q_W)-1)) << 1;
         this_req.addr  = ((((flit_rcv.data[2]>>dnp::req::AH_PTR) & ((1<<dnp::AH_W)-1)) << dnp::AL_W) |
                           ((flit_rcv.data[1]>>dnp::req::AL_PTR)  & ((1<<dnp::AL_W)-1)))
                          - slave_base_addr.read();
@@ -437,12 +465,15 @@ SC_MODULE(axi_slave_if_vc) {
         wr_trans_info_t this_info;
         this_info.tid       = orig_tid;
         this_info.src       = req_src;
+        this_info.qos       = (flit_rcv.data[0] >> dnp::Q_PTR) & ((1<<dnp::Q_W)-1);
+        this_info.vc        = flit_rcv.get_vc();
         this_info.reord_tct = (flit_rcv.data[0] >> dnp::req::REORD_PTR)  & ((1<<dnp::REORD_W)-1);
         
         // update bookkeeping vars
         wr_in_flight++;
         outst_tid = orig_tid;
         // Push info to Resp-pack and request to Slave
+        FLIT_TS_DO(flit_rcv.ts.eject_req(); this_info.ts = flit_rcv.ts;)
         wr_trans_init.write(this_info);
         aw_out.Push(this_req);
         
@@ -457,7 +488,9 @@ SC_MODULE(axi_slave_if_vc) {
         // Gather DATA
         sc_uint<8>        addr_init_aligned  = (this_req.addr.to_uint() & (cfg::WR_LANES-1)) & ~((1<<final_size)-1);
         sc_uint<8>        axi_lane_ptr       = addr_init_aligned;
-        cnt_phit_wreq_t   flit_phit_ptr      = 0;
+        // A short write (SINGLE) carries its data past the header, the data flit is the header flit
+        bool              short_wr           = dnp::SHORT_WR && (flit_rcv.type==SINGLE);
+        cnt_phit_wreq_t   flit_phit_ptr      = short_wr ? dnp::req::WDATA_PHIT : 0;
     
         sc_uint<16> bytes_total    = ((this_req.len.to_uint()+1)<<this_req.size.to_uint());
         sc_uint<16> bytes_depacked = 0;
@@ -468,7 +501,7 @@ SC_MODULE(axi_slave_if_vc) {
         gather_wr_flits : while (1) {
           // Calculate the bytes transferred in this iteration, depending the available flit bytes and the remaining to the beat
           sc_uint<8> bytes_axi_left  = ((1<<this_req.size.to_uint()) - (axi_lane_ptr & ((1<<this_req.size.to_uint())-1)));
-          sc_uint<8> bytes_flit_left = ((cfg::WREQ_PHITS<<1)              - (flit_phit_ptr<<1));
+          sc_uint<8> bytes_flit_left = ((cfg::WREQ_PHITS<<dnp::BPP_W)              - (flit_phit_ptr<<dnp::BPP_W));
           sc_uint<8> bytes_per_iter  = (bytes_axi_left<bytes_flit_left) ? bytes_axi_left : bytes_flit_left;
   
           // When the phit pointer resets get the flit
@@ -484,27 +517,27 @@ SC_MODULE(axi_slave_if_vc) {
               wait();
             }
   
-            cr_t flit_rcv_vc = flit_rcv.get_vc();
-            bool dbg_wreq_cr_ok = wr_flit_cr_out.PushNB(flit_rcv_vc);
+            cr_t flit_rcv_cr = crs::single(flit_rcv.get_vc());
+            bool dbg_wreq_cr_ok = wr_flit_cr_out.PushNB(flit_rcv_cr);
             NVHLS_ASSERT_MSG(dbg_wreq_cr_ok, "W Req credit DROP!!!");
           }
   
           // Convert AXI Beats to flits.
           #pragma hls_unroll yes
-          build_resp: for (unsigned int i=0; i<(cfg::WR_LANES>>1); ++i){ // i counts PHITS
-            if(i>=(axi_lane_ptr>>1) && i<((axi_lane_ptr+bytes_per_iter)>>1)) {
-              sc_uint<8> loc_flit_ptr = flit_phit_ptr + (i-(axi_lane_ptr>>1));
-              data_build_tmp[(i<<1)+1] = (flit_rcv.data[loc_flit_ptr] >> dnp::wdata::B1_PTR) & ((1<<dnp::B_W)-1); // MSB
-              data_build_tmp[(i<<1)  ] = (flit_rcv.data[loc_flit_ptr] >> dnp::wdata::B0_PTR) & ((1<<dnp::B_W)-1); // LSB
-        
-              wstr_build_tmp[(i<<1)+1] = (flit_rcv.data[loc_flit_ptr] >> dnp::wdata::E1_PTR) & ((1<<dnp::E_W)-1); // MSB
-              wstr_build_tmp[(i<<1)  ] = (flit_rcv.data[loc_flit_ptr] >> dnp::wdata::E0_PTR) & ((1<<dnp::E_W)-1); // LSB
+          build_resp: for (unsigned int i=0; i<(cfg::WR_LANES>>dnp::BPP_W); ++i){ // i counts PHITS
+            if(i>=(axi_lane_ptr>>dnp::BPP_W) && i<((axi_lane_ptr+bytes_per_iter)>>dnp::BPP_W)) {
+              sc_uint<8> loc_flit_ptr = flit_phit_ptr + (i-(axi_lane_ptr>>dnp::BPP_W));
+              #pragma hls_unroll yes
+              for (int b=0; b<dnp::BPP; ++b) {
+                data_build_tmp[(i<<dnp::BPP_W)+b] = (flit_rcv.data[loc_flit_ptr] >> (dnp::wdata::B0_PTR+b*dnp::B_W)) & ((1<<dnp::B_W)-1);
+                wstr_build_tmp[(i<<dnp::BPP_W)+b] = (flit_rcv.data[loc_flit_ptr] >> (dnp::wdata::E0_PTR+b*dnp::E_W)) & ((1<<dnp::E_W)-1);
+              }
             }
           }
   
           // transaction event flags
           bool done_job  = ((bytes_depacked+bytes_per_iter)==bytes_total);             // All bytes are processed
-          bool done_flit = (flit_phit_ptr+(bytes_per_iter>>1)==cfg::WREQ_PHITS);       // Flit got empty
+          bool done_flit = (flit_phit_ptr+(bytes_per_iter>>dnp::BPP_W)==cfg::WREQ_PHITS);       // Flit got empty
           bool done_axi  = (((bytes_depacked+bytes_per_iter)&((1<<final_size)-1))==0); // Beat got full
   
           // Push the beat to slave when either this Beat got the needed bytes or all bytes are transferred
@@ -526,7 +559,7 @@ SC_MODULE(axi_slave_if_vc) {
             break;
           } else {                                      // Still Building ...
             bytes_depacked +=bytes_per_iter;
-            flit_phit_ptr = (done_flit) ? 0 : (flit_phit_ptr +(bytes_per_iter>>1));
+            flit_phit_ptr = (done_flit) ? 0 : (flit_phit_ptr +(bytes_per_iter>>dnp::BPP_W));
             axi_lane_ptr   = ((unsigned)this_req.burst==enc_::AXBURST::FIXED) ? ((axi_lane_ptr+bytes_per_iter) & ((1<<this_req.size.to_uint())-1)) + addr_init_aligned :
                                                                       ((axi_lane_ptr+bytes_per_iter) & (cfg::WR_LANES-1)) ;
           }
@@ -552,9 +585,9 @@ SC_MODULE(axi_slave_if_vc) {
     wr_flit_cr_in.Reset();
     b_in.Reset();
     
-    sc_uint<3> wr_credits_avail[cfg::VCS];
+    cr_cnt_t   wr_credits_avail[cfg::VCS];
     for (int i=0; i<cfg::VCS; ++i) {
-      wr_credits_avail[i] = 3;
+      wr_credits_avail[i] = cfg::BUFF_DEPTH;
     }
     
     //#pragma hls_pipeline_init_interval 1
@@ -565,7 +598,7 @@ SC_MODULE(axi_slave_if_vc) {
       wr_trans_info_t     this_head = wr_trans_init.read();
       axi4_::WRespPayload this_resp = b_in.Pop();
       
-      sc_uint<cfg::VCS> this_vc = 1;
+      sc_uint<dnp::V_W> this_vc = tcm::resp_vc(this_head.vc.to_uint());
       
       temp_flit.type = SINGLE;
       temp_flit.vc   = this_vc;
@@ -574,15 +607,16 @@ SC_MODULE(axi_slave_if_vc) {
                           ((sc_uint<dnp::PHIT_W>)this_head.reord_tct        << dnp::wresp::REORD_PTR )   |
                           ((sc_uint<dnp::PHIT_W>)this_head.tid              << dnp::wresp::ID_PTR )   |
                           ((sc_uint<dnp::PHIT_W>)dnp::PACK_TYPE__WR_RESP << dnp::T_PTR ) |
-                          ((sc_uint<dnp::PHIT_W>)0                       << dnp::Q_PTR ) |
+                          ((sc_uint<dnp::PHIT_W>)this_head.qos           << dnp::Q_PTR ) |
                           ((sc_uint<dnp::PHIT_W>)this_head.src              << dnp::D_PTR ) |
                           ((sc_uint<dnp::PHIT_W>)THIS_ID                    << dnp::S_PTR ) ;
   
-      while (wr_credits_avail[this_vc]==0) {
+      while (!crs::ready(wr_credits_avail, this_vc)) {
         cr_t vc_upd;
-        if (wr_flit_cr_in.PopNB(vc_upd)) wr_credits_avail[vc_upd]++;
+        if (wr_flit_cr_in.PopNB(vc_upd)) cr_return(wr_credits_avail, vc_upd);
         wait();
       }
+      FLIT_TS_DO(temp_flit.ts = this_head.ts; temp_flit.ts.inject_rsp();)
       bool dbg_wresp_ok = wr_flit_data_out.PushNB(temp_flit);
       NVHLS_ASSERT_MSG(dbg_wresp_ok, "W Resp pack DROP!!!");
       wr_credits_avail[this_vc]--;
@@ -591,7 +625,12 @@ SC_MODULE(axi_slave_if_vc) {
     } // End of While(1)
   }; // End of Write Resp Packetizer
   
-
+  // Credits returned by the router, of a single VC or coalesced
+  inline void cr_return(cr_cnt_t credits[cfg::VCS], const cr_t &msg) {
+    #pragma hls_unroll yes
+    for (int v=0; v<cfg::VCS; ++v) credits[v] += crs::count(msg, v);
+  };
+  
 }; // End of Slave-IF module
 
 #endif // AXI4_SLAVE_IF_CON_H
@@ -0,0 +1,109 @@
+#ifndef CDC_LINK_CON_H
+#define CDC_LINK_CON_H
+
+#include "systemc.h"
+
+#include "nvhls_connections.h"
+
+// Asynchronous Clock Domain Crossing of a flit channel, eg between the IFs on the IP clock and a faster NoC.
+//   A DEPTH entries FIFO, written on clk_wr and read on clk_rd. Each side owns a binary pointer and passes
+//   its Gray coded copy to the other through a 2 flop synchronizer. Thus a single bit changes per increment
+//   and a pointer sampled mid-change is the old or the new value, never a third, at worst a cycle stale.
+//   Full and empty are conservative, a slot freed or filled in one domain is seen 2-3 cycles later in the other.
+//   The link drops in any Connections channel, as it applies the same valid/ready handshake at both ends.
+// T         : The flit (or credit) type of the channel
+// DEPTH     : FIFO entries, a power of 2. The round trip of the synchronizers is ~6 cycles, DEPTH 8 sustains
+//             a flit per cycle of the slower clock.
+//             On credit based links (the VC networks) a link carries the flits and another the credits. The senders
+//             push non-blocking as they hold the credits, thus DEPTH must cover the credits of the link,
+//             ie VCS*BUFF_DEPTH, for the crossing to never back-pressure.
+template<class T, unsigned DEPTH=8>
+SC_MODULE(cdc_link) {
+  static const unsigned AW = nvhls::log2_ceil<DEPTH>::val; // Entry address
+  static const unsigned PW = AW+1;                          // Pointers wrap twice the entries, to tell full from empty
+  typedef sc_uint<PW> ptr_t;
+
+  sc_in_clk    clk_wr{"clk_wr"};
+  sc_in <bool> rst_n_wr{"rst_n_wr"};
+  sc_in_clk    clk_rd{"clk_rd"};
+  sc_in <bool> rst_n_rd{"rst_n_rd"};
+
+  Connections::In <T> data_in;  // On clk_wr
+  Connections::Out<T> data_out; // On clk_rd
+
+  // The only state crossing the domains. An entry is read only once its write pointer has gone through
+  // the synchronizer, thus it is stable when sampled.
+  sc_signal<T>     mem[DEPTH];
+  sc_signal<ptr_t> wr_gray;
+  sc_signal<ptr_t> rd_gray;
+
+  SC_HAS_PROCESS(cdc_link);
+  cdc_link(sc_module_name name_="cdc_link")
+    : sc_module(name_)
+  {
+    NVHLS_ASSERT_MSG((DEPTH>=2) && ((DEPTH & (DEPTH-1))==0), "CDC link DEPTH must be a power of 2");
+
+    SC_THREAD(wr_job);
+    sensitive << clk_wr.pos();
+    async_reset_signal_is(rst_n_wr, false);
+
+    SC_THREAD(rd_job);
+    sensitive << clk_rd.pos();
+    async_reset_signal_is(rst_n_rd, false);
+  }
+
+  static inline ptr_t bin2gray(const ptr_t &bin) {return bin ^ (bin>>1);};
+
+  // Write domain
+  void wr_job () {
+    data_in.Reset();
+    ptr_t wr_bin = 0;
+    ptr_t rd_sync[2] = {0, 0};
+    wr_gray.write(0);
+
+    #pragma hls_pipeline_init_interval 1
+    #pragma pipeline_stall_mode flush
+    while(1) {
+      wait();
+      // Full when the pointers differ only at the two upper bits of their Gray code
+      ptr_t full_gray = rd_sync[1] ^ (((ptr_t)3) << (PW-2));
+      bool  full      = (bin2gray(wr_bin) == full_gray);
+
+      T flit_in;
+      if (!full && data_in.PopNB(flit_in)) {
+        mem[wr_bin.range(AW-1, 0).to_uint()].write(flit_in);
+        wr_bin++;
+      }
+      wr_gray.write(bin2gray(wr_bin));
+
+      rd_sync[1] = rd_sync[0];
+      rd_sync[0] = rd_gray.read();
+    }
+  };
+
+  // Read domain
+  void rd_job () {
+    data_out.Reset();
+    ptr_t rd_bin = 0;
+    ptr_t wr_sync[2] = {0, 0};
+    rd_gray.write(0);
+
+    #pragma hls_pipeline_init_interval 1
+    #pragma pipeline_stall_mode flush
+    while(1) {
+      wait();
+      bool empty = (bin2gray(rd_bin) == wr_sync[1]);
+
+      if (!empty) {
+        T flit_out = mem[rd_bin.range(AW-1, 0).to_uint()].read();
+        if (data_out.PushNB(flit_out)) rd_bin++;
+      }
+      rd_gray.write(bin2gray(rd_bin));
+
+      wr_sync[1] = wr_sync[0];
+      wr_sync[0] = wr_gray.read();
+    }
+  };
+}; // End of SC_MODULE
+
+#endif // CDC_LINK_CON_H
@@ -0,0 +1,499 @@
+// --------------------------------------------------------- //
+//   Loosely-Timed model of the AXI 2-D mesh interconnect    //
+//                                                           //
+// Aka. Master <-> [ Analytic NoC ] <-> Slave                //
+// --------------------------------------------------------- //
+
+#ifndef AXI4_IC_TLM_H
+#define AXI4_IC_TLM_H
+
+#include "systemc.h"
+#include "nvhls_connections.h"
+
+#include <axi/axi4.h>
+
+#include "./include/axi4_configs_extra.h"
+#include "./include/dnp20_axi.h"
+#include "./include/addr_dec.h"
+
+#include <deque>
+#include <vector>
+#include <algorithm>
+
+// --- Loosely-Timed Interconnect --- //
+// Functionally equivalent, fast model of the ic_top of the AXI 2-D mesh examples. Simulation only.
+// It exposes the same AXI ports and is built from the same cfg bundle, thus it drops in the tb harness.
+// Instead of clocked routers, each packet is timed analytically when it enters the NoC :
+//   - Latency   : IF_CYCLES at each interface plus ROUTER_CYCLES per hop, along the XY route
+//   - Serialization : each packet occupies every output port it traverses for its length in flits
+//   - Contention    : first come first served reservation of each router output port
+// Requests and responses travel in separate networks, as in ic_top. The nodes are placed as in ic_top,
+// Slaves at nodes 0..SLAVE_NUM-1 and Masters after them, with node n at (n % DIM_X, n / DIM_X).
+// The AXI ordering rules of the HLS interfaces are kept (cfg::ORD_SCHEME at the Masters, up to cfg::SLV_OUTS
+// outstanding at the Slaves, completed in order per ID), with REORD modeling the reordering Master interfaces.
+// The idle threads sleep on events, thus the simulation cost scales with the transactions, not the cycles.
+// Widths must match at both ends, the model does not resize transactions.
+// cfg           : The interconnect's configuration bundle
+// DIM_X, DIM_Y  : Dimensions of the mesh
+// REORD         : Masters reorder responses, thus same-ID transactions may target different Slaves
+// ROUTER_CYCLES : Head latency of a router. To be calibrated against the HLS model
+// IF_CYCLES     : Packetization/Depacketization latency at each interface
+template <typename cfg, unsigned DIM_X, unsigned DIM_Y, bool REORD=false, unsigned ROUTER_CYCLES=3, unsigned IF_CYCLES=3>
+SC_MODULE(ic_tlm) {
+public:
+  typedef typename axi::axi4<axi::cfg::standard_duth> axi4_;
+  typedef unsigned long long cycle_t;
+
+  static const unsigned NODES   = DIM_X*DIM_Y;
+  static const unsigned IDS     = (1<<dnp::ID_W);
+  static const unsigned SLV_MAX_OUTS = cfg::SLV_OUTS; // Same as the Slave IF
+
+  enum { NET_REQ = 0, NET_RESP = 1 };
+  // Router output ports, as wired in ic_top
+  enum { PORT_XM = 0, PORT_XP = 1, PORT_YM = 2, PORT_YP = 3, PORT_EJ_RD = 4, PORT_EJ_WR = 5, PORTS = 6 };
+
+  sc_in_clk    clk;
+  sc_in <bool> rst_n;
+
+  // IC's Address map
+  sc_in<sc_uint <32> >  addr_map[cfg::SLAVE_NUM][2]; // [SLAVE_NUM][0:begin, 1: End]
+
+  // MASTER Side AXI Channels
+  Connections::In<typename axi4_::AddrPayload>   ar_in[cfg::MASTER_NUM];
+  Connections::Out<typename axi4_::ReadPayload>  r_out[cfg::MASTER_NUM];
+
+  Connections::In<typename axi4_::AddrPayload>   aw_in[cfg::MASTER_NUM];
+  Connections::In<typename axi4_::WritePayload>  w_in[cfg::MASTER_NUM];
+  Connections::Out<typename axi4_::WRespPayload> b_out[cfg::MASTER_NUM];
+
+  // SLAVE Side AXI Channels
+  Connections::Out<typename axi4_::AddrPayload>  ar_out[cfg::SLAVE_NUM];
+  Connections::In<typename axi4_::ReadPayload>   r_in[cfg::SLAVE_NUM];
+
+  Connections::Out<typename axi4_::AddrPayload>  aw_out[cfg::SLAVE_NUM];
+  Connections::Out<typename axi4_::WritePayload> w_out[cfg::SLAVE_NUM];
+  Connections::In<typename axi4_::WRespPayload>  b_in[cfg::SLAVE_NUM];
+
+  //--- Internals ---//
+  // A packet in flight, timed at the arrival of its head at the destination interface
+  struct req_pck {
+    typename axi4_::AddrPayload               req;
+    std::vector<typename axi4_::WritePayload> data;
+    unsigned char src;
+    unsigned      ticket;
+    cycle_t       arrival;
+  };
+
+  struct rresp_pck {
+    std::vector<typename axi4_::ReadPayload> data;
+    unsigned      ticket;
+    cycle_t       arrival;
+  };
+
+  struct wresp_pck {
+    typename axi4_::WRespPayload resp;
+    unsigned      ticket;
+    cycle_t       arrival;
+  };
+
+  // Transactions currently served by a Slave
+  struct slv_trans {
+    unsigned      tid;
+    unsigned char src;
+    unsigned      size;
+    unsigned      ticket;
+  };
+
+  // Busy until cycle, for each router output port of the two networks
+  cycle_t link_free[2][NODES][PORTS];
+
+  // Master side ordering. Outstanding per ID (and in total for ORD_SCHEME 0) and the delivery tickets
+  unsigned rd_sent[cfg::MASTER_NUM][IDS], rd_dst_last[cfg::MASTER_NUM][IDS];
+  unsigned wr_sent[cfg::MASTER_NUM][IDS], wr_dst_last[cfg::MASTER_NUM][IDS];
+  unsigned rd_sent_all[cfg::MASTER_NUM],  rd_dst_all[cfg::MASTER_NUM];
+  unsigned wr_sent_all[cfg::MASTER_NUM],  wr_dst_all[cfg::MASTER_NUM];
+  unsigned rd_tct_issue[cfg::MASTER_NUM][IDS], rd_tct_deliver[cfg::MASTER_NUM][IDS];
+  unsigned wr_tct_issue[cfg::MASTER_NUM][IDS], wr_tct_deliver[cfg::MASTER_NUM][IDS];
+
+  std::deque<req_pck>    slv_rd_pend[cfg::SLAVE_NUM];
+  std::deque<req_pck>    slv_wr_pend[cfg::SLAVE_NUM];
+  std::deque<slv_trans>  slv_rd_infl[cfg::SLAVE_NUM];
+  std::deque<slv_trans>  slv_wr_infl[cfg::SLAVE_NUM];
+  std::deque<rresp_pck>  mst_rd_pend[cfg::MASTER_NUM];
+  std::deque<wresp_pck>  mst_wr_pend[cfg::MASTER_NUM];
+
+  sc_event ev_slv_rd_new[cfg::SLAVE_NUM],  ev_slv_wr_new[cfg::SLAVE_NUM];
+  sc_event ev_slv_rd_fin[cfg::SLAVE_NUM],  ev_slv_wr_fin[cfg::SLAVE_NUM];
+  sc_event ev_mst_rd_new[cfg::MASTER_NUM], ev_mst_wr_new[cfg::MASTER_NUM];
+  sc_event ev_mst_rd_fin[cfg::MASTER_NUM], ev_mst_wr_fin[cfg::MASTER_NUM];
+
+  sc_time clk_period;
+
+  // Constructor
+  SC_HAS_PROCESS(ic_tlm);
+  ic_tlm(sc_module_name name_="ic_tlm")
+    :
+    sc_module (name_)
+  {
+    NVHLS_ASSERT_MSG((cfg::MASTER_NUM+cfg::SLAVE_NUM) <= NODES, "Nodes do not fit in the mesh.");
+
+    for (unsigned net=0; net<2; ++net)
+      for (unsigned n=0; n<NODES; ++n)
+        for (unsigned p=0; p<PORTS; ++p) link_free[net][n][p] = 0;
+
+    for (unsigned i=0; i<cfg::MASTER_NUM; ++i) {
+      rd_sent_all[i] = 0; rd_dst_all[i] = 0;
+      wr_sent_all[i] = 0; wr_dst_all[i] = 0;
+      for (unsigned t=0; t<IDS; ++t) {
+        rd_sent[i][t] = 0; rd_dst_last[i][t] = 0; rd_tct_issue[i][t] = 0; rd_tct_deliver[i][t] = 0;
+        wr_sent[i][t] = 0; wr_dst_last[i][t] = 0; wr_tct_issue[i][t] = 0; wr_tct_deliver[i][t] = 0;
+      }
+    }
+
+    // One thread per port. Clocked, as the Connections ports require
+    sc_spawn_options opts;
+    opts.set_sensitivity(&clk.pos());
+    opts.async_reset_signal_is(rst_n, false);
+    for (unsigned i=0; i<cfg::MASTER_NUM; ++i) {
+      sc_spawn(sc_bind(&ic_tlm::mst_rd_req_job,  this, i), sc_gen_unique_name("mst_rd_req"),  &opts);
+      sc_spawn(sc_bind(&ic_tlm::mst_wr_req_job,  this, i), sc_gen_unique_name("mst_wr_req"),  &opts);
+      sc_spawn(sc_bind(&ic_tlm::mst_rd_resp_job, this, i), sc_gen_unique_name("mst_rd_resp"), &opts);
+      sc_spawn(sc_bind(&ic_tlm::mst_wr_resp_job, this, i), sc_gen_unique_name("mst_wr_resp"), &opts);
+    }
+    for (unsigned j=0; j<cfg::SLAVE_NUM; ++j) {
+      sc_spawn(sc_bind(&ic_tlm::slv_rd_req_job,  this, j), sc_gen_unique_name("slv_rd_req"),  &opts);
+      sc_spawn(sc_bind(&ic_tlm::slv_wr_req_job,  this, j), sc_gen_unique_name("slv_wr_req"),  &opts);
+      sc_spawn(sc_bind(&ic_tlm::slv_rd_resp_job, this, j), sc_gen_unique_name("slv_rd_resp"), &opts);
+      sc_spawn(sc_bind(&ic_tlm::slv_wr_resp_job, this, j), sc_gen_unique_name("slv_wr_resp"), &opts);
+    }
+  }
+
+
+  //--------------------------//
+  //--- MASTER Side Ingress --//
+  //--------------------------//
+  void mst_rd_req_job(unsigned i) {
+    ar_in[i].Reset();
+    wait();
+    while(1) {
+      typename axi4_::AddrPayload this_req = ar_in[i].Pop();
+      cycle_t  t_inj = now();
+      unsigned tid   = this_req.id.to_uint();
+      unsigned dst   = addr_dec(this_req.addr.to_uint());
+
+      // Stall while the response order could break, as the Master IF does
+      while (!REORD && ( ((cfg::ORD_SCHEME==0) && (rd_sent_all[i]>0) && (rd_dst_all[i]!=dst)) ||
+                         ((cfg::ORD_SCHEME!=0) && (rd_sent[i][tid]>0) && (rd_dst_last[i][tid]!=dst)) )) {
+        wait(ev_mst_rd_fin[i]);
+        wait();
+        t_inj = now();
+      }
+      rd_sent[i][tid]++; rd_dst_last[i][tid] = dst;
+      rd_sent_all[i]++;  rd_dst_all[i]       = dst;
+
+      req_pck pck;
+      pck.req     = this_req;
+      pck.src     = i;
+      pck.ticket  = rd_tct_issue[i][tid]++;
+      pck.arrival = traverse(NET_REQ, cfg::SLAVE_NUM+i, dst, t_inj, 1, PORT_EJ_RD);
+
+      insert_by_arrival(slv_rd_pend[dst], pck);
+      ev_slv_rd_new[dst].notify(SC_ZERO_TIME);
+      wait();
+    }
+  };
+
+  void mst_wr_req_job(unsigned i) {
+    aw_in[i].Reset();
+    w_in[i].Reset();
+    wait();
+    while(1) {
+      req_pck pck;
+      pck.req = aw_in[i].Pop();
+      cycle_t  t_inj = now();
+      unsigned tid   = pck.req.id.to_uint();
+      unsigned dst   = addr_dec(pck.req.addr.to_uint());
+
+      // The packet leaves with its data, which stream behind the header
+      typename axi4_::WritePayload this_beat;
+      do {
+        this_beat = w_in[i].Pop();
+        pck.data.push_back(this_beat);
+      } while (!this_beat.last);
+
+      while (!REORD && ( ((cfg::ORD_SCHEME==0) && (wr_sent_all[i]>0) && (wr_dst_all[i]!=dst)) ||
+                         ((cfg::ORD_SCHEME!=0) && (wr_sent[i][tid]>0) && (wr_dst_last[i][tid]!=dst)) )) {
+        wait(ev_mst_wr_fin[i]);
+        wait();
+        t_inj = now();
+      }
+      wr_sent[i][tid]++; wr_dst_last[i][tid] = dst;
+      wr_sent_all[i]++;  wr_dst_all[i]       = dst;
+
+      unsigned bytes = (pck.req.len.to_uint()+1) << pck.req.size.to_uint();
+      pck.src     = i;
+      pck.ticket  = wr_tct_issue[i][tid]++;
+      bool short_wr = dnp::SHORT_WR && (cfg::WREQ_PHITS>dnp::req::WDATA_PHIT) && (pck.req.len==0) &&
+                      (bytes <= ((cfg::WREQ_PHITS-dnp::req::WDATA_PHIT)<<dnp::BPP_W)); // Single flit, as the Master IF
+      pck.arrival = traverse(NET_REQ, cfg::SLAVE_NUM+i, dst, t_inj, short_wr ? 1 : 1+data_flits(bytes, cfg::WREQ_PHITS), PORT_EJ_WR);
+
+      insert_by_arrival(slv_wr_pend[dst], pck);
+      ev_slv_wr_new[dst].notify(SC_ZERO_TIME);
+      wait();
+    }
+  };
+
+
+  //--------------------------//
+  //--- SLAVE Side Egress  ---//
+  //--------------------------//
+  void slv_rd_req_job(unsigned j) {
+    ar_out[j].Reset();
+    wait();
+    while(1) {
+      if (slv_rd_pend[j].empty()) {
+        wait(ev_slv_rd_new[j]);
+        wait();
+      } else if (slv_rd_pend[j].front().arrival > now()) {
+        wait((int)(slv_rd_pend[j].front().arrival - now()));
+      } else if (!slv_admits(slv_rd_infl[j], slv_rd_pend[j].front().req.id.to_uint())) {
+        wait(ev_slv_rd_fin[j]);
+        wait();
+      } else {
+        req_pck pck = slv_rd_pend[j].front();
+        slv_rd_pend[j].pop_front();
+
+        slv_trans this_trans = {pck.req.id.to_uint(), pck.src, pck.req.size.to_uint(), pck.ticket};
+        slv_rd_infl[j].push_back(this_trans);
+        ar_out[j].Push(pck.req);
+      }
+    }
+  };
+
+  void slv_wr_req_job(unsigned j) {
+    aw_out[j].Reset();
+    w_out[j].Reset();
+    wait();
+    while(1) {
+      if (slv_wr_pend[j].empty()) {
+        wait(ev_slv_wr_new[j]);
+        wait();
+      } else if (slv_wr_pend[j].front().arrival > now()) {
+        wait((int)(slv_wr_pend[j].front().arrival - now()));
+      } else if (!slv_admits(slv_wr_infl[j], slv_wr_pend[j].front().req.id.to_uint())) {
+        wait(ev_slv_wr_fin[j]);
+        wait();
+      } else {
+        req_pck pck = slv_wr_pend[j].front();
+        slv_wr_pend[j].pop_front();
+
+        slv_trans this_trans = {pck.req.id.to_uint(), pck.src, pck.req.size.to_uint(), pck.ticket};
+        slv_wr_infl[j].push_back(this_trans);
+        aw_out[j].Push(pck.req);
+        for (unsigned b=0; b<pck.data.size(); ++b) w_out[j].Push(pck.data[b]);
+      }
+    }
+  };
+
+
+  //--------------------------//
+  //--- SLAVE Side Ingress ---//
+  //--------------------------//
+  void slv_rd_resp_job(unsigned j) {
+    r_in[j].Reset();
+    wait();
+    while(1) {
+      rresp_pck pck;
+      typename axi4_::ReadPayload this_beat = r_in[j].Pop();
+      cycle_t t_inj = now();
+      pck.data.push_back(this_beat);
+      while (!this_beat.last) {
+        this_beat = r_in[j].Pop();
+        pck.data.push_back(this_beat);
+      }
+
+      slv_trans this_trans = slv_pop_trans(slv_rd_infl[j], pck.data[0].id.to_uint());
+      ev_slv_rd_fin[j].notify(SC_ZERO_TIME);
+
+      unsigned bytes = pck.data.size() << this_trans.size;
+      pck.ticket  = this_trans.ticket;
+      pck.arrival = traverse(NET_RESP, j, cfg::SLAVE_NUM+this_trans.src, t_inj, 1+data_flits(bytes, cfg::RRESP_PHITS), PORT_EJ_RD);
+
+      insert_by_arrival(mst_rd_pend[this_trans.src], pck);
+      ev_mst_rd_new[this_trans.src].notify(SC_ZERO_TIME);
+      wait();
+    }
+  };
+
+  void slv_wr_resp_job(unsigned j) {
+    b_in[j].Reset();
+    wait();
+    while(1) {
+      wresp_pck pck;
+      pck.resp = b_in[j].Pop();
+      cycle_t t_inj = now();
+
+      slv_trans this_trans = slv_pop_trans(slv_wr_infl[j], pck.resp.id.to_uint());
+      ev_slv_wr_fin[j].notify(SC_ZERO_TIME);
+
+      pck.ticket  = this_trans.ticket;
+      pck.arrival = traverse(NET_RESP, j, cfg::SLAVE_NUM+this_trans.src, t_inj, 1, PORT_EJ_WR);
+
+      insert_by_arrival(mst_wr_pend[this_trans.src], pck);
+      ev_mst_wr_new[this_trans.src].notify(SC_ZERO_TIME);
+      wait();
+    }
+  };
+
+
+  //--------------------------//
+  //--- MASTER Side Egress ---//
+  //--------------------------//
+  void mst_rd_resp_job(unsigned i) {
+    r_out[i].Reset();
+    wait();
+    while(1) {
+      // The earliest response that is next in its ID order
+      int     sel       = -1;
+      cycle_t sel_arriv = 0;
+      for (unsigned p=0; p<mst_rd_pend[i].size(); ++p) {
+        unsigned tid = mst_rd_pend[i][p].data[0].id.to_uint();
+        if ((mst_rd_pend[i][p].ticket == rd_tct_deliver[i][tid]) && ((sel<0) || (mst_rd_pend[i][p].arrival < sel_arriv))) {
+          sel       = p;
+          sel_arriv = mst_rd_pend[i][p].arrival;
+        }
+      }
+
+      if (sel<0) {
+        wait(ev_mst_rd_new[i]);
+        wait();
+      } else if (sel_arriv > now()) {
+        wait((int)(sel_arriv - now()));
+      } else {
+        rresp_pck pck = mst_rd_pend[i][sel];
+        mst_rd_pend[i].erase(mst_rd_pend[i].begin()+sel);
+
+        for (unsigned b=0; b<pck.data.size(); ++b) r_out[i].Push(pck.data[b]);
+
+        unsigned tid = pck.data[0].id.to_uint();
+        rd_tct_deliver[i][tid]++;
+        rd_sent[i][tid]--;
+        rd_sent_all[i]--;
+        ev_mst_rd_fin[i].notify(SC_ZERO_TIME);
+      }
+    }
+  };
+
+  void mst_wr_resp_job(unsigned i) {
+    b_out[i].Reset();
+    wait();
+    while(1) {
+      int     sel       = -1;
+      cycle_t sel_arriv = 0;
+      for (unsigned p=0; p<mst_wr_pend[i].size(); ++p) {
+        unsigned tid = mst_wr_pend[i][p].resp.id.to_uint();
+        if ((mst_wr_pend[i][p].ticket == wr_tct_deliver[i][tid]) && ((sel<0) || (mst_wr_pend[i][p].arrival < sel_arriv))) {
+          sel       = p;
+          sel_arriv = mst_wr_pend[i][p].arrival;
+        }
+      }
+
+      if (sel<0) {
+        wait(ev_mst_wr_new[i]);
+        wait();
+      } else if (sel_arriv > now()) {
+        wait((int)(sel_arriv - now()));
+      } else {
+        wresp_pck pck = mst_wr_pend[i][sel];
+        mst_wr_pend[i].erase(mst_wr_pend[i].begin()+sel);
+
+        b_out[i].Push(pck.resp);
+
+        unsigned tid = pck.resp.id.to_uint();
+        wr_tct_deliver[i][tid]++;
+        wr_sent[i][tid]--;
+        wr_sent_all[i]--;
+        ev_mst_wr_fin[i].notify(SC_ZERO_TIME);
+      }
+    }
+  };
+
+
+  //--------------------------//
+  //---  Analytic  Timing  ---//
+  //--------------------------//
+  // Times a packet along the XY route from node src to node dst, starting at cycle t_inj.
+  //   Reserves each output port for the packet's flits and returns the arrival of its head
+  cycle_t traverse(unsigned net, unsigned src, unsigned dst, cycle_t t_inj, unsigned flits, unsigned ej_port) {
+    unsigned x  = src % DIM_X, y  = src / DIM_X;
+    unsigned dx = dst % DIM_X, dy = dst / DIM_X;
+
+    cycle_t t = t_inj + IF_CYCLES;
+    while(1) {
+      unsigned port;
+      if      (dx < x) port = PORT_XM;
+      else if (dx > x) port = PORT_XP;
+      else if (dy < y) port = PORT_YM;
+      else if (dy > y) port = PORT_YP;
+      else             port = ej_port;
+
+      cycle_t &port_free = link_free[net][y*DIM_X+x][port];
+      t         = std::max(t+ROUTER_CYCLES, port_free);
+      port_free = t + flits;
+
+      if      (port==PORT_XM) x--;
+      else if (port==PORT_XP) x++;
+      else if (port==PORT_YM) y--;
+      else if (port==PORT_YP) y++;
+      else break;
+    }
+
+    return t + IF_CYCLES;
+  };
+
+  // Data flits of a packet, at dnp::BPP bytes per phit
+  inline unsigned data_flits(unsigned bytes, unsigned phits) {
+    return (bytes + (phits<<dnp::BPP_W) - 1) / (phits<<dnp::BPP_W);
+  };
+
+  // Same rule as the Slave IF. Up to SLV_MAX_OUTS transactions of any ID may be in flight
+  inline bool slv_admits(const std::deque<slv_trans>& infl, unsigned tid) {
+    return (infl.size()<SLV_MAX_OUTS);
+  };
+
+  // A response completes the oldest in flight transaction of its ID
+  inline slv_trans slv_pop_trans(std::deque<slv_trans>& infl, unsigned tid) {
+    for (typename std::deque<slv_trans>::iterator it=infl.begin(); it!=infl.end(); ++it) {
+      if (it->tid==tid) {
+        slv_trans this_trans = *it;
+        infl.erase(it);
+        return this_trans;
+      }
+    }
+    NVHLS_ASSERT_MSG(false, "Response without request.");
+    slv_trans none = {0, 0, 0, 0};
+    return none;
+  };
+
+  inline unsigned addr_dec(unsigned addr) {
+    bool hit;
+    unsigned sel = addr_decoder<cfg::SLAVE_NUM>::decode(addr, addr_map, hit);
+    NVHLS_ASSERT_MSG(hit || addr_decoder<cfg::SLAVE_NUM>::HAS_DEF, "Address does not map to any Slave.");
+    return sel;
+  };
+
+  template<class T>
+  inline void insert_by_arrival(std::deque<T>& q, const T& pck) {
+    typename std::deque<T>::iterator it = q.end();
+    while ((it != q.begin()) && ((it-1)->arrival > pck.arrival)) --it;
+    q.insert(it, pck);
+  };
+
+  inline cycle_t now() { return sc_time_stamp() / clk_period; };
+
+  void start_of_simulation() {
+    clk_period = (dynamic_cast<sc_clock *>(clk.get_interface()))->period();
+  };
+}; // End of SC_MODULE
+
+#endif // AXI4_IC_TLM_H
@@ -0,0 +1,284 @@
+#ifndef AXI4_TOP_IC_MESH_H
+#define AXI4_TOP_IC_MESH_H
+
+#pragma once
+
+// The Master IF of the ordering scheme of the includer. axi_master_if_reord.h when included
+// before this header, otherwise the in-order axi_master_if.h (they share the include guard)
+#include "./axi_master_if.h"
+#include "./axi_slave_if.h"
+
+#include "./router_wh.h"
+
+#include "systemc.h"
+#include "nvhls_connections.h"
+
+// Parametric DIM_X x DIM_Y 2-D mesh AXI interconnect, with separate Request and Response networks.
+//   Generalizes the hand-written 2x2 examples. Every router has a single node, attached to its
+//   local RD (4) and WR (5) ports. Node n sits at router (n % DIM_X, n / DIM_X), the Slaves take
+//   nodes 0..SLAVE_NUM-1 and the Masters the next ones. Routers left without a node keep their
+//   local channels unconnected, as the mesh edges do. Routing is XY thus no route LUT is needed.
+// DIM_X, DIM_Y : Mesh dimensions. DIM_X*DIM_Y must fit the node ID fields, ie build with
+//                -DDNP_NODE_W=6 for 8x8 (see dnp20_axi.h)
+// cfg          : The configuration bundle of the examples. RD and WR requests (and responses)
+//                share a network, thus RREQ_PHITS==WREQ_PHITS and RRESP_PHITS==WRESP_PHITS
+// ARB_TYPE     : The arbiter of the routers
+template <unsigned DIM_X_, unsigned DIM_Y_, typename cfg, arb_type ARB_TYPE=MATRIX>
+SC_MODULE(ic_top_mesh) {
+public:
+  // typedef matchlib's axi with the "standard" configuration
+  typedef typename axi::axi4<axi::cfg::standard_duth> axi4_;
+
+  // typedef the 4 kind of flits(RD/WR Req/Resp) depending their size
+  typedef flit_dnp<cfg::RREQ_PHITS>  rreq_flit_t;
+  typedef flit_dnp<cfg::RRESP_PHITS> rresp_flit_t;
+  typedef flit_dnp<cfg::WREQ_PHITS>  wreq_flit_t;
+  typedef flit_dnp<cfg::WRESP_PHITS> wresp_flit_t;
+
+  static const unsigned DIM_X = DIM_X_;
+  static const unsigned DIM_Y = DIM_Y_;
+  static const unsigned NODES = DIM_X*DIM_Y;
+
+  typedef router_wh_top< 4+2, 4+2, rreq_flit_t,  5, DIM_X, 1, arbiter<4+2, ARB_TYPE> >  rtr_req_t;
+  typedef router_wh_top< 4+2, 4+2, rresp_flit_t, 5, DIM_X, 1, arbiter<4+2, ARB_TYPE> >  rtr_resp_t;
+
+  sc_in_clk    clk;
+  sc_in <bool> rst_n;
+
+  // IC's Address map
+  sc_in<sc_uint <32> >           addr_map[cfg::SLAVE_NUM][2]; // [SLAVE_NUM][0:begin, 1: End]
+
+  sc_signal< sc_uint<dnp::D_W> >  route_lut[1]; // Not-Used by XY routing
+
+  // The Node IDs are passed to IFs as signals
+  sc_signal< sc_uint<dnp::S_W> > NODE_IDS_MASTER[cfg::MASTER_NUM];
+  sc_signal< sc_uint<dnp::S_W> > NODE_IDS_SLAVE[cfg::SLAVE_NUM];
+
+  sc_signal< sc_uint<dnp::D_W> > rtr_id_x[DIM_X];
+  sc_signal< sc_uint<dnp::D_W> > rtr_id_y[DIM_Y];
+
+  // MASTER Side AXI Channels
+  Connections::In<typename axi4_::AddrPayload>   ar_in[cfg::MASTER_NUM];
+  Connections::Out<typename axi4_::ReadPayload>  r_out[cfg::MASTER_NUM];
+
+  Connections::In<typename axi4_::AddrPayload>   aw_in[cfg::MASTER_NUM];
+  Connections::In<typename axi4_::WritePayload>  w_in[cfg::MASTER_NUM];
+  Connections::Out<typename axi4_::WRespPayload> b_out[cfg::MASTER_NUM];
+
+  // SLAVE Side AXI Channels
+  Connections::Out<typename axi4_::AddrPayload>  ar_out[cfg::SLAVE_NUM];
+  Connections::In<typename axi4_::ReadPayload>   r_in[cfg::SLAVE_NUM];
+
+  Connections::Out<typename axi4_::AddrPayload>  aw_out[cfg::SLAVE_NUM];
+  Connections::Out<typename axi4_::WritePayload> w_out[cfg::SLAVE_NUM];
+  Connections::In<typename axi4_::WRespPayload>  b_in[cfg::SLAVE_NUM];
+
+  //--- Internals ---//
+  // --- Master/Slave IFs ---
+  axi_master_if < cfg > *master_if[cfg::MASTER_NUM];
+  axi_slave_if  < cfg > *slave_if[cfg::SLAVE_NUM];
+
+  // --- NoC Channels ---
+  // REQ Routers + In/Out Channels
+  rtr_req_t  *rtr_req[DIM_X][DIM_Y];
+
+  Connections::Combinational<rreq_flit_t>    chan_hor_right_req[DIM_X+1][DIM_Y];
+  Connections::Combinational<rreq_flit_t>    chan_hor_left_req[DIM_X+1][DIM_Y];
+  Connections::Combinational<rreq_flit_t>    chan_ver_up_req[DIM_X][DIM_Y+1];
+  Connections::Combinational<rreq_flit_t>    chan_ver_down_req[DIM_X][DIM_Y+1];
+
+  Connections::Combinational<wreq_flit_t>    chan_inj_wreq[DIM_X][DIM_Y];
+  Connections::Combinational<rreq_flit_t>    chan_inj_rreq[DIM_X][DIM_Y];
+
+  Connections::Combinational<wreq_flit_t>    chan_ej_wreq[DIM_X][DIM_Y];
+  Connections::Combinational<rreq_flit_t>    chan_ej_rreq[DIM_X][DIM_Y];
+
+  // RESP Routers + In/Out Channels
+  rtr_resp_t *rtr_resp[DIM_X][DIM_Y];
+
+  Connections::Combinational<rresp_flit_t>   chan_hor_right_resp[DIM_X+1][DIM_Y];
+  Connections::Combinational<rresp_flit_t>   chan_hor_left_resp[DIM_X+1][DIM_Y];
+  Connections::Combinational<rresp_flit_t>   chan_ver_up_resp[DIM_X][DIM_Y+1];
+  Connections::Combinational<rresp_flit_t>   chan_ver_down_resp[DIM_X][DIM_Y+1];
+
+  Connections::Combinational<wresp_flit_t>   chan_inj_wresp[DIM_X][DIM_Y];
+  Connections::Combinational<rresp_flit_t>   chan_inj_rresp[DIM_X][DIM_Y];
+
+  Connections::Combinational<wresp_flit_t>   chan_ej_wresp[DIM_X][DIM_Y];
+  Connections::Combinational<rresp_flit_t>   chan_ej_rresp[DIM_X][DIM_Y];
+
+  SC_CTOR(ic_top_mesh) {
+    NVHLS_ASSERT_MSG((cfg::MASTER_NUM+cfg::SLAVE_NUM) <= NODES, "More Masters and Slaves than mesh routers!");
+    NVHLS_ASSERT_MSG(NODES <= (1<<dnp::D_W), "Mesh nodes do not fit in the node ID field. Increase DNP_NODE_W");
+
+    route_lut[0] = 0;
+
+    // ----------------- //
+    // --- SLAVE-IFs --- //
+    // ----------------- //
+    for(unsigned j=0; j<cfg::SLAVE_NUM; ++j){
+      NODE_IDS_SLAVE[j] = j;
+
+      unsigned col = j % DIM_X; // aka x dim
+      unsigned row = j / DIM_X; // aka y dim
+
+      slave_if[j] = new axi_slave_if < cfg > (sc_gen_unique_name("Slave-if"));
+      slave_if[j]->clk(clk);
+      slave_if[j]->rst_n(rst_n);
+
+      slave_if[j]->THIS_ID(NODE_IDS_SLAVE[j]);
+      slave_if[j]->slave_base_addr(addr_map[j][0]);
+      // Read-NoC
+      slave_if[j]->rd_flit_in(chan_ej_rreq[col][row]);
+      slave_if[j]->rd_flit_out(chan_inj_rresp[col][row]);
+      // Write-NoC
+      slave_if[j]->wr_flit_in(chan_ej_wreq[col][row]);
+      slave_if[j]->wr_flit_out(chan_inj_wresp[col][row]);
+      // Slave-Side
+      slave_if[j]->ar_out(ar_out[j]);
+      slave_if[j]->r_in(r_in[j]);
+
+      slave_if[j]->aw_out(aw_out[j]);
+      slave_if[j]->w_out(w_out[j]);
+      slave_if[j]->b_in(b_in[j]);
+    }
+
+    // ------------------------------ //
+    // --- MASTER-IFs Connectivity--- //
+    // ------------------------------ //
+    for (unsigned i=0; i<cfg::MASTER_NUM; ++i) {
+      NODE_IDS_MASTER[i] = cfg::SLAVE_NUM + i;
+
+      unsigned col = (cfg::SLAVE_NUM + i) % DIM_X; // aka x dim
+      unsigned row = (cfg::SLAVE_NUM + i) / DIM_X; // aka y dim
+
+      master_if[i] = new axi_master_if < cfg > (sc_gen_unique_name("Master-if"));
+      master_if[i]->clk(clk);
+      master_if[i]->rst_n(rst_n);
+      // Pass the address Map
+      for (int n=0; n<cfg::SLAVE_NUM; ++n) // Iterate Slaves
+        for (int s=0; s<2; ++s) // Iterate Begin-End Values
+          master_if[i]->addr_map[n][s](addr_map[n][s]);
+
+      master_if[i]->THIS_ID(NODE_IDS_MASTER[i]);
+
+      // Master-AXI-Side
+      master_if[i]->ar_in(ar_in[i]);
+      master_if[i]->r_out(r_out[i]);
+
+      master_if[i]->aw_in(aw_in[i]);
+      master_if[i]->w_in(w_in[i]);
+      master_if[i]->b_out(b_out[i]);
+      // Read-NoC
+      master_if[i]->rd_flit_out(chan_inj_rreq[col][row]);
+      master_if[i]->rd_flit_in(chan_ej_rresp[col][row]);
+      // Write-NoC
+      master_if[i]->wr_flit_out(chan_inj_wreq[col][row]);
+      master_if[i]->wr_flit_in(chan_ej_wresp[col][row]);
+    }
+    // -o-o-o-o-o-o-o-o-o- //
+    // -o-o-o-o-o-o-o-o-o- //
+
+    for (unsigned row=0; row<DIM_Y; ++row) rtr_id_y[row] = row;
+    for (unsigned col=0; col<DIM_X; ++col) rtr_id_x[col] = col;
+
+    // --- NoC Connectivity --- //
+    // Ports 0:-X 1:+X 2:-Y 3:+Y 4:Local RD 5:Local WR
+    for(unsigned row=0; row<DIM_Y; ++row) {
+      for (unsigned col=0; col<DIM_X; ++col) {
+        // Req/Fwd Router
+        rtr_req[col][row] = new rtr_req_t(sc_gen_unique_name("Router-req"));
+        rtr_req[col][row]->clk(clk);
+        rtr_req[col][row]->rst_n(rst_n);
+        rtr_req[col][row]->route_lut[0](route_lut[0]);
+        rtr_req[col][row]->id_x(rtr_id_x[col]);
+        rtr_req[col][row]->id_y(rtr_id_y[row]);
+
+        rtr_req[col][row]->data_in[0](chan_hor_right_req[col][row]);
+        rtr_req[col][row]->data_out[0](chan_hor_left_req[col][row]);
+
+        rtr_req[col][row]->data_in[1](chan_hor_left_req[col+1][row]);
+        rtr_req[col][row]->data_out[1](chan_hor_right_req[col+1][row]);
+
+        rtr_req[col][row]->data_in[2](chan_ver_up_req[col][row]);
+        rtr_req[col][row]->data_out[2](chan_ver_down_req[col][row]);
+
+        rtr_req[col][row]->data_in[3](chan_ver_down_req[col][row+1]);
+        rtr_req[col][row]->data_out[3](chan_ver_up_req[col][row+1]);
+
+        rtr_req[col][row]->data_in[4](chan_inj_rreq[col][row]);
+        rtr_req[col][row]->data_out[4](chan_ej_rreq[col][row]);
+
+        rtr_req[col][row]->data_in[5](chan_inj_wreq[col][row]);
+        rtr_req[col][row]->data_out[5](chan_ej_wreq[col][row]);
+
+        // Resp/Bck Router
+        rtr_resp[col][row] = new rtr_resp_t(sc_gen_unique_name("Router-resp"));
+        rtr_resp[col][row]->clk(clk);
+        rtr_resp[col][row]->rst_n(rst_n);
+        rtr_resp[col][row]->route_lut[0](route_lut[0]);
+        rtr_resp[col][row]->id_x(rtr_id_x[col]);
+        rtr_resp[col][row]->id_y(rtr_id_y[row]);
+
+        rtr_resp[col][row]->data_in[0](chan_hor_right_resp[col][row]);
+        rtr_resp[col][row]->data_out[0](chan_hor_left_resp[col][row]);
+
+        rtr_resp[col][row]->data_in[1](chan_hor_left_resp[col+1][row]);
+        rtr_resp[col][row]->data_out[1](chan_hor_right_resp[col+1][row]);
+
+        rtr_resp[col][row]->data_in[2](chan_ver_up_resp[col][row]);
+        rtr_resp[col][row]->data_out[2](chan_ver_down_resp[col][row]);
+
+        rtr_resp[col][row]->data_in[3](chan_ver_down_resp[col][row+1]);
+        rtr_resp[col][row]->data_out[3](chan_ver_up_resp[col][row+1]);
+
+        rtr_resp[col][row]->data_in[4](chan_inj_rresp[col][row]);
+        rtr_resp[col][row]->data_out[4](chan_ej_rresp[col][row]);
+
+        rtr_resp[col][row]->data_in[5](chan_inj_wresp[col][row]);
+        rtr_resp[col][row]->data_out[5](chan_ej_wresp[col][row]);
+      }
+    }
+    
+#ifndef __SYNTHESIS__
+    // The mesh links of the deadlock watchdog, its probes named by the coordinates. The local ports lead to the NIs
+    for(unsigned row=0; row<DIM_Y; ++row) {
+      for (unsigned col=0; col<DIM_X; ++col) {
+        std::string coord = "(" + std::to_string(col) + "," + std::to_string(row) + ")";
+        rtr_req[col][row]->wdog.name  = "Router-req"  + coord;
+        rtr_resp[col][row]->wdog.name = "Router-resp" + coord;
+        if (col+1<DIM_X) {
+          rtr_watchdog::link(rtr_req[col][row]->wdog,    1, rtr_req[col+1][row]->wdog,  0);
+          rtr_watchdog::link(rtr_req[col+1][row]->wdog,  0, rtr_req[col][row]->wdog,    1);
+          rtr_watchdog::link(rtr_resp[col][row]->wdog,   1, rtr_resp[col+1][row]->wdog, 0);
+          rtr_watchdog::link(rtr_resp[col+1][row]->wdog, 0, rtr_resp[col][row]->wdog,   1);
+        }
+        if (row+1<DIM_Y) {
+          rtr_watchdog::link(rtr_req[col][row]->wdog,    3, rtr_req[col][row+1]->wdog,  2);
+          rtr_watchdog::link(rtr_req[col][row+1]->wdog,  2, rtr_req[col][row]->wdog,    3);
+          rtr_watchdog::link(rtr_resp[col][row]->wdog,   3, rtr_resp[col][row+1]->wdog, 2);
+          rtr_watchdog::link(rtr_resp[col][row+1]->wdog, 2, rtr_resp[col][row]->wdog,   3);
+        }
+      }
+    }
+#endif
+  }; // End of constructor
+
+#ifndef __SYNTHESIS__
+  // Router utilization and stall counters, mapped to the mesh coordinates (col, row)
+  //   Ports 0:-X 1:+X 2:-Y 3:+Y 4:Local RD 5:Local WR
+  void end_of_simulation() {
+    std::cout << "\n--- Router Statistics ---\n";
+    for (unsigned row=0; row<DIM_Y; ++row) {
+      for (unsigned col=0; col<DIM_X; ++col) {
+        std::string coord = "(" + std::to_string(col) + "," + std::to_string(row) + ")";
+        rtr_req[col][row]->stats.print(std::cout, "Router-req" + coord);
+        rtr_resp[col][row]->stats.print(std::cout, "Router-resp" + coord);
+      }
+    }
+    std::cout.flush();
+  };
+#endif
+}; // End of SC_MODULE
+
+#endif // AXI4_TOP_IC_MESH_H
@@ -0,0 +1,322 @@
+#ifndef AXI4_TOP_IC_TORUS_H
+#define AXI4_TOP_IC_TORUS_H
+
+#pragma once
+
+#include "./axi_master_if_vc.h"
+#include "./axi_slave_if_vc.h"
+
+#include "./router_vc.h"
+
+#include "systemc.h"
+#include "nvhls_connections.h"
+
+// Parametric DIM_X x DIM_Y 2-D torus AXI interconnect. A single VC network carries both Requests (VC 0) and
+//   Responses (VC 1), as the vc-req-resp example, thus VCs 2 and 3 are their dateline copies (router_vc.h RC 9).
+//   Node placement is the one of ic_top_mesh.h, a node per router with the Slaves first.
+//   The rings are meant to be folded : in each row (column) logical router i is placed at physical slot
+//   folded_slot(i), ie 0, N-1, 1, N-2, ... Every link, the wraparound included, then spans at most two router
+//   pitches, thus all the links are the same plain channels without extra retiming for the wraparound.
+// DIM_X, DIM_Y : Torus dimensions, at least 2. DIM_X*DIM_Y must fit the node ID fields (dnp20_axi.h DNP_NODE_W)
+// cfg          : The configuration bundle of the vc examples with VCS = 4. The network has a single flit size,
+//                thus all the *_PHITS must be equal
+// BUFF_DEPTH   : Router input buffer slots per VC. The IFs take their credits from cfg::BUFF_DEPTH, thus they must match
+// ARB_TYPE     : The arbiter of the routers
+//   cfg::CR_COALESCE selects the coalesced credit return of the routers and IFs, cfg::DAMQ_SLOTS their shared buffers
+//   cfg::TCS must be 1, the dateline copies take the VCs traffic classes would use
+template <unsigned DIM_X_, unsigned DIM_Y_, typename cfg, unsigned BUFF_DEPTH=cfg::BUFF_DEPTH, arb_type ARB_TYPE=MATRIX>
+SC_MODULE(ic_top_torus) {
+public:
+  // typedef matchlib's axi with the "standard" configuration
+  typedef typename axi::axi4<axi::cfg::standard_duth> axi4_;
+
+  // typedef the 4 kind of flits(RD/WR Req/Resp) depending their size
+  typedef flit_dnp<cfg::RREQ_PHITS>  rreq_flit_t;
+  typedef flit_dnp<cfg::RRESP_PHITS> rresp_flit_t;
+  typedef flit_dnp<cfg::WREQ_PHITS>  wreq_flit_t;
+  typedef flit_dnp<cfg::WRESP_PHITS> wresp_flit_t;
+
+  typedef typename vc_credits<cfg::VCS, BUFF_DEPTH, cfg::CR_COALESCE>::cr_t cr_t;
+
+  static const unsigned DIM_X = DIM_X_;
+  static const unsigned DIM_Y = DIM_Y_;
+  static const unsigned NODES = DIM_X*DIM_Y;
+
+  typedef rtr_vc< 4+2, 4+2, rreq_flit_t, DIM_X, 1, cfg::VCS, BUFF_DEPTH, 9, ARB_TYPE, false, DIM_Y, cfg::CR_COALESCE, cfg::DAMQ_SLOTS, cfg::DAMQ_RSV >  rtr_t;
+
+  // Physical slot of the logical router i of a folded ring of n routers
+  static unsigned folded_slot(unsigned i, unsigned n) { return (2*i < n) ? 2*i : 2*(n-1-i)+1; };
+
+  sc_in_clk    clk;
+  sc_in <bool> rst_n;
+
+  // IC's Address map
+  sc_in<sc_uint <32> >           addr_map[cfg::SLAVE_NUM][2]; // [SLAVE_NUM][0:begin, 1: End]
+
+  sc_signal< sc_uint<dnp::D_W> >  route_lut[1]; // Not-Used by torus routing
+
+  // The Node IDs are passed to IFs as signals
+  sc_signal< sc_uint<dnp::S_W> > NODE_IDS_MASTER[cfg::MASTER_NUM];
+  sc_signal< sc_uint<dnp::S_W> > NODE_IDS_SLAVE[cfg::SLAVE_NUM];
+
+  sc_signal< sc_uint<dnp::D_W> > rtr_id_x[DIM_X];
+  sc_signal< sc_uint<dnp::D_W> > rtr_id_y[DIM_Y];
+
+  // MASTER Side AXI Channels
+  Connections::In<typename axi4_::AddrPayload>   ar_in[cfg::MASTER_NUM];
+  Connections::Out<typename axi4_::ReadPayload>  r_out[cfg::MASTER_NUM];
+
+  Connections::In<typename axi4_::AddrPayload>   aw_in[cfg::MASTER_NUM];
+  Connections::In<typename axi4_::WritePayload>  w_in[cfg::MASTER_NUM];
+  Connections::Out<typename axi4_::WRespPayload> b_out[cfg::MASTER_NUM];
+
+  // SLAVE Side AXI Channels
+  Connections::Out<typename axi4_::AddrPayload>  ar_out[cfg::SLAVE_NUM];
+  Connections::In<typename axi4_::ReadPayload>   r_in[cfg::SLAVE_NUM];
+
+  Connections::Out<typename axi4_::AddrPayload>  aw_out[cfg::SLAVE_NUM];
+  Connections::Out<typename axi4_::WritePayload> w_out[cfg::SLAVE_NUM];
+  Connections::In<typename axi4_::WRespPayload>  b_in[cfg::SLAVE_NUM];
+
+  //--- Internals ---//
+  // --- Master/Slave IFs ---
+  axi_master_if_vc < cfg > *master_if[cfg::MASTER_NUM];
+  axi_slave_if_vc  < cfg > *slave_if[cfg::SLAVE_NUM];
+
+  // IF <-> Router buffers, per node. [0]:RD Req, [1]:RD Resp, [2]:WR Req, [3]:WR Resp
+  Connections::Buffer<rreq_flit_t, 4>      *node_buf_data[NODES][4];
+  Connections::Buffer<cr_t , 4>            *node_buf_cr[NODES][4];
+  Connections::Combinational<rreq_flit_t>  node_chan_data[NODES][4];
+  Connections::Combinational<cr_t>         node_chan_cr[NODES][4];
+
+  // --- NoC Channels ---
+  rtr_t *rtr_inst[DIM_X][DIM_Y];
+
+  // Link [c][r] enters router (c,r) from its -X/-Y neighbour (right/up) or leaves it towards -X/-Y (left/down)
+  //   The wraparound links are [0][r] and [c][0]
+  Connections::Combinational<rreq_flit_t>  chan_hor_right_data[DIM_X][DIM_Y];
+  Connections::Combinational<cr_t>         chan_hor_right_cr[DIM_X][DIM_Y];
+  Connections::Combinational<rreq_flit_t>  chan_hor_left_data[DIM_X][DIM_Y];
+  Connections::Combinational<cr_t>         chan_hor_left_cr[DIM_X][DIM_Y];
+
+  Connections::Combinational<rreq_flit_t>  chan_ver_up_data[DIM_X][DIM_Y];
+  Connections::Combinational<cr_t>         chan_ver_up_cr[DIM_X][DIM_Y];
+  Connections::Combinational<rreq_flit_t>  chan_ver_down_data[DIM_X][DIM_Y];
+  Connections::Combinational<cr_t>         chan_ver_down_cr[DIM_X][DIM_Y];
+
+  Connections::Combinational<rreq_flit_t>  chan_inj_wr_data[DIM_X][DIM_Y];
+  Connections::Combinational<cr_t>         chan_inj_wr_cr[DIM_X][DIM_Y];
+  Connections::Combinational<rreq_flit_t>  chan_inj_rd_data[DIM_X][DIM_Y];
+  Connections::Combinational<cr_t>         chan_inj_rd_cr[DIM_X][DIM_Y];
+
+  Connections::Combinational<rreq_flit_t>  chan_ej_wr_data[DIM_X][DIM_Y];
+  Connections::Combinational<cr_t>         chan_ej_wr_cr[DIM_X][DIM_Y];
+  Connections::Combinational<rreq_flit_t>  chan_ej_rd_data[DIM_X][DIM_Y];
+  Connections::Combinational<cr_t>         chan_ej_rd_cr[DIM_X][DIM_Y];
+
+  SC_CTOR(ic_top_torus) {
+    NVHLS_ASSERT_MSG((DIM_X>=2) && (DIM_Y>=2), "Torus dimensions must be at least 2!");
+    NVHLS_ASSERT_MSG(cfg::VCS==4, "Torus needs 4 VCs, Requests/Responses and their dateline copies!");
+    NVHLS_ASSERT_MSG(cfg::TCS==1, "Torus dateline VCs leave no room for traffic classes!");
+    NVHLS_ASSERT_MSG(BUFF_DEPTH==cfg::BUFF_DEPTH, "The router buffers and the IF credits differ!");
+    NVHLS_ASSERT_MSG((cfg::MASTER_NUM+cfg::SLAVE_NUM) <= NODES, "More Masters and Slaves than torus routers!");
+    NVHLS_ASSERT_MSG(NODES <= (1<<dnp::D_W), "Torus nodes do not fit in the node ID field. Increase DNP_NODE_W");
+
+    route_lut[0] = 0;
+
+    // ----------------- //
+    // --- SLAVE-IFs --- //
+    // ----------------- //
+    for(unsigned j=0; j<cfg::SLAVE_NUM; ++j){
+      NODE_IDS_SLAVE[j] = j;
+
+      slave_if[j] = new axi_slave_if_vc < cfg > (sc_gen_unique_name("Slave-if"));
+      slave_if[j]->clk(clk);
+      slave_if[j]->rst_n(rst_n);
+
+      slave_if[j]->THIS_ID(NODE_IDS_SLAVE[j]);
+      slave_if[j]->slave_base_addr(addr_map[j][0]);
+
+      // Read-NoC
+      slave_if[j]->rd_flit_data_in(node_chan_data[j][0]);
+      slave_if[j]->rd_flit_cr_out(node_chan_cr[j][0]);
+      slave_if[j]->rd_flit_data_out(node_chan_data[j][1]);
+      slave_if[j]->rd_flit_cr_in(node_chan_cr[j][1]);
+      // Write-NoC
+      slave_if[j]->wr_flit_data_in(node_chan_data[j][2]);
+      slave_if[j]->wr_flit_cr_out(node_chan_cr[j][2]);
+      slave_if[j]->wr_flit_data_out(node_chan_data[j][3]);
+      slave_if[j]->wr_flit_cr_in(node_chan_cr[j][3]);
+
+      // Slave-Side
+      slave_if[j]->ar_out(ar_out[j]);
+      slave_if[j]->r_in(r_in[j]);
+
+      slave_if[j]->aw_out(aw_out[j]);
+      slave_if[j]->w_out(w_out[j]);
+      slave_if[j]->b_in(b_in[j]);
+
+      // Requests are ejected, Responses injected
+      bind_node_bufs(j, false);
+    }
+
+    // ------------------------------ //
+    // --- MASTER-IFs Connectivity--- //
+    // ------------------------------ //
+    for (unsigned i=0; i<cfg::MASTER_NUM; ++i) {
+      unsigned n = cfg::SLAVE_NUM + i;
+      NODE_IDS_MASTER[i] = n;
+
+      master_if[i] = new axi_master_if_vc < cfg > (sc_gen_unique_name("Master-if"));
+      master_if[i]->clk(clk);
+      master_if[i]->rst_n(rst_n);
+      // Pass the address Map
+      for (int s=0; s<cfg::SLAVE_NUM; ++s) // Iterate Slaves
+        for (int b=0; b<2; ++b) // Iterate Begin-End Values
+          master_if[i]->addr_map[s][b](addr_map[s][b]);
+
+      master_if[i]->THIS_ID(NODE_IDS_MASTER[i]);
+
+      // Master-AXI-Side
+      master_if[i]->ar_in(ar_in[i]);
+      master_if[i]->r_out(r_out[i]);
+
+      master_if[i]->aw_in(aw_in[i]);
+      master_if[i]->w_in(w_in[i]);
+      master_if[i]->b_out(b_out[i]);
+      // Read-NoC
+      master_if[i]->rd_flit_data_out(node_chan_data[n][0]);
+      master_if[i]->rd_flit_cr_in(node_chan_cr[n][0]);
+      master_if[i]->rd_flit_data_in(node_chan_data[n][1]);
+      master_if[i]->rd_flit_cr_out(node_chan_cr[n][1]);
+      // Write-NoC
+      master_if[i]->wr_flit_data_out(node_chan_data[n][2]);
+      master_if[i]->wr_flit_cr_in(node_chan_cr[n][2]);
+      master_if[i]->wr_flit_data_in(node_chan_data[n][3]);
+      master_if[i]->wr_flit_cr_out(node_chan_cr[n][3]);
+
+      // Requests are injected, Responses ejected
+      bind_node_bufs(n, true);
+    }
+    // -o-o-o-o-o-o-o-o-o- //
+    // -o-o-o-o-o-o-o-o-o- //
+
+    for (unsigned row=0; row<DIM_Y; ++row) rtr_id_y[row] = row;
+    for (unsigned col=0; col<DIM_X; ++col) rtr_id_x[col] = col;
+
+    // --- NoC Connectivity --- //
+    // Ports 0:-X 1:+X 2:-Y 3:+Y 4:Local RD 5:Local WR. The edge routers close the rings
+    for(unsigned row=0; row<DIM_Y; ++row) {
+      for (unsigned col=0; col<DIM_X; ++col) {
+        unsigned nxt_col = (col+1) % DIM_X;
+        unsigned nxt_row = (row+1) % DIM_Y;
+
+        rtr_inst[col][row] = new rtr_t(sc_gen_unique_name("Router"));
+        rtr_inst[col][row]->clk(clk);
+        rtr_inst[col][row]->rst_n(rst_n);
+        rtr_inst[col][row]->route_lut[0](route_lut[0]);
+        rtr_inst[col][row]->id_x(rtr_id_x[col]);
+        rtr_inst[col][row]->id_y(rtr_id_y[row]);
+
+        rtr_inst[col][row]->data_in[0] (chan_hor_right_data[col][row]);
+        rtr_inst[col][row]->cr_out[0]  (chan_hor_right_cr[col][row]);
+        rtr_inst[col][row]->data_out[0](chan_hor_left_data[col][row]);
+        rtr_inst[col][row]->cr_in[0]   (chan_hor_left_cr[col][row]);
+
+        rtr_inst[col][row]->data_in[1] (chan_hor_left_data[nxt_col][row]);
+        rtr_inst[col][row]->cr_out[1]  (chan_hor_left_cr[nxt_col][row]);
+        rtr_inst[col][row]->data_out[1](chan_hor_right_data[nxt_col][row]);
+        rtr_inst[col][row]->cr_in[1]   (chan_hor_right_cr[nxt_col][row]);
+
+        rtr_inst[col][row]->data_in[2] (chan_ver_up_data[col][row]);
+        rtr_inst[col][row]->cr_out[2]  (chan_ver_up_cr[col][row]);
+        rtr_inst[col][row]->data_out[2](chan_ver_down_data[col][row]);
+        rtr_inst[col][row]->cr_in[2]   (chan_ver_down_cr[col][row]);
+
+        rtr_inst[col][row]->data_in[3] (chan_ver_down_data[col][nxt_row]);
+        rtr_inst[col][row]->cr_out[3]  (chan_ver_down_cr[col][nxt_row]);
+        rtr_inst[col][row]->data_out[3](chan_ver_up_data[col][nxt_row]);
+        rtr_inst[col][row]->cr_in[3]   (chan_ver_up_cr[col][nxt_row]);
+
+        rtr_inst[col][row]->data_in[4] (chan_inj_rd_data[col][row]);
+        rtr_inst[col][row]->cr_out[4]  (chan_inj_rd_cr[col][row]);
+        rtr_inst[col][row]->data_out[4](chan_ej_rd_data[col][row]);
+        rtr_inst[col][row]->cr_in[4]   (chan_ej_rd_cr[col][row]);
+
+        rtr_inst[col][row]->data_in[5] (chan_inj_wr_data[col][row]);
+        rtr_inst[col][row]->cr_out[5]  (chan_inj_wr_cr[col][row]);
+        rtr_inst[col][row]->data_out[5](chan_ej_wr_data[col][row]);
+        rtr_inst[col][row]->cr_in[5]   (chan_ej_wr_cr[col][row]);
+      }
+    }
+    
+#ifndef __SYNTHESIS__
+    // The ring links of the deadlock watchdog, its probes named by the coordinates. The local ports lead to the NIs
+    for(unsigned row=0; row<DIM_Y; ++row) {
+      for (unsigned col=0; col<DIM_X; ++col) {
+        unsigned nxt_col = (col+1) % DIM_X;
+        unsigned nxt_row = (row+1) % DIM_Y;
+        rtr_inst[col][row]->wdog.name = "Router(" + std::to_string(col) + "," + std::to_string(row) + ")";
+        rtr_watchdog::link(rtr_inst[col][row]->wdog,     1, rtr_inst[nxt_col][row]->wdog, 0);
+        rtr_watchdog::link(rtr_inst[nxt_col][row]->wdog, 0, rtr_inst[col][row]->wdog,     1);
+        rtr_watchdog::link(rtr_inst[col][row]->wdog,     3, rtr_inst[col][nxt_row]->wdog, 2);
+        rtr_watchdog::link(rtr_inst[col][nxt_row]->wdog, 2, rtr_inst[col][row]->wdog,     3);
+      }
+    }
+#endif
+  }; // End of constructor
+
+  // Binds the IF buffers of node n to the local ports of its router.
+  //   A Master injects the Requests and ejects the Responses, a Slave the opposite
+  void bind_node_bufs(unsigned n, bool is_master) {
+    unsigned col = n % DIM_X; // aka x dim
+    unsigned row = n / DIM_X; // aka y dim
+
+    Connections::Combinational<rreq_flit_t> *rtr_data[2][2] = {{&chan_inj_rd_data[col][row], &chan_ej_rd_data[col][row]},
+                                                               {&chan_inj_wr_data[col][row], &chan_ej_wr_data[col][row]}};
+    Connections::Combinational<cr_t>        *rtr_cr[2][2]   = {{&chan_inj_rd_cr[col][row],   &chan_ej_rd_cr[col][row]},
+                                                               {&chan_inj_wr_cr[col][row],   &chan_ej_wr_cr[col][row]}};
+
+    for (unsigned c=0; c<4; ++c) {
+      unsigned wr     = c/2;
+      bool     is_req = (c%2)==0;
+      bool     inject = (is_req == is_master);
+
+      node_buf_data[n][c] = new Connections::Buffer<rreq_flit_t, 4>(sc_gen_unique_name("node_buf_data"));
+      node_buf_cr[n][c]   = new Connections::Buffer<cr_t , 4>(sc_gen_unique_name("node_buf_cr"));
+      node_buf_data[n][c]->clk(clk);
+      node_buf_data[n][c]->rst(rst_n);
+      node_buf_cr[n][c]->clk(clk);
+      node_buf_cr[n][c]->rst(rst_n);
+
+      if (inject) {
+        node_buf_data[n][c]->enq(node_chan_data[n][c]);
+        node_buf_data[n][c]->deq(*rtr_data[wr][0]);
+        node_buf_cr[n][c]->enq(*rtr_cr[wr][0]);
+        node_buf_cr[n][c]->deq(node_chan_cr[n][c]);
+      } else {
+        node_buf_data[n][c]->enq(*rtr_data[wr][1]);
+        node_buf_data[n][c]->deq(node_chan_data[n][c]);
+        node_buf_cr[n][c]->enq(node_chan_cr[n][c]);
+        node_buf_cr[n][c]->deq(*rtr_cr[wr][1]);
+      }
+    }
+  };
+
+#ifndef __SYNTHESIS__
+  // Router utilization and stall counters, mapped to the torus coordinates (col, row)
+  //   Ports 0:-X 1:+X 2:-Y 3:+Y 4:Local RD 5:Local WR
+  void end_of_simulation() {
+    std::cout << "\n--- Router Statistics ---\n";
+    for (unsigned row=0; row<DIM_Y; ++row) {
+      for (unsigned col=0; col<DIM_X; ++col) {
+        std::string coord = "(" + std::to_string(col) + "," + std::to_string(row) + ")";
+        rtr_inst[col][row]->stats.print(std::cout, "Router" + coord);
+      }
+    }
+    std::cout.flush();
+  };
+#endif
+}; // End of SC_MODULE
+
+#endif // AXI4_TOP_IC_TORUS_H
@@ -0,0 +1,103 @@
+#ifndef __ADDR_DECODER__
+#define __ADDR_DECODER__
+
+#include <systemc.h>
+#include "nvhls_connections.h"
+
+// Address decoder of the memory map, shared by the Master IFs and HOME.
+//   The map is the addr_map ports of the IF, [slave][0:begin, 1:end], or when ADDR_DEC_MAP names a type,
+//   a compile-time range table. All regions are compared in parallel and the lowest matching slave is selected.
+//   A compile-time region of a power of 2 size, aligned to its size, matches its base on the upper address
+//   bits (mask/match), a single comparator instead of two.
+// ADDR_DEC_MAP       : A type of constexpr base(i) and end(i), the inclusive range of slave i. eg
+//                        struct soc_map {
+//                          static constexpr unsigned long long base(unsigned i) {return 0x10000ULL*i;};
+//                          static constexpr unsigned long long end (unsigned i) {return 0x10000ULL*i + 0xffff;};
+//                        };
+// ADDR_DEC_DEF_SLAVE : The slave of the unmapped addresses, eg one that responds DECERR.
+//                      Unset, an unmapped address resolves to slave 0 and is an error where the IF checks it.
+template <unsigned SLAVES>
+struct addr_decoder {
+#ifdef ADDR_DEC_DEF_SLAVE
+  static const bool     HAS_DEF   = true;
+  static const unsigned DEF_SLAVE = ADDR_DEC_DEF_SLAVE;
+#else
+  static const bool     HAS_DEF   = false;
+  static const unsigned DEF_SLAVE = 0;
+#endif
+
+  // A region of a power of 2 size, aligned to it
+  static constexpr bool pow2_region(unsigned long long base, unsigned long long end) {
+    return ((((end-base+1) & (end-base)) == 0) && ((base & (end-base)) == 0));
+  };
+
+  // The slave of addr. hit is cleared when no region maps it, and DEF_SLAVE is returned
+  template <typename A, typename T>
+  static inline unsigned char decode(const A &addr, sc_in<T> map[][2], bool &hit) {
+    unsigned char sel = DEF_SLAVE;
+    hit = false;
+#ifdef ADDR_DEC_MAP
+    unsigned long long addr_u = to_u64(addr);
+#endif
+    #pragma hls_unroll yes
+    for (int i=SLAVES-1; i>=0; --i) {
+#ifdef ADDR_DEC_MAP
+      bool match = pow2_region(ADDR_DEC_MAP::base(i), ADDR_DEC_MAP::end(i)) ?
+                   ((addr_u & ~(ADDR_DEC_MAP::end(i)-ADDR_DEC_MAP::base(i))) == ADDR_DEC_MAP::base(i)) :
+                   ((addr_u >= ADDR_DEC_MAP::base(i)) && (addr_u <= ADDR_DEC_MAP::end(i)));
+#else
+      bool match = (addr >= map[i][0].read()) && (addr <= map[i][1].read());
+#endif
+      if (match) {
+        sel = i;
+        hit = true;
+      }
+    }
+    return sel;
+  };
+
+  // The base address of slave i
+  template <typename T>
+  static inline unsigned long long base(sc_in<T> map[][2], const unsigned i) {
+#ifdef ADDR_DEC_MAP
+    return ADDR_DEC_MAP::base(i);
+#else
+    return map[i][0].read().to_uint64();
+#endif
+  };
+
+  template <typename A>
+  static inline unsigned long long to_u64(const A &addr) {return addr.to_uint64();};
+  static inline unsigned long long to_u64(const unsigned &addr) {return addr;};
+};
+
+// HOME of a coherent address, shared by the ACE Master IFs. The lines are interleaved to the HOMES at line
+//   granularity, of (1<<LOG_LINE_B) bytes, thus HOMES must be a power of 2 to select on the line address bits.
+//   ADDR_W is the width of the address, the span of the fold.
+// HOME_SEL : 0 the line address modulo HOMES, 1 the XOR-fold of the line address
+template <unsigned HOMES, unsigned char HOME_SEL, unsigned LOG_LINE_B, unsigned ADDR_W>
+struct home_decoder {
+  static_assert((HOMES>0) && ((HOMES & (HOMES-1)) == 0), "home_decoder : HOMES must be a power of 2.");
+  static const unsigned LOG_HOMES = nvhls::log2_ceil<HOMES>::val;
+
+  // The HOME index of addr, 0..HOMES-1
+  template <typename A>
+  static inline unsigned decode(const A &addr) {
+    unsigned home = 0;
+    if (HOMES>1) {
+      A line = addr >> LOG_LINE_B;
+      if (HOME_SEL==1) {
+        #pragma hls_unroll yes
+        for (int i=0; i<(int)ADDR_W; i+=(LOG_HOMES ? LOG_HOMES : 1)) {
+          A fold = line >> i;
+          home ^= fold.to_uint() & (HOMES-1);
+        }
+      } else {
+        home = line.to_uint() & (HOMES-1);
+      }
+    }
+    return home;
+  };
+};
+
+#endif // __ADDR_DECODER__
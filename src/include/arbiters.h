@@ -1,7 +1,14 @@
 #ifndef __ARBITERS_HEADER__
 #define __ARBITERS_HEADER__
 
-enum arb_type {FIXED, MATRIX, ROUND_ROBIN, WEIGHTED_RR, DEFICIT_RR, STRATIFIED_RR, PHASE};
+enum arb_type {FIXED, MATRIX, ROUND_ROBIN, WEIGHTED_RR, DEFICIT_RR, STRATIFIED_RR, PHASE, QOS_RR, TREE_RR, AGE_RR};
+
+// ARB_WEIGHTS : A type of constexpr weight(i), the weight (WEIGHTED_RR) or quantum (DEFICIT_RR) in flits of input i,
+//               set by every such arbiter at construction. setWeights() still overrides it per arbiter. eg
+//                 struct soc_weights {
+//                   static constexpr unsigned weight(unsigned i) {return (i==0) ? 60 : 30;};
+//                 };
+//               Unset, the defaults of the arbiters hold.
 
 
 template<unsigned SIZE, arb_type ARB_TYPE, unsigned S=0, unsigned DOMAINS=0>
@@ -41,6 +48,12 @@ public:
     
     return grants;
   };
+  
+  // The lowest requesting input, as the one-hot interface of the routers
+  bool arbitrate(const sc_uint<SIZE> reqs_i, sc_uint<SIZE>& grants_o) {
+    grants_o = reqs_i & ((~reqs_i) + 1);
+    return reqs_i.or_reduce();
+  };
 };
 
 /* FUNCTION: Round Robin Arbiter
@@ -226,256 +239,426 @@ public:
   
 };
 
-/* FUNCTION: Wighted Round Robin Arbiter
- * INPUT:    Array of bools
- * OUTPUT:   Unsigned integer pointer to bit position
+/* FUNCTION: Parallel Prefix (Tree) Round Robin Arbiter
+ * INPUT:    One-hot vector of requests
+ * OUTPUT:   One-hot vector of grants. Returns true when any request is granted
  * -----------------------------------------
- *
+ * Round Robin of a single thermometer priority vector, thus O(N) state
+ * instead of the O(N^2) of MATRIX. The first request at or after the priority
+ * is found by a prefix-OR of log2(N) levels (Kogge-Stone), O(N log N) gates
+ * and log depth instead of a chain through all inputs. For high radix routers.
  */
 template<unsigned SIZE>
-class arbiter<SIZE, WEIGHTED_RR, 0, 0> {
+class arbiter<SIZE, TREE_RR, 0, 0> {
 private:
-  bool     Weights[SIZE][SIZE];
-  bool     unvisited[SIZE];
-  unsigned scanCycle;
-  
-  /* FUNCTION: Priority Enforcer
-   * INPUT:    Integer Value
-   * OUTPUT:   Pointer to the least significant
-   *           non zerob bit.
-   * -----------------------------------------
-   *
-   */
-  unsigned priorityEnforcer( unsigned inp ) {
-    
-    unsigned pbit=0;
-    bool found = false;
-
-#pragma hls_unroll yes
-    for (int i=0; i<SIZE; i++) {
-      if ( ((inp & 1<<i) >0) && !found ) {
-        found = true;
-        pbit = i;
-      }
-    }
-    
-    return pbit;
-  }
+  sc_uint<SIZE> priority_therm; // The inputs after the last granted
+  
+  // Each bit is the OR of itself and all the lower ones
+  static inline sc_uint<SIZE> prefix_or(sc_uint<SIZE> x) {
+    #pragma hls_unroll yes
+    for (unsigned s=1; s<SIZE; s<<=1) x = x | (x << s);
+    return x;
+  };
+  
+  // The lowest set bit
+  static inline sc_uint<SIZE> first(const sc_uint<SIZE> x) {
+    sc_uint<SIZE> below = prefix_or(x) << 1;
+    return x & ~below;
+  };
 
 public:
-  
-  arbiter(){
-    
-    scanCycle = 1;
-#pragma hls_unroll yes
-    for (int i=0; i<SIZE; i++) {
-      
-      unvisited[i] = true;
-#pragma hls_unroll yes
-      for (int j=0; j<SIZE; j++) {
-        
-        if (j == i)
-          Weights[i][j] = true;
-        else
-          Weights[i][j] = false;
-      }
-    }
+  arbiter() {
+    priority_therm = 0;
   }
   
-  unsigned arbitrate( bool inp[SIZE] ) {
+  unsigned arbitrate(bool inp[SIZE]) {
+    sc_uint<SIZE> reqs = 0;
+    #pragma hls_unroll yes
+    for (int i=0; i<SIZE; ++i) reqs[i] = inp[i];
+    sc_uint<SIZE> grants;
+    arbitrate(reqs, grants);
+    return oh_fun<SIZE>::oh2wb(grants);
+  };
+  
+  bool arbitrate(const sc_uint<SIZE> reqs_i, sc_uint<SIZE>&  grants_o) {
+    sc_uint<SIZE> req_hp = reqs_i & priority_therm;
     
-    bool sterCyles[SIZE];
-    bool isSterile;
-    bool found     = false;
+    bool anygrant = reqs_i.or_reduce();
+    grants_o = req_hp.or_reduce() ? first(req_hp) : first(reqs_i);
     
-    unsigned pbit;
-    unsigned sterile = 0;;
-    unsigned grants  = 0;
-
-#pragma hls_unroll yes
-    for (int i=0; i<SIZE; i++) {
-      sterCyles[i] = false;
-    }
-
-#pragma hls_unroll yes
-    for (int k=0;k<SIZE; k++) { // repeat until a non sterile scan cycle
-      
-      pbit = priorityEnforcer(scanCycle);
-
-#pragma hls_unroll yes
-      for (int i=0; i<SIZE; i++) { // check each input flow
-        
-        if (!found && inp[i] && unvisited[i] && Weights[i][pbit]) {
-          unvisited[i] = false;
-          found = true;
-          grants = i;
-        }
-      }
-      
-      if (!found) { // if no grant was given
-        
-        isSterile = true;
-
-#pragma hls_unroll yes
-        for (int i=0; i<SIZE; i++) { // update unvisited flows
-          
-          if ( !unvisited[i] ) {
-            isSterile = false;
-          }
-          unvisited[i] = true;
-        }
-        
-        if (isSterile) { // update scan cycle avoiding sterile cycles
-          
-          sterCyles[pbit] = true;
-
-#pragma hls_unroll yes
-          for (int i=0; i<SIZE; i++) {
-            if (sterCyles[i] && ((scanCycle | 1<<i)!=scanCycle) ) {
-              sterile = sterile + (1<<i);
-            }
-          }
-        }
-        
-        scanCycle = scanCycle + sterile + 1;
-        if (scanCycle >= ((1<<SIZE)-1) ) {
-          scanCycle = sterile + 1;
-        }
-      }
-    }
+    // OH to THERM, of the inputs above the grant
+    if (anygrant) priority_therm = prefix_or(grants_o) << 1;
     
-    return grants;
+    return anygrant;
   };
+};
+
+/* FUNCTION: Weighted Round Robin Arbiter
+ * INPUT:    One-hot vector of requests and the packet length (flits) of each request
+ * OUTPUT:   One-hot vector of grants. Returns true when any request is granted
+ * -----------------------------------------
+ * Each input owns a budget of Weight flits per round. A request is granted
+ * while the input has budget left, and is charged the whole packet at its
+ * head, thus the last packet of the round may overdraw the budget. Body flits
+ * cost 0, so the decisions are taken at packet boundaries. The granted input
+ * keeps the turn until its budget is spent. A new round starts when no
+ * requester has budget left. Weights default to 1, i.e. packet Round Robin,
+ * or ARB_WEIGHTS.
+ */
+template<unsigned SIZE>
+class arbiter<SIZE, WEIGHTED_RR, 0, 0> {
+public:
+  static const unsigned CNT_W = 16;
   
+private:
+  sc_uint<SIZE>  priority_therm;
+  sc_uint<CNT_W> Budget[SIZE];
+  sc_uint<CNT_W> Weights[SIZE];
+
+public:
+  arbiter() {
+    priority_therm = 0;
+    #pragma hls_unroll yes
+    for (int i=0; i<SIZE; i++) {
+#ifdef ARB_WEIGHTS
+      Weights[i] = clamp(ARB_WEIGHTS::weight(i));
+#else
+      Weights[i] = 1;
+#endif
+      Budget[i]  = Weights[i];
+    }
+  }
   
   /* FUNCTION: WRR Arbiter :: setWeights
    * INPUT:    Array of unsigned weight values
    * OUTPUT:
    * -----------------------------------------
-   * Input weight for each flow is given as a
-   * percentage of the bandwidth is asks for.
-   * For example if the value of the weight is 75,
-   * this flow asks for the 75% of the bandwidth.
+   * Weight of each input, in flits per round. A zero
+   * weight is treated as 1 to keep every input served.
    */
-  void setWeights( unsigned inp[SIZE] ) {
-    
-    unsigned tmp;
-
-#pragma hls_unroll yes
+  void setWeights( const unsigned inp[SIZE] ) {
+    #pragma hls_unroll yes
     for (int i=0; i<SIZE; i++) {
-      
-      tmp = inp[i];
-
-#pragma hls_unroll yes
-      for (int j=0; j<SIZE; j++) {
-        
-        if (tmp >= 100/(1<<(j+1))) {
-          Weights[i][j] = true;
-          tmp = tmp - 100/(1<<(j+1));
-        } else {
-          Weights[i][j] = false;
-        }
-      }
+      Weights[i] = clamp(inp[i]);
+      Budget[i]  = Weights[i];
     }
   }
+  
+  // A weight within 1 and the counters
+  static inline unsigned clamp(const unsigned w) {
+    return (w==0) ? 1 : ((w >= (1<<CNT_W)) ? (1<<CNT_W)-1 : w);
+  }
+  
+  // Plain interface, each grant costs a single flit
+  bool arbitrate(const sc_uint<SIZE> reqs_i, sc_uint<SIZE>& grants_o) {
+    sc_uint<CNT_W> unit_cost[SIZE];
+    #pragma hls_unroll yes
+    for (int i=0; i<SIZE; i++) unit_cost[i] = 1;
+    
+    return arbitrate(reqs_i, unit_cost, grants_o);
+  };
+  
+  template<class COST_T>
+  bool arbitrate(const sc_uint<SIZE> reqs_i, const COST_T cost_i[SIZE], sc_uint<SIZE>& grants_o) {
+    sc_uint<SIZE> eligible = 0;
+    #pragma hls_unroll yes
+    for (int i=0; i<SIZE; i++) eligible[i] = reqs_i[i] && ((Budget[i]>0) || (cost_i[i]==0));
+    
+    // Nobody has budget left, a new round begins
+    bool new_round = reqs_i.or_reduce() && !eligible.or_reduce();
+    sc_uint<CNT_W> budget_cur[SIZE];
+    #pragma hls_unroll yes
+    for (int i=0; i<SIZE; i++) {
+      budget_cur[i] = new_round ? Weights[i] : Budget[i];
+      eligible[i]   = reqs_i[i] && ((budget_cur[i]>0) || (cost_i[i]==0));
+    }
+    
+    sc_uint<SIZE> req_lp = eligible & (~priority_therm);
+    sc_uint<SIZE> req_hp = eligible & priority_therm;
+    
+    sc_uint<SIZE> grants_lp = ((~req_lp) + 1) & req_lp;
+    sc_uint<SIZE> grants_hp = ((~req_hp) + 1) & req_hp;
+    
+    bool anygrant = eligible.or_reduce();
+    grants_o = grants_hp.or_reduce() ? grants_hp : grants_lp;
+    
+    // OH to THERM. The granted input keeps the highest priority
+    if (anygrant) priority_therm = ~(grants_o - 1);
+    
+    #pragma hls_unroll yes
+    for (int i=0; i<SIZE; i++) {
+      if (grants_o[i]) Budget[i] = (budget_cur[i] > cost_i[i]) ? (sc_uint<CNT_W>)(budget_cur[i] - cost_i[i]) : (sc_uint<CNT_W>)0;
+      else             Budget[i] = budget_cur[i];
+    }
+    
+    return anygrant;
+  };
 };
 
 
 /* FUNCTION: Deficit Round Robin Arbiter
- * INPUT:    Array of bools
- * OUTPUT:   Unsigned integer pointer to bit position
+ * INPUT:    One-hot vector of requests and the packet length (flits) of each request
+ * OUTPUT:   One-hot vector of grants. Returns true when any request is granted
  * -----------------------------------------
- *
+ * A request is granted only when the deficit counter of its input covers the
+ * whole packet, which is charged at its head. Body flits cost 0, thus the
+ * decisions are taken at packet boundaries. The granted input keeps the turn
+ * until it can not afford its next packet. When no requester can afford its
+ * packet, all the requesters get their Quantum and the deficit carries over.
+ * For a work-conserving arbiter the Quantum must not be less than the longest
+ * packet in flits. Quantum defaults to 30 flits for every input, or ARB_WEIGHTS.
+ * An input that does not request loses its deficit, thus an idle input can not
+ * save up a burst.
  */
 template<unsigned SIZE>
 class arbiter<SIZE, DEFICIT_RR, 0, 0> {
-private:
-  unsigned priority;
+public:
+  static const unsigned CNT_W = 16;
   
-  struct flowQueue {
-    unsigned packetSize[5];
-    unsigned maxIndex;
-  };
-  unsigned  D[SIZE];
-  unsigned  Q[SIZE];
-  bool      ActiveList[SIZE];
-  flowQueue F[SIZE];
+private:
+  sc_uint<SIZE>  priority_therm;
+  sc_uint<CNT_W> D[SIZE]; // Deficit counter
+  sc_uint<CNT_W> Q[SIZE]; // Quantum of each input
 
 public:
-  arbiter(){
-
-#pragma hls_unroll yes
+  arbiter() {
+    priority_therm = 0;
+    #pragma hls_unroll yes
     for (int i=0; i<SIZE; i++) {
-      ActiveList[i] = false;
-      F[i].maxIndex = 0;
       D[i] = 0;
-      Q[i] = 30; // maybe a function to set quantum of BW per input
+#ifdef ARB_WEIGHTS
+      Q[i] = clamp(ARB_WEIGHTS::weight(i));
+#else
+      Q[i] = 30;
+#endif
     }
   }
   
-  unsigned arbitrate( bool inp[SIZE], unsigned inp_size[SIZE] ) {
+  /* FUNCTION: DRR Arbiter :: setWeights
+   * INPUT:    Array of unsigned quantum values
+   * OUTPUT:
+   * -----------------------------------------
+   * Quantum of each input, in flits per round.
+   * The BW share of input i is Q[i]/sum(Q).
+   */
+  void setWeights( const unsigned inp[SIZE] ) {
+    #pragma hls_unroll yes
+    for (int i=0; i<SIZE; i++) {
+      Q[i] = clamp(inp[i]);
+      D[i] = 0;
+    }
+  }
+  
+  // A quantum within 1 and the counters
+  static inline unsigned clamp(const unsigned q) {
+    return (q==0) ? 1 : ((q >= (1<<CNT_W)) ? (1<<CNT_W)-1 : q);
+  }
+  
+  // Plain interface, each grant costs a single flit
+  bool arbitrate(const sc_uint<SIZE> reqs_i, sc_uint<SIZE>& grants_o) {
+    sc_uint<CNT_W> unit_cost[SIZE];
+    #pragma hls_unroll yes
+    for (int i=0; i<SIZE; i++) unit_cost[i] = 1;
     
-    bool found_hp = false;
-    bool found_lp = false;
+    return arbitrate(reqs_i, unit_cost, grants_o);
+  };
+  
+  template<class COST_T>
+  bool arbitrate(const sc_uint<SIZE> reqs_i, const COST_T cost_i[SIZE], sc_uint<SIZE>& grants_o) {
+    sc_uint<SIZE> eligible = 0;
+    #pragma hls_unroll yes
+    for (int i=0; i<SIZE; i++) eligible[i] = reqs_i[i] && (cost_i[i] <= D[i]);
     
-    unsigned grant_hp = 0;
-    unsigned grant_lp = 0;
-    unsigned grants   = 0;
-
-
-
-#pragma hls_unroll yes
+    // Nobody affords its packet, the requesters get their quantum
+    bool new_round = reqs_i.or_reduce() && !eligible.or_reduce();
+    sc_uint<CNT_W> d_cur[SIZE];
+    #pragma hls_unroll yes
     for (int i=0; i<SIZE; i++) {
-      
-      // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-      if ( inp[i] && F[i].maxIndex<5) {
-        ActiveList[i] = true;
-        F[i].packetSize[F[i].maxIndex] = inp_size[i];
-        F[i].maxIndex++;
-      }
-      
-      D[i] = ( ActiveList[i] ) ? (D[i] + Q[i]) : 0;
-      // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-      
-      if (i >= priority) {
-        if (F[i].packetSize[0]<=D[i] && ActiveList[i] && !found_hp) {
-          
-          grant_hp = i;
-          found_hp = true;
-        }
-      } else {
-        if (F[i].packetSize[0]<=D[i] && ActiveList[i] && !found_lp) {
-          
-          grant_lp = i;
-          found_lp = true;
-        }
-      }
+      sc_uint<CNT_W+1> d_add = D[i] + Q[i];
+      if (new_round && reqs_i[i]) d_cur[i] = (d_add >= (1<<CNT_W)) ? (sc_uint<CNT_W>)((1<<CNT_W)-1) : (sc_uint<CNT_W>)d_add;
+      else                        d_cur[i] = D[i];
+      eligible[i] = reqs_i[i] && (cost_i[i] <= d_cur[i]);
     }
     
-    grants = (found_hp) ? grant_hp: grant_lp;
+    sc_uint<SIZE> req_lp = eligible & (~priority_therm);
+    sc_uint<SIZE> req_hp = eligible & priority_therm;
     
-    // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    sc_uint<SIZE> grants_lp = ((~req_lp) + 1) & req_lp;
+    sc_uint<SIZE> grants_hp = ((~req_hp) + 1) & req_hp;
     
-    // Update Queue and Deficit Counter for flow i
-    D[grants] = D[grants] - F[grants].packetSize[0];
-#pragma hls_unroll yes
-    for (int i=0; i<4; i++) {
-      F[grants].packetSize[i] = F[grants].packetSize[i+1];
+    bool anygrant = eligible.or_reduce();
+    grants_o = grants_hp.or_reduce() ? grants_hp : grants_lp;
+    
+    // OH to THERM. The granted input keeps the highest priority
+    if (anygrant) priority_therm = ~(grants_o - 1);
+    
+    #pragma hls_unroll yes
+    for (int i=0; i<SIZE; i++) {
+      if      (grants_o[i]) D[i] = d_cur[i] - cost_i[i];
+      else if (!reqs_i[i])  D[i] = 0; // Empty input, as in DRR
+      else                  D[i] = d_cur[i];
     }
-    F[grants].maxIndex--;
     
-    if ( F[grants].maxIndex == 0 ) {
-      ActiveList[grants] = false;
-      D[grants] = 0;
+    return anygrant;
+  };
+};
+
+/* FUNCTION: QoS Priority Arbiter
+ * INPUT:    One-hot vector of requests and the QoS level of each request
+ * OUTPUT:   One-hot vector of grants. Returns true when any request is granted
+ * -----------------------------------------
+ * Only the requests of the highest present QoS level compete. Each level keeps
+ * its own Round Robin state, thus fairness among same-level requests is kept
+ * regardless the higher level traffic. Without QoS levels behaves as ROUND_ROBIN.
+ */
+template<unsigned SIZE>
+class arbiter<SIZE, QOS_RR, 0, 0> {
+public:
+  static const unsigned LEVELS = 8; // 3-bit QoS field of the DNP header
+  
+private:
+  arbiter<SIZE, ROUND_ROBIN> rr_per_lvl[LEVELS];
+
+public:
+  arbiter() {}
+  
+  bool arbitrate(const sc_uint<SIZE> reqs_i, sc_uint<SIZE>& grants_o) {
+    return rr_per_lvl[0].arbitrate(reqs_i, grants_o);
+  };
+  
+  template<class PRIO_T>
+  bool arbitrate(const sc_uint<SIZE> reqs_i, const PRIO_T prio_i[SIZE], sc_uint<SIZE>& grants_o) {
+    // Find the highest level among the active requests
+    unsigned char max_lvl = 0;
+    #pragma hls_unroll yes
+    for (int i=0; i<SIZE; ++i) {
+      if (reqs_i[i] && ((unsigned char)prio_i[i] > max_lvl)) max_lvl = prio_i[i];
     }
     
-    if (found_hp || found_lp && (D[grants]<F[grants].packetSize[0])) {
-      priority = ((grants + 1) == SIZE) ? 0 : (grants+1);
+    sc_uint<SIZE> reqs_top = 0;
+    #pragma hls_unroll yes
+    for (int i=0; i<SIZE; ++i) reqs_top[i] = reqs_i[i] && ((unsigned char)prio_i[i] == max_lvl);
+    
+    // Only the winning level advances its RR pointer
+    bool anygrant = false;
+    grants_o = 0;
+    #pragma hls_unroll yes
+    for (int l=0; l<LEVELS; ++l) {
+      sc_uint<SIZE> lvl_gnt;
+      bool lvl_any = rr_per_lvl[l].arbitrate((l==max_lvl) ? reqs_top : (sc_uint<SIZE>)0, lvl_gnt);
+      if (lvl_any) {
+        anygrant = true;
+        grants_o = lvl_gnt;
+      }
     }
-    // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
     
-    return grants;
+    return anygrant;
+  };
+};
+
+/* FUNCTION: Oldest First Arbiter
+ * INPUT:    One-hot vector of requests and the age of each request
+ * OUTPUT:   One-hot vector of grants. Returns true when any request is granted
+ * -----------------------------------------
+ * Only the requests of the highest age compete, the ties are broken by Round
+ * Robin. The age is the number of routers the packet crossed (flit sideband,
+ * saturating), thus a packet from far away is not outrun at every hop by the
+ * local traffic and the bandwidth is shared fairly among the sources of a
+ * multi-hop path (the parking-lot problem). QoS is ignored.
+ */
+template<unsigned SIZE>
+class arbiter<SIZE, AGE_RR, 0, 0> {
+private:
+  arbiter<SIZE, ROUND_ROBIN> rr;
+
+public:
+  arbiter() {}
+  
+  bool arbitrate(const sc_uint<SIZE> reqs_i, sc_uint<SIZE>& grants_o) {
+    return rr.arbitrate(reqs_i, grants_o);
+  };
+  
+  template<class AGE_T>
+  bool arbitrate(const sc_uint<SIZE> reqs_i, const AGE_T age_i[SIZE], sc_uint<SIZE>& grants_o) {
+    unsigned char max_age = 0;
+    #pragma hls_unroll yes
+    for (int i=0; i<SIZE; ++i) {
+      if (reqs_i[i] && ((unsigned char)age_i[i] > max_age)) max_age = age_i[i];
+    }
+    
+    sc_uint<SIZE> reqs_old = 0;
+    #pragma hls_unroll yes
+    for (int i=0; i<SIZE; ++i) reqs_old[i] = reqs_i[i] && ((unsigned char)age_i[i] == max_age);
+    
+    return rr.arbitrate(reqs_old, grants_o);
+  };
+};
+
+/* FUNCTION: Request aware arbitration of any arbiter type
+ * INPUT:    Arbiter, One-hot vector of requests, the priority (QoS) and the
+ *           cost (packet length in flits, 0 for body flits) of each request
+ * OUTPUT:   One-hot vector of grants. Returns true when any request is granted
+ * -----------------------------------------
+ * Lets the routers be written once for all arbiters. Each arbiter type uses
+ * only the info it needs: QOS_RR the priority, WEIGHTED_RR/DEFICIT_RR the cost.
+ */
+template<class ARB_T>
+struct arb_adapt {
+  template<class REQ_T, class PRIO_T, class COST_T>
+  static inline bool arbitrate(ARB_T& arb, const REQ_T reqs_i, const PRIO_T prio_i[], const COST_T cost_i[], REQ_T& grants_o) {
+    return arb.arbitrate(reqs_i, grants_o);
+  };
+};
+
+template<unsigned SIZE>
+struct arb_adapt< arbiter<SIZE, QOS_RR, 0, 0> > {
+  template<class REQ_T, class PRIO_T, class COST_T>
+  static inline bool arbitrate(arbiter<SIZE, QOS_RR, 0, 0>& arb, const REQ_T reqs_i, const PRIO_T prio_i[], const COST_T cost_i[], REQ_T& grants_o) {
+    return arb.arbitrate(reqs_i, prio_i, grants_o);
+  };
+};
+
+template<unsigned SIZE>
+struct arb_adapt< arbiter<SIZE, AGE_RR, 0, 0> > {
+  template<class REQ_T, class PRIO_T, class COST_T>
+  static inline bool arbitrate(arbiter<SIZE, AGE_RR, 0, 0>& arb, const REQ_T reqs_i, const PRIO_T prio_i[], const COST_T cost_i[], REQ_T& grants_o) {
+    return arb.arbitrate(reqs_i, prio_i, grants_o);
   };
 };
 
+template<unsigned SIZE>
+struct arb_adapt< arbiter<SIZE, WEIGHTED_RR, 0, 0> > {
+  template<class REQ_T, class PRIO_T, class COST_T>
+  static inline bool arbitrate(arbiter<SIZE, WEIGHTED_RR, 0, 0>& arb, const REQ_T reqs_i, const PRIO_T prio_i[], const COST_T cost_i[], REQ_T& grants_o) {
+    return arb.arbitrate(reqs_i, cost_i, grants_o);
+  };
+};
+
+template<unsigned SIZE>
+struct arb_adapt< arbiter<SIZE, DEFICIT_RR, 0, 0> > {
+  template<class REQ_T, class PRIO_T, class COST_T>
+  static inline bool arbitrate(arbiter<SIZE, DEFICIT_RR, 0, 0>& arb, const REQ_T reqs_i, const PRIO_T prio_i[], const COST_T cost_i[], REQ_T& grants_o) {
+    return arb.arbitrate(reqs_i, cost_i, grants_o);
+  };
+};
+
+/* FUNCTION: The priority of a flit's request, for arb_adapt
+ * -----------------------------------------
+ * The QoS of its header, or its age for AGE_RR. AGED tells the routers to
+ * age the flits they forward, otherwise the age stays 0 and is trimmed.
+ */
+template<class ARB_T>
+struct arb_prio {
+  static const bool AGED = false;
+  template<class FLIT_T>
+  static inline unsigned char of(const FLIT_T& flit) { return flit.get_qos(); };
+};
+
+template<unsigned SIZE>
+struct arb_prio< arbiter<SIZE, AGE_RR, 0, 0> > {
+  static const bool AGED = true;
+  template<class FLIT_T>
+  static inline unsigned char of(const FLIT_T& flit) { return flit.get_age(); };
+};
+
 #endif // __ARBITERS_HEADER__
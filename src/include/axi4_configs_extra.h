@@ -1,6 +1,12 @@
 #ifndef __AXI_CONFIG_DUTH_H__
 #define __AXI_CONFIG_DUTH_H__
 
+// Cache line of the ACE configuration in bits, carried in a single CD beat.
+//   The lines span several flits when wider than the CRESP/RRESP flits
+#ifndef ACE_LINE_W
+#define ACE_LINE_W 64
+#endif
+
 namespace axi {
 
 // Extension of Matchlib AXI configuration
@@ -17,7 +23,7 @@ namespace cfg {
       useLast = 1,
       useWriteStrobes = 1,
       useBurst = 1, useFixedBurst = 1, useWrapBurst = 0, maxBurstSize = 256,
-      useQoS = 0, useLock = 0, useProt = 0, useCache = 0, useRegion = 0,
+      useQoS = 1, useLock = 0, useProt = 0, useCache = 0, useRegion = 0,
       aUserWidth = 0, wUserWidth = 0, bUserWidth = 0, rUserWidth = 0,
       addrWidth = 32,
       idWidth = 4,
@@ -34,7 +40,7 @@ namespace cfg {
       useLast = 1,
       useWriteStrobes = 1,
       useBurst = 1, useFixedBurst = 1, useWrapBurst = 0, maxBurstSize = 256,
-      useQoS = 0, useLock = 0, useProt = 0, useCache = 0, useRegion = 0,
+      useQoS = 1, useLock = 0, useProt = 0, useCache = 0, useRegion = 0,
       aUserWidth = 0, wUserWidth = 0, bUserWidth = 0, rUserWidth = 0,
       addrWidth = 32,
       idWidth = 4,
@@ -47,7 +53,7 @@ namespace cfg {
   struct ace {
     enum {
       useACE    = 1,
-      CacheLineWidth = 64, // bits
+      CacheLineWidth = ACE_LINE_W, // bits
       dataWidth = 64,
       useVariableBeatSize = 1,
       useMisalignedAddresses = 0,
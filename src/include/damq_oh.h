@@ -0,0 +1,93 @@
+#ifndef __DAMQ_QUEUE__
+#define __DAMQ_QUEUE__
+
+#include "../include/duth_fun.h"
+#include "../include/nvhls_assert.h"
+
+// Dynamically Allocated Multi-Queue. The SLOTS of an input port are shared by its VCS queues.
+//   Each queue is a linked list through the slots, with one-hot head/tail/next pointers as fifo_queue.
+//   A free slot is taken on push and released on pop. The queue does not reserve slots by itself,
+//   the upstream credits (vc_credits.h) keep each VC's minimum and never overfill the pool.
+template <typename T, unsigned VCS, unsigned SLOTS>
+class damq {
+  public :
+  typedef sc_uint<SLOTS> slot_oh_t;
+
+  T         mem[SLOTS];
+  slot_oh_t nxt[SLOTS];   // Next slot of the same queue
+  slot_oh_t head[VCS];
+  slot_oh_t tail[VCS];
+  slot_oh_t free_slots;   // A bit per free slot
+
+  sc_uint<SLOTS+1> item_count[VCS]; // As fifo_queue, empty when item_count[0]
+
+  public :
+  damq(){
+    reset();
+  };
+
+  void reset () {
+    free_slots = -1;
+    #pragma hls_unroll yes
+    for (int v=0; v<VCS; ++v) {
+      head[v]       = 0;
+      tail[v]       = 0;
+      item_count[v] = 1;
+    }
+  };
+
+  // Non Intrusive
+  inline bool full()             const {return (free_slots==0);};
+  inline bool empty(unsigned vc) const {return (item_count[vc][0]);};
+  inline bool valid(unsigned vc) const {return !empty(vc);};
+
+  // Stored items of a queue, decoded from the one-hot counter
+  inline unsigned count(unsigned vc) const {
+    unsigned cnt = 0;
+    #pragma hls_unroll yes
+    for (int i=0; i<=SLOTS; ++i) if (item_count[vc][i]) cnt = i;
+    return cnt;
+  };
+
+  // And-Or select of the head slot, as the slot count is not limited to the sizes of mux<>
+  inline T peek(unsigned vc) const {
+    T mule = mem[0];
+    #pragma hls_unroll yes
+    for (int s=0; s<SLOTS; ++s) if ((head[vc]>>s) & 1) mule = mem[s];
+    return mule;
+  };
+
+  // A cycle's push and pop, of any queues. Popping an empty queue on push is the bypass of the flit.
+  inline void update(bool pushed, unsigned push_vc, T &push_val, bool popped, unsigned pop_vc) {
+    bool bypassed = pushed && popped && (push_vc==pop_vc) && empty(pop_vc);
+    if (bypassed) return;
+
+    slot_oh_t freed = 0;
+    if (popped) {
+      NVHLS_ASSERT_MSG(!empty(pop_vc), "Popping on EMPTY!");
+      freed = head[pop_vc];
+      slot_oh_t head_nxt = 0;
+      #pragma hls_unroll yes
+      for (int s=0; s<SLOTS; ++s) if ((head[pop_vc]>>s) & 1) head_nxt = nxt[s];
+      head[pop_vc] = item_count[pop_vc][1] ? (slot_oh_t)0 : head_nxt; // The last item leaves the queue empty
+      item_count[pop_vc] = (item_count[pop_vc] >> 1);
+    }
+
+    if (pushed) {
+      NVHLS_ASSERT_MSG(!full(), "Pushing on FULL!");
+      slot_oh_t slot = free_slots & (~free_slots + 1); // Lowest free slot
+      #pragma hls_unroll yes
+      for (int s=0; s<SLOTS; ++s) {
+        if ((slot>>s) & 1) mem[s] = push_val;
+        if (((tail[push_vc]>>s) & 1) && !empty(push_vc)) nxt[s] = slot;
+      }
+      if (empty(push_vc)) head[push_vc] = slot;
+      tail[push_vc]       = slot;
+      item_count[push_vc] = (item_count[push_vc] << 1);
+      free_slots          = free_slots & ~slot;
+    }
+    free_slots = free_slots | freed;
+  };
+};
+
+#endif // #define __DAMQ_QUEUE__
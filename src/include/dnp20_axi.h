@@ -2,18 +2,74 @@
 #define __DNP20_V0_DEF__
 
 
+// Node ID width of the Source/Destination fields, up to 1<<DNP_NODE_W nodes.
+//   The default 4 fits up to 16 nodes, 6 is needed for an 8x8 mesh (src/ic_top_mesh.h)
+//   The phit is widened past 24 bits when the header no longer fits
+#ifndef DNP_NODE_W
+#define DNP_NODE_W 4
+#endif
+
+// Data bytes carried by each data phit, 2 (default) or 4. The phit is widened to fit the bytes with their
+//   enables. Wider AXI beats then take fewer phits, ie a 128-bit beat 4 phits instead of 8.
+//   Beats narrower than a phit's bytes are not supported (AXI size >= log2(DNP_PHIT_BYTES)), unless DNP_NARROW_PACK.
+//   8 bytes would need a phit wider than the 64 bits of sc_uint.
+#ifndef DNP_PHIT_BYTES
+#define DNP_PHIT_BYTES 2
+#endif
+#if (DNP_PHIT_BYTES != 2) && (DNP_PHIT_BYTES != 4)
+#error "DNP_PHIT_BYTES must be 2 or 4"
+#endif
+
+// Short writes. A single beat write that fits the Write Request flit's phits past the header
+//   is sent as one SINGLE flit that carries both the header and the data, instead of HEAD+TAIL.
+//   Needs WREQ_PHITS>3 to have spare phits, eg 4 phits carry 1 beat of up to DNP_PHIT_BYTES.
+#ifndef DNP_SHORT_WR
+#define DNP_SHORT_WR 0
+#endif
+
+// Lookahead output port sideband of the flits, for the routers of RC_METHOD 6. 0 leaves it out of the flit width
+//   and Marshalling, the port then reads 0. The routers of RC_METHOD 6 assert it is set, eg -DDNP_LOOKAHEAD=1
+#ifndef DNP_LOOKAHEAD
+#define DNP_LOOKAHEAD 0
+#endif
+
+// Express mark sideband of the flits, for the express bypass of rtr_vc (EXPRESS>0). 0 leaves it out of the flit
+//   width and Marshalling, the mark then reads 0. The routers of EXPRESS>0 assert it is set, eg -DDNP_EXPRESS=1
+#ifndef DNP_EXPRESS
+#define DNP_EXPRESS 0
+#endif
+
+// Packet age sideband of the flits, for the AGE_RR arbiters. 0 leaves it out of the flit width and Marshalling,
+//   the age then reads 0. The routers of AGE_RR arbiters assert it is set, eg -DDNP_AGE=1
+#ifndef DNP_AGE
+#define DNP_AGE 0
+#endif
+
+// Narrow packing. The data are packed at byte instead of phit granularity, thus consecutive beats narrower
+//   than a phit share it, each byte with its own enable. A phit's Last is set by any of its beats, while the
+//   Read response is carried per byte, thus each beat keeps its own. Wider beats are packed as without it.
+//   Supported by axi_master_if and axi_slave_if.
+#ifndef DNP_NARROW_PACK
+#define DNP_NARROW_PACK 0
+#endif
+
 // Definition of Duth Network Protocol.
 //   Interconnect's internal packetization protocol 
 namespace dnp {
     enum {
-      PHIT_W = 24, // Phit Width
-      
       V_W = 2, // Virtual Channel
-      S_W = 4, // Source
-      D_W = 4, // Destination
+      S_W = DNP_NODE_W, // Source
+      D_W = DNP_NODE_W, // Destination
       Q_W = 3, // QoS
       T_W = 2, // Type
       
+      NP_W = 3, // Next router's output port. Flit sideband for Lookahead RC, under DNP_LOOKAHEAD
+      EX_W = 1, // Express mark. Flit sideband for the express bypass of rtr_vc, under DNP_EXPRESS
+      AG_W = 4, // Packet age, the routers it crossed. Flit sideband for the AGE_RR arbiters, under DNP_AGE
+      PR_W = (AG_W>Q_W) ? AG_W : Q_W, // Arbitration priority, the QoS or the age
+      MC_W = (D_W>6) ? 64 : (1<<D_W), // Multicast destination mask. Not carried by AXI flits, which are always unicast
+      PL_W = 10, // Packet length in flits, charged by the packet-aware arbiters. Not carried, derived from the header
+      
       V_PTR = 0,
       S_PTR = (V_PTR + V_W),
       D_PTR = (S_PTR + S_W),
@@ -30,10 +86,29 @@ namespace dnp {
       AP_W = 8, // Address part (for alignment)
       RE_W = 2, // AXI Write Responce
       REORD_W = 3, // Ticket for reorder buffer
+      REORD_H_W = 3, // Ticket extension (MSBs) for larger reorder buffers. Placed past the header phit
   
       B_W  = 8, // Byte Width ...
       E_W  = 1, // Enable width
       LA_W = 1, // AXI Last
+      
+      BPP   = DNP_PHIT_BYTES,   // Data Bytes Per Phit
+      BPP_W = (BPP==4) ? 2 : 1, // log2(BPP), the phit/byte pointer shifts
+      SHORT_WR = DNP_SHORT_WR,  // Single flit short writes
+      NARROW_PACK = DNP_NARROW_PACK,            // Byte granularity data packing
+      PACK_GRAN_W = (NARROW_PACK) ? 0 : BPP_W,  // log2 of the packing unit in bytes, a byte or a phit
+      PACK_GRAN   = 1<<PACK_GRAN_W,
+      
+      RE_UNITS = BPP>>PACK_GRAN_W, // Read responses per data phit, one per packing unit
+      
+      HDR_PHIT_W   = T_PTR+T_W+ID_W+REORD_W+RE_W, // The widest header phit (Write Response)
+      WDATA_PHIT_W = BPP*(B_W+E_W)+LA_W,
+      RDATA_PHIT_W = BPP*B_W+RE_UNITS*RE_W+LA_W,
+      DATA_PHIT_W  = (WDATA_PHIT_W>RDATA_PHIT_W) ? WDATA_PHIT_W : RDATA_PHIT_W,
+      
+      // Phit Width. 24, unless the headers or the data bytes do not fit
+      PHIT_W = (HDR_PHIT_W>24 && HDR_PHIT_W>=DATA_PHIT_W) ? HDR_PHIT_W  :
+               (DATA_PHIT_W>24)                          ? DATA_PHIT_W : 24,
     };
   
   // Read and Write Request field pointers
@@ -48,6 +123,10 @@ namespace dnp {
       AH_PTR = 0,
       SZ_PTR = AH_PTR+AH_W,
       BU_PTR = SZ_PTR+SZ_W,
+      REORD_H_PHIT = 2,
+      REORD_H_PTR  = BU_PTR+BU_W,
+      
+      WDATA_PHIT = 3, // First data phit of a short write, past the 3 header phits
     };
   };
   
@@ -57,6 +136,9 @@ namespace dnp {
       ID_PTR    = T_PTR+T_W,
       REORD_PTR = ID_PTR+ID_W,
       RESP_PTR  = REORD_PTR+REORD_W,
+      
+      REORD_H_PHIT = 1, // Requires WRESP_PHITS>1
+      REORD_H_PTR  = 0,
     };
   };
   
@@ -70,27 +152,29 @@ namespace dnp {
       SZ_PTR = 0,
       LE_PTR = SZ_PTR+SZ_W,
       AP_PTR = LE_PTR+LE_W,
+      REORD_H_PHIT = 1,
+      REORD_H_PTR  = AP_PTR+AP_W,
     };
   };
   
-  // Write request Data field pointers
+  // Write request Data field pointers. Byte b at B0_PTR+b*B_W, its enable at E0_PTR+b*E_W
   struct wdata {
     enum {
       B0_PTR = 0,
       B1_PTR = B0_PTR+B_W,
-      E0_PTR = B1_PTR+B_W,
+      E0_PTR = B0_PTR+BPP*B_W,
       E1_PTR = E0_PTR+E_W,
-      LA_PTR = E1_PTR+E_W,
+      LA_PTR = E0_PTR+BPP*E_W,
     };
   };
   
-  // Read response Data field pointers
+  // Read response Data field pointers. Byte b at B0_PTR+b*B_W
   struct rdata {
     enum {
       B0_PTR = 0,
       B1_PTR = B0_PTR+B_W,
-      RE_PTR = B1_PTR+B_W,
-      LA_PTR = RE_PTR+RE_W,
+      RE_PTR = B0_PTR+BPP*B_W, // The response of packing unit k at RE_PTR+k*RE_W
+      LA_PTR = RE_PTR+RE_UNITS*RE_W,
     };
   };
   
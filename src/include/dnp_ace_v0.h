@@ -2,24 +2,54 @@
 #define __DNP_ACE_DEF__
 
 
+// Node ID width of the Source/Destination fields, up to 1<<DNP_NODE_W nodes.
+//   The snoop multicast mask has a bit per node, thus the phit grows past 24 bits above 3
+#ifndef DNP_NODE_W
+#define DNP_NODE_W 3
+#endif
+
+// Lookahead output port sideband of the flits, for the routers of RC_METHOD 6. 0 leaves it out of the flit width
+//   and Marshalling, the port then reads 0. The routers of RC_METHOD 6 assert it is set, eg -DDNP_LOOKAHEAD=1
+#ifndef DNP_LOOKAHEAD
+#define DNP_LOOKAHEAD 0
+#endif
+
+// Packet age sideband of the flits, for the AGE_RR arbiters. 0 leaves it out of the flit width and Marshalling,
+//   the age then reads 0. The routers of AGE_RR arbiters assert it is set, eg -DDNP_AGE=1
+#ifndef DNP_AGE
+#define DNP_AGE 0
+#endif
+
+// Cache line in bits, as axi::cfg::ace (axi4_configs_extra.h)
+#ifndef ACE_LINE_W
+#define ACE_LINE_W 64
+#endif
+
 // Definition of Duth Network Protocol for ACE network.
 //   Interconnect's internal packetization protocol 
 namespace dnp {
   enum {
-    // !!!! THIS MUST BE 24. 20 is temp for router synth!!!
-    PHIT_W = 24, // Phit Width
-
     V_W = 2, // Virtual Channel
-    S_W = 3, // Source
-    D_W = 3, // Destination
+    S_W = DNP_NODE_W, // Source
+    D_W = DNP_NODE_W, // Destination
     Q_W = 3, // QoS
     T_W = 3, // Type
+    
+    NP_W = 3, // Next router's output port. Flit sideband for Lookahead RC, under DNP_LOOKAHEAD
+    AG_W = 4, // Packet age, the routers it crossed. Flit sideband for the AGE_RR arbiters, under DNP_AGE
+    PR_W = (AG_W>Q_W) ? AG_W : Q_W, // Arbitration priority, the QoS or the age
+    MC_W = (1<<D_W), // Multicast destination mask. One bit per node ID
+    PL_W = 10, // Packet length in flits, charged by the packet-aware arbiters. Not carried, derived from the header
 
     V_PTR = 0,
     S_PTR = (V_PTR + V_W),
     D_PTR = (S_PTR + S_W),
     Q_PTR = (D_PTR + D_W),
     T_PTR = (Q_PTR + Q_W),
+
+    // !!!! THIS MUST BE 24. 20 is temp for router synth!!!
+    //   Unless the header (Request ID+DOM+SNP, 10 bits, or the snoop multicast mask) does not fit
+    PHIT_W = ((T_PTR+T_W+((MC_W>10) ? MC_W : 10)) > 24) ? (T_PTR+T_W+((MC_W>10) ? MC_W : 10)) : 24, // Phit Width
   };
   
   class ace {
@@ -50,6 +80,8 @@ namespace dnp {
       C_PROT_W = 3,
       C_RESP_W = 5,
       C_HAS_DATA_W = 1,
+      
+      LINE_B = ACE_LINE_W/8, // Cache line bytes, carried by the Snoop data responses
     };
     
     struct req {
@@ -135,6 +167,10 @@ namespace dnp {
     // ACE Extension
     struct creq {
       enum {
+        // PHIT #0
+        MC_PHIT = 0,
+        
+        MC_PTR = T_PTR+T_W, // Multicast mask. When zero the snoop is unicast to D
         // PHIT #1
         AL_PHIT  = 1,
         SNP_PHIT = 1,
@@ -147,9 +183,21 @@ namespace dnp {
         
         AH_PTR = 0,
         C_PROT_PTR = AH_PTR+AH_W,
+        C_DCT_PTR  = C_PROT_PTR+C_PROT_W, // Direct transfer, the line goes to the initiator instead of HOME
+        C_SOLE_PTR = C_DCT_PTR+1,         // The only Snoop of the transaction, thus its IsShared is final
+        // PHIT #3, Direct transfer only. The initiator and its response header
+        R_HDR_PHIT = 3,
+        
+        R_ID_PTR   = 0,
+        R_BU_PTR   = R_ID_PTR+ID_W,
+        R_SZ_PTR   = R_BU_PTR+BU_W,
+        R_LE_PTR   = R_SZ_PTR+SZ_W,
+        R_INIT_PTR = R_LE_PTR+LE_W,
       };
     };
     
+    // A response with data is followed by the line, of wdata phits (bytes and LA) ending at a TAIL flit.
+    //   C_HAS_DATA marks that the line follows, a DataTransfer response without it was sent directly to the initiator
     struct cresp {
       enum {
         // PHIT #0
@@ -270,10 +270,33 @@ sc_uint<8> wb2oh_case (const sc_uint< clog2<8>::val > wb_i) {
 //============================================================================//
 //============================== Mux Container Struct ========================//
 //============================================================================//
+// Sizes beyond the case based ones below are a tree of them. Each level selects between its two halves
+//   by the or-reduce of the upper one's select, thus log depth for any radix
 template <class T, int SIZE> struct mux {
-  static T mux_oh_case(const sc_uint<SIZE> sel_i, const T data_i[SIZE]);
-  static T mux_oh_case(const onehot<SIZE> sel_i, const T data_i[SIZE]);
-  static T mux_oh_ao(const sc_uint<SIZE> sel_i, const T data_i[SIZE]);
+  static const int LO = SIZE/2;
+  static const int HI = SIZE-LO;
+  
+  static T mux_oh_case(const sc_uint<SIZE> sel_i, const T data_i[SIZE]) {
+    sc_uint<LO> sel_lo = sel_i.range(LO-1, 0);
+    sc_uint<HI> sel_hi = sel_i.range(SIZE-1, LO);
+    T selected_lo = mux<T, LO>::mux_oh_case(sel_lo, data_i);
+    T selected_hi = mux<T, HI>::mux_oh_case(sel_hi, data_i+LO);
+    return sel_hi.or_reduce() ? selected_hi : selected_lo;
+  };
+  
+  static T mux_oh_case(const onehot<SIZE> sel_i, const T data_i[SIZE]) {
+    return mux_oh_case(sel_i.val, data_i);
+  };
+  
+  static T mux_oh_ao(const sc_uint<SIZE> sel_i, const T data_i[SIZE]) {
+    T selected = T();
+#pragma hls_unroll yes
+    for(int i=0; i<SIZE; ++i) {
+      bool cur_sel_bit = (sel_i >> i) & 1;
+      selected = selected | data_i[i].and_mask(cur_sel_bit);
+    }
+    return selected;
+  };
 };
 //============================================================================//
 //======================== One-Hot Multiplexer (case based) ==================//
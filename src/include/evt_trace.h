@@ -0,0 +1,162 @@
+#ifndef __EVT_TRACE_H__
+#define __EVT_TRACE_H__
+
+// Low overhead event tracing, in place of the per transaction std::cout logs. Simulation only.
+//   Events are fixed size binary records (module, type, id, addr, arg, sc_time_stamp) logged into a
+//   ring buffer per module. The rings are dumped in a single file at the end of the simulation
+//   (evt_trace_dump), to be decoded offline to text or Chrome/Perfetto JSON by examples/evt_decode.py
+//   EVT_TRACE_LEVEL : Compile time verbosity. Events above it are compiled out, 0 (default) disables all.
+//                     1 : Transactions at the master/slave/home boundaries, 2 : also their data beats
+//   EVT_TRACE_TEXT  : 1 also prints the events as text when they happen (the previous std::cout logs)
+//   EVT_TRACE_DEPTH : Events kept per module (power of 2). The oldest ones are overwritten
+#ifndef EVT_TRACE_LEVEL
+#define EVT_TRACE_LEVEL 0
+#endif
+#ifndef EVT_TRACE_TEXT
+#define EVT_TRACE_TEXT  0
+#endif
+#ifndef EVT_TRACE_DEPTH
+#define EVT_TRACE_DEPTH (1<<16)
+#endif
+
+#define EVT_LVL_TXN  1
+#define EVT_LVL_BEAT 2
+
+#ifndef __SYNTHESIS__
+
+#include <cstdio>
+#include <cstring>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+// Fixed set of event types, their names are stored in the dump for the decoder
+enum evt_type {
+  EVT_AR = 0, EVT_AW, EVT_W, EVT_R, EVT_B,        // Master : pushed AR/AW/W, accepted the last R and B
+  EVT_S_AR, EVT_S_AW, EVT_S_W, EVT_S_R, EVT_S_B,  // Slave  : accepted AR/AW/W, pushed R and B
+  EVT_AC, EVT_CR, EVT_CD, EVT_RACK, EVT_WACK,     // ACE Master : snoop request (id:snoop, arg:hit), response, data and the RD/WR acknowledges
+  EVT_HOME_RD, EVT_HOME_WR,                       // HOME : admitted a coherent RD/WR
+  EVT_HOME_RACK, EVT_HOME_WACK,                   // HOME : got the final RD/WR acknowledge
+  EVT_TYPES
+};
+
+static const char * const evt_type_name[EVT_TYPES] = {
+  "AR", "AW", "W", "R", "B",
+  "S_AR", "S_AW", "S_W", "S_R", "S_B",
+  "AC", "CR", "CD", "RACK", "WACK",
+  "HOME_RD", "HOME_WR",
+  "HOME_RACK", "HOME_WACK"
+};
+
+struct evt_rec {
+  uint64_t time_ps;
+  uint64_t addr;
+  uint32_t arg;   // Event specific, ie the burst len or the initiator
+  uint16_t id;    // Transaction ID
+  uint16_t type;  // evt_type
+};
+
+class evt_ring;
+
+// All the rings of the simulation
+class evt_registry {
+public:
+  std::vector<evt_ring *> rings;
+
+  static evt_registry & get() {
+    static evt_registry reg;
+    return reg;
+  };
+
+  void add(evt_ring *ring)    { rings.push_back(ring); };
+  void remove(evt_ring *ring) { rings.erase(std::remove(rings.begin(), rings.end(), ring), rings.end()); };
+
+  inline bool dump(const char *fname);
+};
+
+class evt_ring {
+public:
+  std::string            name;
+  std::vector<evt_rec>   buf;    // Allocated on the first event
+  unsigned long long int logged;
+
+  evt_ring() : logged(0) {};
+  ~evt_ring() { evt_registry::get().remove(this); };
+
+  void init(const char *name_) {
+    name = name_;
+    evt_registry::get().add(this);
+  };
+
+  void log(evt_type type, unsigned id, unsigned long long int addr, unsigned arg) {
+    if (buf.empty()) buf.resize(EVT_TRACE_DEPTH);
+    evt_rec &rec = buf[logged & (EVT_TRACE_DEPTH-1)];
+    rec.time_ps = (uint64_t)(sc_time_stamp().to_seconds()*1e12 + 0.5);
+    rec.addr    = addr;
+    rec.arg     = arg;
+    rec.id      = id;
+    rec.type    = type;
+    logged++;
+  };
+};
+
+// File : "NOCPEVT1", type count, type names (length, chars), ring count,
+//        per ring : name (length, chars), logged, stored, records oldest first
+inline bool evt_registry::dump(const char *fname) {
+  FILE *fp = std::fopen(fname, "wb");
+  if (!fp) return false;
+  std::fwrite("NOCPEVT1", 1, 8, fp);
+  uint32_t n = EVT_TYPES;
+  std::fwrite(&n, sizeof(n), 1, fp);
+  for (int t=0; t<EVT_TYPES; ++t) {
+    uint32_t len = std::strlen(evt_type_name[t]);
+    std::fwrite(&len, sizeof(len), 1, fp);
+    std::fwrite(evt_type_name[t], 1, len, fp);
+  }
+  n = rings.size();
+  std::fwrite(&n, sizeof(n), 1, fp);
+  for (unsigned r=0; r<rings.size(); ++r) {
+    const evt_ring &ring = *rings[r];
+    uint32_t len    = ring.name.size();
+    uint64_t logged = ring.logged;
+    uint32_t stored = (ring.logged < EVT_TRACE_DEPTH) ? ring.logged : EVT_TRACE_DEPTH;
+    std::fwrite(&len, sizeof(len), 1, fp);
+    std::fwrite(ring.name.data(), 1, len, fp);
+    std::fwrite(&logged, sizeof(logged), 1, fp);
+    std::fwrite(&stored, sizeof(stored), 1, fp);
+    for (uint64_t i=logged-stored; i<logged; ++i) std::fwrite(&ring.buf[i & (EVT_TRACE_DEPTH-1)], sizeof(evt_rec), 1, fp);
+  }
+  std::fclose(fp);
+  return true;
+}
+
+// Called by the harness at the end of the simulation. Nothing is written when tracing is compiled out.
+inline void evt_trace_dump(const char *fname) {
+  if (EVT_TRACE_LEVEL > 0) {
+    if (evt_registry::get().dump(fname)) std::printf("Event trace dumped to %s\n", fname);
+    else                                 std::printf("Event trace dump to %s FAILED\n", fname);
+  }
+}
+
+// Logs an event of verbosity LVL on RING. The trailing statement prints it as text when EVT_TRACE_TEXT.
+// Disabled levels are constant false, thus neither the event nor the text arguments are evaluated.
+#define EVT_TRACE(LVL, RING, TYPE, ID, ADDR, ARG, ...)                 \
+  do {                                                                 \
+    if ((LVL) <= EVT_TRACE_LEVEL) {                                    \
+      (RING).log((TYPE), (ID), (ADDR), (ARG));                         \
+      if (EVT_TRACE_TEXT) { __VA_ARGS__; }                             \
+    }                                                                  \
+  } while (0)
+
+#else  // __SYNTHESIS__
+
+// Empty, for the testbench modules that are compiled along
+struct evt_ring { void init(const char *) {}; };
+inline void evt_trace_dump(const char *) {}
+
+#define EVT_TRACE(LVL, RING, TYPE, ID, ADDR, ARG, ...)
+
+#endif // __SYNTHESIS__
+
+#endif // __EVT_TRACE_H__
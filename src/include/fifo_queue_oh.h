@@ -35,6 +35,14 @@ class fifo_queue {
   inline bool empty() const {return (item_count[0]);};
   inline bool valid() const {return !empty();};
   
+  // Stored items, decoded from the one-hot counter
+  inline unsigned count() const {
+    unsigned cnt = 0;
+    #pragma hls_unroll yes
+    for (int i=0; i<=SIZE; ++i) if (item_count[i]) cnt = i;
+    return cnt;
+  };
+  
   inline T peek()     const {
     //mem[pop_ptr];
     return mux<T, SIZE>::mux_oh_case(pop_ptr, mem);
@@ -5,6 +5,7 @@
 #include "nvhls_connections.h"
 
 #include "./dnp_ace_v0.h"
+#include "./flit_ts.h"
 
 #ifndef __SYNTHESIS__
 	#include <string>
@@ -16,10 +17,18 @@ enum FLIT_TYPE {HEAD=0 , BODY=1, TAIL=3, SINGLE=2};
 template<unsigned char PHIT_NUM>
 struct flit_dnp {
   sc_uint<2>  type;
+  sc_uint<dnp::NP_W> nxt_port; // Lookahead RC : output port to request at the next router. Set only under DNP_LOOKAHEAD
+  sc_uint<dnp::AG_W> age;      // Age : routers crossed, saturating. Set only under the AGE_RR arbiters and DNP_AGE
   //sc_uint<32> dbg_id;
   sc_uint<dnp::PHIT_W> data[PHIT_NUM];
+#if FLIT_TS_ON
+  flit_ts ts; // Simulation only sideband, not Marshalled
+#endif
   
-  static const int width = 2+(PHIT_NUM*dnp::PHIT_W); // Matchlib Marshaller requirement
+  static const int width = 2+(DNP_LOOKAHEAD ? dnp::NP_W : 0)+(DNP_AGE ? dnp::AG_W : 0)+(PHIT_NUM*dnp::PHIT_W); // Matchlib Marshaller requirement
+  static const bool HAS_AGE = DNP_AGE; // The age sideband is carried, for the AGE_RR routers
+  static const bool HAS_LOOKAHEAD = DNP_LOOKAHEAD; // The lookahead port is carried, for the routers of RC_METHOD 6
+  static const bool HAS_EXPRESS = false; // No express mark, ACE flits are not routed by express routers
   
   // helping functions to retrieve flit info (e.g. flit type, source, destination)
 	inline bool performs_rc()   { return ((type == HEAD) || (type == SINGLE)); }
@@ -35,6 +44,30 @@ struct flit_dnp {
   inline sc_uint<dnp::S_W> get_src()  const {return ((data[0] >> dnp::S_PTR) & ((1<<dnp::S_W)-1));};
   inline sc_uint<dnp::T_W> get_type() const {return ((data[0] >> dnp::T_PTR) & ((1<<dnp::T_W)-1));};
   inline sc_uint<dnp::V_W> get_vc()   const {return ((data[0] >> dnp::V_PTR) & ((1<<dnp::V_W)-1));};
+  inline sc_uint<dnp::NP_W> get_nxt_port() const {return DNP_LOOKAHEAD ? nxt_port : (sc_uint<dnp::NP_W>)0;};
+  inline sc_uint<dnp::AG_W> get_age() const {return DNP_AGE ? age : (sc_uint<dnp::AG_W>)0;};
+  inline sc_uint<dnp::MC_W> get_mcast_dst() const {return (sc_uint<dnp::MC_W>)(data[0] >> dnp::ace::creq::MC_PTR);}; // Truncated to MC_W
+  // Packet length in flits, as charged by the packet-aware arbiters. Valid at HEAD/SINGLE flits.
+  //   The header plus the flits the burst occupies at 2 bytes per phit. Saturates at PL_W
+  inline sc_uint<dnp::PL_W> get_pack_len() const {
+    if (type==SINGLE) return 1;
+    
+    sc_uint<dnp::ace::LE_W> len;
+    sc_uint<dnp::ace::SZ_W> size;
+    if ((get_type()==dnp::PACK_TYPE__WR_REQ) || (get_type()==dnp::PACK_TYPE__C_WR_REQ)) {
+      len  = (data[(PHIT_NUM>1) ? 1 : 0] >> dnp::ace::req::LE_PTR) & ((1<<dnp::ace::LE_W)-1);
+      size = (data[(PHIT_NUM>2) ? 2 : 0] >> dnp::ace::req::SZ_PTR) & ((1<<dnp::ace::SZ_W)-1);
+    } else if ((get_type()==dnp::PACK_TYPE__RD_RESP) || (get_type()==dnp::PACK_TYPE__C_RD_RESP)) {
+      len  = (data[(PHIT_NUM>1) ? 1 : 0] >> dnp::ace::rresp::LE_PTR) & ((1<<dnp::ace::LE_W)-1);
+      size = (data[(PHIT_NUM>1) ? 1 : 0] >> dnp::ace::rresp::SZ_PTR) & ((1<<dnp::ace::SZ_W)-1);
+    } else {
+      // Snoop data responses carry no length, charged as header plus the line
+      return 1 + (dnp::ace::LINE_B + (PHIT_NUM<<1) - 1) / (PHIT_NUM<<1);
+    }
+    sc_uint<dnp::ace::LE_W+8> bytes = ((sc_uint<dnp::ace::LE_W+8>)len+1) << size;
+    sc_uint<dnp::ace::LE_W+8> flits = 1 + (bytes + (PHIT_NUM<<1) - 1) / (PHIT_NUM<<1);
+    return (flits >= (1<<dnp::PL_W)) ? (sc_uint<dnp::PL_W>)((1<<dnp::PL_W)-1) : (sc_uint<dnp::PL_W>)flits;
+  };
   inline sc_uint<dnp::Q_W> get_qos()   const {return ((data[0] >> dnp::Q_PTR) & ((1<<dnp::Q_W)-1));};
   
   inline void set_dst(sc_uint<dnp::D_W>  dst ) { data[0] = (data[0].range(dnp::PHIT_W-1, dnp::D_PTR+dnp::D_W) << (dnp::D_PTR+dnp::D_W)) |
@@ -49,6 +82,12 @@ struct flit_dnp {
                                                                 (type  << dnp::T_PTR) |
                                                                 (data[0].range(dnp::T_PTR-1, 0));
   };
+  inline void set_nxt_port(sc_uint<dnp::NP_W> np) { if (DNP_LOOKAHEAD) nxt_port = np; };
+  inline void inc_age() { if (DNP_AGE && (age != ((1<<dnp::AG_W)-1))) age = age+1; };
+  inline void set_mcast_dst(sc_uint<dnp::MC_W> mc) { data[0] = (data[0].range(dnp::PHIT_W-1, dnp::ace::creq::MC_PTR+dnp::MC_W) << (dnp::ace::creq::MC_PTR+dnp::MC_W)) |
+                                                                ((sc_uint<dnp::PHIT_W>)mc << dnp::ace::creq::MC_PTR) |
+                                                                (data[0].range(dnp::ace::creq::MC_PTR-1, 0));
+  };
   inline void set_vc(sc_uint<dnp::V_W>   vc  ) { data[0] = (data[0].range(dnp::PHIT_W-1, dnp::V_PTR+dnp::V_W) << (dnp::V_PTR+dnp::V_W)) |
                                                                 (vc  << dnp::V_PTR) ;
                                                                 //(data[0].range(dnp::V_PTR-1, 0));
@@ -101,6 +140,35 @@ struct flit_dnp {
                     ((sc_uint<dnp::PHIT_W>)(snoop_req.addr >> dnp::ace::AL_W) << dnp::ace::creq::AH_PTR) ;
   };
   
+  // Direct transfer of a Snoop. The snooped master sends the line to init, as the response to rd_req
+  template<typename T>
+  inline void set_snoop_dct (bool dct, bool sole, sc_uint<dnp::S_W> init, const T& rd_req) {
+    const unsigned char HDR = (PHIT_NUM>dnp::ace::creq::R_HDR_PHIT) ? dnp::ace::creq::R_HDR_PHIT : 0;
+    this->data[2] = (this->data[2] & ~(((sc_uint<dnp::PHIT_W>)3) << dnp::ace::creq::C_DCT_PTR)) |
+                    ((sc_uint<dnp::PHIT_W>) dct  << dnp::ace::creq::C_DCT_PTR ) |
+                    ((sc_uint<dnp::PHIT_W>) sole << dnp::ace::creq::C_SOLE_PTR) ;
+    if (HDR>0) {
+      this->data[HDR] = ((sc_uint<dnp::PHIT_W>) init         << dnp::ace::creq::R_INIT_PTR) |
+                        ((sc_uint<dnp::PHIT_W>) rd_req.len   << dnp::ace::creq::R_LE_PTR  ) |
+                        ((sc_uint<dnp::PHIT_W>) rd_req.size  << dnp::ace::creq::R_SZ_PTR  ) |
+                        ((sc_uint<dnp::PHIT_W>) rd_req.burst << dnp::ace::creq::R_BU_PTR  ) |
+                        ((sc_uint<dnp::PHIT_W>) rd_req.id    << dnp::ace::creq::R_ID_PTR  ) ;
+    }
+  };
+  inline bool get_snoop_dct()  const {return ((data[2] >> dnp::ace::creq::C_DCT_PTR)  & 1);};
+  inline bool get_snoop_sole() const {return ((data[2] >> dnp::ace::creq::C_SOLE_PTR) & 1);};
+  
+  // The response header of a direct transfer, and its initiator
+  template<typename T>
+  inline sc_uint<dnp::S_W> get_snoop_dct_hdr (T& rd_req) const {
+    const unsigned char HDR = (PHIT_NUM>dnp::ace::creq::R_HDR_PHIT) ? dnp::ace::creq::R_HDR_PHIT : 0;
+    rd_req.id    = (this->data[HDR] >> dnp::ace::creq::R_ID_PTR) & ((1<<dnp::ace::ID_W)-1);
+    rd_req.burst = (this->data[HDR] >> dnp::ace::creq::R_BU_PTR) & ((1<<dnp::ace::BU_W)-1);
+    rd_req.size  = (this->data[HDR] >> dnp::ace::creq::R_SZ_PTR) & ((1<<dnp::ace::SZ_W)-1);
+    rd_req.len   = (this->data[HDR] >> dnp::ace::creq::R_LE_PTR) & ((1<<dnp::ace::LE_W)-1);
+    return ((this->data[HDR] >> dnp::ace::creq::R_INIT_PTR) & ((1<<dnp::S_W)-1));
+  };
+  
   template<typename T>
   inline void set_rd_resp (const T& rd_req) {
     this->data[0] = ((sc_uint<dnp::PHIT_W>) rd_req.burst   << dnp::ace::rresp::BU_PTR) |
@@ -142,7 +210,9 @@ struct flit_dnp {
   
   // Flit Constructors
   flit_dnp () {
-    type = 0;
+    type     = 0;
+    nxt_port = 0;
+    age      = 0;
     #pragma hls_unroll yes
     for(int i=0; i<PHIT_NUM; ++i)
       data[i] = 0;
@@ -150,6 +220,8 @@ struct flit_dnp {
 
   flit_dnp(FLIT_TYPE _type, short int _src, short int _dst) {
     type    = _type;
+    nxt_port = 0;
+    age      = 0;
     data[0] = 0                 |
               (_src << dnp::S_PTR) |
               (_dst << dnp::D_PTR) ;
@@ -158,25 +230,32 @@ struct flit_dnp {
   // Flit operators
 	inline flit_dnp& operator = (const flit_dnp& rhs) {
 		type   = rhs.type;
+		nxt_port = rhs.nxt_port;
+		age      = rhs.age;
 		//dbg_id = rhs.dbg_id;
 	  #pragma hls_unroll yes
     for(int i=0; i<PHIT_NUM; ++i) data[i] = rhs.data[i];
+    FLIT_TS_DO(ts = rhs.ts;)
 
 		return *this;
 	};
   
   inline flit_dnp& operator = (const flit_dnp* rhs) {
 		type   = rhs->type;
+		nxt_port = rhs->nxt_port;
+		age      = rhs->age;
     //dbg_id = rhs->dbg_id;
 	  #pragma hls_unroll yes
     for(int i=0; i<PHIT_NUM; ++i) data[i] = rhs->data[i];
+    FLIT_TS_DO(ts = rhs->ts;)
 
 		return *this;
 	};
 
 	inline bool operator==(const flit_dnp& rhs) const {
-    bool eq = (rhs.type == type);
+    bool eq = (rhs.type == type) && (rhs.nxt_port == nxt_port);
     for(int i=0; i<PHIT_NUM; ++i) eq = eq && (data[i] == rhs.data[i]);
+    FLIT_TS_DO(eq = eq && (ts == rhs.ts);)
     return eq;
 	}
 
@@ -187,8 +266,11 @@ struct flit_dnp {
   inline flit_dnp operator | (const flit_dnp& rhs) {
 	  flit_dnp mule;
 	  mule.type = type | rhs.type;
+	  mule.nxt_port = nxt_port | rhs.nxt_port;
+	  mule.age      = age      | rhs.age;
     #pragma hls_unroll yes
     for(int i=0; i<PHIT_NUM; ++i) mule.data[i] = data[i] | rhs.data[i];
+    FLIT_TS_DO(mule.ts = ts | rhs.ts;)
     
     return mule;
   };
@@ -197,8 +279,11 @@ struct flit_dnp {
   inline flit_dnp operator & (const flit_dnp& rhs) {
     flit_dnp mule;
     mule.type = type & rhs.type;
+    mule.nxt_port = nxt_port & rhs.nxt_port;
+    mule.age      = age      & rhs.age;
     #pragma hls_unroll yes
     for(int i=0; i<PHIT_NUM; ++i) mule.data[i] = data[i] & rhs.data[i];
+    FLIT_TS_DO(mule.ts = ts & rhs.ts;)
     
     return mule;
   };
@@ -212,8 +297,11 @@ struct flit_dnp {
     for(int j=0; j<dnp::PHIT_W; ++j) mask[j] = mask[j] | (bit << j);
     
     mule.type = type & mask; //((mask<<1) | bit);
+    mule.nxt_port = nxt_port & mask;
+    mule.age      = age      & mask;
     #pragma hls_unroll yes
     for(int i=0; i<PHIT_NUM; ++i) mule.data[i] = data[i] & mask;
+    FLIT_TS_DO(mule.ts = ts.and_mask(bit);)
     
     return mule;
   };
@@ -251,6 +339,8 @@ struct flit_dnp {
   // Only for SystemC
   inline friend void sc_trace(sc_trace_file* tf, const flit_dnp& flit, const std::string& name) {
 		sc_trace(tf, flit.type, name + ".type");
+		sc_trace(tf, flit.nxt_port, name + ".nxt_port");
+		sc_trace(tf, flit.age, name + ".age");
 		//sc_trace(tf, flit.dbg_id, name + ".dbg_id");
     for(int i=0; i<PHIT_NUM; ++i)
       sc_trace(tf, flit.data[i], name + ".data");
@@ -262,6 +352,12 @@ struct flit_dnp {
   void Marshall(Marshaller<Size>& m) {
     //m& dbg_id;
     m& type;
+#if DNP_LOOKAHEAD
+    m& nxt_port;
+#endif
+#if DNP_AGE
+    m& age;
+#endif
     #pragma hls_unroll yes
     //for(int i=0; i<PHIT_NUM; ++i) m& data[i];
     for(int i=PHIT_NUM-1; i>=0; --i) m& data[i];
@@ -280,6 +376,9 @@ struct flit_ack {
     sc_uint<1>        wack;
     
     static const int width = 2+dnp::S_W+dnp::D_W+1+1; // Matchlib Marshaller requirement
+    static const bool HAS_AGE = true; // ACKs carry no age, they are served as the youngest
+    static const bool HAS_LOOKAHEAD = false; // ACKs carry no lookahead port
+    static const bool HAS_EXPRESS = false; // nor express mark
     
     flit_ack(unsigned type_=0, unsigned src_=0, unsigned dst_=0, bool rack_=0, bool wack_=0) :
             type(type_), src(src_), dst(dst_), rack(rack_), wack(wack_)
@@ -297,6 +396,15 @@ struct flit_ack {
     inline sc_uint<dnp::D_W> get_dst()  const {return dst;};
     inline sc_uint<dnp::S_W> get_src()  const {return src;};
     inline sc_uint<dnp::T_W> get_type()  const {return 0;};
+    inline sc_uint<dnp::Q_W> get_qos()   const {return 0;}; // ACKs carry no QoS
+    // ACKs are always unicast and are not routed by lookahead
+    inline sc_uint<dnp::NP_W> get_nxt_port()  const {return 0;};
+    inline sc_uint<dnp::MC_W> get_mcast_dst() const {return 0;};
+    inline sc_uint<dnp::PL_W> get_pack_len()  const {return 1;};
+    inline sc_uint<dnp::AG_W> get_age()       const {return 0;}; // ACKs carry no age
+    inline void set_nxt_port(sc_uint<dnp::NP_W> np) {};
+    inline void set_mcast_dst(sc_uint<dnp::MC_W> mc) {};
+    inline void inc_age() {};
     
     inline bool is_rack()  const {return rack;};
     inline bool is_wack()  const {return wack;};
@@ -348,5 +456,10 @@ struct flit_ack {
 
 
 
+#if FLIT_TS_ON
+template<unsigned char PHIT_NUM>
+inline void flit_ts_depart(flit_dnp<PHIT_NUM> &flit) { flit.ts.depart(); };
+#endif
+
 #endif // __FLIT_DNP_H__
 
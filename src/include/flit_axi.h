@@ -5,6 +5,7 @@
 #include "nvhls_connections.h"
 
 #include "./dnp20_axi.h"
+#include "./flit_ts.h"
 
 #ifndef __SYNTHESIS__
 	#include <string>
@@ -18,10 +19,19 @@ template<unsigned char PHIT_NUM>
 struct flit_dnp {
   sc_uint<2>  type;
   sc_uint<2>  vc;
+  sc_uint<dnp::NP_W> nxt_port; // Lookahead RC : output port to request at the next router. Set only under DNP_LOOKAHEAD
+  sc_uint<dnp::EX_W> express;  // Express : the next router forwards it straight through, see rtr_vc EXPRESS. Set only under DNP_EXPRESS
+  sc_uint<dnp::AG_W> age;      // Age : routers crossed, saturating. Set only under the AGE_RR arbiters and DNP_AGE
   //sc_uint<32> dbg_id;
   sc_uint<dnp::PHIT_W> data[PHIT_NUM];
+#if FLIT_TS_ON
+  flit_ts ts; // Simulation only sideband, not Marshalled
+#endif
   
-  static const int width = 2+2+(PHIT_NUM*dnp::PHIT_W); // Matchlib Marshaller requirement
+  static const int width = 2+2+(DNP_LOOKAHEAD ? dnp::NP_W : 0)+(DNP_EXPRESS ? dnp::EX_W : 0)+(DNP_AGE ? dnp::AG_W : 0)+(PHIT_NUM*dnp::PHIT_W); // Matchlib Marshaller requirement
+  static const bool HAS_AGE = DNP_AGE; // The age sideband is carried, for the AGE_RR routers
+  static const bool HAS_LOOKAHEAD = DNP_LOOKAHEAD; // The lookahead port is carried, for the routers of RC_METHOD 6
+  static const bool HAS_EXPRESS = DNP_EXPRESS; // The express mark is carried, for the express routers
   
   // helping functions to retrieve flit info (e.g. flit type, source, destination)
 	inline bool performs_rc()   { return ((type == HEAD) || (type == SINGLE)); }
@@ -38,6 +48,28 @@ struct flit_dnp {
   inline sc_uint<dnp::T_W> get_type() const {return ((data[0] >> dnp::T_PTR) & ((1<<dnp::T_W)-1));};
   inline sc_uint<dnp::V_W> get_vc()   const {return vc;};
   inline sc_uint<dnp::Q_W> get_qos()   const {return ((data[0] >> dnp::Q_PTR) & ((1<<dnp::Q_W)-1));};
+  inline sc_uint<dnp::NP_W> get_nxt_port() const {return DNP_LOOKAHEAD ? nxt_port : (sc_uint<dnp::NP_W>)0;};
+  inline bool get_express() const {return DNP_EXPRESS && express;};
+  inline sc_uint<dnp::AG_W> get_age() const {return DNP_AGE ? age : (sc_uint<dnp::AG_W>)0;};
+  inline sc_uint<dnp::MC_W> get_mcast_dst() const {return 0;}; // AXI flits are always unicast
+  // Packet length in flits, as charged by the packet-aware arbiters. Valid at HEAD/SINGLE flits.
+  //   The header plus the flits the burst occupies at dnp::BPP bytes per phit. Saturates at PL_W
+  inline sc_uint<dnp::PL_W> get_pack_len() const {
+    if (type==SINGLE) return 1;
+    
+    sc_uint<dnp::LE_W> len;
+    sc_uint<dnp::SZ_W> size;
+    if (get_type()==dnp::PACK_TYPE__WR_REQ) {
+      len  = (data[(PHIT_NUM>1) ? 1 : 0] >> dnp::req::LE_PTR) & ((1<<dnp::LE_W)-1);
+      size = (data[(PHIT_NUM>2) ? 2 : 0] >> dnp::req::SZ_PTR) & ((1<<dnp::SZ_W)-1);
+    } else {
+      len  = (data[(PHIT_NUM>1) ? 1 : 0] >> dnp::rresp::LE_PTR) & ((1<<dnp::LE_W)-1);
+      size = (data[(PHIT_NUM>1) ? 1 : 0] >> dnp::rresp::SZ_PTR) & ((1<<dnp::SZ_W)-1);
+    }
+    sc_uint<dnp::LE_W+8> bytes = ((sc_uint<dnp::LE_W+8>)len+1) << size;
+    sc_uint<dnp::LE_W+8> flits = 1 + (bytes + (PHIT_NUM<<dnp::BPP_W) - 1) / (PHIT_NUM<<dnp::BPP_W);
+    return (flits >= (1<<dnp::PL_W)) ? (sc_uint<dnp::PL_W>)((1<<dnp::PL_W)-1) : (sc_uint<dnp::PL_W>)flits;
+  };
   
   inline void set_dst(sc_uint<dnp::D_W>  dst ) { data[0] = (data[0].range(dnp::PHIT_W-1, dnp::D_PTR+dnp::D_W) << (dnp::D_PTR+dnp::D_W)) |
                                                                 (dst  << dnp::D_PTR) |
@@ -52,6 +84,10 @@ struct flit_dnp {
                                                                 (data[0].range(dnp::T_PTR-1, 0));
   };
   inline void set_vc(sc_uint<dnp::V_W>   vc_  ) { vc = vc_; };
+  inline void set_nxt_port(sc_uint<dnp::NP_W> np) { if (DNP_LOOKAHEAD) nxt_port = np; };
+  inline void set_express(bool ex) { if (DNP_EXPRESS) express = ex; };
+  inline void inc_age() { if (DNP_AGE && (age != ((1<<dnp::AG_W)-1))) age = age+1; };
+  inline void set_mcast_dst(sc_uint<dnp::MC_W> mc) {};
   inline void set_qos(sc_uint<dnp::Q_W>  qos ) { data[0] = (data[0].range(dnp::PHIT_W-1, dnp::Q_PTR+dnp::Q_W) << (dnp::Q_PTR+dnp::Q_W)) |
                                                                 (qos  << dnp::Q_PTR) |
                                                                 (data[0].range(dnp::Q_PTR-1, 0));
@@ -116,8 +152,11 @@ struct flit_dnp {
   
   // Flit Constructors
   flit_dnp () {
-    type = 0;
-    vc   = 0;
+    type     = 0;
+    vc       = 0;
+    nxt_port = 0;
+    express  = 0;
+    age      = 0;
     #pragma hls_unroll yes
     for(int i=0; i<PHIT_NUM; ++i)
       data[i] = 0;
@@ -126,6 +165,9 @@ struct flit_dnp {
   flit_dnp(FLIT_TYPE _type, short int _vc, short int _src, short int _dst) {
     type    = _type;
     type    = _vc;
+    nxt_port = 0;
+    express  = 0;
+    age      = 0;
     data[0] = 0                 |
               (_src << dnp::S_PTR) |
               (_dst << dnp::D_PTR) ;
@@ -135,9 +177,13 @@ struct flit_dnp {
 	inline flit_dnp& operator = (const flit_dnp& rhs) {
 		type   = rhs.type;
 		vc     = rhs.vc;
+		nxt_port = rhs.nxt_port;
+		express  = rhs.express;
+		age      = rhs.age;
 		//dbg_id = rhs.dbg_id;
 	  #pragma hls_unroll yes
     for(int i=0; i<PHIT_NUM; ++i) data[i] = rhs.data[i];
+    FLIT_TS_DO(ts = rhs.ts;)
 
 		return *this;
 	};
@@ -145,16 +191,21 @@ struct flit_dnp {
   inline flit_dnp& operator = (const flit_dnp* rhs) {
 		type   = rhs->type;
 		vc     = rhs->vc;
+		nxt_port = rhs->nxt_port;
+		express  = rhs->express;
+		age      = rhs->age;
     //dbg_id = rhs->dbg_id;
 	  #pragma hls_unroll yes
     for(int i=0; i<PHIT_NUM; ++i) data[i] = rhs->data[i];
+    FLIT_TS_DO(ts = rhs->ts;)
 
 		return *this;
 	};
 
 	inline bool operator==(const flit_dnp& rhs) const {
-    bool eq = (rhs.type == type) && (rhs.vc == vc);
+    bool eq = (rhs.type == type) && (rhs.vc == vc) && (rhs.nxt_port == nxt_port) && (rhs.express == express);
     for(int i=0; i<PHIT_NUM; ++i) eq = eq && (data[i] == rhs.data[i]);
+    FLIT_TS_DO(eq = eq && (ts == rhs.ts);)
     return eq;
 	}
 
@@ -166,8 +217,12 @@ struct flit_dnp {
 	  flit_dnp mule;
 	  mule.type = type | rhs.type;
 	  mule.vc   = vc   | rhs.vc;
+	  mule.nxt_port = nxt_port | rhs.nxt_port;
+	  mule.express  = express  | rhs.express;
+	  mule.age      = age      | rhs.age;
     #pragma hls_unroll yes
     for(int i=0; i<PHIT_NUM; ++i) mule.data[i] = data[i] | rhs.data[i];
+    FLIT_TS_DO(mule.ts = ts | rhs.ts;)
     
     return mule;
   };
@@ -177,8 +232,12 @@ struct flit_dnp {
     flit_dnp mule;
     mule.type = type & rhs.type;
     mule.vc   = type & rhs.vc;
+    mule.nxt_port = nxt_port & rhs.nxt_port;
+    mule.express  = express  & rhs.express;
+    mule.age      = age      & rhs.age;
     #pragma hls_unroll yes
     for(int i=0; i<PHIT_NUM; ++i) mule.data[i] = data[i] & rhs.data[i];
+    FLIT_TS_DO(mule.ts = ts & rhs.ts;)
     
     return mule;
   };
@@ -193,8 +252,12 @@ struct flit_dnp {
     
     mule.type = type & mask; //((mask<<1) | bit);
     mule.vc   = vc   & mask; //((mask<<1) | bit);
+    mule.nxt_port = nxt_port & mask;
+    mule.express  = express  & mask;
+    mule.age      = age      & mask;
     #pragma hls_unroll yes
     for(int i=0; i<PHIT_NUM; ++i) mule.data[i] = data[i] & mask;
+    FLIT_TS_DO(mule.ts = ts.and_mask(bit);)
     
     return mule;
   };
@@ -233,6 +296,9 @@ struct flit_dnp {
   inline friend void sc_trace(sc_trace_file* tf, const flit_dnp& flit, const std::string& name) {
 		sc_trace(tf, flit.type, name + ".type");
 		sc_trace(tf, flit.vc, name + ".vc");
+		sc_trace(tf, flit.nxt_port, name + ".nxt_port");
+		sc_trace(tf, flit.express, name + ".express");
+		sc_trace(tf, flit.age, name + ".age");
 		//sc_trace(tf, flit.dbg_id, name + ".dbg_id");
     for(int i=0; i<PHIT_NUM; ++i)
       sc_trace(tf, flit.data[i], name + ".data");
@@ -245,11 +311,25 @@ struct flit_dnp {
     //m& dbg_id;
     m& type;
     m& vc;
+#if DNP_LOOKAHEAD
+    m& nxt_port;
+#endif
+#if DNP_EXPRESS
+    m& express;
+#endif
+#if DNP_AGE
+    m& age;
+#endif
     #pragma hls_unroll yes
     for(int i=PHIT_NUM-1; i>=0; --i) m& data[i];
   };
   
 };
 
+#if FLIT_TS_ON
+template<unsigned char PHIT_NUM>
+inline void flit_ts_depart(flit_dnp<PHIT_NUM> &flit) { flit.ts.depart(); };
+#endif
+
 #endif // __FLIT_DNP_H__
 
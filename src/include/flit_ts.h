@@ -0,0 +1,158 @@
+#ifndef __FLIT_TS_H__
+#define __FLIT_TS_H__
+
+// Simulation only timestamps of the flits, to break the transaction latency down per stage.
+//   Built with FLIT_TS, the flits carry a sideband that is neither part of their Marshall width nor of synthesis,
+//   thus it travels only through the SystemC views of the channels (SIM_MODE 1 or 2).
+//   A request is stamped when the master IF accepted its AXI request and when it injected the packet, at every
+//   router departure and at its depacketization by the slave IF. The slave IF carries these stamps to the response,
+//   which is stamped in turn at its injection, hops and ejection at the master IF, where the whole record is
+//   accumulated per flow (flit_ts_stats). The stages are
+//     M-IF    : AXI request accepted -> request injected, the ordering stalls of the master IF
+//     REQ-RTR : request injected     -> its last router departure, the hops and their queuing
+//     REQ-EJ  : last departure       -> depacketized at the slave IF
+//     SLAVE   : depacketized         -> response injected, the slave service through the slave IF
+//     RSP-RTR, RSP-EJ : the same for the response, up to the master IF
+//   The harness attributes the rest of its measured delay to the master side (its queue, reorder buffers, data beats).
+//   Only the AXI interfaces stamp the packets, the other flits just count their hops.
+#if defined(FLIT_TS) && !defined(__SYNTHESIS__)
+#define FLIT_TS_ON 1
+#define FLIT_TS_DO(stmt) stmt
+#else
+#define FLIT_TS_ON 0
+#define FLIT_TS_DO(stmt)
+#endif
+
+#if FLIT_TS_ON
+
+#include <map>
+#include <utility>
+#include <iostream>
+#include <iomanip>
+#include <string>
+
+struct flit_ts {
+  typedef unsigned long long int stamp_t; // sc_time_stamp() in simulation time units
+
+  stamp_t  acc;               // AXI request accepted by the master IF
+  stamp_t  inj, hop;          // Injection and last router departure of the current packet
+  unsigned hops;              // Routers crossed by the current packet
+  stamp_t  req_inj, req_hop;  // The request's, carried by its response
+  stamp_t  req_ej;
+  unsigned req_hops;
+
+  flit_ts() : acc(0), inj(0), hop(0), hops(0), req_inj(0), req_hop(0), req_ej(0), req_hops(0) {};
+
+  static stamp_t now() { return sc_time_stamp().value(); };
+
+  // Master IF, the request head
+  void inject(stamp_t accepted) { acc = accepted; inj = now(); hop = inj; hops = 0; };
+  // Router, at the departure of the flit
+  void depart() { hop = now(); hops++; };
+  // Slave IF, the request head depacketized and the response head injected
+  void eject_req()  { req_inj = inj; req_hop = hop; req_hops = hops; req_ej = now(); };
+  void inject_rsp() { inj = now(); hop = inj; hops = 0; };
+
+  // The flits are and-or multiplexed as well
+  inline flit_ts operator | (const flit_ts &rhs) const {
+    flit_ts m;
+    m.acc = acc | rhs.acc; m.inj = inj | rhs.inj; m.hop = hop | rhs.hop; m.hops = hops | rhs.hops;
+    m.req_inj = req_inj | rhs.req_inj; m.req_hop = req_hop | rhs.req_hop;
+    m.req_ej  = req_ej  | rhs.req_ej;  m.req_hops = req_hops | rhs.req_hops;
+    return m;
+  };
+  inline flit_ts operator & (const flit_ts &rhs) const {
+    flit_ts m;
+    m.acc = acc & rhs.acc; m.inj = inj & rhs.inj; m.hop = hop & rhs.hop; m.hops = hops & rhs.hops;
+    m.req_inj = req_inj & rhs.req_inj; m.req_hop = req_hop & rhs.req_hop;
+    m.req_ej  = req_ej  & rhs.req_ej;  m.req_hops = req_hops & rhs.req_hops;
+    return m;
+  };
+  inline flit_ts and_mask(bool bit) const { return bit ? *this : flit_ts(); };
+
+  inline bool operator == (const flit_ts &rhs) const {
+    return (acc == rhs.acc) && (inj == rhs.inj) && (hop == rhs.hop) && (hops == rhs.hops) &&
+           (req_inj == rhs.req_inj) && (req_hop == rhs.req_hop) && (req_ej == rhs.req_ej) && (req_hops == rhs.req_hops);
+  };
+};
+
+// The stages of the completed transactions, per direction and (master, slave) node flow
+class flit_ts_stats {
+public:
+  enum {M_IF=0, REQ_RTR, REQ_EJ, SLAVE, RSP_RTR, RSP_EJ, REQ_HOPS, RSP_HOPS, FIELDS};
+
+  struct acc_t {
+    unsigned long long int cnt;
+    double sum[FIELDS];
+    acc_t() : cnt(0) { for (int f=0; f<FIELDS; ++f) sum[f] = 0; };
+  };
+
+  typedef std::map< std::pair<unsigned, unsigned>, acc_t > flow_map;
+  flow_map flows[2]; // RD, WR
+
+  static flit_ts_stats & get() {
+    static flit_ts_stats st;
+    return st;
+  };
+
+  // Master IF, the response head ejected
+  void record(bool is_wr, unsigned master, unsigned slave, const flit_ts &ts) {
+    flit_ts::stamp_t ej = flit_ts::now();
+    acc_t &a = flows[is_wr][std::make_pair(master, slave)];
+    a.cnt++;
+    a.sum[M_IF]     += ts.req_inj - ts.acc;
+    a.sum[REQ_RTR]  += ts.req_hop - ts.req_inj;
+    a.sum[REQ_EJ]   += ts.req_ej  - ts.req_hop;
+    a.sum[SLAVE]    += ts.inj     - ts.req_ej;
+    a.sum[RSP_RTR]  += ts.hop     - ts.inj;
+    a.sum[RSP_EJ]   += ej         - ts.hop;
+    a.sum[REQ_HOPS] += ts.req_hops;
+    a.sum[RSP_HOPS] += ts.hops;
+  };
+
+  // Average cycles per stage. total[] is the delay the harness measured per direction, the rest of it is reported
+  void report(std::ostream &os, const sc_time &clk_period, const double total[2]) const {
+    static const char * const dir_name[2] = {"RD", "WR"};
+    double clk = clk_period.value();
+    static const char * const col_name[RSP_EJ+2] = {"M-IF", "REQ-RTR", "REQ-EJ", "SLAVE", "RSP-RTR", "RSP-EJ", "REST"};
+    os << "Latency breakdown (avg cycles) :\n";
+    os << std::setw(12) << "flow" << "    : " << std::setw(10) << "count";
+    for (int f=0; f<RSP_EJ+2; ++f) os << std::setw(9) << col_name[f];
+    os << "  hops(req,rsp)\n";
+    for (int d=0; d<2; ++d) {
+      acc_t all;
+      for (flow_map::const_iterator it=flows[d].begin(); it!=flows[d].end(); ++it) {
+        all.cnt += it->second.cnt;
+        for (int f=0; f<FIELDS; ++f) all.sum[f] += it->second.sum[f];
+      }
+      print_row(os, "ALL", dir_name[d], all, clk, total[d]);
+      for (flow_map::const_iterator it=flows[d].begin(); it!=flows[d].end(); ++it) {
+        std::string flow = "N" + std::to_string(it->first.first) + "->N" + std::to_string(it->first.second);
+        print_row(os, flow, dir_name[d], it->second, clk, -1);
+      }
+    }
+  };
+
+  static void print_row(std::ostream &os, const std::string &flow, const char *dir, const acc_t &a, double clk, double total) {
+    os << std::setw(12) << flow << " " << dir << " : " << std::setw(10) << a.cnt;
+    double stages = 0;
+    for (int f=M_IF; f<=RSP_EJ; ++f) {
+      double avg = a.cnt ? (a.sum[f] / clk / a.cnt) : 0;
+      stages += avg;
+      os << std::setw(9) << std::fixed << std::setprecision(2) << avg;
+    }
+    if (total >= 0) os << std::setw(9) << (a.cnt ? (total - stages) : 0.0);
+    else            os << std::setw(9) << "-";
+    os << "  " << (a.cnt ? (a.sum[REQ_HOPS] / a.cnt) : 0) << ", " << (a.cnt ? (a.sum[RSP_HOPS] / a.cnt) : 0) << "\n";
+    os.unsetf(std::ios_base::floatfield);
+    os.precision(6);
+  };
+};
+
+#endif // FLIT_TS_ON
+
+// A router departure, of the flits that carry the timestamps. Other flits (ie the ACE acks) get this no-op
+template <class F>
+inline void flit_ts_depart(F &) {};
+
+#endif // __FLIT_TS_H__
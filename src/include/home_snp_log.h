@@ -0,0 +1,42 @@
+#ifndef __HOME_SNP_LOG_H__
+#define __HOME_SNP_LOG_H__
+
+// Simulation only record of the FULL Masters each coherent transaction of a HOME snoops. Compiled out for synthesis.
+//   With a Snoop filter HOME snoops only the sharers of a line, or none, thus the testbench cannot tell the Snoops
+//   to expect from the request alone. HOME records every admitted transaction once the testbench enables the log,
+//   and the testbench consumes them in order, per address and initiator.
+#ifndef __SYNTHESIS__
+
+#include <deque>
+
+class home_snp_log {
+public:
+  struct rec_t {
+    unsigned long long addr;      // As sent in the Snoops
+    unsigned           initiator; // Node ID
+    unsigned           snooped;   // Mask of the snooped FULL Masters, bit 0 the first
+  };
+
+  static bool & enabled() {
+    static bool e = false;
+    return e;
+  };
+
+  static std::deque<rec_t> & recs() {
+    static std::deque<rec_t> r;
+    return r;
+  };
+
+  static inline void record(unsigned long long addr, unsigned initiator, unsigned snooped) {
+    if (!enabled()) return;
+    rec_t rec;
+    rec.addr      = addr;
+    rec.initiator = initiator;
+    rec.snooped   = snooped;
+    recs().push_back(rec);
+  };
+};
+
+#endif // __SYNTHESIS__
+
+#endif // __HOME_SNP_LOG_H__
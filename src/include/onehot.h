@@ -4,6 +4,38 @@
 #include <systemc.h>
 #include "./duth_fun.h"
 
+//============================================================================//
+//==================== One-Hot Encode/Decode of any width ====================//
+//============================================================================//
+// wb2oh : Weighted-binary to one-hot, a comparator per bit. Out of range selects bit 0, as the case based ones
+// oh2wb : One-hot to weighted-binary. Recursive on the vector halves, thus an or-reduce tree of log depth
+template <unsigned N>
+struct oh_fun {
+  static const unsigned LO = N/2;
+  static const unsigned HI = N-LO;
+  
+  template<typename T>
+  static inline sc_uint<N> wb2oh(const T wb_i) {
+    sc_uint<N> oh_rep = 1;
+    #pragma hls_unroll yes
+    for (unsigned i=1; i<N; ++i) if (wb_i==i) oh_rep = ((sc_uint<N>)1) << i;
+    return oh_rep;
+  };
+  
+  static inline unsigned oh2wb(const sc_uint<N> oh_i) {
+    sc_uint<LO> oh_lo = oh_i.range(LO-1, 0);
+    sc_uint<HI> oh_hi = oh_i.range(N-1, LO);
+    return oh_hi.or_reduce() ? (LO + oh_fun<HI>::oh2wb(oh_hi)) : oh_fun<LO>::oh2wb(oh_lo);
+  };
+};
+
+template <>
+struct oh_fun<1> {
+  template<typename T>
+  static inline sc_uint<1> wb2oh(const T wb_i) {return 1;};
+  static inline unsigned   oh2wb(const sc_uint<1> oh_i) {return 0;};
+};
+
 //============================================================================//
 //============================== One-Hot Class ========================//
 //============================================================================//
@@ -22,28 +54,7 @@ public:
   }
   
   template<typename T>
-  inline void set(T wb_val) {
-    switch (wb_val) {
-      case 0 : val = (1<<0);
-        break;
-      case 1 : val = (1<<1);
-        break;
-      case 2 : val = (1<<2);
-        break;
-      case 3 : val = (1<<3);
-        break;
-      case 4 : val = (1<<4);
-        break;
-      case 5 : val = (1<<5);
-        break;
-      case 6 : val = (1<<6);
-        break;
-      case 7 : val = (1<<7);
-        break;
-      default : val = (1<<0);;
-        break;
-    }
-  }; //(1<<wb_val);};
+  inline void set(T wb_val) {val = oh_fun<N>::wb2oh(wb_val);};
   
   template<unsigned RHS_N>
   inline void set(onehot<RHS_N> oh_val) { val = oh_val.val;};
@@ -0,0 +1,85 @@
+#ifndef __OUTS_ID_TABLE__
+#define __OUTS_ID_TABLE__
+
+#include <systemc.h>
+#include "nvhls_connections.h"
+#include "nvhls_assert.h"
+
+// Outstanding transactions of a Slave IF, looked up by AXI ID.
+//   DEPTH slots are shared by all IDs. The transactions of the same ID are kept in issue order
+//   through per ID sequence numbers, thus a lookup is a match of (ID, oldest sequence) over the slots.
+//   Different IDs complete in any order, as the Slave responds.
+template <typename T, unsigned DEPTH, unsigned ID_W>
+class outs_id_table {
+  public :
+  typedef sc_uint< nvhls::log2_ceil<DEPTH>::val+1 > seq_t;   // Wraps past DEPTH, thus never aliases
+  typedef sc_uint< nvhls::log2_ceil<DEPTH+1>::val > count_t;
+
+  T              mem[DEPTH];
+  bool           valid[DEPTH];
+  sc_uint<ID_W>  tid[DEPTH];
+  seq_t          seq[DEPTH];
+
+  seq_t          push_seq[1<<ID_W];
+  seq_t          pop_seq[1<<ID_W];
+
+  count_t        item_count;
+
+  outs_id_table() {
+    reset();
+  };
+
+  void reset() {
+    #pragma hls_unroll yes
+    for (int i=0; i<DEPTH; ++i) valid[i] = false;
+    #pragma hls_unroll yes
+    for (int i=0; i<(1<<ID_W); ++i) {
+      push_seq[i] = 0;
+      pop_seq[i]  = 0;
+    }
+    item_count = 0;
+  };
+
+  inline bool full()  const { return (item_count==DEPTH); };
+  inline bool empty() const { return (item_count==0); };
+  inline unsigned count() const { return item_count.to_uint(); };
+
+  // An outstanding transaction of this ID exists
+  inline bool has(sc_uint<ID_W> id) const { return (push_seq[id] != pop_seq[id]); };
+
+  // Stores to the first free slot
+  inline void push(sc_uint<ID_W> id, const T &val) {
+    NVHLS_ASSERT_MSG(!full(), "Outstanding table FULL!");
+    bool done = false;
+    #pragma hls_unroll yes
+    for (int i=0; i<DEPTH; ++i) {
+      if (!valid[i] && !done) {
+        mem[i]   = val;
+        valid[i] = true;
+        tid[i]   = id;
+        seq[i]   = push_seq[id];
+        done     = true;
+      }
+    }
+    push_seq[id]++;
+    item_count++;
+  };
+
+  // The oldest transaction of this ID is removed and returned
+  inline T pop(sc_uint<ID_W> id) {
+    NVHLS_ASSERT_MSG(has(id), "No outstanding transaction of this ID!");
+    T val = mem[0];
+    #pragma hls_unroll yes
+    for (int i=0; i<DEPTH; ++i) {
+      if (valid[i] && (tid[i]==id) && (seq[i]==pop_seq[id])) {
+        val      = mem[i];
+        valid[i] = false;
+      }
+    }
+    pop_seq[id]++;
+    item_count--;
+    return val;
+  };
+};
+
+#endif // __OUTS_ID_TABLE__
@@ -0,0 +1,76 @@
+#ifndef __RTR_STATS_H__
+#define __RTR_STATS_H__
+
+// Simulation only router instrumentation, to locate hot links and size the buffers.
+//   Compiled out for synthesis. The routers update it once per cycle.
+#ifndef __SYNTHESIS__
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+
+struct rtr_port_stats {
+  // Output side
+  unsigned long long int flits;    // Flits forwarded through the link
+  unsigned long long int blocked;  // Cycles a flit waited for the output because downstream was full (or had no credits)
+  // Input side
+  unsigned long long int arb_lost; // Cycles a ready request lost the arbitration
+  unsigned long long int occ_sum;  // Accumulated buffer occupancy, for the average
+  unsigned int           occ;      // Current buffer occupancy (flits, all VCs)
+  unsigned int           occ_peak; // Peak buffer occupancy
+
+  void reset() {
+    flits = 0; blocked = 0; arb_lost = 0; occ_sum = 0; occ = 0; occ_peak = 0;
+  }
+};
+
+template <unsigned int IN_NUM, unsigned int OUT_NUM>
+struct rtr_stats {
+  unsigned long long int cycles;
+  rtr_port_stats in[IN_NUM];
+  rtr_port_stats out[OUT_NUM];
+
+  rtr_stats() { reset(); }
+
+  void reset() {
+    cycles = 0;
+    for (unsigned i=0; i<IN_NUM;  ++i) in[i].reset();
+    for (unsigned j=0; j<OUT_NUM; ++j) out[j].reset();
+  }
+
+  void set_occ(unsigned ip, unsigned occ) {
+    in[ip].occ      = occ;
+    in[ip].occ_sum += occ;
+    if (occ > in[ip].occ_peak) in[ip].occ_peak = occ;
+  }
+
+  // One row per port. Output columns refer to the link leaving the port, input columns to its buffer.
+  void print(std::ostream &os, const std::string &name) const {
+    os << name << " : " << cycles << " cycles\n";
+    os << "  port      flits   util(%)    blocked   arb_lost   occ  peak   avg_occ\n";
+    unsigned ports = (IN_NUM > OUT_NUM) ? IN_NUM : OUT_NUM;
+    for (unsigned p=0; p<ports; ++p) {
+      os << "  " << std::setw(4) << p;
+      if (p<OUT_NUM) {
+        os << std::setw(11) << out[p].flits
+           << std::setw(10) << std::fixed << std::setprecision(2) << (cycles ? (100.0*out[p].flits/cycles) : 0.0)
+           << std::setw(11) << out[p].blocked;
+      } else {
+        os << std::setw(11) << "-" << std::setw(10) << "-" << std::setw(11) << "-";
+      }
+      if (p<IN_NUM) {
+        os << std::setw(11) << in[p].arb_lost
+           << std::setw(6)  << in[p].occ
+           << std::setw(6)  << in[p].occ_peak
+           << std::setw(10) << std::fixed << std::setprecision(2) << (cycles ? ((double)in[p].occ_sum/cycles) : 0.0);
+      } else {
+        os << std::setw(11) << "-" << std::setw(6) << "-" << std::setw(6) << "-" << std::setw(10) << "-";
+      }
+      os << std::defaultfloat << "\n";
+    }
+  }
+};
+
+#endif // __SYNTHESIS__
+
+#endif // __RTR_STATS_H__
@@ -0,0 +1,205 @@
+#ifndef __RTR_WATCHDOG_H__
+#define __RTR_WATCHDOG_H__
+
+// Simulation only deadlock and starvation watchdog of the routers. Compiled out for synthesis.
+//   Each router keeps a probe of its input buffers (per VC), updated once per cycle : whether the buffer holds a flit,
+//   the output (and output VC) its head requests, why it does not move, and the cycle it last moved or was empty.
+//   A buffer whose head has not moved for the threshold of cycles is stuck. The wait-for graph follows it through
+//     LOCK : the buffer of the same router that holds the requested output VC, in the middle of its packet
+//     FULL : the downstream buffer, as the output has no room (wormhole) or no credits (VC). An output the top did not
+//            link leads to an NI (or to an unlinked router), thus the path ends there
+//     ARB  : none, the buffer could move but lost every arbitration, it starves
+//   A path that returns to one of its buffers is a deadlock cycle.
+//   The routers register their probes at elaboration, the tops link them (link()) and the harness calls check().
+#ifndef __SYNTHESIS__
+
+#include "systemc.h"
+#include <vector>
+#include <map>
+#include <set>
+#include <string>
+#include <iostream>
+
+class wdog_probe;
+
+class rtr_watchdog {
+public:
+  static std::vector<wdog_probe*> & probes() {
+    static std::vector<wdog_probe*> p;
+    return p;
+  };
+
+  // The output op of up, feeds the input ip of dn
+  static inline void link(wdog_probe &up, unsigned op, wdog_probe &dn, unsigned ip);
+
+  // Dumps the buffers stuck for threshold cycles and their wait-for graph. Returns the number of stuck buffers
+  static inline unsigned check(std::ostream &os, unsigned long long threshold);
+};
+
+class wdog_probe {
+public:
+  enum state_t {IDLE=0, MOVED, ARB, LOCK, FULL};
+
+  struct buf_t {
+    state_t                state;
+    int                    op, ovc; // Requested output and output VC
+    unsigned long long int since;   // Last cycle it moved or was empty
+  };
+
+  std::string              name;
+  unsigned                 in_num, out_num, vcs;
+  std::vector<buf_t>       buf;      // [ip*vcs + v]
+  std::vector<int>         owner;    // [op*vcs + ovc] the buffer that holds the output VC, -1 when free
+  std::vector<int>         credits;  // [op*vcs + ovc] credits of the VC routers, -1 otherwise
+  std::vector<wdog_probe*> down;     // [op] the downstream router, NULL for an NI or an unlinked one
+  std::vector<unsigned>    down_ip;
+  unsigned long long int   cycle;
+
+  wdog_probe() : in_num(0), out_num(0), vcs(1), cycle(0) {};
+
+  void init(const std::string &name_, unsigned in_num_, unsigned out_num_, unsigned vcs_) {
+    name    = name_;
+    in_num  = in_num_;
+    out_num = out_num_;
+    vcs     = vcs_;
+    buf.resize(in_num*vcs);
+    owner.resize(out_num*vcs);
+    credits.resize(out_num*vcs);
+    down.assign(out_num, (wdog_probe*)NULL);
+    down_ip.assign(out_num, 0);
+    reset();
+    rtr_watchdog::probes().push_back(this);
+  };
+
+  void reset() {
+    cycle = 0;
+    for (unsigned b=0; b<buf.size(); ++b) {
+      buf[b].state = IDLE;
+      buf[b].op    = -1;
+      buf[b].ovc   = 0;
+      buf[b].since = 0;
+    }
+    for (unsigned o=0; o<owner.size(); ++o) {
+      owner[o]   = -1;
+      credits[o] = -1;
+    }
+  };
+
+  // Once per cycle and buffer
+  void set(unsigned ip, unsigned v, state_t state, int op, int ovc) {
+    buf_t &b = buf[ip*vcs + v];
+    if ((state==IDLE) || (state==MOVED)) b.since = cycle;
+    b.state = state;
+    b.op    = op;
+    b.ovc   = ovc;
+  };
+  void set_owner(unsigned op, unsigned ovc, int holder) { owner[op*vcs + ovc] = holder; };
+  void set_credits(unsigned op, unsigned ovc, int cr)   { credits[op*vcs + ovc] = cr;   };
+  void tick() { cycle++; };
+
+  bool stuck(unsigned b, unsigned long long threshold) const {
+    return (buf[b].state>=ARB) && ((cycle - buf[b].since) >= threshold);
+  };
+
+  std::string buf_name(unsigned b) const {
+    std::string s = name + ".in[" + std::to_string(b/vcs) + "]";
+    if (vcs>1) s += ".vc" + std::to_string(b%vcs);
+    return s;
+  };
+
+  std::string out_name(int op, int ovc) const {
+    std::string s = name + ".out[" + std::to_string(op) + "]";
+    if (vcs>1) s += ".vc" + std::to_string(ovc);
+    return s;
+  };
+};
+
+inline void rtr_watchdog::link(wdog_probe &up, unsigned op, wdog_probe &dn, unsigned ip) {
+  up.down[op]    = &dn;
+  up.down_ip[op] = ip;
+};
+
+inline unsigned rtr_watchdog::check(std::ostream &os, unsigned long long threshold) {
+  static const char * const state_name[] = {"IDLE", "MOVED", "ARB", "LOCK", "FULL"};
+  static const unsigned MAX_LISTED = 64;
+  typedef std::pair<wdog_probe*, unsigned> node_t;
+
+  std::vector<node_t> stuck;
+  for (unsigned r=0; r<probes().size(); ++r) {
+    for (unsigned b=0; b<probes()[r]->buf.size(); ++b) {
+      if (probes()[r]->stuck(b, threshold)) stuck.push_back(node_t(probes()[r], b));
+    }
+  }
+  if (stuck.empty()) return 0;
+
+  os << "\n--- Watchdog : " << stuck.size() << " router buffers stuck for " << threshold << " cycles @" << sc_time_stamp() << " ---\n";
+  for (unsigned s=0; s<stuck.size() && s<MAX_LISTED; ++s) {
+    const wdog_probe           *p = stuck[s].first;
+    const wdog_probe::buf_t    &b = p->buf[stuck[s].second];
+    os << "  " << p->buf_name(stuck[s].second) << " -> " << p->out_name(b.op, b.ovc)
+       << " : " << state_name[b.state] << " for " << (p->cycle - b.since) << " cycles";
+    if (p->credits[b.op*p->vcs + b.ovc]>=0) os << ", " << p->credits[b.op*p->vcs + b.ovc] << " credits";
+    os << "\n";
+  }
+  if (stuck.size()>MAX_LISTED) os << "  ...\n";
+
+  // Each path starts at a stuck buffer that no earlier path crossed
+  os << "Wait-for graph :\n";
+  std::set<node_t> seen;
+  unsigned         deadlocks = 0;
+  for (unsigned s=0; s<stuck.size(); ++s) {
+    if (seen.count(stuck[s])) continue;
+    std::map<node_t, unsigned> on_path;
+    std::vector<node_t>        path;
+    std::string                end;
+    node_t                     n = stuck[s];
+    while (1) {
+      if (on_path.count(n)) {
+        end = "DEADLOCK cycle back to " + n.first->buf_name(n.second);
+        deadlocks++;
+        break;
+      }
+      if (seen.count(n)) {
+        end = "joins the path of " + n.first->buf_name(n.second) + " above";
+        break;
+      }
+      on_path[n] = path.size();
+      path.push_back(n);
+
+      const wdog_probe        *p = n.first;
+      const wdog_probe::buf_t &b = p->buf[n.second];
+      if (b.state==wdog_probe::LOCK) {
+        int holder = p->owner[b.op*p->vcs + b.ovc];
+        if ((holder<0) || ((unsigned)holder==n.second)) { end = "waits a free " + p->out_name(b.op, b.ovc); break; }
+        n = node_t(n.first, holder);
+      } else if (b.state==wdog_probe::FULL) {
+        wdog_probe *dn = p->down[b.op];
+        if (dn==NULL) { end = "waits the NI (or unlinked router) at " + p->out_name(b.op, b.ovc); break; }
+        n = node_t(dn, p->down_ip[b.op]*dn->vcs + ((dn->vcs>1) ? b.ovc : 0));
+      } else if (b.state==wdog_probe::ARB) {
+        end = "STARVED, loses the arbitration of " + p->out_name(b.op, b.ovc);
+        break;
+      } else if (b.state==wdog_probe::IDLE) {
+        end = "which is empty, waits the rest of its packet";
+        break;
+      } else {
+        end = "which is moving";
+        break;
+      }
+    }
+    os << "  ";
+    for (unsigned k=0; k<path.size(); ++k) {
+      const wdog_probe::buf_t &b = path[k].first->buf[path[k].second];
+      os << path[k].first->buf_name(path[k].second) << " -" << state_name[b.state] << "-> ";
+      seen.insert(path[k]);
+    }
+    os << end << "\n";
+  }
+  os << "Watchdog : " << deadlocks << " deadlock cycles\n";
+  os.flush();
+  return stuck.size();
+};
+
+#endif // __SYNTHESIS__
+
+#endif // __RTR_WATCHDOG_H__
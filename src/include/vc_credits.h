@@ -0,0 +1,62 @@
+#ifndef __VC_CREDITS__
+#define __VC_CREDITS__
+
+#include <systemc.h>
+#include "nvhls_connections.h"
+
+// Credit messages of the Virtual Channel networks, shared by the routers and the interfaces at both ends of a link.
+//   CR_COALESCE == 0 : Each message returns a single credit, it carries the VC id.
+//   CR_COALESCE >  0 : Each message returns the credits of all VCs, a count of CNT_W bits per VC.
+//                      The sender holds the credits until they reach CR_COALESCE, or a cycle passes without
+//                      a freed slot. Fewer messages for long links, at the cost of wider ones.
+//   DAMQ_SLOTS == 0  : The downstream buffers are of BUFF_DEPTH per VC.
+//   DAMQ_SLOTS >  0  : The downstream buffer is a pool of DAMQ_SLOTS shared by the VCs (damq_oh.h). Each VC owns
+//                      DAMQ_RSV of them, thus always progresses, and takes the rest from the shared ones up to BUFF_DEPTH.
+//                      The messages are the same, only the sender checks the shared slots in use.
+template <unsigned VCS, unsigned BUFF_DEPTH, unsigned CR_COALESCE=0, unsigned DAMQ_SLOTS=0, unsigned DAMQ_RSV=1>
+struct vc_credits {
+  static const unsigned VC_W  = nvhls::log2_ceil<VCS>::val;
+  static const unsigned CNT_W = nvhls::log2_ceil<BUFF_DEPTH+1>::val;
+  static const unsigned CR_W  = (CR_COALESCE>0) ? VCS*CNT_W : VC_W;
+  static const unsigned SHARED = (DAMQ_SLOTS>VCS*DAMQ_RSV) ? (DAMQ_SLOTS-VCS*DAMQ_RSV) : 0; // DAMQ slots beyond the reserved
+
+  typedef sc_uint<CR_W>  cr_t;  // The message
+  typedef sc_uint<CNT_W> cnt_t; // Credits of a VC, up to BUFF_DEPTH
+
+  // A message that returns one credit of vc
+  static inline cr_t single(unsigned vc) {
+    cr_t msg = 0;
+    if (CR_COALESCE>0) msg = ((cr_t)1) << (vc*CNT_W);
+    else               msg = vc;
+    return msg;
+  };
+
+  // The credits of vc returned by a message
+  static inline unsigned count(const cr_t &msg, unsigned vc) {
+    if (CR_COALESCE>0) return (msg >> (vc*CNT_W)) & ((1<<CNT_W)-1);
+    else               return (msg==vc) ? 1 : 0;
+  };
+
+  // A coalesced message of the held credits
+  static inline cr_t pack(const cnt_t held[VCS]) {
+    cr_t msg = 0;
+    #pragma hls_unroll yes
+    for (unsigned v=0; v<VCS; ++v) msg |= ((cr_t)held[v]) << (v*CNT_W);
+    return msg;
+  };
+
+  // A flit may be sent on vc, given the available credits of all VCs
+  static inline bool ready(const cnt_t avail[VCS], unsigned vc) {
+    if (DAMQ_SLOTS==0) return (avail[vc]>0);
+    unsigned shared_used = 0;
+    #pragma hls_unroll yes
+    for (unsigned v=0; v<VCS; ++v) {
+      unsigned used = BUFF_DEPTH - avail[v];
+      if (used>DAMQ_RSV) shared_used += used-DAMQ_RSV;
+    }
+    unsigned used_vc = BUFF_DEPTH - avail[vc];
+    return (avail[vc]>0) && ((used_vc<DAMQ_RSV) || (shared_used<SHARED));
+  };
+};
+
+#endif // __VC_CREDITS__
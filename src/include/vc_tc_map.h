@@ -0,0 +1,36 @@
+#ifndef __VC_TC_MAP__
+#define __VC_TC_MAP__
+
+// Traffic classes of the Virtual Channel networks, shared by the Master and Slave IFs.
+//   Each class owns a pair of VCs, Requests on 2*tc and Responses on 2*tc+1, thus Requests never wait
+//   behind Responses. The Master picks the class of a request, the Slave responds on the pair of the
+//   VC the request arrived.
+//   TC_MAP selects the key of the class, its range split evenly among the TCS classes
+//     TC_MAP_NONE : A single class, Requests on VC 0 and Responses on VC 1
+//     TC_MAP_ID   : AXI ID ranges, eg a CPU's IDs apart from a DMA's
+//     TC_MAP_QOS  : AXI QoS ranges, the higher QoS on the higher class
+//     TC_MAP_TYPE : Reads and Writes on different classes
+//     TC_MAP_DST  : The destination node
+//   A transaction of an ID keeps its class while others of that ID are in flight, unless the class
+//   follows QoS. Then the Master treats a change of class as a possible reordering.
+enum tc_map_type {TC_MAP_NONE, TC_MAP_ID, TC_MAP_QOS, TC_MAP_TYPE, TC_MAP_DST};
+
+template <unsigned TCS, unsigned char TC_MAP, unsigned ID_W>
+struct vc_tc_map {
+  // The Request VC of a transaction
+  static inline unsigned req_vc(unsigned id, unsigned qos, bool is_wr, unsigned dst) {
+    unsigned tc = 0;
+    if      (TC_MAP==TC_MAP_ID)   tc = (id*TCS)  >> ID_W;
+    else if (TC_MAP==TC_MAP_QOS)  tc = (qos*TCS) >> 4;     // AXI QoS is 4 bits
+    else if (TC_MAP==TC_MAP_TYPE) tc = (is_wr ? 1 : 0) % TCS;
+    else if (TC_MAP==TC_MAP_DST)  tc = dst % TCS;
+    return (tc<<1);
+  };
+
+  // The Response VC of a request that arrived on req_vc. Its class wraps, eg a torus dateline VC
+  static inline unsigned resp_vc(unsigned req_vc) {
+    return (((req_vc>>1) % TCS) << 1) | 1;
+  };
+};
+
+#endif // __VC_TC_MAP__
@@ -7,9 +7,16 @@
 #include "./include/duth_fun.h"
 #include "./include/arbiters.h"
 #include "./include/fifo_queue_oh.h"
+#include "./include/damq_oh.h"
+#include "./include/rtr_stats.h"
+#include "./include/rtr_watchdog.h"
+#include "./include/flit_ts.h"
+#include "./include/vc_credits.h"
 
 #include "nvhls_connections.h"
 
+enum sa_alloc_type {SA_SEPARABLE, SA_ISLIP, SA_WAVEFRONT};
+
 // Select In/Out Ports, the type of flit and the Routing Computation calculation function
 // For RC_METHOD: 0-> direct rc 1-> lut, 2-> type, ... , 4-> LUT based routing
 // IN_NUM    : Number of inputs
@@ -26,12 +33,67 @@
 //               - 3 : For single stage NoCs
 //               - 4 : LUT based RC
 //               - 5 : XY routing with merged RD/WR Req-Resp
+//               - 6 : Lookahead XY routing with merged RD/WR Req-Resp. Mesh inputs (0-3) use the port
+//                     carried in the head flit, while the port of the next router is computed in parallel
+//                     to SA and written back to the flit. Local inputs (4+) compute their port locally.
+//                     The port is a flit sideband that needs DNP_LOOKAHEAD
+//               - 7 : West-First minimal adaptive routing with merged RD/WR Req-Resp. Among the legal ports
+//                     the one with the most downstream credits is selected. In-order delivery is NOT preserved,
+//                     thus it must be used along with the reordering Master interfaces.
+//               - 9 : Torus XY routing with merged RD/WR Req-Resp. Each ring is taken in its shorter direction
+//                     (ties towards +). A dateline on the wraparound links keeps the rings deadlock-free : the
+//                     upper half of the VCs are the dateline copies of the lower half. Packets enter each
+//                     dimension on their lower VC, move to its copy when crossing the wraparound link and return
+//                     to the lower VC at ejection. Requires an even VCS and DIM_Y.
 
-// ARB_C      : The arbiter type. Eg MATRIX, ROUND_ROBIN
-template< unsigned int IN_NUM, unsigned int OUT_NUM, typename flit_t, int DIM_X=0, int NODES=1, unsigned VCS=2, unsigned BUFF_DEPTH=3, unsigned RC_METHOD=3, arb_type arbiter_t=MATRIX >
+// ARB_C      : The arbiter type. Eg MATRIX, ROUND_ROBIN, QOS_RR
+//               - QOS_RR grants the packets of the highest QoS level first, in both SA stages
+//               - AGE_RR grants the oldest packets first, the ones that crossed the most routers, in both SA
+//                 stages. Round Robin among them. The routers age the flits they forward only with this arbiter,
+//                 which needs DNP_AGE
+//               - WEIGHTED_RR, DEFICIT_RR share the BW in flits, charging each packet at its head.
+//                 Per input weights are set by ARB_WEIGHTS, or at elaboration through arb_sa2[j].setWeights()
+//               - TREE_RR is Round Robin of a log depth prefix tree, for high radix. The crossbar muxes
+//                 of any radix are trees of the case based ones (duth_fun.h)
+// BYPASS     : Empty buffer bypass. An incoming flit to an empty VC buffer participates to SA in the same cycle,
+//              removing the buffering cycle at low load. A flit that does not win is buffered as usual.
+// DIM_Y      : Y Dimension of a 2-D torus network. Used in torus routing
+// CR_COALESCE: Coalesced credit return (src/include/vc_credits.h). 0 returns a credit per message, otherwise
+//              the freed slots of all VCs are returned together once they reach CR_COALESCE, or at the first
+//              cycle without a freed slot. The upstream routers and IFs must use the same setting
+// DAMQ_SLOTS : Shared input buffer (src/include/damq_oh.h). 0 keeps a FIFO of BUFF_DEPTH per VC. Otherwise each input
+//              has a pool of DAMQ_SLOTS flits, linked per VC, and a VC may hold up to BUFF_DEPTH of them.
+// DAMQ_RSV   : Slots of the pool reserved per VC, at least 1 for deadlock freedom. The rest are shared.
+//              The upstream routers and IFs account for the shared slots, thus they must use the same settings
+// EXPRESS    : Express bypass for XY routing (RC_METHOD 5). A packet is marked express when the next router forwards
+//              it straight, in the same dimension. There it skips buffering and allocation : arriving at an empty VC
+//              buffer it is granted the straight output ahead of every other flit, thus it is latched to the next
+//              link at the cycle it arrives. The endpoints of each straight segment process it as usual.
+//              EXPRESS is the number of consecutive cycles express flits may take an input or output ahead of
+//              waiting flits. Then the express priority is dropped for a cycle and the SA arbiters pick among all
+//              requests as usual, thus the waiting flits are not guaranteed to win. 0 disables the express bypass.
+//              The mark is a flit sideband that needs DNP_EXPRESS
+// SA_ALLOC   : The switch allocator. All use the arbiter_t arbiters
+//               - SA_SEPARABLE : Single iteration, input first. SA1 picks a VC per input, SA2 an input per output
+//               - SA_ISLIP     : SA_ITERS iterations of iSLIP over the requests of all VCs. Each free output grants a
+//                                free input, each input accepts one of its grants, the pairs leave the next iteration.
+//                                The arbiters keep the state of the first iteration's accepted grants only.
+//                                An input that loses an output may still win another through one of its other VCs
+//               - SA_WAVEFRONT : Wavefront allocator, the diagonals of the input/output matrix are served in order
+//                                from a priority diagonal that rotates every cycle
+//              The VC of an input for each output is picked ahead of the matching by its SA1 arbiter. Not with EXPRESS
+template< unsigned int IN_NUM, unsigned int OUT_NUM, typename flit_t, int DIM_X=0, int NODES=1, unsigned VCS=2, unsigned BUFF_DEPTH=3, unsigned RC_METHOD=3, arb_type arbiter_t=MATRIX, bool BYPASS=false, int DIM_Y=0, unsigned CR_COALESCE=0, unsigned DAMQ_SLOTS=0, unsigned DAMQ_RSV=1, unsigned EXPRESS=0, sa_alloc_type SA_ALLOC=SA_SEPARABLE, unsigned SA_ITERS=2 >
 SC_MODULE(rtr_vc) {
 public:
-  typedef sc_uint< nvhls::log2_ceil<VCS>::val > cr_t;
+  // 8 is the LUT multicast of router_wh_top, not supported here
+  static_assert((RC_METHOD<=7) || (RC_METHOD==9), "rtr_vc supports RC_METHOD 0-7 and 9.");
+  static_assert(!arb_prio< arbiter<VCS, arbiter_t> >::AGED || flit_t::HAS_AGE, "AGE_RR arbiters require the age sideband of the flits, DNP_AGE.");
+  static_assert((RC_METHOD!=6) || flit_t::HAS_LOOKAHEAD, "Lookahead routing requires the lookahead port sideband of the flits, DNP_LOOKAHEAD.");
+  static_assert((EXPRESS==0) || flit_t::HAS_EXPRESS, "The express bypass requires the express mark sideband of the flits, DNP_EXPRESS.");
+  typedef vc_credits<VCS, BUFF_DEPTH, CR_COALESCE, DAMQ_SLOTS, DAMQ_RSV> crs;
+  typedef typename crs::cr_t  cr_t;
+  typedef typename crs::cnt_t cr_cnt_t;
+  typedef sc_uint< nvhls::log2_ceil<VCS>::val > vc_t;
   
   sc_in_clk   clk;
   sc_in<bool> rst_n;
@@ -48,14 +110,30 @@ public:
   Connections::In<cr_t>    cr_in[OUT_NUM];
   
   // Internals
-  fifo_queue<flit_t, BUFF_DEPTH>  fifo[IN_NUM][VCS];
+  fifo_queue<flit_t, (DAMQ_SLOTS>0) ? 1 : BUFF_DEPTH>  fifo[IN_NUM][VCS]; // Unused with DAMQ_SLOTS>0
+  damq<flit_t, VCS, (DAMQ_SLOTS>0) ? DAMQ_SLOTS : 1>  dq[IN_NUM];         // Used with DAMQ_SLOTS>0
   bool                            out_lock[IN_NUM][VCS];
   onehot<OUT_NUM>                 out_port_locked[IN_NUM][VCS];
+  sc_uint<dnp::PR_W>              qos_locked[IN_NUM][VCS]; // Priority (QoS or age) of the packet, carried only by its header
+  vc_t                            out_vc_locked[IN_NUM][VCS]; // Output VC of the packet. Differs only on a dateline
+  bool                            exp_locked[IN_NUM][VCS];    // Express mark of the packet's flits
+  sc_uint<8>                      exp_starve_in[IN_NUM];      // Consecutive cycles express flits went ahead of others
+  sc_uint<8>                      exp_starve_out[OUT_NUM];
   
   onehot<BUFF_DEPTH+1>        credits[OUT_NUM][VCS];
+  cr_cnt_t                    cr_held[IN_NUM][VCS]; // Freed slots not yet returned upstream, when coalescing
   onehot<VCS>                 out_available[OUT_NUM];
   arbiter<VCS   , arbiter_t>  arb_sa1[IN_NUM];
   arbiter<IN_NUM, arbiter_t>  arb_sa2[OUT_NUM];
+  arbiter<OUT_NUM, arbiter_t> arb_acc[IN_NUM];  // SA_ISLIP accept arbiters
+  unsigned char               wf_prio;          // SA_WAVEFRONT priority diagonal
+  
+#ifndef __SYNTHESIS__
+  // Simulation only utilization and stall counters, per port
+  rtr_stats<IN_NUM, OUT_NUM> stats;
+  // and the state of the input VCs for the deadlock watchdog
+  wdog_probe                 wdog;
+#endif
   
   // Constructor
   SC_HAS_PROCESS(rtr_vc);
@@ -64,6 +142,14 @@ public:
     :
     sc_module(name_)
   {
+    NVHLS_ASSERT_MSG((RC_METHOD!=9) || ((VCS%2==0) && (DIM_X>0) && (DIM_Y>0)), "Torus routing requires an even number of VCs and both dimensions.");
+    NVHLS_ASSERT_MSG((EXPRESS==0) || ((RC_METHOD==5) && (IN_NUM>=4) && (OUT_NUM>=4)), "Express bypass requires XY routing on a mesh router.");
+    NVHLS_ASSERT_MSG((EXPRESS<256), "Express preemption limit exceeds its counters.");
+    NVHLS_ASSERT_MSG((DAMQ_SLOTS==0) || ((DAMQ_RSV>0) && (DAMQ_RSV<=BUFF_DEPTH) && (VCS*DAMQ_RSV<=DAMQ_SLOTS)), "DAMQ must reserve 1 to BUFF_DEPTH slots per VC, within its pool.");
+    NVHLS_ASSERT_MSG((SA_ALLOC==SA_SEPARABLE) || ((EXPRESS==0) && (SA_ITERS>0)), "iSLIP/wavefront allocation requires no express bypass and at least 1 iteration.");
+#ifndef __SYNTHESIS__
+    wdog.init(name(), IN_NUM, OUT_NUM, VCS);
+#endif
     SC_THREAD(router_job);
     sensitive << clk.pos();
     async_reset_signal_is(rst_n, false);
@@ -73,8 +159,11 @@ public:
   void router_job() {
     flit_t       vc_hol_flit[IN_NUM][VCS];
     onehot<VCS>  sa1_grants[IN_NUM];
+    bool         exp_won[IN_NUM]; // The SA1 winner is an express flit passing straight, with priority
     
     flit_t flit_to_xbar[IN_NUM];
+    sc_uint<dnp::PR_W> qos_to_xbar[IN_NUM];
+    sc_uint<dnp::PL_W> len_to_xbar[IN_NUM];
     
     // The request and grants of the Inputs/Outputs
     onehot<OUT_NUM> req_sa2_per_i[IN_NUM];
@@ -83,13 +172,25 @@ public:
     onehot<IN_NUM>  gnt_sa2_per_o[OUT_NUM];
     onehot<OUT_NUM> gnt_sa2_per_i[IN_NUM];
     
+    // The requests of all VCs, for the iSLIP/wavefront allocators
+    onehot<VCS>        vc_reqs[IN_NUM];
+    onehot<OUT_NUM>    vc_port_req[IN_NUM][VCS];
+    sc_uint<dnp::PR_W> vc_qos_in[IN_NUM][VCS];
+    sc_uint<dnp::PL_W> vc_len_in[IN_NUM][VCS];
+    
     // Reset per input state
     #pragma hls_unroll yes
     per_i_rst:for (unsigned char i=0; i<IN_NUM; ++i) {
       data_in[i].Reset();
       cr_out[i].Reset();
+      dq[i].reset();
       #pragma hls_unroll yes
-      for(unsigned v=0; v<VCS; ++v) out_lock[i][v] = false;
+      for(unsigned v=0; v<VCS; ++v) {
+        out_lock[i][v]   = false;
+        cr_held[i][v]    = 0;
+        exp_locked[i][v] = false;
+      }
+      exp_starve_in[i] = 0;
     }
     // Reset per output state
     #pragma hls_unroll yes
@@ -101,7 +202,13 @@ public:
         out_available[j].val[v] = true;
         credits[j][v] = onehot<BUFF_DEPTH+1>(1<<BUFF_DEPTH);
       }
+      exp_starve_out[j] = 0;
     }
+    wf_prio = 0;
+#ifndef __SYNTHESIS__
+    stats.reset();
+    wdog.reset();
+#endif
     
     // Post Reset
     #pragma hls_pipeline_init_interval 1
@@ -128,6 +235,15 @@ public:
   
       onehot<VCS> out_ready[OUT_NUM];
       
+#ifndef __SYNTHESIS__
+      bool        out_blocked[OUT_NUM]; // A flit waits for the output, which has no credits at its VC
+      sc_uint<VCS> sa1_reqs[IN_NUM];
+      for (int j=0; j<OUT_NUM; ++j) out_blocked[j] = false;
+      int                 wd_op[IN_NUM][VCS];
+      int                 wd_ovc[IN_NUM][VCS];
+      wdog_probe::state_t wd_state[IN_NUM][VCS];
+#endif
+      
       // Read all inputs
       #pragma hls_unroll yes
       for (int i=0; i<IN_NUM; ++i) {
@@ -141,7 +257,7 @@ public:
         // Check Credits
         #pragma hls_unroll yes
         for (int v = 0; v < VCS; ++v) {
-          out_ready[j][v] = (credits[j][v].is_ready());
+          out_ready[j][v] = (DAMQ_SLOTS>0) ? credits_ready_damq(j, v) : credits[j][v].is_ready();
         }
       }
       
@@ -150,16 +266,35 @@ public:
       input_prep : for (int i = 0; i < IN_NUM; ++i) {
         onehot<VCS>      req_sa1;
         onehot<OUT_NUM>  port_req_oh[VCS];
+        sc_uint<dnp::PR_W> vc_qos[VCS];
+        sc_uint<dnp::PL_W> vc_len[VCS]; // Packet length charged to packet-aware arbiters. Only the headers are charged
+        sc_uint<VCS>      exp_vcs = 0;      // The VC of an arriving express flit that goes straight
+        
+#ifndef __SYNTHESIS__
+        unsigned occ = 0;
+        for (unsigned v=0; v<VCS; ++v) occ += (DAMQ_SLOTS>0) ? dq[i].count(v) : fifo[i][v].count();
+        stats.set_occ(i, occ);
+#endif
         
         // prepare requests of each VC, to content in SA1
         #pragma hls_unroll yes
         vc_prep : for (unsigned v=0; v<VCS; ++v) {
-          vc_hol_flit[i][v] = fifo[i][v].peek();
+          // On bypass the incoming flit is the head of the empty buffer.
+          //   When popped at the same cycle the push/pop pointers both advance, leaving the buffer empty.
+          bool buff_empty     = (DAMQ_SLOTS>0) ? dq[i].empty(v) : fifo[i][v].empty();
+          bool exp_in         = (EXPRESS>0) && (i<4) && buff_empty && data_val_in[i] && (data_data_in[i].get_vc()==v) && data_data_in[i].get_express();
+          bool bypass_this_vc = (BYPASS && buff_empty && data_val_in[i] && (data_data_in[i].get_vc()==v)) || exp_in;
+          bool vc_valid       = !buff_empty || bypass_this_vc;
+          vc_hol_flit[i][v]   = bypass_this_vc ? data_data_in[i] : ((DAMQ_SLOTS>0) ? dq[i].peek(v) : fifo[i][v].peek());
           
           // Depending the Flit type the input selects an output port to request.
           // The required output gets stored to be used by the rest of the flits.
+          vc_t out_vc = v;
           if (out_lock[i][v]) {
             port_req_oh[v].set(out_port_locked[i][v]);
+            vc_qos[v] = qos_locked[i][v];
+            vc_len[v] = 0;
+            if (RC_METHOD==9) out_vc = out_vc_locked[i][v];
           } else {
             // Route Computation
             unsigned char current_op;
@@ -169,28 +304,102 @@ public:
             else if (RC_METHOD==3) { current_op = do_rc_common(vc_hol_flit[i][v].get_dst(),vc_hol_flit[i][v].get_type());}
             else if (RC_METHOD==4) { current_op = do_rc_lut(vc_hol_flit[i][v].get_dst());}
             else if (RC_METHOD==5) { current_op = do_rc_xy_merge(vc_hol_flit[i][v].get_dst(), vc_hol_flit[i][v].get_type());}
+            else if (RC_METHOD==6) { current_op = (i<4) ? (unsigned char)vc_hol_flit[i][v].get_nxt_port().to_uint() : do_rc_xy_merge(vc_hol_flit[i][v].get_dst(), vc_hol_flit[i][v].get_type());}
+            else if (RC_METHOD==7) { current_op = do_rc_west_first(vc_hol_flit[i][v].get_dst(), vc_hol_flit[i][v].get_type(), v);}
+            else if (RC_METHOD==9) { current_op = do_rc_torus(vc_hol_flit[i][v].get_dst(), vc_hol_flit[i][v].get_type());}
             else                   { NVHLS_ASSERT_MSG(0, "Wrong Routing method selected.");}
             
+            if (RC_METHOD==9) {
+              out_vc              = do_vc_dateline(i, v, current_op);
+              out_vc_locked[i][v] = out_vc;
+            }
+            
+            // Lookahead RC for the next router. Not in the critical path of the SA
+            if (RC_METHOD==6) vc_hol_flit[i][v].set_nxt_port(do_rc_xy_lookahead(current_op, vc_hol_flit[i][v].get_dst(), vc_hol_flit[i][v].get_type()));
+            
             port_req_oh[v].set(current_op);
             out_port_locked[i][v].set(port_req_oh[v]);
+            vc_qos[v]        = arb_prio< arbiter<VCS, arbiter_t> >::of(vc_hol_flit[i][v]);
+            qos_locked[i][v] = vc_qos[v];
+            vc_len[v]        = vc_hol_flit[i][v].get_pack_len();
+            
+            // Express when the next router goes straight as well, ie it is within a straight segment
+            if (EXPRESS>0) exp_locked[i][v] = (current_op<4) && (do_rc_xy_lookahead(current_op, vc_hol_flit[i][v].get_dst(), vc_hol_flit[i][v].get_type())==current_op);
+          }
+          
+          if (EXPRESS>0) {
+            vc_hol_flit[i][v].set_express(exp_locked[i][v]);
+            if (exp_in && port_req_oh[v][i^1]) exp_vcs[v] = 1;
           }
           
+          // The flits of the packet leave on the output VC, which is the one credited and reserved downstream
+          if (RC_METHOD==9) vc_hol_flit[i][v].set_vc(out_vc);
+          
           // The required output port must be also Ready and or available.
           onehot<VCS> req_out_ready_vcs = mux<onehot<VCS>, OUT_NUM>::mux_oh_case(port_req_oh[v], out_ready);
           onehot<VCS> req_out_avail_vcs = mux<onehot<VCS>, OUT_NUM>::mux_oh_case(port_req_oh[v], out_available);
           
-          bool req_out_ready = req_out_ready_vcs[v];
-          bool req_out_avail = req_out_avail_vcs[v];
+          bool req_out_ready = req_out_ready_vcs[out_vc];
+          bool req_out_avail = req_out_avail_vcs[out_vc];
   
-          req_sa1[v] = (fifo[i][v].valid() && req_out_ready && (out_lock[i][v] || req_out_avail));
+          req_sa1[v] = (vc_valid && req_out_ready && (out_lock[i][v] || req_out_avail));
+#ifndef __SYNTHESIS__
+          if (vc_valid && !req_out_ready && (out_lock[i][v] || req_out_avail)) {
+            for (int j=0; j<OUT_NUM; ++j) if (port_req_oh[v][j]) out_blocked[j] = true;
+          }
+          wd_op[i][v]    = oh_fun<OUT_NUM>::oh2wb(port_req_oh[v].val);
+          wd_ovc[i][v]   = out_vc;
+          wd_state[i][v] = !vc_valid                          ? wdog_probe::IDLE :
+                           !(out_lock[i][v] || req_out_avail) ? wdog_probe::LOCK :
+                           !req_out_ready                     ? wdog_probe::FULL : wdog_probe::ARB;
+#endif
         }
+#ifndef __SYNTHESIS__
+        sa1_reqs[i] = req_sa1.val;
+#endif
         
-        // Arbitrate amonng the VCs and select the winner to access SA2 and output MUX
-        bool any_sa1_gnt = arb_sa1[i].arbitrate(req_sa1.val, sa1_grants[i].val);
+        // An express flit passing straight takes the input ahead of the rest, unless they waited EXPRESS cycles
+        exp_won[i] = false;
+        if (EXPRESS>0) {
+          sc_uint<VCS> exp_reqs = req_sa1.val & exp_vcs;
+          exp_won[i] = (exp_reqs!=0) && (exp_starve_in[i]<EXPRESS);
+          if (exp_won[i]) {
+            if ((req_sa1.val & ~exp_reqs)!=0) exp_starve_in[i]++;
+            req_sa1.val = exp_reqs;
+          } else {
+            exp_starve_in[i] = 0;
+          }
+        }
         
-        flit_to_xbar[i]  = mux<flit_t, VCS>::mux_oh_case(sa1_grants[i], vc_hol_flit[i]);
-        req_sa2_per_i[i] = mux<onehot<OUT_NUM>, VCS>::mux_oh_case(sa1_grants[i], port_req_oh).and_mask(any_sa1_gnt);
+        if (SA_ALLOC==SA_SEPARABLE) {
+          // Arbitrate amonng the VCs and select the winner to access SA2 and output MUX
+          bool any_sa1_gnt = arb_adapt< arbiter<VCS, arbiter_t> >::arbitrate(arb_sa1[i], req_sa1.val, vc_qos, vc_len, sa1_grants[i].val);
+          
+          flit_to_xbar[i]  = mux<flit_t, VCS>::mux_oh_case(sa1_grants[i], vc_hol_flit[i]);
+          qos_to_xbar[i]   = mux<sc_uint<dnp::PR_W>, VCS>::mux_oh_case(sa1_grants[i], vc_qos);
+          len_to_xbar[i]   = mux<sc_uint<dnp::PL_W>, VCS>::mux_oh_case(sa1_grants[i], vc_len);
+          req_sa2_per_i[i] = mux<onehot<OUT_NUM>, VCS>::mux_oh_case(sa1_grants[i], port_req_oh).and_mask(any_sa1_gnt);
+        } else {
+          vc_reqs[i] = req_sa1;
+          #pragma hls_unroll yes
+          for (unsigned v=0; v<VCS; ++v) {
+            vc_port_req[i][v] = port_req_oh[v];
+            vc_qos_in[i][v]   = vc_qos[v];
+            vc_len_in[i][v]   = vc_len[v];
+          }
+        }
       } // End of set inputs
+      
+      // The matching allocators take all VCs at once. Each input gets the VC and the output it won
+      if (SA_ALLOC!=SA_SEPARABLE) {
+        sa_match(vc_reqs, vc_port_req, vc_qos_in, vc_len_in, sa1_grants, req_sa2_per_i);
+        #pragma hls_unroll yes
+        for (int i=0; i<IN_NUM; ++i) {
+          flit_to_xbar[i] = mux<flit_t, VCS>::mux_oh_case(sa1_grants[i], vc_hol_flit[i]);
+          qos_to_xbar[i]  = mux<sc_uint<dnp::PR_W>, VCS>::mux_oh_case(sa1_grants[i], vc_qos_in[i]);
+          len_to_xbar[i]  = mux<sc_uint<dnp::PL_W>, VCS>::mux_oh_case(sa1_grants[i], vc_len_in[i]);
+        }
+      }
   
       // Per Output arbitration and multiplexing
       #pragma hls_unroll yes
@@ -200,21 +409,46 @@ public:
         for(int i=0; i<IN_NUM; ++i) {
           req_sa2_per_o[j][i] = req_sa2_per_i[i][j];
         }
-        // SA2 arbitration among the inputs to win the output and the required VC
-        bool any_gnt = arb_sa2[j].arbitrate(req_sa2_per_o[j].val, gnt_sa2_per_o[j].val);
+        // The straight input's express flit takes the output ahead of the rest, unless they waited EXPRESS cycles
+        if ((EXPRESS>0) && (j<4)) {
+          unsigned char exp_i   = j^1;
+          bool          exp_out = exp_won[exp_i] && req_sa2_per_o[j][exp_i] && (exp_starve_out[j]<EXPRESS);
+          if (exp_out) {
+            if ((req_sa2_per_o[j].val & ~(((sc_uint<IN_NUM>)1)<<exp_i))!=0) exp_starve_out[j]++;
+            req_sa2_per_o[j].val = ((sc_uint<IN_NUM>)1)<<exp_i;
+          } else {
+            exp_starve_out[j] = 0;
+          }
+        }
+        
+        // SA2 arbitration among the inputs to win the output and the required VC.
+        //   A matching allocator has already granted at most one input per output
+        bool any_gnt;
+        if (SA_ALLOC==SA_SEPARABLE) {
+          any_gnt = arb_adapt< arbiter<IN_NUM, arbiter_t> >::arbitrate(arb_sa2[j], req_sa2_per_o[j].val, qos_to_xbar, len_to_xbar, gnt_sa2_per_o[j].val);
+        } else {
+          gnt_sa2_per_o[j] = req_sa2_per_o[j];
+          any_gnt          = req_sa2_per_o[j].or_reduce();
+        }
         
         flit_t selected_flit = mux<flit_t, IN_NUM>::mux_oh_case(gnt_sa2_per_o[j], flit_to_xbar);
-        cr_t   selected_vc   = selected_flit.get_vc();
+        vc_t   selected_vc   = selected_flit.get_vc();
         
         data_val_out[j]  = any_gnt;
         data_data_out[j] = selected_flit;
         
         #pragma hls_unroll yes
         for (unsigned v=0; v<VCS; ++v) {
-          bool cr_upd_this_vc = cr_val_in[j] && (cr_data_in[j]==v);
           bool cr_cons_this_vc = any_gnt     && (selected_vc  ==v);
-          if      ( cr_cons_this_vc && (!cr_upd_this_vc)) credits[j][v].decrease();
-          else if (!cr_cons_this_vc && ( cr_upd_this_vc)) credits[j][v].increase();
+          if (CR_COALESCE>0) {
+            // Several credits may return at once. Onehot credits shift by the returned minus the consumed
+            unsigned cr_upd_cnt = cr_val_in[j] ? crs::count(cr_data_in[j], v) : 0;
+            credits[j][v].val = (credits[j][v].val << cr_upd_cnt) >> (cr_cons_this_vc ? 1 : 0);
+          } else {
+            bool cr_upd_this_vc = cr_val_in[j] && (cr_data_in[j]==v);
+            if      ( cr_cons_this_vc && (!cr_upd_this_vc)) credits[j][v].decrease();
+            else if (!cr_cons_this_vc && ( cr_upd_this_vc)) credits[j][v].increase();
+          }
         }
         
         if (any_gnt) {
@@ -236,28 +470,79 @@ public:
         bool sa2_grant = gnt_sa2_per_i[i].or_reduce();
         cr_val_out[i]  = sa2_grant;
         bool got_new_flit = data_val_in[i];
-        cr_t new_flit_vc  = data_data_in[i].get_vc();
+        vc_t new_flit_vc  = data_data_in[i].get_vc();
         
-        if (got_new_flit) fifo[i][new_flit_vc].push_no_count_incr(data_data_in[i]);
+        if (got_new_flit && (DAMQ_SLOTS==0)) fifo[i][new_flit_vc].push_no_count_incr(data_data_in[i]);
         
         // Update the FIFO and VC state
-        cr_t vc_popped = 0;
+        vc_t vc_popped = 0;
         #pragma hls_unroll yes
         for (unsigned v=0; v<VCS; ++v) {
           bool this_vc_popped = sa2_grant && sa1_grants[i][v];
           if (this_vc_popped) {
             cr_data_out[i] = v;
-            fifo[i][v].inc_pop_ptr();
+            vc_popped      = v;
+            if (DAMQ_SLOTS==0) fifo[i][v].inc_pop_ptr();
             
             if      (vc_hol_flit[i][v].is_head()) out_lock[i][v] = true;
             else if (vc_hol_flit[i][v].is_tail()) out_lock[i][v] = false;
           }
           
           bool this_vc_pushed = got_new_flit && (new_flit_vc==v);
-          fifo[i][v].set_count(this_vc_pushed, this_vc_popped);
+          if (DAMQ_SLOTS==0) fifo[i][v].set_count(this_vc_pushed, this_vc_popped);
+        }
+        // The shared buffer takes the cycle's push and pop at once, a slot freed now is reused the next cycle
+        if (DAMQ_SLOTS>0) dq[i].update(got_new_flit, new_flit_vc, data_data_in[i], sa2_grant, vc_popped);
+        
+        // Coalesced credits are held, until enough or until the input stops freeing slots.
+        //   The latter returns every held credit once the upstream stalls for them, thus no deadlock.
+        if (CR_COALESCE>0) {
+          unsigned held_total = 0;
+          #pragma hls_unroll yes
+          for (unsigned v=0; v<VCS; ++v) {
+            if (sa2_grant && sa1_grants[i][v]) cr_held[i][v]++;
+            held_total += cr_held[i][v];
+          }
+          cr_val_out[i] = (held_total>=CR_COALESCE) || (!sa2_grant && (held_total>0));
+          if (cr_val_out[i]) {
+            cr_data_out[i] = crs::pack(cr_held[i]);
+            #pragma hls_unroll yes
+            for (unsigned v=0; v<VCS; ++v) cr_held[i][v] = 0;
+          }
         }
       }
       
+#ifndef __SYNTHESIS__
+      stats.cycles++;
+      for (int i=0; i<IN_NUM; ++i) {
+        // The VC popped by this cycle's SA2 grant. cr_val_out is not a pop under CR_COALESCE
+        sc_uint<VCS> popped = gnt_sa2_per_i[i].or_reduce() ? sa1_grants[i].val : (sc_uint<VCS>)0;
+        if ((sa1_reqs[i] & ~popped) != 0) stats.in[i].arb_lost++;
+      }
+      for (int j=0; j<OUT_NUM; ++j) {
+        if (data_val_out[j]) stats.out[j].flits++;
+        if (out_blocked[j])  stats.out[j].blocked++;
+      }
+      for (int i=0; i<IN_NUM; ++i) {
+        for (unsigned v=0; v<VCS; ++v) {
+          bool moved = gnt_sa2_per_i[i].or_reduce() && sa1_grants[i][v];
+          wdog.set(i, v, moved ? wdog_probe::MOVED : wd_state[i][v], wd_op[i][v], wd_ovc[i][v]);
+        }
+      }
+      for (int j=0; j<OUT_NUM; ++j) {
+        for (unsigned v=0; v<VCS; ++v) {
+          wdog.set_owner(j, v, -1);
+          wdog.set_credits(j, v, oh_fun<BUFF_DEPTH+1>::oh2wb(credits[j][v].val));
+        }
+      }
+      for (int i=0; i<IN_NUM; ++i) {
+        for (unsigned v=0; v<VCS; ++v) {
+          if (out_lock[i][v]) wdog.set_owner(oh_fun<OUT_NUM>::oh2wb(out_port_locked[i][v].val), (RC_METHOD==9) ? (unsigned)out_vc_locked[i][v] : v, i*VCS+v);
+        }
+      }
+      wdog.tick();
+#endif
+      
       // Write to outputs
       #pragma hls_unroll yes
       for (int i=0; i<IN_NUM; ++i) {
@@ -269,6 +554,8 @@ public:
       #pragma hls_unroll yes
       for (int j=0; j<OUT_NUM; ++j) {
         if (data_val_out[j]) {
+          if (arb_prio< arbiter<IN_NUM, arbiter_t> >::AGED) data_data_out[j].inc_age();
+          FLIT_TS_DO(flit_ts_depart(data_data_out[j]);)
           bool dbg_push_ok = data_out[j].PushNB(data_data_out[j]);
           NVHLS_ASSERT_MSG(dbg_push_ok, "Push Data DROP!!!");
         }
@@ -279,6 +566,128 @@ public:
   
   
   
+  // iSLIP/wavefront matching of the requests of all VCs.
+  //   Each input first picks a VC for every output, with a copy of its SA1 arbiter. The copies of the matched
+  //   pairs (and of the first iSLIP iteration) become the new arbiter states. Thus any arbiter_t keeps its policy
+  inline void sa_match(const onehot<VCS> vc_reqs_i[IN_NUM], const onehot<OUT_NUM> vc_port_i[IN_NUM][VCS],
+                       const sc_uint<dnp::PR_W> vc_qos_i[IN_NUM][VCS], const sc_uint<dnp::PL_W> vc_len_i[IN_NUM][VCS],
+                       onehot<VCS> vc_gnt_o[IN_NUM], onehot<OUT_NUM> out_gnt_o[IN_NUM])
+  {
+    arbiter<VCS, arbiter_t> vc_arb[IN_NUM][OUT_NUM];
+    sc_uint<VCS>            vc_cand[IN_NUM][OUT_NUM];
+    sc_uint<dnp::PR_W>      qos_per_o[OUT_NUM][IN_NUM]; // The candidate's priority and length, as seen by the outputs
+    sc_uint<dnp::PL_W>      len_per_o[OUT_NUM][IN_NUM];
+    sc_uint<dnp::PR_W>      qos_per_i[IN_NUM][OUT_NUM]; // and by the inputs
+    sc_uint<dnp::PL_W>      len_per_i[IN_NUM][OUT_NUM];
+    sc_uint<IN_NUM>         reqs_per_o[OUT_NUM];
+    
+    #pragma hls_unroll yes
+    for (int j=0; j<OUT_NUM; ++j) reqs_per_o[j] = 0;
+    
+    #pragma hls_unroll yes
+    for (int i=0; i<IN_NUM; ++i) {
+      #pragma hls_unroll yes
+      for (int j=0; j<OUT_NUM; ++j) {
+        sc_uint<VCS> vc_reqs = 0;
+        #pragma hls_unroll yes
+        for (unsigned v=0; v<VCS; ++v) vc_reqs[v] = ((vc_reqs_i[i].val >> v) & 1) && ((vc_port_i[i][v].val >> j) & 1);
+        vc_arb[i][j] = arb_sa1[i];
+        reqs_per_o[j][i] = arb_adapt< arbiter<VCS, arbiter_t> >::arbitrate(vc_arb[i][j], vc_reqs, vc_qos_i[i], vc_len_i[i], vc_cand[i][j]);
+        
+        qos_per_o[j][i] = mux<sc_uint<dnp::PR_W>, VCS>::mux_oh_case(vc_cand[i][j], vc_qos_i[i]);
+        len_per_o[j][i] = mux<sc_uint<dnp::PL_W>, VCS>::mux_oh_case(vc_cand[i][j], vc_len_i[i]);
+        qos_per_i[i][j] = qos_per_o[j][i];
+        len_per_i[i][j] = len_per_o[j][i];
+      }
+    }
+    
+    sc_uint<IN_NUM>  in_free  = -1;
+    sc_uint<OUT_NUM> out_free = -1;
+    sc_uint<OUT_NUM> match[IN_NUM];
+    #pragma hls_unroll yes
+    for (int i=0; i<IN_NUM; ++i) match[i] = 0;
+    
+    if (SA_ALLOC==SA_WAVEFRONT) {
+      // The cells of a diagonal share no input or output, thus each diagonal is granted at once
+      const unsigned DIAGS = (IN_NUM>OUT_NUM) ? IN_NUM : OUT_NUM;
+      #pragma hls_unroll yes
+      for (unsigned k=0; k<DIAGS; ++k) {
+        #pragma hls_unroll yes
+        for (int i=0; i<IN_NUM; ++i) {
+          #pragma hls_unroll yes
+          for (int j=0; j<OUT_NUM; ++j) {
+            bool on_diag = (((i+j+DIAGS-wf_prio) % DIAGS) == k);
+            if (on_diag && reqs_per_o[j][i] && in_free[i] && out_free[j]) {
+              match[i][j] = 1;
+              in_free[i]  = 0;
+              out_free[j] = 0;
+            }
+          }
+        }
+      }
+      wf_prio = ((wf_prio+1)==DIAGS) ? 0 : (wf_prio+1);
+    } else {
+      #pragma hls_unroll yes
+      for (unsigned it=0; it<SA_ITERS; ++it) {
+        // Grant : each free output to a free input
+        arbiter<IN_NUM, arbiter_t> out_arb[OUT_NUM];
+        sc_uint<IN_NUM>            gnt_per_o[OUT_NUM];
+        #pragma hls_unroll yes
+        for (int j=0; j<OUT_NUM; ++j) {
+          sc_uint<IN_NUM> reqs = out_free[j] ? (sc_uint<IN_NUM>)(reqs_per_o[j] & in_free) : (sc_uint<IN_NUM>)0;
+          out_arb[j] = arb_sa2[j];
+          arb_adapt< arbiter<IN_NUM, arbiter_t> >::arbitrate(out_arb[j], reqs, qos_per_o[j], len_per_o[j], gnt_per_o[j]);
+        }
+        // Accept : each free input one of its grants
+        #pragma hls_unroll yes
+        for (int i=0; i<IN_NUM; ++i) {
+          sc_uint<OUT_NUM> offers = 0;
+          #pragma hls_unroll yes
+          for (int j=0; j<OUT_NUM; ++j) offers[j] = in_free[i] && gnt_per_o[j][i];
+          arbiter<OUT_NUM, arbiter_t> in_arb = arb_acc[i];
+          sc_uint<OUT_NUM>            accepted;
+          bool any_acc = arb_adapt< arbiter<OUT_NUM, arbiter_t> >::arbitrate(in_arb, offers, qos_per_i[i], len_per_i[i], accepted);
+          if (any_acc) {
+            match[i]   = accepted;
+            in_free[i] = 0;
+            out_free   = out_free & ~accepted;
+            if (it==0) {
+              arb_acc[i] = in_arb;
+              #pragma hls_unroll yes
+              for (int j=0; j<OUT_NUM; ++j) if (accepted[j]) arb_sa2[j] = out_arb[j];
+            }
+          }
+        }
+      }
+    }
+    
+    // The matched VCs
+    #pragma hls_unroll yes
+    for (int i=0; i<IN_NUM; ++i) {
+      out_gnt_o[i].val = match[i];
+      vc_gnt_o[i].val  = 0;
+      #pragma hls_unroll yes
+      for (int j=0; j<OUT_NUM; ++j) {
+        if (match[i][j]) {
+          vc_gnt_o[i].val = vc_cand[i][j];
+          arb_sa1[i]      = vc_arb[i][j];
+        }
+      }
+    }
+  };
+  
+  // DAMQ credits : A VC is ready with credits of its own, or while the shared slots of the downstream pool last
+  inline bool credits_ready_damq (unsigned char out_port, unsigned vc) {
+    cr_cnt_t avail[VCS];
+    #pragma hls_unroll yes
+    for (unsigned v=0; v<VCS; ++v) {
+      avail[v] = 0;
+      #pragma hls_unroll yes
+      for (unsigned c=0; c<=BUFF_DEPTH; ++c) if (credits[out_port][v].val[c]) avail[v] = c; // Decode the onehot
+    }
+    return crs::ready(avail, vc);
+  };
+  
   // Direct RC : The Dst Node is the Output port
   //inline unsigned char do_rc_direct (const unsigned char destination) {return destination;};
   inline unsigned char do_rc_direct (sc_uint<dnp::D_W> destination) {return destination.to_uint();};
@@ -298,12 +707,81 @@ public:
   };
   
   inline unsigned char do_rc_xy_merge  (sc_uint<dnp::D_W> destination, sc_uint<dnp::T_W> type) {
+    return do_rc_xy_at(id_x.read(), id_y.read(), destination, type);
+  };
+  
+  // Lookahead XY : The output port of the next router, which is the neighbour towards this_op
+  inline unsigned char do_rc_xy_lookahead  (unsigned char this_op, sc_uint<dnp::D_W> destination, sc_uint<dnp::T_W> type) {
+    sc_uint<dnp::D_W> nxt_id_x = id_x.read();
+    sc_uint<dnp::D_W> nxt_id_y = id_y.read();
+    
+    if      (this_op==0) nxt_id_x--;
+    else if (this_op==1) nxt_id_x++;
+    else if (this_op==2) nxt_id_y--;
+    else if (this_op==3) nxt_id_y++;
+    else                 return 0; // Ejects at this router. Don't care
+    
+    return do_rc_xy_at(nxt_id_x, nxt_id_y, destination, type);
+  };
+  
+  // West-First adaptive : West-bound packets go West first, deterministically.
+  //   Otherwise when both East and the Vertical direction are minimal, the port with the most credits at vc wins.
+  inline unsigned char do_rc_west_first  (sc_uint<dnp::D_W> destination, sc_uint<dnp::T_W> type, unsigned vc) {
     sc_uint<dnp::D_W> this_id_x = id_x.read();
     sc_uint<dnp::D_W> this_id_y = id_y.read();
     
     sc_uint<dnp::D_W> dst_x = destination % DIM_X;
     sc_uint<dnp::D_W> dst_y = destination / DIM_X;
     
+    if (dst_x<this_id_x) return 0;
+    
+    bool          go_x = (dst_x>this_id_x);
+    bool          go_y = (dst_y!=this_id_y);
+    unsigned char op_y = (dst_y>this_id_y) ? 3 : 2;
+    
+    // Credits are onehot, thus the greater value holds the more credits
+    sc_uint<BUFF_DEPTH+1> cr_x = credits[1][vc].val;
+    sc_uint<BUFF_DEPTH+1> cr_y = (dst_y>this_id_y) ? credits[3][vc].val : credits[2][vc].val;
+    
+    if      (go_x && go_y) return (cr_y>cr_x) ? op_y : 1;
+    else if (go_x)         return 1;
+    else if (go_y)         return op_y;
+    else                   return do_rc_xy_at(this_id_x, this_id_y, destination, type); // Ejection port
+  };
+  
+  // Torus XY : The shorter direction of each ring, ties towards +. Same ejection ports as XY
+  inline unsigned char do_rc_torus  (sc_uint<dnp::D_W> destination, sc_uint<dnp::T_W> type) {
+    unsigned this_id_x = id_x.read().to_uint();
+    unsigned this_id_y = id_y.read().to_uint();
+    
+    unsigned dst_x = destination.to_uint() % DIM_X;
+    unsigned dst_y = destination.to_uint() / DIM_X;
+    
+    unsigned dist_x = (dst_x + DIM_X - this_id_x) % DIM_X; // Hops towards +X
+    unsigned dist_y = (dst_y + DIM_Y - this_id_y) % DIM_Y; // Hops towards +Y
+    
+    if      (dist_x != 0) return (2*dist_x <= DIM_X) ? 1 : 0;
+    else if (dist_y != 0) return (2*dist_y <= DIM_Y) ? 3 : 2;
+    else                  return do_rc_xy_at(this_id_x, this_id_y, destination, type); // Ejection port
+  };
+  
+  // Dateline VC : The lower VC when entering a dimension or ejecting, its dateline copy (upper half) from the
+  //   wraparound link onwards. Inputs 0,1 are on the X ring and 2,3 on the Y ring.
+  inline vc_t do_vc_dateline  (unsigned char in_port, unsigned in_vc, unsigned char out_port) {
+    unsigned low_vc   = in_vc % (VCS/2);
+    bool     wrap     = ((out_port==0) && (id_x.read()==0)) || ((out_port==1) && (id_x.read()==DIM_X-1)) ||
+                        ((out_port==2) && (id_y.read()==0)) || ((out_port==3) && (id_y.read()==DIM_Y-1));
+    bool     same_dim = (out_port<4) && (in_port<4) && ((out_port/2)==(in_port/2));
+    
+    if      (wrap)     return low_vc + VCS/2;
+    else if (same_dim) return in_vc;
+    else               return low_vc;
+  };
+  
+  inline unsigned char do_rc_xy_at  (sc_uint<dnp::D_W> this_id_x, sc_uint<dnp::D_W> this_id_y, sc_uint<dnp::D_W> destination, sc_uint<dnp::T_W> type) {
+    sc_uint<dnp::D_W> dst_x = destination % DIM_X;
+    sc_uint<dnp::D_W> dst_y = destination / DIM_X;
+    
     if (dst_x>this_id_x) {
       return 1;
     } else if (dst_x<this_id_x) {
@@ -5,6 +5,9 @@
 #include "./include/flit_axi.h"
 #include "./include/duth_fun.h"
 #include "./include/arbiters.h"
+#include "./include/rtr_stats.h"
+#include "./include/rtr_watchdog.h"
+#include "./include/flit_ts.h"
 
 #include "nvhls_connections.h"
 
@@ -20,11 +23,29 @@
 //               - 3 : For single stage NoCs
 //               - 4 : LUT based RC
 //               - 5 : XY routing with merged RD/WR Req-Resp
+//               - 6 : Lookahead XY routing with merged RD/WR Req-Resp. Mesh inputs (0-3) use the port
+//                     carried in the head flit, while the port of the next router is computed in parallel
+//                     to SA and written back to the flit. Local inputs (4+) compute their port locally.
+//                     The port is a flit sideband that needs DNP_LOOKAHEAD
+//               - 8 : LUT based RC with multicast. SINGLE flits with a non-zero multicast mask are replicated
+//                     to every output that leads to a masked node, and pop when all copies are sent.
+//                     Each copy carries only the mask bits of the nodes reached through its output.
 // DIM_X     : X Dimension of a 2-D mesh network. Used in XY routing
 // NODES     : All possible target nodes of the network. Used in LUT routing
-// ARB_C     : The arbiter type. Eg MATRIX, ROUND_ROBIN
+// ARB_C     : The arbiter type. Eg MATRIX, ROUND_ROBIN, QOS_RR
+//               - QOS_RR grants the packets of the highest QoS level first. Round Robin within the level
+//               - AGE_RR grants the oldest packets first, the ones that crossed the most routers. Round Robin
+//                 among them. The routers age the flits they forward only with this arbiter, which needs DNP_AGE
+//               - WEIGHTED_RR, DEFICIT_RR share the output BW in flits, charging each packet at its head.
+//                 Per input weights are set by ARB_WEIGHTS, or at elaboration through arbiter[op].setWeights()
+//               - TREE_RR is Round Robin of a log depth prefix tree, for high radix. The crossbar muxes
+//                 of any radix are trees of the case based ones (duth_fun.h)
 template<unsigned int IN_NUM, unsigned int OUT_NUM, class flit_t, int RC_METHOD=0, int DIM_X=0, int NODES=1, class ARB_C=arbiter<IN_NUM, MATRIX> >
 SC_MODULE(router_wh_top) {
+  // 7 (West-First) and 9 (torus) are of rtr_vc only, as they need the VCs
+  static_assert((RC_METHOD<=6) || (RC_METHOD==8), "router_wh_top supports RC_METHOD 0-6 and 8.");
+  static_assert(!arb_prio<ARB_C>::AGED || flit_t::HAS_AGE, "AGE_RR arbiters require the age sideband of the flits, DNP_AGE.");
+  static_assert((RC_METHOD!=6) || flit_t::HAS_LOOKAHEAD, "Lookahead routing requires the lookahead port sideband of the flits, DNP_LOOKAHEAD.");
   
   typedef sc_uint< clog2<OUT_NUM>::val > port_w_t;
   
@@ -48,17 +69,31 @@ SC_MODULE(router_wh_top) {
   bool out_lock[IN_NUM];
   // Each input stores its required outport (for body/tail flits)
   port_w_t out_port[IN_NUM];
+  // Each input stores the priority (QoS or age) of its packet, as only the header carries it
+  sc_uint<dnp::PR_W> in_qos[IN_NUM];
+  // Outputs that have already received a copy of the multicast flit at the head of the input
+  sc_uint<OUT_NUM> mc_served[IN_NUM];
   
   // Per Output 
   // out available holds the availability of the corresponding output port
   bool   out_available[OUT_NUM];
   ARB_C  arbiter[OUT_NUM];
   
+#ifndef __SYNTHESIS__
+  // Simulation only utilization and stall counters, per port
+  rtr_stats<IN_NUM, OUT_NUM> stats;
+  // and the state of the inputs for the deadlock watchdog
+  wdog_probe                 wdog;
+#endif
+  
   // Constructor
   SC_HAS_PROCESS(router_wh_top);
   router_wh_top(sc_module_name name_="router_wh_top")
     : sc_module(name_)
   { 
+#ifndef __SYNTHESIS__
+    wdog.init(name(), IN_NUM, OUT_NUM, 1);
+#endif
     SC_THREAD(router_job);
     sensitive << clk.pos();
     async_reset_signal_is(rst_n, false);
@@ -70,12 +105,18 @@ SC_MODULE(router_wh_top) {
       data_in[i].Reset();
       out_lock[i]       = false;
       out_port[i]       = 0;
+      in_qos[i]         = 0;
+      mc_served[i]      = 0;
     }
   #pragma hls_unroll yes
   per_o_rst:for(unsigned char o=0; o<OUT_NUM; ++o) {
       data_out[o].Reset();
       out_available[o] = true;
     }
+#ifndef __SYNTHESIS__
+    stats.reset();
+    wdog.reset();
+#endif
     
     // Post Reset
     #pragma hls_pipeline_init_interval 1
@@ -95,6 +136,19 @@ SC_MODULE(router_wh_top) {
       
       bool is_inp_granted[IN_NUM][OUT_NUM];
       
+      // Multicast flits and all their requested outputs
+      bool             is_mcast[IN_NUM];
+      sc_uint<OUT_NUM> mc_req_all[IN_NUM];
+      
+      // Packet length charged to the requests of packet-aware arbiters. Only the headers are charged
+      sc_uint<dnp::PL_W> req_len[IN_NUM];
+      
+#ifndef __SYNTHESIS__
+      int stall_op[IN_NUM]; // The output the input waits for, while it is full downstream. -1 otherwise
+      int                 wd_op[IN_NUM];
+      wdog_probe::state_t wd_state[IN_NUM];
+#endif
+      
       // Input logic, loops for each input to produce the required requests
       #pragma hls_unroll yes
       set_inp: for (int ip=0; ip<IN_NUM; ++ip) {
@@ -106,11 +160,15 @@ SC_MODULE(router_wh_top) {
           fifo_valid[ip] = true;
           hol_data[ip] = data_in[ip].Peek();
         }
+#ifndef __SYNTHESIS__
+        stats.set_occ(ip, !fifo_valid[ip] ? 0 : (data_in[ip].Full() ? 2 : 1)); // 2 slots InBuffered
+#endif
     
         // Depending the Flit type the input selects an output port to request.
         // The required output gets stored to be used by the rest of the flits.
         port_w_t  current_op;
         bool      is_head_single = hol_data[ip].performs_rc();
+        req_len[ip] = (fifo_valid[ip] && is_head_single) ? hol_data[ip].get_pack_len() : (sc_uint<dnp::PL_W>)0;
         if (fifo_valid[ip] && is_head_single) {
           // Route Computation Methods
           if      (RC_METHOD==0) { current_op = do_rc_direct(hol_data[ip].get_dst());} // returns the node ID
@@ -119,9 +177,15 @@ SC_MODULE(router_wh_top) {
           else if (RC_METHOD==3) { current_op = do_rc_common(hol_data[ip].get_dst(), hol_data[ip].get_type());}
           else if (RC_METHOD==4) { current_op = do_rc_lut(hol_data[ip].get_dst());}
           else if (RC_METHOD==5) { current_op = do_rc_xy_merge(hol_data[ip].get_dst(), hol_data[ip].get_type());}
+          else if (RC_METHOD==6) { current_op = (ip<4) ? (port_w_t)hol_data[ip].get_nxt_port() : (port_w_t)do_rc_xy_merge(hol_data[ip].get_dst(), hol_data[ip].get_type());}
+          else if (RC_METHOD==8) { current_op = do_rc_lut(hol_data[ip].get_dst());} // Unicast, multicast ports are resolved below
           else                   { NVHLS_ASSERT_MSG(0, "Wrong Routing method selected.");}
           
+          // Lookahead RC for the next router. Not in the critical path of the SA
+          if (RC_METHOD==6) hol_data[ip].set_nxt_port(do_rc_xy_lookahead(current_op, hol_data[ip].get_dst(), hol_data[ip].get_type()));
+          
           out_port[ip] = current_op;
+          in_qos[ip]   = arb_prio<ARB_C>::of(hol_data[ip]);
         } else {
           current_op = out_port[ip];
         }
@@ -137,6 +201,26 @@ SC_MODULE(router_wh_top) {
         
         bool all_ok = (fifo_valid[ip] && outp_ready && (out_lock[ip] || (is_head_single && outp_avail)));
         req_per_i[ip] = all_ok ? port_req_oh : (sc_uint<OUT_NUM>) 0;
+        
+        // A multicast flit requests, independently, each output that is ready/available and has not got its copy
+        is_mcast[ip]   = (RC_METHOD==8) && fifo_valid[ip] && hol_data[ip].is_single() && (hol_data[ip].get_mcast_dst()!=0);
+        mc_req_all[ip] = is_mcast[ip] ? do_rc_lut_mcast(hol_data[ip].get_mcast_dst()) : (sc_uint<OUT_NUM>) 0;
+        if (is_mcast[ip]) {
+          sc_uint<OUT_NUM> ready_avail_oh = 0;
+          #pragma hls_unroll yes
+          for (int op=0; op<OUT_NUM; ++op) ready_avail_oh[op] = ready_outp[op] && out_available[op];
+          
+          req_per_i[ip] = mc_req_all[ip] & (~mc_served[ip]) & ready_avail_oh;
+        }
+#ifndef __SYNTHESIS__
+        bool may_req = fifo_valid[ip] && !is_mcast[ip] && (out_lock[ip] || (is_head_single && outp_avail));
+        stall_op[ip] = (may_req && !outp_ready) ? (int)current_op : -1;
+        // A multicast flit that does not move is taken as starved, it may wait several outputs
+        wd_op[ip]    = current_op;
+        wd_state[ip] = !fifo_valid[ip]           ? wdog_probe::IDLE :
+                       (stall_op[ip]>=0)         ? wdog_probe::FULL :
+                       (may_req || is_mcast[ip]) ? wdog_probe::ARB  : wdog_probe::LOCK;
+#endif
       } // End of set_inp
       
       swap_dim< sc_uint<OUT_NUM>, IN_NUM, sc_uint<IN_NUM>, OUT_NUM >( req_per_i, req_per_o );
@@ -147,11 +231,15 @@ SC_MODULE(router_wh_top) {
         bool      any_gnt; // the output has been granted
         port_w_t  gnt_ip;  // Input port that got grant
   
-        any_gnt = arbiter[op].arbitrate(req_per_o[op], gnt_per_o[op]);
+        any_gnt = arb_adapt<ARB_C>::arbitrate(arbiter[op], req_per_o[op], in_qos, req_len, gnt_per_o[op]);
         
         flit_t selected_flit;
         selected_flit = mux<flit_t, IN_NUM>::mux_oh_case(gnt_per_o[op], hol_data);
+        // Multicast copies keep only the nodes reached through this output
+        if (RC_METHOD==8) selected_flit.set_mcast_dst(selected_flit.get_mcast_dst() & lut_mcast_nodes(op));
         if(any_gnt) {
+          if (arb_prio<ARB_C>::AGED) selected_flit.inc_age();
+          FLIT_TS_DO(flit_ts_depart(selected_flit);)
           data_out[op].Push(selected_flit);
           
           if      (selected_flit.is_head()) out_available[op] = false;
@@ -165,16 +253,46 @@ SC_MODULE(router_wh_top) {
       #pragma hls_unroll yes
       popped_i:for (unsigned char ip=0; ip<IN_NUM; ++ip){
         if (gnt_per_i[ip].or_reduce()) {
-          // Update the local lock bit depending the flit type
-          //   Head->locks Tail->unlocks
-          if     (hol_data[ip].is_head()) out_lock[ip] = true;
-          else if(hol_data[ip].is_tail()) out_lock[ip] = false;
-          
-          data_in[ip].Pop();
+          if (is_mcast[ip]) {
+            // Multicast pops when all copies are sent
+            sc_uint<OUT_NUM> served = mc_served[ip] | gnt_per_i[ip];
+            if (served == mc_req_all[ip]) {
+              mc_served[ip] = 0;
+              data_in[ip].Pop();
+            } else {
+              mc_served[ip] = served;
+            }
+          } else {
+            // Update the local lock bit depending the flit type
+            //   Head->locks Tail->unlocks
+            if     (hol_data[ip].is_head()) out_lock[ip] = true;
+            else if(hol_data[ip].is_tail()) out_lock[ip] = false;
+            
+            data_in[ip].Pop();
+          }
         }
       }
       
       
+#ifndef __SYNTHESIS__
+      stats.cycles++;
+      bool out_blocked[OUT_NUM];
+      for (unsigned char op=0; op<OUT_NUM; ++op) out_blocked[op] = false;
+      for (unsigned char ip=0; ip<IN_NUM; ++ip) {
+        if (stall_op[ip]>=0) out_blocked[stall_op[ip]] = true;
+        if (req_per_i[ip].or_reduce() && !gnt_per_i[ip].or_reduce()) stats.in[ip].arb_lost++;
+      }
+      for (unsigned char op=0; op<OUT_NUM; ++op) {
+        if (gnt_per_o[op].or_reduce()) stats.out[op].flits++;
+        if (out_blocked[op])           stats.out[op].blocked++;
+      }
+      for (unsigned char ip=0; ip<IN_NUM; ++ip)
+        wdog.set(ip, 0, gnt_per_i[ip].or_reduce() ? wdog_probe::MOVED : wd_state[ip], wd_op[ip], 0);
+      for (unsigned char op=0; op<OUT_NUM; ++op) wdog.set_owner(op, 0, -1);
+      for (unsigned char ip=0; ip<IN_NUM; ++ip) if (out_lock[ip]) wdog.set_owner(out_port[ip], 0, ip);
+      wdog.tick();
+#endif
+      
       // Move flits from internal Buffer to Out Port
       #pragma hls_unroll yes
       for (unsigned char op=0; op<OUT_NUM; ++op)
@@ -207,11 +325,43 @@ SC_MODULE(router_wh_top) {
   inline unsigned char do_rc_lut (sc_lv<dnp::D_W> destination) {
     return route_lut[destination.to_uint()].read();
   };
+  // Multicast LUT Based RC : All the outputs that lead to the masked nodes
+  inline sc_uint<OUT_NUM> do_rc_lut_mcast (sc_uint<dnp::MC_W> mcast_dst) {
+    sc_uint<OUT_NUM> ports = 0;
+    #pragma hls_unroll yes
+    for (int n=0; n<NODES; ++n) {
+      if ((n<dnp::MC_W) && mcast_dst[n]) ports = ports | (((sc_uint<OUT_NUM>)1) << route_lut[n].read());
+    }
+    return ports;
+  };
+  // The nodes that are reached through this output port
+  inline sc_uint<dnp::MC_W> lut_mcast_nodes (unsigned char port) {
+    sc_uint<dnp::MC_W> nodes = 0;
+    #pragma hls_unroll yes
+    for (int n=0; n<NODES; ++n) {
+      if ((n<dnp::MC_W) && (route_lut[n].read()==port)) nodes[n] = 1;
+    }
+    return nodes;
+  };
   // XY merged RD/WR
   inline unsigned char do_rc_xy_merge  (sc_uint<dnp::D_W> destination, sc_uint<dnp::T_W> type) {
-    sc_uint<dnp::D_W> this_id_x = id_x.read();
-    sc_uint<dnp::D_W> this_id_y = id_y.read();
-  
+    return do_rc_xy_at(id_x.read(), id_y.read(), destination, type);
+  };
+  // Lookahead XY : The output port of the next router, which is the neighbour towards this_op
+  inline unsigned char do_rc_xy_lookahead  (port_w_t this_op, sc_uint<dnp::D_W> destination, sc_uint<dnp::T_W> type) {
+    sc_uint<dnp::D_W> nxt_id_x = id_x.read();
+    sc_uint<dnp::D_W> nxt_id_y = id_y.read();
+    
+    if      (this_op==0) nxt_id_x--;
+    else if (this_op==1) nxt_id_x++;
+    else if (this_op==2) nxt_id_y--;
+    else if (this_op==3) nxt_id_y++;
+    else                 return 0; // Ejects at this router. Don't care
+    
+    return do_rc_xy_at(nxt_id_x, nxt_id_y, destination, type);
+  };
+  // XY merged RD/WR, of the router that sits at this_id_x, this_id_y
+  inline unsigned char do_rc_xy_at  (sc_uint<dnp::D_W> this_id_x, sc_uint<dnp::D_W> this_id_y, sc_uint<dnp::D_W> destination, sc_uint<dnp::T_W> type) {
     sc_uint<dnp::D_W> dst_x = destination % DIM_X;
     sc_uint<dnp::D_W> dst_y = destination / DIM_X;
     
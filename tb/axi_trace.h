@@ -0,0 +1,251 @@
+#ifndef __AXI_TRACE_H__
+#define __AXI_TRACE_H__
+
+#include <cstdio>
+#include <cstring>
+#include <stdint.h>
+#include <string>
+#include <map>
+#include <deque>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "helper_non_synth.h"
+
+// Compact binary trace of the master side AXI/ACE transactions.
+//   The file is a 16 byte header ("NOCPTRC1", record size, version) followed by fixed size
+//   little-endian records, in the order they were captured. Every record is a handshake of a
+//   master channel (AR, AW, W) or a snoop (AC) received by an ACE master.
+//   Requests (AR/AW) of a master are numbered (seq) and carry the closed-loop dependency : the
+//   last request of the same master that completed before it was issued (dep) and the cycles
+//   from that completion to the issue (dep_gap). Thus the think time of the original master is
+//   kept while the fabric latency is the one of the replayed interconnect.
+struct trace_rec {
+  enum kind_t {AR=0, AW=1, W=2, AC=3};
+  enum {NO_DEP = 0xFFFFFFFF};
+
+  uint64_t cycle;   // Handshake cycle of the simulation
+  uint64_t addr;    // AR/AW/AC address
+  uint64_t data;    // W : data[63:0]
+  uint32_t seq;     // AR/AW : request number of this master
+  uint32_t dep;     // AR/AW : seq of the dependency, or NO_DEP
+  uint32_t dep_gap; // AR/AW : cycles from the dependency completion to the issue
+  uint32_t wstrb;   // W : strobes of data[63:0]
+  uint16_t id;
+  uint8_t  kind;
+  uint8_t  master;
+  uint8_t  len;
+  uint8_t  size;
+  uint8_t  burst;
+  uint8_t  cache;
+  uint8_t  qos;
+  uint8_t  last;    // W : last beat
+  uint8_t  snoop;   // ACE : AR/AW/AC snoop
+  uint8_t  domain;  // ACE : AR/AW domain
+  uint8_t  barrier; // ACE : AR/AW barrier
+  uint8_t  unique;  // ACE : AW unique
+  uint8_t  prot;    // ACE : AC prot
+  uint8_t  rsvd;
+
+  trace_rec() { std::memset(this, 0, sizeof(trace_rec)); dep = NO_DEP; }
+
+  // Common AR/AW fields, the AXI QoS and ACE attributes are filled by the caller
+  template <typename ADDR_T>
+  void set_req(const ADDR_T &req) {
+    id    = req.id.to_uint();
+    addr  = req.addr.to_uint64();
+    len   = req.len.to_uint();
+    size  = req.size.to_uint();
+    burst = req.burst.to_uint();
+    cache = req.cache.to_uint();
+  }
+
+  template <typename ADDR_T>
+  void get_req(ADDR_T &req) const {
+    req.id    = id;
+    req.addr  = addr;
+    req.len   = len;
+    req.size  = size;
+    req.burst = burst;
+    req.cache = cache;
+  }
+
+  template <typename DATA_T>
+  void set_data(const DATA_T &beat) {
+    data  = beat.data.to_uint64();
+    wstrb = beat.wstrb.to_uint64();
+    last  = beat.last.to_uint();
+  }
+};
+
+static const char     TRACE_MAGIC[8] = {'N','O','C','P','T','R','C','1'};
+static const uint32_t TRACE_VERSION  = 1;
+
+
+// Appends the records of all the masters to a single file. Buffered, the masters share it
+class trace_writer {
+public:
+  FILE *fp;
+  unsigned long long int records;
+
+  trace_writer() : fp(NULL), records(0) {};
+  ~trace_writer() { close(); };
+
+  bool open(const char *fname) {
+    fp = std::fopen(fname, "wb");
+    if (!fp) return false;
+    std::setvbuf(fp, NULL, _IOFBF, 1<<20);
+    uint32_t hdr[2] = {(uint32_t)sizeof(trace_rec), TRACE_VERSION};
+    std::fwrite(TRACE_MAGIC, 1, 8, fp);
+    std::fwrite(hdr, sizeof(uint32_t), 2, fp);
+    return true;
+  };
+
+  bool is_open() const { return fp != NULL; };
+
+  void put(const trace_rec &rec) {
+    std::fwrite(&rec, sizeof(trace_rec), 1, fp);
+    records++;
+  };
+
+  void close() {
+    if (fp) std::fclose(fp);
+    fp = NULL;
+  };
+};
+
+
+// Memory-maps a trace for replay. Pages are read in on demand (sequential access advised),
+// thus a trace of any size is streamed without being loaded in memory.
+class trace_reader {
+public:
+  const trace_rec *recs;
+  size_t           num;
+  void            *map;
+  size_t           map_len;
+
+  trace_reader() : recs(NULL), num(0), map(NULL), map_len(0) {};
+  ~trace_reader() { if (map) munmap(map, map_len); };
+
+  bool open(const char *fname) {
+    int fd = ::open(fname, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < 16) { ::close(fd); return false; }
+    map_len = st.st_size;
+    map     = mmap(NULL, map_len, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) { map = NULL; return false; }
+    madvise(map, map_len, MADV_SEQUENTIAL);
+
+    const char     *base = (const char *) map;
+    const uint32_t *hdr  = (const uint32_t *) (base+8);
+    if (std::memcmp(base, TRACE_MAGIC, 8) || hdr[0] != sizeof(trace_rec) || hdr[1] != TRACE_VERSION) return false;
+    recs = (const trace_rec *) (base+16);
+    num  = (map_len-16) / sizeof(trace_rec);
+    return true;
+  };
+
+  bool is_open() const { return recs != NULL; };
+};
+
+
+// Outstanding requests of a master and their completion times, to record and to resolve the
+// closed-loop dependencies. Responses of the same direction and ID complete in order (AXI).
+// Completions are kept in a ring, a dependency older than the ring is considered long done.
+class trace_deps {
+public:
+  enum {RING = 4096};
+
+  std::map< unsigned, std::deque<uint32_t> > outstanding; // (dir,id) -> seq
+  uint32_t               done_seq[RING];
+  unsigned long long int done_cycle[RING];
+  uint32_t               last_done;
+  unsigned long long int last_done_cycle;
+
+  trace_deps() { reset(); };
+
+  void reset() {
+    outstanding.clear();
+    for (int i=0; i<RING; ++i) done_seq[i] = trace_rec::NO_DEP;
+    last_done       = trace_rec::NO_DEP;
+    last_done_cycle = 0;
+  };
+
+  void issued(bool is_wr, unsigned id, uint32_t seq) {
+    outstanding[(id<<1) | is_wr].push_back(seq);
+  };
+
+  void completed(bool is_wr, unsigned id, unsigned long long int cycle) {
+    std::deque<uint32_t> &q = outstanding[(id<<1) | is_wr];
+    if (q.empty()) return;
+    uint32_t seq = q.front();
+    q.pop_front();
+    done(seq, cycle);
+  };
+
+  // Also for replayed requests that were dropped, so that their dependents do not wait forever
+  void done(uint32_t seq, unsigned long long int cycle) {
+    done_seq[seq%RING]   = seq;
+    done_cycle[seq%RING] = cycle;
+    last_done            = seq;
+    last_done_cycle      = cycle;
+  };
+
+  // Whether the request may issue at cycle now, given its dependency
+  bool ready(const trace_rec &rec, unsigned long long int now) const {
+    if (rec.dep == trace_rec::NO_DEP) return true;
+    uint32_t slot = rec.dep%RING;
+    if (done_seq[slot] == rec.dep)                                       return (now >= done_cycle[slot] + rec.dep_gap);
+    if (done_seq[slot] != trace_rec::NO_DEP && done_seq[slot] > rec.dep) return true;
+    return false;
+  };
+};
+
+
+// Per master replay state.
+//   TIMED  : requests are issued at their original cycles (or later, in order, if behind)
+//   CLOSED : requests wait for their dependency to complete plus the original think time
+class trace_replay {
+public:
+  enum mode_t {TIMED, CLOSED};
+
+  const trace_reader *src;
+  mode_t              mode;
+  unsigned            master;
+  size_t              pos;
+
+  trace_replay() : src(NULL), mode(TIMED), master(0), pos(0) {};
+
+  static mode_t mode_from_env() {
+    return (!std::strcmp(tb_param_str("TB_TRACE_MODE", "timed"), "closed")) ? CLOSED : TIMED;
+  };
+
+  bool active() const { return src != NULL; };
+
+  // The next AR/AW request of this master, NULL at the end of the trace
+  const trace_rec * peek() {
+    while (pos < src->num) {
+      const trace_rec &rec = src->recs[pos];
+      if (rec.master == master && (rec.kind == trace_rec::AR || rec.kind == trace_rec::AW)) return &rec;
+      pos++;
+    }
+    return NULL;
+  };
+
+  bool done() { return !active() || (peek() == NULL); };
+
+  const trace_rec * next(const trace_deps &deps, unsigned long long int now) {
+    const trace_rec *rec = peek();
+    if (!rec) return NULL;
+    bool go = (mode == TIMED) ? (now >= rec->cycle) : deps.ready(*rec, now);
+    if (!go) return NULL;
+    pos++;
+    return rec;
+  };
+};
+
+#endif // __AXI_TRACE_H__
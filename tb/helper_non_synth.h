@@ -1,6 +1,8 @@
 #ifndef __DUTH_HELPER_NON_SYNTH__
 #define __DUTH_HELPER_NON_SYNTH__
 
+#include <cstdlib>
+
 unsigned int my_log2c(unsigned int val) {
 	/// ceil(log2) integer calculation. Returns -1 for log2(0)
 	unsigned int ret = -1;
@@ -11,5 +13,18 @@ unsigned int my_log2c(unsigned int val) {
 	return ret;
 }
 
+int tb_param(const char *name, int dflt) {
+	/// Testbench knob with a run-time override from the environment. ie TB_GEN_RATE_RD=30 ./sim_sc
+	/// Allows sweeping traffic parameters without rebuilding. Returns dflt when name is not set
+	const char *val = std::getenv(name);
+	return (val && *val) ? std::atoi(val) : dflt;
+}
+
+const char* tb_param_str(const char *name, const char *dflt) {
+	/// String variant of tb_param. ie TB_LAT_DUMP=lat.json ./sim_sc
+	const char *val = std::getenv(name);
+	return (val && *val) ? val : dflt;
+}
+
 
 #endif // __DUTH_HELPER_NON_SYNTH__
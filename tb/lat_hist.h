@@ -0,0 +1,160 @@
+#ifndef __LAT_HIST_H__
+#define __LAT_HIST_H__
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <cstring>
+
+// Fixed memory, log-linear latency histogram.
+//   Values below 2^SUB_BITS get a bucket each (exact). Above that, every power of two
+//   is split in 2^(SUB_BITS-1) linear sub-buckets, thus percentiles are reported with up to
+//   1/2^(SUB_BITS-1) relative error. Values are saturated to 2^MAX_BITS-1 cycles.
+class lat_hist {
+public:
+  enum {
+    SUB_BITS = 5,
+    MAX_BITS = 32,
+    BUCKETS  = (MAX_BITS-SUB_BITS+1)*(1<<(SUB_BITS-1)) + (1<<SUB_BITS),
+  };
+
+  unsigned long long int bucket[BUCKETS];
+  unsigned long long int cnt, sum, lo, hi;
+
+  lat_hist() { clear(); }
+
+  void clear() {
+    for (int i=0; i<BUCKETS; ++i) bucket[i] = 0;
+    cnt = 0; sum = 0; lo = ~0ULL; hi = 0;
+  }
+
+  void add(unsigned long long int val) {
+    if (val > ((1ULL<<MAX_BITS)-1)) val = (1ULL<<MAX_BITS)-1;
+    bucket[index(val)]++;
+    cnt++;
+    sum += val;
+    if (val < lo) lo = val;
+    if (val > hi) hi = val;
+  }
+
+  void merge(const lat_hist &other) {
+    for (int i=0; i<BUCKETS; ++i) bucket[i] += other.bucket[i];
+    cnt += other.cnt;
+    sum += other.sum;
+    if (other.lo < lo) lo = other.lo;
+    if (other.hi > hi) hi = other.hi;
+  }
+
+  unsigned long long int count() const { return cnt; }
+  unsigned long long int min()   const { return cnt ? lo : 0; }
+  unsigned long long int max()   const { return hi; }
+  double                 mean()  const { return cnt ? ((double)sum / (double)cnt) : 0; }
+
+  // Smallest value that at least pct% of the samples do not exceed.
+  // Reported as the upper edge of its bucket, bounded by the recorded min/max
+  unsigned long long int percentile(double pct) const {
+    if (!cnt) return 0;
+    unsigned long long int rank = (unsigned long long int)((pct/100.0)*(double)cnt + 0.999999);
+    if (rank < 1)   rank = 1;
+    if (rank > cnt) rank = cnt;
+    unsigned long long int acc = 0;
+    for (int i=0; i<BUCKETS; ++i) {
+      acc += bucket[i];
+      if (acc >= rank) {
+        unsigned long long int val = upper(i);
+        if (val > hi) val = hi;
+        if (val < lo) val = lo;
+        return val;
+      }
+    }
+    return hi;
+  }
+
+private:
+  static int index(unsigned long long int val) {
+    if (val < (1ULL<<SUB_BITS)) return (int)val;
+    int msb = 0;
+    while ((val >> (msb+1)) != 0) msb++;
+    int shift = msb - SUB_BITS + 1;
+    return shift*(1<<(SUB_BITS-1)) + (int)(val >> shift);
+  }
+
+  static unsigned long long int upper(int idx) {
+    if (idx < (1<<SUB_BITS)) return idx;
+    int shift = (idx >> (SUB_BITS-1)) - 1;
+    unsigned long long int mant = idx - shift*(1<<(SUB_BITS-1));
+    return ((mant+1) << shift) - 1;
+  }
+};
+
+
+// Collects named latency histograms (ie per flow and direction) and reports their percentiles.
+//   The report is printed, and optionally dumped to a file for regression tracking.
+//   The dump is JSON when the file name ends with .json, CSV otherwise.
+class lat_report {
+public:
+  struct entry {
+    std::string flow; // ie "ALL", "M0->S1"
+    std::string dir;  // "RD", "WR"
+    lat_hist    hist;
+  };
+
+  std::vector<entry> entries;
+
+  void add(const std::string &flow, const std::string &dir, const lat_hist &hist) {
+    entry e;
+    e.flow = flow;
+    e.dir  = dir;
+    e.hist = hist;
+    entries.push_back(e);
+  }
+
+  void print(std::ostream &os) const {
+    os << "Latency distribution(cycles)  :      count        min        p50        p90        p99      p99.9        max         avg\n";
+    for (unsigned i=0; i<entries.size(); ++i) {
+      const lat_hist &h = entries[i].hist;
+      os << std::left  << std::setw(10) << entries[i].flow << std::setw(19) << entries[i].dir << ": " << std::right
+         << std::setw(11) << h.count()
+         << std::setw(11) << h.min()
+         << std::setw(11) << h.percentile(50)
+         << std::setw(11) << h.percentile(90)
+         << std::setw(11) << h.percentile(99)
+         << std::setw(11) << h.percentile(99.9)
+         << std::setw(11) << h.max()
+         << std::setw(12) << std::fixed << std::setprecision(2) << h.mean() << std::defaultfloat << "\n";
+    }
+  }
+
+  bool dump(const char *fname) const {
+    std::ofstream ofs(fname);
+    if (!ofs.is_open()) return false;
+
+    size_t len   = std::strlen(fname);
+    bool is_json = (len>5) && (std::strcmp(fname+len-5, ".json")==0);
+
+    if (is_json) ofs << "{\n  \"latency\": [\n";
+    else         ofs << "flow,dir,count,min,p50,p90,p99,p99.9,max,avg\n";
+
+    for (unsigned i=0; i<entries.size(); ++i) {
+      const lat_hist &h = entries[i].hist;
+      if (is_json) {
+        ofs << "    {\"flow\": \"" << entries[i].flow << "\", \"dir\": \"" << entries[i].dir << "\""
+            << ", \"count\": " << h.count()          << ", \"min\": "   << h.min()
+            << ", \"p50\": "   << h.percentile(50)   << ", \"p90\": "   << h.percentile(90)
+            << ", \"p99\": "   << h.percentile(99)   << ", \"p99.9\": " << h.percentile(99.9)
+            << ", \"max\": "   << h.max()            << ", \"avg\": "   << h.mean() << "}"
+            << ((i+1<entries.size()) ? ",\n" : "\n");
+      } else {
+        ofs << entries[i].flow << "," << entries[i].dir << "," << h.count() << "," << h.min() << ","
+            << h.percentile(50) << "," << h.percentile(90) << "," << h.percentile(99) << ","
+            << h.percentile(99.9) << "," << h.max() << "," << h.mean() << "\n";
+      }
+    }
+    if (is_json) ofs << "  ]\n}\n";
+    return true;
+  }
+};
+
+#endif // __LAT_HIST_H__
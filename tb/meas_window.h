@@ -0,0 +1,110 @@
+#ifndef __TB_MEAS_WINDOW_H__
+#define __TB_MEAS_WINDOW_H__
+
+#include "systemc.h"
+#include <vector>
+#include <cmath>
+
+#include "helper_non_synth.h"
+#include "tb_wrap.h"
+#include "tb_scoreboard.h"
+
+// Steady-state measurement window of a run, enabled with TB_MEAS_WINDOW=1 in place of the fixed TB_GEN_CYCLES.
+//   The first TB_WARMUP_CYCLES are discarded. The requests generated after them are marked (by their time_gen)
+//   and only those are measured, to their completion. The window is split in batches of TB_BATCH_CYCLES and
+//   closes once the 95% confidence intervals of the batch means of latency and throughput are within TB_CI_PCT
+//   percent of their mean, after at least TB_MIN_BATCHES, or at the cap of TB_MAX_CYCLES. The generators keep
+//   the load until the marked requests complete, then the harness stops them and drains as usual.
+//   Writes are marked by their response at the slave, as their latency is measured from it.
+//   All cycles are of the harness clock.
+class meas_window {
+public:
+  const bool     enabled     = (tb_param("TB_MEAS_WINDOW",   0) != 0);
+  const unsigned warmup      =  tb_param("TB_WARMUP_CYCLES", 1000);
+  const unsigned batch       =  tb_param("TB_BATCH_CYCLES",  1000);
+  const unsigned min_batches =  tb_param("TB_MIN_BATCHES",   5);
+  const unsigned max_cycles  =  tb_param("TB_MAX_CYCLES",    100000);
+  const double   ci_pct      =  tb_param("TB_CI_PCT",        5);
+
+  sc_time clk_period;
+  sc_time t_open, t_close; // Marked : t_open <= time_gen < t_close
+
+  // The current batch, of the completed requests
+  unsigned long long int b_lat_sum, b_cnt;
+  std::vector<double>    lat_means, thr_means;
+  bool                   conv;
+
+  meas_window() : t_open(sc_max_time()), t_close(sc_max_time()), b_lat_sum(0), b_cnt(0), conv(false) {};
+
+  bool in(const sc_time &gen) const { return (gen >= t_open) && (gen < t_close); };
+
+  // A marked request completed
+  void record(unsigned long long int lat) {
+    b_lat_sum += lat;
+    b_cnt++;
+  };
+
+  // Window length, of the closed window
+  unsigned long long int cycles() const { return (t_close - t_open) / clk_period; };
+
+  // Half width of the 95% confidence interval of the mean, relative to it
+  static double ci_rel(const std::vector<double> &v) {
+    static const double t_975[30] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                                      2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+                                      2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+    unsigned n = v.size();
+    if (n < 2) return 1.0;
+    double mean = 0, var = 0;
+    for (unsigned i=0; i<n; ++i) mean += v[i];
+    mean /= n;
+    for (unsigned i=0; i<n; ++i) var += (v[i]-mean)*(v[i]-mean);
+    var /= (n-1);
+    double t = (n-1 <= 30) ? t_975[n-2] : 1.96;
+    return (mean > 0) ? (t * std::sqrt(var/n) / mean) : 1.0;
+  };
+
+  // Warm-up, the batches up to convergence or the cap, then the marked requests to completion.
+  // Called in place of the fixed generation period, from the harness thread.
+  template <class RD, class WR>
+  void run(const tb_scoreboard< msg_tb_wrap<RD> > &sb_rd_resp, const tb_scoreboard< msg_tb_wrap<WR> > &sb_wr_resp) {
+    // Bounds move to the next cycle, thus a request of the same cycle is on the same side whatever the process order
+    wait(clk_period*warmup);
+    t_open = sc_time_stamp() + clk_period;
+    std::cout << "--- Measurement Window Opened @" << sc_time_stamp() << " ---\n";
+
+    unsigned long long int elapsed = 0;
+    do {
+      wait(clk_period*batch);
+      elapsed += batch;
+      lat_means.push_back(b_cnt ? ((double)b_lat_sum / (double)b_cnt) : 0.0);
+      thr_means.push_back((double)b_cnt / (double)batch);
+      b_lat_sum = 0;
+      b_cnt     = 0;
+      conv = (lat_means.size() >= min_batches) &&
+             (ci_rel(lat_means)*100.0 <= ci_pct) && (ci_rel(thr_means)*100.0 <= ci_pct);
+    } while (!conv && (elapsed < max_cycles));
+
+    t_close = sc_time_stamp() + clk_period;
+    std::cout << "--- Measurement Window Closed @" << sc_time_stamp() << (conv ? " (converged)" : " (cycle cap)") << " ---\n";
+    std::cout.flush();
+
+    // Each flow is a FIFO in generation order, its head is the oldest outstanding
+    while (pending(sb_rd_resp) || pending(sb_wr_resp)) wait(clk_period*16);
+    std::cout << "--- Marked Requests Completed @" << sc_time_stamp() << " ---\n";
+  };
+
+  template <class T>
+  bool pending(const tb_scoreboard<T> &sb) const {
+    for (typename tb_scoreboard<T>::fifo_iter it = sb.index.begin(); it != sb.index.end(); ++it) {
+      if ((it->second.head != SB_NIL) && (sb.at(it->second.head).time_gen < t_close)) return true;
+    }
+    return false;
+  };
+
+  void report(std::ostream &os) const {
+    os << "Meas window  (cycles, batches)  : " << cycles() << ", " << lat_means.size() << (conv ? " converged" : " capped") << "\n";
+    os << "Meas CI95    (lat %, thr %)     : " << ci_rel(lat_means)*100.0 << ", " << ci_rel(thr_means)*100.0 << "\n";
+  };
+};
+
+#endif // __TB_MEAS_WINDOW_H__
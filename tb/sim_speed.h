@@ -0,0 +1,34 @@
+#ifndef __TB_SIM_SPEED_H__
+#define __TB_SIM_SPEED_H__
+
+#include <iostream>
+#include <sys/resource.h>
+#include <boost/timer/timer.hpp>
+
+// Simulation speed of a run, reported by the harness for the benchmark of examples/sim_bench.py.
+//   The timer is (re)started at the start of the simulation, thus elaboration is excluded. Cycles and
+//   transactions are per second of wall time, the peak resident memory is the OS high-water mark of the process.
+class sim_speed {
+public:
+  boost::timer::cpu_timer timer;
+
+  void start() { timer.start(); }
+
+  // Peak resident set, KB on Linux
+  static long peak_rss_kb() {
+    struct rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) != 0) return 0;
+    return ru.ru_maxrss;
+  }
+
+  void report(std::ostream &os, unsigned long long int cycles, unsigned long long int trans) {
+    timer.stop();
+    boost::timer::cpu_times t = timer.elapsed();
+    double wall = t.wall * 1e-9;
+    double cpu  = (t.user + t.system) * 1e-9;
+    os << "Sim speed  (cycles/s, trans/s) : " << (wall>0 ? cycles/wall : 0) << ", " << (wall>0 ? trans/wall : 0) << "\n";
+    os << "Sim cost   (wall s, cpu s, KB) : " << wall << ", " << cpu << ", " << peak_rss_kb() << "\n";
+  }
+};
+
+#endif // __TB_SIM_SPEED_H__
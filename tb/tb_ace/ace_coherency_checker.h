@@ -4,9 +4,12 @@
 #include "systemc.h"
 
 #include "../../src/include/dnp_ace_v0.h"
+#include "../tb_scoreboard.h"
+#include "../../src/include/home_snp_log.h"
 
 #include <deque>
 #include <queue>
+#include <functional>
 
 #include <iostream>
 #include <fstream>
@@ -27,18 +30,21 @@ SC_MODULE(ace_coherency_checker) {
   
   // Scoreboard
   sc_mutex                                                      *sb_lock;
-  std::vector< std::deque< msg_tb_wrap<ace5_::AddrPayload> > >  *sb_rd_req_q;
-  std::vector< std::deque< msg_tb_wrap<ace5_::ReadPayload> > >  *sb_rd_resp_q;
+  tb_scoreboard< msg_tb_wrap<ace5_::AddrPayload> >     *sb_rd_req_q;
+  tb_scoreboard< msg_tb_wrap<ace5_::ReadPayload> >     *sb_rd_resp_q;
   
-  std::vector< std::deque< msg_tb_wrap<ace5_::AddrPayload> > >   *sb_wr_req_q;
-  std::vector< std::deque< msg_tb_wrap<ace5_::WritePayload> > >  *sb_wr_data_q;
-  std::vector< std::deque< msg_tb_wrap<ace5_::WRespPayload> > >  *sb_wr_resp_q;
+  tb_scoreboard< msg_tb_wrap<ace5_::AddrPayload> >     *sb_wr_req_q;
+  tb_scoreboard< msg_tb_wrap<ace5_::WritePayload> >    *sb_wr_data_q;
+  tb_scoreboard< msg_tb_wrap<ace5_::WRespPayload> >    *sb_wr_resp_q;
   
-  std::vector< std::deque< msg_tb_wrap<ace5_::AddrPayload> > >   *sb_coherent_access_q;
+  tb_scoreboard< msg_tb_wrap<ace5_::AddrPayload> >     *sb_coherent_access_q;
   std::vector< std::deque< msg_tb_wrap<ace5_::AC> > >            *sb_snoop_req_q;
   std::vector< std::deque< msg_tb_wrap<ace5_::CR> > >            *sb_snoop_resp_q;
   std::vector< std::deque< msg_tb_wrap<ace5_::CD> > >            *sb_snoop_data_resp_q;
   
+  // Whether a FULL Master (0 the first) holds a line, to check the Masters a Snoop filter leaves out. Set by the harness
+  std::function<bool(unsigned, ace5_::Addr)> holds_line;
+  
 	unsigned int total_cycles;
   
   sc_time clk_period;
@@ -144,7 +150,7 @@ SC_MODULE(ace_coherency_checker) {
   // Functions
 	void do_cycle();
   
-  void     manage_bundle   (snoop_trans_bundle & cur_trans_bundle, unsigned initiator);
+  void     manage_bundle   (snoop_trans_bundle & cur_trans_bundle, unsigned initiator, ace5_::Addr snooped_addr, unsigned snooped);
   unsigned mem_map_resolve (ace5_::Addr &addr);
   bool     req_denies_dirty (NVUINTW(enc_::ARSNOOP::_WIDTH) &request_in, bool is_read );
   bool     req_no_data_resp (NVUINTW(enc_::ARSNOOP::_WIDTH) &request_in, bool is_read );
@@ -153,6 +159,7 @@ SC_MODULE(ace_coherency_checker) {
   SC_HAS_PROCESS(ace_coherency_checker);
   ace_coherency_checker(sc_module_name name_="ace_coherency_checker") : sc_module(name_)
   {
+    home_snp_log::enabled() = true; // The Snoops HOME sends per transaction
 		SC_THREAD(do_cycle);
     sensitive << clk.pos();
     reset_signal_is(rst_n, false);
@@ -177,6 +184,18 @@ void ace_coherency_checker<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, FULL_
     wait();
     
     sb_lock->lock();
+    // The transactions a Snoop filter snoops no Master for have no bundle, complete them as they are admitted
+    std::deque<home_snp_log::rec_t> &snp_recs = home_snp_log::recs();
+    for (typename std::deque<home_snp_log::rec_t>::iterator it=snp_recs.begin(); it!=snp_recs.end(); ) {
+      if (it->snooped == 0) {
+        snoop_trans_bundle no_snoops;
+        manage_bundle(no_snoops, it->initiator-SLAVE_NUM, it->addr, 0);
+        it = snp_recs.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    
     for (unsigned i=0; i<FULL_MASTER_NUM; ++i) {
       if ( !(*sb_snoop_resp_q)[i].empty() ) {
         
@@ -212,14 +231,20 @@ void ace_coherency_checker<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, FULL_
         unsigned new_count = (cur_trans_bundle_it->second).push(i, snoop_req, snoop_resp, snoop_data);
         // Existing Address of scrutineer
         // Bundled completed, Set next expected packets and reset it.
+        // Every FULL Master but the initiator is snooped, unless HOME recorded that a Snoop filter left some out
         unsigned master_initiator = (initiator - SLAVE_NUM);
-        if ( init_is_ace && (new_count == FULL_MASTER_NUM-1) ) {
-          manage_bundle(cur_trans_bundle_it->second, master_initiator);
+        unsigned snooped          = ((1u<<FULL_MASTER_NUM)-1) & ~(init_is_ace ? (1u<<master_initiator) : 0u);
+        typename std::deque<home_snp_log::rec_t>::iterator rec = snp_recs.begin();
+        while ((rec != snp_recs.end()) && !((rec->addr == snoop_req.addr.to_uint64()) && (rec->initiator == initiator))) ++rec;
+        if (rec != snp_recs.end()) snooped = rec->snooped;
+        
+        unsigned expected = 0;
+        for (unsigned m=0; m<FULL_MASTER_NUM; ++m) expected += (snooped >> m) & 1;
+        if (new_count == expected) {
+          manage_bundle(cur_trans_bundle_it->second, master_initiator, snoop_req.addr, snooped);
           (cur_trans_bundle_it->second).clear();
+          if (rec != snp_recs.end()) snp_recs.erase(rec);
           //scrutineer.erase(cur_trans_bundle_it); // ToDo : consider completely remove it to save space/ but lose time constr/deconstr
-        } else if (init_is_lite && (new_count == FULL_MASTER_NUM) ) {
-          manage_bundle(cur_trans_bundle_it->second, master_initiator);
-          (cur_trans_bundle_it->second).clear();
         }
       } // End of new bundle handle
     } // End for Masters
@@ -237,7 +262,7 @@ void ace_coherency_checker<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, FULL_
 // --------------------------- //
 
 template <unsigned int RD_M_LANES, unsigned int RD_S_LANES, unsigned int WR_M_LANES, unsigned int WR_S_LANES, unsigned int FULL_MASTER_NUM, unsigned int LITE_MASTER_NUM, unsigned int SLAVE_NUM>
-void ace_coherency_checker<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, FULL_MASTER_NUM, LITE_MASTER_NUM, SLAVE_NUM>::manage_bundle (snoop_trans_bundle & cur_trans_bundle, unsigned initiator) {
+void ace_coherency_checker<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, FULL_MASTER_NUM, LITE_MASTER_NUM, SLAVE_NUM>::manage_bundle (snoop_trans_bundle & cur_trans_bundle, unsigned initiator, ace5_::Addr snooped_addr, unsigned snooped) {
   
   // This is deprecated, when the lack of a snoop response gives hints the initiator.
   // To add ACE LITE nodes, this is impossible and the initiator is passed by the HOME through the PROT field
@@ -257,25 +282,34 @@ void ace_coherency_checker<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, FULL_
   ace5_::AddrPayload coherent_init;
   bool               coherent_init_found = false;
   bool is_read;
-  int dbg_size = (*sb_coherent_access_q)[initiator].size();
-  for (int i=0; i<(*sb_coherent_access_q)[initiator].size(); ++i) {
-    msg_tb_wrap<ace5_::AddrPayload> cur_coherent_req = ((*sb_coherent_access_q)[initiator][i]);
-    if (cur_coherent_req.dut_msg.addr == cur_trans_bundle.ac[(initiator+1)%FULL_MASTER_NUM].addr) {
+  sb_key_t    init_key     = sb_key(initiator, 0, snooped_addr.to_uint64());
+  int dbg_size = sb_coherent_access_q->size(init_key);
+  for (int i=sb_coherent_access_q->first(init_key); i!=SB_NIL; i=sb_coherent_access_q->next(i)) {
+    msg_tb_wrap<ace5_::AddrPayload> &cur_coherent_req = sb_coherent_access_q->at(i);
+    if (cur_coherent_req.dut_msg.addr == snooped_addr) {
       coherent_init       = cur_coherent_req.dut_msg;
       coherent_init_found = true;
       is_read             = cur_coherent_req.is_read;
-      (*sb_coherent_access_q)[initiator].erase((*sb_coherent_access_q)[initiator].begin()+i);
+      sb_coherent_access_q->erase(init_key, i);
       break;
     }
   }
   NVHLS_ASSERT_MSG(coherent_init_found, "Init transaction not found!");
   
+  // A Master that HOME did not snoop must not hold the line
+  for (int i=0; i<FULL_MASTER_NUM; ++i) {
+    if ((i != initiator) && !((snooped >> i) & 1) && holds_line && holds_line(i, snooped_addr)) {
+      std::cout << "ERR : HOME did not snoop M#" << i+SLAVE_NUM << " that holds the line of access: " << coherent_init << "\n";
+      NVHLS_ASSERT(0);
+    }
+  }
+  
   // Check that all Snoop requests are the same and of correct type.
   ace5_::AC snoop_type_expected;
   snoop_type_expected.addr  = coherent_init.addr;
   snoop_type_expected.snoop = is_read ? ace::rd_2_snoop(coherent_init.snoop) : ace::wr_2_snoop(coherent_init.snoop);
   for (int i=0; i<FULL_MASTER_NUM; ++i) {
-    if(i != initiator) {
+    if(cur_trans_bundle.valid[i]) {
       bool addr_is_equal  = (cur_trans_bundle.ac[i].addr == snoop_type_expected.addr);
       bool snoop_is_equal = (cur_trans_bundle.ac[i].snoop == snoop_type_expected.snoop);
       if (!(addr_is_equal && snoop_is_equal)) {
@@ -293,7 +327,7 @@ void ace_coherency_checker<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, FULL_
   bool got_data  = false;
   bool got_dirty = false;
   for (int i=0; i<FULL_MASTER_NUM; ++i) {
-    if(i != initiator) {
+    if(cur_trans_bundle.valid[i]) {
       resp_accum |= cur_trans_bundle.cr[i].resp;
       bool this_has_data = cur_trans_bundle.cr[i].resp & 0x1;
       bool this_dirty    = cur_trans_bundle.cr[i].resp & 0x4;
@@ -332,13 +366,13 @@ void ace_coherency_checker<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, FULL_
     temp_wr_req_tb.dut_msg.barrier = 0;
     
     unsigned tgt_mem = mem_map_resolve(coherent_init.addr);
-    (*sb_wr_req_q)[tgt_mem].push_back(temp_wr_req_tb);
+    sb_wr_req_q->push(sb_key(tgt_mem, coherent_init.id.to_uint() & ((1<<dnp::ace::ID_W)-1)), temp_wr_req_tb);
     
     msg_tb_wrap< ace5_::WritePayload > wr_back_beat;
     wr_back_beat.dut_msg.data  = snoop_data.data;
     wr_back_beat.dut_msg.last  = snoop_data.last;
     wr_back_beat.dut_msg.wstrb = -1;
-    (*sb_wr_data_q)[tgt_mem].push_back(wr_back_beat);
+    sb_wr_data_q->push(sb_key(tgt_mem, sb_wr_initiator(wr_back_beat.dut_msg, WR_S_LANES)), wr_back_beat);
   }
   
   // Setup scoreboards to reflect the responses
@@ -356,7 +390,7 @@ void ace_coherency_checker<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, FULL_
       msg_tb_wrap<ace5_::ReadPayload> temp_rd_resp_tb;
       temp_rd_resp_tb.dut_msg = data_responce;
   
-      (*sb_rd_resp_q)[initiator].push_back(temp_rd_resp_tb);
+      sb_rd_resp_q->push(sb_key(initiator, temp_rd_resp_tb.dut_msg.resp.to_uint(), coherent_init.id.to_uint() & ((1<<dnp::ace::ID_W)-1)), temp_rd_resp_tb);
       
     } else {
       // Generate expected request to Mem
@@ -368,7 +402,7 @@ void ace_coherency_checker<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, FULL_
       temp_rd_req_tb.dut_msg.barrier = 0;
       
       unsigned tgt_mem = mem_map_resolve(coherent_init.addr);
-      (*sb_rd_req_q)[tgt_mem].push_back(temp_rd_req_tb);
+      sb_rd_req_q->push(sb_key(tgt_mem, coherent_init.id.to_uint() & ((1<<dnp::ace::ID_W)-1)), temp_rd_req_tb);
       
       // Generate expected responce from Mem
       ace5_::ReadPayload beat_expected;
@@ -388,7 +422,7 @@ void ace_coherency_checker<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, FULL_
           temp_rd_resp_tb.dut_msg  = beat_expected;
           temp_rd_resp_tb.time_gen = sc_time_stamp();
       
-          (*sb_rd_resp_q)[initiator].push_back(temp_rd_resp_tb);
+          sb_rd_resp_q->push(sb_key(initiator, temp_rd_resp_tb.dut_msg.resp.to_uint(), coherent_init.id.to_uint() & ((1<<dnp::ace::ID_W)-1)), temp_rd_resp_tb);
           beat_expected.data = 0;
         }
       }
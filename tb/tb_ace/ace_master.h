@@ -6,6 +6,11 @@
 #include "../helper_non_synth.h"
 #include "../../src/include/dnp_ace_v0.h"
 #include "../tb_wrap.h"
+#include "../tb_scoreboard.h"
+#include "../lat_hist.h"
+#include "../meas_window.h"
+#include "../axi_trace.h"
+#include "../../src/include/evt_trace.h"
 
 #include <deque>
 #include <queue>
@@ -52,14 +57,14 @@ SC_MODULE(ace_master) {
   
   // Scoreboard
   sc_mutex                                                      *sb_lock;
-  std::vector< std::deque< msg_tb_wrap<ace5_::AddrPayload> > >  *sb_rd_req_q;
-  std::vector< std::deque< msg_tb_wrap<ace5_::ReadPayload> > >  *sb_rd_resp_q;
+  tb_scoreboard< msg_tb_wrap<ace5_::AddrPayload> >     *sb_rd_req_q;
+  tb_scoreboard< msg_tb_wrap<ace5_::ReadPayload> >     *sb_rd_resp_q;
   
-  std::vector< std::deque< msg_tb_wrap<ace5_::AddrPayload > > >  *sb_wr_req_q;
-  std::vector< std::deque< msg_tb_wrap<ace5_::WritePayload> > >  *sb_wr_data_q;
-  std::vector< std::deque< msg_tb_wrap<ace5_::WRespPayload> > >  *sb_wr_resp_q;
+  tb_scoreboard< msg_tb_wrap<ace5_::AddrPayload> >     *sb_wr_req_q;
+  tb_scoreboard< msg_tb_wrap<ace5_::WritePayload> >    *sb_wr_data_q;
+  tb_scoreboard< msg_tb_wrap<ace5_::WRespPayload> >    *sb_wr_resp_q;
   
-  std::vector< std::deque< msg_tb_wrap<ace5_::AddrPayload> > >   *sb_coherent_access_q;
+  tb_scoreboard< msg_tb_wrap<ace5_::AddrPayload> >     *sb_coherent_access_q;
   std::vector< std::deque< msg_tb_wrap<ace5_::AC> > >            *sb_snoop_req_q;
   std::vector< std::deque< msg_tb_wrap<ace5_::CR> > >            *sb_snoop_resp_q;
   std::vector< std::deque< msg_tb_wrap<ace5_::CD> > >            *sb_snoop_data_resp_q;
@@ -75,8 +80,8 @@ SC_MODULE(ace_master) {
   std::queue<ace5_::RACK>  stored_rd_ack;
   std::queue<ace5_::WACK>  stored_wr_ack;
   
-  std::deque<ace5_::AddrPayload>  sb_rd_order_q; // queue to check ordering
-  std::deque<ace5_::AddrPayload>  sb_wr_order_q; // queue to check ordering
+  tb_scoreboard<ace5_::AddrPayload>  sb_rd_order_q; // Outstanding requests per ID, to check ordering
+  tb_scoreboard<ace5_::AddrPayload>  sb_wr_order_q; // Outstanding requests per ID, to check ordering
   
   // Cache state keeping
   class cache_line {
@@ -127,10 +132,18 @@ SC_MODULE(ace_master) {
   std::map<ace5_::Addr, int>        cache_outstanding;
   std::map<ace5_::Addr, int>        cache_outstanding_writes;
   
+  // Whether the cache holds a valid copy of the line
+  bool holds_line(ace5_::Addr addr) {
+    typename std::map<ace5_::Addr, cache_line>::iterator it = cache.find(addr);
+    return (it != cache.end()) && !it->second.is_inv();
+  };
+  
 	int MASTER_ID  = -1;
 	unsigned int AXI_GEN_RATE_RD;
   unsigned int AXI_GEN_RATE_WR;
   unsigned int ACE_GEN_RATE_CACHE;
+  trace_writer *trace_out; // Records the pushed AR/AW/W and the received AC when set
+  trace_replay  replay;    // Replays a trace instead of the random generators when its src is set
   // int FLOW_CTRL;     // 0: READY-VALID
   //                    // 1: CREDITS 
   //                    // 2: FIFO
@@ -148,6 +161,10 @@ SC_MODULE(ace_master) {
   unsigned long long int last_wr_sinked_cycle = 0;
   unsigned long long int rd_resp_data_count = 0;
   unsigned long long int wr_resp_data_count = 0;
+  // Latency distribution per target slave
+  lat_hist rd_lat[SLAVE_NUM];
+  lat_hist wr_lat[SLAVE_NUM];
+  meas_window *meas; // Only the marked requests are measured when set
   
 	bool stop_at_tail, has_stopped_gen;
 	
@@ -168,6 +185,11 @@ SC_MODULE(ace_master) {
   unsigned int gen_wr_addr;
   unsigned int resp_val_expect;
   
+  trace_deps  deps;      // Outstanding and completed requests of the trace
+  uint32_t    trace_seq;
+  
+  evt_ring    evt;       // Event trace (see evt_trace.h)
+  
   // Read Responce Sink
   int rd_resp_ej;
   int wr_resp_ej;
@@ -180,7 +202,16 @@ SC_MODULE(ace_master) {
 	void do_cycle();
 	void gen_new_rd_trans();
 	void gen_new_wr_trans();
-	void gen_new_cache_trans();
+	unsigned gen_new_cache_trans(int line = -1);
+	void issue_rd_trans(ace5_::AddrPayload &rd_req_m);
+	void issue_wr_trans(ace5_::AddrPayload &m_wr_req);
+	void replay_trans(const trace_rec &rec);
+	void record_req(const ace5_::AddrPayload &req, bool is_wr);
+	void record_data(const ace5_::WritePayload &beat);
+	void record_snoop(const ace5_::AC &snoop_req);
+  
+  unsigned long long int cur_cycle() { return (unsigned long long int)(sc_time_stamp() / clk_period); };
+  bool replay_done() { return replay.done(); };
 	
 	void gen_snoop_resp(ace5_::AC &rcv_snoop_req);
 	
@@ -203,6 +234,9 @@ SC_MODULE(ace_master) {
     AXI_GEN_RATE_RD      = 0;
     AXI_GEN_RATE_WR      = 0;
     ACE_GEN_RATE_CACHE   = 5;
+    trace_out            = NULL;
+    meas                 = NULL;
+    evt.init(this->name());
     
 		SC_THREAD(do_cycle);
     sensitive << clk.pos();
@@ -253,6 +287,9 @@ void ace_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAV
   b_in.Reset();
   wack_out.Reset();
   
+  deps.reset();
+  trace_seq = 0;
+  
   //if (MASTER_ID == 2) cache[8] = cache_line(0xFF00FF00FF00FF00, cache_line::State::UC);
   //if (MASTER_ID == 3) cache[8] = cache_line(0xAA00AA00AA00AA00, cache_line::State::SD);
   //if (MASTER_ID == 4) cache[8] = cache_line(0xFF00FF00FF00FF00, cache_line::State::SC);
@@ -262,7 +299,10 @@ void ace_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAV
     total_cycles++;
     
     // Transaction Generator
-    if (!stop_gen.read()) {
+    if (!stop_gen.read() && replay.active()) {
+      const trace_rec *rec;
+      while ((rec = replay.next(deps, cur_cycle())) != NULL) replay_trans(*rec);
+    } else if (!stop_gen.read()) {
       unsigned int rnd_val_rd = rand()%100;
       if (rnd_val_rd < AXI_GEN_RATE_RD) {
         gen_new_rd_trans();
@@ -288,7 +328,9 @@ void ace_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAV
         if (ar_out.PushNB(tmp_ar)) {
           stored_rd_trans.pop();
     
-          std::cout << "[Master " << MASTER_ID << "] : PUSHED AR:" << tmp_ar << " @" << sc_time_stamp() << std::endl;
+          EVT_TRACE(EVT_LVL_TXN, evt, EVT_AR, tmp_ar.id.to_uint(), tmp_ar.addr.to_uint64(), tmp_ar.len.to_uint(),
+                    std::cout << "[Master " << MASTER_ID << "] : PUSHED AR:" << tmp_ar << " @" << sc_time_stamp() << "\n");
+          if (trace_out) record_req(tmp_ar, false);
           rd_trans_inj++;
           if(is_coherent) {
             cache_outstanding[tmp_ar.addr]++;
@@ -300,7 +342,7 @@ void ace_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAV
             temp_rd_coherent_req_tb.is_read  = true;
             temp_rd_coherent_req_tb.time_gen = sc_time_stamp();
             
-            (*sb_coherent_access_q)[MASTER_ID - SLAVE_NUM].push_back(temp_rd_coherent_req_tb);
+            sb_coherent_access_q->push(sb_key(MASTER_ID - SLAVE_NUM, 0, tmp_ar.addr.to_uint64()), temp_rd_coherent_req_tb);
             sb_lock->unlock();
           }
         }
@@ -317,7 +359,9 @@ void ace_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAV
         if (aw_out.PushNB(tmp_aw)) {
           stored_wr_trans.pop();
     
-          std::cout << "[Master " << MASTER_ID << "] : PUSHED AW: " << tmp_aw << " @" << sc_time_stamp() << std::endl;
+          EVT_TRACE(EVT_LVL_TXN, evt, EVT_AW, tmp_aw.id.to_uint(), tmp_aw.addr.to_uint64(), tmp_aw.len.to_uint(),
+                    std::cout << "[Master " << MASTER_ID << "] : PUSHED AW: " << tmp_aw << " @" << sc_time_stamp() << "\n");
+          if (trace_out) record_req(tmp_aw, true);
           wr_trans_inj++;
           if(is_coherent) {
             cache_outstanding[tmp_aw.addr]++;
@@ -329,7 +373,7 @@ void ace_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAV
             temp_wr_coherent_req_tb.is_read  = false;
             temp_wr_coherent_req_tb.time_gen = sc_time_stamp();
             
-            (*sb_coherent_access_q)[MASTER_ID - SLAVE_NUM].push_back(temp_wr_coherent_req_tb);
+            sb_coherent_access_q->push(sb_key(MASTER_ID - SLAVE_NUM, 0, tmp_aw.addr.to_uint64()), temp_wr_coherent_req_tb);
             sb_lock->unlock();
           }
         }
@@ -342,7 +386,9 @@ void ace_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAV
       if (w_out.PushNB(tmp_w)) {
         stored_wr_data.pop();
   
-        std::cout << "[Master " << MASTER_ID << "] : PUSHED W: " << tmp_w << " @" << sc_time_stamp() << std::endl;
+        EVT_TRACE(EVT_LVL_BEAT, evt, EVT_W, 0, 0, tmp_w.last.to_uint(),
+                  std::cout << "[Master " << MASTER_ID << "] : PUSHED W: " << tmp_w << " @" << sc_time_stamp() << "\n");
+        if (trace_out) record_data(tmp_w);
         wr_data_inj++;
       }
     }
@@ -367,6 +413,7 @@ void ace_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAV
     ace5_::AC rcv_snoop_req;
     bool got_snoop_req = ac_in.PopNB(rcv_snoop_req);  // Lacks backpressure
     if(got_snoop_req){
+      if (trace_out) record_snoop(rcv_snoop_req);
       // ToDo : Implement ACE verification
       //verify_snoop_req(got_snoop_req);
       gen_snoop_resp(rcv_snoop_req);
@@ -378,7 +425,8 @@ void ace_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAV
       if (cr_out.PushNB(tmp_cr)) {
         stored_cache_resp.pop();
       
-        std::cout << "[Master " << MASTER_ID << "] : PUSHED SNOOP Resp: " << tmp_cr << " @" << sc_time_stamp() << std::endl;
+        EVT_TRACE(EVT_LVL_TXN, evt, EVT_CR, 0, 0, tmp_cr.resp.to_uint(),
+                  std::cout << "[Master " << MASTER_ID << "] : PUSHED SNOOP Resp: " << tmp_cr << " @" << sc_time_stamp() << "\n");
         //cache_resp_inj++;
       }
     }
@@ -389,7 +437,8 @@ void ace_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAV
       if (cd_out.PushNB(tmp_cd)) {
         stored_cache_data.pop();
       
-        std::cout << "[Master " << MASTER_ID << "] : PUSHED SNOOP Data: " << tmp_cd << " @" << sc_time_stamp() << std::endl;
+        EVT_TRACE(EVT_LVL_BEAT, evt, EVT_CD, 0, 0, tmp_cd.last.to_uint(),
+                  std::cout << "[Master " << MASTER_ID << "] : PUSHED SNOOP Data: " << tmp_cd << " @" << sc_time_stamp() << "\n");
         //cache_resp_data_inj++;
       }
     }
@@ -399,7 +448,8 @@ void ace_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAV
       ace5_::RACK tmp_rack = stored_rd_ack.front();
       if (rack_out.PushNB(tmp_rack)) {
         stored_rd_ack.pop();
-        std::cout << "[Master " << MASTER_ID << "] : PUSHED READ Ack: " << tmp_rack << " @" << sc_time_stamp() << std::endl;
+        EVT_TRACE(EVT_LVL_TXN, evt, EVT_RACK, 0, 0, 0,
+                  std::cout << "[Master " << MASTER_ID << "] : PUSHED READ Ack: " << tmp_rack << " @" << sc_time_stamp() << "\n");
       }
     }
   
@@ -408,7 +458,8 @@ void ace_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAV
       ace5_::WACK tmp_wack = stored_wr_ack.front();
       if (wack_out.PushNB(tmp_wack)) {
         stored_wr_ack.pop();
-        std::cout << "[Master " << MASTER_ID << "] : PUSHED WRITE Ack: " << tmp_wack << " @" << sc_time_stamp() << std::endl;
+        EVT_TRACE(EVT_LVL_TXN, evt, EVT_WACK, 0, 0, 0,
+                  std::cout << "[Master " << MASTER_ID << "] : PUSHED WRITE Ack: " << tmp_wack << " @" << sc_time_stamp() << "\n");
       }
     }
     
@@ -434,6 +485,12 @@ void ace_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAV
   rd_req_m.addr = gen_rd_addr + ((rand()%RD_M_LANES) & (1<<rd_req_m.size));
   gen_rd_addr   = (gen_rd_addr + RD_M_LANES) % (addr_map[SLAVE_NUM-1][1].read()+1);
   
+  issue_rd_trans(rd_req_m);
+}; // End of Read generator
+
+// Queues a non-coherent Read for injection and pushes the expected transactions to the Scoreboard
+template <unsigned int RD_M_LANES, unsigned int RD_S_LANES, unsigned int WR_M_LANES, unsigned int WR_S_LANES, unsigned int MASTER_NUM, unsigned int SLAVE_NUM>
+void ace_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAVE_NUM>::issue_rd_trans(ace5_::AddrPayload &rd_req_m) {
   // Push it to injection queue
   stored_rd_trans.push(rd_req_m);
   
@@ -453,11 +510,11 @@ void ace_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAV
   temp_rd_req_tb.time_gen = sc_time_stamp();
   
   unsigned dst = mem_map_resolve(rd_req_s.addr);
-  (*sb_rd_req_q)[dst].push_back(temp_rd_req_tb);
+  sb_rd_req_q->push(sb_key(dst, rd_req_s.id.to_uint() & ((1<<dnp::ace::ID_W)-1)), temp_rd_req_tb);
   sb_lock->unlock();
   
   // Push into order queue - Reorder check extension
-  sb_rd_order_q.push_back(rd_req_m);
+  sb_rd_order_q.push(sb_key(rd_req_m.id.to_uint()), rd_req_m);
   
   rd_trans_generated++;
   
@@ -495,7 +552,7 @@ void ace_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAV
       temp_rd_resp_tb.dut_msg  = beat_expected;
       temp_rd_resp_tb.time_gen = sc_time_stamp();
       
-      (*sb_rd_resp_q)[MASTER_ID-SLAVE_NUM].push_back(temp_rd_resp_tb);
+      sb_rd_resp_q->push(sb_key(MASTER_ID-SLAVE_NUM, beat_expected.resp.to_uint(), beat_expected.id.to_uint() & ((1<<dnp::ace::ID_W)-1)), temp_rd_resp_tb);
       beat_expected.data = 0;
   
       rd_data_generated++;
@@ -506,7 +563,6 @@ void ace_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAV
 
 template <unsigned int RD_M_LANES, unsigned int RD_S_LANES, unsigned int WR_M_LANES, unsigned int WR_S_LANES, unsigned int MASTER_NUM, unsigned int SLAVE_NUM>
 void ace_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAVE_NUM>::gen_new_wr_trans() {
-  sb_lock->lock();
   ace5_::AddrPayload m_wr_req;//(SINGLE, -1, -1, -1);
   
   m_wr_req.id    = (rand()%AXI_TID_NUM) | (MASTER_ID << 2); // (rand()%4)+2;
@@ -522,11 +578,18 @@ void ace_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAV
   m_wr_req.addr  = gen_wr_addr + ((rand()%WR_M_LANES) & (1<<m_wr_req.size));
   gen_wr_addr    = (gen_wr_addr + WR_M_LANES) % (addr_map[SLAVE_NUM-1][1].read()+1);;
   
+  issue_wr_trans(m_wr_req);
+}; // End of Write generator
+
+// Queues a non-coherent Write and its data for injection and pushes the expected transactions to the Scoreboard
+template <unsigned int RD_M_LANES, unsigned int RD_S_LANES, unsigned int WR_M_LANES, unsigned int WR_S_LANES, unsigned int MASTER_NUM, unsigned int SLAVE_NUM>
+void ace_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAVE_NUM>::issue_wr_trans(ace5_::AddrPayload &m_wr_req) {
+  sb_lock->lock();
   // Push it to injection queue
   stored_wr_trans.push(m_wr_req);
   
   // Push into order queue - Reorder check extension
-  sb_wr_order_q.push_back(m_wr_req);
+  sb_wr_order_q.push(sb_key(m_wr_req.id.to_uint()), m_wr_req);
   
   // Create dummy write data
   ace5_::WritePayload cur_beat;      // The beat that will be injected at MASTER
@@ -559,7 +622,10 @@ void ace_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAV
   temp_wr_req_tb.dut_msg = s_wr_req;
   
   unsigned dst = mem_map_resolve(s_wr_req.addr);
-  (*sb_wr_req_q)[dst].push_back(temp_wr_req_tb);
+  sb_wr_req_q->push(sb_key(dst, s_wr_req.id.to_uint() & ((1<<dnp::ace::ID_W)-1)), temp_wr_req_tb);
+  
+  // The beats expected at the Slave, queued once the initiator of the last is known
+  std::vector< msg_tb_wrap<ace5_::WritePayload> > beats_at_slave;
   
   cur_beat.data  = 0;
   cur_beat.wstrb = 0;
@@ -595,29 +661,34 @@ void ace_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAV
       msg_tb_wrap< ace5_::WritePayload > temp_wr_data_tb;
       temp_wr_data_tb.dut_msg = beat_at_slave;
         
-      wr_resp_data_count++;
+      if (!meas || meas->in(sc_time_stamp())) wr_resp_data_count++;
       last_wr_sinked_cycle = (sc_time_stamp() / clk_period);
       
-      (*sb_wr_data_q)[dst].push_back(temp_wr_data_tb);
+      beats_at_slave.push_back(temp_wr_data_tb);
       beat_at_slave.data  = 0;
       beat_at_slave.wstrb = 0;
     }
   }
   
+  sb_key_t data_key = sb_key(dst, sb_wr_initiator(beats_at_slave.back().dut_msg, WR_S_LANES));
+  for (unsigned i=0; i<beats_at_slave.size(); ++i) sb_wr_data_q->push(data_key, beats_at_slave[i]);
+  
   sb_lock->unlock();
   
   wr_trans_generated++;
-}; // End of Write generator
+}; // End of Write issue
 
+// Generates a coherent transaction, legal for the current state of the line. A random line when line<0.
+// Returns the generated direction : 0 none (the line got evicted), 1 Read, 2 Write
 template <unsigned int RD_M_LANES, unsigned int RD_S_LANES, unsigned int WR_M_LANES, unsigned int WR_S_LANES, unsigned int MASTER_NUM, unsigned int SLAVE_NUM>
-void ace_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAVE_NUM>::gen_new_cache_trans() {
+unsigned ace_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAVE_NUM>::gen_new_cache_trans(int line) {
   ace5_::AddrPayload cache_req;
   
   cache_req.id    = MASTER_ID;// (rand() % AXI_TID_NUM); // (rand()% 2)+2;
   cache_req.size  = nvhls::log2_ceil<RD_M_LANES>::val;
   cache_req.burst = enc_::AXBURST::INCR;
   cache_req.len   = 0;
-  cache_req.addr  = ((rand()%ACE_CACHE_LINES)+1) * (ace5_::C_CACHE_WIDTH>>3);//0x8;
+  cache_req.addr  = (((line<0) ? (rand()%ACE_CACHE_LINES) : (line%ACE_CACHE_LINES))+1) * (ace5_::C_CACHE_WIDTH>>3);//0x8;
   
   cache_line & this_line = cache[cache_req.addr];
   
@@ -652,7 +723,7 @@ void ace_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAV
     is_read = (sel_req < 1);
   } else if (this_line.is_ud()) {
     this_line.state = cache_line::State::INV;
-    return;
+    return 0;
   } else if (this_line.is_sc()) {
     unsigned sel_req = rand() % 5;
     // RD_ONCE, RD_SHARED, RD_CLEAN, RD_NOT_SHARED_DIRTY, RD_UNIQUE, CLEAN_UNIQUE, MAKE_UNIQUE, CLEAN_SHARED, CLEAN_INVALID, MAKE_INVALID
@@ -665,7 +736,7 @@ void ace_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAV
     is_read = (sel_req<3);
   } else if (this_line.is_sd()) {
     this_line.state = cache_line::State::INV;
-    return;
+    return 0;
     
     unsigned sel_req = rand() % 2;
     // RD_ONCE, RD_SHARED, RD_CLEAN, RD_NOT_SHARED_DIRTY, RD_UNIQUE, CLEAN_UNIQUE, MAKE_UNIQUE, CLEAN_SHARED, CLEAN_INVALID, MAKE_INVALID
@@ -685,7 +756,7 @@ void ace_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAV
       // Pushing to ACE Coherency checker happens during injection
     
       // Push into order queue - Reorder check extension
-      sb_rd_order_q.push_back(cache_req);
+      sb_rd_order_q.push(sb_key(cache_req.id.to_uint()), cache_req);
     
       rd_trans_generated++;
     } else {  // It's a WR request
@@ -710,24 +781,120 @@ void ace_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAV
       temp_wr_coherent_req_tb.dut_msg.barrier = 0;
       temp_wr_coherent_req_tb.dut_msg.unique  = 0;
       temp_wr_coherent_req_tb.time_gen        = sc_time_stamp();
-      (*sb_wr_req_q)[target_mem].push_back(temp_wr_coherent_req_tb);
+      sb_wr_req_q->push(sb_key(target_mem, cache_req.id.to_uint() & ((1<<dnp::ace::ID_W)-1)), temp_wr_coherent_req_tb);
     
       msg_tb_wrap<ace5_::WritePayload> temp_wr_data_tb;
       temp_wr_data_tb.dut_msg = data_beat;
       temp_wr_data_tb.is_read = false;
       temp_wr_data_tb.time_gen = sc_time_stamp();
     
-      (*sb_wr_data_q)[target_mem].push_back(temp_wr_data_tb);
+      sb_wr_data_q->push(sb_key(target_mem, sb_wr_initiator(data_beat, WR_S_LANES)), temp_wr_data_tb);
       sb_lock->unlock();
     
       // Push into order queue - Reorder check extension
-      sb_wr_order_q.push_back(cache_req);
+      sb_wr_order_q.push(sb_key(cache_req.id.to_uint()), cache_req);
       wr_trans_generated++;
     }
     cache_trans_generated++;
   }
+  return is_read ? 1 : 2;
 }; // End of Cache generator
 
+// ------------------------ //
+// --- TRACE Functions  --- //
+// ------------------------ //
+// Replays a traced request. Non-coherent requests are legalized to what this testbench supports
+// (size, burst, len, mapped address) and their data follow the self-checking pattern of the generators.
+// Coherent requests keep their timing and cache line (folded onto the modeled lines), but the
+// transaction is the one the cache model allows for the current line state.
+template <unsigned int RD_M_LANES, unsigned int RD_S_LANES, unsigned int WR_M_LANES, unsigned int WR_S_LANES, unsigned int MASTER_NUM, unsigned int SLAVE_NUM>
+void ace_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAVE_NUM>::replay_trans(const trace_rec &rec) {
+  bool is_wr = (rec.kind == trace_rec::AW);
+  
+  bool is_coherent = rec.snoop || (rec.domain==1) || (rec.domain==2);
+  if (is_coherent) {
+    unsigned dir = gen_new_cache_trans(rec.addr / (ace5_::C_CACHE_WIDTH>>3));
+    if (dir) deps.issued((dir==2), MASTER_ID & ((1<<dnp::ace::ID_W)-1), rec.seq);
+    else     deps.done(rec.seq, cur_cycle());
+    return;
+  }
+  
+  unsigned m_lanes = is_wr ? WR_M_LANES : RD_M_LANES;
+  unsigned s_lanes = is_wr ? WR_S_LANES : RD_S_LANES;
+  
+  ace5_::AddrPayload req;
+  rec.get_req(req);
+  req.id = is_wr ? ((rec.id%AXI_TID_NUM) | (MASTER_ID << 2)) : (rec.id%AXI_TID_NUM);
+  
+  unsigned size = rec.size;
+  if (size > my_log2c(m_lanes)) size = my_log2c(m_lanes);
+  if (size < 1)                 size = 1 & ((1<<my_log2c(m_lanes))-1); // 0 size is NOT supported
+  req.size = size;
+  
+  unsigned len = rec.len;
+  if (rec.burst == enc_::AXBURST::WRAP && len!=1 && len!=3 && len!=7 && len!=15) req.burst = enc_::AXBURST::INCR;
+  else if (rec.burst > enc_::AXBURST::WRAP)                                       req.burst = enc_::AXBURST::INCR;
+  if (req.burst == enc_::AXBURST::FIXED && len > 15) len = 15;
+  // Downsizing multiplies the beats at the slave, keep them within 256
+  if ((1u<<size) > s_lanes) {
+    unsigned max_len = (256 >> (size-my_log2c(s_lanes))) - 1;
+    if (len > max_len) len = max_len;
+  }
+  req.len = len;
+  
+  // Unmapped addresses are folded in the address map. Aligned on size
+  ace5_::Addr addr = rec.addr;
+  bool mapped = false;
+  for (int i=0; i<SLAVE_NUM; ++i) mapped = mapped || (addr>=addr_map[i][0].read() && addr <= addr_map[i][1].read());
+  if (!mapped) addr = addr_map[0][0].read() + (rec.addr % (addr_map[SLAVE_NUM-1][1].read() - addr_map[0][0].read() + 1));
+  req.addr = addr & ~((ace5_::Addr)((1<<size)-1));
+  
+  deps.issued(is_wr, req.id.to_uint() & ((1<<dnp::ace::ID_W)-1), rec.seq);
+  if (is_wr) issue_wr_trans(req);
+  else       issue_rd_trans(req);
+}; // End of Replay
+
+template <unsigned int RD_M_LANES, unsigned int RD_S_LANES, unsigned int WR_M_LANES, unsigned int WR_S_LANES, unsigned int MASTER_NUM, unsigned int SLAVE_NUM>
+void ace_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAVE_NUM>::record_req(const ace5_::AddrPayload &req, bool is_wr) {
+  unsigned long long int now = cur_cycle();
+  trace_rec rec;
+  rec.kind    = is_wr ? trace_rec::AW : trace_rec::AR;
+  rec.master  = MASTER_ID;
+  rec.cycle   = now;
+  rec.set_req(req);
+  rec.snoop   = req.snoop.to_uint();
+  rec.domain  = req.domain.to_uint();
+  rec.barrier = req.barrier.to_uint();
+  rec.unique  = req.unique.to_uint();
+  rec.seq     = trace_seq++;
+  rec.dep     = deps.last_done;
+  rec.dep_gap = (deps.last_done == trace_rec::NO_DEP) ? 0 : (uint32_t)(now - deps.last_done_cycle);
+  trace_out->put(rec);
+  if (!replay.active()) deps.issued(is_wr, req.id.to_uint() & ((1<<dnp::ace::ID_W)-1), rec.seq);
+};
+
+template <unsigned int RD_M_LANES, unsigned int RD_S_LANES, unsigned int WR_M_LANES, unsigned int WR_S_LANES, unsigned int MASTER_NUM, unsigned int SLAVE_NUM>
+void ace_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAVE_NUM>::record_data(const ace5_::WritePayload &beat) {
+  trace_rec rec;
+  rec.kind   = trace_rec::W;
+  rec.master = MASTER_ID;
+  rec.cycle  = cur_cycle();
+  rec.set_data(beat);
+  trace_out->put(rec);
+};
+
+template <unsigned int RD_M_LANES, unsigned int RD_S_LANES, unsigned int WR_M_LANES, unsigned int WR_S_LANES, unsigned int MASTER_NUM, unsigned int SLAVE_NUM>
+void ace_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAVE_NUM>::record_snoop(const ace5_::AC &snoop_req) {
+  trace_rec rec;
+  rec.kind   = trace_rec::AC;
+  rec.master = MASTER_ID;
+  rec.cycle  = cur_cycle();
+  rec.addr   = snoop_req.addr.to_uint64();
+  rec.snoop  = snoop_req.snoop.to_uint();
+  rec.prot   = snoop_req.prot.to_uint();
+  trace_out->put(rec);
+};
+
 
 template <unsigned int RD_M_LANES, unsigned int RD_S_LANES, unsigned int WR_M_LANES, unsigned int WR_S_LANES, unsigned int MASTER_NUM, unsigned int SLAVE_NUM>
 void ace_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAVE_NUM>::gen_snoop_resp(ace5_::AC &rcv_snoop_req) {
@@ -743,12 +910,14 @@ void ace_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAV
   ace5_::CD cur_data;
   bool has_data = false;
   if (cur_line_iter == cache.end() || cur_line_iter->second.is_inv()) {
-    std::cout << "[Master " << MASTER_ID << "] SNOOP Miss " << rcv_snoop_req << "@" << sc_time_stamp() << "\n";
+    EVT_TRACE(EVT_LVL_TXN, evt, EVT_AC, rcv_snoop_req.snoop.to_uint(), rcv_snoop_req.addr.to_uint64(), 0,
+              std::cout << "[Master " << MASTER_ID << "] SNOOP Miss " << rcv_snoop_req << "@" << sc_time_stamp() << "\n");
     cur_resp.resp = 0;
     has_data = false;
   } else {
-    std::cout << "[Master " << MASTER_ID << "] SNOOP Hit @" << sc_time_stamp() << " " << rcv_snoop_req;
-    std::cout << " --- Addr:"<< std::hex << cur_line_iter->first << std::dec << " : " << cur_line_iter->second << "\n";
+    EVT_TRACE(EVT_LVL_TXN, evt, EVT_AC, rcv_snoop_req.snoop.to_uint(), rcv_snoop_req.addr.to_uint64(), 1,
+              std::cout << "[Master " << MASTER_ID << "] SNOOP Hit @" << sc_time_stamp() << " " << rcv_snoop_req;
+              std::cout << " --- Addr:"<< std::hex << cur_line_iter->first << std::dec << " : " << cur_line_iter->second << "\n");
   
     cur_data.data = cur_line_iter->second.data;
     cur_data.last = 1;
@@ -1346,41 +1515,48 @@ void ace_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAV
   bool is_coherent = false;
   // --- Reorder Check --- //
   unsigned reorder=2; // 2 : Req not found, 1 : Request reordered, 0 : everything is fine
-  unsigned j=0;
   ace5_::AddrPayload sb_ord_req;
-  while (j<sb_rd_order_q.size()){
-    sb_ord_req = sb_rd_order_q[j];
-    
-    if(sb_ord_req.id == rcv_rd_resp.id) {
-      // Slave must sneak its ID to the resp field.
-      unsigned dst = mem_map_resolve(sb_ord_req.addr);
-      is_coherent = (sb_ord_req.snoop || sb_ord_req.domain.xor_reduce());
-      reorder = (dst  == rcv_rd_resp.resp) || is_coherent ? 0 : 1;
-      if(rcv_rd_resp.last) sb_rd_order_q.erase(sb_rd_order_q.begin()+j);
-      break;
-    }
-    j++;
+  unsigned lat_dst = 0;
+  // The response must be of the oldest outstanding request of its ID
+  sb_key_t ord_key = sb_key(rcv_rd_resp.id.to_uint());
+  int      ord     = sb_rd_order_q.first(ord_key);
+  if (ord != SB_NIL) {
+    sb_ord_req = sb_rd_order_q.at(ord);
+    // Slave must sneak its ID to the resp field.
+    unsigned dst = mem_map_resolve(sb_ord_req.addr);
+    lat_dst = dst;
+    is_coherent = (sb_ord_req.snoop || sb_ord_req.domain.xor_reduce());
+    reorder = (dst  == rcv_rd_resp.resp) || is_coherent ? 0 : 1;
+    if(rcv_rd_resp.last) sb_rd_order_q.erase(ord_key, ord);
   }
   // --------------------- //
+  // Expected in order within the flow, the search goes further only if the beat was reordered
   bool found = false;
-  j=0;
+  sb_key_t key = sb_key(MASTER_ID-SLAVE_NUM, rcv_rd_resp.resp.to_uint(), rcv_rd_resp.id.to_uint() & ((1<<dnp::ace::ID_W)-1));
+  int      j   = sb_rd_resp_q->first(key);
   //if (sb_ord_req.snoop == 0) {
-    while (j<(*sb_rd_resp_q)[MASTER_ID-SLAVE_NUM].size()){
-      msg_tb_wrap< ace5_::ReadPayload > sb_resp = (*sb_rd_resp_q)[MASTER_ID-SLAVE_NUM][j];
+    while (j != SB_NIL){
+      msg_tb_wrap< ace5_::ReadPayload > &sb_resp = sb_rd_resp_q->at(j);
     
       if (eq_rd_data(rcv_rd_resp, sb_resp.dut_msg)){
+        bool measured = !meas || meas->in(sb_resp.time_gen);
         if (sb_resp.dut_msg.last) {
-          rd_resp_delay += ((sc_time_stamp() - sb_resp.time_gen) / clk_period) - 1;
-          rd_resp_count++;
+          unsigned long long int this_delay = ((sc_time_stamp() - sb_resp.time_gen) / clk_period) - 1;
+          if (measured) {
+            rd_resp_delay += this_delay;
+            rd_lat[lat_dst].add(this_delay);
+            rd_resp_count++;
+            if (meas) meas->record(this_delay);
+          }
         }
-        rd_resp_data_count++;
+        if (measured) rd_resp_data_count++;
         last_rd_sinked_cycle = (sc_time_stamp() / clk_period);
       
-        (*sb_rd_resp_q)[MASTER_ID-SLAVE_NUM].erase((*sb_rd_resp_q)[MASTER_ID-SLAVE_NUM].begin()+j);
+        sb_rd_resp_q->erase(key, j);
         found = true;
         break;
       }
-      j++;
+      j = sb_rd_resp_q->next(j);
     }
   //} else {
   //  found = true; // Ignore the check if it's a Snoop access
@@ -1389,6 +1565,7 @@ void ace_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAV
     ace5_::RACK tmp_rack;
     tmp_rack.rack = 1;
     stored_rd_ack.push(tmp_rack);
+    if (trace_out || replay.active()) deps.completed(false, rcv_rd_resp.id.to_uint() & ((1<<dnp::ace::ID_W)-1), cur_cycle());
   }
   // --- DEPRECATED --- This checks absolute order among all TIDs
   //AXI4_R sb_val = (*sb_rd_resp_q)[MASTER_ID].front();
@@ -1398,14 +1575,13 @@ void ace_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAV
   if(!found){
     std::cout<< "\n\n";
     std::cout<< "[Master " << MASTER_ID <<"] " << "RD-Resp  : "<< rcv_rd_resp << " . NOT FOUND! @" << sc_time_stamp() << "\n";
-    std::cout<< "[Master " << MASTER_ID <<"] " << "-SB_front - "<< (*sb_rd_resp_q)[MASTER_ID-SLAVE_NUM].front() << "\n";
+    if (sb_rd_resp_q->first(key) != SB_NIL) std::cout<< "[Master " << MASTER_ID <<"] " << "-SB_front - "<< sb_rd_resp_q->at(sb_rd_resp_q->first(key)) << "\n";
     error_sb_rd_resp_not_found++;
     sc_assert(0);
     // sc_stop();
   }else if(reorder==2) {
     std::cout<< "\n\n";
     std::cout<< "[Master " << MASTER_ID <<"] " << "RD-Resp  : "<< rcv_rd_resp << " . Respective Request wasn't found!!! @" << sc_time_stamp() << "\n";
-    std::cout<< "[Master " << MASTER_ID <<"] " << "-REQ_front - "<< sb_rd_order_q.front() << "\n";
     sc_assert(0);
   }else if(reorder==1) {
     std::cout<< "\n\n";
@@ -1413,7 +1589,8 @@ void ace_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAV
     std::cout<< "[Master " << MASTER_ID <<"] " << "REQ-Ordered - "<< sb_ord_req << "\n";
     sc_assert(0);
   }else{
-    std::cout<< "[Master " << MASTER_ID <<"] " << "RD-Resp OK   : <<  " << rcv_rd_resp << " @" << sc_time_stamp() << "\n";
+    EVT_TRACE((rcv_rd_resp.last ? EVT_LVL_TXN : EVT_LVL_BEAT), evt, EVT_R, rcv_rd_resp.id.to_uint(), 0, rcv_rd_resp.last.to_uint(),
+              std::cout<< "[Master " << MASTER_ID <<"] " << "RD-Resp OK   : <<  " << rcv_rd_resp << " @" << sc_time_stamp() << "\n");
     if (is_coherent){
       upd_cache_read(sb_ord_req, rcv_rd_resp);
     } else {
@@ -1431,59 +1608,63 @@ void ace_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAV
   bool is_coherent = false;
   // --- Reorder Check --- //
   int reorder = 2; // 2 : Req not found, 1 : Request reordered, 0 : everything is fine
-  unsigned int j = 0;
   ace5_::AddrPayload sb_ord_req;
-  while (j<sb_wr_order_q.size()) {
-    sb_ord_req = sb_wr_order_q[j];
-    
-    if(sb_ord_req.id == rcv_wr_resp.id) {
-      // Slave must sneak its ID into the first data byte of every beat (aka data[0]).
-      unsigned dst = mem_map_resolve(sb_ord_req.addr);
-      is_coherent = (sb_ord_req.snoop || sb_ord_req.domain.xor_reduce());
-      reorder = (dst  == rcv_wr_resp.resp) ? 0 : 1;
-      sb_wr_order_q.erase(sb_wr_order_q.begin()+j);
-      break;
-    }
-    
-    j++;
+  unsigned lat_dst = 0;
+  // The response must be of the oldest outstanding request of its ID
+  sb_key_t ord_key = sb_key(rcv_wr_resp.id.to_uint());
+  int      ord     = sb_wr_order_q.first(ord_key);
+  if (ord != SB_NIL) {
+    sb_ord_req = sb_wr_order_q.at(ord);
+    // Slave must sneak its ID into the first data byte of every beat (aka data[0]).
+    unsigned dst = mem_map_resolve(sb_ord_req.addr);
+    lat_dst = dst;
+    is_coherent = (sb_ord_req.snoop || sb_ord_req.domain.xor_reduce());
+    reorder = (dst  == rcv_wr_resp.resp) ? 0 : 1;
+    sb_wr_order_q.erase(ord_key, ord);
   }
   // --------------------- //
   
   // Verify Responce
   bool found = false;
-  j = 0;
-  while (j<(*sb_wr_resp_q)[MASTER_ID-SLAVE_NUM].size()){
-    msg_tb_wrap< ace5_::WRespPayload > sb_resp = (*sb_wr_resp_q)[MASTER_ID-SLAVE_NUM][j];
+  sb_key_t key = sb_key(MASTER_ID-SLAVE_NUM, rcv_wr_resp.resp.to_uint(), rcv_wr_resp.id.to_uint() & ((1<<dnp::ace::ID_W)-1));
+  int      j   = sb_wr_resp_q->first(key);
+  while (j != SB_NIL){
+    msg_tb_wrap< ace5_::WRespPayload > &sb_resp = sb_wr_resp_q->at(j);
     
     if (eq_wr_resp(sb_resp.dut_msg, rcv_wr_resp)){
       
-      wr_resp_delay += ((sc_time_stamp() - sb_resp.time_gen) / clk_period) - 1;
-      wr_resp_count++;
+      if (!meas || meas->in(sb_resp.time_gen)) {
+        unsigned long long int this_delay = ((sc_time_stamp() - sb_resp.time_gen) / clk_period) - 1;
+        wr_resp_delay += this_delay;
+        wr_lat[lat_dst].add(this_delay);
+        wr_resp_count++;
+        if (meas) meas->record(this_delay);
+      }
       
-      (*sb_wr_resp_q)[MASTER_ID-SLAVE_NUM].erase((*sb_wr_resp_q)[MASTER_ID-SLAVE_NUM].begin()+j);
+      sb_wr_resp_q->erase(key, j);
       found = true;
       break;
     }
-    j++;
+    j = sb_wr_resp_q->next(j);
   }
   
   //if (rcv_wr_resp.last) {
     ace5_::WACK tmp_wack;
     tmp_wack.wack = 1;
     stored_wr_ack.push(tmp_wack);
+    if (trace_out || replay.active()) deps.completed(true, rcv_wr_resp.id.to_uint() & ((1<<dnp::ace::ID_W)-1), cur_cycle());
   //}
   
   if(!found){
     std::cout<< "\n\n";
     std::cout<< "[Master " << MASTER_ID <<"] " << "WR-Resp  : "<< rcv_wr_resp << " . NOT FOUND! @" << sc_time_stamp() << "\n";
-    std::cout<< "[Master " << MASTER_ID <<"] " << "-SB_front - "<< (*sb_wr_resp_q)[MASTER_ID-SLAVE_NUM].front() << "\n";
+    if (sb_wr_resp_q->first(key) != SB_NIL) std::cout<< "[Master " << MASTER_ID <<"] " << "-SB_front - "<< sb_wr_resp_q->at(sb_wr_resp_q->first(key)) << "\n";
     error_sb_wr_resp_not_found++;
     sc_assert(0);
     // sc_stop();
   }else if(reorder==2) {
     std::cout<< "\n\n";
     std::cout<< "[Master " << MASTER_ID <<"] " << "WR-Resp  : "<< rcv_wr_resp << " . Respective Request wasn't found!!! @" << sc_time_stamp() << "\n";
-    std::cout<< "[Master " << MASTER_ID <<"] " << "-REQ_front - "<< sb_wr_order_q.front() << "\n";
     sc_assert(0);
   }else if(reorder==1) {
     std::cout<< "\n\n";
@@ -1491,7 +1672,8 @@ void ace_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAV
     std::cout<< "[Master " << MASTER_ID <<"] " << "REQ-Ordered - "<< sb_ord_req << "\n";
     sc_assert(0);
   }else{
-    std::cout<< "[Master " << MASTER_ID <<"] " << "WR-Resp OK   : <<  " << rcv_wr_resp << "\n";
+    EVT_TRACE(EVT_LVL_TXN, evt, EVT_B, rcv_wr_resp.id.to_uint(), 0, rcv_wr_resp.resp.to_uint(),
+              std::cout<< "[Master " << MASTER_ID <<"] " << "WR-Resp OK   : <<  " << rcv_wr_resp << "\n");
     if (is_coherent) {
       upd_cache_write(sb_ord_req, rcv_wr_resp);
     } else {
@@ -6,6 +6,10 @@
 #include "../helper_non_synth.h"
 #include "../../src/include/dnp_ace_v0.h"
 #include "../tb_wrap.h"
+#include "../tb_scoreboard.h"
+#include "../lat_hist.h"
+#include "../meas_window.h"
+#include "../../src/include/evt_trace.h"
 
 #include <deque>
 #include <queue>
@@ -47,14 +51,14 @@ SC_MODULE(acelite_master) {
   
   // Scoreboard
   sc_mutex                                                      *sb_lock;
-  std::vector< std::deque< msg_tb_wrap<ace5_::AddrPayload> > >  *sb_rd_req_q;
-  std::vector< std::deque< msg_tb_wrap<ace5_::ReadPayload> > >  *sb_rd_resp_q;
+  tb_scoreboard< msg_tb_wrap<ace5_::AddrPayload> >     *sb_rd_req_q;
+  tb_scoreboard< msg_tb_wrap<ace5_::ReadPayload> >     *sb_rd_resp_q;
   
-  std::vector< std::deque< msg_tb_wrap<ace5_::AddrPayload > > >  *sb_wr_req_q;
-  std::vector< std::deque< msg_tb_wrap<ace5_::WritePayload> > >  *sb_wr_data_q;
-  std::vector< std::deque< msg_tb_wrap<ace5_::WRespPayload> > >  *sb_wr_resp_q;
+  tb_scoreboard< msg_tb_wrap<ace5_::AddrPayload> >     *sb_wr_req_q;
+  tb_scoreboard< msg_tb_wrap<ace5_::WritePayload> >    *sb_wr_data_q;
+  tb_scoreboard< msg_tb_wrap<ace5_::WRespPayload> >    *sb_wr_resp_q;
   
-  std::vector< std::deque< msg_tb_wrap<ace5_::AddrPayload> > >   *sb_coherent_access_q;
+  tb_scoreboard< msg_tb_wrap<ace5_::AddrPayload> >     *sb_coherent_access_q;
   std::vector< std::deque< msg_tb_wrap<ace5_::AC> > >            *sb_snoop_req_q;
   std::vector< std::deque< msg_tb_wrap<ace5_::CR> > >            *sb_snoop_resp_q;
   std::vector< std::deque< msg_tb_wrap<ace5_::CD> > >            *sb_snoop_data_resp_q;
@@ -67,8 +71,8 @@ SC_MODULE(acelite_master) {
   std::queue<ace5_::CR>  stored_cache_resp;
   std::queue<ace5_::CD>  stored_cache_data;
   
-  std::deque<ace5_::AddrPayload>  sb_rd_order_q; // queue to check ordering
-  std::deque<ace5_::AddrPayload>  sb_wr_order_q; // queue to check ordering
+  tb_scoreboard<ace5_::AddrPayload>  sb_rd_order_q; // Outstanding requests per ID, to check ordering
+  tb_scoreboard<ace5_::AddrPayload>  sb_wr_order_q; // Outstanding requests per ID, to check ordering
   
   std::map<ace5_::Addr, int>        cache_outstanding;
   std::map<ace5_::Addr, int>        cache_outstanding_writes;
@@ -94,6 +98,10 @@ SC_MODULE(acelite_master) {
   unsigned long long int last_wr_sinked_cycle = 0;
   unsigned long long int rd_resp_data_count = 0;
   unsigned long long int wr_resp_data_count = 0;
+  // Latency distribution per target slave
+  lat_hist rd_lat[SLAVE_NUM];
+  lat_hist wr_lat[SLAVE_NUM];
+  meas_window *meas; // Only the marked requests are measured when set
   
 	bool stop_at_tail, has_stopped_gen;
 	
@@ -122,6 +130,8 @@ SC_MODULE(acelite_master) {
   int error_sb_rd_resp_not_found;
   int error_sb_wr_resp_not_found;
   
+  evt_ring evt; // Event trace (see evt_trace.h)
+  
   // Functions
 	void do_cycle();
 	void gen_new_rd_trans();
@@ -146,6 +156,8 @@ SC_MODULE(acelite_master) {
     AXI_GEN_RATE_RD      = 0;
     AXI_GEN_RATE_WR      = 0;
     ACE_GEN_RATE_CACHE   = 5;
+    meas                 = NULL;
+    evt.init(this->name());
     
 		SC_THREAD(do_cycle);
     sensitive << clk.pos();
@@ -221,7 +233,8 @@ void acelite_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM,
         if (ar_out.PushNB(tmp_ar)) {
           stored_rd_trans.pop();
     
-          std::cout << "[Master " << MASTER_ID << "] : PUSHED AR:" << tmp_ar << " @" << sc_time_stamp() << std::endl;
+          EVT_TRACE(EVT_LVL_TXN, evt, EVT_AR, tmp_ar.id.to_uint(), tmp_ar.addr.to_uint64(), tmp_ar.len.to_uint(),
+                    std::cout << "[Master " << MASTER_ID << "] : PUSHED AR:" << tmp_ar << " @" << sc_time_stamp() << "\n");
           rd_trans_inj++;
           if(is_coherent) {
             cache_outstanding[tmp_ar.addr]++;
@@ -233,7 +246,7 @@ void acelite_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM,
             temp_rd_coherent_req_tb.is_read  = true;
             temp_rd_coherent_req_tb.time_gen = sc_time_stamp();
             
-            (*sb_coherent_access_q)[MASTER_ID - SLAVE_NUM].push_back(temp_rd_coherent_req_tb);
+            sb_coherent_access_q->push(sb_key(MASTER_ID - SLAVE_NUM, 0, tmp_ar.addr.to_uint64()), temp_rd_coherent_req_tb);
             sb_lock->unlock();
           }
         }
@@ -250,7 +263,8 @@ void acelite_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM,
         if (aw_out.PushNB(tmp_aw)) {
           stored_wr_trans.pop();
     
-          std::cout << "[Master " << MASTER_ID << "] : PUSHED AW: " << tmp_aw << " @" << sc_time_stamp() << std::endl;
+          EVT_TRACE(EVT_LVL_TXN, evt, EVT_AW, tmp_aw.id.to_uint(), tmp_aw.addr.to_uint64(), tmp_aw.len.to_uint(),
+                    std::cout << "[Master " << MASTER_ID << "] : PUSHED AW: " << tmp_aw << " @" << sc_time_stamp() << "\n");
           wr_trans_inj++;
           if(is_coherent) {
             cache_outstanding[tmp_aw.addr]++;
@@ -262,7 +276,7 @@ void acelite_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM,
             temp_wr_coherent_req_tb.is_read  = false;
             temp_wr_coherent_req_tb.time_gen = sc_time_stamp();
             
-            (*sb_coherent_access_q)[MASTER_ID - SLAVE_NUM].push_back(temp_wr_coherent_req_tb);
+            sb_coherent_access_q->push(sb_key(MASTER_ID - SLAVE_NUM, 0, tmp_aw.addr.to_uint64()), temp_wr_coherent_req_tb);
             sb_lock->unlock();
           }
         }
@@ -275,7 +289,8 @@ void acelite_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM,
       if (w_out.PushNB(tmp_w)) {
         stored_wr_data.pop();
   
-        std::cout << "[Master " << MASTER_ID << "] : PUSHED W: " << tmp_w << " @" << sc_time_stamp() << std::endl;
+        EVT_TRACE(EVT_LVL_BEAT, evt, EVT_W, 0, 0, tmp_w.last.to_uint(),
+                  std::cout << "[Master " << MASTER_ID << "] : PUSHED W: " << tmp_w << " @" << sc_time_stamp() << "\n");
         wr_data_inj++;
       }
     }
@@ -338,11 +353,11 @@ void acelite_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM,
   temp_rd_req_tb.time_gen = sc_time_stamp();
   
   unsigned dst = mem_map_resolve(rd_req_s.addr);
-  (*sb_rd_req_q)[dst].push_back(temp_rd_req_tb);
+  sb_rd_req_q->push(sb_key(dst, rd_req_s.id.to_uint() & ((1<<dnp::ace::ID_W)-1)), temp_rd_req_tb);
   sb_lock->unlock();
   
   // Push into order queue - Reorder check extension
-  sb_rd_order_q.push_back(rd_req_m);
+  sb_rd_order_q.push(sb_key(rd_req_m.id.to_uint()), rd_req_m);
   
   rd_trans_generated++;
   
@@ -379,7 +394,7 @@ void acelite_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM,
       temp_rd_resp_tb.dut_msg  = beat_expected;
       temp_rd_resp_tb.time_gen = sc_time_stamp();
       
-      (*sb_rd_resp_q)[MASTER_ID-SLAVE_NUM].push_back(temp_rd_resp_tb);
+      sb_rd_resp_q->push(sb_key(MASTER_ID-SLAVE_NUM, beat_expected.resp.to_uint(), beat_expected.id.to_uint() & ((1<<dnp::ace::ID_W)-1)), temp_rd_resp_tb);
       beat_expected.data = 0;
   
       rd_data_generated++;
@@ -410,7 +425,7 @@ void acelite_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM,
   stored_wr_trans.push(m_wr_req);
   
   // Push into order queue - Reorder check extension
-  sb_wr_order_q.push_back(m_wr_req);
+  sb_wr_order_q.push(sb_key(m_wr_req.id.to_uint()), m_wr_req);
   
   // Create dummy write data
   ace5_::WritePayload cur_beat;      // The beat that will be injected at MASTER
@@ -443,7 +458,10 @@ void acelite_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM,
   temp_wr_req_tb.dut_msg = s_wr_req;
   
   unsigned dst = mem_map_resolve(s_wr_req.addr);
-  (*sb_wr_req_q)[dst].push_back(temp_wr_req_tb);
+  sb_wr_req_q->push(sb_key(dst, s_wr_req.id.to_uint() & ((1<<dnp::ace::ID_W)-1)), temp_wr_req_tb);
+  
+  // The beats expected at the Slave, queued once the initiator of the last is known
+  std::vector< msg_tb_wrap<ace5_::WritePayload> > beats_at_slave;
   
   cur_beat.data  = 0;
   cur_beat.wstrb = 0;
@@ -479,15 +497,18 @@ void acelite_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM,
       msg_tb_wrap< ace5_::WritePayload > temp_wr_data_tb;
       temp_wr_data_tb.dut_msg = beat_at_slave;
         
-      wr_resp_data_count++;
+      if (!meas || meas->in(sc_time_stamp())) wr_resp_data_count++;
       last_wr_sinked_cycle = (sc_time_stamp() / clk_period);
       
-      (*sb_wr_data_q)[dst].push_back(temp_wr_data_tb);
+      beats_at_slave.push_back(temp_wr_data_tb);
       beat_at_slave.data  = 0;
       beat_at_slave.wstrb = 0;
     }
   }
   
+  sb_key_t data_key = sb_key(dst, sb_wr_initiator(beats_at_slave.back().dut_msg, WR_S_LANES));
+  for (unsigned i=0; i<beats_at_slave.size(); ++i) sb_wr_data_q->push(data_key, beats_at_slave[i]);
+  
   sb_lock->unlock();
   
   wr_trans_generated++;
@@ -525,7 +546,7 @@ void acelite_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM,
       // Pushing to ACE Coherency checker happens during injection
     
       // Push into order queue - Reorder check extension
-      sb_rd_order_q.push_back(cache_req);
+      sb_rd_order_q.push(sb_key(cache_req.id.to_uint()), cache_req);
     
       rd_trans_generated++;
     } else {  // It's a WR request
@@ -550,18 +571,18 @@ void acelite_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM,
       temp_wr_coherent_req_tb.dut_msg.barrier = 0;
       temp_wr_coherent_req_tb.dut_msg.unique  = 0;
       temp_wr_coherent_req_tb.time_gen        = sc_time_stamp();
-      (*sb_wr_req_q)[target_mem].push_back(temp_wr_coherent_req_tb);
+      sb_wr_req_q->push(sb_key(target_mem, cache_req.id.to_uint() & ((1<<dnp::ace::ID_W)-1)), temp_wr_coherent_req_tb);
     
       msg_tb_wrap<ace5_::WritePayload> temp_wr_data_tb;
       temp_wr_data_tb.dut_msg = data_beat;
       temp_wr_data_tb.is_read = false;
       temp_wr_data_tb.time_gen = sc_time_stamp();
     
-      (*sb_wr_data_q)[target_mem].push_back(temp_wr_data_tb);
+      sb_wr_data_q->push(sb_key(target_mem, sb_wr_initiator(data_beat, WR_S_LANES)), temp_wr_data_tb);
       sb_lock->unlock();
     
       // Push into order queue - Reorder check extension
-      sb_wr_order_q.push_back(cache_req);
+      sb_wr_order_q.push(sb_key(cache_req.id.to_uint()), cache_req);
       wr_trans_generated++;
     }
     cache_trans_generated++;
@@ -578,41 +599,48 @@ void acelite_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM,
   bool is_coherent = false;
   // --- Reorder Check --- //
   unsigned reorder=2; // 2 : Req not found, 1 : Request reordered, 0 : everything is fine
-  unsigned j=0;
   ace5_::AddrPayload sb_ord_req;
-  while (j<sb_rd_order_q.size()){
-    sb_ord_req = sb_rd_order_q[j];
-    
-    if(sb_ord_req.id == rcv_rd_resp.id) {
-      // Slave must sneak its ID to the resp field.
-      unsigned dst = mem_map_resolve(sb_ord_req.addr);
-      is_coherent = (sb_ord_req.snoop || sb_ord_req.domain.xor_reduce());
-      reorder = (dst  == rcv_rd_resp.resp) || is_coherent ? 0 : 1;
-      if(rcv_rd_resp.last) sb_rd_order_q.erase(sb_rd_order_q.begin()+j);
-      break;
-    }
-    j++;
+  unsigned lat_dst = 0;
+  // The response must be of the oldest outstanding request of its ID
+  sb_key_t ord_key = sb_key(rcv_rd_resp.id.to_uint());
+  int      ord     = sb_rd_order_q.first(ord_key);
+  if (ord != SB_NIL) {
+    sb_ord_req = sb_rd_order_q.at(ord);
+    // Slave must sneak its ID to the resp field.
+    unsigned dst = mem_map_resolve(sb_ord_req.addr);
+    lat_dst = dst;
+    is_coherent = (sb_ord_req.snoop || sb_ord_req.domain.xor_reduce());
+    reorder = (dst  == rcv_rd_resp.resp) || is_coherent ? 0 : 1;
+    if(rcv_rd_resp.last) sb_rd_order_q.erase(ord_key, ord);
   }
   // --------------------- //
+  // Expected in order within the flow, the search goes further only if the beat was reordered
   bool found = false;
-  j=0;
+  sb_key_t key = sb_key(MASTER_ID-SLAVE_NUM, rcv_rd_resp.resp.to_uint(), rcv_rd_resp.id.to_uint() & ((1<<dnp::ace::ID_W)-1));
+  int      j   = sb_rd_resp_q->first(key);
   //if (sb_ord_req.snoop == 0) {
-    while (j<(*sb_rd_resp_q)[MASTER_ID-SLAVE_NUM].size()){
-      msg_tb_wrap< ace5_::ReadPayload > sb_resp = (*sb_rd_resp_q)[MASTER_ID-SLAVE_NUM][j];
+    while (j != SB_NIL){
+      msg_tb_wrap< ace5_::ReadPayload > &sb_resp = sb_rd_resp_q->at(j);
     
       if (eq_rd_data(rcv_rd_resp, sb_resp.dut_msg)){
+        bool measured = !meas || meas->in(sb_resp.time_gen);
         if (sb_resp.dut_msg.last) {
-          rd_resp_delay += ((sc_time_stamp() - sb_resp.time_gen) / clk_period) - 1;
-          rd_resp_count++;
+          unsigned long long int this_delay = ((sc_time_stamp() - sb_resp.time_gen) / clk_period) - 1;
+          if (measured) {
+            rd_resp_delay += this_delay;
+            rd_lat[lat_dst].add(this_delay);
+            rd_resp_count++;
+            if (meas) meas->record(this_delay);
+          }
         }
-        rd_resp_data_count++;
+        if (measured) rd_resp_data_count++;
         last_rd_sinked_cycle = (sc_time_stamp() / clk_period);
       
-        (*sb_rd_resp_q)[MASTER_ID-SLAVE_NUM].erase((*sb_rd_resp_q)[MASTER_ID-SLAVE_NUM].begin()+j);
+        sb_rd_resp_q->erase(key, j);
         found = true;
         break;
       }
-      j++;
+      j = sb_rd_resp_q->next(j);
     }
   //} else {
   //  found = true; // Ignore the check if it's a Snoop access
@@ -621,14 +649,13 @@ void acelite_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM,
   if(!found){
     std::cout<< "\n\n";
     std::cout<< "[Master " << MASTER_ID <<"] " << "RD-Resp  : "<< rcv_rd_resp << " . NOT FOUND! @" << sc_time_stamp() << "\n";
-    std::cout<< "[Master " << MASTER_ID <<"] " << "-SB_front - "<< (*sb_rd_resp_q)[MASTER_ID-SLAVE_NUM].front() << "\n";
+    if (sb_rd_resp_q->first(key) != SB_NIL) std::cout<< "[Master " << MASTER_ID <<"] " << "-SB_front - "<< sb_rd_resp_q->at(sb_rd_resp_q->first(key)) << "\n";
     error_sb_rd_resp_not_found++;
     sc_assert(0);
     // sc_stop();
   }else if(reorder==2) {
     std::cout<< "\n\n";
     std::cout<< "[Master " << MASTER_ID <<"] " << "RD-Resp  : "<< rcv_rd_resp << " . Respective Request wasn't found!!! @" << sc_time_stamp() << "\n";
-    std::cout<< "[Master " << MASTER_ID <<"] " << "-REQ_front - "<< sb_rd_order_q.front() << "\n";
     sc_assert(0);
   }else if(reorder==1) {
     std::cout<< "\n\n";
@@ -636,7 +663,8 @@ void acelite_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM,
     std::cout<< "[Master " << MASTER_ID <<"] " << "REQ-Ordered - "<< sb_ord_req << "\n";
     sc_assert(0);
   }else{
-    std::cout<< "[Master " << MASTER_ID <<"] " << "RD-Resp OK   : <<  " << rcv_rd_resp << " @" << sc_time_stamp() << "\n";
+    EVT_TRACE((rcv_rd_resp.last ? EVT_LVL_TXN : EVT_LVL_BEAT), evt, EVT_R, rcv_rd_resp.id.to_uint(), 0, rcv_rd_resp.last.to_uint(),
+              std::cout<< "[Master " << MASTER_ID <<"] " << "RD-Resp OK   : <<  " << rcv_rd_resp << " @" << sc_time_stamp() << "\n");
     if (is_coherent){
       cache_outstanding[sb_ord_req.addr]--;
     } else {
@@ -654,54 +682,57 @@ void acelite_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM,
   bool is_coherent = false;
   // --- Reorder Check --- //
   int reorder = 2; // 2 : Req not found, 1 : Request reordered, 0 : everything is fine
-  unsigned int j = 0;
   ace5_::AddrPayload sb_ord_req;
-  while (j<sb_wr_order_q.size()) {
-    sb_ord_req = sb_wr_order_q[j];
-    
-    if(sb_ord_req.id == rcv_wr_resp.id) {
-      // Slave must sneak its ID into the first data byte of every beat (aka data[0]).
-      unsigned dst = mem_map_resolve(sb_ord_req.addr);
-      is_coherent = (sb_ord_req.snoop || sb_ord_req.domain.xor_reduce());
-      reorder = (dst  == rcv_wr_resp.resp) ? 0 : 1;
-      sb_wr_order_q.erase(sb_wr_order_q.begin()+j);
-      break;
-    }
-    
-    j++;
+  unsigned lat_dst = 0;
+  // The response must be of the oldest outstanding request of its ID
+  sb_key_t ord_key = sb_key(rcv_wr_resp.id.to_uint());
+  int      ord     = sb_wr_order_q.first(ord_key);
+  if (ord != SB_NIL) {
+    sb_ord_req = sb_wr_order_q.at(ord);
+    // Slave must sneak its ID into the first data byte of every beat (aka data[0]).
+    unsigned dst = mem_map_resolve(sb_ord_req.addr);
+    lat_dst = dst;
+    is_coherent = (sb_ord_req.snoop || sb_ord_req.domain.xor_reduce());
+    reorder = (dst  == rcv_wr_resp.resp) ? 0 : 1;
+    sb_wr_order_q.erase(ord_key, ord);
   }
   // --------------------- //
   
   // Verify Responce
   bool found = false;
-  j = 0;
-  while (j<(*sb_wr_resp_q)[MASTER_ID-SLAVE_NUM].size()){
-    msg_tb_wrap< ace5_::WRespPayload > sb_resp = (*sb_wr_resp_q)[MASTER_ID-SLAVE_NUM][j];
+  sb_key_t key = sb_key(MASTER_ID-SLAVE_NUM, rcv_wr_resp.resp.to_uint(), rcv_wr_resp.id.to_uint() & ((1<<dnp::ace::ID_W)-1));
+  int      j   = sb_wr_resp_q->first(key);
+  while (j != SB_NIL){
+    msg_tb_wrap< ace5_::WRespPayload > &sb_resp = sb_wr_resp_q->at(j);
     
     if (eq_wr_resp(sb_resp.dut_msg, rcv_wr_resp)){
       
-      wr_resp_delay += ((sc_time_stamp() - sb_resp.time_gen) / clk_period) - 1;
-      wr_resp_count++;
+      if (!meas || meas->in(sb_resp.time_gen)) {
+        unsigned long long int this_delay = ((sc_time_stamp() - sb_resp.time_gen) / clk_period) - 1;
+        wr_resp_delay += this_delay;
+        wr_lat[lat_dst].add(this_delay);
+        wr_resp_count++;
+        if (meas) meas->record(this_delay);
+      }
       
-      (*sb_wr_resp_q)[MASTER_ID-SLAVE_NUM].erase((*sb_wr_resp_q)[MASTER_ID-SLAVE_NUM].begin()+j);
+      sb_wr_resp_q->erase(key, j);
       found = true;
       break;
     }
-    j++;
+    j = sb_wr_resp_q->next(j);
   }
   
   
   if(!found){
     std::cout<< "\n\n";
     std::cout<< "[Master " << MASTER_ID <<"] " << "WR-Resp  : "<< rcv_wr_resp << " . NOT FOUND! @" << sc_time_stamp() << "\n";
-    std::cout<< "[Master " << MASTER_ID <<"] " << "-SB_front - "<< (*sb_wr_resp_q)[MASTER_ID-SLAVE_NUM].front() << "\n";
+    if (sb_wr_resp_q->first(key) != SB_NIL) std::cout<< "[Master " << MASTER_ID <<"] " << "-SB_front - "<< sb_wr_resp_q->at(sb_wr_resp_q->first(key)) << "\n";
     error_sb_wr_resp_not_found++;
     sc_assert(0);
     // sc_stop();
   }else if(reorder==2) {
     std::cout<< "\n\n";
     std::cout<< "[Master " << MASTER_ID <<"] " << "WR-Resp  : "<< rcv_wr_resp << " . Respective Request wasn't found!!! @" << sc_time_stamp() << "\n";
-    std::cout<< "[Master " << MASTER_ID <<"] " << "-REQ_front - "<< sb_wr_order_q.front() << "\n";
     sc_assert(0);
   }else if(reorder==1) {
     std::cout<< "\n\n";
@@ -709,7 +740,8 @@ void acelite_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM,
     std::cout<< "[Master " << MASTER_ID <<"] " << "REQ-Ordered - "<< sb_ord_req << "\n";
     sc_assert(0);
   }else{
-    std::cout<< "[Master " << MASTER_ID <<"] " << "WR-Resp OK   : <<  " << rcv_wr_resp << "\n";
+    EVT_TRACE(EVT_LVL_TXN, evt, EVT_B, rcv_wr_resp.id.to_uint(), 0, rcv_wr_resp.resp.to_uint(),
+              std::cout<< "[Master " << MASTER_ID <<"] " << "WR-Resp OK   : <<  " << rcv_wr_resp << "\n");
     if (is_coherent) {
       //upd_cache_write(sb_ord_req, rcv_wr_resp);
       cache_outstanding_writes[sb_ord_req.addr]--;
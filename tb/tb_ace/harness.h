@@ -21,20 +21,38 @@
 #include <iostream>
 #include <fstream>
 
+#include "../../tb/sim_speed.h"
+#include "../../tb/meas_window.h"
+#include "../../src/include/rtr_watchdog.h"
+
 SC_MODULE(harness) {
   typedef typename ace::ace5<axi::cfg::ace> ace5_;
   
+  // Traffic knobs. Each can be overridden at run-time from the environment (see tb_param)
   const int CLK_PERIOD = 5;
-  const int GEN_CYCLES = 2 * 1000;
+  const int GEN_CYCLES = tb_param("TB_GEN_CYCLES", 2 * 1000);
   
-  const int AXI_GEN_RATE_RD[smpl_cfg::ALL_MASTER_NUM]    = {20, 20, 20, 20};
-  const int AXI_GEN_RATE_WR[smpl_cfg::ALL_MASTER_NUM]    = {20, 20, 20, 20};
-  const int ACE_GEN_RATE_CACHE[smpl_cfg::ALL_MASTER_NUM] = {10, 10, 10, 10};
+  const int AXI_GEN_RATE_RD[smpl_cfg::ALL_MASTER_NUM]    = {tb_param("TB_GEN_RATE_RD", 20), tb_param("TB_GEN_RATE_RD", 20), tb_param("TB_GEN_RATE_RD", 20), tb_param("TB_GEN_RATE_RD", 20)};
+  const int AXI_GEN_RATE_WR[smpl_cfg::ALL_MASTER_NUM]    = {tb_param("TB_GEN_RATE_WR", 20), tb_param("TB_GEN_RATE_WR", 20), tb_param("TB_GEN_RATE_WR", 20), tb_param("TB_GEN_RATE_WR", 20)};
+  const int ACE_GEN_RATE_CACHE[smpl_cfg::ALL_MASTER_NUM] = {tb_param("TB_GEN_RATE_CACHE", 10), tb_param("TB_GEN_RATE_CACHE", 10), tb_param("TB_GEN_RATE_CACHE", 10), tb_param("TB_GEN_RATE_CACHE", 10)};
   
-  const int AXI_STALL_RATE_RD = 00;
-  const int AXI_STALL_RATE_WR = 00;
+  const int AXI_STALL_RATE_RD = tb_param("TB_STALL_RATE_RD", 00);
+  const int AXI_STALL_RATE_WR = tb_param("TB_STALL_RATE_WR", 00);
   
   const int DRAIN_CYCLES = GEN_CYCLES/10;
+  
+  // Deadlock watchdog of the routers (src/include/rtr_watchdog.h). 0 disables it, otherwise the simulation fails
+  // once a router buffer has not moved for TB_WDOG_CYCLES, thus a deadlocked or starved network stops at once
+  const int WDOG_CYCLES = tb_param("TB_WDOG_CYCLES", 0);
+  
+  // Trace capture (TB_TRACE_REC=<file>) of the ACE master channels, or replay (TB_TRACE_REPLAY=<file>)
+  // in place of their random generators. TB_TRACE_MODE=timed|closed selects the replay timing.
+  // ACE-Lite masters keep their random traffic.
+  trace_writer trace_out;
+  trace_reader trace_in;
+  
+  sim_speed   speed; // Wall time and memory of the run
+  meas_window meas;  // Steady-state window, in place of GEN_CYCLES when TB_MEAS_WINDOW=1
    
   sc_clock        clk; //clock signal
   sc_signal<bool> rst_n;
@@ -44,15 +62,17 @@ SC_MODULE(harness) {
   // --- Scoreboards --- //
   // Scoreboards refer to the receiver of the queue.
   // I.e. the receiver checks what is expected to be received. Thus sender must take care to push Transactions to the appropriate queue
-  sc_mutex                                                      sb_lock;
-  std::vector< std::deque< msg_tb_wrap<ace5_::AddrPayload> > >  sb_rd_req_q;
-  std::vector< std::deque< msg_tb_wrap<ace5_::ReadPayload> > >  sb_rd_resp_q;
+  // Each one holds a FIFO per flow (see tb_scoreboard.h) :
+  //   RD/WR Req : (Slave, TID), WR Data : (Slave, Initiator), RD/WR Resp : (Master, Resp, TID), Coherent : (Master, Addr)
+  sc_mutex                                             sb_lock;
+  tb_scoreboard< msg_tb_wrap<ace5_::AddrPayload> >     sb_rd_req_q;
+  tb_scoreboard< msg_tb_wrap<ace5_::ReadPayload> >     sb_rd_resp_q;
   
-  std::vector< std::deque< msg_tb_wrap<ace5_::AddrPayload > > >  sb_wr_req_q;
-  std::vector< std::deque< msg_tb_wrap<ace5_::WritePayload> > >  sb_wr_data_q;
-  std::vector< std::deque< msg_tb_wrap<ace5_::WRespPayload> > >  sb_wr_resp_q;
+  tb_scoreboard< msg_tb_wrap<ace5_::AddrPayload> >     sb_wr_req_q;
+  tb_scoreboard< msg_tb_wrap<ace5_::WritePayload> >    sb_wr_data_q;
+  tb_scoreboard< msg_tb_wrap<ace5_::WRespPayload> >    sb_wr_resp_q;
   
-  std::vector< std::deque< msg_tb_wrap<ace5_::AddrPayload> > >   sb_coherent_access_q;
+  tb_scoreboard< msg_tb_wrap<ace5_::AddrPayload> >     sb_coherent_access_q;
   std::vector< std::deque< msg_tb_wrap<ace5_::AC> > >            sb_snoop_req_q;
   std::vector< std::deque< msg_tb_wrap<ace5_::CR> > >            sb_snoop_resp_q;
   std::vector< std::deque< msg_tb_wrap<ace5_::CD> > >            sb_snoop_data_resp_q;
@@ -97,14 +117,7 @@ SC_MODULE(harness) {
     stop_gen("stop_gen"),
     
     sb_lock(),
-    sb_rd_req_q(smpl_cfg::SLAVE_NUM),
-    sb_rd_resp_q(smpl_cfg::ALL_MASTER_NUM),
     
-    sb_wr_req_q(smpl_cfg::SLAVE_NUM),
-    sb_wr_data_q(smpl_cfg::SLAVE_NUM),
-    sb_wr_resp_q(smpl_cfg::ALL_MASTER_NUM),
-
-    sb_coherent_access_q(smpl_cfg::ALL_MASTER_NUM),
     sb_snoop_req_q(smpl_cfg::FULL_MASTER_NUM),
     sb_snoop_resp_q(smpl_cfg::FULL_MASTER_NUM),
     sb_snoop_data_resp_q(smpl_cfg::FULL_MASTER_NUM),
@@ -112,6 +125,15 @@ SC_MODULE(harness) {
     coherency_checker("coherency_checker"),
     interconnect("interconnect")
   {
+    const char *trace_replay_f = tb_param_str("TB_TRACE_REPLAY", "");
+    const char *trace_rec_f    = tb_param_str("TB_TRACE_REC", "");
+    if (*trace_replay_f) {
+      NVHLS_ASSERT_MSG(trace_in.open(trace_replay_f), "Cannot open the replay trace!");
+      std::cout << "--- Replaying " << trace_in.num << " trace records from " << trace_replay_f << " ---\n";
+    } else if (*trace_rec_f) {
+      NVHLS_ASSERT_MSG(trace_out.open(trace_rec_f), "Cannot create the trace file!");
+    }
+    
     // Construct Components
     for (int i=0; i<smpl_cfg::FULL_MASTER_NUM; ++i)
       master[i] = new ace_master<smpl_cfg::RD_LANES, smpl_cfg::RD_LANES, smpl_cfg::WR_LANES, smpl_cfg::WR_LANES, smpl_cfg::ALL_MASTER_NUM, smpl_cfg::SLAVE_NUM>(sc_gen_unique_name("master"));
@@ -144,6 +166,7 @@ SC_MODULE(harness) {
     coherency_checker.sb_snoop_req_q        = &sb_snoop_req_q;  // Scoreboard by Ref
     coherency_checker.sb_snoop_resp_q       = &sb_snoop_resp_q;  // Scoreboard by Ref
     coherency_checker.sb_snoop_data_resp_q  = &sb_snoop_data_resp_q;  // Scoreboard by Ref
+    coherency_checker.holds_line = [this](unsigned m, ace5_::Addr addr) { return master[m]->holds_line(addr); };
   
     coherency_checker.stop_gen(stop_gen);
   
@@ -178,6 +201,13 @@ SC_MODULE(harness) {
       master[i]->AXI_GEN_RATE_RD     = AXI_GEN_RATE_RD[i];
       master[i]->AXI_GEN_RATE_WR     = AXI_GEN_RATE_WR[i];
       master[i]->ACE_GEN_RATE_CACHE  = ACE_GEN_RATE_CACHE[i];
+      master[i]->trace_out           = trace_out.is_open() ? &trace_out : NULL;
+      master[i]->meas                = meas.enabled ? &meas : NULL;
+      if (trace_in.is_open()) {
+        master[i]->replay.src    = &trace_in;
+        master[i]->replay.master = i+smpl_cfg::SLAVE_NUM;
+        master[i]->replay.mode   = trace_replay::mode_from_env();
+      }
       master[i]->stop_gen(stop_gen);
       
       master[i]->clk(clk);
@@ -220,6 +250,7 @@ SC_MODULE(harness) {
     // ACE-LITE MASTER
     for (int i=0; i<smpl_cfg::LITE_MASTER_NUM; ++i) {
       master_lite[i]->sb_lock      = &sb_lock;      // Scoreboard by Ref
+      master_lite[i]->meas         = meas.enabled ? &meas : NULL;
       master_lite[i]->sb_rd_req_q  = &sb_rd_req_q;  // Scoreboard by Ref
       master_lite[i]->sb_rd_resp_q = &sb_rd_resp_q; // Scoreboard by Ref
     
@@ -311,15 +342,33 @@ SC_MODULE(harness) {
   
     //sc_object_tracer<sc_clock> trace_clk(clk);
     Connections::set_sim_clk(&clk);
+    meas.clk_period = clk.period();
     
     SC_THREAD(harness_job);
     sensitive << clk.posedge_event();
+    
+    SC_THREAD(watchdog_job);
     //sc_object_tracer<sc_clock> trace_clk(clk);
     
   } // End of Constructor
   
+  // Checks the routers every TB_WDOG_CYCLES, it dumps the stuck buffers and their wait-for graph
+  void watchdog_job() {
+    if (WDOG_CYCLES<=0) return;
+    while(1) {
+      wait(clk.period()*WDOG_CYCLES);
+      if (rtr_watchdog::check(std::cout, WDOG_CYCLES)) {
+        std::cout << "\n!!! --- FAILED --- !!! Watchdog stopped the simulation @" << sc_time_stamp() << "\n";
+        std::cout.flush();
+        sc_stop();
+        return;
+      }
+    }
+  };
+  
   void harness_job() {
     std::cout << "--- Simulation is Starting @" << sc_time_stamp() << " ---\n";
+    speed.start();
 
     std::cout.flush();
     rst_n.write(false);
@@ -330,7 +379,16 @@ SC_MODULE(harness) {
     wait(CLK_PERIOD*2, SC_NS);
     
     stop_gen.write(false);
-    wait(CLK_PERIOD*GEN_CYCLES, SC_NS);
+    if (meas.enabled) meas.run(sb_rd_resp_q, sb_wr_resp_q);
+    else              wait(CLK_PERIOD*GEN_CYCLES, SC_NS);
+    
+    // A replayed trace lasts until every ACE master reaches its end
+    bool replay_done = false;
+    while (trace_in.is_open() && !replay_done) {
+      replay_done = true;
+      for (int i=0; i<smpl_cfg::FULL_MASTER_NUM; ++i) replay_done = replay_done && master[i]->replay_done();
+      if (!replay_done) wait(CLK_PERIOD*DRAIN_CYCLES, SC_NS);
+    }
     
     stop_gen.write(true);
     std::cout << "--- Transaction Generation Stopped @" << sc_time_stamp() << " ---\n";
@@ -339,19 +397,12 @@ SC_MODULE(harness) {
     // Drain
     bool all_drained = false;
     do {
-      int rd_req_remain  = 0;
-      int rd_resp_remain = 0;
-      
-      for(int i=0; i<smpl_cfg::SLAVE_NUM;  ++i) rd_req_remain  += sb_rd_req_q[i].size();
-      for(int i=0; i<smpl_cfg::ALL_MASTER_NUM; ++i) rd_resp_remain += sb_rd_resp_q[i].size();
+      int rd_req_remain  = sb_rd_req_q.size();
+      int rd_resp_remain = sb_rd_resp_q.size();
       
-      int wr_req_remain  = 0;
-      int wr_data_remain = 0;
-      int wr_resp_remain = 0;
-      
-      for(int i=0; i<smpl_cfg::SLAVE_NUM;++i)  wr_req_remain  += sb_wr_req_q[i].size();
-      for(int i=0; i<smpl_cfg::SLAVE_NUM;++i)  wr_data_remain += sb_wr_data_q[i].size();
-      for(int i=0; i<smpl_cfg::ALL_MASTER_NUM;++i) wr_resp_remain += sb_wr_resp_q[i].size();
+      int wr_req_remain  = sb_wr_req_q.size();
+      int wr_data_remain = sb_wr_data_q.size();
+      int wr_resp_remain = sb_wr_resp_q.size();
       
       
       // Outstanding coherent transactions
@@ -561,6 +612,53 @@ SC_MODULE(harness) {
     std::cout << "Full     Avg delay(cycles)      : " << rd_delay_full_total << ", "<< wr_delay_full_total << "\n";
     std::cout << "Throughput   (flits/cycle/node) : " << rd_throughput_total << ", "<< wr_throughput_total << "\n";
     */
+    
+    // Simulation speed, for examples/sim_bench.py
+    speed.report(std::cout, total_cycles, rd_trans_sum_glob + wr_trans_sum_glob);
+    if (meas.enabled) meas.report(std::cout);
+    
+    // Latency distribution, in total and per Master->Slave flow. ACE-Lite masters follow the ACE ones
+    lat_hist rd_lat_glob, wr_lat_glob;
+    lat_report lat_rep;
+    for (int j=0; j<smpl_cfg::SLAVE_NUM; ++j) {
+      for (int i=0; i<smpl_cfg::FULL_MASTER_NUM; ++i) {
+        rd_lat_glob.merge(master[i]->rd_lat[j]);
+        wr_lat_glob.merge(master[i]->wr_lat[j]);
+      }
+      for (int i=0; i<smpl_cfg::LITE_MASTER_NUM; ++i) {
+        rd_lat_glob.merge(master_lite[i]->rd_lat[j]);
+        wr_lat_glob.merge(master_lite[i]->wr_lat[j]);
+      }
+    }
+    lat_rep.add("ALL", "RD", rd_lat_glob);
+    lat_rep.add("ALL", "WR", wr_lat_glob);
+    for (int i=0; i<smpl_cfg::ALL_MASTER_NUM; ++i) {
+      for (int j=0; j<smpl_cfg::SLAVE_NUM; ++j) {
+        std::string flow = "M" + std::to_string(i) + "->S" + std::to_string(j);
+        bool is_lite = (i >= smpl_cfg::FULL_MASTER_NUM);
+        lat_rep.add(flow, "RD", is_lite ? master_lite[i-smpl_cfg::FULL_MASTER_NUM]->rd_lat[j] : master[i]->rd_lat[j]);
+        lat_rep.add(flow, "WR", is_lite ? master_lite[i-smpl_cfg::FULL_MASTER_NUM]->wr_lat[j] : master[i]->wr_lat[j]);
+      }
+    }
+    std::cout << "\n";
+    lat_rep.print(std::cout);
+    
+    // Machine readable dump. JSON when the name ends with .json, CSV otherwise
+    const char *lat_dump = tb_param_str("TB_LAT_DUMP", "");
+    if (*lat_dump) {
+      if (lat_rep.dump(lat_dump)) std::cout << "Latency dumped to " << lat_dump << "\n";
+      else                        std::cout << "Latency dump to " << lat_dump << " FAILED\n";
+    }
+    
+    if (trace_out.is_open()) {
+      std::cout << "Trace of " << trace_out.records << " records captured\n";
+      trace_out.close();
+    }
+    
+    // Binary event trace, decoded by examples/evt_decode.py. Only when built with EVT_TRACE_LEVEL>0
+    evt_trace_dump(tb_param_str("TB_EVT_TRACE", "evt_trace.bin"));
+    
+    std::cout << "\n";
     std::cout << __VERSION__ << "\n";
     std::cout.flush();
     
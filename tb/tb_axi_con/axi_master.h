@@ -7,9 +7,17 @@
 #include "../helper_non_synth.h"
 #include "../../src/include/flit_axi.h"
 #include "../tb_wrap.h"
+#include "../tb_scoreboard.h"
+#include "../lat_hist.h"
+#include "../meas_window.h"
+#include "../traffic_gen.h"
+#include "../axi_trace.h"
+#include "../../src/include/evt_trace.h"
 
 #include <deque>
 #include <queue>
+#include <map>
+#include <vector>
 
 #include <iostream>
 #include <fstream>
@@ -21,7 +29,9 @@
 #define AXI_BURST_NUM 3
 
 #define AXI4_MAX_LEN      4     // FIXED, WRAP bursts has a maximum of 16 beats
+#ifndef AXI4_MAX_INCR_LEN
 #define AXI4_MAX_INCR_LEN 4    // AXI4 extends INCR bursts upto 256 beats
+#endif
 
 
 template <unsigned int RD_M_LANES, unsigned int RD_S_LANES, unsigned int WR_M_LANES, unsigned int WR_S_LANES, unsigned int MASTER_NUM, unsigned int SLAVE_NUM>
@@ -44,16 +54,28 @@ SC_MODULE(axi_master) {
 	Connections::In<axi4_::WRespPayload>   b_in;
   
   // Scoreboard
-  sc_mutex                                                      *sb_lock;
-  std::vector< std::deque< msg_tb_wrap<axi4_::AddrPayload> > >  *sb_rd_req_q;
-  std::vector< std::deque< msg_tb_wrap<axi4_::ReadPayload> > >  *sb_rd_resp_q;
-  
-  std::vector< std::deque< msg_tb_wrap<axi4_::AddrPayload> > >   *sb_wr_req_q;
-  std::vector< std::deque< msg_tb_wrap<axi4_::WritePayload> > >  *sb_wr_data_q;
-  std::vector< std::deque< msg_tb_wrap<axi4_::WRespPayload> > >  *sb_wr_resp_q;
-  
-  std::deque<axi4_::AddrPayload>  sb_rd_order_q; // queue to check order
-  std::deque<axi4_::AddrPayload>  sb_wr_order_q; // queue to check order
+  sc_mutex                                             *sb_lock;
+  tb_scoreboard< msg_tb_wrap<axi4_::AddrPayload> >     *sb_rd_req_q;
+  tb_scoreboard< msg_tb_wrap<axi4_::ReadPayload> >     *sb_rd_resp_q;
+  
+  tb_scoreboard< msg_tb_wrap<axi4_::AddrPayload> >     *sb_wr_req_q;
+  tb_scoreboard< msg_tb_wrap<axi4_::WritePayload> >    *sb_wr_data_q;
+  tb_scoreboard< msg_tb_wrap<axi4_::WRespPayload> >    *sb_wr_resp_q;
+  
+  tb_scoreboard<axi4_::AddrPayload>  sb_rd_order_q; // Outstanding requests per ID, to check order
+  tb_scoreboard<axi4_::AddrPayload>  sb_wr_order_q; // Outstanding requests per ID, to check order
+  std::map<unsigned, std::deque<unsigned> > rd_beat_dst; // The Slave of each expected RD beat per ID, to check order
+  
+  // Channel striping and packet length bound of the Master IF (axi_master_if STRIPE_CH, LOG_STRIPE, MAX_BEATS).
+  //   The Slaves then expect the sub-bursts the IF splits a request into, and the Master their merged responses
+  unsigned STRIPE_CH;
+  unsigned LOG_STRIPE;
+  unsigned MAX_BEATS;
+  struct sub_burst {
+    axi4_::AddrPayload req;      // In Master terms
+    axi4_::Addr        net_addr; // The address the Slave IF receives
+    unsigned           dst;      // The Slave
+  };
   
   std::queue<axi4_::AddrPayload>   stored_rd_trans;
   std::queue<axi4_::AddrPayload>   stored_wr_trans;
@@ -62,6 +84,9 @@ SC_MODULE(axi_master) {
 	int MASTER_ID  = -1;
 	unsigned int GEN_RATE_RD;
   unsigned int GEN_RATE_WR;
+  traffic_cfg  TRAFFIC;    // Destination pattern, injection process and burst lengths
+  trace_writer *trace_out; // Records the pushed AR/AW/W when set
+  trace_replay  replay;    // Replays a trace instead of the random generator when its src is set
   // int FLOW_CTRL;     // 0: READY-VALID
   //                    // 1: CREDITS 
   //                    // 2: FIFO
@@ -79,6 +104,10 @@ SC_MODULE(axi_master) {
   unsigned long long int last_wr_sinked_cycle = 0;
   unsigned long long int rd_resp_data_count = 0;
   unsigned long long int wr_resp_data_count = 0;
+  // Latency distribution per target slave
+  lat_hist rd_lat[SLAVE_NUM];
+  lat_hist wr_lat[SLAVE_NUM];
+  meas_window *meas; // Only the marked requests are measured when set
   
 	bool stop_at_tail, has_stopped_gen;
   
@@ -96,6 +125,14 @@ SC_MODULE(axi_master) {
   unsigned int gen_wr_addr;
   unsigned int resp_val_expect;
   
+  traffic_gen rd_traffic;
+  traffic_gen wr_traffic;
+  
+  trace_deps  deps;      // Outstanding and completed requests of the trace
+  uint32_t    trace_seq;
+  
+  evt_ring    evt;       // Event trace (see evt_trace.h)
+  
   // Read Responce Sink
   int rd_resp_ej;
   int wr_resp_ej;
@@ -108,6 +145,15 @@ SC_MODULE(axi_master) {
 	void do_cycle();
 	void gen_new_rd_trans();
 	void gen_new_wr_trans();
+	void issue_rd_trans(axi4_::AddrPayload &rd_req_m);
+	void issue_wr_trans(axi4_::AddrPayload &m_wr_req);
+	void split_trans(const axi4_::AddrPayload &req, std::vector<sub_burst> &subs);
+	void replay_trans(const trace_rec &rec);
+	void record_req(const axi4_::AddrPayload &req, bool is_wr);
+	void record_data(const axi4_::WritePayload &beat);
+  
+  unsigned long long int cur_cycle() { return (unsigned long long int)(sc_time_stamp() / clk_period); };
+  bool replay_done() { return replay.done(); };
   
 	void verify_rd_resp(axi4_::ReadPayload  &rcv_rd_resp);
 	void verify_wr_resp(axi4_::WRespPayload &rcv_wr_resp);
@@ -124,6 +170,12 @@ SC_MODULE(axi_master) {
     MASTER_ID = -1;
     GEN_RATE_RD  = 0;
     GEN_RATE_WR  = 0;
+    trace_out    = NULL;
+    meas         = NULL;
+    STRIPE_CH    = 0;
+    LOG_STRIPE   = 12;
+    MAX_BEATS    = 0;
+    evt.init(this->name());
     
 		SC_THREAD(do_cycle);
     sensitive << clk.pos();
@@ -162,18 +214,24 @@ void axi_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAV
   
   clk_period = (dynamic_cast<sc_clock *>(clk.get_interface()))->period();
   
+  rd_traffic.cfg = TRAFFIC;
+  wr_traffic.cfg = TRAFFIC;
+  deps.reset();
+  trace_seq = 0;
+  
   while(1) {
     wait();
     
     // Transaction Generator
-    if (!stop_gen.read()) {
-      unsigned int rnd_val_rd = rand()%100;
-      if (rnd_val_rd < GEN_RATE_RD) {
+    if (!stop_gen.read() && replay.active()) {
+      const trace_rec *rec;
+      while ((rec = replay.next(deps, cur_cycle())) != NULL) replay_trans(*rec);
+    } else if (!stop_gen.read()) {
+      if (rd_traffic.inject(GEN_RATE_RD)) {
         gen_new_rd_trans();
       }
       
-      unsigned int rnd_val_wr = rand()%100;
-      if (rnd_val_wr < GEN_RATE_WR) {
+      if (wr_traffic.inject(GEN_RATE_WR)) {
         gen_new_wr_trans();
       }
     }
@@ -183,7 +241,9 @@ void axi_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAV
       axi4_::AddrPayload tmp_ar = stored_rd_trans.front();
       if (ar_out.PushNB(tmp_ar)){
         stored_rd_trans.pop();
-        std::cout<<"[Master "<< MASTER_ID << "] : PUSHED AR:" << tmp_ar << " @" << sc_time_stamp() << std::endl;
+        EVT_TRACE(EVT_LVL_TXN, evt, EVT_AR, tmp_ar.id.to_uint(), tmp_ar.addr.to_uint64(), tmp_ar.len.to_uint(),
+                  std::cout<<"[Master "<< MASTER_ID << "] : PUSHED AR:" << tmp_ar << " @" << sc_time_stamp() << "\n");
+        if (trace_out) record_req(tmp_ar, false);
         rd_trans_inj++;
       }
     }
@@ -193,7 +253,9 @@ void axi_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAV
       axi4_::AddrPayload tmp_aw = stored_wr_trans.front();
       if (aw_out.PushNB(tmp_aw)) {
         stored_wr_trans.pop();
-        std::cout<<"[Master "<< MASTER_ID << "] : PUSHED AW: " << tmp_aw << " @" << sc_time_stamp() << std::endl;
+        EVT_TRACE(EVT_LVL_TXN, evt, EVT_AW, tmp_aw.id.to_uint(), tmp_aw.addr.to_uint64(), tmp_aw.len.to_uint(),
+                  std::cout<<"[Master "<< MASTER_ID << "] : PUSHED AW: " << tmp_aw << " @" << sc_time_stamp() << "\n");
+        if (trace_out) record_req(tmp_aw, true);
         wr_trans_inj++;
       }
     }
@@ -203,7 +265,9 @@ void axi_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAV
       axi4_::WritePayload tmp_w = stored_wr_data.front();
       if (w_out.PushNB(tmp_w)) {
         stored_wr_data.pop();
-        std::cout<<"[Master "<< MASTER_ID << "] : PUSHED W: " << tmp_w << " @" << sc_time_stamp() << std::endl;
+        EVT_TRACE(EVT_LVL_BEAT, evt, EVT_W, 0, 0, tmp_w.last.to_uint(),
+                  std::cout<<"[Master "<< MASTER_ID << "] : PUSHED W: " << tmp_w << " @" << sc_time_stamp() << "\n");
+        if (trace_out) record_data(tmp_w);
         wr_data_inj++;
       }
     }
@@ -230,83 +294,106 @@ void axi_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAV
   axi4_::AddrPayload rd_req_m;
   
   rd_req_m.id   = (rand()%AXI_TID_NUM);
-  rd_req_m.size  = ((rand()%my_log2c(RD_M_LANES))+1) & ((1<<my_log2c(RD_M_LANES))-1);
+  rd_req_m.size  = (dnp::PACK_GRAN_W+(rand()%(my_log2c(RD_M_LANES)-dnp::PACK_GRAN_W+1))) & ((1<<my_log2c(RD_M_LANES))-1); // Sizes narrower than a phit's bytes are NOT supported, unless narrow packing
   rd_req_m.burst = (rand()%AXI_BURST_NUM);
   rd_req_m.len   = (rd_req_m.burst==enc_::AXBURST::WRAP)  ? ((1<<(rand()%my_log2c(AXI4_MAX_LEN+1)))-1)           :
                    (rd_req_m.burst==enc_::AXBURST::FIXED) ? (rand()%AXI4_MAX_LEN)                                :
                    (RD_M_LANES>RD_S_LANES) ? (rand()%(AXI4_MAX_INCR_LEN/(RD_M_LANES/RD_S_LANES)))    // INCR With    Downsize // Cap the maximum len in case of transactions downsize (which increases len)
                                            : (rand()%AXI4_MAX_INCR_LEN)                           ;  // INCR WithOut Downsize
+  if (TRAFFIC.burst != traffic_cfg::BURST_RAND) {
+    rd_req_m.burst = enc_::AXBURST::INCR;
+    rd_req_m.len   = rd_traffic.burst_len((RD_M_LANES>RD_S_LANES) ? (AXI4_MAX_INCR_LEN/(RD_M_LANES/RD_S_LANES)) : AXI4_MAX_INCR_LEN);
+  }
   
   // Increasing address to keep track of the transactions
   rd_req_m.addr  = gen_rd_addr + ((rand()%RD_M_LANES) & (1<<rd_req_m.size));
   
-  rd_req_m.addr   = (rand()%2) ? gen_rd_addr : gen_rd_addr + 0x10000; //addr_map[i][1].read();
+  // The destination slave follows the traffic pattern
+  rd_req_m.addr   = addr_map[rd_traffic.dest(MASTER_ID, MASTER_NUM, SLAVE_NUM)][0].read() + gen_rd_addr;
   gen_rd_addr = gen_rd_addr + RD_M_LANES;
   
+  issue_rd_trans(rd_req_m);
+}; // End of Read generator
+
+// Queues a Read request for injection and pushes the expected transactions to the Scoreboard
+template <unsigned int RD_M_LANES, unsigned int RD_S_LANES, unsigned int WR_M_LANES, unsigned int WR_S_LANES, unsigned int MASTER_NUM, unsigned int SLAVE_NUM>
+void axi_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAVE_NUM>::issue_rd_trans(axi4_::AddrPayload &rd_req_m) {
   // Push it to injection queue
   stored_rd_trans.push(rd_req_m);
   
+  // The sub-bursts the Master IF sends, a single one unless split
+  std::vector<sub_burst> subs;
+  split_trans(rd_req_m, subs);
+  
   // Push it to Scoreboard
   sb_lock->lock();
-  // Consider resizing at slave
-  axi4_::AddrPayload rd_req_s;
-  rd_req_s.id   = rd_req_m.id;
-  rd_req_s.size  = ((1<<rd_req_m.size)>RD_S_LANES) ? my_log2c(RD_S_LANES) : (unsigned) rd_req_m.size;
-  rd_req_s.len   = ((1<<rd_req_m.size)>RD_S_LANES) ? unsigned (((rd_req_m.len+1)<<(rd_req_m.size-my_log2c(RD_S_LANES)))-1) : (unsigned) rd_req_m.len;
-  rd_req_s.burst = rd_req_m.burst;
-  rd_req_s.addr  = rd_req_m.addr;
-  
-  msg_tb_wrap<axi4_::AddrPayload> temp_rd_req_tb;
-  temp_rd_req_tb.dut_msg = rd_req_s;
-  
-  temp_rd_req_tb.time_gen = sc_time_stamp();
-  
-  unsigned dst = mem_map_resolve(rd_req_s.addr);
-  (*sb_rd_req_q)[dst].push_back(temp_rd_req_tb);
+  for (unsigned s=0; s<subs.size(); ++s) {
+    axi4_::AddrPayload &sub_m = subs[s].req;
+    // Consider resizing at slave
+    axi4_::AddrPayload rd_req_s;
+    rd_req_s.id   = sub_m.id;
+    rd_req_s.size  = ((1<<sub_m.size)>RD_S_LANES) ? my_log2c(RD_S_LANES) : (unsigned) sub_m.size;
+    rd_req_s.len   = ((1<<sub_m.size)>RD_S_LANES) ? unsigned (((sub_m.len+1)<<(sub_m.size-my_log2c(RD_S_LANES)))-1) : (unsigned) sub_m.len;
+    rd_req_s.burst = sub_m.burst;
+    rd_req_s.addr  = subs[s].net_addr;
+    
+    msg_tb_wrap<axi4_::AddrPayload> temp_rd_req_tb;
+    temp_rd_req_tb.dut_msg = rd_req_s;
+    
+    temp_rd_req_tb.time_gen = sc_time_stamp();
+    
+    sb_rd_req_q->push(sb_key(subs[s].dst, rd_req_s.id.to_uint() & ((1<<dnp::ID_W)-1)), temp_rd_req_tb);
+  }
   sb_lock->unlock();
   
   // Push into order queue - Reorder check extension
-  sb_rd_order_q.push_back(rd_req_m);
+  sb_rd_order_q.push(sb_key(rd_req_m.id.to_uint()), rd_req_m);
   
   rd_trans_generated++;
   
   // --- --- --- --- --- --- --- --- //
   // Generate the expected Responce
   // --- --- --- --- --- --- --- --- //
+  // Each Slave counts the bytes of its sub-burst from 0. The merged burst has a single RLAST
   sb_lock->lock();
   axi4_::ReadPayload beat_expected;
   
   beat_expected.id = rd_req_m.id;
   
-  // Create Expected Response
-  unsigned long int bytes_total = ((rd_req_m.len+1)<<rd_req_m.size);
-  unsigned long int byte_count  = 0;
-  
-  unsigned char m_init_ptr  = rd_req_m.addr % RD_M_LANES;
-  unsigned char m_ptr       = m_init_ptr;
-  unsigned char m_size      = rd_req_m.size;
-  
-  beat_expected.data = 0;
-  
-  while(byte_count<bytes_total) {
-    beat_expected.data |= ( ((axi4_::Data)(byte_count & 0xFF)) << ((axi4_::Data)(m_ptr*8)));
-    byte_count++;
-  
-    m_ptr = (rd_req_m.burst==enc_::AXBURST::FIXED) ? ((m_ptr+1)%(1<<m_size)) + m_init_ptr
-                                    :  (m_ptr+1)%RD_M_LANES ;
+  for (unsigned s=0; s<subs.size(); ++s) {
+    axi4_::AddrPayload &sub_m = subs[s].req;
     
-    if(((m_ptr%(1<<m_size))==0) || (byte_count == bytes_total)) {
-      beat_expected.resp = mem_map_resolve(rd_req_m.addr);
-      beat_expected.last = (byte_count == bytes_total);
-      
-      msg_tb_wrap< axi4_::ReadPayload > temp_rd_resp_tb;
-      temp_rd_resp_tb.dut_msg  = beat_expected;
-      temp_rd_resp_tb.time_gen = sc_time_stamp();
+    // Create Expected Response
+    unsigned long int bytes_total = ((sub_m.len+1)<<sub_m.size);
+    unsigned long int byte_count  = 0;
+    
+    unsigned char m_init_ptr  = sub_m.addr % RD_M_LANES;
+    unsigned char m_ptr       = m_init_ptr;
+    unsigned char m_size      = sub_m.size;
+    
+    beat_expected.data = 0;
+    
+    while(byte_count<bytes_total) {
+      beat_expected.data |= ( ((axi4_::Data)(byte_count & 0xFF)) << ((axi4_::Data)(m_ptr*8)));
+      byte_count++;
+    
+      m_ptr = (sub_m.burst==enc_::AXBURST::FIXED) ? ((m_ptr+1)%(1<<m_size)) + m_init_ptr
+                                                  :  (m_ptr+1)%RD_M_LANES ;
       
-      (*sb_rd_resp_q)[MASTER_ID].push_back(temp_rd_resp_tb);
-      beat_expected.data = 0;
-  
-      rd_data_generated++;
+      if(((m_ptr%(1<<m_size))==0) || (byte_count == bytes_total)) {
+        beat_expected.resp = subs[s].dst;
+        beat_expected.last = (byte_count == bytes_total) && (s==subs.size()-1);
+        
+        msg_tb_wrap< axi4_::ReadPayload > temp_rd_resp_tb;
+        temp_rd_resp_tb.dut_msg  = beat_expected;
+        temp_rd_resp_tb.time_gen = sc_time_stamp();
+        
+        sb_rd_resp_q->push(sb_key(MASTER_ID, beat_expected.resp.to_uint(), beat_expected.id.to_uint() & ((1<<dnp::ID_W)-1)), temp_rd_resp_tb);
+        rd_beat_dst[rd_req_m.id.to_uint()].push_back(subs[s].dst);
+        beat_expected.data = 0;
+    
+        rd_data_generated++;
+      }
     }
   }
   sb_lock->unlock();
@@ -314,29 +401,44 @@ void axi_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAV
 
 template <unsigned int RD_M_LANES, unsigned int RD_S_LANES, unsigned int WR_M_LANES, unsigned int WR_S_LANES, unsigned int MASTER_NUM, unsigned int SLAVE_NUM>
 void axi_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAVE_NUM>::gen_new_wr_trans() {
-  sb_lock->lock();
   axi4_::AddrPayload m_wr_req;
   
   m_wr_req.id    = (rand()%AXI_TID_NUM);
-  m_wr_req.size  = ((rand()%my_log2c(WR_M_LANES))+1) & ((1<<my_log2c(WR_M_LANES))-1); // 0 size is NOT supported
+  m_wr_req.size  = (dnp::PACK_GRAN_W+(rand()%(my_log2c(WR_M_LANES)-dnp::PACK_GRAN_W+1))) & ((1<<my_log2c(WR_M_LANES))-1); // Sizes narrower than a phit's bytes are NOT supported, unless narrow packing
   m_wr_req.burst = (rand()%AXI_BURST_NUM);
   m_wr_req.len   = (m_wr_req.burst==enc_::AXBURST::WRAP)  ? ((1<<(rand()%my_log2c(AXI4_MAX_LEN+1)))-1)           :
                    (m_wr_req.burst==enc_::AXBURST::FIXED) ? (rand()%AXI4_MAX_LEN)                                :
                    (WR_M_LANES>WR_S_LANES) ? (rand()%(AXI4_MAX_INCR_LEN/(WR_M_LANES/WR_S_LANES)))    // INCR With    Downsize // Cap the maximum len in case of transactions downsize (which increases len)
                                            : (rand()%AXI4_MAX_INCR_LEN)                           ;  // INCR WithOut Downsize
+  if (TRAFFIC.burst != traffic_cfg::BURST_RAND) {
+    m_wr_req.burst = enc_::AXBURST::INCR;
+    m_wr_req.len   = wr_traffic.burst_len((WR_M_LANES>WR_S_LANES) ? (AXI4_MAX_INCR_LEN/(WR_M_LANES/WR_S_LANES)) : AXI4_MAX_INCR_LEN);
+  }
   
   // Increasing address to keep track of the transactions
   // Aligned on size transactions (Although non-aligned should be an easy addition)
   m_wr_req.addr  = gen_wr_addr + ((rand()%WR_M_LANES) & (1<<m_wr_req.size));
   
-  m_wr_req.addr   = (rand()%2) ? gen_wr_addr : gen_wr_addr + 0x10000; //addr_map[i][1].read();
+  // The destination slave follows the traffic pattern
+  m_wr_req.addr   = addr_map[wr_traffic.dest(MASTER_ID, MASTER_NUM, SLAVE_NUM)][0].read() + gen_wr_addr;
   gen_wr_addr    = gen_wr_addr + WR_M_LANES;
   
+  issue_wr_trans(m_wr_req);
+}; // End of Write generator
+
+// Queues a Write request and its data for injection and pushes the expected transactions to the Scoreboard
+template <unsigned int RD_M_LANES, unsigned int RD_S_LANES, unsigned int WR_M_LANES, unsigned int WR_S_LANES, unsigned int MASTER_NUM, unsigned int SLAVE_NUM>
+void axi_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAVE_NUM>::issue_wr_trans(axi4_::AddrPayload &m_wr_req) {
+  sb_lock->lock();
   // Push it to injection queue
   stored_wr_trans.push(m_wr_req);
   
   // Push into order queue - Reorder check extension
-  sb_wr_order_q.push_back(m_wr_req);
+  sb_wr_order_q.push(sb_key(m_wr_req.id.to_uint()), m_wr_req);
+  
+  // The sub-bursts the Master IF sends, a single one unless split
+  std::vector<sub_burst> subs;
+  split_trans(m_wr_req, subs);
   
   // Create dummy write data
   axi4_::WritePayload cur_beat;      // The beat that will be injected at MASTER
@@ -353,23 +455,30 @@ void axi_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAV
   
   unsigned char m_size = m_wr_req.size;
   unsigned char s_size = ((1<<m_size)>WR_S_LANES) ? my_log2c(WR_S_LANES) : m_size;
-
-  unsigned char m_len = m_wr_req.len;
-  unsigned char s_len = ((1<<m_size)>WR_S_LANES) ? (((m_len+1)<<(m_size-s_size))-1) : m_len;
   
   // Push it to Scoreboard
-  axi4_::AddrPayload s_wr_req;
-  s_wr_req.id   = m_wr_req.id;
-  s_wr_req.addr  = m_wr_req.addr;
-  s_wr_req.size  = s_size;
-  s_wr_req.len   = s_len;
-  s_wr_req.burst = m_wr_req.burst;
-  
-  msg_tb_wrap<axi4_::AddrPayload> temp_wr_req_tb;
-  temp_wr_req_tb.dut_msg = s_wr_req;
+  for (unsigned s=0; s<subs.size(); ++s) {
+    unsigned char m_len = subs[s].req.len;
+    unsigned char s_len = ((1<<m_size)>WR_S_LANES) ? (((m_len+1)<<(m_size-s_size))-1) : m_len;
+    
+    axi4_::AddrPayload s_wr_req;
+    s_wr_req.id   = m_wr_req.id;
+    s_wr_req.addr  = subs[s].net_addr;
+    s_wr_req.size  = s_size;
+    s_wr_req.len   = s_len;
+    s_wr_req.burst = m_wr_req.burst;
+    
+    msg_tb_wrap<axi4_::AddrPayload> temp_wr_req_tb;
+    temp_wr_req_tb.dut_msg = s_wr_req;
+    
+    sb_wr_req_q->push(sb_key(subs[s].dst, s_wr_req.id.to_uint() & ((1<<dnp::ID_W)-1)), temp_wr_req_tb);
+  }
   
-  unsigned dst = mem_map_resolve(s_wr_req.addr);
-  (*sb_wr_req_q)[dst].push_back(temp_wr_req_tb);
+  // The beats expected at the Slave of each sub-burst, queued once the initiator of its last is known.
+  //   The last byte of every sub-burst is the initiator, as each is a burst of its own at its Slave
+  std::vector< msg_tb_wrap<axi4_::WritePayload> > beats_at_slave;
+  unsigned          sub     = 0;
+  unsigned long int sub_end = ((subs[0].req.len+1)<<m_size);
   
   cur_beat.data  = 0;
   cur_beat.wstrb = 0;
@@ -377,7 +486,7 @@ void axi_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAV
   beat_at_slave.wstrb = 0;
   
   while(byte_count<bytes_total) {
-    unsigned byte_to_write = (byte_count==bytes_total-1) ? MASTER_ID : byte_count;
+    unsigned byte_to_write = (byte_count==sub_end-1) ? MASTER_ID : byte_count;
     cur_beat.data |= (((axi4_::Data)(byte_to_write & 0xFF)) << ((axi4_::Data)(m_ptr*8)));
     cur_beat.wstrb |= (((axi4_::Data)1) << ((axi4_::Data)m_ptr));
     
@@ -400,24 +509,140 @@ void axi_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAV
       cur_beat.wstrb = 0;
     }
 
-    if(((s_ptr%(1<<s_size))==0) || (byte_count == bytes_total)) {
-      beat_at_slave.last = (byte_count == bytes_total);
+    if(((s_ptr%(1<<s_size))==0) || (byte_count == sub_end)) {
+      beat_at_slave.last = (byte_count == sub_end);
       msg_tb_wrap< axi4_::WritePayload > temp_wr_data_tb;
       temp_wr_data_tb.dut_msg = beat_at_slave;
         
-      wr_resp_data_count++;
+      if (!meas || meas->in(sc_time_stamp())) wr_resp_data_count++;
       last_wr_sinked_cycle = (sc_time_stamp() / clk_period);
       
-      (*sb_wr_data_q)[dst].push_back(temp_wr_data_tb);
+      beats_at_slave.push_back(temp_wr_data_tb);
       beat_at_slave.data  = 0;
       beat_at_slave.wstrb = 0;
     }
+    
+    if (byte_count == sub_end) {
+      sb_key_t data_key = sb_key(subs[sub].dst, sb_wr_initiator(beats_at_slave.back().dut_msg, WR_S_LANES));
+      for (unsigned i=0; i<beats_at_slave.size(); ++i) sb_wr_data_q->push(data_key, beats_at_slave[i]);
+      beats_at_slave.clear();
+      if (++sub < subs.size()) sub_end += ((subs[sub].req.len+1)<<m_size);
+    }
   }
   
   sb_lock->unlock();
   
   wr_trans_generated++;
-}; // End of Read generator
+}; // End of Write issue
+
+// The sub-bursts the Master IF splits req into, at each stripe boundary of the striped channels and every MAX_BEATS,
+//   as its burst_split(). A striped one is received at its channel as the dense offset of the channel's stripes
+template <unsigned int RD_M_LANES, unsigned int RD_S_LANES, unsigned int WR_M_LANES, unsigned int WR_S_LANES, unsigned int MASTER_NUM, unsigned int SLAVE_NUM>
+void axi_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAVE_NUM>::split_trans(const axi4_::AddrPayload &req, std::vector<sub_burst> &subs) {
+  subs.clear();
+  axi4_::AddrPayload rest = req;
+  bool more = true;
+  while (more) {
+    sub_burst this_sub;
+    this_sub.req = rest;
+    
+    bool incr  = (rest.burst.to_uint()==enc_::AXBURST::INCR);
+    bool fixed = (rest.burst.to_uint()==enc_::AXBURST::FIXED);
+    
+    unsigned long long addr       = rest.addr.to_uint64();
+    unsigned long long aligned    = addr & ~((1ULL<<rest.size.to_uint())-1);
+    unsigned long long stripe_m   = (1ULL<<LOG_STRIPE)-1;
+    unsigned long long off        = addr - addr_map[0][0].read().to_uint64();
+    unsigned int       beats_left = rest.len.to_uint()+1;
+    unsigned int       beats_in   = beats_left;
+    unsigned           dst        = mem_map_resolve(rest.addr);
+    bool               striped    = (STRIPE_CH>0) && (dst<STRIPE_CH);
+    
+    if (striped && incr) beats_in = (addr + ((1ULL<<LOG_STRIPE) - (off & stripe_m)) - aligned) >> rest.size.to_uint();
+    if ((MAX_BEATS>0) && (incr || fixed) && (beats_in>MAX_BEATS)) beats_in = MAX_BEATS;
+    more = (beats_left>beats_in);
+    if (more) {
+      this_sub.req.len = beats_in-1;
+      rest.addr = fixed ? addr : (aligned + ((unsigned long long)beats_in << rest.size.to_uint()));
+      rest.len  = beats_left-beats_in-1;
+    }
+    
+    this_sub.dst      = striped ? (unsigned)((off >> LOG_STRIPE) & (STRIPE_CH-1)) : dst;
+    this_sub.net_addr = striped ? (axi4_::Addr)(addr_map[this_sub.dst][0].read().to_uint64() +
+                                                (((off >> (LOG_STRIPE+my_log2c(STRIPE_CH))) << LOG_STRIPE) | (off & stripe_m)))
+                                : this_sub.req.addr;
+    subs.push_back(this_sub);
+  }
+};
+
+// ------------------------ //
+// --- TRACE Functions  --- //
+// ------------------------ //
+// Replays a traced request. The request is legalized to what this testbench supports
+// (size, burst, len, mapped address), its data follow the self-checking pattern of the generators
+template <unsigned int RD_M_LANES, unsigned int RD_S_LANES, unsigned int WR_M_LANES, unsigned int WR_S_LANES, unsigned int MASTER_NUM, unsigned int SLAVE_NUM>
+void axi_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAVE_NUM>::replay_trans(const trace_rec &rec) {
+  bool     is_wr   = (rec.kind == trace_rec::AW);
+  unsigned m_lanes = is_wr ? WR_M_LANES : RD_M_LANES;
+  unsigned s_lanes = is_wr ? WR_S_LANES : RD_S_LANES;
+  
+  axi4_::AddrPayload req;
+  rec.get_req(req);
+  req.qos = rec.qos;
+  
+  unsigned size = rec.size;
+  if (size > my_log2c(m_lanes)) size = my_log2c(m_lanes);
+  if (size < dnp::PACK_GRAN_W)        size = dnp::PACK_GRAN_W & ((1<<my_log2c(m_lanes))-1); // Sizes narrower than a phit's bytes are NOT supported, unless narrow packing
+  req.size = size;
+  
+  unsigned len = rec.len;
+  if (rec.burst == enc_::AXBURST::WRAP && len!=1 && len!=3 && len!=7 && len!=15) req.burst = enc_::AXBURST::INCR;
+  else if (rec.burst > enc_::AXBURST::WRAP)                                       req.burst = enc_::AXBURST::INCR;
+  if (req.burst == enc_::AXBURST::FIXED && len > 15) len = 15;
+  // Downsizing multiplies the beats at the slave, keep them within 256
+  if ((1u<<size) > s_lanes) {
+    unsigned max_len = (256 >> (size-my_log2c(s_lanes))) - 1;
+    if (len > max_len) len = max_len;
+  }
+  req.len = len;
+  
+  // Unmapped addresses are folded in the address map. Aligned on size
+  axi4_::Addr addr = rec.addr;
+  bool mapped = false;
+  for (int i=0; i<SLAVE_NUM; ++i) mapped = mapped || (addr>=addr_map[i][0].read() && addr <= addr_map[i][1].read());
+  if (!mapped) addr = addr_map[0][0].read() + (rec.addr % (addr_map[SLAVE_NUM-1][1].read() - addr_map[0][0].read() + 1));
+  req.addr = addr & ~((axi4_::Addr)((1<<size)-1));
+  
+  deps.issued(is_wr, req.id.to_uint() & ((1<<dnp::ID_W)-1), rec.seq);
+  if (is_wr) issue_wr_trans(req);
+  else       issue_rd_trans(req);
+}; // End of Replay
+
+template <unsigned int RD_M_LANES, unsigned int RD_S_LANES, unsigned int WR_M_LANES, unsigned int WR_S_LANES, unsigned int MASTER_NUM, unsigned int SLAVE_NUM>
+void axi_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAVE_NUM>::record_req(const axi4_::AddrPayload &req, bool is_wr) {
+  unsigned long long int now = cur_cycle();
+  trace_rec rec;
+  rec.kind    = is_wr ? trace_rec::AW : trace_rec::AR;
+  rec.master  = MASTER_ID;
+  rec.cycle   = now;
+  rec.set_req(req);
+  rec.qos     = req.qos.to_uint();
+  rec.seq     = trace_seq++;
+  rec.dep     = deps.last_done;
+  rec.dep_gap = (deps.last_done == trace_rec::NO_DEP) ? 0 : (uint32_t)(now - deps.last_done_cycle);
+  trace_out->put(rec);
+  if (!replay.active()) deps.issued(is_wr, req.id.to_uint() & ((1<<dnp::ID_W)-1), rec.seq);
+};
+
+template <unsigned int RD_M_LANES, unsigned int RD_S_LANES, unsigned int WR_M_LANES, unsigned int WR_S_LANES, unsigned int MASTER_NUM, unsigned int SLAVE_NUM>
+void axi_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAVE_NUM>::record_data(const axi4_::WritePayload &beat) {
+  trace_rec rec;
+  rec.kind   = trace_rec::W;
+  rec.master = MASTER_ID;
+  rec.cycle  = cur_cycle();
+  rec.set_data(beat);
+  trace_out->put(rec);
+};
 
 // ------------------------ //
 // --- VERIFY Functions --- //
@@ -429,54 +654,62 @@ void axi_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAV
   
   // --- Reorder Check --- //
   int reorder=2; // 2 : Req not found, 1 : Request reordered, 0 : everything is fine
-  unsigned j=0;
   axi4_::AddrPayload sb_ord_req;
-  while (j<sb_rd_order_q.size()){
-    sb_ord_req = sb_rd_order_q[j];
-    
-    if(sb_ord_req.id == rcv_rd_resp.id) {
-      // Slave must sneak its ID to the resp field.
-      unsigned dst = mem_map_resolve(sb_ord_req.addr);
-      reorder = (dst  == rcv_rd_resp.resp) ? 0 : 1;
-      if(rcv_rd_resp.last) sb_rd_order_q.erase(sb_rd_order_q.begin()+j);
-      break;
-    }
-    
-    j++;
+  unsigned lat_dst = 0;
+  // The response must be of the oldest outstanding request of its ID
+  sb_key_t ord_key = sb_key(rcv_rd_resp.id.to_uint());
+  int      ord     = sb_rd_order_q.first(ord_key);
+  if (ord != SB_NIL) {
+    sb_ord_req = sb_rd_order_q.at(ord);
+    // Slave must sneak its ID to the resp field. The beats of a split burst come from the Slave of their sub-burst
+    std::deque<unsigned> &beat_dst = rd_beat_dst[rcv_rd_resp.id.to_uint()];
+    unsigned dst = beat_dst.empty() ? mem_map_resolve(sb_ord_req.addr) : beat_dst.front();
+    if (!beat_dst.empty()) beat_dst.pop_front();
+    lat_dst = dst;
+    reorder = (dst  == rcv_rd_resp.resp) ? 0 : 1;
+    if(rcv_rd_resp.last) sb_rd_order_q.erase(ord_key, ord);
   }
   // --------------------- //
   
+  // Expected in order within the flow, the search goes further only if the beat was reordered
   bool found=false;
-  j=0;
-  while (j<(*sb_rd_resp_q)[MASTER_ID].size()){
-    msg_tb_wrap< axi4_::ReadPayload > sb_resp = (*sb_rd_resp_q)[MASTER_ID][j];
+  sb_key_t key = sb_key(MASTER_ID, rcv_rd_resp.resp.to_uint(), rcv_rd_resp.id.to_uint() & ((1<<dnp::ID_W)-1));
+  int      j   = sb_rd_resp_q->first(key);
+  while (j != SB_NIL){
+    msg_tb_wrap< axi4_::ReadPayload > &sb_resp = sb_rd_resp_q->at(j);
     
     if (eq_rd_data(rcv_rd_resp, sb_resp.dut_msg)){
+      bool measured = !meas || meas->in(sb_resp.time_gen);
       if (sb_resp.dut_msg.last) {
-        rd_resp_delay += ((sc_time_stamp() - sb_resp.time_gen) / clk_period) - 1;
-        rd_resp_count++; 
+        unsigned long long int this_delay = ((sc_time_stamp() - sb_resp.time_gen) / clk_period) - 1;
+        if (measured) {
+          rd_resp_delay += this_delay;
+          rd_lat[lat_dst].add(this_delay);
+          rd_resp_count++;
+          if (meas) meas->record(this_delay);
+        }
+        if (trace_out || replay.active()) deps.completed(false, rcv_rd_resp.id.to_uint() & ((1<<dnp::ID_W)-1), cur_cycle());
       }
-      rd_resp_data_count++;
+      if (measured) rd_resp_data_count++;
       last_rd_sinked_cycle = (sc_time_stamp() / clk_period);
       
-      (*sb_rd_resp_q)[MASTER_ID].erase((*sb_rd_resp_q)[MASTER_ID].begin()+j);
+      sb_rd_resp_q->erase(key, j);
       found = true;
       break;
     }
-    j++;
+    j = sb_rd_resp_q->next(j);
   }
   
   if(!found){
     std::cout<< "\n\n";
     std::cout<< "[Master " << MASTER_ID <<"] " << "RD-Resp  : "<< rcv_rd_resp << " . NOT FOUND! @" << sc_time_stamp() << "\n";
-    std::cout<< "[Master " << MASTER_ID <<"] " << "-SB_front - "<< (*sb_rd_resp_q)[MASTER_ID].front() << "\n";
+    if (sb_rd_resp_q->first(key) != SB_NIL) std::cout<< "[Master " << MASTER_ID <<"] " << "-SB_front - "<< sb_rd_resp_q->at(sb_rd_resp_q->first(key)) << "\n";
     error_sb_rd_resp_not_found++;
     sc_assert(0);
     // sc_stop();
   }else if(reorder==2) {
     std::cout<< "\n\n";
     std::cout<< "[Master " << MASTER_ID <<"] " << "RD-Resp  : "<< rcv_rd_resp << " . Respective Request wasn't found!!! @" << sc_time_stamp() << "\n";
-    std::cout<< "[Master " << MASTER_ID <<"] " << "-REQ_front - "<< sb_rd_order_q.front() << "\n";
     sc_assert(0);
   }else if(reorder==1) {
     std::cout<< "\n\n";
@@ -484,7 +717,8 @@ void axi_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAV
     std::cout<< "[Master " << MASTER_ID <<"] " << "REQ-Ordered - "<< sb_ord_req << "\n";
     sc_assert(0);
   }else{
-    std::cout<< "[Master " << MASTER_ID <<"] " << "RD-Resp OK   : <<  " << rcv_rd_resp << " @" << sc_time_stamp() << "\n";
+    EVT_TRACE((rcv_rd_resp.last ? EVT_LVL_TXN : EVT_LVL_BEAT), evt, EVT_R, rcv_rd_resp.id.to_uint(), 0, rcv_rd_resp.last.to_uint(),
+              std::cout<< "[Master " << MASTER_ID <<"] " << "RD-Resp OK   : <<  " << rcv_rd_resp << " @" << sc_time_stamp() << "\n");
     rd_resp_ej++;
   }
   std::cout.flush();
@@ -497,51 +731,76 @@ void axi_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAV
   sb_lock->lock();
   // --- Reorder Check --- //
   int reorder=2; // 2 : Req not found, 1 : Request reordered, 0 : everything is fine
-  unsigned j=0;
   axi4_::AddrPayload sb_ord_req;
-  while (j<sb_wr_order_q.size()){
-    sb_ord_req = sb_wr_order_q[j];
-    
-    if(sb_ord_req.id == rcv_wr_resp.id) {
-      // Slave must sneak its ID into the first data byte of every beat (aka data[0]).
-      unsigned dst = mem_map_resolve(sb_ord_req.addr);
-      reorder = (dst  == rcv_wr_resp.resp) ? 0 : 1;
-      sb_wr_order_q.erase(sb_wr_order_q.begin()+j);
-      break;
-    }
-    j++;
+  unsigned lat_dst = 0;
+  // The Master IF responds a split burst once, with the worst BRESP of its sub-bursts
+  std::vector<sub_burst> subs;
+  // The response must be of the oldest outstanding request of its ID
+  sb_key_t ord_key = sb_key(rcv_wr_resp.id.to_uint());
+  int      ord     = sb_wr_order_q.first(ord_key);
+  if (ord != SB_NIL) {
+    sb_ord_req = sb_wr_order_q.at(ord);
+    // Slave must sneak its ID into the first data byte of every beat (aka data[0]).
+    split_trans(sb_ord_req, subs);
+    unsigned dst = 0;
+    for (unsigned s=0; s<subs.size(); ++s) if (subs[s].dst>dst) dst = subs[s].dst;
+    lat_dst = dst;
+    reorder = (dst  == rcv_wr_resp.resp) ? 0 : 1;
+    sb_wr_order_q.erase(ord_key, ord);
+  }
+  if (subs.empty() || (reorder!=0)) {
+    subs.resize(1);
+    subs[0].dst = rcv_wr_resp.resp.to_uint();
   }
   // --------------------- //
   
-  // Verify Responce
-  bool found=false;
-  j=0;
-  while (j<(*sb_wr_resp_q)[MASTER_ID].size()){
-    msg_tb_wrap< axi4_::WRespPayload > sb_resp = (*sb_wr_resp_q)[MASTER_ID][j];
+  // Verify Responce, each Slave has responded its sub-burst
+  bool    found=true;
+  sc_time time_gen;
+  for (unsigned s=0; s<subs.size(); ++s) {
+    axi4_::WRespPayload sub_resp;
+    sub_resp.id   = rcv_wr_resp.id;
+    sub_resp.resp = subs[s].dst;
     
-    if ( eq_wr_resp(sb_resp.dut_msg, rcv_wr_resp) ){
+    bool     sub_found=false;
+    sb_key_t key = sb_key(MASTER_ID, subs[s].dst, rcv_wr_resp.id.to_uint() & ((1<<dnp::ID_W)-1));
+    int      j   = sb_wr_resp_q->first(key);
+    while (j != SB_NIL){
+      msg_tb_wrap< axi4_::WRespPayload > &sb_resp = sb_wr_resp_q->at(j);
       
-      wr_resp_delay += ((sc_time_stamp() - sb_resp.time_gen) / clk_period) - 1;
+      if ( eq_wr_resp(sb_resp.dut_msg, sub_resp) ){
+        time_gen = sb_resp.time_gen;
+        sb_wr_resp_q->erase(key, j);
+        sub_found = true;
+        break;
+      }
+      j = sb_wr_resp_q->next(j);
+    }
+    found = found && sub_found;
+  }
+  
+  if (found) {
+    if (!meas || meas->in(time_gen)) {
+      unsigned long long int this_delay = ((sc_time_stamp() - time_gen) / clk_period) - 1;
+      wr_resp_delay += this_delay;
+      wr_lat[lat_dst].add(this_delay);
       wr_resp_count++;
-      
-      (*sb_wr_resp_q)[MASTER_ID].erase((*sb_wr_resp_q)[MASTER_ID].begin()+j);
-      found = true;
-      break;
+      if (meas) meas->record(this_delay);
     }
-    j++;
+    if (trace_out || replay.active()) deps.completed(true, rcv_wr_resp.id.to_uint() & ((1<<dnp::ID_W)-1), cur_cycle());
   }
   
   if(!found){
+    sb_key_t key = sb_key(MASTER_ID, rcv_wr_resp.resp.to_uint(), rcv_wr_resp.id.to_uint() & ((1<<dnp::ID_W)-1));
     std::cout<< "\n\n";
     std::cout<< "[Master " << MASTER_ID <<"] " << "WR-Resp  : "<< rcv_wr_resp << " . NOT FOUND! @" << sc_time_stamp() << "\n";
-    std::cout<< "[Master " << MASTER_ID <<"] " << "-SB_front - "<< (*sb_wr_resp_q)[MASTER_ID].front() << "\n";
+    if (sb_wr_resp_q->first(key) != SB_NIL) std::cout<< "[Master " << MASTER_ID <<"] " << "-SB_front - "<< sb_wr_resp_q->at(sb_wr_resp_q->first(key)) << "\n";
     error_sb_wr_resp_not_found++;
     sc_assert(0);
     // sc_stop();
   }else if(reorder==2) {
     std::cout<< "\n\n";
     std::cout<< "[Master " << MASTER_ID <<"] " << "WR-Resp  : "<< rcv_wr_resp << " . Respective Request wasn't found!!! @" << sc_time_stamp() << "\n";
-    std::cout<< "[Master " << MASTER_ID <<"] " << "-REQ_front - "<< sb_wr_order_q.front() << "\n";
     sc_assert(0);
   }else if(reorder==1) {
     std::cout<< "\n\n";
@@ -549,7 +808,8 @@ void axi_master<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAV
     std::cout<< "[Master " << MASTER_ID <<"] " << "REQ-Ordered - "<< sb_ord_req << "\n";
     sc_assert(0);
   }else{
-    std::cout<< "[Master " << MASTER_ID <<"] " << "WR-Resp OK   : <<  " << rcv_wr_resp << "\n";
+    EVT_TRACE(EVT_LVL_TXN, evt, EVT_B, rcv_wr_resp.id.to_uint(), 0, rcv_wr_resp.resp.to_uint(),
+              std::cout<< "[Master " << MASTER_ID <<"] " << "WR-Resp OK   : <<  " << rcv_wr_resp << "\n");
     wr_resp_ej++;
   }
   std::cout.flush();
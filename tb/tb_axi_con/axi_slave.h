@@ -5,6 +5,8 @@
 
 #include "../../src/include/flit_axi.h"
 #include "../tb_wrap.h"
+#include "../tb_scoreboard.h"
+#include "../../src/include/evt_trace.h"
 
 #include <deque>
 #include <queue>
@@ -38,13 +40,13 @@ SC_MODULE(axi_slave) {
 	Connections::Out<axi4_::WRespPayload>  b_out;
   
   // Scoreboard
-  sc_mutex                                                       *sb_lock;
-  std::vector< std::deque< msg_tb_wrap<axi4_::AddrPayload> > >   *sb_rd_req_q;
-  std::vector< std::deque< msg_tb_wrap<axi4_::ReadPayload> > >   *sb_rd_resp_q; // This is Sized to Master LANES
+  sc_mutex                                             *sb_lock;
+  tb_scoreboard< msg_tb_wrap<axi4_::AddrPayload> >     *sb_rd_req_q;
+  tb_scoreboard< msg_tb_wrap<axi4_::ReadPayload> >     *sb_rd_resp_q; // This is Sized to Master LANES
   
-  std::vector< std::deque< msg_tb_wrap<axi4_::AddrPayload> > >   *sb_wr_req_q;
-  std::vector< std::deque< msg_tb_wrap<axi4_::WritePayload> > >  *sb_wr_data_q;
-  std::vector< std::deque< msg_tb_wrap<axi4_::WRespPayload> > >  *sb_wr_resp_q;
+  tb_scoreboard< msg_tb_wrap<axi4_::AddrPayload> >     *sb_wr_req_q;
+  tb_scoreboard< msg_tb_wrap<axi4_::WritePayload> >    *sb_wr_data_q;
+  tb_scoreboard< msg_tb_wrap<axi4_::WRespPayload> >    *sb_wr_resp_q;
   
 	int SLAVE_ID   = -1;
 	unsigned int STALL_RATE_RD;
@@ -62,6 +64,7 @@ SC_MODULE(axi_slave) {
   std::queue<axi4_::WRespPayload>  stored_wr_resp;
   
   std::deque<axi4_::AddrPayload>   wr_to_get_resp;
+  std::vector<axi4_::WritePayload> wr_burst;       // Beats of the burst in progress, verified with its last
   
   // Read Response Generator
   int rd_resp_val;
@@ -82,6 +85,8 @@ SC_MODULE(axi_slave) {
   int error_sb_wr_req_not_found;
   int error_sb_wr_data_not_found;
   
+  evt_ring evt; // Event trace (see evt_trace.h)
+  
   // Functions
 	void do_cycle();
 	void gen_rd_resp(axi4_::AddrPayload   &rcv_rd_req );
@@ -103,6 +108,7 @@ SC_MODULE(axi_slave) {
     SLAVE_ID      = -1;
     STALL_RATE_RD = 0;
     STALL_RATE_WR = 0;
+    evt.init(this->name());
     
 		SC_THREAD(do_cycle);
     sensitive << clk.pos();
@@ -188,7 +194,8 @@ void axi_slave<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAVE
       axi4_::ReadPayload temp_resp = stored_rd_resp.front();
       if (r_out.PushNB(temp_resp)) {
         stored_rd_resp.pop();
-        std::cout<<"[Slave "<< SLAVE_ID << "] : PUSHED RD-Resp " << temp_resp << " @" << sc_time_stamp() << std::endl;
+        EVT_TRACE((temp_resp.last ? EVT_LVL_TXN : EVT_LVL_BEAT), evt, EVT_S_R, temp_resp.id.to_uint(), 0, temp_resp.last.to_uint(),
+                  std::cout<<"[Slave "<< SLAVE_ID << "] : PUSHED RD-Resp " << temp_resp << " @" << sc_time_stamp() << "\n");
         rd_resp_inj++;
       }
     }
@@ -199,7 +206,8 @@ void axi_slave<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAVE
       axi4_::WRespPayload temp_resp = stored_wr_resp.front();
       if (b_out.PushNB(temp_resp)) {
         stored_wr_resp.pop();
-        std::cout<<"[Slave "<< SLAVE_ID << "] : PUSHED WR-Resp " << temp_resp << " @" << sc_time_stamp() << std::endl;
+        EVT_TRACE(EVT_LVL_TXN, evt, EVT_S_B, temp_resp.id.to_uint(), 0, temp_resp.resp.to_uint(),
+                  std::cout<<"[Slave "<< SLAVE_ID << "] : PUSHED WR-Resp " << temp_resp << " @" << sc_time_stamp() << "\n");
         wr_resp_inj++;
       }
     }
@@ -269,7 +277,7 @@ void axi_slave<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAVE
   temp_wr_resp_tb.dut_msg  = temp_wr_resp;
   temp_wr_resp_tb.time_gen = sc_time_stamp();
   
-  (*sb_wr_resp_q)[wr_initiator].push_back(temp_wr_resp_tb); // Send Beat to ScoreBoard.
+  sb_wr_resp_q->push(sb_key(wr_initiator, SLAVE_ID, temp_wr_resp.id.to_uint() & ((1<<dnp::ID_W)-1)), temp_wr_resp_tb); // Send Beat to ScoreBoard.
   wr_resp_generated++;
   sb_lock->unlock();
 }; // End of Read generator
@@ -284,28 +292,30 @@ template <unsigned int RD_M_LANES, unsigned int RD_S_LANES, unsigned int WR_M_LA
 bool axi_slave<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAVE_NUM>::verify_rd_req (axi4_::AddrPayload &rcv_rd_req) {
   bool verified = true;
   sb_lock->lock();
+  // Requests of all Masters with this ID share the flow, the search goes past the
+  // oldest when Masters interleave or requests of a Master got reordered.
   bool found=false;
-  unsigned int  j=0;
-  while (j<(*sb_rd_req_q)[SLAVE_ID].size()){
-    msg_tb_wrap< axi4_::AddrPayload > sb_req = (*sb_rd_req_q)[SLAVE_ID][j];
-    
-    if ( eq_rd_req(rcv_rd_req, sb_req.dut_msg) ){
-      (*sb_rd_req_q)[SLAVE_ID].erase((*sb_rd_req_q)[SLAVE_ID].begin()+j);
+  sb_key_t key = sb_key(SLAVE_ID, rcv_rd_req.id.to_uint() & ((1<<dnp::ID_W)-1));
+  int      j   = sb_rd_req_q->first(key);
+  while (j != SB_NIL){
+    if ( eq_rd_req(rcv_rd_req, sb_rd_req_q->at(j).dut_msg) ){
+      sb_rd_req_q->erase(key, j);
       found = true;
       break;
     }
-    j++;
+    j = sb_rd_req_q->next(j);
   }
   
   if(!found){
     std::cout << "ERR : [Slave " << SLAVE_ID <<"] " << "RD Request   : "<< rcv_rd_req << " . NOT FOUND! @" << sc_time_stamp() << "\n";
-    std::cout << "ERR : [Slave " << SLAVE_ID <<"] " << "-SB_front - "<< (*sb_rd_req_q)[SLAVE_ID].front() << "\n";
+    if (sb_rd_req_q->first(key) != SB_NIL) std::cout << "ERR : [Slave " << SLAVE_ID <<"] " << "-SB_front - "<< sb_rd_req_q->at(sb_rd_req_q->first(key)) << "\n";
     error_sb_rd_req_not_found++;
     sc_assert(0);
     // sc_stop();
     verified = false;
   } else {
-    std::cout<< "[Slave " << SLAVE_ID <<"] " << "RD Req OK  : <<  " << rcv_rd_req << " @" << sc_time_stamp() << "\n";
+    EVT_TRACE(EVT_LVL_TXN, evt, EVT_S_AR, rcv_rd_req.id.to_uint(), rcv_rd_req.addr.to_uint64(), rcv_rd_req.len.to_uint(),
+              std::cout<< "[Slave " << SLAVE_ID <<"] " << "RD Req OK  : <<  " << rcv_rd_req << " @" << sc_time_stamp() << "\n");
   }
   std::cout.flush();
   sb_lock->unlock();
@@ -317,28 +327,28 @@ bool axi_slave<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAVE
   bool verified = true;
   sb_lock->lock();
   bool found=false;
-  unsigned int  j=0;
-  while (j<(*sb_wr_req_q)[SLAVE_ID].size()){
-    axi4_::AddrPayload sb_value = ((*sb_wr_req_q)[SLAVE_ID][j]).dut_msg;
-    
-    if (eq_wr_req(rcv_wr_req, sb_value)){
-      (*sb_wr_req_q)[SLAVE_ID].erase((*sb_wr_req_q)[SLAVE_ID].begin()+j);
+  sb_key_t key = sb_key(SLAVE_ID, rcv_wr_req.id.to_uint() & ((1<<dnp::ID_W)-1));
+  int      j   = sb_wr_req_q->first(key);
+  while (j != SB_NIL){
+    if (eq_wr_req(rcv_wr_req, sb_wr_req_q->at(j).dut_msg)){
+      sb_wr_req_q->erase(key, j);
       found = true;
       break;
     }
-    j++;
+    j = sb_wr_req_q->next(j);
   }
   
   if(!found){
     std::cout << "\n";
     std::cout << "ERR : [Slave " << SLAVE_ID <<"] " << "WR Request   : "<< rcv_wr_req << " . NOT FOUND! @" << sc_time_stamp() << "\n";
-    std::cout << "ERR : [Slave " << SLAVE_ID <<"] " << "-SB_front - "<< (*sb_wr_req_q)[SLAVE_ID].front() << "\n";
+    if (sb_wr_req_q->first(key) != SB_NIL) std::cout << "ERR : [Slave " << SLAVE_ID <<"] " << "-SB_front - "<< sb_wr_req_q->at(sb_wr_req_q->first(key)) << "\n";
     error_sb_wr_req_not_found++;
     sc_assert(0);
     // sc_stop();
     verified = false;
   } else {
-    std::cout<< "[Slave " << SLAVE_ID <<"] " << "WR Req OK  : <<  " << rcv_wr_req << "\n";
+    EVT_TRACE(EVT_LVL_TXN, evt, EVT_S_AW, rcv_wr_req.id.to_uint(), rcv_wr_req.addr.to_uint64(), rcv_wr_req.len.to_uint(),
+              std::cout<< "[Slave " << SLAVE_ID <<"] " << "WR Req OK  : <<  " << rcv_wr_req << "\n");
   }
   std::cout.flush();
   sb_lock->unlock();
@@ -349,38 +359,38 @@ template <unsigned int RD_M_LANES, unsigned int RD_S_LANES, unsigned int WR_M_LA
 bool axi_slave<RD_M_LANES, RD_S_LANES, WR_M_LANES, WR_S_LANES, MASTER_NUM, SLAVE_NUM>::verify_wr_data (axi4_::WritePayload &rcv_wr_data, unsigned &wr_initiator) {
   bool verified = true;
   sb_lock->lock();
-  bool found=false;
-  unsigned int  j=0;
-  while (j<(*sb_wr_data_q)[SLAVE_ID].size()){
-    axi4_::WritePayload sb_value = ((*sb_wr_data_q)[SLAVE_ID][j]).dut_msg;
+  // W carries no ID, thus the flow of a burst is its initiator that the last byte signals.
+  // The beats are held until the last one and then matched in order.
+  wr_burst.push_back(rcv_wr_data);
+  if (rcv_wr_data.last.to_uint()) {
+    wr_initiator = sb_wr_initiator(rcv_wr_data, WR_S_LANES);
+    sb_key_t key = sb_key(SLAVE_ID, wr_initiator);
     
-    if (eq_wr_data(rcv_wr_data, sb_value)){
-      // The last byte of the last beat signals the initiator
-      if (rcv_wr_data.last.to_uint()) {
-        for (int i=WR_S_LANES-1; i>=0;--i) {
-          if ( (rcv_wr_data.wstrb.to_uint() >> i) & 1 ) {
-            wr_initiator = ((rcv_wr_data.data >> (i*8)) & 0xFF).to_uint();
-            break;
-          }
+    for (unsigned b=0; b<wr_burst.size(); ++b) {
+      bool found=false;
+      int  j = sb_wr_data_q->first(key);
+      while (j != SB_NIL){
+        if (eq_wr_data(wr_burst[b], sb_wr_data_q->at(j).dut_msg)){
+          sb_wr_data_q->erase(key, j);
+          found = true;
+          break;
         }
+        j = sb_wr_data_q->next(j);
       }
       
-      (*sb_wr_data_q)[SLAVE_ID].erase((*sb_wr_data_q)[SLAVE_ID].begin()+j);
-      found = true;
-      break;
+      if(!found){
+        std::cout << "ERR : [Slave " << SLAVE_ID <<"] " << "WR Data   : "<< wr_burst[b] << " . NOT FOUND! @" << sc_time_stamp() << "\n";
+        if (sb_wr_data_q->first(key) != SB_NIL) std::cout << "ERR : [Slave " << SLAVE_ID <<"] " << "-SB_front - "<< sb_wr_data_q->at(sb_wr_data_q->first(key)) << "\n";
+        error_sb_wr_data_not_found++;
+        sc_assert(0);
+        // sc_stop();
+        verified = false;
+      } else {
+        EVT_TRACE(EVT_LVL_BEAT, evt, EVT_S_W, 0, 0, wr_burst[b].last.to_uint(),
+                  std::cout<< "[Slave " << SLAVE_ID <<"] " << "WR Data OK  : <<  " << wr_burst[b] << "\n");
+      }
     }
-    j++;
-  }
-  
-  if(!found){
-    std::cout << "ERR : [Slave " << SLAVE_ID <<"] " << "WR Data   : "<< rcv_wr_data << " . NOT FOUND! @" << sc_time_stamp() << "\n";
-    std::cout << "ERR : [Slave " << SLAVE_ID <<"] " << "-SB_front - "<< (*sb_wr_data_q)[SLAVE_ID].front() << "\n";
-    error_sb_wr_data_not_found++;
-    sc_assert(0);
-    // sc_stop();
-    verified = false;
-  } else {
-    std::cout<< "[Slave " << SLAVE_ID <<"] " << "WR Data OK  : <<  " << rcv_wr_data << "\n";
+    wr_burst.clear();
   }
   std::cout.flush();
   sb_lock->unlock();
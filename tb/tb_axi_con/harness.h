@@ -16,23 +16,46 @@
 #include <iostream>
 #include <fstream>
 
+#include "../../tb/sim_speed.h"
+#include "../../tb/meas_window.h"
+#include "../../src/include/rtr_watchdog.h"
+#include "../../src/include/flit_ts.h"
+
 SC_MODULE(harness) {
+  // Traffic knobs. Each can be overridden at run-time from the environment (see tb_param)
   const int CLK_PERIOD = 5;
-  const int GEN_CYCLES = 2 * 1000;
+  const int GEN_CYCLES = tb_param("TB_GEN_CYCLES", 2 * 1000);
   
-  const int GEN_RATE_RD[smpl_cfg::MASTER_NUM] = {40, 40};
-  const int GEN_RATE_WR[smpl_cfg::MASTER_NUM] = {40, 40};
+  const int GEN_RATE_RD = tb_param("TB_GEN_RATE_RD", 40); // Same for all the Masters
+  const int GEN_RATE_WR = tb_param("TB_GEN_RATE_WR", 40);
   
-  const int STALL_RATE_RD = 00;
-  const int STALL_RATE_WR = 00;
+  const int STALL_RATE_RD = tb_param("TB_STALL_RATE_RD", 00);
+  const int STALL_RATE_WR = tb_param("TB_STALL_RATE_WR", 00);
   
   const int DRAIN_CYCLES = GEN_CYCLES/10;
   
+  // Deadlock watchdog of the routers (src/include/rtr_watchdog.h). 0 disables it, otherwise the simulation fails
+  // once a router buffer has not moved for TB_WDOG_CYCLES, thus a deadlocked or starved network stops at once
+  const int WDOG_CYCLES = tb_param("TB_WDOG_CYCLES", 0);
+  
+  // Trace capture (TB_TRACE_REC=<file>) of the master channels, or replay (TB_TRACE_REPLAY=<file>)
+  // in place of the random generators. TB_TRACE_MODE=timed|closed selects the replay timing.
+  trace_writer trace_out;
+  trace_reader trace_in;
+  
+  sim_speed   speed; // Wall time and memory of the run
+  meas_window meas;  // Steady-state window, in place of GEN_CYCLES when TB_MEAS_WINDOW=1
+  
   typedef typename axi::axi4<axi::cfg::standard_duth> axi4_;
   typedef typename axi::AXI4_Encoding            enc_;
    
   sc_clock        clk;
   sc_signal<bool> rst_n;
+#ifdef IC_CDC
+  // The NoC clock of an interconnect with clock domain crossings, its period set in ps (TB_NOC_CLK_PS).
+  // The default is faster than clk and not a multiple of it, thus the edges of the domains drift apart
+  sc_clock        clk_noc;
+#endif
   
   sc_signal<bool> stop_gen;
   
@@ -41,18 +64,24 @@ SC_MODULE(harness) {
   // --- Scoreboards --- //
   // Scoreboards refer to the receiver of the queue.
   // I.e. the receiver checks what is expected to be received. Thus sender must take care to push Transactions to the appropriate queue
-  sc_mutex                                                       sb_lock;
-  std::vector< std::deque< msg_tb_wrap<axi4_::AddrPayload> > >   sb_rd_req_q;
-  std::vector< std::deque< msg_tb_wrap<axi4_::ReadPayload> > >   sb_rd_resp_q;
+  // Each one holds a FIFO per flow (see tb_scoreboard.h) :
+  //   RD/WR Req : (Slave, TID), WR Data : (Slave, Initiator), RD/WR Resp : (Master, Slave, TID)
+  sc_mutex                                             sb_lock;
+  tb_scoreboard< msg_tb_wrap<axi4_::AddrPayload> >     sb_rd_req_q;
+  tb_scoreboard< msg_tb_wrap<axi4_::ReadPayload> >     sb_rd_resp_q;
   
-  std::vector< std::deque< msg_tb_wrap<axi4_::AddrPayload> > >   sb_wr_req_q;
-  std::vector< std::deque< msg_tb_wrap<axi4_::WritePayload> > >  sb_wr_data_q;
-  std::vector< std::deque< msg_tb_wrap<axi4_::WRespPayload> > >  sb_wr_resp_q;
+  tb_scoreboard< msg_tb_wrap<axi4_::AddrPayload> >     sb_wr_req_q;
+  tb_scoreboard< msg_tb_wrap<axi4_::WritePayload> >    sb_wr_data_q;
+  tb_scoreboard< msg_tb_wrap<axi4_::WRespPayload> >    sb_wr_resp_q;
   
   axi_master<smpl_cfg::RD_LANES, smpl_cfg::RD_LANES, smpl_cfg::WR_LANES, smpl_cfg::WR_LANES, smpl_cfg::MASTER_NUM, smpl_cfg::SLAVE_NUM> *master[smpl_cfg::MASTER_NUM];
   axi_slave<smpl_cfg::RD_LANES, smpl_cfg::RD_LANES, smpl_cfg::WR_LANES, smpl_cfg::WR_LANES, smpl_cfg::MASTER_NUM, smpl_cfg::SLAVE_NUM>  *slave[smpl_cfg::SLAVE_NUM];
   
+#ifdef IC_TLM
+  ic_tlm_top         interconnect; // Loosely-Timed model of the interconnect
+#else
   CCS_DESIGN(ic_top) interconnect;
+#endif
 
   // Master Side Channels
   Connections::Combinational<axi4_::AddrPayload>   *master_rd_req[smpl_cfg::MASTER_NUM];
@@ -73,14 +102,12 @@ SC_MODULE(harness) {
   SC_CTOR(harness) :
     clk("clock",10,SC_NS,0.5,0.0,SC_NS),
     rst_n("rst_n"),
+#ifdef IC_CDC
+    clk_noc("clock_noc",tb_param("TB_NOC_CLK_PS", 7000),SC_PS,0.5,0.0,SC_PS),
+#endif
     stop_gen("stop_gen"),
     
     sb_lock(),
-    sb_rd_req_q(smpl_cfg::SLAVE_NUM),
-    sb_rd_resp_q(smpl_cfg::MASTER_NUM),
-    sb_wr_req_q(smpl_cfg::SLAVE_NUM),
-    sb_wr_data_q(smpl_cfg::SLAVE_NUM),
-    sb_wr_resp_q(smpl_cfg::MASTER_NUM),
     
     interconnect("interconnect")
   {
@@ -89,11 +116,24 @@ SC_MODULE(harness) {
     addr_map[0][1] = 0x0ffff;
     addr_map[1][0] = 0x10000;
     addr_map[1][1] = 0x2ffff;
+    // Any further Slave gets the next 64KB
+    for (int j=2; j<smpl_cfg::SLAVE_NUM; ++j) {
+      addr_map[j][0] = 0x30000 + (j-2)*0x10000;
+      addr_map[j][1] = 0x30000 + (j-2)*0x10000 + 0x0ffff;
+    }
+    
+    const char *trace_replay_f = tb_param_str("TB_TRACE_REPLAY", "");
+    const char *trace_rec_f    = tb_param_str("TB_TRACE_REC", "");
+    if (*trace_replay_f) {
+      NVHLS_ASSERT_MSG(trace_in.open(trace_replay_f), "Cannot open the replay trace!");
+      std::cout << "--- Replaying " << trace_in.num << " trace records from " << trace_replay_f << " ---\n";
+    } else if (*trace_rec_f) {
+      NVHLS_ASSERT_MSG(trace_out.open(trace_rec_f), "Cannot create the trace file!");
+    }
     
     // Construct Components
     for (int i=0; i<smpl_cfg::MASTER_NUM; ++i) {
       master[i] = new axi_master<smpl_cfg::RD_LANES, smpl_cfg::RD_LANES, smpl_cfg::WR_LANES, smpl_cfg::WR_LANES, smpl_cfg::MASTER_NUM, smpl_cfg::SLAVE_NUM>(sc_gen_unique_name("master"));
-      slave[i]  = new axi_slave <smpl_cfg::RD_LANES, smpl_cfg::RD_LANES, smpl_cfg::WR_LANES, smpl_cfg::WR_LANES, smpl_cfg::MASTER_NUM, smpl_cfg::SLAVE_NUM>(sc_gen_unique_name("slave"));
     
       master_rd_req[i]  = new Connections::Combinational<axi4_::AddrPayload>  (sc_gen_unique_name("master_rd_req"));
       master_rd_resp[i] = new Connections::Combinational<axi4_::ReadPayload>  (sc_gen_unique_name("master_rd_resp"));
@@ -101,8 +141,11 @@ SC_MODULE(harness) {
       master_wr_req[i]  = new Connections::Combinational<axi4_::AddrPayload>   (sc_gen_unique_name("master_wr_req"));
       master_wr_data[i] = new Connections::Combinational<axi4_::WritePayload>  (sc_gen_unique_name("master_wr_data"));
       master_wr_resp[i] = new Connections::Combinational<axi4_::WRespPayload>  (sc_gen_unique_name("master_wr_resp"));
-                                      
-                                      
+    }
+    
+    for (int i=0; i<smpl_cfg::SLAVE_NUM; ++i) {
+      slave[i] = new axi_slave <smpl_cfg::RD_LANES, smpl_cfg::RD_LANES, smpl_cfg::WR_LANES, smpl_cfg::WR_LANES, smpl_cfg::MASTER_NUM, smpl_cfg::SLAVE_NUM>(sc_gen_unique_name("slave"));
+      
       // Slave Side Channels
       slave_rd_req[i]  = new Connections::Combinational<axi4_::AddrPayload>  (sc_gen_unique_name("slave_rd_req"));
       slave_rd_resp[i] = new Connections::Combinational<axi4_::ReadPayload>  (sc_gen_unique_name("slave_rd_resp"));
@@ -127,8 +170,23 @@ SC_MODULE(harness) {
       master[i]->sb_wr_resp_q = &sb_wr_resp_q; // Scoreboard by Ref
       
       master[i]->MASTER_ID    = i;
-      master[i]->GEN_RATE_RD  = GEN_RATE_RD[i];
-      master[i]->GEN_RATE_WR  = GEN_RATE_WR[i];
+      master[i]->GEN_RATE_RD  = GEN_RATE_RD;
+      master[i]->GEN_RATE_WR  = GEN_RATE_WR;
+      master[i]->TRAFFIC      = traffic_cfg::from_env();
+      master[i]->trace_out    = trace_out.is_open() ? &trace_out : NULL;
+      master[i]->meas         = meas.enabled ? &meas : NULL;
+#ifdef IC_STRIPE_CH
+      master[i]->STRIPE_CH    = IC_STRIPE_CH;  // The sub-bursts of the Master IF are expected at the Slaves
+      master[i]->LOG_STRIPE   = IC_LOG_STRIPE;
+#endif
+#ifdef IC_MAX_BEATS
+      master[i]->MAX_BEATS    = IC_MAX_BEATS;  // As are its packets of at most MAX_BEATS
+#endif
+      if (trace_in.is_open()) {
+        master[i]->replay.src    = &trace_in;
+        master[i]->replay.master = i;
+        master[i]->replay.mode   = trace_replay::mode_from_env();
+      }
       master[i]->stop_gen(stop_gen);
       
       master[i]->clk(clk);
@@ -144,8 +202,10 @@ SC_MODULE(harness) {
       master[i]->aw_out(*master_wr_req[i]);
       master[i]->w_out(*master_wr_data[i]);
       master[i]->b_in(*master_wr_resp[i]);
-      
-      // SLAVE
+    }
+    
+    // SLAVE
+    for (int i=0; i<smpl_cfg::SLAVE_NUM; ++i) {
       slave[i]->sb_lock      = &sb_lock;      // Scoreboard by Ref
       slave[i]->sb_rd_req_q  = &sb_rd_req_q;  // Scoreboard by Ref
       slave[i]->sb_rd_resp_q = &sb_rd_resp_q; // Scoreboard by Ref
@@ -176,6 +236,9 @@ SC_MODULE(harness) {
     // IC-TOP
     interconnect.clk(clk);
     interconnect.rst_n(rst_n);
+#ifdef IC_CDC
+    interconnect.clk_noc(clk_noc);
+#endif
     for(int j=0; j<smpl_cfg::SLAVE_NUM; ++j) {
       interconnect.addr_map[j][0](addr_map[j][0]);
       interconnect.addr_map[j][1](addr_map[j][1]);
@@ -190,7 +253,7 @@ SC_MODULE(harness) {
       interconnect.b_out[i](*master_wr_resp[i]);
     }
     // Slave Side
-    for (int i=0; i<smpl_cfg::MASTER_NUM; ++i) {
+    for (int i=0; i<smpl_cfg::SLAVE_NUM; ++i) {
       interconnect.ar_out[i](*slave_rd_req[i]);
       interconnect.r_in[i](*slave_rd_resp[i]);
   
@@ -203,13 +266,31 @@ SC_MODULE(harness) {
     std::cout.flush();
     
     Connections::set_sim_clk(&clk);
+    meas.clk_period = clk.period();
     
     SC_THREAD(harness_job);
     sensitive << clk.posedge_event();
+    
+    SC_THREAD(watchdog_job);
   } // End of Constructor
   
+  // Checks the routers every TB_WDOG_CYCLES, it dumps the stuck buffers and their wait-for graph
+  void watchdog_job() {
+    if (WDOG_CYCLES<=0) return;
+    while(1) {
+      wait(clk.period()*WDOG_CYCLES);
+      if (rtr_watchdog::check(std::cout, WDOG_CYCLES)) {
+        std::cout << "\n!!! --- FAILED --- !!! Watchdog stopped the simulation @" << sc_time_stamp() << "\n";
+        std::cout.flush();
+        sc_stop();
+        return;
+      }
+    }
+  };
+  
   void harness_job() {
     std::cout << "--- Simulation is Starting @" << sc_time_stamp() << " ---\n";
+    speed.start();
 
     std::cout.flush();
     rst_n.write(false);
@@ -220,7 +301,16 @@ SC_MODULE(harness) {
     wait(CLK_PERIOD*2, SC_NS);
     
     stop_gen.write(false);
-    wait(CLK_PERIOD*GEN_CYCLES, SC_NS);
+    if (meas.enabled) meas.run(sb_rd_resp_q, sb_wr_resp_q);
+    else              wait(CLK_PERIOD*GEN_CYCLES, SC_NS);
+    
+    // A replayed trace lasts until every master reaches its end
+    bool replay_done = false;
+    while (trace_in.is_open() && !replay_done) {
+      replay_done = true;
+      for (int i=0; i<smpl_cfg::MASTER_NUM; ++i) replay_done = replay_done && master[i]->replay_done();
+      if (!replay_done) wait(CLK_PERIOD*DRAIN_CYCLES, SC_NS);
+    }
     
     stop_gen.write(true);
     std::cout << "--- Transaction Generation Stopped @" << sc_time_stamp() << " ---\n";
@@ -229,19 +319,12 @@ SC_MODULE(harness) {
     // Drain
     bool all_drained = false;
     do {
-      int rd_req_remain  = 0;
-      int rd_resp_remain = 0;
+      int rd_req_remain  = sb_rd_req_q.size();
+      int rd_resp_remain = sb_rd_resp_q.size();
       
-      for(int i=0; i<smpl_cfg::SLAVE_NUM;  ++i) rd_req_remain  += sb_rd_req_q[i].size();
-      for(int i=0; i<smpl_cfg::MASTER_NUM; ++i) rd_resp_remain += sb_rd_resp_q[i].size();
-      
-      int wr_req_remain  = 0;
-      int wr_data_remain = 0;
-      int wr_resp_remain = 0;
-      
-      for(int i=0; i<smpl_cfg::SLAVE_NUM;++i)  wr_req_remain  += sb_wr_req_q[i].size();
-      for(int i=0; i<smpl_cfg::SLAVE_NUM;++i)  wr_data_remain += sb_wr_data_q[i].size();
-      for(int i=0; i<smpl_cfg::MASTER_NUM;++i) wr_resp_remain += sb_wr_resp_q[i].size();
+      int wr_req_remain  = sb_wr_req_q.size();
+      int wr_data_remain = sb_wr_data_q.size();
+      int wr_resp_remain = sb_wr_resp_q.size();
       
       all_drained = (!rd_req_remain) && (!rd_resp_remain) && 
                     (!wr_req_remain) && (!wr_data_remain) && (!wr_resp_remain);
@@ -291,30 +374,40 @@ SC_MODULE(harness) {
       rd_resp_generated += master[i]->rd_data_generated;
       
       rd_req_injected += master[i]->rd_trans_inj;
-      rd_req_ejected  += slave[i]->rd_req_ej;
       
       rd_resp_injected += master[i]->rd_data_generated;
       rd_resp_ejected  += master[i]->rd_resp_ej;
       
-      err_sb_rd_req_not_found  += slave[i]->error_sb_rd_req_not_found;
       err_sb_rd_resp_not_found += master[i]->error_sb_rd_resp_not_found;
       
       // WRITES
       wr_req_generated  += master[i]->wr_trans_generated;
       wr_data_generated += master[i]->wr_data_generated;
-      wr_resp_generated += slave[i]->wr_resp_generated;
       
       wr_req_injected  += master[i]->wr_trans_inj;
       wr_data_injected += master[i]->wr_data_inj;
+      
+      wr_resp_ejected  += master[i]->wr_resp_ej;
+      
+      err_sb_wr_resp_not_found += master[i]->error_sb_wr_resp_not_found;
+    }
+    
+    for (int i=0; i<smpl_cfg::SLAVE_NUM; ++i){
+      // READS
+      rd_req_ejected  += slave[i]->rd_req_ej;
+      
+      err_sb_rd_req_not_found  += slave[i]->error_sb_rd_req_not_found;
+      
+      // WRITES
+      wr_resp_generated += slave[i]->wr_resp_generated;
+      
       wr_req_ejected   += slave[i]->wr_req_ej;
       wr_data_ejected  += slave[i]->wr_data_ej;
       
       wr_resp_injected += slave[i]->wr_resp_inj;
-      wr_resp_ejected  += master[i]->wr_resp_ej;
       
       err_sb_wr_req_not_found  += slave[i]->error_sb_wr_req_not_found;
       err_sb_wr_data_not_found += slave[i]->error_sb_wr_data_not_found;
-      err_sb_wr_resp_not_found += master[i]->error_sb_wr_resp_not_found;
     }
     
     bool error = (rd_req_injected - rd_req_ejected) || (rd_resp_injected - rd_resp_ejected) || err_sb_rd_req_not_found || err_sb_rd_resp_not_found;
@@ -367,7 +460,7 @@ SC_MODULE(harness) {
     unsigned long long int rd_delay_full_sum_p_m[smpl_cfg::MASTER_NUM];
     unsigned long long int wr_trans_sum_p_m[smpl_cfg::MASTER_NUM];
     unsigned long long int rd_trans_sum_p_m[smpl_cfg::MASTER_NUM];
-    for(int i=0; i<smpl_cfg::SLAVE_NUM; ++i) {
+    for(int i=0; i<smpl_cfg::MASTER_NUM; ++i) {
       wr_delay_full_sum_p_m[i] = 0; rd_delay_full_sum_p_m[i] = 0;
       wr_trans_sum_p_m[i]      = 0; rd_trans_sum_p_m[i]      = 0;
     }
@@ -393,6 +486,7 @@ SC_MODULE(harness) {
     
     sc_time this_clk_period = clk.period();
     unsigned long long int total_cycles = sc_time_stamp() / this_clk_period;
+    unsigned long long int thr_cycles   = meas.enabled ? meas.cycles() : total_cycles; // Of the throughput
     
     std::cout << "Delay Per Master Slave(delay, Throughput) :\n";
     for (int i=0; i<smpl_cfg::MASTER_NUM; i++) {
@@ -402,20 +496,66 @@ SC_MODULE(harness) {
                                        << "\n   WR: "
                                        << (wr_trans_sum_p_m[i] ? ((float)wr_delay_full_sum_p_m[i] / (float)wr_trans_sum_p_m[i]) : 0)
                                        << ", "
-                                       << (wr_trans_sum_p_m[i] ? ((float)master[i]->wr_resp_data_count / (float)total_cycles) : 0)
+                                       << (wr_trans_sum_p_m[i] ? ((float)master[i]->wr_resp_data_count / (float)thr_cycles) : 0)
                                        << "\n";
     }
     
     float rd_delay_full_total     = ((float)rd_delay_full_sum_glob / (float)rd_trans_sum_glob);
     float wr_delay_full_total     = ((float)wr_delay_full_sum_glob / (float)wr_trans_sum_glob);
     
-    float rd_throughput_total     = ((float)rd_data_count_glob      / (float)total_cycles) / (float)smpl_cfg::MASTER_NUM;
-    float wr_throughput_total     = ((float)wr_data_count_glob      / (float)total_cycles) / (float)smpl_cfg::MASTER_NUM;
+    float rd_throughput_total     = ((float)rd_data_count_glob      / (float)thr_cycles) / (float)smpl_cfg::MASTER_NUM;
+    float wr_throughput_total     = ((float)wr_data_count_glob      / (float)thr_cycles) / (float)smpl_cfg::MASTER_NUM;
     
     std::cout << "                               (RD, WR) \n";
     std::cout << "Full     Avg delay(cycles)      : " << rd_delay_full_total << ", "<< wr_delay_full_total << "\n";
     std::cout << "Throughput   (flits/cycle/node) : " << rd_throughput_total << ", "<< wr_throughput_total << "\n";
     
+    // Simulation speed, for examples/sim_bench.py
+    speed.report(std::cout, total_cycles, rd_trans_sum_glob + wr_trans_sum_glob);
+    if (meas.enabled) meas.report(std::cout);
+    
+    // Latency per stage of the flit timestamps (FLIT_TS builds). The rest is not known in a measurement window
+#if FLIT_TS_ON
+    double delay_total[2] = {meas.enabled ? -1.0 : rd_delay_full_total, meas.enabled ? -1.0 : wr_delay_full_total};
+    flit_ts_stats::get().report(std::cout, this_clk_period, delay_total);
+#endif
+    
+    // Latency distribution, in total and per Master->Slave flow
+    lat_hist rd_lat_glob, wr_lat_glob;
+    lat_report lat_rep;
+    for (int i=0; i<smpl_cfg::MASTER_NUM; ++i) {
+      for (int j=0; j<smpl_cfg::SLAVE_NUM; ++j) {
+        rd_lat_glob.merge(master[i]->rd_lat[j]);
+        wr_lat_glob.merge(master[i]->wr_lat[j]);
+      }
+    }
+    lat_rep.add("ALL", "RD", rd_lat_glob);
+    lat_rep.add("ALL", "WR", wr_lat_glob);
+    for (int i=0; i<smpl_cfg::MASTER_NUM; ++i) {
+      for (int j=0; j<smpl_cfg::SLAVE_NUM; ++j) {
+        std::string flow = "M" + std::to_string(i) + "->S" + std::to_string(j);
+        lat_rep.add(flow, "RD", master[i]->rd_lat[j]);
+        lat_rep.add(flow, "WR", master[i]->wr_lat[j]);
+      }
+    }
+    std::cout << "\n";
+    lat_rep.print(std::cout);
+    
+    // Machine readable dump. JSON when the name ends with .json, CSV otherwise
+    const char *lat_dump = tb_param_str("TB_LAT_DUMP", "");
+    if (*lat_dump) {
+      if (lat_rep.dump(lat_dump)) std::cout << "Latency dumped to " << lat_dump << "\n";
+      else                        std::cout << "Latency dump to " << lat_dump << " FAILED\n";
+    }
+    
+    if (trace_out.is_open()) {
+      std::cout << "Trace of " << trace_out.records << " records captured\n";
+      trace_out.close();
+    }
+    
+    // Binary event trace, decoded by examples/evt_decode.py. Only when built with EVT_TRACE_LEVEL>0
+    evt_trace_dump(tb_param_str("TB_EVT_TRACE", "evt_trace.bin"));
+    
     std::cout << "\n";
     std::cout << __VERSION__ << "\n";
     std::cout.flush();
@@ -0,0 +1,108 @@
+#ifndef __TB_SCOREBOARD_H__
+#define __TB_SCOREBOARD_H__
+
+#include <vector>
+#include <unordered_map>
+
+// Scoreboard of the expected transactions, as per flow FIFOs behind a hash index.
+//   A flow is the key of the transactions that must remain ordered, ie (master, slave, TID)
+//   for the responses and (slave, TID) for the requests, as a slave does not see the initiator.
+//   Lookups start from the oldest entry of a single FIFO, thus match on the first try unless
+//   the DUT reorders within the flow. Entries live in a pool and are recycled through a free
+//   list, memory is bounded by the peak number of outstanding transactions.
+typedef unsigned long long int sb_key_t;
+
+static const int SB_NIL = -1;
+
+// Fields wider than 16/16/32 bits are folded, flows that collide share a FIFO and are told apart by the match
+inline sb_key_t sb_key(unsigned long long int a, unsigned long long int b=0, unsigned long long int c=0) {
+  return ((a & 0xFFFF) << 48) | ((b & 0xFFFF) << 32) | ((c ^ (c >> 32)) & 0xFFFFFFFF);
+}
+
+template <class T>
+class tb_scoreboard {
+public:
+  struct fifo {
+    int      head, tail;
+    unsigned size;
+    fifo() : head(SB_NIL), tail(SB_NIL), size(0) {};
+  };
+
+  struct node {
+    T   val;
+    int prev, next;
+  };
+
+  typedef typename std::unordered_map<sb_key_t, fifo>::const_iterator fifo_iter;
+
+  std::unordered_map<sb_key_t, fifo> index;
+  std::vector<node>                  pool;
+  int                                free_head;
+  unsigned long long int             total;
+
+  tb_scoreboard() : free_head(SB_NIL), total(0) {};
+
+  void push(sb_key_t key, const T &val) {
+    int e;
+    if (free_head != SB_NIL) {
+      e         = free_head;
+      free_head = pool[e].next;
+    } else {
+      e = pool.size();
+      pool.push_back(node());
+    }
+    fifo &q      = index[key];
+    pool[e].val  = val;
+    pool[e].prev = q.tail;
+    pool[e].next = SB_NIL;
+    if (q.tail != SB_NIL) pool[q.tail].next = e;
+    else                  q.head            = e;
+    q.tail = e;
+    q.size++;
+    total++;
+  };
+
+  // Oldest entry of the flow, then the next ones. SB_NIL at the end
+  int first(sb_key_t key) const {
+    fifo_iter it = index.find(key);
+    return (it == index.end()) ? SB_NIL : it->second.head;
+  };
+  int next(int e) const { return pool[e].next; };
+
+  T &       at(int e)       { return pool[e].val; };
+  const T & at(int e) const { return pool[e].val; };
+
+  void erase(sb_key_t key, int e) {
+    fifo &q = index[key];
+    if (pool[e].prev != SB_NIL) pool[pool[e].prev].next = pool[e].next;
+    else                        q.head                  = pool[e].next;
+    if (pool[e].next != SB_NIL) pool[pool[e].next].prev = pool[e].prev;
+    else                        q.tail                  = pool[e].prev;
+    q.size--;
+    total--;
+    pool[e].val  = T();
+    pool[e].next = free_head;
+    free_head    = e;
+  };
+
+  void pop(sb_key_t key) { erase(key, first(key)); };
+
+  unsigned size(sb_key_t key) const {
+    fifo_iter it = index.find(key);
+    return (it == index.end()) ? 0 : it->second.size;
+  };
+
+  unsigned long long int size() const { return total; };
+  bool                   empty() const { return total == 0; };
+};
+
+// The initiator of a write, signaled by the masters in the highest strobed byte of its last beat
+template <class W>
+inline unsigned sb_wr_initiator(const W &last_beat, unsigned lanes) {
+  for (int i=lanes-1; i>=0; --i) {
+    if ((last_beat.wstrb >> i) & 1) return ((last_beat.data >> (i*8)) & 0xFF).to_uint();
+  }
+  return -1;
+}
+
+#endif // __TB_SCOREBOARD_H__
@@ -0,0 +1,136 @@
+#ifndef __TRAFFIC_GEN_H__
+#define __TRAFFIC_GEN_H__
+
+#include <cstdlib>
+#include <cstring>
+#include "helper_non_synth.h"
+
+// Synthetic traffic patterns of the testbench masters.
+//   A pattern maps the index of the generating master to a destination slave. The permutations
+//   (transpose, bit-complement) operate on the bits of the endpoint index, ie b = log2(max(masters, slaves))
+//   bits, and wrap to the present slaves.
+//     - UNIFORM    : uniformly random slave
+//     - HOTSPOT    : hot_dst with a probability of hot_pct%, uniform otherwise
+//     - TRANSPOSE  : index bits rotated by b/2. d_i = s_((i+b/2) mod b)
+//     - BITCOMP    : complemented index bits
+//     - NEIGHBOR   : the next slave, (m+1) mod slaves
+//   The injection process decides when a master generates a transaction.
+//     - BERNOULLI  : each cycle with a probability of rate%
+//     - ONOFF      : Markov modulated ON/OFF. The master alternates between ON and OFF periods,
+//                    of on_len and off_len cycles on average, and injects only while ON. The rate
+//                    during ON is scaled up to keep the average at rate%, thus traffic is bursty.
+//   The burst length distribution of the generated transactions.
+//     - RAND       : any burst type (FIXED, INCR, WRAP) and random length (default)
+//     - FIXED      : INCR bursts of len_a beats
+//     - UNIFORM    : INCR bursts of [len_a, len_b] beats
+//     - BIMODAL    : INCR bursts of len_a beats with a probability of bimodal_pct%, len_b otherwise
+//   Lengths are capped to what the master supports.
+struct traffic_cfg {
+  enum pattern_t {UNIFORM, HOTSPOT, TRANSPOSE, BITCOMP, NEIGHBOR};
+  enum inject_t  {BERNOULLI, ONOFF};
+  enum burst_t   {BURST_RAND, BURST_FIXED, BURST_UNIFORM, BURST_BIMODAL};
+
+  pattern_t pattern     = UNIFORM;
+  unsigned  hot_dst     = 0;
+  unsigned  hot_pct     = 50;
+
+  inject_t  inject      = BERNOULLI;
+  unsigned  on_len      = 20;
+  unsigned  off_len     = 20;
+
+  burst_t   burst       = BURST_RAND;
+  unsigned  len_a       = 1;
+  unsigned  len_b       = 4;
+  unsigned  bimodal_pct = 80;
+
+  // Select from the environment. ie TB_PATTERN=hotspot TB_HOT_PCT=30 TB_INJECT=onoff TB_BURST=bimodal ./sim_sc
+  static traffic_cfg from_env() {
+    traffic_cfg cfg;
+    const char *pat = tb_param_str("TB_PATTERN", "uniform");
+    if      (!strcmp(pat, "hotspot"))   cfg.pattern = HOTSPOT;
+    else if (!strcmp(pat, "transpose")) cfg.pattern = TRANSPOSE;
+    else if (!strcmp(pat, "bitcomp"))   cfg.pattern = BITCOMP;
+    else if (!strcmp(pat, "neighbor"))  cfg.pattern = NEIGHBOR;
+    else                                cfg.pattern = UNIFORM;
+    cfg.hot_dst = tb_param("TB_HOT_DST", cfg.hot_dst);
+    cfg.hot_pct = tb_param("TB_HOT_PCT", cfg.hot_pct);
+
+    const char *inj = tb_param_str("TB_INJECT", "bernoulli");
+    cfg.inject  = (!strcmp(inj, "onoff")) ? ONOFF : BERNOULLI;
+    cfg.on_len  = tb_param("TB_ON_LEN",  cfg.on_len);
+    cfg.off_len = tb_param("TB_OFF_LEN", cfg.off_len);
+
+    const char *bu = tb_param_str("TB_BURST", "rand");
+    if      (!strcmp(bu, "fixed"))   cfg.burst = BURST_FIXED;
+    else if (!strcmp(bu, "uniform")) cfg.burst = BURST_UNIFORM;
+    else if (!strcmp(bu, "bimodal")) cfg.burst = BURST_BIMODAL;
+    else                             cfg.burst = BURST_RAND;
+    cfg.len_a       = tb_param("TB_BURST_A",   cfg.len_a);
+    cfg.len_b       = tb_param("TB_BURST_B",   cfg.len_b);
+    cfg.bimodal_pct = tb_param("TB_BIMODAL_PCT", cfg.bimodal_pct);
+    return cfg;
+  };
+};
+
+// The traffic state of a single generator (ie the RD or WR channel of a master)
+class traffic_gen {
+public:
+  traffic_cfg cfg;
+  bool        is_on;
+
+  traffic_gen() : is_on(true) {};
+
+  // Whether a transaction is generated at this cycle, for an average rate (%)
+  bool inject(unsigned rate) {
+    if (cfg.inject == traffic_cfg::BERNOULLI) return ((unsigned)(rand()%100) < rate);
+
+    // ON/OFF state transition at the end of the current period, geometric on average of on/off_len
+    unsigned cur_len = is_on ? cfg.on_len : cfg.off_len;
+    if (cur_len==0 || (unsigned)(rand()%cur_len)==0) is_on = !is_on;
+    if (!is_on) return false;
+    unsigned on_rate = (cfg.on_len == 0) ? 0 : (rate * (cfg.on_len + cfg.off_len)) / cfg.on_len;
+    return ((unsigned)(rand()%100) < on_rate);
+  };
+
+  // The destination slave of master src
+  unsigned dest(unsigned src, unsigned masters, unsigned slaves) {
+    unsigned nodes = (masters > slaves) ? masters : slaves;
+    unsigned bits  = 0;
+    while ((1u<<bits) < nodes) bits++;
+    unsigned mask  = (1u<<bits) - 1;
+
+    unsigned dst;
+    switch (cfg.pattern) {
+      case traffic_cfg::HOTSPOT :
+        dst = ((unsigned)(rand()%100) < cfg.hot_pct) ? cfg.hot_dst : (unsigned)(rand()%slaves);
+        break;
+      case traffic_cfg::TRANSPOSE :
+        dst = (bits==0) ? 0 : (((src << (bits/2)) | (src >> (bits - bits/2))) & mask);
+        break;
+      case traffic_cfg::BITCOMP :
+        dst = (~src) & mask;
+        break;
+      case traffic_cfg::NEIGHBOR :
+        dst = src+1;
+        break;
+      default :
+        dst = (unsigned)(rand()%slaves);
+        break;
+    }
+    return dst % slaves;
+  };
+
+  // AXI len (beats-1) of an INCR burst, up to max_beats
+  unsigned burst_len(unsigned max_beats) {
+    unsigned beats;
+    if      (cfg.burst == traffic_cfg::BURST_FIXED)   beats = cfg.len_a;
+    else if (cfg.burst == traffic_cfg::BURST_UNIFORM) beats = (cfg.len_b > cfg.len_a) ? cfg.len_a + (rand()%(cfg.len_b - cfg.len_a + 1)) : cfg.len_a;
+    else                                              beats = ((unsigned)(rand()%100) < cfg.bimodal_pct) ? cfg.len_a : cfg.len_b;
+
+    if (beats < 1)         beats = 1;
+    if (beats > max_beats) beats = max_beats;
+    return beats-1;
+  };
+};
+
+#endif // __TRAFFIC_GEN_H__